@@ -7,6 +7,8 @@ static const uint NUMBER_OF_SAMPLES = 4;
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Shaders including engine_constants.h first read these from its buffers
+#ifndef IOE_ENGINE_CONSTANTS
 cbuffer GlobalSettings
 {
     float4 View : VIEW;
@@ -14,6 +16,7 @@ cbuffer GlobalSettings
     float4x4 WorldInvTranspose : WORLDINVTRANSPOSE;
 	float2 ViewportSize : VIEWPORTSIZE;
 };
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////
 
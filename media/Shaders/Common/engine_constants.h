@@ -0,0 +1,37 @@
+#ifndef _IOE_SHADER_ENGINE_CONSTANTS_H_
+#define _IOE_SHADER_ENGINE_CONSTANTS_H_
+
+// Buffers owned by the engine, split by how often they change. Each is bound
+// once at its own register for every stage, so materials never upload or bind
+// them. Layouts match IOEEngineConstants.h.
+#define IOE_ENGINE_CONSTANTS
+
+////////////////////////////////////////////////////////////////////////////////
+
+cbuffer PerFrame : register(b11)
+{
+    float Time;
+    float DeltaTime;
+    uint FrameIndex;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+cbuffer PerView : register(b12)
+{
+    float4x4 ViewProj;
+    float4 View : VIEW;
+    float2 ViewportSize : VIEWPORTSIZE;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+cbuffer PerObject : register(b13)
+{
+    float4x4 WorldViewProj : WORLDVIEWPROJ;
+    float4x4 WorldInvTranspose : WORLDINVTRANSPOSE;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
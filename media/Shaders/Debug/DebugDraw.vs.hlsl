@@ -1,7 +1,4 @@
-cbuffer GlobalSettings
-{
-    float4x4 WorldViewProj : WORLDVIEWPROJ;
-}
+#include "../common/engine_constants.h"
 
 struct VS_INPUT
 {
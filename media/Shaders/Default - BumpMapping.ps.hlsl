@@ -26,6 +26,7 @@ Texture2D DiffuseTexture;
 Texture2D BumpTexture;
 
 #include "common/common_defs.h"
+#include "common/engine_constants.h"
 #include "common/common.h"
 #include "common/common_shadows.h"
 
@@ -1,9 +1,4 @@
-cbuffer GlobalSettings
-{
-    float4 View : VIEW;
-	float4x4 WorldViewProj : WORLDVIEWPROJ;
-    float4x4 WorldInvTranspose : WORLDINVTRANSPOSE;
-};
+#include "common/engine_constants.h"
 
 struct PS_INPUT
 {
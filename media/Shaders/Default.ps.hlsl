@@ -25,6 +25,7 @@ SamplerState g_samPoint
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "common/common_defs.h"
+#include "common/engine_constants.h"
 #include "common/common.h"
 #include "common/common_shadows.h"
 
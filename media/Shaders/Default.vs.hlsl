@@ -1,12 +1,22 @@
 #include "common/common_defs.h"
+#include "common/engine_constants.h"
 
-cbuffer GlobalSettings
+// Instanced draws read each copy's model space placement from Instances,
+// starting at FirstInstance. NumInstances is zero for ordinary draws.
+cbuffer InstanceSettings
 {
-    float4 View : VIEW;
-    float4x4 WorldViewProj : WORLDVIEWPROJ;
-    float4x4 WorldInvTranspose : WORLDINVTRANSPOSE;
+    uint FirstInstance;
+    uint NumInstances;
 }
 
+struct InstanceData
+{
+    float4x4 World;
+    float4x4 WorldInvTranspose;
+};
+
+StructuredBuffer<InstanceData> Instances;
+
 struct VS_INPUT
 {
     float4 Pos      : POSITION;
@@ -31,10 +41,19 @@ struct VS_OUTPUT
 
 ////////////////////////////////////////////////////////////////////////////////
 
-VS_OUTPUT main(VS_INPUT input)
+VS_OUTPUT main(VS_INPUT input, uint InstanceID : SV_InstanceID)
 {
     VS_OUTPUT Out = (VS_OUTPUT)0;
 
+    if (NumInstances > 0)
+    {
+        InstanceData Instance = Instances[FirstInstance + InstanceID];
+        input.Pos = mul(float4(input.Pos.xyz, 1.0f), Instance.World);
+        input.Nrm = float4(mul(input.Nrm.xyz, (float3x3)Instance.WorldInvTranspose), 0.0f);
+        input.Tangent = float4(mul(input.Tangent.xyz, (float3x3)Instance.WorldInvTranspose), 0.0f);
+        input.Binormal = float4(mul(input.Binormal.xyz, (float3x3)Instance.WorldInvTranspose), 0.0f);
+    }
+
     Out.Pos = mul(float4(input.Pos.xyz, 1.0f), WorldViewProj);
     Out.Colour = input.Colour;
 	Out.WNrm = input.Nrm;
@@ -5,20 +5,25 @@ struct PSInput
     float2 UV		: TEXCOORD0;
 };
 
+// Signed distance to the glyph's edge, 0.5 on it
 Texture2D GlyphSampler;
 
-SamplerState g_samPoint
+SamplerState g_samLinear
 {
-    Filter = MIN_MAG_MIP_POINT;
-    AddressU = Wrap;
-    AddressV = Wrap;
+    Filter = MIN_MAG_MIP_LINEAR;
+    AddressU = Clamp;
+    AddressV = Clamp;
 };
 
 float4 main(PSInput input) : SV_TARGET0
 {
     float2 UV = input.UV;
 
-    float4 vTextureColour = GlyphSampler.Sample(g_samPoint, UV);
+    float fDistance = GlyphSampler.Sample(g_samLinear, UV).r;
 
-    return vTextureColour * input.Colour;
+    // Antialiased over about a pixel at any size the text is drawn at
+    float fWidth = fwidth(fDistance);
+    float fCoverage = smoothstep(0.5f - fWidth, 0.5f + fWidth, fDistance);
+
+    return float4(input.Colour.rgb, input.Colour.a * fCoverage);
 }
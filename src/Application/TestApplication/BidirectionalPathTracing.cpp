@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <memory>
 
@@ -9,6 +11,7 @@
 
 #include <IOE/IOERenderer/IOEFont.h>
 #include <IOE/IOERenderer/IOEMaterial.h>
+#include <IOE/IOERenderer/IOEMaterialBatch.h>
 #include <IOE/IOERenderer/IOEModelManager.h>
 #include <IOE/IOERenderer/IOERPI.h>
 #include <IOE/IOERenderer/IOEShader.h>
@@ -20,6 +23,7 @@
 #include <IOE/IOEInput/IOEInputMouse.h>
 
 #include <IOE/IOEMaths/Matrix.h>
+#include <IOE/IOEMaths/Sampling.h>
 #include <IOE/IOEMaths/Vector.h>
 
 #include "DirectXCollision.h"
@@ -37,7 +41,8 @@ using Core::IOEManagerContainer;
 
 //////////////////////////////////////////////////////////////////////////
 
-const float BidirectionalPathTracer::ms_fVPLResolution = 256.0f;
+const float BidirectionalPathTracer::ms_fVPLResolution	  = 256.0f;
+const float BidirectionalPathTracer::ms_fMaxRayBundleHeight = 0.8f;
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -74,6 +79,7 @@ BidirectionalPathTracer::BidirectionalPathTracer()
 	, m_tBackFaceCulling(Renderer::IOERasterizerState::Default())
 	, m_tNoCulling(Renderer::IOERasterizerState::Default())
 	, m_tVertexBuffer(static_cast<uint32_t>(ms_fVPLResolution * ms_fVPLResolution * 16))
+	, m_uRayBundleFrame(0)
 {
 	m_tNoCulling.tData.eCullMode = Renderer::ECullMode::None;
 
@@ -261,6 +267,7 @@ void BidirectionalPathTracer::SetLightSettings(const IOEVector &vLightPos, float
 			"RarelyModified", "Specular", CTestApplication::GetSingletonPtr()->GetSpecular());
 		m_pGeneratePerPixelLinkedListMaterial->UnmapCBuffer("RarelyModified");
 	}
+	m_tCubemapViews.ClearViews();
 	for (int32_t nIdx(0); nIdx < (int32_t)Renderer::ECubeFace::NumFaces; ++nIdx)
 	{
 		m_arrCubemapCameras[nIdx].GetTransform().SetTranslation(vLightPos);
@@ -268,7 +275,14 @@ void BidirectionalPathTracer::SetLightSettings(const IOEVector &vLightPos, float
 
 		m_arrCubemapCameras[nIdx].UpdateViewMatrices();
 
-		m_arrCubemapVisibility[nIdx].UpdateVisibility(m_arrCubemapCameras[nIdx]);
+		m_tCubemapViews.AddView(m_arrCubemapCameras[nIdx]);
+	}
+
+	// One traversal for all six faces
+	m_tCubemapViews.UpdateVisibility();
+	for (std::uint32_t uIdx(0); uIdx < (std::uint32_t)Renderer::ECubeFace::NumFaces; ++uIdx)
+	{
+		m_arrCubemapVisibility[uIdx].UpdateVisibility(m_tCubemapViews, uIdx);
 	}
 }
 
@@ -301,57 +315,55 @@ void BidirectionalPathTracer::Initialise()
 							Renderer::ETextureFormat::R24_UNORM_X8_TYPELESS,
 							Renderer::ETextureFormat::D24_UNORM_S8_UINT, true);
 
-	m_pCopyBufferMaterial[0] = std::make_shared<Renderer::IOEMaterial>();
-	m_pCopyBufferMaterial[0]->AddDefinition("TEXTURE_INDEX", "0");
-	m_pCopyBufferMaterial[0]->LoadMaterial(
-		Core::Algorithm::JoinPath(Core::g_pEngine->GetMediaPath(), L"Materials", L"CopyBuffer.ioe.xml"));
+	// Every material is compiled together, before any of them is used
+	Renderer::IOEMaterialBatch tMaterials;
+	const std::wstring szMaterialPath(Core::Algorithm::JoinPath(Core::g_pEngine->GetMediaPath(), L"Materials"));
 
-	m_pCopyBufferMaterial[1] = std::make_shared<Renderer::IOEMaterial>();
-	m_pCopyBufferMaterial[1]->AddDefinition("TEXTURE_INDEX", "1");
-	m_pCopyBufferMaterial[1]->LoadMaterial(
-		Core::Algorithm::JoinPath(Core::g_pEngine->GetMediaPath(), L"Materials", L"CopyBuffer.ioe.xml"));
+	m_tCopyBufferTemplate.LoadTemplate(Core::Algorithm::JoinPath(szMaterialPath, L"CopyBuffer.ioe.xml"));
+	m_pCopyBufferMaterial[0] =
+		tMaterials.Add(m_tCopyBufferTemplate, m_tCopyBufferTemplate.GetPermutation("TEXTURE_INDEX", "0"));
+	m_pCopyBufferMaterial[1] =
+		tMaterials.Add(m_tCopyBufferTemplate, m_tCopyBufferTemplate.GetPermutation("TEXTURE_INDEX", "1"));
 
-	m_pBuildReflectiveShadowMapMaterial = std::make_shared<Renderer::IOEMaterial>();
-	m_pBuildReflectiveShadowMapMaterial->LoadMaterial(Core::Algorithm::JoinPath(
-		Core::g_pEngine->GetMediaPath(), L"Materials", L"GenerateReflectiveShadowMap.ioe.xml"));
+	m_pBuildReflectiveShadowMapMaterial =
+		tMaterials.Add(Core::Algorithm::JoinPath(szMaterialPath, L"GenerateReflectiveShadowMap.ioe.xml"));
 
-	m_pGenerateVPLMaterial = std::make_shared<Renderer::IOEMaterial>();
 #if (ENABLE_BIDIRECTIONAL_PATH_TRACER_DUAL_PARABALOID_SHADOW_MAPS == 1)
-	m_pGenerateVPLMaterial->LoadMaterial(Core::Algorithm::JoinPath(Core::g_pEngine->GetMediaPath(), L"Materials",
-																   L"GenerateVPLDualParabaloid.ioe.xml"));
+	m_pGenerateVPLMaterial =
+		tMaterials.Add(Core::Algorithm::JoinPath(szMaterialPath, L"GenerateVPLDualParabaloid.ioe.xml"));
 #else
-	m_pGenerateVPLMaterial->LoadMaterial(Core::Algorithm::JoinPat
-		Core::g_pEngine->GetMediaPath(), L"Materials", L"GenerateVPLCuboid.ioe.xml"));h(
+	m_pGenerateVPLMaterial = tMaterials.Add(Core::Algorithm::JoinPath(szMaterialPath, L"GenerateVPLCuboid.ioe.xml"));
 #endif
 
-	m_pGeneratePerPixelLinkedListMaterial = std::make_shared<Renderer::IOEMaterial>();
-	m_pGeneratePerPixelLinkedListMaterial->LoadMaterial(Core::Algorithm::JoinPath(
-		Core::g_pEngine->GetMediaPath(), L"Materials", L"PerPixelLinkedListRayBundle.ioe.xml"));
+	m_pGeneratePerPixelLinkedListMaterial =
+		tMaterials.Add(Core::Algorithm::JoinPath(szMaterialPath, L"PerPixelLinkedListRayBundle.ioe.xml"));
+	m_pClearPerPixelLinkedListMaterial =
+		tMaterials.Add(Core::Algorithm::JoinPath(szMaterialPath, L"ClearPerPixelLinkedListBuffer.ioe.xml"));
+	m_pComputeRadianceMaterial =
+		tMaterials.Add(Core::Algorithm::JoinPath(szMaterialPath, L"CalculateRadianceRayBundle.ioe.xml"));
+	m_pComputeVPLSampleDataMaterial =
+		tMaterials.Add(Core::Algorithm::JoinPath(szMaterialPath, L"ComputeVPLSampleDataMaterial.ioe.xml"));
+	m_pDebugPerPixelLinkedListMaterial =
+		tMaterials.Add(Core::Algorithm::JoinPath(szMaterialPath, L"DebugPerPixelLinkedList.ioe.xml"));
+
+	tMaterials.Load(IOE::Renderer::IOERPI::GetSingletonPtr());
+
 	m_pGeneratePerPixelLinkedListMaterial->MapCBuffer("ScreenSizes");
 	m_pGeneratePerPixelLinkedListMaterial->SetShaderVariableValue("ScreenSizes", "ScreenWidth", ms_fVPLResolution);
 	m_pGeneratePerPixelLinkedListMaterial->SetShaderVariableValue("ScreenSizes", "ScreenHeight", ms_fVPLResolution);
 	m_pGeneratePerPixelLinkedListMaterial->UnmapCBuffer("ScreenSizes");
 
-	m_pClearPerPixelLinkedListMaterial = std::make_shared<Renderer::IOEMaterial>();
-	m_pClearPerPixelLinkedListMaterial->LoadMaterial(Core::Algorithm::JoinPath(
-		Core::g_pEngine->GetMediaPath(), L"Materials", L"ClearPerPixelLinkedListBuffer.ioe.xml"));
 	m_pClearPerPixelLinkedListMaterial->MapCBuffer("ScreenSizes");
 	m_pClearPerPixelLinkedListMaterial->SetShaderVariableValue("ScreenSizes", "ScreenWidth", ms_fVPLResolution);
 	m_pClearPerPixelLinkedListMaterial->SetShaderVariableValue("ScreenSizes", "ScreenHeight", ms_fVPLResolution);
 	m_pClearPerPixelLinkedListMaterial->SetShaderVariableValue("ScreenSizes", "NumSamples", ms_nNumSamples);
 	m_pClearPerPixelLinkedListMaterial->UnmapCBuffer("ScreenSizes");
 
-	m_pComputeRadianceMaterial = std::make_shared<Renderer::IOEMaterial>();
-	m_pComputeRadianceMaterial->LoadMaterial(Core::Algorithm::JoinPath(Core::g_pEngine->GetMediaPath(), L"Materials",
-																	   L"CalculateRadianceRayBundle.ioe.xml"));
 	m_pComputeRadianceMaterial->MapCBuffer("RarelyModified");
 	m_pComputeRadianceMaterial->SetShaderVariableValue("RarelyModified", "ScreenWidth", ms_fVPLResolution);
 	m_pComputeRadianceMaterial->SetShaderVariableValue("RarelyModified", "ScreenHeight", ms_fVPLResolution);
 	m_pComputeRadianceMaterial->UnmapCBuffer("RarelyModified");
 
-	m_pComputeVPLSampleDataMaterial = std::make_shared<Renderer::IOEMaterial>();
-	m_pComputeVPLSampleDataMaterial->LoadMaterial(Core::Algorithm::JoinPath(
-		Core::g_pEngine->GetMediaPath(), L"Materials", L"ComputeVPLSampleDataMaterial.ioe.xml"));
 	m_pComputeVPLSampleDataMaterial->MapCBuffer("RarelyModified");
 	m_pComputeVPLSampleDataMaterial->SetShaderVariableValue("RarelyModified", "ScreenWidth", ms_fVPLResolution);
 	m_pComputeVPLSampleDataMaterial->SetShaderVariableValue("RarelyModified", "ScreenHeight", ms_fVPLResolution);
@@ -518,100 +530,13 @@ void BidirectionalPathTracer::Initialise()
 	}
 	m_tVertexBuffer.Setup(IOE::Renderer::IOERPI::GetSingletonPtr());
 
-	m_pDebugPerPixelLinkedListMaterial = std::make_shared<Renderer::IOEMaterial>();
-	m_pDebugPerPixelLinkedListMaterial->LoadMaterial(
-		Core::Algorithm::JoinPath(Core::g_pEngine->GetMediaPath(), L"Materials", L"DebugPerPixelLinkedList.ioe.xml"));
 	m_pDebugPerPixelLinkedListMaterial->MapCBuffer("ScreenSizes");
 	m_pDebugPerPixelLinkedListMaterial->SetShaderVariableValue("ScreenSizes", "ScreenWidth", ms_fVPLResolution);
 	m_pDebugPerPixelLinkedListMaterial->SetShaderVariableValue("ScreenSizes", "ScreenHeight", ms_fVPLResolution);
 	m_pDebugPerPixelLinkedListMaterial->UnmapCBuffer("ScreenSizes");
 
-	for (int32_t nPhiIdx(0); nPhiIdx < ms_nNumSamplePhiDirs; ++nPhiIdx)
-	{
-		float fLongitude = (static_cast<float>(IOE_TWO_PI) / ms_nNumSamplePhiDirs) * nPhiIdx;
-
-		for (int32_t nThetaIdx(0); nThetaIdx < ms_nNumSampleThetaDirs; ++nThetaIdx)
-		{
-			// + 1 to avoid direct up into the sky
-			float fLattitude = (static_cast<float>(IOE_PI) / (ms_nNumSampleThetaDirs + 1)) * (nThetaIdx + 1);
-
-			int32_t nIdx = nPhiIdx * ms_nNumSampleThetaDirs + nThetaIdx;
-
-			/*
-			x	=	r cos theta sin phi
-			y	=	r sin theta sin phi
-			z	=	r cos phi.
-			*/
-			float fX = Maths::Sin(fLattitude) * Maths::Cos(fLongitude);
-			float fY = Maths::Cos(fLattitude);
-			float fZ = Maths::Sin(fLattitude) * Maths::Sin(fLongitude);
-
-			Maths::IOEVector vDir(fX, fY, fZ);
-			// Maths::IOEVector vDir(0.0f, 0.0f, -1.0f);
-
-			m_arrDirections[nIdx] = vDir;
-
-			Maths::IOEAABB tAABB(CTestApplication::GetSingletonPtr()->GetMainModel()->GetAABB());
-			Maths::IOEMatrix mTransform(Maths::IOEMatrix::LookAt(Maths::g_vIdentity, -vDir));
-			Maths::IOEAABB tAABBTransformed = tAABB.Transform(mTransform);
-
-			Maths::IOEVector vMin(tAABBTransformed.m_vBounds[0]);
-			Maths::IOEVector vMax(tAABBTransformed.m_vBounds[1]);
-			Maths::IOEVector vCentre(vMin + (vMax - vMin) * 0.5f);
-			vCentre.SetW(1.0f);
-
-			float fMaxBounds((vMax - vMin).MaxElement() * 1.5f);
-
-			// vCentre = vMin + IOEVector(fMaxBounds*0.5f, fMaxBounds*0.5f,
-			// fMaxBounds*0.5f);
-			Maths::IOECamera &rCamera(m_arrCamerasGlobalRayBundles[nIdx]);
-
-			Maths::IOEVector vTrans(vCentre + vDir * 45.0f);
-			Maths::IOERay tRay(vTrans, -vDir * fMaxBounds);
-			float fDistance(0.0f);
-
-			if (tAABB.Intersect(tRay, &fDistance))
-			{
-				vTrans = vCentre + vDir * (fDistance + 50.0f);
-			}
-
-			vTrans.SetW(1.0f);
-			rCamera.GetTransform() = IOETransform(g_mIdentity);
-			rCamera.GetTransform().SetTranslation(vTrans);
-			rCamera.SetLookAt(vCentre);
-			rCamera.SetUpVector(Maths::IOEVector(0.0f, 1.0f, 0.0f));
-			rCamera.SetOrthographic(fMaxBounds, fMaxBounds, 1.0f, fMaxBounds * 2.0f);
-			rCamera.UpdateViewMatrices();
-
-			Maths::IOEMatrix mViewProj((rCamera.GetViewMatrix() * rCamera.GetProjectionMatrix()));
-			for (int i = 0; i < 16; ++i)
-			{
-				m_arrRayBundleLocations[nIdx][i] = mViewProj.GetCell(i % 4, i / 4);
-			}
-			vTrans.Get(m_arrRayBundleLocations[nIdx][16], m_arrRayBundleLocations[nIdx][17],
-					   m_arrRayBundleLocations[nIdx][18], m_arrRayBundleLocations[nIdx][19]);
-			vDir.Get(m_arrRayBundleLocations[nIdx][20], m_arrRayBundleLocations[nIdx][21],
-					 m_arrRayBundleLocations[nIdx][22], m_arrRayBundleLocations[nIdx][23]);
-		}
-	}
-
-	Renderer::IOETextureSource tSource;
-	tSource.pSrc			= &m_arrRayBundleLocations[0][0];
-	tSource.uNumMipMaps		= 1;
-	tSource.uPixelSizeBytes = 0;
-
-	// float fBufferSize(sizeof(float) * 16);
-	float fBufferSize(
-		static_cast<float>(CTestApplication::GetSingletonPtr()->GetActiveMaterial()->GetStructuredBufferSize(
-			"InRayBundleCameraLocations")));
-	if (fBufferSize <= 0.0f)
-		fBufferSize = sizeof(float) * 24;
-	m_pRayBundleCameraLocationBuffer = std::make_shared<Renderer::IOETexture>(
-		IOE::Renderer::ETextureFormat::Unknown, fBufferSize, static_cast<int32_t>(ms_nNumSamples));
-	m_pRayBundleCameraLocationBuffer->SetBufferAccess(Renderer::ECPUAccess::GPUReadWrite);
-	m_pRayBundleCameraLocationBuffer->SetBufferDescription(Renderer::EBufferDescription::ShaderResource);
-	m_pRayBundleCameraLocationBuffer->SetTextureType(Renderer::ETextureType::GenericBuffer);
-	m_pRayBundleCameraLocationBuffer->Setup(&tSource);
+	UpdateRayBundleCameras(m_uRayBundleFrame);
+	CreateRayBundleBuffer();
 
 	//////////////////////////////////////////////////////////////////////////
 	// Global ray bundle render targets
@@ -665,8 +590,122 @@ void BidirectionalPathTracer::Initialise()
 
 //////////////////////////////////////////////////////////////////////////
 
+void BidirectionalPathTracer::UpdateRayBundleCameras(std::uint32_t uSeed)
+{
+	// Scrambled Sobol points warped onto the band of the sphere away from the poles, four directions at a time
+	static_assert(ms_nNumSamples % 4 == 0, "Ray bundle directions are generated in packets of four");
+	for (int32_t nPacket(0); nPacket < ms_nNumSamples / 4; ++nPacket)
+	{
+		alignas(16) float arrU1[4];
+		alignas(16) float arrU2[4];
+		for (int32_t nLane(0); nLane < 4; ++nLane)
+		{
+			arrU1[nLane] = Maths::Sampling::ScrambledSobol(nPacket * 4 + nLane, 0, uSeed);
+			arrU2[nLane] = Maths::Sampling::ScrambledSobol(nPacket * 4 + nLane, 1, uSeed);
+		}
+
+		__m128 vX, vY, vZ;
+		Maths::Sampling::UniformSampleZone(_mm_load_ps(arrU1), _mm_load_ps(arrU2), -ms_fMaxRayBundleHeight,
+										   ms_fMaxRayBundleHeight, vX, vY, vZ);
+
+		alignas(16) float arrX[4];
+		alignas(16) float arrY[4];
+		alignas(16) float arrZ[4];
+		_mm_store_ps(arrX, vX);
+		_mm_store_ps(arrY, vY);
+		_mm_store_ps(arrZ, vZ);
+		for (int32_t nLane(0); nLane < 4; ++nLane)
+		{
+			m_arrDirections[nPacket * 4 + nLane] = Maths::IOEVector(arrX[nLane], arrY[nLane], arrZ[nLane]);
+		}
+	}
+
+	for (int32_t nIdx(0); nIdx < ms_nNumSamples; ++nIdx)
+	{
+		const Maths::IOEVector &vDir(m_arrDirections[nIdx]);
+
+		Maths::IOEAABB tAABB(CTestApplication::GetSingletonPtr()->GetMainModel()->GetAABB());
+		Maths::IOEMatrix mTransform(Maths::IOEMatrix::LookAt(Maths::g_vIdentity, -vDir));
+		Maths::IOEAABB tAABBTransformed = tAABB.Transform(mTransform);
+
+		Maths::IOEVector vMin(tAABBTransformed.m_vBounds[0]);
+		Maths::IOEVector vMax(tAABBTransformed.m_vBounds[1]);
+		Maths::IOEVector vCentre(vMin + (vMax - vMin) * 0.5f);
+		vCentre.SetW(1.0f);
+
+		float fMaxBounds((vMax - vMin).MaxElement() * 1.5f);
+
+		Maths::IOECamera &rCamera(m_arrCamerasGlobalRayBundles[nIdx]);
+
+		Maths::IOEVector vTrans(vCentre + vDir * 45.0f);
+		Maths::IOERay tRay(vTrans, -vDir * fMaxBounds);
+		float fDistance(0.0f);
+
+		if (tAABB.Intersect(tRay, &fDistance))
+		{
+			vTrans = vCentre + vDir * (fDistance + 50.0f);
+		}
+
+		vTrans.SetW(1.0f);
+		rCamera.GetTransform() = IOETransform(g_mIdentity);
+		rCamera.GetTransform().SetTranslation(vTrans);
+		rCamera.SetLookAt(vCentre);
+		rCamera.SetUpVector(Maths::IOEVector(0.0f, 1.0f, 0.0f));
+		rCamera.SetOrthographic(fMaxBounds, fMaxBounds, 1.0f, fMaxBounds * 2.0f);
+		rCamera.UpdateViewMatrices();
+
+		Maths::IOEMatrix mViewProj((rCamera.GetViewMatrix() * rCamera.GetProjectionMatrix()));
+		for (int i = 0; i < 16; ++i)
+		{
+			m_arrRayBundleLocations[nIdx][i] = mViewProj.GetCell(i % 4, i / 4);
+		}
+		vTrans.Get(m_arrRayBundleLocations[nIdx][16], m_arrRayBundleLocations[nIdx][17],
+				   m_arrRayBundleLocations[nIdx][18], m_arrRayBundleLocations[nIdx][19]);
+		vDir.Get(m_arrRayBundleLocations[nIdx][20], m_arrRayBundleLocations[nIdx][21],
+				 m_arrRayBundleLocations[nIdx][22], m_arrRayBundleLocations[nIdx][23]);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void BidirectionalPathTracer::CreateRayBundleBuffer()
+{
+	Renderer::IOETextureSource tSource;
+	tSource.pSrc			= &m_arrRayBundleLocations[0][0];
+	tSource.uNumMipMaps		= 1;
+	tSource.uPixelSizeBytes = 0;
+
+	// float fBufferSize(sizeof(float) * 16);
+	float fBufferSize(
+		static_cast<float>(CTestApplication::GetSingletonPtr()->GetActiveMaterial()->GetStructuredBufferSize(
+			"InRayBundleCameraLocations")));
+	if (fBufferSize <= 0.0f)
+		fBufferSize = sizeof(float) * 24;
+	m_pRayBundleCameraLocationBuffer = std::make_shared<Renderer::IOETexture>(
+		IOE::Renderer::ETextureFormat::Unknown, fBufferSize, static_cast<int32_t>(ms_nNumSamples));
+	// Written from the CPU every frame as the directions are reseeded
+	m_pRayBundleCameraLocationBuffer->SetBufferAccess(Renderer::ECPUAccess::GPUReadCPUWrite);
+	m_pRayBundleCameraLocationBuffer->SetBufferDescription(Renderer::EBufferDescription::ShaderResource);
+	m_pRayBundleCameraLocationBuffer->SetTextureType(Renderer::ETextureType::GenericBuffer);
+	m_pRayBundleCameraLocationBuffer->Setup(&tSource);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 void BidirectionalPathTracer::PreRender(Renderer::IOERPI *RPI)
 {
+	// A new seed each frame, so the bundles sweep fresh directions rather
+	// than retracing the same set
+	UpdateRayBundleCameras(++m_uRayBundleFrame);
+
+	void *pData(nullptr);
+	if (m_pRayBundleCameraLocationBuffer->MapBuffer(Renderer::EBufferMapType::WriteDiscard, pData))
+	{
+		// Never more than the buffer the shader's layout sized
+		std::size_t uSize(static_cast<std::size_t>(m_pRayBundleCameraLocationBuffer->GetWidth()) * ms_nNumSamples);
+		std::memcpy(pData, m_arrRayBundleLocations, std::min(uSize, sizeof(m_arrRayBundleLocations)));
+		m_pRayBundleCameraLocationBuffer->UnmapBuffer();
+	}
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -787,14 +826,17 @@ void BidirectionalPathTracer::CreateVPLSampleData(IOE::Renderer::IOERPI *RPI)
 	// single dispatch call rather than
 	// ms_nNumSamples calls.
 	m_pComputeVPLSampleDataMaterial->Set(RPI, false);
+	const IOE::Renderer::IOEShaderParameterHandle hRayDir(
+		m_pComputeVPLSampleDataMaterial->GetShaderParameter("Globals", "RayDir"));
+	const IOE::Renderer::IOEShaderParameterHandle hCurrentSample(
+		m_pComputeVPLSampleDataMaterial->GetShaderParameter("Globals", "CurrentSample"));
 	for (int32_t nSample(0); nSample < ms_nNumSamples; ++nSample)
 	{
 		IOEVector vForward(m_arrDirections[nSample]);
 		vForward.NormaliseSet();
-		m_pComputeVPLSampleDataMaterial->MapCBuffer("Globals");
-		m_pComputeVPLSampleDataMaterial->SetShaderVariableValue("Globals", "RayDir", vForward);
-		m_pComputeVPLSampleDataMaterial->SetShaderVariableValue("Globals", "CurrentSample", nSample);
-		m_pComputeVPLSampleDataMaterial->UnmapCBuffer("Globals");
+		// Uploaded by Dispatch
+		m_pComputeVPLSampleDataMaterial->SetShaderParameter(hRayDir, vForward);
+		m_pComputeVPLSampleDataMaterial->SetShaderParameter(hCurrentSample, nSample);
 
 #if !defined(IOE_FINAL)
 		RPI->AddDebugLine(CTestApplication::GetSingletonPtr()->GetLightPosition(),
@@ -865,24 +907,7 @@ void BidirectionalPathTracer::GenerateVPLs(Renderer::IOERPI *RPI)
 		::IOE::Renderer::IOERPI::GetSingletonPtr()->SetProfileMarker(
 			buffer, ::IOE::Renderer::EProfileMarkerType::Start, Maths::ColourList::White);
 
-		float s_fLongitude = ((static_cast<float>(IOE_TWO_PI) / (ms_nNumSampleThetaDirs + 2)) *
-							  ((nIdx % (ms_nNumSampleThetaDirs)) + 1));
-		float s_fLattitude =
-			((static_cast<float>(IOE_PI) / (ms_nNumSamplePhiDirs + 2)) * ((nIdx / ms_nNumSamplePhiDirs) + 1));
-
-		// Core::g_pEngine->GetApplication()->Logf("Long: %.2f, Lat: %.2f\n",
-		// s_fLongitude, s_fLattitude);
-
-		/*
-		x	=	r cos theta sin phi
-		y	=	r sin theta sin phi
-		z	=	r cos phi.
-		*/
-		float fX = Maths::Cos(s_fLongitude) * Maths::Sin(s_fLattitude);
-		float fY = Maths::Cos(s_fLattitude);
-		float fZ = Maths::Sin(s_fLongitude) * Maths::Sin(s_fLattitude);
-
-		Maths::IOEVector vDir(fX, fY, fZ);
+		const Maths::IOEVector &vDir(m_arrDirections[nIdx]);
 
 		m_pGenerateVPLMaterial->MapCBuffer("PassSettings");
 		m_pGenerateVPLMaterial->SetShaderVariableValue("PassSettings", "SampleDir", vDir);
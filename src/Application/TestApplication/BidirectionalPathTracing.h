@@ -5,6 +5,8 @@
 #include <IOE/IOEMaths/Vector.h>
 #include <IOE/IOEApplication/IOEApplication.h>
 #include <IOE/IOERenderer/IOEBuffer.h>
+#include <IOE/IOERenderer/IOEMaterialTemplate.h>
+#include <IOE/IOERenderer/IOEMultiViewVisibility.h>
 #include <IOE/IOERenderer/IOEVisibilityBounds.h>
 
 #define ENABLE_BIDIRECTIONAL_PATH_TRACER_DUAL_PARABALOID_SHADOW_MAPS 1
@@ -43,15 +45,13 @@ struct DebugPerPixelLinkedListVertex
 class BidirectionalPathTracer
 {
 public:
-	// Phi = Longitude (Num slices)
-	// Theta = Lattitude (Num stacks)
-	static const std::int32_t ms_nNumSampleThetaDirs = 4;
-	static const std::int32_t ms_nNumSamplePhiDirs   = 5;
-
-	static const std::int32_t ms_nNumSamples =
-		ms_nNumSamplePhiDirs * ms_nNumSampleThetaDirs;
+	static const std::int32_t ms_nNumSamples = 20;
 	static const float ms_fVPLResolution;
 
+	// Ray bundle directions are kept within this height of the horizon, as
+	// the fixed up vector makes the bundle cameras degenerate at the poles
+	static const float ms_fMaxRayBundleHeight;
+
 public:
 	template <int TNumFaces>
 	struct RenderableCubemapTexture
@@ -132,6 +132,16 @@ private:
 	void GenerateVPLs(IOE::Renderer::IOERPI *RPI);
 	void CreatePerPixelLinkedList(IOE::Renderer::IOERPI *RPI);
 
+	// Rebuilds the ray bundle cameras from a scrambled Sobol set. Each
+	// seed gives a differently scrambled but equally well stratified set
+	// of directions, so reseeding every frame converges faster than
+	// reusing one fixed set.
+	void UpdateRayBundleCameras(std::uint32_t uSeed);
+
+	// Once, with the cameras of the current seed; PreRender then rewrites
+	// its contents in place
+	void CreateRayBundleBuffer();
+
 private:
 	void DebugDrawScene(IOE::Renderer::IOERPI *RPI);
 
@@ -196,10 +206,14 @@ private:
 		m_pGlobalRayBundleDepthTarget[3];
 
 	std::shared_ptr<IOE::Renderer::IOEMaterial> m_pCopyBufferMaterial[2];
+	IOE::Renderer::IOEMaterialTemplate m_tCopyBufferTemplate;
 
 	IOE::Maths::IOECamera m_arrCamerasGlobalRayBundles[ms_nNumSamples];
 	IOE::Maths::IOEVector m_arrDirections[ms_nNumSamples];
 
+	// Seeds the ray bundle directions, advanced once a frame
+	std::uint32_t m_uRayBundleFrame;
+
 public:
 	float m_arrRayBundleLocations[ms_nNumSamples][24];
 
@@ -214,6 +228,7 @@ private:
 		m_arrCubemapCameras[IOE::Renderer::ECubeFace::NumFaces];
 	IOE::Maths::IOECamera
 		m_arrDefaultAxesCameras[IOE::Renderer::ECubeFace::NumFaces];
+	IOE::Renderer::IOEMultiViewVisibility m_tCubemapViews;
 	IOE::Renderer::IOEVisibilityBounds
 		m_arrCubemapVisibility[IOE::Renderer::ECubeFace::NumFaces];
 	IOE::Maths::IOECamera m_tForwardCamera;
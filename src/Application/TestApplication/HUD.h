@@ -131,6 +131,10 @@ struct HUD
 {
 	HUD()
 		: m_tFrameDelta("FPS", 0.0f, 0.45f)
+		, m_tVisibilityCache("Visibility Cache %", 0.0f, 0.4f)
+		, m_tOccluded("Occluded %", 0.0f, 0.35f)
+		, m_tDrawsBefore("Draws Before Instancing", 0.0f, 0.3f)
+		, m_tDrawsAfter("Draws After Instancing", 0.0f, 0.25f)
 		, m_tCameraControlsLabel("Camera Controls:", -0.5f, 0.f)
 		, m_tCameraControlsLabel_Line1("W: Forward, S: Backwards", -0.5f,
 									   -0.05f)
@@ -140,6 +144,13 @@ struct HUD
 		, m_tCameraControlsLabel_Line4("Left: -Yaw,  Right: +Yaw", -0.5f,
 									   -0.2f)
 
+		, m_tRenderStatDraws("Draws", -0.5f, -0.25f)
+		, m_tRenderStatTriangles("Triangles", -0.5f, -0.3f)
+		, m_tRenderStatStateChanges("State Changes", -0.5f, -0.35f)
+		, m_tRenderStatCBufferMaps("CBuffer Maps", -0.5f, -0.4f)
+		, m_tRenderStatTextureBinds("Texture Binds", -0.5f, -0.45f)
+		, m_tRenderStatVisibleSubsets("Visible Subsets", -0.5f, -0.5f)
+
 		, m_tDebugControlsLabel("Debug Controls:", 0.3f, 0.f)
 		, m_tDebugControlsLabel_Line1("F1: Next Debug Mode", 0.25f, -0.05f)
 		, m_tDebugControlsLabel_Line2("F2: Prev Debug Mode", 0.25f, -0.1f)
@@ -149,7 +160,11 @@ struct HUD
 		, m_tDebugControlsLabel_Line5("F5/F6: Change Roughness", 0.25f, -0.25f)
 		, m_tDebugControlsLabel_Line6("F7/F8: Change Intensity", 0.25f, -0.3f)
 		, m_tDebugControlsLabel_Line8("O/P: Cycle Setup", 0.25f, -0.35f)
+		, m_tDebugControlsLabel_Line9("F9: Dump Occlusion Depth", 0.25f,
+									  -0.4f)
 		, m_tDebugControlsLabel_Line7("Space: Toggle HUD", 0.25f, -0.45f)
+		, m_tDebugControlsLabel_Line10("F10: Toggle Instancing", 0.25f,
+									   -0.5f)
 
 		, m_tIndirectDirectLight("Lighting: ", 0.25f, 0.4f)
 		, m_tIndirectDirectLightToggle("Toggle: I", 0.25f, 0.35f)
@@ -165,6 +180,10 @@ struct HUD
 	void GenerateText(std::shared_ptr<IOE::Renderer::IOEFont> pFont)
 	{
 		m_tFrameDelta.GenerateText(pFont);
+		m_tVisibilityCache.GenerateText(pFont);
+		m_tOccluded.GenerateText(pFont);
+		m_tDrawsBefore.GenerateText(pFont);
+		m_tDrawsAfter.GenerateText(pFont);
 		m_tIntensity.GenerateText(pFont);
 		m_tRoughness.GenerateText(pFont);
 		m_tSpecular.GenerateText(pFont);
@@ -175,6 +194,13 @@ struct HUD
 		m_tCameraControlsLabel_Line3.GenerateText(pFont);
 		m_tCameraControlsLabel_Line4.GenerateText(pFont);
 
+		m_tRenderStatDraws.GenerateText(pFont);
+		m_tRenderStatTriangles.GenerateText(pFont);
+		m_tRenderStatStateChanges.GenerateText(pFont);
+		m_tRenderStatCBufferMaps.GenerateText(pFont);
+		m_tRenderStatTextureBinds.GenerateText(pFont);
+		m_tRenderStatVisibleSubsets.GenerateText(pFont);
+
 		m_tDebugControlsLabel.GenerateText(pFont);
 		m_tDebugControlsLabel_Line1.GenerateText(pFont);
 		m_tDebugControlsLabel_Line2.GenerateText(pFont);
@@ -184,6 +210,8 @@ struct HUD
 		m_tDebugControlsLabel_Line6.GenerateText(pFont);
 		m_tDebugControlsLabel_Line7.GenerateText(pFont);
 		m_tDebugControlsLabel_Line8.GenerateText(pFont);
+		m_tDebugControlsLabel_Line9.GenerateText(pFont);
+		m_tDebugControlsLabel_Line10.GenerateText(pFont);
 
 		m_tIndirectDirectLight.GenerateText(pFont);
 		m_tIndirectDirectLightToggle.GenerateText(pFont);
@@ -194,16 +222,31 @@ struct HUD
 	void Update()
 	{
 		m_tFrameDelta.Update();
+		m_tVisibilityCache.Update();
+		m_tOccluded.Update();
+		m_tDrawsBefore.Update();
+		m_tDrawsAfter.Update();
 		m_tIntensity.Update();
 		m_tRoughness.Update();
 		m_tSpecular.Update();
 		m_tDebugMode.Update();
 		m_tIndirectDirectLight.Update();
+
+		m_tRenderStatDraws.Update();
+		m_tRenderStatTriangles.Update();
+		m_tRenderStatStateChanges.Update();
+		m_tRenderStatCBufferMaps.Update();
+		m_tRenderStatTextureBinds.Update();
+		m_tRenderStatVisibleSubsets.Update();
 	}
 
 	void SetScreenSize(float fWidth, float fHeight)
 	{
 		m_tFrameDelta.SetScreenSize(fWidth, fHeight);
+		m_tVisibilityCache.SetScreenSize(fWidth, fHeight);
+		m_tOccluded.SetScreenSize(fWidth, fHeight);
+		m_tDrawsBefore.SetScreenSize(fWidth, fHeight);
+		m_tDrawsAfter.SetScreenSize(fWidth, fHeight);
 
 		m_tIntensity.SetScreenSize(fWidth, fHeight);
 		m_tRoughness.SetScreenSize(fWidth, fHeight);
@@ -215,6 +258,13 @@ struct HUD
 		m_tCameraControlsLabel_Line3.SetScreenSize(fWidth, fHeight);
 		m_tCameraControlsLabel_Line4.SetScreenSize(fWidth, fHeight);
 
+		m_tRenderStatDraws.SetScreenSize(fWidth, fHeight);
+		m_tRenderStatTriangles.SetScreenSize(fWidth, fHeight);
+		m_tRenderStatStateChanges.SetScreenSize(fWidth, fHeight);
+		m_tRenderStatCBufferMaps.SetScreenSize(fWidth, fHeight);
+		m_tRenderStatTextureBinds.SetScreenSize(fWidth, fHeight);
+		m_tRenderStatVisibleSubsets.SetScreenSize(fWidth, fHeight);
+
 		m_tDebugControlsLabel.SetScreenSize(fWidth, fHeight);
 		m_tDebugControlsLabel_Line1.SetScreenSize(fWidth, fHeight);
 		m_tDebugControlsLabel_Line2.SetScreenSize(fWidth, fHeight);
@@ -224,6 +274,8 @@ struct HUD
 		m_tDebugControlsLabel_Line6.SetScreenSize(fWidth, fHeight);
 		m_tDebugControlsLabel_Line7.SetScreenSize(fWidth, fHeight);
 		m_tDebugControlsLabel_Line8.SetScreenSize(fWidth, fHeight);
+		m_tDebugControlsLabel_Line9.SetScreenSize(fWidth, fHeight);
+		m_tDebugControlsLabel_Line10.SetScreenSize(fWidth, fHeight);
 
 		m_tIndirectDirectLight.SetScreenSize(fWidth, fHeight);
 		m_tIndirectDirectLightToggle.SetScreenSize(fWidth, fHeight);
@@ -234,6 +286,16 @@ struct HUD
 	// Frame time
 	HUDElement<float> m_tFrameDelta;
 
+	// Share of camera visibility updates that skipped a full cull
+	HUDElement<float> m_tVisibilityCache;
+
+	// Share of frustum visible subsets rejected by occlusion culling
+	HUDElement<float> m_tOccluded;
+
+	// Draw calls for the visible subsets without and with instancing
+	HUDElement<std::uint32_t> m_tDrawsBefore;
+	HUDElement<std::uint32_t> m_tDrawsAfter;
+
 	// Properties
 	HUDElement<float> m_tIntensity;
 	HUDElement<float> m_tRoughness;
@@ -246,6 +308,15 @@ struct HUD
 	HUDElement<std::string> m_tCameraControlsLabel_Line3;
 	HUDElement<std::string> m_tCameraControlsLabel_Line4;
 
+	// Renderer counters of the last frame, with their min, average and max
+	// over the stats window
+	HUDElement<std::string> m_tRenderStatDraws;
+	HUDElement<std::string> m_tRenderStatTriangles;
+	HUDElement<std::string> m_tRenderStatStateChanges;
+	HUDElement<std::string> m_tRenderStatCBufferMaps;
+	HUDElement<std::string> m_tRenderStatTextureBinds;
+	HUDElement<std::string> m_tRenderStatVisibleSubsets;
+
 	// Debug Controls
 	HUDElement<std::string> m_tDebugControlsLabel;
 	HUDElement<std::string> m_tDebugControlsLabel_Line1;
@@ -256,6 +327,8 @@ struct HUD
 	HUDElement<std::string> m_tDebugControlsLabel_Line6;
 	HUDElement<std::string> m_tDebugControlsLabel_Line7;
 	HUDElement<std::string> m_tDebugControlsLabel_Line8;
+	HUDElement<std::string> m_tDebugControlsLabel_Line9;
+	HUDElement<std::string> m_tDebugControlsLabel_Line10;
 
 	HUDElement<std::string> m_tIndirectDirectLight;
 	HUDElement<std::string> m_tIndirectDirectLightToggle;
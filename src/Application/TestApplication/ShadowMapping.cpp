@@ -116,8 +116,6 @@ void CubeShadowMap::Initialise()
 
 		m_arrCameras[nIdx].SetCameraProperties(tProperties);
 		m_arrCameras[nIdx].SetUpVector(vUpVector);
-
-		m_arrVisibilityBounds[nIdx].SetTakeIntoAccountLookAt(true);
 	}
 	SetLightPosition(vLightPos);
 
@@ -233,15 +231,28 @@ void CubeShadowMap::SetResolution(float fResolution)
 
 void CubeShadowMap::SetLightPosition(const IOE::Maths::IOEVector &vLightPos)
 {
+	// The light is held relative to the main camera's world origin
+	const Maths::IOEVectorD vOrigin(
+		Renderer::IOERPI::GetSingletonPtr()->GetDefaultCamera().GetWorldOrigin());
+
+	m_tViews.ClearViews();
 	for (int32_t nIdx(0); nIdx < (int32_t)Renderer::ECubeFace::NumFaces;
 		 ++nIdx)
 	{
+		m_arrCameras[nIdx].SetWorldOrigin(vOrigin);
 		m_arrCameras[nIdx].GetTransform().SetTranslation(vLightPos);
 		m_arrCameras[nIdx].SetLookAt(vLightPos + g_arrAxes[nIdx]);
 
 		m_arrCameras[nIdx].UpdateViewMatrices();
 
-		m_arrVisibilityBounds[nIdx].UpdateVisibility(m_arrCameras[nIdx]);
+		m_tViews.AddView(m_arrCameras[nIdx]);
+	}
+
+	m_tViews.UpdateVisibility();
+	for (std::uint32_t uIdx(0);
+		 uIdx < (std::uint32_t)Renderer::ECubeFace::NumFaces; ++uIdx)
+	{
+		m_arrVisibilityBounds[uIdx].UpdateVisibility(m_tViews, uIdx);
 	}
 }
 
@@ -289,15 +300,12 @@ void DualParabaloidShadowMap::Initialise()
 		Core::g_pEngine->GetMediaPath(), L"Materials",
 		L"BuildParabaloidShadowMap.ioe.xml"));
 
-	m_pCopyBufferMaterial[0] = std::make_shared<Renderer::IOEMaterial>();
-	m_pCopyBufferMaterial[0]->AddDefinition("TEXTURE_INDEX", "0");
-	m_pCopyBufferMaterial[0]->LoadMaterial(Core::Algorithm::JoinPath(
-		Core::g_pEngine->GetMediaPath(), L"Materials", L"CopyBuffer.ioe.xml"));
-
-	m_pCopyBufferMaterial[1] = std::make_shared<Renderer::IOEMaterial>();
-	m_pCopyBufferMaterial[1]->AddDefinition("TEXTURE_INDEX", "1");
-	m_pCopyBufferMaterial[1]->LoadMaterial(Core::Algorithm::JoinPath(
+	m_tCopyBufferTemplate.LoadTemplate(Core::Algorithm::JoinPath(
 		Core::g_pEngine->GetMediaPath(), L"Materials", L"CopyBuffer.ioe.xml"));
+	m_pCopyBufferMaterial[0] = m_tCopyBufferTemplate.GetVariant(
+		m_tCopyBufferTemplate.GetPermutation("TEXTURE_INDEX", "0"));
+	m_pCopyBufferMaterial[1] = m_tCopyBufferTemplate.GetVariant(
+		m_tCopyBufferTemplate.GetPermutation("TEXTURE_INDEX", "1"));
 
 	m_pShaderResources = std::make_shared<Renderer::IOETexture>(
 		Renderer::ETextureFormat::R32_FLOAT, m_pShadowMap->GetWidth(),
@@ -466,6 +474,7 @@ void DualParabaloidShadowMap::PostRender(
 void DualParabaloidShadowMap::SetLightPosition(
 	const IOE::Maths::IOEVector &vLightPos)
 {
+	m_tViews.ClearViews();
 	for (std::uint32_t uIdx = 0; uIdx < 2; ++uIdx)
 	{
 		Maths::IOEVector vForwardVec(uIdx == 0 ? Maths::g_vForwardVector
@@ -475,7 +484,14 @@ void DualParabaloidShadowMap::SetLightPosition(
 		m_arrCamera[uIdx].SetUpVector(Maths::g_vUpVector);
 		m_arrCamera[uIdx].UpdateViewMatrices();
 
-		m_arrVisibilityBounds[uIdx].UpdateVisibility(vLightPos, vForwardVec);
+		m_tViews.AddHalfSpace(vLightPos, vForwardVec);
+	}
+
+	// Both hemispheres in one traversal
+	m_tViews.UpdateVisibility();
+	for (std::uint32_t uIdx = 0; uIdx < 2; ++uIdx)
+	{
+		m_arrVisibilityBounds[uIdx].UpdateVisibility(m_tViews, uIdx);
 	}
 }
 
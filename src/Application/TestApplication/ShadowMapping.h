@@ -7,6 +7,8 @@
 #include <IOE/IOEMaths/Vector.h>
 #include <IOE/IOEApplication/IOEApplication.h>
 #include <IOE/IOERenderer/IOEBuffer.h>
+#include <IOE/IOERenderer/IOEMaterialTemplate.h>
+#include <IOE/IOERenderer/IOEMultiViewVisibility.h>
 #include <IOE/IOERenderer/IOEVisibilityBounds.h>
 
 //////////////////////////////////////////////////////////////////////////
@@ -64,6 +66,7 @@ private:
 		m_arrRenderTargets[IOE::Renderer::ECubeFace::NumFaces];
 	std::shared_ptr<IOE::Renderer::IOETexture> m_pDepthTarget;
 	IOE::Maths::IOECamera m_arrCameras[IOE::Renderer::ECubeFace::NumFaces];
+	IOE::Renderer::IOEMultiViewVisibility m_tViews;
 	IOE::Renderer::IOEVisibilityBounds
 		m_arrVisibilityBounds[IOE::Renderer::ECubeFace::NumFaces];
 
@@ -118,10 +121,12 @@ private:
 	// the default interpolation.
 	std::shared_ptr<IOE::Renderer::IOETexture> m_arrRenderTargets[2];
 	IOE::Maths::IOECamera m_arrCamera[2];
+	IOE::Renderer::IOEMultiViewVisibility m_tViews;
 	IOE::Renderer::IOEVisibilityBounds m_arrVisibilityBounds[2];
 
 	std::shared_ptr<IOE::Renderer::IOEMaterial> m_pBuildShadowmapMaterial;
 	std::shared_ptr<IOE::Renderer::IOEMaterial> m_pCopyBufferMaterial[2];
+	IOE::Renderer::IOEMaterialTemplate m_tCopyBufferTemplate;
 
 	IOE::Renderer::IOEBlendState m_tDefault;
 	IOE::Renderer::IOEBlendState m_tNoBlend;
@@ -10,6 +10,7 @@
 #include <IOE/IOERenderer/IOERPI.h>
 #include <IOE/IOERenderer/IOEShader.h>
 #include <IOE/IOERenderer/IOEMaterial.h>
+#include <IOE/IOERenderer/IOEMaterialBatch.h>
 #include <IOE/IOERenderer/IOEModelManager.h>
 #include <IOE/IOERenderer/IOEVertexFormat.h>
 #include <IOE/IOERenderer/IOEFont.h>
@@ -116,6 +117,11 @@ IOE::Renderer::ETextureFormat eFormat =
 
 void VoxelConeTracer::Initialise()
 {
+	// Every material is compiled together, before any of them is used
+	Renderer::IOEMaterialBatch tMaterials;
+	const std::wstring szMaterialPath(Core::Algorithm::JoinPath(
+		Core::g_pEngine->GetMediaPath(), L"Materials"));
+
 	m_pBuildOctreeMaterial = std::make_shared<Renderer::IOEMaterial>();
 
 #if (ENABLE_SHADOW_MAPPING == 1)
@@ -125,29 +131,28 @@ void VoxelConeTracer::Initialise()
 	m_pBuildOctreeMaterial->AddDefinition("SHADOW_MAPPING", "1");
 #endif
 #endif
-	m_pBuildOctreeMaterial->LoadMaterial(IOE::Core::Algorithm::JoinPath(
-		Core::g_pEngine->GetMediaPath(), L"Materials",
-		L"GenerateOctree.ioe.xml"));
-
-	m_pDebugOctreeMaterial = std::make_shared<Renderer::IOEMaterial>(
-		Core::Algorithm::JoinPath(Core::g_pEngine->GetMediaPath(),
-								  L"Materials", L"DebugOctree.ioe.xml"));
-	m_pDebugOctreePointsMaterial = std::make_shared<Renderer::IOEMaterial>(
-		Core::Algorithm::JoinPath(Core::g_pEngine->GetMediaPath(),
-								  L"Materials", L"DebugDrawPoints.ioe.xml"));
+	tMaterials.Add(m_pBuildOctreeMaterial,
+				   Core::Algorithm::JoinPath(szMaterialPath,
+											 L"GenerateOctree.ioe.xml"));
+
+	m_pDebugOctreeMaterial = tMaterials.Add(
+		Core::Algorithm::JoinPath(szMaterialPath, L"DebugOctree.ioe.xml"));
+	m_pDebugOctreePointsMaterial = tMaterials.Add(
+		Core::Algorithm::JoinPath(szMaterialPath, L"DebugDrawPoints.ioe.xml"));
+	m_tGenerateMipsTemplate.LoadTemplate(
+		Core::Algorithm::JoinPath(szMaterialPath, L"GenerateMips.ioe.xml"));
 	for (int32_t nIdx(0); nIdx < EAxisDirection::NumDirections; ++nIdx)
 	{
 		std::stringstream sstream;
 		sstream << nIdx;
-		m_pGenerateMipsMaterial[nIdx] =
-			std::make_shared<Renderer::IOEMaterial>();
-		m_pGenerateMipsMaterial[nIdx]->AddDefinition("DIRECTION",
-													 sstream.str());
-		m_pGenerateMipsMaterial[nIdx]->LoadMaterial(
-			Core::Algorithm::JoinPath(Core::g_pEngine->GetMediaPath(),
-									  L"Materials", L"GenerateMips.ioe.xml"));
+		m_pGenerateMipsMaterial[nIdx] = tMaterials.Add(
+			m_tGenerateMipsTemplate,
+			m_tGenerateMipsTemplate.GetPermutation("DIRECTION",
+												   sstream.str().c_str()));
 	}
 
+	tMaterials.Load(IOE::Renderer::IOERPI::GetSingletonPtr());
+
 	UpdateLightSettings();
 
 	for (std::int32_t nIdx(0); nIdx < EAxisDirection::NumDirections; ++nIdx)
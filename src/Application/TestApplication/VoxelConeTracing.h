@@ -5,6 +5,7 @@
 #include <IOE/IOEMaths/Vector.h>
 #include <IOE/IOEApplication/IOEApplication.h>
 #include <IOE/IOERenderer/IOEBuffer.h>
+#include <IOE/IOERenderer/IOEMaterialTemplate.h>
 #include <IOE/IOERenderer/IOEVisibilityBounds.h>
 
 #include "Axis.h"
@@ -85,6 +86,7 @@ private:
 	std::shared_ptr<IOE::Renderer::IOEMaterial> m_pDebugOctreePointsMaterial;
 	std::shared_ptr<IOE::Renderer::IOEMaterial>
 		m_pGenerateMipsMaterial[EAxisDirection::NumDirections];
+	IOE::Renderer::IOEMaterialTemplate m_tGenerateMipsTemplate;
 
 	IOE::Maths::IOEVector m_vOctreeOffset;
 	IOE::Maths::IOEVector m_vOctreeScale;
@@ -9,8 +9,10 @@
 
 #include <IOE/IOERenderer/IOEFont.h>
 #include <IOE/IOERenderer/IOEMaterial.h>
+#include <IOE/IOERenderer/IOEMaterialBatch.h>
 #include <IOE/IOERenderer/IOEModelManager.h>
 #include <IOE/IOERenderer/IOERPI.h>
+#include <IOE/IOERenderer/IOERenderQueue.h>
 #include <IOE/IOERenderer/IOEShader.h>
 #include <IOE/IOERenderer/IOEVertexFormat.h>
 
@@ -54,12 +56,17 @@ CTestApplication::CTestApplication(const IOE::Application::C_CommandLine &rComma
 	, m_pClampSampler(std::make_shared<Renderer::IOESamplerState>(Renderer::IOESamplerState::Default()))
 	, m_pDefaultSampler(std::make_shared<Renderer::IOESamplerState>(Renderer::IOESamplerState::Default()))
 	, m_bCameraDirty(true)
+	, m_bInstancing(true)
 	, m_eCameraMode(ECameraMode::Camera)
 	, m_vCameraPosition(-10.0f, 1.5f, 5.0f)
 	, m_qCameraRotation(20.0f, 110.0f, 0.0f)
 	, m_dRenderTime(0.0)
 	, m_nNumnRenders(0)
 	, m_fLastRender(0.0f)
+	, m_fVisibilityCacheHitRate(0.0f)
+	, m_fOccludedPercentage(0.0f)
+	, m_uDrawsBefore(0)
+	, m_uDrawsAfter(0)
 	, m_szDebugMode("None")
 	, m_szLightingMode("Direct And Indirect")
 	, m_nLightingMode(0)
@@ -113,9 +120,15 @@ void CTestApplication::OnManagerPostInit()
 	//
 	//////////////////////////////////////////////////////////////////////////
 
+	//////////////////////////////////////////////////////////////////////////
+	// Every material is compiled together once they have all been added
+	Renderer::IOEMaterialBatch tMaterials;
+	//
+	//////////////////////////////////////////////////////////////////////////
+
 	//////////////////////////////////////////////////////////////////////////
 	// Compile the generic diffuse material
-	m_pDiffuseMaterial = std::make_shared<Renderer::IOEMaterial>(
+	m_pDiffuseMaterial = tMaterials.Add(
 		Core::Algorithm::JoinPath(Core::g_pEngine->GetMediaPath(), L"Materials", L"DefaultDiffuse.ioe.xml"));
 	//
 	//////////////////////////////////////////////////////////////////////////
@@ -130,8 +143,8 @@ void CTestApplication::OnManagerPostInit()
 	m_pBumpMappingMaterial->AddDefinition("SHADOW_MAPPING", "1");
 #endif
 #endif
-	m_pBumpMappingMaterial->LoadMaterial(
-		Core::Algorithm::JoinPath(Core::g_pEngine->GetMediaPath(), L"Materials", L"DefaultBumpMapping.ioe.xml"));
+	tMaterials.Add(m_pBumpMappingMaterial, Core::Algorithm::JoinPath(Core::g_pEngine->GetMediaPath(), L"Materials",
+																	L"DefaultBumpMapping.ioe.xml"));
 	//
 	//////////////////////////////////////////////////////////////////////////
 
@@ -161,9 +174,39 @@ void CTestApplication::OnManagerPostInit()
 		m_pPhysicalMaterial[nMaterialIdx]->AddDefinition("SHADOW_MAPPING", "1");
 #endif
 #endif
-		m_pPhysicalMaterial[nMaterialIdx]->LoadMaterial(
+		tMaterials.Add(
+			m_pPhysicalMaterial[nMaterialIdx],
 			Core::Algorithm::JoinPath(Core::g_pEngine->GetMediaPath(), L"Materials", L"DefaultPhysical.ioe.xml"));
+	}
+	//
+	//////////////////////////////////////////////////////////////////////////
+
+	//////////////////////////////////////////////////////////////////////////
+	// Compile all 7 copy buffer shaders, each one takes a single side of the
+	// face
+	// and the last uses a texture3 to do a 3D lookup
+	m_tCopyBufferTemplate.LoadTemplate(
+		Core::Algorithm::JoinPath(Core::g_pEngine->GetMediaPath(), L"Materials", L"CopyBuffer.ioe.xml"));
+	for (int32_t nIdx(0); nIdx < 7; ++nIdx)
+	{
+		std::uint64_t uPermutation(0);
+		if (nIdx > 0)
+		{
+			char buffer[2] = { 0 };
+			_itoa_s<2>(nIdx - 1, buffer, 10);
+			uPermutation = m_tCopyBufferTemplate.GetPermutation("TEXTURE_CUBE_DIRECTION", buffer);
+		}
+		m_pCopyBufferMaterial[nIdx] = tMaterials.Add(m_tCopyBufferTemplate, uPermutation);
+	}
+	//////////////////////////////////////////////////////////////////////////
+
+	tMaterials.Load(Renderer::IOERPI::GetSingletonPtr());
+	IOE::Core::g_pEngine->GetApplication()->Logf("Loaded materials: %u shaders from %u compiles\n",
+												  tMaterials.GetNumShaders(), tMaterials.GetNumCompiles());
+
 #if (ENABLE_BIDIRECTIONAL_PATH_TRACER == 1)
+	for (int nMaterialIdx = 0; nMaterialIdx < 3; ++nMaterialIdx)
+	{
 		m_pPhysicalMaterial[nMaterialIdx]->MapCBuffer("RarelyModified");
 		m_pPhysicalMaterial[nMaterialIdx]->SetShaderVariableValue("RarelyModified", "ScreenWidth",
 																  BidirectionalPathTracer::ms_fVPLResolution);
@@ -172,10 +215,8 @@ void CTestApplication::OnManagerPostInit()
 		m_pPhysicalMaterial[nMaterialIdx]->SetShaderVariableValue("RarelyModified", "NumSamples",
 																  BidirectionalPathTracer::ms_nNumSamples);
 		m_pPhysicalMaterial[nMaterialIdx]->UnmapCBuffer("RarelyModified");
-#endif
 	}
-//
-//////////////////////////////////////////////////////////////////////////
+#endif
 
 // Assign the initial material
 #if (ENABLE_BIDIRECTIONAL_PATH_TRACER == 0 && ENABLE_VOXEL_CONE_TRACING == 0)
@@ -184,24 +225,6 @@ void CTestApplication::OnManagerPostInit()
 	m_pActiveMaterial = m_pPhysicalMaterial[0];
 #endif
 
-	//////////////////////////////////////////////////////////////////////////
-	// Compile all 7 copy buffer shaders, each one takes a single side of the
-	// face
-	// and the last uses a texture3 to do a 3D lookup
-	for (int32_t nIdx(0); nIdx < 7; ++nIdx)
-	{
-		m_pCopyBufferMaterial[nIdx] = std::make_shared<Renderer::IOEMaterial>();
-		if (nIdx > 0)
-		{
-			char buffer[2] = { 0 };
-			_itoa_s<2>(nIdx - 1, buffer, 10);
-			m_pCopyBufferMaterial[nIdx]->AddDefinition("TEXTURE_CUBE_DIRECTION", buffer);
-		}
-		m_pCopyBufferMaterial[nIdx]->LoadMaterial(
-			Core::Algorithm::JoinPath(Core::g_pEngine->GetMediaPath(), L"Materials", L"CopyBuffer.ioe.xml"));
-	}
-	//////////////////////////////////////////////////////////////////////////
-
 	//////////////////////////////////////////////////////////////////////////
 	// Load the scene and add to renderer
 	std::wstring szModelPath;
@@ -214,6 +237,9 @@ void CTestApplication::OnManagerPostInit()
 	m_pSponza = IOE::Renderer::IOEModelManager::GetSingletonPtr()->LoadModel(szModelPath);
 	m_pSponza->SetMaterial(IOE::Renderer::IOERPI::GetSingletonPtr(), m_pActiveMaterial);
 	IOE::Renderer::IOEModelManager::GetSingletonPtr()->AddToRender(m_pSponza);
+	IOE::Core::g_pEngine->GetApplication()->Logf("Loaded '%S': %d subsets drawn as %u instanced shapes\n",
+												  szModelPath.c_str(), m_pSponza->GetNumSubsets(),
+												  m_pSponza->GetNumSubsetShapes());
 
 	//////////////////////////////////////////////////////////////////////////
 
@@ -254,6 +280,16 @@ void CTestApplication::OnManagerPostInit()
 	m_tHUD.SetScreenSize(static_cast<float>(uX), static_cast<float>(uY));
 	m_tHUD.GenerateText(m_pFont);
 	m_tHUD.m_tFrameDelta.SetDataSource(&m_fLastRender);
+	m_tHUD.m_tVisibilityCache.SetDataSource(&m_fVisibilityCacheHitRate);
+	m_tHUD.m_tOccluded.SetDataSource(&m_fOccludedPercentage);
+	m_tHUD.m_tDrawsBefore.SetDataSource(&m_uDrawsBefore);
+	m_tHUD.m_tDrawsAfter.SetDataSource(&m_uDrawsAfter);
+	m_tHUD.m_tRenderStatDraws.SetDataSource(&m_arrRenderStats[Renderer::ERenderStat::Draws]);
+	m_tHUD.m_tRenderStatTriangles.SetDataSource(&m_arrRenderStats[Renderer::ERenderStat::Triangles]);
+	m_tHUD.m_tRenderStatStateChanges.SetDataSource(&m_arrRenderStats[Renderer::ERenderStat::StateChanges]);
+	m_tHUD.m_tRenderStatCBufferMaps.SetDataSource(&m_arrRenderStats[Renderer::ERenderStat::ConstantBufferMaps]);
+	m_tHUD.m_tRenderStatTextureBinds.SetDataSource(&m_arrRenderStats[Renderer::ERenderStat::TextureBinds]);
+	m_tHUD.m_tRenderStatVisibleSubsets.SetDataSource(&m_arrRenderStats[Renderer::ERenderStat::VisibleSubsets]);
 	m_tHUD.m_tIntensity.SetDataSource(&m_fIntensity);
 	m_tHUD.m_tRoughness.SetDataSource(&m_fRoughness);
 	m_tHUD.m_tSpecular.SetDataSource(&m_fLightSpecular);
@@ -493,11 +529,26 @@ void CTestApplication::HandleInput(IOE::Core::IOETimeDelta tTimeDelta)
 							  rTransform.GetRotationQuat().Rotate(Maths::g_vForwardVector));
 			rCamera.GetTransform() = rTransform;
 			rCamera.UpdateViewMatrices();
+
+			// Move the world origin onto the camera once it strays far enough
+			// for float precision to show. The light is held relative to the
+			// origin, so it moves back by the same shift.
+			static const float fRecentreDistance = 1024.0f;
+			Maths::IOEVector vShift(Maths::g_vZeroVector);
+			if (m_eCameraMode == ECameraMode::Camera && rCamera.RecentreWorldOrigin(fRecentreDistance, &vShift))
+			{
+				rTransform = rCamera.GetTransform();
+				SetLightPosition(m_vLightPos - vShift);
+				m_bCameraDirty = true;
+			}
 		}
 
+		// Reuses the last result unless the camera or a model has moved
+		m_tCameraVisibilityCheck.UpdateVisibility(rCamera);
+		m_tOcclusionCulling.Cull(rCamera, m_tCameraVisibilityCheck);
+
 		if (m_bCameraDirty)
 		{
-			m_tCameraVisibilityCheck.UpdateVisibility(rCamera);
 			m_bCameraDirty = false;
 
 			if (m_eCameraMode == ECameraMode::Camera)
@@ -576,6 +627,16 @@ void CTestApplication::HandleInput_Debug(IOE::Core::IOETimeDelta tTimeDelta)
 			}
 		}
 
+		if (pKeyboard->JustReleased(IOE::Input::EInputKey::F9))
+		{
+			m_tOcclusionCulling.DumpDepth("OcclusionDepth.pgm");
+		}
+
+		if (pKeyboard->JustReleased(IOE::Input::EInputKey::F10))
+		{
+			m_bInstancing = !m_bInstancing;
+		}
+
 		static float fTimer(0.0f);
 		static Maths::IOERay tRay(Maths::g_vIdentity, Maths::g_vIdentity);
 
@@ -751,13 +812,36 @@ void CTestApplication::OnRender(IOE::Renderer::IOERPI *pRPI)
 		m_pActiveMaterial->SetTextureVariable(pRPI, "InVPLShadowMaps", m_tBidirectionalPathTracer.GetVPLShadowMaps());
 #endif
 
+		pRPI->GetRenderStats().Add(Renderer::ERenderStat::VisibleSubsets,
+								   m_tCameraVisibilityCheck.GetNumVisibleMeshes());
+
 		if ((m_eDebugDrawMode == EDebugDrawMode::None)
 #if (ENABLE_VOXEL_CONE_TRACING == 1)
 			&& !m_tVoxelConeTracer.IsDebugDrawEnabled()
 #endif
 		)
 		{
-			IOE::Renderer::IOEModelManager::GetSingletonPtr()->RenderAllModels(pRPI, m_tCameraVisibilityCheck);
+			// Repeated subsets are drawn as instances of one draw each, otherwise draws are
+			// sorted by depth then pipeline rather than in load order
+			m_tInstanceBatcher.Build(m_tCameraVisibilityCheck);
+			if (m_bInstancing)
+			{
+				m_tInstanceBatcher.Execute(pRPI);
+			}
+			else
+			{
+				// Pipelines are of each material under the states the frame started with
+				Renderer::IOEPipelineDescription tPassStates;
+				tPassStates.uRasterizerStateID = pRPI->GetRasterizerState().GetID();
+				tPassStates.uBlendStateID	  = pRPI->GetBlendState().GetID();
+				tPassStates.uDepthStateID	  = pRPI->GetDefaultDepthState().GetID();
+				IOE::Renderer::IOEModelManager::GetSingletonPtr()->QueueModels(
+					Renderer::g_tRenderQueue, pRPI->GetCamera(), m_tCameraVisibilityCheck, pRPI->GetStateCache(),
+					tPassStates);
+				Renderer::g_tRenderQueue.Sort();
+				Renderer::g_tRenderQueue.Execute(pRPI);
+				Renderer::g_tRenderQueue.Clear();
+			}
 		}
 
 #if (ENABLE_BIDIRECTIONAL_PATH_TRACER == 1)
@@ -789,6 +873,17 @@ void CTestApplication::OnRender(IOE::Renderer::IOERPI *pRPI)
 	END_PROFILE_MARKER();
 
 	m_fLastRender = (0.75f * m_fLastRender) + (0.25f * Core::g_pEngine->GetFrameDelta().fInvDelta);
+	m_fVisibilityCacheHitRate = m_tCameraVisibilityCheck.GetCacheStats().GetHitRate() * 100.0f;
+	m_fOccludedPercentage = m_tOcclusionCulling.GetRejectedPercentage();
+	m_uDrawsBefore = m_tInstanceBatcher.GetStats().uDrawsBefore;
+	m_uDrawsAfter = m_bInstancing ? m_tInstanceBatcher.GetStats().uDrawsAfter : m_uDrawsBefore;
+
+	// The counters of the frame in flight are only complete once the RPI ends it, so the HUD shows the last one
+	const Renderer::IOERenderStats &rRenderStats(pRPI->GetRenderStats());
+	for (std::uint32_t uStat(0); uStat < Renderer::ERenderStat::NumStats; ++uStat)
+	{
+		m_arrRenderStats[uStat] = rRenderStats.Format(static_cast<Renderer::ERenderStat::Enum>(uStat));
+	}
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <memory>
 #include <string>
 #include <sstream>
@@ -23,6 +24,10 @@
 #include <IOE/IOEApplication/IOEApplication.h>
 #include <IOE/IOERenderer/IOEBuffer.h>
 #include <IOE/IOERenderer/IOEVisibilityBounds.h>
+#include <IOE/IOERenderer/IOEOcclusionCulling.h>
+#include <IOE/IOERenderer/IOEInstanceBatcher.h>
+#include <IOE/IOERenderer/IOEMaterialTemplate.h>
+#include <IOE/IOERenderer/IOERenderStats.h>
 
 #include "Axis.h"
 #include "HUD.h"
@@ -356,6 +361,7 @@ private:
 	// [2] = Just Direct Lighting
 	std::shared_ptr<IOE::Renderer::IOEMaterial> m_pPhysicalMaterial[3];
 	std::shared_ptr<IOE::Renderer::IOEMaterial> m_pCopyBufferMaterial[7];
+	IOE::Renderer::IOEMaterialTemplate m_tCopyBufferTemplate;
 
 	std::shared_ptr<IOE::Renderer::IOEMaterial> m_pActiveMaterial;
 
@@ -398,7 +404,10 @@ private:
 	EDebugDrawMode m_eDebugDrawMode;
 
 	IOE::Renderer::IOEVisibilityBounds m_tCameraVisibilityCheck;
+	IOE::Renderer::IOEOcclusionCulling m_tOcclusionCulling;
+	IOE::Renderer::IOEInstanceBatcher m_tInstanceBatcher;
 	bool m_bCameraDirty;
+	bool m_bInstancing;
 
 	ECameraMode m_eCameraMode;
 
@@ -406,6 +415,13 @@ private:
 	int32_t m_nNumnRenders;
 
 	float m_fLastRender;
+	float m_fVisibilityCacheHitRate;
+	float m_fOccludedPercentage;
+	std::uint32_t m_uDrawsBefore;
+	std::uint32_t m_uDrawsAfter;
+
+	// Renderer counters as drawn on the HUD, one per ERenderStat
+	std::array<std::string, IOE::Renderer::ERenderStat::NumStats> m_arrRenderStats;
 
 	std::string m_szDebugMode;
 	std::string m_szLightingMode;
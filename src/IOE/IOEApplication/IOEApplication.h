@@ -17,32 +17,6 @@ namespace Application
 	extern const std::uint32_t gsDefaultResX;
 	extern const std::uint32_t gsDefaultResY;
 
-	template <typename _T>
-	inline _T GetDefaultResX()
-	{
-		auto pBase(IOE::Core::g_pEngine->GetApplication());
-		std::uint32_t uValue(gsDefaultResX);
-		if (pBase->GetCommandLine().HasArgument(L"resx"))
-		{
-			uValue = pBase->GetCommandLine().GetArgumentValue<std::uint32_t>(
-				L"resx", 0);
-		}
-		return static_cast<_T>(uValue);
-	}
-
-	template <typename _T>
-	inline _T GetDefaultResY()
-	{
-		auto pBase(IOE::Core::g_pEngine->GetApplication());
-		std::uint32_t uValue(gsDefaultResY);
-		if (pBase->GetCommandLine().HasArgument(L"resy"))
-		{
-			uValue = pBase->GetCommandLine().GetArgumentValue<std::uint32_t>(
-				L"resy", 0);
-		}
-		return static_cast<_T>(uValue);
-	}
-
 	interface_class IOEApplicationBase
 	{
 	public:
@@ -106,6 +80,42 @@ namespace Application
 		virtual void OnResize(std::uint32_t uwidth, std::uint32_t uHeight) = 0;
 	};
 
+	// Tools and tests run the engine without an application, and take the
+	// defaults
+	template <typename _T>
+	inline _T GetDefaultResX()
+	{
+		const IOEApplicationBase *pBase(nullptr);
+		if (IOE::Core::g_pEngine != nullptr)
+		{
+			pBase = IOE::Core::g_pEngine->GetApplication();
+		}
+		std::uint32_t uValue(gsDefaultResX);
+		if (pBase != nullptr && pBase->GetCommandLine().HasArgument(L"resx"))
+		{
+			uValue = pBase->GetCommandLine().GetArgumentValue<std::uint32_t>(
+				L"resx", 0);
+		}
+		return static_cast<_T>(uValue);
+	}
+
+	template <typename _T>
+	inline _T GetDefaultResY()
+	{
+		const IOEApplicationBase *pBase(nullptr);
+		if (IOE::Core::g_pEngine != nullptr)
+		{
+			pBase = IOE::Core::g_pEngine->GetApplication();
+		}
+		std::uint32_t uValue(gsDefaultResY);
+		if (pBase != nullptr && pBase->GetCommandLine().HasArgument(L"resy"))
+		{
+			uValue = pBase->GetCommandLine().GetArgumentValue<std::uint32_t>(
+				L"resy", 0);
+		}
+		return static_cast<_T>(uValue);
+	}
+
 	template <class TApplication>
 	class IOEApplication : public IOEApplicationBase,
 						   public IOE::Core::IOEManager<TApplication>
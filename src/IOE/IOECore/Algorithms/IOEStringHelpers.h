@@ -20,7 +20,7 @@ namespace Core
 				szInput.begin(),
 				std::find_if(
 					szInput.begin(), szInput.end(),
-					[&loc](const TStringType::value_type &chInput) -> bool {
+					[&loc](typename TStringType::value_type chInput) -> bool {
 						return !std::isspace<typename TStringType::value_type>(
 							chInput, loc);
 					}));
@@ -35,7 +35,7 @@ namespace Core
 			szInput.erase(
 				std::find_if(
 					szInput.rbegin(), szInput.rend(),
-					[&loc](const TStringType::value_type &chInput) -> bool {
+					[&loc](typename TStringType::value_type chInput) -> bool {
 						return !std::isspace<typename TStringType::value_type>(
 							chInput, loc);
 					})
@@ -105,9 +105,10 @@ namespace Core
 												const TIteratorType end,
 												const TStringType &sep)
 		{
-			std::basic_ostringstream<TStringType::value_type,
-									 TStringType::traits_type,
-									 TStringType::allocator_type> tResult;
+			std::basic_ostringstream<typename TStringType::value_type,
+									 typename TStringType::traits_type,
+									 typename TStringType::allocator_type>
+				tResult;
 
 			if (begin != end)
 			{
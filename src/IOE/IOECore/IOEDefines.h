@@ -1,48 +1,12 @@
 #pragma once
 
-// For _assert
 #include <type_traits>
 #include <limits>
 #include <cstdint>
-#include <crtdbg.h>
-
-// Synonyms for class to help describe the class better - helps readability
-#define interface_class class
-#define abstract_class class
-
-#define IOE_OFF 0
-#define IOE_ON 1
-
-#if defined(IOE_DEBUG)
-#include "IOEDefines_Debug.h"
-#elif defined(IOE_RELEASE)
-#include "IOEDefines_Release.h"
-#elif defined(IOE_FINAL)
-#include "IOEDefines_Final.h"
-#endif
-
-// Pre-method declarative syntax
-#define FORCEINLINE __forceinline
-#define INLINE inline
-
-#if defined(IOE_DEBUG)
-#define FORCEINLINE_DEBUGGABLE inline
-#elif defined(IOE_RELEASE) // IOE_RELEASE
-#define FORCEINLINE_DEBUGGABLE inline
-#else // IOE_FINAL
-#define FORCEINLINE_DEBUGGABLE __forceinline
-#endif
-
-// Post-method virtual modifiers
-#define FINAL final
-#define OVERRIDE override
-
-// Convert the value of any define to a string representation; i.e.
-// #define foo 1
-// STRINGIFY_EXPAND(foo) -> STRINGIFY(1) -> "1"
-// STRINGIFY(foo) -> "foo"
-#define STRINGIFY(str) #str
-#define STRINGIFY_EXPAND(macro) STRINGIFY(macro)
+#include <cstring>
+
+// Class synonyms, inlining, stringify and assert macros
+#include "IOEPortable.h"
 
 // Obtain the nearest next power of two
 template <typename T,
@@ -111,8 +75,8 @@ void CopyAndMovePtr(void *pBuffer, T *&pInput, std::size_t nBytes)
 	memcpy(pBuffer, pInput, nBytes);
 
 	// Move on the pointer by number of bytes
-	pPtr =
-		reinterpret_cast<T *>(reinterpret_cast<std::uint8_t *>(pPtr) + nBytes);
+	pInput = reinterpret_cast<T *>(reinterpret_cast<std::uint8_t *>(pInput) +
+								   nBytes);
 }
 
 template <typename T, typename T2>
@@ -147,99 +111,23 @@ void *GetPointerAndMovePtr(T *&pPtr, std::size_t nBytes)
 #define EXTERNAL_PLATFORM_INCLUDE(module, file_name)                          \
 	STRINGIFY_EXPAND(IOE/module/IOE_PLATFORM/file_name)
 
-// Code taken from here:
-// http://www.codeproject.com/Articles/10022/DebugBreak-and-ASSERTs-that-work-always-anywhere
-#include <Windows.h> // TODO: Move this to platform specific code
-inline void __stdcall PreDebugBreakAnyway()
-{
-	if (IsDebuggerPresent())
-	{
-		// We're running under the debugger.
-		// There's no need to call the inner DebugBreak
-		// placed in the two __try/__catch blocks below,
-		// because the outer DebugBreak will
-		// force a first-chance exception handled in the debugger.
-		return;
-	}
-
-	__try
-	{
-		__try
-		{
-			DebugBreak();
-		}
-		__except (UnhandledExceptionFilter(GetExceptionInformation()))
-		{
-			// You can place the ExitProcess here to emulate work
-			// of the __except block from BaseStartProcess
-			ExitProcess(0);
-		}
-	}
-	__except (EXCEPTION_EXECUTE_HANDLER)
-	{
-		// We'll get here if the user has pushed Cancel (Debug).
-		// The debugger is already attached to our process.
-		// Return to let the outer DebugBreak be called.
-	}
-}
-
-#define DebugBreakAnyway()                                                    \
-	PreDebugBreakAnyway();                                                    \
-	DebugBreak();
-
-#if (IOE_DEBUG_ENABLED == IOE_ON && IOE_ASSERT_ENABLED == IOE_ON &&           \
-	 defined(_DEBUG))
-
-#define IOE_ASSERT(condition, message)                                        \
-	do                                                                        \
-	{                                                                         \
-		if ((!(condition)) &&                                                 \
-			(1 == _CrtDbgReportW(_CRT_ASSERT, _CRT_WIDE(__FILE__), __LINE__,  \
-								 NULL, _CRT_WIDE(message))))                  \
-		{                                                                     \
-			DebugBreakAnyway();                                               \
-		}                                                                     \
-	} while (0);
-
-#define IOE_ASSERT_VARGS(condition, message, ...)                             \
-	{                                                                         \
-		wchar_t buffer[256];                                                  \
-		swprintf_s(buffer, 256, _CRT_WIDE(message), __VA_ARGS__);             \
-		do                                                                    \
-		{                                                                     \
-			if (!(condition) &&                                               \
-				(1 == _CrtDbgReportW(_CRT_ASSERT, _CRT_WIDE(__FILE__),        \
-									 __LINE__, NULL, buffer)))                \
-			{                                                                 \
-				DebugBreakAnyway();                                           \
-			}                                                                 \
-		} while (0);                                                          \
-	}
-
-#else // IOE_DEBUG_ENABLED == IOE_ON && IOE_ASSERT == IOE_ON
-
-#define IOE_ASSERT(condition, message) ((void)0);
-
-#define IOE_ASSERT_VARGS(condition, message, ...) ((void)0);
-
-#endif // IOE_DEBUG_ENABLED == IOE_ON && IOE_ASSERT == IOE_ON
+// Breaking into the debugger even when none is attached needs the platform
+#include PLATFORM_INCLUDE(IOEDebugBreak_Platform.h)
 
 #if (IOE_DEBUG_ENABLED == IOE_ON && IOE_RPI_PROFILE_MARKERS == IOE_ON)
 
 #define START_PROFILE_MARKER(name, colour)                                    \
 	::IOE::Renderer::IOERPI::GetSingletonPtr()->SetProfileMarker(             \
-		name##" "##STRINGIFY_EXPAND(__FILE__)##" @ "##STRINGIFY_EXPAND(       \
-			__LINE__),                                                        \
+		name " " STRINGIFY_EXPAND(__FILE__) " @ " STRINGIFY_EXPAND(__LINE__), \
 		::IOE::Renderer::EProfileMarkerType::Start, colour)
 #define END_PROFILE_MARKER()                                                  \
 	::IOE::Renderer::IOERPI::GetSingletonPtr()->SetProfileMarker(             \
-		STRINGIFY_EXPAND(__FILE__)##" @ "##STRINGIFY_EXPAND(__LINE__),        \
+		STRINGIFY_EXPAND(__FILE__) " @ " STRINGIFY_EXPAND(__LINE__),          \
 		::IOE::Renderer::EProfileMarkerType::End,                             \
 		::IOE::Maths::ColourList::White)
 #define SET_PROFILE_MARKER(name, colour)                                      \
 	::IOE::Renderer::IOERPI::GetSingletonPtr()->SetProfileMarker(             \
-		name##" "##STRINGIFY_EXPAND(__FILE__)##" @ "##STRINGIFY_EXPAND(       \
-			__LINE__),                                                        \
+		name " " STRINGIFY_EXPAND(__FILE__) " @ " STRINGIFY_EXPAND(__LINE__), \
 		::IOE::Renderer::EProfileMarkerType::Single, colour)
 
 #else
@@ -40,6 +40,11 @@ namespace Core
 	{
 	public:
 		IOEEngineBase();
+		// g_pEngine owns the engine through this base
+		virtual ~IOEEngineBase()
+		{
+		}
+
 		std::int32_t Run();
 
 		FORCEINLINE EEnginePhase GetEnginePhase() const
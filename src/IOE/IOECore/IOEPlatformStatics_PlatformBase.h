@@ -21,7 +21,7 @@ namespace Core
 		{
 			return L'\\';
 		}
-		static constexpr wchar_t* GetBackDir()
+		static constexpr const wchar_t* GetBackDir()
 		{
 			return L"..";
 		}
@@ -38,7 +38,7 @@ namespace Core
 		{
 			return L'\\';
 		}
-		FORCEINLINE static wchar_t* GetBackDir()
+		FORCEINLINE static const wchar_t* GetBackDir()
 		{
 			return L"..";
 		}
@@ -0,0 +1,140 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+// The subset of IOEDefines.h that needs nothing from the platform, for
+// code that must also build and be tested away from Windows. IOEDefines.h
+// includes this, so the two can be mixed freely.
+//////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(_MSC_VER)
+// For _CrtDbgReportW
+#include <crtdbg.h>
+#endif
+
+// Synonyms for class to help describe the class better - helps readability
+#define interface_class class
+#define abstract_class class
+
+#define IOE_OFF 0
+#define IOE_ON 1
+
+#if defined(IOE_DEBUG)
+#include "IOEDefines_Debug.h"
+#elif defined(IOE_RELEASE)
+#include "IOEDefines_Release.h"
+#elif defined(IOE_FINAL)
+#include "IOEDefines_Final.h"
+#endif
+
+// Pre-method declarative syntax
+#if defined(_MSC_VER)
+#define FORCEINLINE __forceinline
+#else
+#define FORCEINLINE inline __attribute__((always_inline))
+#endif
+#define INLINE inline
+
+// Case insensitive compare, which only MSVC spells _stricmp
+#if !defined(_MSC_VER)
+#include <strings.h>
+#define _stricmp strcasecmp
+#endif
+
+#if defined(IOE_DEBUG)
+#define FORCEINLINE_DEBUGGABLE inline
+#elif defined(IOE_RELEASE) // IOE_RELEASE
+#define FORCEINLINE_DEBUGGABLE inline
+#else // IOE_FINAL
+#define FORCEINLINE_DEBUGGABLE FORCEINLINE
+#endif
+
+// Post-method virtual modifiers
+#define FINAL final
+#define OVERRIDE override
+
+// Convert the value of any define to a string representation; i.e.
+// #define foo 1
+// STRINGIFY_EXPAND(foo) -> STRINGIFY(1) -> "1"
+// STRINGIFY(foo) -> "foo"
+#define STRINGIFY(str) #str
+#define STRINGIFY_EXPAND(macro) STRINGIFY(macro)
+
+// Asserts report through the CRT's dialog on Windows and to stderr
+// elsewhere, breaking into the debugger when asked to
+#if defined(_MSC_VER)
+
+#if defined(_DEBUG)
+#define IOE_ASSERT_DEBUG_BUILD IOE_ON
+#else
+#define IOE_ASSERT_DEBUG_BUILD IOE_OFF
+#endif
+
+#define IOE_DEBUG_BREAK() __debugbreak()
+
+#define IOE_ASSERT_REPORT(message)                                            \
+	(1 == _CrtDbgReportW(_CRT_ASSERT, _CRT_WIDE(__FILE__), __LINE__, NULL,    \
+						 _CRT_WIDE(message)))
+
+#define IOE_ASSERT_BUFFER wchar_t buffer[256];
+#define IOE_ASSERT_REPORT_VARGS(message, ...)                                 \
+	(swprintf_s(buffer, 256, _CRT_WIDE(message), __VA_ARGS__),               \
+	 1 == _CrtDbgReportW(_CRT_ASSERT, _CRT_WIDE(__FILE__), __LINE__, NULL,    \
+						 buffer))
+
+#else // _MSC_VER
+
+#if defined(NDEBUG)
+#define IOE_ASSERT_DEBUG_BUILD IOE_OFF
+#else
+#define IOE_ASSERT_DEBUG_BUILD IOE_ON
+#endif
+
+#define IOE_DEBUG_BREAK() __builtin_trap()
+
+#define IOE_ASSERT_REPORT(message)                                            \
+	(std::fprintf(stderr, "%s(%d): %s\n", __FILE__, __LINE__, message),       \
+	 true)
+
+#define IOE_ASSERT_BUFFER
+#define IOE_ASSERT_REPORT_VARGS(message, ...)                                 \
+	(std::fprintf(stderr, "%s(%d): " message "\n", __FILE__, __LINE__,        \
+				  __VA_ARGS__),                                               \
+	 true)
+
+#endif // _MSC_VER
+
+#if (IOE_DEBUG_ENABLED == IOE_ON && IOE_ASSERT_ENABLED == IOE_ON &&           \
+	 IOE_ASSERT_DEBUG_BUILD == IOE_ON)
+
+#define IOE_ASSERT(condition, message)                                        \
+	do                                                                        \
+	{                                                                         \
+		if ((!(condition)) && IOE_ASSERT_REPORT(message))                     \
+		{                                                                     \
+			IOE_DEBUG_BREAK();                                                \
+		}                                                                     \
+	} while (0);
+
+#define IOE_ASSERT_VARGS(condition, message, ...)                             \
+	{                                                                         \
+		IOE_ASSERT_BUFFER                                                     \
+		do                                                                    \
+		{                                                                     \
+			if (!(condition) &&                                               \
+				IOE_ASSERT_REPORT_VARGS(message, __VA_ARGS__))                \
+			{                                                                 \
+				IOE_DEBUG_BREAK();                                            \
+			}                                                                 \
+		} while (0);                                                          \
+	}
+
+#else // IOE_DEBUG_ENABLED == IOE_ON && IOE_ASSERT == IOE_ON
+
+#define IOE_ASSERT(condition, message) ((void)0);
+
+#define IOE_ASSERT_VARGS(condition, message, ...) ((void)0);
+
+#endif // IOE_DEBUG_ENABLED == IOE_ON && IOE_ASSERT == IOE_ON
@@ -0,0 +1,122 @@
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <type_traits>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Core
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Non-owning view of a contiguous run of elements. Lets an interface take
+	// arrays, vectors and braced lists without copying them; the view must
+	// not outlive the storage it was made from.
+	template <typename _T>
+	class IOESpan
+	{
+		typedef typename std::remove_const<_T>::type _Mutable;
+
+	public:
+		IOESpan()
+			: m_pData(nullptr)
+			, m_uSize(0)
+		{
+		}
+
+		IOESpan(_T *pData, std::size_t uSize)
+			: m_pData(pData)
+			, m_uSize(uSize)
+		{
+		}
+
+		template <std::size_t uSize>
+		IOESpan(_T (&arrData)[uSize])
+			: m_pData(arrData)
+			, m_uSize(uSize)
+		{
+		}
+
+		template <std::size_t uSize>
+		IOESpan(std::array<_Mutable, uSize> &arrData)
+			: m_pData(arrData.data())
+			, m_uSize(uSize)
+		{
+		}
+
+		template <std::size_t uSize>
+		IOESpan(const std::array<_Mutable, uSize> &arrData)
+			: m_pData(arrData.data())
+			, m_uSize(uSize)
+		{
+		}
+
+		IOESpan(std::vector<_Mutable> &arrData)
+			: m_pData(arrData.data())
+			, m_uSize(arrData.size())
+		{
+		}
+
+		IOESpan(const std::vector<_Mutable> &arrData)
+			: m_pData(arrData.data())
+			, m_uSize(arrData.size())
+		{
+		}
+
+		// Only valid for the full expression the list was written in, which
+		// makes it suitable for call arguments only
+		IOESpan(std::initializer_list<_Mutable> tList)
+			: m_pData(tList.begin())
+			, m_uSize(tList.size())
+		{
+		}
+
+	public:
+		_T *data() const
+		{
+			return m_pData;
+		}
+		std::size_t size() const
+		{
+			return m_uSize;
+		}
+		bool empty() const
+		{
+			return m_uSize == 0;
+		}
+
+		_T *begin() const
+		{
+			return m_pData;
+		}
+		_T *end() const
+		{
+			return m_pData + m_uSize;
+		}
+
+		_T &operator[](std::size_t uIdx) const
+		{
+			return m_pData[uIdx];
+		}
+
+	private:
+		_T *m_pData;
+		std::size_t m_uSize;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Core
+} // namespace IOE
+
+//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,4 @@
+#pragma once
+
+// Nothing to add here: IOE_DEBUG_BREAK from IOEPortable.h already traps
+// whether or not a debugger is attached.
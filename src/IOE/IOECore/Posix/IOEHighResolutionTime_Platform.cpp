@@ -0,0 +1,22 @@
+#include "IOEHighResolutionTime_Platform.h"
+
+#include <chrono>
+
+namespace IOE
+{
+namespace Core
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEHighResolutionTime_Platform::IOEHighResolutionTime_Platform()
+		: m_dRawTime(std::chrono::duration<double, std::milli>(
+						 std::chrono::steady_clock::now().time_since_epoch())
+						 .count())
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Core
+} // namespace IOE
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <IOE/IOECore/IOEPortable.h>
+#include <IOE/IOECore/IOEHighResolutionTime_PlatformBase.h>
+
+namespace IOE
+{
+namespace Core
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class IOEHighResolutionTime_Platform
+		: public IOEHighResolutionTime_PlatformBase
+	{
+	public:
+		// Default copy / move constructor and assignment / move operators
+		IOEHighResolutionTime_Platform(
+			const IOEHighResolutionTime_Platform &) = default;
+		IOEHighResolutionTime_Platform(IOEHighResolutionTime_Platform &&) =
+			default;
+
+		IOEHighResolutionTime_Platform &
+		operator=(const IOEHighResolutionTime_Platform &) = default;
+		IOEHighResolutionTime_Platform &
+		operator=(IOEHighResolutionTime_Platform &&) = default;
+
+	public:
+		IOEHighResolutionTime_Platform();
+
+		// The raw time (in ms) on the monotonic clock. This does not take
+		// into account any paused time or time dilation.
+		FORCEINLINE virtual double GetRawTime() const final override
+		{
+			return m_dRawTime;
+		}
+
+		// The difference in time (in ms) between two raw time snapshots
+		FORCEINLINE virtual double
+		GetTimeDiff(double dTime) const final override
+		{
+			return GetRawTime() - dTime;
+		}
+		FORCEINLINE double
+		operator-(const IOEHighResolutionTime_Platform &rhs) const
+		{
+			return GetRawTime() - rhs.GetRawTime();
+		}
+
+	private:
+		double m_dRawTime;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Core
+} // namespace IOE
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../IOEDefines.h"
+#include "../IOEPlatformStatics_PlatformBase.h"
+
+namespace IOE
+{
+namespace Core
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// The base class already splits paths with '/'
+	class IOEPlatformStatics_Platform : public IOEPlatformStatics_PlatformBase
+	{
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Core
+} // namespace IOE
@@ -0,0 +1,45 @@
+#pragma once
+
+// Code taken from here:
+// http://www.codeproject.com/Articles/10022/DebugBreak-and-ASSERTs-that-work-always-anywhere
+#include <Windows.h>
+inline void __stdcall PreDebugBreakAnyway()
+{
+	if (IsDebuggerPresent())
+	{
+		// We're running under the debugger.
+		// There's no need to call the inner DebugBreak
+		// placed in the two __try/__catch blocks below,
+		// because the outer DebugBreak will
+		// force a first-chance exception handled in the debugger.
+		return;
+	}
+
+	__try
+	{
+		__try
+		{
+			DebugBreak();
+		}
+		__except (UnhandledExceptionFilter(GetExceptionInformation()))
+		{
+			// You can place the ExitProcess here to emulate work
+			// of the __except block from BaseStartProcess
+			ExitProcess(0);
+		}
+	}
+	__except (EXCEPTION_EXECUTE_HANDLER)
+	{
+		// We'll get here if the user has pushed Cancel (Debug).
+		// The debugger is already attached to our process.
+		// Return to let the outer DebugBreak be called.
+	}
+}
+
+#define DebugBreakAnyway()                                                    \
+	PreDebugBreakAnyway();                                                    \
+	DebugBreak();
+
+// Asserts break through the above rather than the plain __debugbreak
+#undef IOE_DEBUG_BREAK
+#define IOE_DEBUG_BREAK() DebugBreakAnyway()
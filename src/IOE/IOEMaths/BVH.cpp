@@ -0,0 +1,764 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "BVH.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Maths
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		// Relative costs of stepping through a node and of testing an item
+		const float g_fTraversalCost = 1.0f;
+		const float g_fItemCost		 = 1.0f;
+
+		FORCEINLINE float HalfArea(const float *pMin, const float *pMax)
+		{
+			float fX(pMax[0] - pMin[0]);
+			float fY(pMax[1] - pMin[1]);
+			float fZ(pMax[2] - pMin[2]);
+			return fX * fY + fY * fZ + fZ * fX;
+		}
+
+		// Plane tests for one box against the planes in uMask, writing the
+		// planes it straddles to rOutMask
+		FORCEINLINE ECullResult::Enum TestBox(const IOEFrustumPlanes &rPlanes,
+											  const float *pCentre,
+											  const float *pExtent,
+											  std::uint32_t uMask,
+											  std::uint32_t &rOutMask)
+		{
+			rOutMask = 0;
+			for (std::uint32_t uPlane(0); uMask != 0; ++uPlane, uMask >>= 1)
+			{
+				if ((uMask & 1u) == 0)
+				{
+					continue;
+				}
+
+				const float fNX(rPlanes.arrNormalX[uPlane]);
+				const float fNY(rPlanes.arrNormalY[uPlane]);
+				const float fNZ(rPlanes.arrNormalZ[uPlane]);
+
+				const float fDist(fNX * pCentre[0] + fNY * pCentre[1] +
+								  fNZ * pCentre[2] +
+								  rPlanes.arrDistance[uPlane]);
+				const float fRadius(std::abs(fNX) * pExtent[0] +
+									std::abs(fNY) * pExtent[1] +
+									std::abs(fNZ) * pExtent[2]);
+
+				if (fDist < -fRadius)
+				{
+					return ECullResult::Outside;
+				}
+				if (fDist < fRadius)
+				{
+					rOutMask |= 1u << uPlane;
+				}
+			}
+			return rOutMask != 0 ? ECullResult::Intersect
+								 : ECullResult::Inside;
+		}
+
+		struct CullStackEntry
+		{
+			std::uint32_t uNodeIdx;
+			std::uint32_t uPlaneMask;
+		};
+
+		struct ViewStackEntry
+		{
+			std::uint32_t uNodeIdx;
+
+			// Views still to be tested and views that already contain the
+			// whole node
+			std::uint64_t uTestMask;
+			std::uint64_t uAcceptMask;
+
+			// Planes each group of views still straddles
+			std::uint8_t arrPlanes[IOEFrustumSet::ms_uNumGroups];
+		};
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEBVH::IOEBVH()
+		: m_fCost(0.0f)
+		, m_fBuildCost(0.0f)
+		, m_bDirty(false)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEBVH::Build(const IOEAABBArray &rBoxes)
+	{
+		m_arrNodes.clear();
+		m_arrItemBounds.resize(rBoxes.uCount);
+		m_arrItemOrder.resize(rBoxes.uCount);
+		for (std::uint32_t uItem(0); uItem < rBoxes.uCount; ++uItem)
+		{
+			const float arrCentre[3] = {rBoxes.pCentreX[uItem],
+										rBoxes.pCentreY[uItem],
+										rBoxes.pCentreZ[uItem]};
+			const float arrExtent[3] = {rBoxes.pExtentX[uItem],
+										rBoxes.pExtentY[uItem],
+										rBoxes.pExtentZ[uItem]};
+			for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+			{
+				m_arrItemBounds[uItem].arrMin[uAxis] =
+					arrCentre[uAxis] - arrExtent[uAxis];
+				m_arrItemBounds[uItem].arrMax[uAxis] =
+					arrCentre[uAxis] + arrExtent[uAxis];
+			}
+			m_arrItemOrder[uItem] = uItem;
+		}
+
+		m_bDirty = true;
+		Update(0.0f);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEBVH::SetBounds(std::uint32_t uItem, const float *pCentre,
+						   const float *pExtent)
+	{
+		IOE_ASSERT(uItem < GetNumItems(), "BVH: Item out of range");
+
+		Bounds &rBounds(m_arrItemBounds[uItem]);
+		for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+		{
+			rBounds.arrMin[uAxis] = pCentre[uAxis] - pExtent[uAxis];
+			rBounds.arrMax[uAxis] = pCentre[uAxis] + pExtent[uAxis];
+		}
+		m_bDirty = true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEBVH::GetBounds(std::uint32_t uItem, float *pCentre,
+						   float *pExtent) const
+	{
+		IOE_ASSERT(uItem < GetNumItems(), "BVH: Item out of range");
+
+		const Bounds &rBounds(m_arrItemBounds[uItem]);
+		for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+		{
+			pCentre[uAxis] =
+				(rBounds.arrMin[uAxis] + rBounds.arrMax[uAxis]) * 0.5f;
+			pExtent[uAxis] =
+				(rBounds.arrMax[uAxis] - rBounds.arrMin[uAxis]) * 0.5f;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEBVH::Update(float fRebuildRatio /*=1.5f*/)
+	{
+		if (!m_bDirty)
+		{
+			return false;
+		}
+		m_bDirty = false;
+
+		if (!m_arrNodes.empty())
+		{
+			Refit();
+			m_fCost = ComputeCost();
+			if (m_fCost <= m_fBuildCost * fRebuildRatio)
+			{
+				return false;
+			}
+		}
+
+		m_arrNodes.clear();
+		if (m_arrItemOrder.empty())
+		{
+			m_fCost = m_fBuildCost = 0.0f;
+			return true;
+		}
+
+		m_arrNodes.reserve(m_arrItemOrder.size() * 2);
+
+		Node tRoot;
+		tRoot.uFirstItem = 0;
+		tRoot.uNumItems	 = static_cast<std::uint32_t>(m_arrItemOrder.size());
+		tRoot.uLeft		 = 0;
+		m_arrNodes.push_back(tRoot);
+
+		std::vector<std::uint32_t> arrPending(1, 0);
+		while (!arrPending.empty())
+		{
+			std::uint32_t uNodeIdx(arrPending.back());
+			arrPending.pop_back();
+
+			BuildRange(uNodeIdx);
+
+			const std::uint32_t uLeft(m_arrNodes[uNodeIdx].uLeft);
+			if (uLeft != 0)
+			{
+				arrPending.push_back(uLeft);
+				arrPending.push_back(uLeft + 1);
+			}
+		}
+
+		m_fCost = m_fBuildCost = ComputeCost();
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEBVH::BuildRange(std::uint32_t uNodeIdx)
+	{
+		const std::uint32_t uFirst(m_arrNodes[uNodeIdx].uFirstItem);
+		const std::uint32_t uCount(m_arrNodes[uNodeIdx].uNumItems);
+
+		const Bounds tBounds(GetRangeBounds(uFirst, uCount));
+		SetNodeBounds(m_arrNodes[uNodeIdx], tBounds);
+
+		if (uCount <= ms_uMaxLeafSize)
+		{
+			return;
+		}
+
+		// Bin the item centres along each axis and sweep for the split with
+		// the lowest surface area cost
+		float arrCentreMin[3], arrCentreMax[3];
+		for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+		{
+			arrCentreMin[uAxis] = std::numeric_limits<float>::max();
+			arrCentreMax[uAxis] = -std::numeric_limits<float>::max();
+		}
+		for (std::uint32_t uIdx(uFirst); uIdx < uFirst + uCount; ++uIdx)
+		{
+			const Bounds &rItem(m_arrItemBounds[m_arrItemOrder[uIdx]]);
+			for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+			{
+				float fCentre(
+					(rItem.arrMin[uAxis] + rItem.arrMax[uAxis]) * 0.5f);
+				arrCentreMin[uAxis] = std::min(arrCentreMin[uAxis], fCentre);
+				arrCentreMax[uAxis] = std::max(arrCentreMax[uAxis], fCentre);
+			}
+		}
+
+		float fBestCost(std::numeric_limits<float>::max());
+		std::uint32_t uBestAxis(3);
+		std::uint32_t uBestSplit(0);
+
+		for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+		{
+			const float fRange(arrCentreMax[uAxis] - arrCentreMin[uAxis]);
+			if (fRange <= 0.0f)
+			{
+				continue;
+			}
+			const float fScale(ms_uNumBins / fRange);
+
+			Bounds arrBins[ms_uNumBins];
+			std::uint32_t arrCounts[ms_uNumBins] = {};
+			for (std::uint32_t uBin(0); uBin < ms_uNumBins; ++uBin)
+			{
+				for (std::uint32_t uDim(0); uDim < 3; ++uDim)
+				{
+					arrBins[uBin].arrMin[uDim] =
+						std::numeric_limits<float>::max();
+					arrBins[uBin].arrMax[uDim] =
+						-std::numeric_limits<float>::max();
+				}
+			}
+
+			for (std::uint32_t uIdx(uFirst); uIdx < uFirst + uCount; ++uIdx)
+			{
+				const Bounds &rItem(m_arrItemBounds[m_arrItemOrder[uIdx]]);
+				float fCentre(
+					(rItem.arrMin[uAxis] + rItem.arrMax[uAxis]) * 0.5f);
+				std::uint32_t uBin(std::min(
+					static_cast<std::uint32_t>((fCentre - arrCentreMin[uAxis]) *
+											   fScale),
+					ms_uNumBins - 1));
+
+				++arrCounts[uBin];
+				for (std::uint32_t uDim(0); uDim < 3; ++uDim)
+				{
+					arrBins[uBin].arrMin[uDim] =
+						std::min(arrBins[uBin].arrMin[uDim],
+								 rItem.arrMin[uDim]);
+					arrBins[uBin].arrMax[uDim] =
+						std::max(arrBins[uBin].arrMax[uDim],
+								 rItem.arrMax[uDim]);
+				}
+			}
+
+			// Right to left sweep of the area and count above each split
+			float arrRightCost[ms_uNumBins];
+			Bounds tAccum(arrBins[ms_uNumBins - 1]);
+			std::uint32_t uAccumCount(arrCounts[ms_uNumBins - 1]);
+			for (std::uint32_t uBin(ms_uNumBins - 1); uBin > 0; --uBin)
+			{
+				arrRightCost[uBin] =
+					uAccumCount > 0
+						? HalfArea(tAccum.arrMin, tAccum.arrMax) * uAccumCount
+						: 0.0f;
+				for (std::uint32_t uDim(0); uDim < 3; ++uDim)
+				{
+					tAccum.arrMin[uDim] =
+						std::min(tAccum.arrMin[uDim],
+								 arrBins[uBin - 1].arrMin[uDim]);
+					tAccum.arrMax[uDim] =
+						std::max(tAccum.arrMax[uDim],
+								 arrBins[uBin - 1].arrMax[uDim]);
+				}
+				uAccumCount += arrCounts[uBin - 1];
+			}
+
+			tAccum		= arrBins[0];
+			uAccumCount = arrCounts[0];
+			for (std::uint32_t uSplit(1); uSplit < ms_uNumBins; ++uSplit)
+			{
+				float fCost(
+					(uAccumCount > 0
+						 ? HalfArea(tAccum.arrMin, tAccum.arrMax) * uAccumCount
+						 : 0.0f) +
+					arrRightCost[uSplit]);
+				if (uAccumCount > 0 && uAccumCount < uCount &&
+					fCost < fBestCost)
+				{
+					fBestCost  = fCost;
+					uBestAxis  = uAxis;
+					uBestSplit = uSplit;
+				}
+
+				for (std::uint32_t uDim(0); uDim < 3; ++uDim)
+				{
+					tAccum.arrMin[uDim] =
+						std::min(tAccum.arrMin[uDim],
+								 arrBins[uSplit].arrMin[uDim]);
+					tAccum.arrMax[uDim] =
+						std::max(tAccum.arrMax[uDim],
+								 arrBins[uSplit].arrMax[uDim]);
+				}
+				uAccumCount += arrCounts[uSplit];
+			}
+		}
+
+		std::uint32_t uNumLeft(uCount / 2);
+		if (uBestAxis < 3)
+		{
+			const float fMin(arrCentreMin[uBestAxis]);
+			const float fScale(
+				ms_uNumBins / (arrCentreMax[uBestAxis] - fMin));
+			const std::vector<Bounds> &rItems(m_arrItemBounds);
+
+			auto itMiddle(std::partition(
+				m_arrItemOrder.begin() + uFirst,
+				m_arrItemOrder.begin() + uFirst + uCount,
+				[&](std::uint32_t uItem) {
+					float fCentre((rItems[uItem].arrMin[uBestAxis] +
+								   rItems[uItem].arrMax[uBestAxis]) *
+								  0.5f);
+					return std::min(static_cast<std::uint32_t>(
+										(fCentre - fMin) * fScale),
+									ms_uNumBins - 1) < uBestSplit;
+				}));
+			uNumLeft = static_cast<std::uint32_t>(
+				itMiddle - (m_arrItemOrder.begin() + uFirst));
+		}
+		// Otherwise every centre coincides and any even split will do
+
+		Node tLeft;
+		tLeft.uFirstItem = uFirst;
+		tLeft.uNumItems	 = uNumLeft;
+		tLeft.uLeft		 = 0;
+
+		Node tRight;
+		tRight.uFirstItem = uFirst + uNumLeft;
+		tRight.uNumItems  = uCount - uNumLeft;
+		tRight.uLeft	  = 0;
+
+		m_arrNodes[uNodeIdx].uLeft =
+			static_cast<std::uint32_t>(m_arrNodes.size());
+		m_arrNodes.push_back(tLeft);
+		m_arrNodes.push_back(tRight);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEBVH::Refit()
+	{
+		// Children always follow their parent, so a reverse walk sees both
+		// children before the node itself
+		for (std::size_t uIdx(m_arrNodes.size()); uIdx-- > 0;)
+		{
+			Node &rNode(m_arrNodes[uIdx]);
+			if (rNode.uLeft == 0)
+			{
+				SetNodeBounds(
+					rNode, GetRangeBounds(rNode.uFirstItem, rNode.uNumItems));
+				continue;
+			}
+
+			const Node &rLeft(m_arrNodes[rNode.uLeft]);
+			const Node &rRight(m_arrNodes[rNode.uLeft + 1]);
+
+			Bounds tBounds;
+			for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+			{
+				tBounds.arrMin[uAxis] =
+					std::min(rLeft.arrCentre[uAxis] - rLeft.arrExtent[uAxis],
+							 rRight.arrCentre[uAxis] - rRight.arrExtent[uAxis]);
+				tBounds.arrMax[uAxis] =
+					std::max(rLeft.arrCentre[uAxis] + rLeft.arrExtent[uAxis],
+							 rRight.arrCentre[uAxis] + rRight.arrExtent[uAxis]);
+			}
+			SetNodeBounds(rNode, tBounds);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	float IOEBVH::ComputeCost() const
+	{
+		if (m_arrNodes.empty())
+		{
+			return 0.0f;
+		}
+
+		float fTotal(0.0f);
+		for (const Node &rNode : m_arrNodes)
+		{
+			const float fArea(4.0f *
+							  (rNode.arrExtent[0] * rNode.arrExtent[1] +
+							   rNode.arrExtent[1] * rNode.arrExtent[2] +
+							   rNode.arrExtent[2] * rNode.arrExtent[0]));
+			fTotal += fArea * (rNode.uLeft != 0
+								   ? g_fTraversalCost
+								   : g_fItemCost * rNode.uNumItems);
+		}
+
+		const Node &rRoot(m_arrNodes[0]);
+		const float fRootArea(4.0f * (rRoot.arrExtent[0] * rRoot.arrExtent[1] +
+									  rRoot.arrExtent[1] * rRoot.arrExtent[2] +
+									  rRoot.arrExtent[2] * rRoot.arrExtent[0]));
+		return fRootArea > 0.0f ? fTotal / fRootArea : 0.0f;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEBVH::SetNodeBounds(Node &rNode, const Bounds &rBounds) const
+	{
+		for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+		{
+			rNode.arrCentre[uAxis] =
+				(rBounds.arrMin[uAxis] + rBounds.arrMax[uAxis]) * 0.5f;
+			rNode.arrExtent[uAxis] =
+				(rBounds.arrMax[uAxis] - rBounds.arrMin[uAxis]) * 0.5f;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEBVH::Bounds IOEBVH::GetRangeBounds(std::uint32_t uFirst,
+										  std::uint32_t uCount) const
+	{
+		Bounds tBounds;
+		for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+		{
+			tBounds.arrMin[uAxis] = std::numeric_limits<float>::max();
+			tBounds.arrMax[uAxis] = -std::numeric_limits<float>::max();
+		}
+
+		for (std::uint32_t uIdx(uFirst); uIdx < uFirst + uCount; ++uIdx)
+		{
+			const Bounds &rItem(m_arrItemBounds[m_arrItemOrder[uIdx]]);
+			for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+			{
+				tBounds.arrMin[uAxis] =
+					std::min(tBounds.arrMin[uAxis], rItem.arrMin[uAxis]);
+				tBounds.arrMax[uAxis] =
+					std::max(tBounds.arrMax[uAxis], rItem.arrMax[uAxis]);
+			}
+		}
+		return tBounds;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEBVH::GetSubtrees(std::uint32_t uMinCount,
+							 std::vector<std::uint32_t> &rRoots) const
+	{
+		rRoots.clear();
+		if (m_arrNodes.empty())
+		{
+			return;
+		}
+
+		// Split the largest subtree until there are enough of them or only
+		// leaves remain, keeping the pieces of similar size
+		rRoots.push_back(0);
+		while (rRoots.size() < uMinCount)
+		{
+			std::size_t uLargest(rRoots.size());
+			std::uint32_t uLargestItems(0);
+			for (std::size_t uIdx(0); uIdx < rRoots.size(); ++uIdx)
+			{
+				const Node &rNode(m_arrNodes[rRoots[uIdx]]);
+				if (rNode.uLeft != 0 && rNode.uNumItems > uLargestItems)
+				{
+					uLargest	  = uIdx;
+					uLargestItems = rNode.uNumItems;
+				}
+			}
+
+			if (uLargest == rRoots.size())
+			{
+				break;
+			}
+
+			const std::uint32_t uLeft(m_arrNodes[rRoots[uLargest]].uLeft);
+			rRoots[uLargest] = uLeft;
+			rRoots.push_back(uLeft + 1);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEBVH::Cull(const IOEFrustumPlanes &rPlanes,
+					  std::uint32_t uPlaneMask,
+					  std::vector<std::uint32_t> &rVisible,
+					  IOEBVHCullStats *pStats /*=nullptr*/) const
+	{
+		CullSubtree(0, rPlanes, uPlaneMask, rVisible, pStats);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEBVH::CullSubtree(std::uint32_t uRootNode,
+							 const IOEFrustumPlanes &rPlanes,
+							 std::uint32_t uPlaneMask,
+							 std::vector<std::uint32_t> &rVisible,
+							 IOEBVHCullStats *pStats /*=nullptr*/) const
+	{
+		IOE_ASSERT(!m_bDirty, "BVH: Update must be called after moving items");
+
+		IOEBVHCullStats tStats;
+		if (m_arrNodes.empty())
+		{
+			if (pStats != nullptr)
+			{
+				*pStats = tStats;
+			}
+			return;
+		}
+
+		std::vector<CullStackEntry> arrStack;
+		arrStack.reserve(64);
+
+		IOE_ASSERT(uRootNode < m_arrNodes.size(), "BVH: Node out of range");
+
+		CullStackEntry tEntry;
+		tEntry.uNodeIdx	  = uRootNode;
+		tEntry.uPlaneMask = uPlaneMask;
+		arrStack.push_back(tEntry);
+
+		while (!arrStack.empty())
+		{
+			tEntry = arrStack.back();
+			arrStack.pop_back();
+
+			const Node &rNode(m_arrNodes[tEntry.uNodeIdx]);
+			++tStats.uNodesVisited;
+
+			std::uint32_t uStraddled(0);
+			const ECullResult::Enum eResult(
+				TestBox(rPlanes, rNode.arrCentre, rNode.arrExtent,
+						tEntry.uPlaneMask, uStraddled));
+
+			if (eResult == ECullResult::Outside)
+			{
+				continue;
+			}
+
+			if (eResult == ECullResult::Inside)
+			{
+				// The whole subtree is one contiguous range of items
+				++tStats.uSubtreesAccepted;
+				rVisible.insert(
+					rVisible.end(),
+					m_arrItemOrder.begin() + rNode.uFirstItem,
+					m_arrItemOrder.begin() + rNode.uFirstItem +
+						rNode.uNumItems);
+				tStats.uItemsVisible += rNode.uNumItems;
+				continue;
+			}
+
+			if (rNode.uLeft != 0)
+			{
+				tEntry.uPlaneMask = uStraddled;
+				tEntry.uNodeIdx	  = rNode.uLeft;
+				arrStack.push_back(tEntry);
+				tEntry.uNodeIdx = rNode.uLeft + 1;
+				arrStack.push_back(tEntry);
+				continue;
+			}
+
+			for (std::uint32_t uIdx(rNode.uFirstItem);
+				 uIdx < rNode.uFirstItem + rNode.uNumItems; ++uIdx)
+			{
+				const std::uint32_t uItem(m_arrItemOrder[uIdx]);
+				const Bounds &rItem(m_arrItemBounds[uItem]);
+
+				float arrCentre[3], arrExtent[3];
+				for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+				{
+					arrCentre[uAxis] =
+						(rItem.arrMin[uAxis] + rItem.arrMax[uAxis]) * 0.5f;
+					arrExtent[uAxis] =
+						(rItem.arrMax[uAxis] - rItem.arrMin[uAxis]) * 0.5f;
+				}
+
+				++tStats.uItemsTested;
+				std::uint32_t uItemStraddled(0);
+				if (TestBox(rPlanes, arrCentre, arrExtent, uStraddled,
+							uItemStraddled) != ECullResult::Outside)
+				{
+					rVisible.push_back(uItem);
+					++tStats.uItemsVisible;
+				}
+			}
+		}
+
+		if (pStats != nullptr)
+		{
+			*pStats = tStats;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEBVH::CullViews(const IOEFrustumSet &rViews,
+						   std::uint64_t uViewMask,
+						   std::vector<std::uint32_t> &rVisible,
+						   std::vector<std::uint64_t> &rViewMasks,
+						   IOEBVHCullStats *pStats /*=nullptr*/) const
+	{
+		IOE_ASSERT(!m_bDirty, "BVH: Update must be called after moving items");
+
+		IOEBVHCullStats tStats;
+		if (m_arrNodes.empty() || uViewMask == 0)
+		{
+			if (pStats != nullptr)
+			{
+				*pStats = tStats;
+			}
+			return;
+		}
+
+		std::vector<ViewStackEntry> arrStack;
+		arrStack.reserve(64);
+
+		ViewStackEntry tEntry;
+		tEntry.uNodeIdx	   = 0;
+		tEntry.uTestMask   = uViewMask;
+		tEntry.uAcceptMask = 0;
+		std::fill(tEntry.arrPlanes,
+				  tEntry.arrPlanes + IOEFrustumSet::ms_uNumGroups,
+				  static_cast<std::uint8_t>(
+					  IOEFrustumPlanes::ms_uAllPlanesMask));
+		arrStack.push_back(tEntry);
+
+		while (!arrStack.empty())
+		{
+			tEntry = arrStack.back();
+			arrStack.pop_back();
+
+			const Node &rNode(m_arrNodes[tEntry.uNodeIdx]);
+			++tStats.uNodesVisited;
+
+			std::uint64_t uInside(0);
+			std::uint8_t arrPlanes[IOEFrustumSet::ms_uNumGroups];
+			const std::uint64_t uTouching(
+				rViews.Classify(rNode.arrCentre, rNode.arrExtent,
+								tEntry.uTestMask, uInside, tEntry.arrPlanes,
+								arrPlanes));
+
+			const std::uint64_t uAccept(tEntry.uAcceptMask | uInside);
+			const std::uint64_t uTest(uTouching & ~uInside);
+
+			if (uTest == 0)
+			{
+				if (uAccept == 0)
+				{
+					continue;
+				}
+
+				// Every remaining view is settled for the whole subtree
+				++tStats.uSubtreesAccepted;
+				rVisible.insert(
+					rVisible.end(),
+					m_arrItemOrder.begin() + rNode.uFirstItem,
+					m_arrItemOrder.begin() + rNode.uFirstItem +
+						rNode.uNumItems);
+				rViewMasks.insert(rViewMasks.end(), rNode.uNumItems, uAccept);
+				tStats.uItemsVisible += rNode.uNumItems;
+				continue;
+			}
+
+			if (rNode.uLeft != 0)
+			{
+				tEntry.uTestMask   = uTest;
+				tEntry.uAcceptMask = uAccept;
+				std::copy(arrPlanes, arrPlanes + IOEFrustumSet::ms_uNumGroups,
+						  tEntry.arrPlanes);
+				tEntry.uNodeIdx = rNode.uLeft;
+				arrStack.push_back(tEntry);
+				tEntry.uNodeIdx = rNode.uLeft + 1;
+				arrStack.push_back(tEntry);
+				continue;
+			}
+
+			for (std::uint32_t uIdx(rNode.uFirstItem);
+				 uIdx < rNode.uFirstItem + rNode.uNumItems; ++uIdx)
+			{
+				const std::uint32_t uItem(m_arrItemOrder[uIdx]);
+				const Bounds &rItem(m_arrItemBounds[uItem]);
+
+				float arrCentre[3], arrExtent[3];
+				for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+				{
+					arrCentre[uAxis] =
+						(rItem.arrMin[uAxis] + rItem.arrMax[uAxis]) * 0.5f;
+					arrExtent[uAxis] =
+						(rItem.arrMax[uAxis] - rItem.arrMin[uAxis]) * 0.5f;
+				}
+
+				++tStats.uItemsTested;
+				std::uint64_t uItemInside(0);
+				const std::uint64_t uItemViews(
+					uAccept | rViews.Classify(arrCentre, arrExtent, uTest,
+											  uItemInside, arrPlanes));
+				if (uItemViews != 0)
+				{
+					rVisible.push_back(uItem);
+					rViewMasks.push_back(uItemViews);
+					++tStats.uItemsVisible;
+				}
+			}
+		}
+
+		if (pStats != nullptr)
+		{
+			*pStats = tStats;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Maths
+} // namespace IOE
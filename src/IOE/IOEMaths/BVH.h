@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <IOE/IOECore/IOEPortable.h>
+
+#include "Frustum.h"
+#include "FrustumSet.h"
+
+//////////////////////////////////////////////////////////////////////////
+// Bounding volume hierarchy over a set of boxes for visibility queries.
+// Built top down with binned SAH splits and refit bottom up when items
+// move, falling back to a rebuild once refits have degraded the tree.
+//
+// Items are reordered so every node covers a contiguous range of them,
+// which lets culling accept a fully inside subtree as one range without
+// visiting its children.
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Maths
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	struct IOEBVHCullStats
+	{
+		IOEBVHCullStats()
+			: uNodesVisited(0)
+			, uSubtreesAccepted(0)
+			, uItemsTested(0)
+			, uItemsVisible(0)
+		{
+		}
+
+		IOEBVHCullStats &operator+=(const IOEBVHCullStats &rhs)
+		{
+			uNodesVisited += rhs.uNodesVisited;
+			uSubtreesAccepted += rhs.uSubtreesAccepted;
+			uItemsTested += rhs.uItemsTested;
+			uItemsVisible += rhs.uItemsVisible;
+			return *this;
+		}
+
+		std::uint32_t uNodesVisited;
+		std::uint32_t uSubtreesAccepted;
+		std::uint32_t uItemsTested;
+		std::uint32_t uItemsVisible;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class IOEBVH
+	{
+	public:
+		static const std::uint32_t ms_uMaxLeafSize = 4;
+		static const std::uint32_t ms_uNumBins	   = 12;
+
+	public:
+		IOEBVH();
+
+	public:
+		// Replaces every item and builds from scratch. Item i keeps index i
+		// in all later calls.
+		void Build(const IOEAABBArray &rBoxes);
+
+		// Moves an item; the tree catches up on the next Update
+		void SetBounds(std::uint32_t uItem, const float *pCentre,
+					   const float *pExtent);
+
+		// Refits if anything moved, rebuilding instead when the SAH cost
+		// has grown past fRebuildRatio times its cost after the last build.
+		// Returns true if the tree was rebuilt.
+		bool Update(float fRebuildRatio = 1.5f);
+
+		// Appends every item that is not fully outside the planes in
+		// uPlaneMask to rVisible, in no particular order
+		void Cull(const IOEFrustumPlanes &rPlanes, std::uint32_t uPlaneMask,
+				  std::vector<std::uint32_t> &rVisible,
+				  IOEBVHCullStats *pStats = nullptr) const;
+
+		// Picks at least uMinCount disjoint subtrees covering every item,
+		// fewer if the tree runs out of interior nodes, so a cull can be
+		// split into independent pieces
+		void GetSubtrees(std::uint32_t uMinCount,
+						 std::vector<std::uint32_t> &rRoots) const;
+
+		// Cull restricted to the items below one node from GetSubtrees.
+		// Calls on disjoint subtrees may run concurrently.
+		void CullSubtree(std::uint32_t uRootNode,
+						 const IOEFrustumPlanes &rPlanes,
+						 std::uint32_t uPlaneMask,
+						 std::vector<std::uint32_t> &rVisible,
+						 IOEBVHCullStats *pStats = nullptr) const;
+
+		// Culls against every view in uViewMask in one traversal. Each item
+		// visible in at least one view is appended to rVisible with the
+		// views that see it in the matching entry of rViewMasks. A node
+		// drops the views it is outside of and settles those it is fully
+		// inside, so its children only test the views still undecided.
+		void CullViews(const IOEFrustumSet &rViews, std::uint64_t uViewMask,
+					   std::vector<std::uint32_t> &rVisible,
+					   std::vector<std::uint64_t> &rViewMasks,
+					   IOEBVHCullStats *pStats = nullptr) const;
+
+		// Current bounds of one item, as last given to Build or SetBounds
+		void GetBounds(std::uint32_t uItem, float *pCentre,
+					   float *pExtent) const;
+
+		FORCEINLINE std::uint32_t GetNumItems() const
+		{
+			return static_cast<std::uint32_t>(m_arrItemBounds.size());
+		}
+		FORCEINLINE std::uint32_t GetNumNodes() const
+		{
+			return static_cast<std::uint32_t>(m_arrNodes.size());
+		}
+
+		// Expected cost of a query relative to testing the root alone
+		FORCEINLINE float GetCost() const
+		{
+			return m_fCost;
+		}
+
+	private:
+		struct Bounds
+		{
+			float arrMin[3];
+			float arrMax[3];
+		};
+
+		struct Node
+		{
+			float arrCentre[3];
+			float arrExtent[3];
+
+			// Range of m_arrItemOrder covered by the subtree
+			std::uint32_t uFirstItem;
+			std::uint32_t uNumItems;
+
+			// Index of the left child, the right follows it. Zero marks a
+			// leaf as the root is never a child.
+			std::uint32_t uLeft;
+		};
+
+	private:
+		void BuildRange(std::uint32_t uNodeIdx);
+		void Refit();
+		float ComputeCost() const;
+
+		void SetNodeBounds(Node &rNode, const Bounds &rBounds) const;
+		Bounds GetRangeBounds(std::uint32_t uFirst, std::uint32_t uCount) const;
+
+	private:
+		std::vector<Node> m_arrNodes;
+		std::vector<Bounds> m_arrItemBounds;
+		std::vector<std::uint32_t> m_arrItemOrder;
+
+		float m_fCost;
+		float m_fBuildCost;
+		bool m_bDirty;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Maths
+} // namespace IOE
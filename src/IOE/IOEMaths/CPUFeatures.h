@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+#include <IOE/IOECore/IOEPortable.h>
+
+//////////////////////////////////////////////////////////////////////////
+// Run time checks for the instruction sets beyond SSE2 that are used when
+// the CPU has them. MSVC emits any intrinsic in any function, whereas GCC
+// and Clang only do so in functions marked with the matching target.
+//////////////////////////////////////////////////////////////////////////
+
+#if defined(_MSC_VER)
+#define IOE_TARGET_AVX
+#define IOE_TARGET_F16C
+#else
+#define IOE_TARGET_AVX __attribute__((target("avx")))
+#define IOE_TARGET_F16C __attribute__((target("avx,f16c")))
+#endif
+
+namespace IOE
+{
+namespace Maths
+{
+namespace CPUFeatures
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace Detail
+	{
+		// ECX of CPUID leaf 1
+		FORCEINLINE std::uint32_t GetLeaf1ECX()
+		{
+#if defined(_MSC_VER)
+			int arrInfo[4];
+			__cpuid(arrInfo, 1);
+			return static_cast<std::uint32_t>(arrInfo[2]);
+#else
+			unsigned int uEAX(0), uEBX(0), uECX(0), uEDX(0);
+			return __get_cpuid(1, &uEAX, &uEBX, &uECX, &uEDX) != 0 ? uECX
+																   : 0;
+#endif
+		}
+
+		// Whether the OS saves the xmm and ymm registers, only to be asked
+		// once CPUID reports OSXSAVE
+		FORCEINLINE bool IsYMMStateSaved()
+		{
+#if defined(_MSC_VER)
+			return (_xgetbv(0) & 0x6) == 0x6;
+#else
+			std::uint32_t uLow(0), uHigh(0);
+			__asm__ volatile("xgetbv" : "=a"(uLow), "=d"(uHigh) : "c"(0));
+			return (uLow & 0x6) == 0x6;
+#endif
+		}
+	} // namespace Detail
+
+	//////////////////////////////////////////////////////////////////////////
+
+	inline bool HasAVX()
+	{
+		const std::uint32_t uECX(Detail::GetLeaf1ECX());
+		const bool bAVX((uECX & (1u << 28)) != 0);
+		const bool bOSXSave((uECX & (1u << 27)) != 0);
+		return bAVX && bOSXSave && Detail::IsYMMStateSaved();
+	}
+
+	// F16C is VEX encoded, so it also needs the OS to support AVX
+	inline bool HasF16C()
+	{
+		return (Detail::GetLeaf1ECX() & (1u << 29)) != 0 && HasAVX();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace CPUFeatures
+} // namespace Maths
+} // namespace IOE
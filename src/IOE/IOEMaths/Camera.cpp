@@ -1,3 +1,5 @@
+#include <cstring>
+
 #include "Camera.h"
 #include <IOE/IOEApplication/IOEApplication.h>
 #include <IOE/IOECore/IOEEngine.h>
@@ -23,6 +25,8 @@ namespace Maths
 		m_mInvViewMatrix	   = g_mIdentity;
 		m_mProjectionMatrix	   = g_mIdentity;
 		m_mInvProjectionMatrix = g_mIdentity;
+
+		m_arrWorldOrigin[0] = m_arrWorldOrigin[1] = m_arrWorldOrigin[2] = 0.0;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -110,6 +114,11 @@ namespace Maths
 		}
 
 		m_mInvProjectionMatrix = m_mProjectionMatrix.Inverse();
+
+		XMFLOAT4X4 tViewProjection;
+		XMStoreFloat4x4(&tViewProjection,
+						(m_mViewMatrix * m_mProjectionMatrix).GetRaw());
+		m_tFrustumPlanes.SetFromViewProjection(&tViewProjection.m[0][0]);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -142,6 +151,33 @@ namespace Maths
 
 	//////////////////////////////////////////////////////////////////////////
 
+	void IOECamera::GetViewProjection(float *pMatrix) const
+	{
+		XMFLOAT4X4 tViewProjection;
+		XMStoreFloat4x4(&tViewProjection,
+						(m_mViewMatrix * m_mProjectionMatrix).GetRaw());
+		std::memcpy(pMatrix, &tViewProjection.m[0][0],
+					sizeof(tViewProjection));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	const IOEFrustumPlanes &IOECamera::GetFrustumPlanes() const
+	{
+		return m_tFrustumPlanes;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEVector IOECamera::GetFrustumPlane(EFrustumPlane::Enum ePlane) const
+	{
+		float fX, fY, fZ, fD;
+		m_tFrustumPlanes.GetPlane(ePlane, fX, fY, fZ, fD);
+		return IOEVector(fX, fY, fZ, fD);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 	void IOECamera::SetCameraStyle(ECameraStyle nStyle)
 	{
 		m_nCameraStyle = nStyle;
@@ -184,6 +220,52 @@ namespace Maths
 
 	//////////////////////////////////////////////////////////////////////////
 
+	IOEVectorD IOECamera::GetWorldOrigin() const
+	{
+		return IOEVectorD::Load3(m_arrWorldOrigin);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOECamera::SetWorldOrigin(const IOEVectorD &vOrigin)
+	{
+		vOrigin.Store3(m_arrWorldOrigin);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEVectorD IOECamera::GetWorldPosition() const
+	{
+		return IOEVectorD::Load3(m_arrWorldOrigin, 0.0) +
+			   IOEVectorD(m_tTransform.GetTranslation());
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOECamera::RecentreWorldOrigin(float fMaxDistance,
+										IOEVector *pShift /*=nullptr*/)
+	{
+		IOEVector vShift(m_tTransform.GetTranslation());
+		vShift.SetW(0.0f);
+		if (vShift.GetLengthSq() <= fMaxDistance * fMaxDistance)
+		{
+			return false;
+		}
+
+		SetWorldOrigin(GetWorldOrigin() + IOEVectorD(vShift));
+		m_tTransform.SetTranslation(m_tTransform.GetTranslation() - vShift);
+		m_vLookAtVec -= vShift;
+		UpdateViewMatrices();
+
+		if (pShift != nullptr)
+		{
+			*pShift = vShift;
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 	void IOECamera::SetCameraProperties(CCameraProperties tProperties)
 	{
 		m_tParams = tProperties;
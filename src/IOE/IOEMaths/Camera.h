@@ -5,9 +5,11 @@
 
 #include <IOE/IOECore/IOEHighResolutionTime.h>
 
+#include "Frustum.h"
 #include "Vector.h"
 #include "Matrix.h"
 #include "Transform.h"
+#include "VectorD.h"
 #include "Math.h"
 
 using std::weak_ptr;
@@ -106,9 +108,31 @@ namespace Maths
 		const IOEMatrix& GetProjectionMatrix() const;
 		const IOEMatrix& GetInvProjectionMatrix() const;
 
+		// Row major view * projection in the row-vector convention used by
+		// IOEMatrix, as the frustum planes are built from
+		void GetViewProjection(float* pMatrix) const;
+
+		// World space planes, refreshed by UpdateViewMatrices
+		const IOEFrustumPlanes& GetFrustumPlanes() const;
+		IOEVector GetFrustumPlane(EFrustumPlane::Enum ePlane) const;
+
 		const IOETransform& GetTransform() const;
 		IOETransform& GetTransform();
 
+		// The camera's transform and matrices are relative to a double
+		// precision world origin. Models are rebased against it so large
+		// worlds render without float precision loss near the camera.
+		IOEVectorD GetWorldOrigin() const;
+		void SetWorldOrigin(const IOEVectorD& vOrigin);
+		IOEVectorD GetWorldPosition() const;
+
+		// Moves the world origin onto the camera once it has drifted more
+		// than fMaxDistance away, leaving the view unchanged. Anything else
+		// held relative to the origin, such as the target, must be moved by
+		// the returned shift. Returns true if the origin moved.
+		bool RecentreWorldOrigin(float fMaxDistance,
+								 IOEVector* pShift = nullptr);
+
 		IOEVector ScreenSpaceDirToWorldSpaceDir(int32_t nX, int32_t nY) const;
 
 	private:
@@ -120,11 +144,15 @@ namespace Maths
 		IOEMatrix m_mProjectionMatrix;
 		IOEMatrix m_mInvProjectionMatrix;
 
+		IOEFrustumPlanes m_tFrustumPlanes;
+
 		IOEVector m_vUpVector;
 		IOEVector m_vLookAtVec;
 
 		IOETransform* m_pTarget;
 
+		double m_arrWorldOrigin[3];
+
 		CCameraProperties m_tParams;
 
 		ECameraStyle m_nCameraStyle;
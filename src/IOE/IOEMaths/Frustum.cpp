@@ -0,0 +1,521 @@
+#include <cmath>
+#include <cstring>
+
+#include <emmintrin.h>
+
+#include "Frustum.h"
+
+namespace IOE
+{
+namespace Maths
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	static const std::uint32_t s_uPacketWidth = 4;
+	static const std::uint32_t s_uNumPackets  = 2;
+	static const std::uint32_t s_uBlockWidth  = s_uPacketWidth * s_uNumPackets;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Padded copy of the final partial block so the kernel never reads past
+	// the end of the caller's arrays
+	struct alignas(16) AABBTailBlock
+	{
+		float arrCentreX[s_uBlockWidth];
+		float arrCentreY[s_uBlockWidth];
+		float arrCentreZ[s_uBlockWidth];
+		float arrExtentX[s_uBlockWidth];
+		float arrExtentY[s_uBlockWidth];
+		float arrExtentZ[s_uBlockWidth];
+		std::uint8_t arrInMasks[s_uBlockWidth];
+		std::uint8_t arrCoherentPlanes[s_uBlockWidth];
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Inputs of one block of s_uBlockWidth boxes
+	struct AABBBlock
+	{
+		IOEAABBArray tBoxes;
+		const std::uint8_t *pInMasks;
+		const std::uint8_t *pCoherentPlanes;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Widens four bytes to four 32 bit lanes
+	static FORCEINLINE __m128i LoadBytes(const std::uint8_t *pBytes)
+	{
+		std::int32_t nPacked;
+		std::memcpy(&nPacked, pBytes, sizeof(nPacked));
+
+		__m128i vZero(_mm_setzero_si128());
+		__m128i vBytes(_mm_cvtsi32_si128(nPacked));
+		return _mm_unpacklo_epi16(_mm_unpacklo_epi8(vBytes, vZero), vZero);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Signed distance of four box centres to a plane and the projected radius
+	// of their extents onto the plane normal
+	static FORCEINLINE void PlaneDistance(__m128 vNX, __m128 vNY, __m128 vNZ,
+										  __m128 vD, const IOEAABBArray &rBoxes,
+										  std::uint32_t uBase, __m128 &vDist,
+										  __m128 &vRadius)
+	{
+		const __m128 vAbsMask(_mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+
+		vDist = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(vNX, _mm_loadu_ps(rBoxes.pCentreX + uBase)),
+					   _mm_mul_ps(vNY, _mm_loadu_ps(rBoxes.pCentreY + uBase))),
+			_mm_add_ps(_mm_mul_ps(vNZ, _mm_loadu_ps(rBoxes.pCentreZ + uBase)),
+					   vD));
+		vRadius = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(_mm_and_ps(vNX, vAbsMask),
+								  _mm_loadu_ps(rBoxes.pExtentX + uBase)),
+					   _mm_mul_ps(_mm_and_ps(vNY, vAbsMask),
+								  _mm_loadu_ps(rBoxes.pExtentY + uBase))),
+			_mm_mul_ps(_mm_and_ps(vNZ, vAbsMask),
+					   _mm_loadu_ps(rBoxes.pExtentZ + uBase)));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	static FORCEINLINE std::uint32_t CoherentPlane(std::uint8_t uPlane)
+	{
+		return uPlane < EFrustumPlane::NumPlanes ? uPlane : 0;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	static void ClassifyBlock(const IOEFrustumPlanes &rPlanes,
+							  const AABBBlock &rBlock, std::uint32_t uValid,
+							  std::uint32_t uPlaneMask, std::uint8_t *pResults,
+							  std::uint8_t *pOutPlaneMasks,
+							  std::uint8_t *pCoherentPlanes,
+							  std::uint32_t &uNumVisible)
+	{
+		__m128 arrOutside[s_uNumPackets];
+		__m128 arrStraddle[s_uNumPackets];
+		__m128i arrStraddleBits[s_uNumPackets];
+		__m128i arrInMasks[s_uNumPackets];
+		__m128i arrRejectPlane[s_uNumPackets];
+
+		const __m128i vPlaneMask(
+			_mm_set1_epi32(static_cast<std::int32_t>(uPlaneMask)));
+
+		for (std::uint32_t uPacket(0); uPacket < s_uNumPackets; ++uPacket)
+		{
+			arrOutside[uPacket]		 = _mm_setzero_ps();
+			arrStraddle[uPacket]	 = _mm_setzero_ps();
+			arrStraddleBits[uPacket] = _mm_setzero_si128();
+			arrRejectPlane[uPacket]  = _mm_setzero_si128();
+			arrInMasks[uPacket]		 = vPlaneMask;
+			if (rBlock.pInMasks != nullptr)
+			{
+				arrInMasks[uPacket] = _mm_and_si128(
+					vPlaneMask, LoadBytes(rBlock.pInMasks + uPacket * 4));
+			}
+		}
+
+		// Plane coherency: gather each box's cached plane and test it first
+		bool bAllOutside(false);
+		if (rBlock.pCoherentPlanes != nullptr)
+		{
+			bAllOutside = true;
+			for (std::uint32_t uPacket(0); uPacket < s_uNumPackets; ++uPacket)
+			{
+				const std::uint32_t uBase(uPacket * 4);
+				std::uint32_t arrCache[4];
+				for (std::uint32_t uLane(0); uLane < 4; ++uLane)
+				{
+					arrCache[uLane] =
+						CoherentPlane(rBlock.pCoherentPlanes[uBase + uLane]);
+				}
+
+				__m128 vNX(_mm_setr_ps(rPlanes.arrNormalX[arrCache[0]],
+									   rPlanes.arrNormalX[arrCache[1]],
+									   rPlanes.arrNormalX[arrCache[2]],
+									   rPlanes.arrNormalX[arrCache[3]]));
+				__m128 vNY(_mm_setr_ps(rPlanes.arrNormalY[arrCache[0]],
+									   rPlanes.arrNormalY[arrCache[1]],
+									   rPlanes.arrNormalY[arrCache[2]],
+									   rPlanes.arrNormalY[arrCache[3]]));
+				__m128 vNZ(_mm_setr_ps(rPlanes.arrNormalZ[arrCache[0]],
+									   rPlanes.arrNormalZ[arrCache[1]],
+									   rPlanes.arrNormalZ[arrCache[2]],
+									   rPlanes.arrNormalZ[arrCache[3]]));
+				__m128 vD(_mm_setr_ps(rPlanes.arrDistance[arrCache[0]],
+									  rPlanes.arrDistance[arrCache[1]],
+									  rPlanes.arrDistance[arrCache[2]],
+									  rPlanes.arrDistance[arrCache[3]]));
+				__m128i vCachedIdx(_mm_setr_epi32(
+					static_cast<std::int32_t>(arrCache[0]),
+					static_cast<std::int32_t>(arrCache[1]),
+					static_cast<std::int32_t>(arrCache[2]),
+					static_cast<std::int32_t>(arrCache[3])));
+				__m128i vCachedBit(_mm_setr_epi32(
+					1 << arrCache[0], 1 << arrCache[1], 1 << arrCache[2],
+					1 << arrCache[3]));
+
+				__m128 vDist, vRadius;
+				PlaneDistance(vNX, vNY, vNZ, vD, rBlock.tBoxes, uBase, vDist,
+							  vRadius);
+
+				// Only reject on planes this box is actually tested against
+				__m128 vActive(_mm_castsi128_ps(_mm_cmpeq_epi32(
+					_mm_and_si128(arrInMasks[uPacket], vCachedBit),
+					vCachedBit)));
+				arrOutside[uPacket] = _mm_and_ps(
+					vActive, _mm_cmplt_ps(vDist, _mm_sub_ps(_mm_setzero_ps(),
+															vRadius)));
+				arrRejectPlane[uPacket] = _mm_and_si128(
+					_mm_castps_si128(arrOutside[uPacket]), vCachedIdx);
+
+				bAllOutside = bAllOutside &&
+							  _mm_movemask_ps(arrOutside[uPacket]) == 0xf;
+			}
+		}
+
+		for (std::uint32_t uPlane(0);
+			 uPlane < EFrustumPlane::NumPlanes && !bAllOutside; ++uPlane)
+		{
+			const std::uint32_t uPlaneBit(1u << uPlane);
+			if ((uPlaneMask & uPlaneBit) == 0)
+			{
+				continue;
+			}
+
+			const __m128 vNX(_mm_set1_ps(rPlanes.arrNormalX[uPlane]));
+			const __m128 vNY(_mm_set1_ps(rPlanes.arrNormalY[uPlane]));
+			const __m128 vNZ(_mm_set1_ps(rPlanes.arrNormalZ[uPlane]));
+			const __m128 vD(_mm_set1_ps(rPlanes.arrDistance[uPlane]));
+			const __m128i vPlaneBit(
+				_mm_set1_epi32(static_cast<std::int32_t>(uPlaneBit)));
+			const __m128i vPlaneIdx(
+				_mm_set1_epi32(static_cast<std::int32_t>(uPlane)));
+
+			bAllOutside = true;
+			for (std::uint32_t uPacket(0); uPacket < s_uNumPackets; ++uPacket)
+			{
+				__m128 vDist, vRadius;
+				PlaneDistance(vNX, vNY, vNZ, vD, rBlock.tBoxes, uPacket * 4,
+							  vDist, vRadius);
+
+				// Lanes whose mask excludes this plane are inside it
+				__m128 vActive(_mm_castsi128_ps(_mm_cmpeq_epi32(
+					_mm_and_si128(arrInMasks[uPacket], vPlaneBit), vPlaneBit)));
+
+				__m128 vOutside(_mm_and_ps(
+					vActive, _mm_cmplt_ps(vDist, _mm_sub_ps(_mm_setzero_ps(),
+															vRadius))));
+				__m128 vStraddle(
+					_mm_and_ps(vActive, _mm_cmplt_ps(vDist, vRadius)));
+
+				__m128 vNewlyOutside(
+					_mm_andnot_ps(arrOutside[uPacket], vOutside));
+				arrRejectPlane[uPacket] = _mm_or_si128(
+					arrRejectPlane[uPacket],
+					_mm_and_si128(_mm_castps_si128(vNewlyOutside), vPlaneIdx));
+
+				arrOutside[uPacket] = _mm_or_ps(arrOutside[uPacket], vOutside);
+				arrStraddle[uPacket] =
+					_mm_or_ps(arrStraddle[uPacket], vStraddle);
+				arrStraddleBits[uPacket] = _mm_or_si128(
+					arrStraddleBits[uPacket],
+					_mm_and_si128(_mm_castps_si128(vStraddle), vPlaneBit));
+
+				bAllOutside = bAllOutside &&
+							  _mm_movemask_ps(arrOutside[uPacket]) == 0xf;
+			}
+		}
+
+		for (std::uint32_t uPacket(0); uPacket < s_uNumPackets; ++uPacket)
+		{
+			const std::int32_t nOutside(_mm_movemask_ps(arrOutside[uPacket]));
+			const std::int32_t nStraddle(
+				_mm_movemask_ps(arrStraddle[uPacket]));
+
+			alignas(16) std::int32_t arrBits[4];
+			alignas(16) std::int32_t arrReject[4];
+			_mm_store_si128(reinterpret_cast<__m128i *>(arrBits),
+							arrStraddleBits[uPacket]);
+			_mm_store_si128(reinterpret_cast<__m128i *>(arrReject),
+							arrRejectPlane[uPacket]);
+
+			for (std::uint32_t uLane(0); uLane < 4; ++uLane)
+			{
+				const std::uint32_t uIdx(uPacket * 4 + uLane);
+				if (uIdx >= uValid)
+				{
+					return;
+				}
+
+				ECullResult::Enum eResult(ECullResult::Inside);
+				if ((nOutside >> uLane) & 1)
+				{
+					eResult = ECullResult::Outside;
+					if (pCoherentPlanes != nullptr)
+					{
+						pCoherentPlanes[uIdx] =
+							static_cast<std::uint8_t>(arrReject[uLane]);
+					}
+				}
+				else
+				{
+					if ((nStraddle >> uLane) & 1)
+					{
+						eResult = ECullResult::Intersect;
+					}
+					++uNumVisible;
+				}
+
+				pResults[uIdx] = eResult;
+				if (pOutPlaneMasks != nullptr)
+				{
+					pOutPlaneMasks[uIdx] =
+						static_cast<std::uint8_t>(arrBits[uLane]);
+				}
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEFrustumPlanes::IOEFrustumPlanes()
+	{
+		for (std::uint32_t uPlane(0); uPlane < EFrustumPlane::NumPlanes;
+			 ++uPlane)
+		{
+			arrNormalX[uPlane]  = 0.0f;
+			arrNormalY[uPlane]  = 0.0f;
+			arrNormalZ[uPlane]  = 0.0f;
+			arrDistance[uPlane] = 0.0f;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEFrustumPlanes::SetPlane(EFrustumPlane::Enum ePlane, float fX,
+									float fY, float fZ, float fD)
+	{
+		float fLength(std::sqrt(fX * fX + fY * fY + fZ * fZ));
+		float fInvLength(fLength > 0.0f ? 1.0f / fLength : 0.0f);
+
+		arrNormalX[ePlane]  = fX * fInvLength;
+		arrNormalY[ePlane]  = fY * fInvLength;
+		arrNormalZ[ePlane]  = fZ * fInvLength;
+		arrDistance[ePlane] = fD * fInvLength;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEFrustumPlanes::GetPlane(EFrustumPlane::Enum ePlane, float &fX,
+									float &fY, float &fZ, float &fD) const
+	{
+		fX = arrNormalX[ePlane];
+		fY = arrNormalY[ePlane];
+		fZ = arrNormalZ[ePlane];
+		fD = arrDistance[ePlane];
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEFrustumPlanes::SetFromViewProjection(const float *pMatrix)
+	{
+		// Gribb/Hartmann: with clip = p * M the planes are sums of the
+		// matrix columns
+		auto Column = [pMatrix](std::uint32_t uCol, std::uint32_t uRow) {
+			return pMatrix[uRow * 4 + uCol];
+		};
+
+		for (std::uint32_t uPlane(0); uPlane < EFrustumPlane::NumPlanes;
+			 ++uPlane)
+		{
+			float arrPlane[4];
+			for (std::uint32_t uRow(0); uRow < 4; ++uRow)
+			{
+				float fW(Column(3, uRow));
+				switch (uPlane)
+				{
+				case EFrustumPlane::Left:
+					arrPlane[uRow] = fW + Column(0, uRow);
+					break;
+				case EFrustumPlane::Right:
+					arrPlane[uRow] = fW - Column(0, uRow);
+					break;
+				case EFrustumPlane::Bottom:
+					arrPlane[uRow] = fW + Column(1, uRow);
+					break;
+				case EFrustumPlane::Top:
+					arrPlane[uRow] = fW - Column(1, uRow);
+					break;
+				case EFrustumPlane::Near:
+					arrPlane[uRow] = Column(2, uRow);
+					break;
+				default:
+					arrPlane[uRow] = fW - Column(2, uRow);
+					break;
+				}
+			}
+
+			SetPlane(static_cast<EFrustumPlane::Enum>(uPlane), arrPlane[0],
+					 arrPlane[1], arrPlane[2], arrPlane[3]);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEFrustumPlanes::Offset(float fX, float fY, float fZ)
+	{
+		// n.(p + t) + d = n.p + (d + n.t)
+		for (std::uint32_t uPlane(0); uPlane < EFrustumPlane::NumPlanes;
+			 ++uPlane)
+		{
+			arrDistance[uPlane] += arrNormalX[uPlane] * fX +
+								   arrNormalY[uPlane] * fY +
+								   arrNormalZ[uPlane] * fZ;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEFrustumPlanes::operator==(const IOEFrustumPlanes &rhs) const
+	{
+		for (std::uint32_t uPlane(0); uPlane < EFrustumPlane::NumPlanes;
+			 ++uPlane)
+		{
+			if (arrNormalX[uPlane] != rhs.arrNormalX[uPlane] ||
+				arrNormalY[uPlane] != rhs.arrNormalY[uPlane] ||
+				arrNormalZ[uPlane] != rhs.arrNormalZ[uPlane] ||
+				arrDistance[uPlane] != rhs.arrDistance[uPlane])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t CullAABBArray(const IOEFrustumPlanes &rPlanes,
+								const IOEAABBArray &rBoxes,
+								std::uint8_t *pResults,
+								const IOEFrustumCullOptions &rOptions
+								/*=IOEFrustumCullOptions()*/)
+	{
+		IOE_ASSERT(pResults != nullptr, "No result array given");
+
+		std::uint32_t uNumVisible(0);
+		std::uint32_t uFirst(0);
+
+		AABBBlock tBlock;
+		for (; uFirst + s_uBlockWidth <= rBoxes.uCount; uFirst += s_uBlockWidth)
+		{
+			tBlock.tBoxes.pCentreX = rBoxes.pCentreX + uFirst;
+			tBlock.tBoxes.pCentreY = rBoxes.pCentreY + uFirst;
+			tBlock.tBoxes.pCentreZ = rBoxes.pCentreZ + uFirst;
+			tBlock.tBoxes.pExtentX = rBoxes.pExtentX + uFirst;
+			tBlock.tBoxes.pExtentY = rBoxes.pExtentY + uFirst;
+			tBlock.tBoxes.pExtentZ = rBoxes.pExtentZ + uFirst;
+			tBlock.pInMasks		   = rOptions.pInPlaneMasks != nullptr
+									 ? rOptions.pInPlaneMasks + uFirst
+									 : nullptr;
+			tBlock.pCoherentPlanes = rOptions.pCoherentPlanes != nullptr
+										 ? rOptions.pCoherentPlanes + uFirst
+										 : nullptr;
+
+			ClassifyBlock(rPlanes, tBlock, s_uBlockWidth, rOptions.uPlaneMask,
+						  pResults + uFirst,
+						  rOptions.pOutPlaneMasks != nullptr
+							  ? rOptions.pOutPlaneMasks + uFirst
+							  : nullptr,
+						  rOptions.pCoherentPlanes != nullptr
+							  ? rOptions.pCoherentPlanes + uFirst
+							  : nullptr,
+						  uNumVisible);
+		}
+
+		const std::uint32_t uValid(rBoxes.uCount - uFirst);
+		if (uValid > 0)
+		{
+			// Pad the tail with empty boxes at the origin; their results are
+			// never written
+			AABBTailBlock tTail;
+			std::memset(&tTail, 0, sizeof(tTail));
+
+			const std::size_t uBytes(sizeof(float) * uValid);
+			std::memcpy(tTail.arrCentreX, rBoxes.pCentreX + uFirst, uBytes);
+			std::memcpy(tTail.arrCentreY, rBoxes.pCentreY + uFirst, uBytes);
+			std::memcpy(tTail.arrCentreZ, rBoxes.pCentreZ + uFirst, uBytes);
+			std::memcpy(tTail.arrExtentX, rBoxes.pExtentX + uFirst, uBytes);
+			std::memcpy(tTail.arrExtentY, rBoxes.pExtentY + uFirst, uBytes);
+			std::memcpy(tTail.arrExtentZ, rBoxes.pExtentZ + uFirst, uBytes);
+
+			tBlock.tBoxes.pCentreX = tTail.arrCentreX;
+			tBlock.tBoxes.pCentreY = tTail.arrCentreY;
+			tBlock.tBoxes.pCentreZ = tTail.arrCentreZ;
+			tBlock.tBoxes.pExtentX = tTail.arrExtentX;
+			tBlock.tBoxes.pExtentY = tTail.arrExtentY;
+			tBlock.tBoxes.pExtentZ = tTail.arrExtentZ;
+			tBlock.pInMasks		   = nullptr;
+			tBlock.pCoherentPlanes = nullptr;
+
+			if (rOptions.pInPlaneMasks != nullptr)
+			{
+				std::memcpy(tTail.arrInMasks, rOptions.pInPlaneMasks + uFirst,
+							uValid);
+				tBlock.pInMasks = tTail.arrInMasks;
+			}
+			if (rOptions.pCoherentPlanes != nullptr)
+			{
+				std::memcpy(tTail.arrCoherentPlanes,
+							rOptions.pCoherentPlanes + uFirst, uValid);
+				tBlock.pCoherentPlanes = tTail.arrCoherentPlanes;
+			}
+
+			ClassifyBlock(rPlanes, tBlock, uValid, rOptions.uPlaneMask,
+						  pResults + uFirst,
+						  rOptions.pOutPlaneMasks != nullptr
+							  ? rOptions.pOutPlaneMasks + uFirst
+							  : nullptr,
+						  rOptions.pCoherentPlanes != nullptr
+							  ? rOptions.pCoherentPlanes + uFirst
+							  : nullptr,
+						  uNumVisible);
+		}
+
+		return uNumVisible;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	ECullResult::Enum CullAABB(const IOEFrustumPlanes &rPlanes,
+							   const float *pCentre, const float *pExtent,
+							   std::uint32_t uPlaneMask
+							   /*=IOEFrustumPlanes::ms_uAllPlanesMask*/,
+							   std::uint8_t *pOutPlaneMask /*=nullptr*/)
+	{
+		IOEAABBArray tBox;
+		tBox.pCentreX = &pCentre[0];
+		tBox.pCentreY = &pCentre[1];
+		tBox.pCentreZ = &pCentre[2];
+		tBox.pExtentX = &pExtent[0];
+		tBox.pExtentY = &pExtent[1];
+		tBox.pExtentZ = &pExtent[2];
+		tBox.uCount   = 1;
+
+		IOEFrustumCullOptions tOptions;
+		tOptions.uPlaneMask		= uPlaneMask;
+		tOptions.pOutPlaneMasks = pOutPlaneMask;
+
+		std::uint8_t uResult(ECullResult::Outside);
+		CullAABBArray(rPlanes, tBox, &uResult, tOptions);
+		return static_cast<ECullResult::Enum>(uResult);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Maths
+} // namespace IOE
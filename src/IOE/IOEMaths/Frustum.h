@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstdint>
+
+#include <IOE/IOECore/IOEPortable.h>
+
+//////////////////////////////////////////////////////////////////////////
+// World space frustum planes and a batch AABB classification kernel. Only
+// SSE2 is used so the kernel runs on any x86 host without a renderer.
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Maths
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace EFrustumPlane
+	{
+		enum Enum
+		{
+			Left,
+			Right,
+			Bottom,
+			Top,
+			Near,
+			Far,
+
+			NumPlanes
+		};
+	} // namespace EFrustumPlane
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace ECullResult
+	{
+		enum Enum : std::uint8_t
+		{
+			Outside,
+			Intersect,
+			Inside,
+		};
+	} // namespace ECullResult
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Planes are stored structure-of-arrays with inward facing unit normals,
+	// so a point p is inside plane i when dot(n_i, p) + d_i >= 0.
+	struct alignas(16) IOEFrustumPlanes
+	{
+		static const std::uint32_t ms_uAllPlanesMask =
+			(1u << EFrustumPlane::NumPlanes) - 1;
+
+		IOEFrustumPlanes();
+
+		void SetPlane(EFrustumPlane::Enum ePlane, float fX, float fY, float fZ,
+					  float fD);
+		void GetPlane(EFrustumPlane::Enum ePlane, float &fX, float &fY,
+					  float &fZ, float &fD) const;
+
+		// Row major view * projection matrix in the row-vector convention
+		// used by IOEMatrix, with a [0, 1] clip space depth range.
+		void SetFromViewProjection(const float *pMatrix);
+
+		// Re-expresses the planes relative to the point (fX, fY, fZ), for
+		// testing boxes stored relative to that point such as model space
+		// bounds of a model placed there
+		void Offset(float fX, float fY, float fZ);
+
+		// Exact comparison, so a view that has not moved compares equal
+		bool operator==(const IOEFrustumPlanes &rhs) const;
+		bool operator!=(const IOEFrustumPlanes &rhs) const
+		{
+			return !(*this == rhs);
+		}
+
+		float arrNormalX[EFrustumPlane::NumPlanes];
+		float arrNormalY[EFrustumPlane::NumPlanes];
+		float arrNormalZ[EFrustumPlane::NumPlanes];
+		float arrDistance[EFrustumPlane::NumPlanes];
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Structure-of-arrays view over uCount boxes given as centre and half
+	// extents. The arrays need no alignment or padding.
+	struct IOEAABBArray
+	{
+		IOEAABBArray()
+			: pCentreX(nullptr)
+			, pCentreY(nullptr)
+			, pCentreZ(nullptr)
+			, pExtentX(nullptr)
+			, pExtentY(nullptr)
+			, pExtentZ(nullptr)
+			, uCount(0)
+		{
+		}
+
+		const float *pCentreX;
+		const float *pCentreY;
+		const float *pCentreZ;
+		const float *pExtentX;
+		const float *pExtentY;
+		const float *pExtentZ;
+		std::uint32_t uCount;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	struct IOEFrustumCullOptions
+	{
+		IOEFrustumCullOptions()
+			: uPlaneMask(IOEFrustumPlanes::ms_uAllPlanesMask)
+			, pInPlaneMasks(nullptr)
+			, pOutPlaneMasks(nullptr)
+			, pCoherentPlanes(nullptr)
+		{
+		}
+
+		// Planes tested for every box; planes outside the mask count as
+		// inside and are skipped entirely
+		std::uint32_t uPlaneMask;
+
+		// Optional per box masks combined with uPlaneMask, normally the
+		// parent's pOutPlaneMasks entry during hierarchical traversal
+		const std::uint8_t *pInPlaneMasks;
+
+		// Optional per box output of the planes the box straddles
+		std::uint8_t *pOutPlaneMasks;
+
+		// Optional per box index of the plane that last rejected the box.
+		// It is tested first and updated in place, so boxes that stay
+		// outside across frames are usually rejected by one plane test.
+		std::uint8_t *pCoherentPlanes;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Classifies 8 boxes per iteration, writing one ECullResult per box to
+	// pResults. Returns the number of boxes that are not outside.
+	std::uint32_t CullAABBArray(
+		const IOEFrustumPlanes &rPlanes, const IOEAABBArray &rBoxes,
+		std::uint8_t *pResults,
+		const IOEFrustumCullOptions &rOptions = IOEFrustumCullOptions());
+
+	// Single box convenience wrapper around CullAABBArray
+	ECullResult::Enum
+	CullAABB(const IOEFrustumPlanes &rPlanes, const float *pCentre,
+			 const float *pExtent,
+			 std::uint32_t uPlaneMask = IOEFrustumPlanes::ms_uAllPlanesMask,
+			 std::uint8_t *pOutPlaneMask = nullptr);
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Maths
+} // namespace IOE
@@ -0,0 +1,213 @@
+#include <cmath>
+#include <cstring>
+
+#include <emmintrin.h>
+
+#include "FrustumSet.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Maths
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		// Distance of an unused plane slot, far enough that any box counts
+		// as inside it
+		const float g_fPassDistance = 1.0e30f;
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEFrustumSet::IOEFrustumSet()
+	{
+		Clear();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEFrustumSet::Clear()
+	{
+		for (std::uint32_t uPlane(0); uPlane < EFrustumPlane::NumPlanes;
+			 ++uPlane)
+		{
+			for (std::uint32_t uView(0); uView < ms_uMaxViews; ++uView)
+			{
+				SetPlane(uPlane, uView, 0.0f, 0.0f, 0.0f, g_fPassDistance);
+			}
+		}
+		m_uNumViews = 0;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t IOEFrustumSet::Add(const IOEFrustumPlanes &rPlanes,
+									 std::uint32_t uPlaneMask /*=all*/)
+	{
+		IOE_ASSERT(m_uNumViews < ms_uMaxViews, "Too many views in set");
+
+		const std::uint32_t uView(m_uNumViews++);
+		for (std::uint32_t uPlane(0); uPlane < EFrustumPlane::NumPlanes;
+			 ++uPlane)
+		{
+			if ((uPlaneMask & (1u << uPlane)) == 0)
+			{
+				SetPlane(uPlane, uView, 0.0f, 0.0f, 0.0f, g_fPassDistance);
+				continue;
+			}
+
+			SetPlane(uPlane, uView, rPlanes.arrNormalX[uPlane],
+					 rPlanes.arrNormalY[uPlane], rPlanes.arrNormalZ[uPlane],
+					 rPlanes.arrDistance[uPlane]);
+		}
+		return uView;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEFrustumSet::operator==(const IOEFrustumSet &rhs) const
+	{
+		if (m_uNumViews != rhs.m_uNumViews)
+		{
+			return false;
+		}
+
+		// The absolute normals follow from the normals
+		const std::size_t uSize(m_uNumViews * sizeof(float));
+		for (std::uint32_t uPlane(0); uPlane < EFrustumPlane::NumPlanes;
+			 ++uPlane)
+		{
+			if (std::memcmp(m_arrNormalX[uPlane], rhs.m_arrNormalX[uPlane],
+							uSize) != 0 ||
+				std::memcmp(m_arrNormalY[uPlane], rhs.m_arrNormalY[uPlane],
+							uSize) != 0 ||
+				std::memcmp(m_arrNormalZ[uPlane], rhs.m_arrNormalZ[uPlane],
+							uSize) != 0 ||
+				std::memcmp(m_arrDistance[uPlane], rhs.m_arrDistance[uPlane],
+							uSize) != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEFrustumSet::SetPlane(std::uint32_t uPlane, std::uint32_t uView,
+								 float fX, float fY, float fZ, float fD)
+	{
+		m_arrNormalX[uPlane][uView]		= fX;
+		m_arrNormalY[uPlane][uView]		= fY;
+		m_arrNormalZ[uPlane][uView]		= fZ;
+		m_arrDistance[uPlane][uView]	= fD;
+		m_arrAbsNormalX[uPlane][uView] = std::abs(fX);
+		m_arrAbsNormalY[uPlane][uView] = std::abs(fY);
+		m_arrAbsNormalZ[uPlane][uView] = std::abs(fZ);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint64_t IOEFrustumSet::Classify(
+		const float *pCentre, const float *pExtent, std::uint64_t uViewMask,
+		std::uint64_t &rInside, const std::uint8_t *pInPlanes /*=nullptr*/,
+		std::uint8_t *pOutPlanes /*=nullptr*/) const
+	{
+		const __m128 vCentreX(_mm_set1_ps(pCentre[0]));
+		const __m128 vCentreY(_mm_set1_ps(pCentre[1]));
+		const __m128 vCentreZ(_mm_set1_ps(pCentre[2]));
+		const __m128 vExtentX(_mm_set1_ps(pExtent[0]));
+		const __m128 vExtentY(_mm_set1_ps(pExtent[1]));
+		const __m128 vExtentZ(_mm_set1_ps(pExtent[2]));
+
+		std::uint64_t uTouching(0);
+		rInside = 0;
+
+		// Groups of four views, skipping any with no requested view
+		for (std::uint32_t uBase(0); uBase < m_uNumViews; uBase += 4)
+		{
+			const std::uint32_t uGroupIdx(uBase / 4);
+			const std::uint64_t uGroup((uViewMask >> uBase) & 0xf);
+			if (pOutPlanes != nullptr)
+			{
+				pOutPlanes[uGroupIdx] = 0;
+			}
+			if (uGroup == 0)
+			{
+				continue;
+			}
+
+			const std::uint32_t uPlaneMask(
+				pInPlanes != nullptr ? pInPlanes[uGroupIdx]
+									 : IOEFrustumPlanes::ms_uAllPlanesMask);
+
+			__m128 vOutside(_mm_setzero_ps());
+			__m128 vStraddle(_mm_setzero_ps());
+			std::uint32_t uStraddledPlanes(0);
+			for (std::uint32_t uPlane(0); uPlane < EFrustumPlane::NumPlanes;
+				 ++uPlane)
+			{
+				if ((uPlaneMask & (1u << uPlane)) == 0)
+				{
+					continue;
+				}
+
+				const __m128 vNX(_mm_loadu_ps(m_arrNormalX[uPlane] + uBase));
+				const __m128 vNY(_mm_loadu_ps(m_arrNormalY[uPlane] + uBase));
+				const __m128 vNZ(_mm_loadu_ps(m_arrNormalZ[uPlane] + uBase));
+				const __m128 vD(_mm_loadu_ps(m_arrDistance[uPlane] + uBase));
+
+				const __m128 vDist(_mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(vNX, vCentreX),
+							   _mm_mul_ps(vNY, vCentreY)),
+					_mm_add_ps(_mm_mul_ps(vNZ, vCentreZ), vD)));
+
+				const __m128 vAbsX(
+					_mm_loadu_ps(m_arrAbsNormalX[uPlane] + uBase));
+				const __m128 vAbsY(
+					_mm_loadu_ps(m_arrAbsNormalY[uPlane] + uBase));
+				const __m128 vAbsZ(
+					_mm_loadu_ps(m_arrAbsNormalZ[uPlane] + uBase));
+				const __m128 vRadius(_mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(vAbsX, vExtentX),
+							   _mm_mul_ps(vAbsY, vExtentY)),
+					_mm_mul_ps(vAbsZ, vExtentZ)));
+
+				// Outside when dist < -radius, straddling when dist < radius
+				const __m128 vNegDist(_mm_sub_ps(_mm_setzero_ps(), vDist));
+				vOutside =
+					_mm_or_ps(vOutside, _mm_cmpgt_ps(vNegDist, vRadius));
+				const __m128 vPlaneStraddle(_mm_cmplt_ps(vDist, vRadius));
+				vStraddle = _mm_or_ps(vStraddle, vPlaneStraddle);
+				if ((_mm_movemask_ps(vPlaneStraddle) & uGroup) != 0)
+				{
+					uStraddledPlanes |= 1u << uPlane;
+				}
+			}
+
+			const std::uint64_t uOutside(
+				static_cast<std::uint64_t>(_mm_movemask_ps(vOutside)));
+			const std::uint64_t uStraddle(
+				static_cast<std::uint64_t>(_mm_movemask_ps(vStraddle)));
+
+			if (pOutPlanes != nullptr)
+			{
+				pOutPlanes[uGroupIdx] =
+					static_cast<std::uint8_t>(uStraddledPlanes);
+			}
+
+			uTouching |= (uGroup & ~uOutside) << uBase;
+			rInside |= (uGroup & ~uStraddle) << uBase;
+		}
+
+		return uTouching;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Maths
+} // namespace IOE
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+
+#include <IOE/IOECore/IOEPortable.h>
+
+#include "Frustum.h"
+
+//////////////////////////////////////////////////////////////////////////
+// Up to 64 views tested together, such as the faces of a cube map, both
+// halves of a paraboloid map and any number of ordinary cameras. Planes
+// are stored per plane slot across views so four views are classified per
+// SSE instruction, and results come back as one bit per view.
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Maths
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class IOEFrustumSet
+	{
+	public:
+		static const std::uint32_t ms_uMaxViews	= 64;
+		static const std::uint32_t ms_uNumGroups = ms_uMaxViews / 4;
+
+	public:
+		IOEFrustumSet();
+
+	public:
+		void Clear();
+
+		// Adds a view tested against the planes in uPlaneMask; the other
+		// slots always pass, so a half space is a single plane view.
+		// Returns the view's bit index.
+		std::uint32_t
+		Add(const IOEFrustumPlanes &rPlanes,
+			std::uint32_t uPlaneMask = IOEFrustumPlanes::ms_uAllPlanesMask);
+
+		FORCEINLINE std::uint32_t GetNumViews() const
+		{
+			return m_uNumViews;
+		}
+
+		// Same views with exactly the same planes
+		bool operator==(const IOEFrustumSet &rhs) const;
+		bool operator!=(const IOEFrustumSet &rhs) const
+		{
+			return !(*this == rhs);
+		}
+
+		FORCEINLINE std::uint64_t GetAllViewsMask() const
+		{
+			return m_uNumViews == ms_uMaxViews
+					   ? ~static_cast<std::uint64_t>(0)
+					   : (static_cast<std::uint64_t>(1) << m_uNumViews) - 1;
+		}
+
+		// Returns the views in uViewMask that the box is not fully outside
+		// of, and writes the subset that contain it entirely to rInside.
+		//
+		// Views are tested in groups of four. pInPlanes optionally limits
+		// the planes tested per group and pOutPlanes receives the planes
+		// each group straddles, so a hierarchy can pass a parent's output
+		// to its children as with IOEFrustumCullOptions. Both hold
+		// ms_uNumGroups entries.
+		std::uint64_t Classify(const float *pCentre, const float *pExtent,
+							   std::uint64_t uViewMask, std::uint64_t &rInside,
+							   const std::uint8_t *pInPlanes = nullptr,
+							   std::uint8_t *pOutPlanes = nullptr) const;
+
+	private:
+		void SetPlane(std::uint32_t uPlane, std::uint32_t uView, float fX,
+					  float fY, float fZ, float fD);
+
+	private:
+		float m_arrNormalX[EFrustumPlane::NumPlanes][ms_uMaxViews];
+		float m_arrNormalY[EFrustumPlane::NumPlanes][ms_uMaxViews];
+		float m_arrNormalZ[EFrustumPlane::NumPlanes][ms_uMaxViews];
+		float m_arrDistance[EFrustumPlane::NumPlanes][ms_uMaxViews];
+
+		// Absolute normals for projecting box extents
+		float m_arrAbsNormalX[EFrustumPlane::NumPlanes][ms_uMaxViews];
+		float m_arrAbsNormalY[EFrustumPlane::NumPlanes][ms_uMaxViews];
+		float m_arrAbsNormalZ[EFrustumPlane::NumPlanes][ms_uMaxViews];
+
+		std::uint32_t m_uNumViews;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Maths
+} // namespace IOE
@@ -0,0 +1,157 @@
+#include <immintrin.h>
+
+#include "CPUFeatures.h"
+#include "LargeWorld.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Maths
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		// Four offsets from a splatted origin, rounded to float
+		FORCEINLINE __m128 RebaseBlock(const double *pData, std::size_t uIdx,
+									   const DoubleSIMD::Double4 &vOrigin)
+		{
+			return DoubleSIMD::ToFloat(
+				DoubleSIMD::Sub(DoubleSIMD::Load(pData + uIdx), vOrigin));
+		}
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IsAVXSupported()
+	{
+		static const bool s_bSupported(CPUFeatures::HasAVX());
+		return s_bSupported;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void RebaseTranslations(const IOEVectorD &vOrigin, const double *pX,
+							const double *pY, const double *pZ, float *pOutX,
+							float *pOutY, float *pOutZ, std::size_t uCount)
+	{
+		double fOriginX, fOriginY, fOriginZ;
+		vOrigin.Get(fOriginX, fOriginY, fOriginZ);
+
+		const DoubleSIMD::Double4 vOriginX(DoubleSIMD::Splat(fOriginX));
+		const DoubleSIMD::Double4 vOriginY(DoubleSIMD::Splat(fOriginY));
+		const DoubleSIMD::Double4 vOriginZ(DoubleSIMD::Splat(fOriginZ));
+
+		const std::size_t uBlocked(uCount & ~static_cast<std::size_t>(3));
+		for (std::size_t uIdx(0); uIdx < uBlocked; uIdx += 4)
+		{
+			_mm_storeu_ps(pOutX + uIdx, RebaseBlock(pX, uIdx, vOriginX));
+			_mm_storeu_ps(pOutY + uIdx, RebaseBlock(pY, uIdx, vOriginY));
+			_mm_storeu_ps(pOutZ + uIdx, RebaseBlock(pZ, uIdx, vOriginZ));
+		}
+
+		for (std::size_t uIdx(uBlocked); uIdx < uCount; ++uIdx)
+		{
+			pOutX[uIdx] = static_cast<float>(pX[uIdx] - fOriginX);
+			pOutY[uIdx] = static_cast<float>(pY[uIdx] - fOriginY);
+			pOutZ[uIdx] = static_cast<float>(pZ[uIdx] - fOriginZ);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEWorldPositionArray::IOEWorldPositionArray()
+	{
+#if (IOE_VECTORD_AVX == IOE_ON)
+		IOE_ASSERT(IsAVXSupported(),
+				   "This build uses AVX for double precision maths");
+#endif
+
+		m_arrOrigin[0] = m_arrOrigin[1] = m_arrOrigin[2] = 0.0;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t IOEWorldPositionArray::Add(const IOEVectorD &vPosition)
+	{
+		double fX, fY, fZ;
+		vPosition.Get(fX, fY, fZ);
+
+		m_arrX.push_back(fX);
+		m_arrY.push_back(fY);
+		m_arrZ.push_back(fZ);
+
+		m_arrRebasedX.push_back(0.0f);
+		m_arrRebasedY.push_back(0.0f);
+		m_arrRebasedZ.push_back(0.0f);
+
+		const std::uint32_t uIdx(GetCount() - 1);
+		RebaseOne(uIdx);
+		return uIdx;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEWorldPositionArray::Set(std::uint32_t uIdx,
+									const IOEVectorD &vPosition)
+	{
+		IOE_ASSERT(uIdx < GetCount(), "World position index out of range");
+
+		vPosition.Get(m_arrX[uIdx], m_arrY[uIdx], m_arrZ[uIdx]);
+		RebaseOne(uIdx);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEVectorD IOEWorldPositionArray::Get(std::uint32_t uIdx) const
+	{
+		IOE_ASSERT(uIdx < GetCount(), "World position index out of range");
+
+		return IOEVectorD(m_arrX[uIdx], m_arrY[uIdx], m_arrZ[uIdx]);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEWorldPositionArray::Rebase(const IOEVectorD &vOrigin)
+	{
+		double arrOrigin[3];
+		vOrigin.Store3(arrOrigin);
+		if (arrOrigin[0] == m_arrOrigin[0] && arrOrigin[1] == m_arrOrigin[1] &&
+			arrOrigin[2] == m_arrOrigin[2])
+		{
+			return false;
+		}
+
+		RebaseTranslations(vOrigin, m_arrX.data(), m_arrY.data(),
+						   m_arrZ.data(), m_arrRebasedX.data(),
+						   m_arrRebasedY.data(), m_arrRebasedZ.data(),
+						   m_arrX.size());
+
+		m_arrOrigin[0] = arrOrigin[0];
+		m_arrOrigin[1] = arrOrigin[1];
+		m_arrOrigin[2] = arrOrigin[2];
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEVectorD IOEWorldPositionArray::GetOrigin() const
+	{
+		return IOEVectorD::Load3(m_arrOrigin);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEWorldPositionArray::RebaseOne(std::uint32_t uIdx)
+	{
+		m_arrRebasedX[uIdx] = static_cast<float>(m_arrX[uIdx] - m_arrOrigin[0]);
+		m_arrRebasedY[uIdx] = static_cast<float>(m_arrY[uIdx] - m_arrOrigin[1]);
+		m_arrRebasedZ[uIdx] = static_cast<float>(m_arrZ[uIdx] - m_arrOrigin[2]);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Maths
+} // namespace IOE
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <IOE/IOECore/IOEDefines.h>
+#include <IOE/IOEMaths/VectorD.h>
+
+//////////////////////////////////////////////////////////////////////////
+// Camera relative rendering for large worlds. World positions are kept in
+// double precision and rebased once per frame, against the main camera's
+// world origin, into float offsets from that origin. The kernels
+// work on structure-of-arrays data four instances at a time so tens of
+// thousands of instances cost well under a millisecond.
+//
+// Models are placed by translation alone, so only translations are
+// rebased; rotation and scale stay in model space.
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Maths
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Builds with /arch:AVX need this to be true; see VectorD.h
+	bool IsAVXSupported();
+
+	// pOut[i] = float(p[i] - vOrigin) per axis. Any alignment is allowed
+	// and the outputs may not alias the inputs.
+	void RebaseTranslations(const IOEVectorD &vOrigin, const double *pX,
+							const double *pY, const double *pZ, float *pOutX,
+							float *pOutY, float *pOutZ, std::size_t uCount);
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Growable set of double precision world positions along with their
+	// float offsets from the last origin they were rebased against. Adding
+	// or moving a position updates its offset straight away.
+	class IOEWorldPositionArray
+	{
+	public:
+		IOEWorldPositionArray();
+
+	public:
+		std::uint32_t Add(const IOEVectorD &vPosition);
+		void Set(std::uint32_t uIdx, const IOEVectorD &vPosition);
+		IOEVectorD Get(std::uint32_t uIdx) const;
+
+		FORCEINLINE std::uint32_t GetCount() const
+		{
+			return static_cast<std::uint32_t>(m_arrX.size());
+		}
+
+		// Recomputes every offset against vOrigin, skipping the pass when
+		// the origin has not changed. Returns true if it ran.
+		bool Rebase(const IOEVectorD &vOrigin);
+
+		// The origin of the last rebase, zero before the first
+		IOEVectorD GetOrigin() const;
+
+		FORCEINLINE void GetRebased(std::uint32_t uIdx, float &fX, float &fY,
+									float &fZ) const
+		{
+			fX = m_arrRebasedX[uIdx];
+			fY = m_arrRebasedY[uIdx];
+			fZ = m_arrRebasedZ[uIdx];
+		}
+
+		FORCEINLINE const float *GetRebasedX() const
+		{
+			return m_arrRebasedX.data();
+		}
+		FORCEINLINE const float *GetRebasedY() const
+		{
+			return m_arrRebasedY.data();
+		}
+		FORCEINLINE const float *GetRebasedZ() const
+		{
+			return m_arrRebasedZ.data();
+		}
+
+	private:
+		void RebaseOne(std::uint32_t uIdx);
+
+	private:
+		std::vector<double> m_arrX;
+		std::vector<double> m_arrY;
+		std::vector<double> m_arrZ;
+
+		std::vector<float> m_arrRebasedX;
+		std::vector<float> m_arrRebasedY;
+		std::vector<float> m_arrRebasedZ;
+
+		double m_arrOrigin[3];
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Maths
+} // namespace IOE
@@ -53,15 +53,20 @@ namespace Maths
 												  float fNear /*=0.0f*/,
 												  float fFar /*=1.0f*/)
 	{
-		std::uint32_t uWidth(0), uHeight(0);
-		IOE::Core::g_pEngine->GetApplication()->GetWindowSize(uWidth, uHeight);
-		if (fWidth == std::numeric_limits<float>::infinity())
+		if (fWidth == std::numeric_limits<float>::infinity() ||
+			fHeight == std::numeric_limits<float>::infinity())
 		{
-			fWidth = static_cast<float>(uWidth);
-		}
-		if (fHeight == std::numeric_limits<float>::infinity())
-		{
-			fHeight = static_cast<float>(uHeight);
+			std::uint32_t uWidth(0), uHeight(0);
+			IOE::Core::g_pEngine->GetApplication()->GetWindowSize(uWidth,
+																  uHeight);
+			if (fWidth == std::numeric_limits<float>::infinity())
+			{
+				fWidth = static_cast<float>(uWidth);
+			}
+			if (fHeight == std::numeric_limits<float>::infinity())
+			{
+				fHeight = static_cast<float>(uHeight);
+			}
 		}
 		return IOEMatrix(XMMatrixOrthographicLH(fWidth, fHeight, fNear, fFar));
 	}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+
+#include <IOE/IOECore/IOEDefines.h>
+#include <IOE/IOEMaths/Matrix.h>
+#include <IOE/IOEMaths/VectorD.h>
+
+//////////////////////////////////////////////////////////////////////////
+// Double precision affine transforms in the same row-vector convention as
+// IOEMatrix, so the translation lives in row 3. Only the placement needs
+// double precision; GetRelativeTo produces the float matrix the renderer
+// consumes once the camera's world origin has been subtracted.
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Maths
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class alignas(32) IOEMatrixD
+	{
+	public:
+		FORCEINLINE IOEMatrixD()
+		{
+		}
+
+		FORCEINLINE IOEMatrixD(const IOEVectorD &vRow0, const IOEVectorD &vRow1,
+							   const IOEVectorD &vRow2, const IOEVectorD &vRow3)
+		{
+			Set(vRow0, vRow1, vRow2, vRow3);
+		}
+
+		FORCEINLINE explicit IOEMatrixD(const IOEMatrix &mMatrix)
+		{
+			for (std::int32_t nRow(0); nRow < 4; ++nRow)
+			{
+				m_arrRows[nRow] =
+					IOEVectorD(IOEVector(mMatrix.GetRaw().r[nRow]));
+			}
+		}
+
+	public:
+		FORCEINLINE void Set(const IOEVectorD &vRow0, const IOEVectorD &vRow1,
+							 const IOEVectorD &vRow2, const IOEVectorD &vRow3)
+		{
+			m_arrRows[0] = vRow0;
+			m_arrRows[1] = vRow1;
+			m_arrRows[2] = vRow2;
+			m_arrRows[3] = vRow3;
+		}
+
+		FORCEINLINE IOEVectorD GetRow(std::int32_t nRowIdx) const
+		{
+			IOE_ASSERT(nRowIdx >= 0 && nRowIdx < 4,
+					   "Row must be between 0 and 4");
+			return m_arrRows[nRowIdx];
+		}
+
+		FORCEINLINE void SetRow(std::int32_t nRowIdx, const IOEVectorD &vRow)
+		{
+			IOE_ASSERT(nRowIdx >= 0 && nRowIdx < 4,
+					   "Row must be between 0 and 4");
+			m_arrRows[nRowIdx] = vRow;
+		}
+
+		FORCEINLINE IOEVectorD GetTranslation() const
+		{
+			return m_arrRows[3];
+		}
+
+		// w is forced to 1 so the matrix stays affine
+		FORCEINLINE void SetTranslation(const IOEVectorD &vTranslation)
+		{
+			double fX, fY, fZ;
+			vTranslation.Get(fX, fY, fZ);
+			m_arrRows[3].Set(fX, fY, fZ, 1.0);
+		}
+
+	public:
+		FORCEINLINE IOEVectorD TransformPoint(const IOEVectorD &vPoint) const
+		{
+			return Transform(vPoint);
+		}
+
+		FORCEINLINE IOEMatrixD Multiply(const IOEMatrixD &rhs) const
+		{
+			IOEMatrixD mResult;
+			for (std::int32_t nRow(0); nRow < 4; ++nRow)
+			{
+				mResult.m_arrRows[nRow] = rhs.Transform(m_arrRows[nRow]);
+			}
+			return mResult;
+		}
+
+		FORCEINLINE IOEMatrixD operator*(const IOEMatrixD &rhs) const
+		{
+			return Multiply(rhs);
+		}
+
+		FORCEINLINE IOEMatrixD &operator*=(const IOEMatrixD &rhs)
+		{
+			*this = Multiply(rhs);
+			return *this;
+		}
+
+		// Float matrix with the translation re-expressed relative to
+		// vOrigin. The subtraction happens before rounding so the result
+		// keeps full float precision near the origin.
+		FORCEINLINE IOEMatrix GetRelativeTo(const IOEVectorD &vOrigin) const
+		{
+			IOEVector vTranslation(
+				GetTranslation().GetRelativeTo(vOrigin));
+			return IOEMatrix(m_arrRows[0].ToFloat(), m_arrRows[1].ToFloat(),
+							 m_arrRows[2].ToFloat(), vTranslation);
+		}
+
+	public:
+		FORCEINLINE static IOEMatrixD Identity()
+		{
+			return IOEMatrixD(IOEVectorD(1.0, 0.0, 0.0, 0.0),
+							  IOEVectorD(0.0, 1.0, 0.0, 0.0),
+							  IOEVectorD(0.0, 0.0, 1.0, 0.0),
+							  IOEVectorD(0.0, 0.0, 0.0, 1.0));
+		}
+
+		FORCEINLINE static IOEMatrixD Translation(
+			const IOEVectorD &vTranslation)
+		{
+			IOEMatrixD mResult(Identity());
+			mResult.SetTranslation(vTranslation);
+			return mResult;
+		}
+
+		// Rotation and scale from a float matrix placed at a double
+		// precision position
+		FORCEINLINE static IOEMatrixD Compose(const IOEMatrix &mRotationScale,
+											  const IOEVectorD &vTranslation)
+		{
+			IOEMatrixD mResult(mRotationScale);
+			mResult.SetTranslation(vTranslation);
+			return mResult;
+		}
+
+	private:
+		// Row vector times this matrix
+		FORCEINLINE IOEVectorD Transform(const IOEVectorD &vRow) const
+		{
+			double fX, fY, fZ, fW;
+			vRow.Get(fX, fY, fZ, fW);
+			return m_arrRows[0] * fX + m_arrRows[1] * fY + m_arrRows[2] * fZ +
+				   m_arrRows[3] * fW;
+		}
+
+	private:
+		IOEVectorD m_arrRows[4];
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Maths
+} // namespace IOE
@@ -0,0 +1,694 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#include <emmintrin.h>
+
+#include <tbb/parallel_for.h>
+
+#include "OcclusionBuffer.h"
+
+namespace IOE
+{
+namespace Maths
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		// Triangles are clipped a little outside the screen so edge
+		// functions stay small without clipping every visible triangle
+		const float g_fGuardBand = 1.5f;
+
+		// A clipped triangle has at most one extra vertex per plane
+		const std::uint32_t g_uNumClipPlanes = 5;
+		const std::uint32_t g_uMaxClipVerts	 = 3 + g_uNumClipPlanes;
+
+		// Distance of a clip space vertex inside each clip plane: near,
+		// then the guard band on x and y
+		FORCEINLINE float ClipDistance(const float *pVertex,
+									   std::uint32_t uPlane)
+		{
+			switch (uPlane)
+			{
+			case 0:
+				return pVertex[2];
+			case 1:
+				return g_fGuardBand * pVertex[3] - pVertex[0];
+			case 2:
+				return g_fGuardBand * pVertex[3] + pVertex[0];
+			case 3:
+				return g_fGuardBand * pVertex[3] - pVertex[1];
+			default:
+				return g_fGuardBand * pVertex[3] + pVertex[1];
+			}
+		}
+
+		FORCEINLINE void Transform(const float *pMatrix, float fX, float fY,
+								   float fZ, float *pClip)
+		{
+			for (std::uint32_t uCol(0); uCol < 4; ++uCol)
+			{
+				pClip[uCol] = fX * pMatrix[uCol] + fY * pMatrix[4 + uCol] +
+							  fZ * pMatrix[8 + uCol] + pMatrix[12 + uCol];
+			}
+		}
+
+		FORCEINLINE float HorizontalMax(__m128 vValue)
+		{
+			vValue = _mm_max_ps(
+				vValue,
+				_mm_shuffle_ps(vValue, vValue, _MM_SHUFFLE(1, 0, 3, 2)));
+			vValue = _mm_max_ps(
+				vValue,
+				_mm_shuffle_ps(vValue, vValue, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_cvtss_f32(vValue);
+		}
+
+		FORCEINLINE float HorizontalMin(__m128 vValue)
+		{
+			vValue = _mm_min_ps(
+				vValue,
+				_mm_shuffle_ps(vValue, vValue, _MM_SHUFFLE(1, 0, 3, 2)));
+			vValue = _mm_min_ps(
+				vValue,
+				_mm_shuffle_ps(vValue, vValue, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_cvtss_f32(vValue);
+		}
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEOcclusionBuffer::IOEOcclusionBuffer(std::uint32_t uWidth /*=256*/,
+										   std::uint32_t uHeight /*=128*/)
+	{
+		for (std::uint32_t uIdx(0); uIdx < 16; ++uIdx)
+		{
+			m_arrViewProjection[uIdx] = (uIdx % 5) == 0 ? 1.0f : 0.0f;
+		}
+		SetResolution(uWidth, uHeight);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEOcclusionBuffer::SetResolution(std::uint32_t uWidth,
+										   std::uint32_t uHeight)
+	{
+		IOE_ASSERT(uWidth % ms_uTileSize == 0 && uHeight % ms_uTileSize == 0,
+				   "Occlusion buffer must be a whole number of tiles");
+
+		m_uWidth   = uWidth;
+		m_uHeight  = uHeight;
+		m_uTilesX  = uWidth / ms_uTileSize;
+		m_uTilesY  = uHeight / ms_uTileSize;
+		m_uBlocksX = uWidth / ms_uBlockSize;
+		m_uBlocksY = uHeight / ms_uBlockSize;
+
+		m_arrDepth.assign(uWidth * uHeight, 1.0f);
+		m_arrBlockDepth.assign(m_uBlocksX * m_uBlocksY, 1.0f);
+		m_arrTileDepth.assign(m_uTilesX * m_uTilesY, 1.0f);
+		m_arrTileBins.resize(m_uTilesX * m_uTilesY);
+		m_arrTriangles.clear();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEOcclusionBuffer::Begin(const float *pViewProjection)
+	{
+		std::memcpy(m_arrViewProjection, pViewProjection,
+					sizeof(m_arrViewProjection));
+
+		std::fill(m_arrDepth.begin(), m_arrDepth.end(), 1.0f);
+		std::fill(m_arrBlockDepth.begin(), m_arrBlockDepth.end(), 1.0f);
+		std::fill(m_arrTileDepth.begin(), m_arrTileDepth.end(), 1.0f);
+		m_arrTriangles.clear();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEOcclusionBuffer::AddOccluder(const float *pPositions,
+										 std::uint32_t uStride,
+										 const std::int32_t *pIndices,
+										 std::uint32_t uNumIndices,
+										 const float *pOffset /*=nullptr*/)
+	{
+		const float arrNoOffset[3] = {0.0f, 0.0f, 0.0f};
+		const float *pMove(pOffset != nullptr ? pOffset : arrNoOffset);
+		const char *pBytes(reinterpret_cast<const char *>(pPositions));
+
+		for (std::uint32_t uIdx(0); uIdx + 2 < uNumIndices; uIdx += 3)
+		{
+			float arrClip[3][4];
+			for (std::uint32_t uVert(0); uVert < 3; ++uVert)
+			{
+				const float *pPosition(reinterpret_cast<const float *>(
+					pBytes + static_cast<std::size_t>(pIndices[uIdx + uVert]) *
+								 uStride));
+				Transform(m_arrViewProjection, pPosition[0] + pMove[0],
+						  pPosition[1] + pMove[1], pPosition[2] + pMove[2],
+						  arrClip[uVert]);
+			}
+			AddClipTriangle(arrClip[0], arrClip[1], arrClip[2]);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEOcclusionBuffer::AddClipTriangle(const float *pV0,
+											 const float *pV1,
+											 const float *pV2)
+	{
+		// Most triangles need no clipping at all
+		std::uint32_t uOutside(0);
+		for (std::uint32_t uPlane(0); uPlane < g_uNumClipPlanes; ++uPlane)
+		{
+			if (ClipDistance(pV0, uPlane) < 0.0f ||
+				ClipDistance(pV1, uPlane) < 0.0f ||
+				ClipDistance(pV2, uPlane) < 0.0f)
+			{
+				uOutside |= 1u << uPlane;
+			}
+		}
+		if (uOutside == 0)
+		{
+			AddScreenTriangle(pV0, pV1, pV2);
+			return;
+		}
+
+		// Sutherland-Hodgman against each plane the triangle crosses
+		float arrPolys[2][g_uMaxClipVerts][4];
+		std::memcpy(arrPolys[0][0], pV0, sizeof(float) * 4);
+		std::memcpy(arrPolys[0][1], pV1, sizeof(float) * 4);
+		std::memcpy(arrPolys[0][2], pV2, sizeof(float) * 4);
+		std::uint32_t uNumVerts(3);
+		std::uint32_t uCurrent(0);
+
+		for (std::uint32_t uPlane(0); uPlane < g_uNumClipPlanes; ++uPlane)
+		{
+			if ((uOutside & (1u << uPlane)) == 0)
+			{
+				continue;
+			}
+
+			float(*pIn)[4](arrPolys[uCurrent]);
+			float(*pOut)[4](arrPolys[uCurrent ^ 1]);
+			std::uint32_t uNumOut(0);
+			for (std::uint32_t uVert(0); uVert < uNumVerts; ++uVert)
+			{
+				const float *pA(pIn[uVert]);
+				const float *pB(pIn[(uVert + 1) % uNumVerts]);
+				const float fDistA(ClipDistance(pA, uPlane));
+				const float fDistB(ClipDistance(pB, uPlane));
+
+				if (fDistA >= 0.0f)
+				{
+					std::memcpy(pOut[uNumOut++], pA, sizeof(float) * 4);
+				}
+				if ((fDistA >= 0.0f) != (fDistB >= 0.0f))
+				{
+					const float fT(fDistA / (fDistA - fDistB));
+					for (std::uint32_t uAxis(0); uAxis < 4; ++uAxis)
+					{
+						pOut[uNumOut][uAxis] =
+							pA[uAxis] + (pB[uAxis] - pA[uAxis]) * fT;
+					}
+					++uNumOut;
+				}
+			}
+
+			uNumVerts = uNumOut;
+			uCurrent ^= 1;
+			if (uNumVerts < 3)
+			{
+				return;
+			}
+		}
+
+		for (std::uint32_t uVert(1); uVert + 1 < uNumVerts; ++uVert)
+		{
+			AddScreenTriangle(arrPolys[uCurrent][0], arrPolys[uCurrent][uVert],
+							  arrPolys[uCurrent][uVert + 1]);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEOcclusionBuffer::AddScreenTriangle(const float *pV0,
+											   const float *pV1,
+											   const float *pV2)
+	{
+		const float *arrVerts[3] = {pV0, pV1, pV2};
+
+		Triangle tTri;
+		float arrZ[3];
+		for (std::uint32_t uVert(0); uVert < 3; ++uVert)
+		{
+			const float *pVert(arrVerts[uVert]);
+			const float fInvW(1.0f / pVert[3]);
+			tTri.arrX[uVert] =
+				(pVert[0] * fInvW * 0.5f + 0.5f) * static_cast<float>(m_uWidth);
+			tTri.arrY[uVert] = (0.5f - pVert[1] * fInvW * 0.5f) *
+							   static_cast<float>(m_uHeight);
+			arrZ[uVert] = pVert[2] * fInvW;
+		}
+
+		float fArea((tTri.arrX[1] - tTri.arrX[0]) *
+						(tTri.arrY[2] - tTri.arrY[0]) -
+					(tTri.arrY[1] - tTri.arrY[0]) *
+						(tTri.arrX[2] - tTri.arrX[0]));
+		if (std::abs(fArea) < 1.0e-6f)
+		{
+			return;
+		}
+
+		// Occluders are drawn from both sides, so wind every triangle the
+		// same way for the edge tests
+		if (fArea < 0.0f)
+		{
+			std::swap(tTri.arrX[1], tTri.arrX[2]);
+			std::swap(tTri.arrY[1], tTri.arrY[2]);
+			std::swap(arrZ[1], arrZ[2]);
+			fArea = -fArea;
+		}
+
+		const float fDX1(tTri.arrX[1] - tTri.arrX[0]);
+		const float fDY1(tTri.arrY[1] - tTri.arrY[0]);
+		const float fDX2(tTri.arrX[2] - tTri.arrX[0]);
+		const float fDY2(tTri.arrY[2] - tTri.arrY[0]);
+		const float fDZ1(arrZ[1] - arrZ[0]);
+		const float fDZ2(arrZ[2] - arrZ[0]);
+		tTri.fZdX = (fDZ1 * fDY2 - fDZ2 * fDY1) / fArea;
+		tTri.fZdY = (fDZ2 * fDX1 - fDZ1 * fDX2) / fArea;
+		tTri.fZ0 =
+			arrZ[0] - tTri.fZdX * tTri.arrX[0] - tTri.fZdY * tTri.arrY[0];
+
+		// Pixels whose centres can fall inside
+		const float fMinX(
+			std::min(tTri.arrX[0], std::min(tTri.arrX[1], tTri.arrX[2])));
+		const float fMaxX(
+			std::max(tTri.arrX[0], std::max(tTri.arrX[1], tTri.arrX[2])));
+		const float fMinY(
+			std::min(tTri.arrY[0], std::min(tTri.arrY[1], tTri.arrY[2])));
+		const float fMaxY(
+			std::max(tTri.arrY[0], std::max(tTri.arrY[1], tTri.arrY[2])));
+
+		tTri.nMinX = std::max(
+			static_cast<std::int32_t>(std::ceil(fMinX - 0.5f)), 0);
+		tTri.nMinY = std::max(
+			static_cast<std::int32_t>(std::ceil(fMinY - 0.5f)), 0);
+		tTri.nMaxX =
+			std::min(static_cast<std::int32_t>(std::floor(fMaxX - 0.5f)),
+					 static_cast<std::int32_t>(m_uWidth) - 1);
+		tTri.nMaxY =
+			std::min(static_cast<std::int32_t>(std::floor(fMaxY - 0.5f)),
+					 static_cast<std::int32_t>(m_uHeight) - 1);
+		if (tTri.nMinX > tTri.nMaxX || tTri.nMinY > tTri.nMaxY)
+		{
+			return;
+		}
+
+		m_arrTriangles.push_back(tTri);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEOcclusionBuffer::Rasterise()
+	{
+		for (std::vector<std::uint32_t> &rBin : m_arrTileBins)
+		{
+			rBin.clear();
+		}
+
+		for (std::uint32_t uTri(0); uTri < m_arrTriangles.size(); ++uTri)
+		{
+			const Triangle &rTri(m_arrTriangles[uTri]);
+			const std::uint32_t uTileX0(rTri.nMinX / ms_uTileSize);
+			const std::uint32_t uTileX1(rTri.nMaxX / ms_uTileSize);
+			const std::uint32_t uTileY0(rTri.nMinY / ms_uTileSize);
+			const std::uint32_t uTileY1(rTri.nMaxY / ms_uTileSize);
+			for (std::uint32_t uTileY(uTileY0); uTileY <= uTileY1; ++uTileY)
+			{
+				for (std::uint32_t uTileX(uTileX0); uTileX <= uTileX1;
+					 ++uTileX)
+				{
+					m_arrTileBins[uTileY * m_uTilesX + uTileX].push_back(uTri);
+				}
+			}
+		}
+
+		// Tiles own disjoint pixels and blocks so need no synchronisation
+		tbb::parallel_for(std::uint32_t(0), m_uTilesX * m_uTilesY,
+						  [this](std::uint32_t uTile) {
+							  RasteriseTile(uTile);
+							  BuildTileHierarchy(uTile);
+						  });
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEOcclusionBuffer::RasteriseTile(std::uint32_t uTile)
+	{
+		const std::int32_t nTileX(
+			static_cast<std::int32_t>((uTile % m_uTilesX) * ms_uTileSize));
+		const std::int32_t nTileY(
+			static_cast<std::int32_t>((uTile / m_uTilesX) * ms_uTileSize));
+		const std::int32_t nTileSize(static_cast<std::int32_t>(ms_uTileSize));
+
+		const __m128 vZero(_mm_setzero_ps());
+		const __m128 vLaneOffsets(_mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f));
+
+		for (std::uint32_t uTri : m_arrTileBins[uTile])
+		{
+			const Triangle &rTri(m_arrTriangles[uTri]);
+
+			// Rows of four pixels starting on a multiple of four, which
+			// always stay inside the tile
+			const std::int32_t nMinX(std::max(rTri.nMinX, nTileX) & ~3);
+			const std::int32_t nMaxX(
+				std::min(rTri.nMaxX, nTileX + nTileSize - 1));
+			const std::int32_t nMinY(std::max(rTri.nMinY, nTileY));
+			const std::int32_t nMaxY(
+				std::min(rTri.nMaxY, nTileY + nTileSize - 1));
+
+			// Edge i is opposite vertex i and positive inside
+			float arrA[3], arrB[3], arrC[3];
+			for (std::uint32_t uEdge(0); uEdge < 3; ++uEdge)
+			{
+				const std::uint32_t uFrom((uEdge + 1) % 3);
+				const std::uint32_t uTo((uEdge + 2) % 3);
+				arrA[uEdge] = rTri.arrY[uFrom] - rTri.arrY[uTo];
+				arrB[uEdge] = rTri.arrX[uTo] - rTri.arrX[uFrom];
+				arrC[uEdge] = -(arrA[uEdge] * rTri.arrX[uFrom] +
+								arrB[uEdge] * rTri.arrY[uFrom]);
+			}
+
+			const __m128 vStartX(_mm_add_ps(
+				_mm_set1_ps(static_cast<float>(nMinX)), vLaneOffsets));
+			const __m128 vA0(_mm_set1_ps(arrA[0]));
+			const __m128 vA1(_mm_set1_ps(arrA[1]));
+			const __m128 vA2(_mm_set1_ps(arrA[2]));
+			const __m128 vStep0(_mm_set1_ps(arrA[0] * 4.0f));
+			const __m128 vStep1(_mm_set1_ps(arrA[1] * 4.0f));
+			const __m128 vStep2(_mm_set1_ps(arrA[2] * 4.0f));
+			const __m128 vStepZ(_mm_set1_ps(rTri.fZdX * 4.0f));
+
+			for (std::int32_t nY(nMinY); nY <= nMaxY; ++nY)
+			{
+				const float fY(static_cast<float>(nY) + 0.5f);
+				__m128 vE0(_mm_add_ps(_mm_mul_ps(vA0, vStartX),
+									  _mm_set1_ps(arrB[0] * fY + arrC[0])));
+				__m128 vE1(_mm_add_ps(_mm_mul_ps(vA1, vStartX),
+									  _mm_set1_ps(arrB[1] * fY + arrC[1])));
+				__m128 vE2(_mm_add_ps(_mm_mul_ps(vA2, vStartX),
+									  _mm_set1_ps(arrB[2] * fY + arrC[2])));
+				__m128 vZ(
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(rTri.fZdX), vStartX),
+							   _mm_set1_ps(rTri.fZdY * fY + rTri.fZ0)));
+
+				float *pRow(&m_arrDepth[nY * m_uWidth]);
+				for (std::int32_t nX(nMinX); nX <= nMaxX; nX += 4)
+				{
+					const __m128 vInside(_mm_cmpge_ps(
+						_mm_min_ps(vE0, _mm_min_ps(vE1, vE2)), vZero));
+					if (_mm_movemask_ps(vInside) != 0)
+					{
+						const __m128 vDepth(_mm_loadu_ps(pRow + nX));
+						const __m128 vNearest(_mm_min_ps(vDepth, vZ));
+						_mm_storeu_ps(
+							pRow + nX,
+							_mm_or_ps(_mm_and_ps(vInside, vNearest),
+									  _mm_andnot_ps(vInside, vDepth)));
+					}
+
+					vE0 = _mm_add_ps(vE0, vStep0);
+					vE1 = _mm_add_ps(vE1, vStep1);
+					vE2 = _mm_add_ps(vE2, vStep2);
+					vZ	= _mm_add_ps(vZ, vStepZ);
+				}
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEOcclusionBuffer::BuildTileHierarchy(std::uint32_t uTile)
+	{
+		const std::uint32_t uBlocksPerTile(ms_uTileSize / ms_uBlockSize);
+		const std::uint32_t uBlockX0((uTile % m_uTilesX) * uBlocksPerTile);
+		const std::uint32_t uBlockY0((uTile / m_uTilesX) * uBlocksPerTile);
+
+		if (m_arrTileBins[uTile].empty())
+		{
+			// Nothing drawn, the clear already left everything at the far
+			// plane
+			return;
+		}
+
+		float fTileFarthest(0.0f);
+		for (std::uint32_t uBlockY(uBlockY0);
+			 uBlockY < uBlockY0 + uBlocksPerTile; ++uBlockY)
+		{
+			for (std::uint32_t uBlockX(uBlockX0);
+				 uBlockX < uBlockX0 + uBlocksPerTile; ++uBlockX)
+			{
+				__m128 vFarthest(_mm_setzero_ps());
+				for (std::uint32_t uRow(0); uRow < ms_uBlockSize; ++uRow)
+				{
+					const float *pPixels(
+						&m_arrDepth[(uBlockY * ms_uBlockSize + uRow) *
+										m_uWidth +
+									uBlockX * ms_uBlockSize]);
+					vFarthest = _mm_max_ps(vFarthest, _mm_loadu_ps(pPixels));
+					vFarthest =
+						_mm_max_ps(vFarthest, _mm_loadu_ps(pPixels + 4));
+				}
+
+				const float fFarthest(HorizontalMax(vFarthest));
+				m_arrBlockDepth[uBlockY * m_uBlocksX + uBlockX] = fFarthest;
+				fTileFarthest = std::max(fTileFarthest, fFarthest);
+			}
+		}
+		m_arrTileDepth[uTile] = fTileFarthest;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEOcclusionBuffer::ProjectBox(const float *pCentre,
+										const float *pExtent,
+										ScreenRect &rRect) const
+	{
+		const float *pM(m_arrViewProjection);
+
+		// The eight corners as two groups of four, each clip space
+		// component being the centre's plus signed extents along the axes
+		const __m128 vSignX(_mm_setr_ps(-1.0f, 1.0f, -1.0f, 1.0f));
+		const __m128 vSignY(_mm_setr_ps(-1.0f, -1.0f, 1.0f, 1.0f));
+		__m128 arrClip[2][4];
+		for (std::uint32_t uCol(0); uCol < 4; ++uCol)
+		{
+			const float fCentre(pCentre[0] * pM[uCol] +
+								pCentre[1] * pM[4 + uCol] +
+								pCentre[2] * pM[8 + uCol] + pM[12 + uCol]);
+			const __m128 vXY(_mm_add_ps(
+				_mm_set1_ps(fCentre),
+				_mm_add_ps(
+					_mm_mul_ps(vSignX, _mm_set1_ps(pExtent[0] * pM[uCol])),
+					_mm_mul_ps(vSignY,
+							   _mm_set1_ps(pExtent[1] * pM[4 + uCol])))));
+			const __m128 vZ(_mm_set1_ps(pExtent[2] * pM[8 + uCol]));
+			arrClip[0][uCol] = _mm_sub_ps(vXY, vZ);
+			arrClip[1][uCol] = _mm_add_ps(vXY, vZ);
+		}
+
+		const __m128 vZero(_mm_setzero_ps());
+		__m128 vMinX(_mm_set1_ps(1.0e30f)), vMaxX(_mm_set1_ps(-1.0e30f));
+		__m128 vMinY(vMinX), vMaxY(vMaxX), vNearZ(vMinX);
+		for (std::uint32_t uGroup(0); uGroup < 2; ++uGroup)
+		{
+			const __m128 *pClip(arrClip[uGroup]);
+
+			// A corner behind the near plane has no usable projection
+			if (_mm_movemask_ps(_mm_or_ps(_mm_cmplt_ps(pClip[2], vZero),
+										  _mm_cmple_ps(pClip[3], vZero))) !=
+				0)
+			{
+				return false;
+			}
+
+			const __m128 vInvW(_mm_div_ps(_mm_set1_ps(1.0f), pClip[3]));
+			const __m128 vX(_mm_mul_ps(pClip[0], vInvW));
+			const __m128 vY(_mm_mul_ps(pClip[1], vInvW));
+			vMinX  = _mm_min_ps(vMinX, vX);
+			vMaxX  = _mm_max_ps(vMaxX, vX);
+			vMinY  = _mm_min_ps(vMinY, vY);
+			vMaxY  = _mm_max_ps(vMaxY, vY);
+			vNearZ = _mm_min_ps(vNearZ, _mm_mul_ps(pClip[2], vInvW));
+		}
+
+		// Screen y runs down, so the top of the rectangle is the largest y
+		const float fWidth(static_cast<float>(m_uWidth));
+		const float fHeight(static_cast<float>(m_uHeight));
+		rRect.fMinX	 = (HorizontalMin(vMinX) * 0.5f + 0.5f) * fWidth;
+		rRect.fMaxX	 = (HorizontalMax(vMaxX) * 0.5f + 0.5f) * fWidth;
+		rRect.fMinY	 = (0.5f - HorizontalMax(vMaxY) * 0.5f) * fHeight;
+		rRect.fMaxY	 = (0.5f - HorizontalMin(vMinY) * 0.5f) * fHeight;
+		rRect.fNearZ = HorizontalMin(vNearZ);
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEOcclusionBuffer::IsOccluded(const float *pCentre,
+										const float *pExtent) const
+	{
+		ScreenRect tRect;
+		if (!ProjectBox(pCentre, pExtent, tRect))
+		{
+			return false;
+		}
+
+		// Every pixel the rectangle touches, clamped to the screen. A box
+		// entirely off screen is left to frustum culling.
+		const std::int32_t nX0(std::max(
+			static_cast<std::int32_t>(std::floor(tRect.fMinX)), 0));
+		const std::int32_t nY0(std::max(
+			static_cast<std::int32_t>(std::floor(tRect.fMinY)), 0));
+		const std::int32_t nX1(
+			std::min(static_cast<std::int32_t>(std::floor(tRect.fMaxX)),
+					 static_cast<std::int32_t>(m_uWidth) - 1));
+		const std::int32_t nY1(
+			std::min(static_cast<std::int32_t>(std::floor(tRect.fMaxY)),
+					 static_cast<std::int32_t>(m_uHeight) - 1));
+		if (nX0 > nX1 || nY0 > nY1)
+		{
+			return false;
+		}
+
+		const std::int32_t nTileSize(static_cast<std::int32_t>(ms_uTileSize));
+		const std::int32_t nBlockSize(
+			static_cast<std::int32_t>(ms_uBlockSize));
+
+		// Tiles, then blocks, then pixels, descending only where the
+		// coarser level has something at or behind the box
+		for (std::int32_t nTileY(nY0 / nTileSize); nTileY <= nY1 / nTileSize;
+			 ++nTileY)
+		{
+			for (std::int32_t nTileX(nX0 / nTileSize);
+				 nTileX <= nX1 / nTileSize; ++nTileX)
+			{
+				if (m_arrTileDepth[nTileY * m_uTilesX + nTileX] < tRect.fNearZ)
+				{
+					continue;
+				}
+
+				const std::int32_t nBX0(
+					std::max(nX0, nTileX * nTileSize) / nBlockSize);
+				const std::int32_t nBX1(
+					std::min(nX1, nTileX * nTileSize + nTileSize - 1) /
+					nBlockSize);
+				const std::int32_t nBY0(
+					std::max(nY0, nTileY * nTileSize) / nBlockSize);
+				const std::int32_t nBY1(
+					std::min(nY1, nTileY * nTileSize + nTileSize - 1) /
+					nBlockSize);
+				for (std::int32_t nBY(nBY0); nBY <= nBY1; ++nBY)
+				{
+					for (std::int32_t nBX(nBX0); nBX <= nBX1; ++nBX)
+					{
+						if (m_arrBlockDepth[nBY * m_uBlocksX + nBX] <
+							tRect.fNearZ)
+						{
+							continue;
+						}
+
+						const std::int32_t nPY1(
+							std::min(nY1, nBY * nBlockSize + nBlockSize - 1));
+						const std::int32_t nPX1(
+							std::min(nX1, nBX * nBlockSize + nBlockSize - 1));
+						for (std::int32_t nPY(std::max(nY0, nBY * nBlockSize));
+							 nPY <= nPY1; ++nPY)
+						{
+							for (std::int32_t nPX(
+									 std::max(nX0, nBX * nBlockSize));
+								 nPX <= nPX1; ++nPX)
+							{
+								if (m_arrDepth[nPY * m_uWidth + nPX] >=
+									tRect.fNearZ)
+								{
+									return false;
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	float IOEOcclusionBuffer::GetScreenArea(const float *pCentre,
+											const float *pExtent) const
+	{
+		ScreenRect tRect;
+		if (!ProjectBox(pCentre, pExtent, tRect))
+		{
+			return 1.0f;
+		}
+
+		const float fWidth(static_cast<float>(m_uWidth));
+		const float fHeight(static_cast<float>(m_uHeight));
+		const float fSizeX(std::min(tRect.fMaxX, fWidth) -
+						   std::max(tRect.fMinX, 0.0f));
+		const float fSizeY(std::min(tRect.fMaxY, fHeight) -
+						   std::max(tRect.fMinY, 0.0f));
+		if (fSizeX <= 0.0f || fSizeY <= 0.0f)
+		{
+			return 0.0f;
+		}
+		return (fSizeX * fSizeY) / (fWidth * fHeight);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEOcclusionBuffer::DumpDepth(const char *szPath) const
+	{
+		std::ofstream tStream(szPath, std::ios::out | std::ios::binary);
+		if (!tStream)
+		{
+			return false;
+		}
+
+		// Perspective depth bunches up near 1, so stretch the range
+		// actually covered to the full grey scale
+		float fNearest(1.0f);
+		for (float fDepth : m_arrDepth)
+		{
+			fNearest = std::min(fNearest, fDepth);
+		}
+		const float fRange(std::max(1.0f - fNearest, 1.0e-6f));
+
+		std::vector<std::uint8_t> arrPixels(m_arrDepth.size());
+		for (std::size_t uIdx(0); uIdx < m_arrDepth.size(); ++uIdx)
+		{
+			const float fDepth(m_arrDepth[uIdx]);
+			const float fShade(1.0f - (fDepth - fNearest) / fRange);
+			arrPixels[uIdx] =
+				fDepth >= 1.0f
+					? 0
+					: static_cast<std::uint8_t>(32.0f + 223.0f * fShade);
+		}
+
+		tStream << "P5\n" << m_uWidth << " " << m_uHeight << "\n255\n";
+		tStream.write(reinterpret_cast<const char *>(arrPixels.data()),
+					  static_cast<std::streamsize>(arrPixels.size()));
+		return tStream.good();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Maths
+} // namespace IOE
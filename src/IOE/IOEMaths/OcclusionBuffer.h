@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <IOE/IOECore/IOEPortable.h>
+
+//////////////////////////////////////////////////////////////////////////
+// Low resolution software depth buffer for occlusion culling, needing no
+// GPU. Occluder triangles are clipped to the near plane, binned into
+// screen tiles and the tiles filled in parallel, four pixels per SSE
+// instruction. Each tile then reduces its pixels to the farthest depth of
+// every block and of the tile as a whole.
+//
+// A box is occluded when its nearest depth lies behind the farthest depth
+// of every block its screen rectangle touches, so most tests read a few
+// tile values and never touch pixels. Occluders are sampled at pixel
+// centres, as a GPU would, so an object may be hidden by less than a
+// pixel of occluder edge at this resolution.
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Maths
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class IOEOcclusionBuffer
+	{
+	public:
+		static const std::uint32_t ms_uTileSize  = 32;
+		static const std::uint32_t ms_uBlockSize = 8;
+
+	public:
+		// Both dimensions must be multiples of ms_uTileSize
+		IOEOcclusionBuffer(std::uint32_t uWidth = 256,
+						   std::uint32_t uHeight = 128);
+
+	public:
+		void SetResolution(std::uint32_t uWidth, std::uint32_t uHeight);
+
+		FORCEINLINE std::uint32_t GetWidth() const
+		{
+			return m_uWidth;
+		}
+		FORCEINLINE std::uint32_t GetHeight() const
+		{
+			return m_uHeight;
+		}
+
+		// Clears to the far plane and drops every occluder. The matrix is
+		// row major view * projection in the row-vector convention used by
+		// IOEMatrix, with a [0, 1] clip space depth range, as taken by
+		// IOEFrustumPlanes::SetFromViewProjection.
+		void Begin(const float *pViewProjection);
+
+		// Queues an indexed triangle list. Positions are read uStride bytes
+		// apart and moved by pOffset when given, so model space vertices
+		// can be placed without copying them.
+		void AddOccluder(const float *pPositions, std::uint32_t uStride,
+						 const std::int32_t *pIndices,
+						 std::uint32_t uNumIndices,
+						 const float *pOffset = nullptr);
+
+		// Bins and fills the queued triangles then builds the hierarchy
+		void Rasterise();
+
+		// True only when the box is certainly hidden by the occluders.
+		// Boxes reaching behind the near plane are never occluded.
+		bool IsOccluded(const float *pCentre, const float *pExtent) const;
+
+		// Fraction of the screen covered by the box's projected rectangle,
+		// 1 for boxes reaching behind the near plane, for picking occluders
+		float GetScreenArea(const float *pCentre, const float *pExtent) const;
+
+		FORCEINLINE float GetDepth(std::uint32_t uX, std::uint32_t uY) const
+		{
+			return m_arrDepth[uY * m_uWidth + uX];
+		}
+
+		FORCEINLINE std::uint32_t GetNumTriangles() const
+		{
+			return static_cast<std::uint32_t>(m_arrTriangles.size());
+		}
+
+		// Writes the depth buffer as a binary greyscale PGM image, nearest
+		// occluder white and empty pixels black
+		bool DumpDepth(const char *szPath) const;
+
+	private:
+		// Screen space triangle with its depth as a plane over x and y
+		struct Triangle
+		{
+			float arrX[3];
+			float arrY[3];
+			float fZ0, fZdX, fZdY;
+			std::int32_t nMinX, nMinY, nMaxX, nMaxY;
+		};
+
+		// Screen rectangle and nearest depth of a projected box
+		struct ScreenRect
+		{
+			float fMinX, fMinY, fMaxX, fMaxY;
+			float fNearZ;
+		};
+
+	private:
+		void AddClipTriangle(const float *pV0, const float *pV1,
+							 const float *pV2);
+		void AddScreenTriangle(const float *pV0, const float *pV1,
+							   const float *pV2);
+		void RasteriseTile(std::uint32_t uTile);
+		void BuildTileHierarchy(std::uint32_t uTile);
+
+		bool ProjectBox(const float *pCentre, const float *pExtent,
+						ScreenRect &rRect) const;
+
+	private:
+		float m_arrViewProjection[16];
+
+		std::uint32_t m_uWidth, m_uHeight;
+		std::uint32_t m_uTilesX, m_uTilesY;
+		std::uint32_t m_uBlocksX, m_uBlocksY;
+
+		std::vector<float> m_arrDepth;
+
+		// Farthest depth of each block and tile
+		std::vector<float> m_arrBlockDepth;
+		std::vector<float> m_arrTileDepth;
+
+		std::vector<Triangle> m_arrTriangles;
+		std::vector<std::vector<std::uint32_t> > m_arrTileBins;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Maths
+} // namespace IOE
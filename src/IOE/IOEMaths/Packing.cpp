@@ -0,0 +1,830 @@
+#include <cmath>
+
+#include <immintrin.h>
+
+#include "CPUFeatures.h"
+#include "Packing.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Maths
+{
+namespace Packing
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		FORCEINLINE __m128 Splat(float fValue)
+		{
+			return _mm_set1_ps(fValue);
+		}
+
+		FORCEINLINE __m128 Select(__m128 vFalse, __m128 vTrue, __m128 vMask)
+		{
+			return _mm_or_ps(_mm_and_ps(vMask, vTrue),
+							 _mm_andnot_ps(vMask, vFalse));
+		}
+
+		FORCEINLINE __m128 Abs(__m128 vValue)
+		{
+			return _mm_andnot_ps(_mm_set1_ps(-0.0f), vValue);
+		}
+
+		// +1 or -1 with the sign of the input, +1 for both zeros
+		FORCEINLINE __m128 SignNotZero(__m128 vValue)
+		{
+			return Select(Splat(1.0f), Splat(-1.0f),
+						  _mm_cmplt_ps(vValue, _mm_setzero_ps()));
+		}
+
+		// Clamps to [fMin, 1]; NaN becomes fMin as _mm_max_ps returns its
+		// second operand when either is NaN
+		FORCEINLINE __m128 Saturate(__m128 vValue, float fMin)
+		{
+			return _mm_min_ps(_mm_max_ps(vValue, Splat(fMin)), Splat(1.0f));
+		}
+
+		FORCEINLINE __m128 Gather(const float *pSrc, std::size_t uStride)
+		{
+			return _mm_setr_ps(pSrc[0], pSrc[uStride], pSrc[uStride * 2],
+							   pSrc[uStride * 3]);
+		}
+
+		FORCEINLINE void Scatter(__m128 vValue, float *pDst,
+								 std::size_t uStride)
+		{
+			alignas(16) float arrValues[4];
+			_mm_store_ps(arrValues, vValue);
+			for (std::size_t uIdx(0); uIdx < 4; ++uIdx)
+			{
+				pDst[uIdx * uStride] = arrValues[uIdx];
+			}
+		}
+
+		//////////////////////////////////////////////////////////////////////
+		// Half precision
+
+		// 32 bit lanes out, sign extended so _mm_packs_epi32 keeps all 16
+		// bits. Round to nearest even, NaN stays NaN.
+		FORCEINLINE __m128i FloatToHalfSSE2(__m128 vValue)
+		{
+			const __m128i vSubnormalMagic(
+				_mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23));
+
+			__m128 vSign(_mm_and_ps(vValue, _mm_set1_ps(-0.0f)));
+			__m128 vAbs(_mm_xor_ps(vValue, vSign));
+			__m128i vAbsBits(_mm_castps_si128(vAbs));
+
+			__m128i vIsNaN(_mm_castps_si128(_mm_cmpunord_ps(vAbs, vAbs)));
+			__m128i vIsRegular(
+				_mm_cmpgt_epi32(_mm_set1_epi32((127 + 16) << 23), vAbsBits));
+			__m128i vSpecial(_mm_or_si128(
+				_mm_and_si128(vIsNaN, _mm_set1_epi32(0x200)),
+				_mm_set1_epi32(0x7c00)));
+
+			// Subnormal results, rounded by the FPU through a magic add
+			__m128i vIsSubnormal(
+				_mm_cmpgt_epi32(_mm_set1_epi32((127 - 14) << 23), vAbsBits));
+			__m128i vSubnormal(_mm_sub_epi32(
+				_mm_castps_si128(
+					_mm_add_ps(vAbs, _mm_castsi128_ps(vSubnormalMagic))),
+				vSubnormalMagic));
+
+			// Normal results, with the exponent rebiased and the mantissa
+			// rounded to nearest even
+			__m128i vOdd(_mm_srai_epi32(_mm_slli_epi32(vAbsBits, 31 - 13), 31));
+			__m128i vNormal(_mm_srli_epi32(
+				_mm_sub_epi32(
+					_mm_add_epi32(vAbsBits,
+								  _mm_set1_epi32(0xfff - ((127 - 15) << 23))),
+					vOdd),
+				13));
+
+			__m128i vFinite(
+				_mm_or_si128(_mm_and_si128(vIsSubnormal, vSubnormal),
+							 _mm_andnot_si128(vIsSubnormal, vNormal)));
+			__m128i vResult(
+				_mm_or_si128(_mm_and_si128(vIsRegular, vFinite),
+							 _mm_andnot_si128(vIsRegular, vSpecial)));
+			return _mm_or_si128(
+				vResult, _mm_srai_epi32(_mm_castps_si128(vSign), 16));
+		}
+
+		// Takes zero extended 32 bit lanes
+		FORCEINLINE __m128 HalfToFloatSSE2(__m128i vHalf)
+		{
+			__m128i vExpMantissa(_mm_and_si128(vHalf, _mm_set1_epi32(0x7fff)));
+			__m128i vSign(
+				_mm_slli_epi32(_mm_xor_si128(vHalf, vExpMantissa), 16));
+
+			// Scaling by 2^112 rebiases normals and normalises subnormals
+			__m128 vMagnitude(
+				_mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(vExpMantissa, 13)),
+						   _mm_castsi128_ps(_mm_set1_epi32(0x77800000))));
+
+			__m128i vWasInfNaN(
+				_mm_cmpgt_epi32(vExpMantissa, _mm_set1_epi32(0x7bff)));
+			__m128i vInfNaN(
+				_mm_and_si128(vWasInfNaN, _mm_set1_epi32(0x7f800000)));
+
+			return _mm_or_ps(vMagnitude,
+							 _mm_castsi128_ps(_mm_or_si128(vSign, vInfNaN)));
+		}
+
+		IOE_TARGET_F16C void FloatToHalfF16C(const float *pSrc,
+											 std::uint16_t *pDst,
+											 std::size_t uCount)
+		{
+			for (std::size_t uIdx(0); uIdx < uCount; uIdx += 8)
+			{
+				__m128i vLow(_mm_cvtps_ph(_mm_loadu_ps(pSrc + uIdx),
+										  _MM_FROUND_TO_NEAREST_INT));
+				__m128i vHigh(_mm_cvtps_ph(_mm_loadu_ps(pSrc + uIdx + 4),
+										   _MM_FROUND_TO_NEAREST_INT));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(pDst + uIdx),
+								 _mm_unpacklo_epi64(vLow, vHigh));
+			}
+		}
+
+		IOE_TARGET_F16C void HalfToFloatF16C(const std::uint16_t *pSrc,
+											 float *pDst, std::size_t uCount)
+		{
+			for (std::size_t uIdx(0); uIdx < uCount; uIdx += 8)
+			{
+				__m128i vHalves(_mm_loadu_si128(
+					reinterpret_cast<const __m128i *>(pSrc + uIdx)));
+				_mm_storeu_ps(pDst + uIdx, _mm_cvtph_ps(vHalves));
+				_mm_storeu_ps(
+					pDst + uIdx + 4,
+					_mm_cvtph_ps(_mm_unpackhi_epi64(vHalves, vHalves)));
+			}
+		}
+
+		//////////////////////////////////////////////////////////////////////
+		// Octahedral
+
+		FORCEINLINE void EncodeOctahedral(__m128 vX, __m128 vY, __m128 vZ,
+										  __m128 &vU, __m128 &vV)
+		{
+			__m128 vL1(_mm_add_ps(_mm_add_ps(Abs(vX), Abs(vY)), Abs(vZ)));
+			__m128 vInvL1(_mm_div_ps(Splat(1.0f), vL1));
+			__m128 vProjU(_mm_mul_ps(vX, vInvL1));
+			__m128 vProjV(_mm_mul_ps(vY, vInvL1));
+
+			__m128 vFoldU(_mm_mul_ps(_mm_sub_ps(Splat(1.0f), Abs(vProjV)),
+									 SignNotZero(vProjU)));
+			__m128 vFoldV(_mm_mul_ps(_mm_sub_ps(Splat(1.0f), Abs(vProjU)),
+									 SignNotZero(vProjV)));
+
+			__m128 vLower(_mm_cmplt_ps(vZ, _mm_setzero_ps()));
+			vU = Select(vProjU, vFoldU, vLower);
+			vV = Select(vProjV, vFoldV, vLower);
+		}
+
+		FORCEINLINE void DecodeOctahedral(__m128 vU, __m128 vV, __m128 &vX,
+										  __m128 &vY, __m128 &vZ)
+		{
+			vZ = _mm_sub_ps(_mm_sub_ps(Splat(1.0f), Abs(vU)), Abs(vV));
+
+			// Unfold the lower hemisphere by moving each component
+			// towards zero by the overshoot
+			__m128 vFold(_mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), vZ),
+									_mm_setzero_ps()));
+			vX = _mm_sub_ps(vU, _mm_mul_ps(vFold, SignNotZero(vU)));
+			vY = _mm_sub_ps(vV, _mm_mul_ps(vFold, SignNotZero(vV)));
+
+			__m128 vLengthSq(_mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(vX, vX), _mm_mul_ps(vY, vY)),
+				_mm_mul_ps(vZ, vZ)));
+			__m128 vInvLength(_mm_div_ps(Splat(1.0f), _mm_sqrt_ps(vLengthSq)));
+			vX = _mm_mul_ps(vX, vInvLength);
+			vY = _mm_mul_ps(vY, vInvLength);
+			vZ = _mm_mul_ps(vZ, vInvLength);
+		}
+
+		FORCEINLINE __m128i PackSNorm16x2(__m128 vU, __m128 vV)
+		{
+			__m128i vPackedU(_mm_cvtps_epi32(
+				_mm_mul_ps(Saturate(vU, -1.0f), Splat(32767.0f))));
+			__m128i vPackedV(_mm_cvtps_epi32(
+				_mm_mul_ps(Saturate(vV, -1.0f), Splat(32767.0f))));
+			return _mm_or_si128(_mm_and_si128(vPackedU, _mm_set1_epi32(0xffff)),
+								_mm_slli_epi32(vPackedV, 16));
+		}
+
+		FORCEINLINE void UnpackSNorm16x2(__m128i vPacked, __m128 &vU,
+										 __m128 &vV)
+		{
+			__m128 vLow(_mm_cvtepi32_ps(
+				_mm_srai_epi32(_mm_slli_epi32(vPacked, 16), 16)));
+			__m128 vHigh(_mm_cvtepi32_ps(_mm_srai_epi32(vPacked, 16)));
+			vU = _mm_max_ps(_mm_div_ps(vLow, Splat(32767.0f)), Splat(-1.0f));
+			vV = _mm_max_ps(_mm_div_ps(vHigh, Splat(32767.0f)), Splat(-1.0f));
+		}
+
+		//////////////////////////////////////////////////////////////////////
+		// RGB9E5
+
+		const float g_fRGB9E5Max = 65408.0f;
+
+		// 2^(uExponent - 127) for a biased exponent in [1, 254]
+		FORCEINLINE __m128 ExponentToFloat(__m128i vBiasedExponent)
+		{
+			return _mm_castsi128_ps(_mm_slli_epi32(vBiasedExponent, 23));
+		}
+
+		FORCEINLINE __m128i PackRGB9E5(__m128 vR, __m128 vG, __m128 vB)
+		{
+			const __m128 vLimit(Splat(g_fRGB9E5Max));
+			vR = _mm_min_ps(_mm_max_ps(vR, _mm_setzero_ps()), vLimit);
+			vG = _mm_min_ps(_mm_max_ps(vG, _mm_setzero_ps()), vLimit);
+			vB = _mm_min_ps(_mm_max_ps(vB, _mm_setzero_ps()), vLimit);
+			__m128 vMax(_mm_max_ps(_mm_max_ps(vR, vG), vB));
+
+			// floor(log2(max)) + 16, limited below by the smallest shared
+			// exponent. Zero and denormals have a zero exponent field.
+			__m128i vExponent(_mm_sub_epi32(
+				_mm_srli_epi32(_mm_castps_si128(vMax), 23),
+				_mm_set1_epi32(127 - 16)));
+			__m128i vNegative(_mm_cmplt_epi32(vExponent, _mm_setzero_si128()));
+			vExponent = _mm_andnot_si128(vNegative, vExponent);
+
+			// Scale of 2^(24 - exponent) maps the largest channel to
+			// [256, 512]
+			__m128 vScale(ExponentToFloat(
+				_mm_sub_epi32(_mm_set1_epi32(127 + 24), vExponent)));
+			__m128i vMaxMantissa(_mm_cvttps_epi32(
+				_mm_add_ps(_mm_mul_ps(vMax, vScale), Splat(0.5f))));
+
+			// Rounding up to 512 needs the next exponent
+			__m128i vOverflow(
+				_mm_cmpeq_epi32(vMaxMantissa, _mm_set1_epi32(512)));
+			vExponent = _mm_sub_epi32(vExponent, vOverflow);
+			vScale = Select(vScale, _mm_mul_ps(vScale, Splat(0.5f)),
+							_mm_castsi128_ps(vOverflow));
+
+			__m128i vMantissaR(_mm_cvttps_epi32(
+				_mm_add_ps(_mm_mul_ps(vR, vScale), Splat(0.5f))));
+			__m128i vMantissaG(_mm_cvttps_epi32(
+				_mm_add_ps(_mm_mul_ps(vG, vScale), Splat(0.5f))));
+			__m128i vMantissaB(_mm_cvttps_epi32(
+				_mm_add_ps(_mm_mul_ps(vB, vScale), Splat(0.5f))));
+
+			return _mm_or_si128(
+				_mm_or_si128(vMantissaR, _mm_slli_epi32(vMantissaG, 9)),
+				_mm_or_si128(_mm_slli_epi32(vMantissaB, 18),
+							 _mm_slli_epi32(vExponent, 27)));
+		}
+
+		FORCEINLINE void UnpackRGB9E5(__m128i vPacked, __m128 &vR, __m128 &vG,
+									  __m128 &vB)
+		{
+			const __m128i vMask(_mm_set1_epi32(0x1ff));
+
+			// 2^(exponent - 15 - 9)
+			__m128 vScale(ExponentToFloat(_mm_add_epi32(
+				_mm_srli_epi32(vPacked, 27), _mm_set1_epi32(127 - 24))));
+
+			vR = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(vPacked, vMask)),
+							vScale);
+			vG = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(
+								_mm_srli_epi32(vPacked, 9), vMask)),
+							vScale);
+			vB = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(
+								_mm_srli_epi32(vPacked, 18), vMask)),
+							vScale);
+		}
+
+		//////////////////////////////////////////////////////////////////////
+		// Tangent frames
+
+		FORCEINLINE float Dot3(const float *pA, const float *pB)
+		{
+			return pA[0] * pB[0] + pA[1] * pB[1] + pA[2] * pB[2];
+		}
+
+		FORCEINLINE void Normalise3(float *pValue)
+		{
+			float fInvLength(1.0f / std::sqrt(Dot3(pValue, pValue)));
+			pValue[0] *= fInvLength;
+			pValue[1] *= fInvLength;
+			pValue[2] *= fInvLength;
+		}
+
+		FORCEINLINE void Cross3(const float *pA, const float *pB, float *pOut)
+		{
+			pOut[0] = pA[1] * pB[2] - pA[2] * pB[1];
+			pOut[1] = pA[2] * pB[0] - pA[0] * pB[2];
+			pOut[2] = pA[0] * pB[1] - pA[1] * pB[0];
+		}
+
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IsF16CSupported()
+	{
+		static const bool s_bSupported(CPUFeatures::HasF16C());
+		return s_bSupported;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void FloatToHalf(const float *pSrc, std::uint16_t *pDst, std::size_t uCount)
+	{
+		const std::size_t uBlocked(uCount & ~static_cast<std::size_t>(7));
+		if (IsF16CSupported())
+		{
+			FloatToHalfF16C(pSrc, pDst, uBlocked);
+		}
+		else
+		{
+			for (std::size_t uIdx(0); uIdx < uBlocked; uIdx += 8)
+			{
+				__m128i vLow(FloatToHalfSSE2(_mm_loadu_ps(pSrc + uIdx)));
+				__m128i vHigh(FloatToHalfSSE2(_mm_loadu_ps(pSrc + uIdx + 4)));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(pDst + uIdx),
+								 _mm_packs_epi32(vLow, vHigh));
+			}
+		}
+
+		for (std::size_t uIdx(uBlocked); uIdx < uCount; ++uIdx)
+		{
+			pDst[uIdx] = FloatToHalf(pSrc[uIdx]);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void HalfToFloat(const std::uint16_t *pSrc, float *pDst, std::size_t uCount)
+	{
+		const std::size_t uBlocked(uCount & ~static_cast<std::size_t>(7));
+		if (IsF16CSupported())
+		{
+			HalfToFloatF16C(pSrc, pDst, uBlocked);
+		}
+		else
+		{
+			for (std::size_t uIdx(0); uIdx < uBlocked; uIdx += 8)
+			{
+				__m128i vHalves(_mm_loadu_si128(
+					reinterpret_cast<const __m128i *>(pSrc + uIdx)));
+				__m128i vZero(_mm_setzero_si128());
+				__m128i vLow(_mm_unpacklo_epi16(vHalves, vZero));
+				__m128i vHigh(_mm_unpackhi_epi16(vHalves, vZero));
+				_mm_storeu_ps(pDst + uIdx, HalfToFloatSSE2(vLow));
+				_mm_storeu_ps(pDst + uIdx + 4, HalfToFloatSSE2(vHigh));
+			}
+		}
+
+		for (std::size_t uIdx(uBlocked); uIdx < uCount; ++uIdx)
+		{
+			pDst[uIdx] = HalfToFloat(pSrc[uIdx]);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t PackUNorm4x8(__m128 vValue)
+	{
+		__m128i vPacked(_mm_cvtps_epi32(
+			_mm_mul_ps(Saturate(vValue, 0.0f), Splat(255.0f))));
+		vPacked = _mm_packs_epi32(vPacked, vPacked);
+		return static_cast<std::uint32_t>(
+			_mm_cvtsi128_si32(_mm_packus_epi16(vPacked, vPacked)));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t PackSNorm4x8(__m128 vValue)
+	{
+		__m128i vPacked(_mm_cvtps_epi32(
+			_mm_mul_ps(Saturate(vValue, -1.0f), Splat(127.0f))));
+		vPacked = _mm_packs_epi32(vPacked, vPacked);
+		return static_cast<std::uint32_t>(
+			_mm_cvtsi128_si32(_mm_packs_epi16(vPacked, vPacked)));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t PackUNorm1010102(__m128 vValue)
+	{
+		alignas(16) std::uint32_t arrFields[4];
+		_mm_store_si128(
+			reinterpret_cast<__m128i *>(arrFields),
+			_mm_cvtps_epi32(_mm_mul_ps(Saturate(vValue, 0.0f),
+									   _mm_setr_ps(1023.0f, 1023.0f, 1023.0f,
+												   3.0f))));
+		return arrFields[0] | (arrFields[1] << 10) | (arrFields[2] << 20) |
+			   (arrFields[3] << 30);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t PackSNorm1010102(__m128 vValue)
+	{
+		alignas(16) std::uint32_t arrFields[4];
+		_mm_store_si128(
+			reinterpret_cast<__m128i *>(arrFields),
+			_mm_cvtps_epi32(_mm_mul_ps(Saturate(vValue, -1.0f),
+									   _mm_setr_ps(511.0f, 511.0f, 511.0f,
+												   1.0f))));
+		return (arrFields[0] & 0x3ffu) | ((arrFields[1] & 0x3ffu) << 10) |
+			   ((arrFields[2] & 0x3ffu) << 20) | (arrFields[3] << 30);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint64_t PackUNorm4x16(__m128 vValue)
+	{
+		__m128i vPacked(_mm_cvtps_epi32(
+			_mm_mul_ps(Saturate(vValue, 0.0f), Splat(65535.0f))));
+
+		// SSE2 only has a signed saturating pack, so bias into its range
+		// and flip the top bit back afterwards
+		vPacked = _mm_sub_epi32(vPacked, _mm_set1_epi32(32768));
+		vPacked = _mm_xor_si128(_mm_packs_epi32(vPacked, vPacked),
+								_mm_set1_epi16(-32768));
+
+		std::uint64_t uResult;
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(&uResult), vPacked);
+		return uResult;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint64_t PackSNorm4x16(__m128 vValue)
+	{
+		__m128i vPacked(_mm_cvtps_epi32(
+			_mm_mul_ps(Saturate(vValue, -1.0f), Splat(32767.0f))));
+		vPacked = _mm_packs_epi32(vPacked, vPacked);
+
+		std::uint64_t uResult;
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(&uResult), vPacked);
+		return uResult;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	__m128 UnpackUNorm4x8(std::uint32_t uValue)
+	{
+		__m128i vZero(_mm_setzero_si128());
+		__m128i vBytes(_mm_cvtsi32_si128(static_cast<int>(uValue)));
+		__m128i vFields(_mm_unpacklo_epi16(_mm_unpacklo_epi8(vBytes, vZero),
+										   vZero));
+		return _mm_div_ps(_mm_cvtepi32_ps(vFields), Splat(255.0f));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	__m128 UnpackSNorm4x8(std::uint32_t uValue)
+	{
+		__m128i vBytes(_mm_cvtsi32_si128(static_cast<int>(uValue)));
+
+		// Duplicating each byte into the high half and shifting back down
+		// sign extends it
+		__m128i vWords(_mm_srai_epi16(_mm_unpacklo_epi8(vBytes, vBytes), 8));
+		__m128i vFields(_mm_srai_epi32(_mm_unpacklo_epi16(vWords, vWords), 16));
+		return _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(vFields), Splat(127.0f)),
+						  Splat(-1.0f));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	__m128 UnpackUNorm1010102(std::uint32_t uValue)
+	{
+		__m128i vFields(_mm_setr_epi32(
+			static_cast<int>(uValue & 0x3ffu),
+			static_cast<int>((uValue >> 10) & 0x3ffu),
+			static_cast<int>((uValue >> 20) & 0x3ffu),
+			static_cast<int>(uValue >> 30)));
+		return _mm_div_ps(_mm_cvtepi32_ps(vFields),
+						  _mm_setr_ps(1023.0f, 1023.0f, 1023.0f, 3.0f));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	__m128 UnpackSNorm1010102(std::uint32_t uValue)
+	{
+		// Shifting each field to the top and arithmetically back down sign
+		// extends it
+		__m128i vFields(_mm_setr_epi32(
+			static_cast<std::int32_t>(uValue << 22) >> 22,
+			static_cast<std::int32_t>(uValue << 12) >> 22,
+			static_cast<std::int32_t>(uValue << 2) >> 22,
+			static_cast<std::int32_t>(uValue) >> 30));
+		return _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(vFields),
+									 _mm_setr_ps(511.0f, 511.0f, 511.0f, 1.0f)),
+						  Splat(-1.0f));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	__m128 UnpackUNorm4x16(std::uint64_t uValue)
+	{
+		__m128i vWords(
+			_mm_loadl_epi64(reinterpret_cast<const __m128i *>(&uValue)));
+		__m128i vFields(_mm_unpacklo_epi16(vWords, _mm_setzero_si128()));
+		return _mm_div_ps(_mm_cvtepi32_ps(vFields), Splat(65535.0f));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	__m128 UnpackSNorm4x16(std::uint64_t uValue)
+	{
+		__m128i vWords(
+			_mm_loadl_epi64(reinterpret_cast<const __m128i *>(&uValue)));
+		__m128i vFields(_mm_srai_epi32(_mm_unpacklo_epi16(vWords, vWords), 16));
+		return _mm_max_ps(
+			_mm_div_ps(_mm_cvtepi32_ps(vFields), Splat(32767.0f)),
+			Splat(-1.0f));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void DecodeOctahedral(float fU, float fV, float &fX, float &fY, float &fZ)
+	{
+		float fAbsU(fU < 0.0f ? -fU : fU);
+		float fAbsV(fV < 0.0f ? -fV : fV);
+
+		fZ = 1.0f - fAbsU - fAbsV;
+		float fFold(fZ < 0.0f ? -fZ : 0.0f);
+		fX = fU - (fU >= 0.0f ? fFold : -fFold);
+		fY = fV - (fV >= 0.0f ? fFold : -fFold);
+
+		float fInvLength(1.0f / std::sqrt(fX * fX + fY * fY + fZ * fZ));
+		fX *= fInvLength;
+		fY *= fInvLength;
+		fZ *= fInvLength;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t PackOctahedral16(float fX, float fY, float fZ)
+	{
+		float fU, fV;
+		EncodeOctahedral(fX, fY, fZ, fU, fV);
+		return PackSNorm(fU, 16) | (PackSNorm(fV, 16) << 16);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void UnpackOctahedral16(std::uint32_t uValue, float &fX, float &fY,
+							float &fZ)
+	{
+		DecodeOctahedral(UnpackSNorm(uValue & 0xffffu, 16),
+						 UnpackSNorm(uValue >> 16, 16), fX, fY, fZ);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void PackOctahedral16(const float *pSrc, std::size_t uStride,
+						  std::uint32_t *pDst, std::size_t uCount)
+	{
+		std::size_t uIdx(0);
+		for (; uIdx + 4 <= uCount; uIdx += 4)
+		{
+			const float *pVectors(pSrc + uIdx * uStride);
+
+			__m128 vU, vV;
+			EncodeOctahedral(Gather(pVectors, uStride),
+							 Gather(pVectors + 1, uStride),
+							 Gather(pVectors + 2, uStride), vU, vV);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(pDst + uIdx),
+							 PackSNorm16x2(vU, vV));
+		}
+
+		for (; uIdx < uCount; ++uIdx)
+		{
+			const float *pVector(pSrc + uIdx * uStride);
+			pDst[uIdx] = PackOctahedral16(pVector[0], pVector[1], pVector[2]);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void UnpackOctahedral16(const std::uint32_t *pSrc, float *pDst,
+							std::size_t uStride, std::size_t uCount)
+	{
+		std::size_t uIdx(0);
+		for (; uIdx + 4 <= uCount; uIdx += 4)
+		{
+			__m128 vU, vV, vX, vY, vZ;
+			UnpackSNorm16x2(
+				_mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc + uIdx)),
+				vU, vV);
+			DecodeOctahedral(vU, vV, vX, vY, vZ);
+
+			float *pVectors(pDst + uIdx * uStride);
+			Scatter(vX, pVectors, uStride);
+			Scatter(vY, pVectors + 1, uStride);
+			Scatter(vZ, pVectors + 2, uStride);
+		}
+
+		for (; uIdx < uCount; ++uIdx)
+		{
+			float *pVector(pDst + uIdx * uStride);
+			UnpackOctahedral16(pSrc[uIdx], pVector[0], pVector[1], pVector[2]);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint64_t PackTangentFrame(const float *pNormal, const float *pTangent,
+								   float fHandedness)
+	{
+		// Orthonormalise, falling back to any perpendicular tangent when
+		// the given one is parallel to the normal
+		float arrNormal[3] = {pNormal[0], pNormal[1], pNormal[2]};
+		Normalise3(arrNormal);
+
+		float fNormalDotTangent(Dot3(arrNormal, pTangent));
+		float arrTangent[3] = {pTangent[0] - arrNormal[0] * fNormalDotTangent,
+							   pTangent[1] - arrNormal[1] * fNormalDotTangent,
+							   pTangent[2] - arrNormal[2] * fNormalDotTangent};
+		if (Dot3(arrTangent, arrTangent) < 1.0e-12f)
+		{
+			const float arrAxisX[3] = {1.0f, 0.0f, 0.0f};
+			const float arrAxisY[3] = {0.0f, 1.0f, 0.0f};
+			bool bUseX(arrNormal[0] > -0.9f && arrNormal[0] < 0.9f);
+			Cross3(bUseX ? arrAxisX : arrAxisY, arrNormal, arrTangent);
+		}
+		Normalise3(arrTangent);
+
+		float arrBitangent[3];
+		Cross3(arrNormal, arrTangent, arrBitangent);
+
+		// Rotation taking (x, y, z) to (tangent, bitangent, normal);
+		// mRC is row R, column C
+		const float m00(arrTangent[0]), m01(arrBitangent[0]), m02(arrNormal[0]);
+		const float m10(arrTangent[1]), m11(arrBitangent[1]), m12(arrNormal[1]);
+		const float m20(arrTangent[2]), m21(arrBitangent[2]), m22(arrNormal[2]);
+
+		float arrQuat[4];
+		const float fTrace(m00 + m11 + m22);
+		if (fTrace > 0.0f)
+		{
+			float fScale(0.5f / std::sqrt(fTrace + 1.0f));
+			arrQuat[0] = (m21 - m12) * fScale;
+			arrQuat[1] = (m02 - m20) * fScale;
+			arrQuat[2] = (m10 - m01) * fScale;
+			arrQuat[3] = 0.25f / fScale;
+		}
+		else if (m00 > m11 && m00 > m22)
+		{
+			float fScale(2.0f * std::sqrt(1.0f + m00 - m11 - m22));
+			arrQuat[0] = 0.25f * fScale;
+			arrQuat[1] = (m01 + m10) / fScale;
+			arrQuat[2] = (m02 + m20) / fScale;
+			arrQuat[3] = (m21 - m12) / fScale;
+		}
+		else if (m11 > m22)
+		{
+			float fScale(2.0f * std::sqrt(1.0f + m11 - m00 - m22));
+			arrQuat[0] = (m01 + m10) / fScale;
+			arrQuat[1] = 0.25f * fScale;
+			arrQuat[2] = (m12 + m21) / fScale;
+			arrQuat[3] = (m02 - m20) / fScale;
+		}
+		else
+		{
+			float fScale(2.0f * std::sqrt(1.0f + m22 - m00 - m11));
+			arrQuat[0] = (m02 + m20) / fScale;
+			arrQuat[1] = (m12 + m21) / fScale;
+			arrQuat[2] = 0.25f * fScale;
+			arrQuat[3] = (m10 - m01) / fScale;
+		}
+
+		// q and -q are the same rotation, so make w positive and then at
+		// least one snorm16 step so the handedness sign cannot be lost
+		float fSign(arrQuat[3] < 0.0f ? -1.0f : 1.0f);
+		for (float &rComponent : arrQuat)
+		{
+			rComponent *= fSign;
+		}
+
+		const float fBias(1.0f / 32767.0f);
+		if (arrQuat[3] < fBias)
+		{
+			float fScale(std::sqrt(1.0f - fBias * fBias) /
+						 std::sqrt(Dot3(arrQuat, arrQuat)));
+			arrQuat[0] *= fScale;
+			arrQuat[1] *= fScale;
+			arrQuat[2] *= fScale;
+			arrQuat[3] = fBias;
+		}
+
+		if (fHandedness < 0.0f)
+		{
+			for (float &rComponent : arrQuat)
+			{
+				rComponent = -rComponent;
+			}
+		}
+
+		return PackSNorm4x16(_mm_loadu_ps(arrQuat));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void UnpackTangentFrame(std::uint64_t uValue, float *pNormal,
+							float *pTangent, float &fHandedness)
+	{
+		alignas(16) float arrQuat[4];
+		_mm_store_ps(arrQuat, UnpackSNorm4x16(uValue));
+
+		float fInvLength(1.0f / std::sqrt(Dot3(arrQuat, arrQuat) +
+										  arrQuat[3] * arrQuat[3]));
+		const float fX(arrQuat[0] * fInvLength);
+		const float fY(arrQuat[1] * fInvLength);
+		const float fZ(arrQuat[2] * fInvLength);
+		const float fW(arrQuat[3] * fInvLength);
+
+		fHandedness = fW < 0.0f ? -1.0f : 1.0f;
+
+		// First and third columns of the rotation matrix
+		pTangent[0] = 1.0f - 2.0f * (fY * fY + fZ * fZ);
+		pTangent[1] = 2.0f * (fX * fY + fW * fZ);
+		pTangent[2] = 2.0f * (fX * fZ - fW * fY);
+
+		pNormal[0] = 2.0f * (fX * fZ + fW * fY);
+		pNormal[1] = 2.0f * (fY * fZ - fW * fX);
+		pNormal[2] = 1.0f - 2.0f * (fX * fX + fY * fY);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t PackRGB9E5(float fR, float fG, float fB)
+	{
+		return static_cast<std::uint32_t>(_mm_cvtsi128_si32(
+			PackRGB9E5(_mm_set_ss(fR), _mm_set_ss(fG), _mm_set_ss(fB))));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void UnpackRGB9E5(std::uint32_t uValue, float &fR, float &fG, float &fB)
+	{
+		__m128 vR, vG, vB;
+		UnpackRGB9E5(_mm_cvtsi32_si128(static_cast<int>(uValue)), vR, vG, vB);
+		fR = _mm_cvtss_f32(vR);
+		fG = _mm_cvtss_f32(vG);
+		fB = _mm_cvtss_f32(vB);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void PackRGB9E5(const float *pSrc, std::size_t uStride,
+					std::uint32_t *pDst, std::size_t uCount)
+	{
+		std::size_t uIdx(0);
+		for (; uIdx + 4 <= uCount; uIdx += 4)
+		{
+			const float *pTexels(pSrc + uIdx * uStride);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(pDst + uIdx),
+							 PackRGB9E5(Gather(pTexels, uStride),
+										Gather(pTexels + 1, uStride),
+										Gather(pTexels + 2, uStride)));
+		}
+
+		for (; uIdx < uCount; ++uIdx)
+		{
+			const float *pTexel(pSrc + uIdx * uStride);
+			pDst[uIdx] = PackRGB9E5(pTexel[0], pTexel[1], pTexel[2]);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void UnpackRGB9E5(const std::uint32_t *pSrc, float *pDst,
+					  std::size_t uStride, std::size_t uCount)
+	{
+		std::size_t uIdx(0);
+		for (; uIdx + 4 <= uCount; uIdx += 4)
+		{
+			__m128 vR, vG, vB;
+			UnpackRGB9E5(
+				_mm_loadu_si128(reinterpret_cast<const __m128i *>(pSrc + uIdx)),
+				vR, vG, vB);
+
+			float *pTexels(pDst + uIdx * uStride);
+			Scatter(vR, pTexels, uStride);
+			Scatter(vG, pTexels + 1, uStride);
+			Scatter(vB, pTexels + 2, uStride);
+		}
+
+		for (; uIdx < uCount; ++uIdx)
+		{
+			float *pTexel(pDst + uIdx * uStride);
+			UnpackRGB9E5(pSrc[uIdx], pTexel[0], pTexel[1], pTexel[2]);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Packing
+} // namespace Maths
+} // namespace IOE
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <emmintrin.h>
+
+#include <IOE/IOECore/IOEPortable.h>
+
+//////////////////////////////////////////////////////////////////////////
+// Conversions between 32 bit floats and the compact formats used for
+// vertex and texture data. Scalar helpers are inline; the array versions
+// are SIMD and are the ones to use in compression pipelines.
+//
+//	Half        - IEEE binary16, round to nearest even, F16C when the CPU
+//	              supports it and SSE2 otherwise.
+//	UNorm/SNorm - D3D conversion rules for 8, 10 and 16 bit fields.
+//	Octahedral  - unit vectors as two snorm components.
+//	TangentFrame- normal, tangent and handedness as one quaternion.
+//	RGB9E5      - D3D R9G9B9E5_SHAREDEXP HDR colour.
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Maths
+{
+namespace Packing
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace Detail
+	{
+		FORCEINLINE std::uint32_t FloatBits(float fValue)
+		{
+			std::uint32_t uBits;
+			std::memcpy(&uBits, &fValue, sizeof(uBits));
+			return uBits;
+		}
+
+		FORCEINLINE float BitsToFloat(std::uint32_t uBits)
+		{
+			float fValue;
+			std::memcpy(&fValue, &uBits, sizeof(fValue));
+			return fValue;
+		}
+
+		FORCEINLINE float Saturate(float fValue, float fMin)
+		{
+			// Written so that NaN maps to fMin
+			return fValue > fMin ? (fValue < 1.0f ? fValue : 1.0f) : fMin;
+		}
+
+		// Round to nearest even, matching the packed SSE conversions
+		FORCEINLINE std::int32_t RoundToInt(float fValue)
+		{
+			return _mm_cvtss_si32(_mm_set_ss(fValue));
+		}
+	} // namespace Detail
+
+	//////////////////////////////////////////////////////////////////////////
+	// Half precision
+
+	FORCEINLINE std::uint16_t FloatToHalf(float fValue)
+	{
+		const std::uint32_t uBits(Detail::FloatBits(fValue));
+		const std::uint32_t uSign((uBits >> 16) & 0x8000u);
+		const std::uint32_t uAbs(uBits & 0x7fffffffu);
+
+		std::uint32_t uHalf;
+		if (uAbs > 0x7f800000u)
+		{
+			// NaN, kept quiet
+			uHalf = 0x7e00u;
+		}
+		else if (uAbs >= 0x477ff000u)
+		{
+			// Rounds to or beyond 65520, the first value past half's range
+			uHalf = 0x7c00u;
+		}
+		else if (uAbs < 0x38800000u)
+		{
+			// Subnormal result: let the FPU round by adding 0.5 as the
+			// magic value whose ulp matches half's subnormal spacing
+			uHalf = Detail::FloatBits(Detail::BitsToFloat(uAbs) + 0.5f) -
+					Detail::FloatBits(0.5f);
+		}
+		else
+		{
+			// Rebias the exponent and round to nearest even on bit 13
+			uHalf = (uAbs + 0xc8000fffu + ((uAbs >> 13) & 1u)) >> 13;
+		}
+		return static_cast<std::uint16_t>(uHalf | uSign);
+	}
+
+	FORCEINLINE float HalfToFloat(std::uint16_t uHalf)
+	{
+		const std::uint32_t uSign(static_cast<std::uint32_t>(uHalf & 0x8000u)
+								  << 16);
+		const std::uint32_t uExpMantissa(uHalf & 0x7fffu);
+
+		// Scaling by 2^112 rebiases normals and normalises subnormals
+		float fMagnitude(Detail::BitsToFloat(uExpMantissa << 13) *
+						 Detail::BitsToFloat(0x77800000u));
+		std::uint32_t uResult(Detail::FloatBits(fMagnitude));
+		if (uExpMantissa >= 0x7c00u)
+		{
+			uResult |= 0x7f800000u;
+		}
+		return Detail::BitsToFloat(uResult | uSign);
+	}
+
+	// Converts uCount values. Any alignment and count is allowed.
+	void FloatToHalf(const float *pSrc, std::uint16_t *pDst,
+					 std::size_t uCount);
+	void HalfToFloat(const std::uint16_t *pSrc, float *pDst,
+					 std::size_t uCount);
+
+	// True when the array conversions run on F16C instructions
+	bool IsF16CSupported();
+
+	//////////////////////////////////////////////////////////////////////////
+	// Normalised integers, uBits in [2, 16]
+
+	FORCEINLINE std::uint32_t PackUNorm(float fValue, std::uint32_t uBits)
+	{
+		const float fScale(static_cast<float>((1u << uBits) - 1));
+		return static_cast<std::uint32_t>(
+			Detail::RoundToInt(Detail::Saturate(fValue, 0.0f) * fScale));
+	}
+
+	FORCEINLINE float UnpackUNorm(std::uint32_t uValue, std::uint32_t uBits)
+	{
+		const float fScale(static_cast<float>((1u << uBits) - 1));
+		return static_cast<float>(uValue & ((1u << uBits) - 1)) / fScale;
+	}
+
+	// Two's complement field of uBits; -1 and -1 + 1 ulp both decode to -1
+	FORCEINLINE std::uint32_t PackSNorm(float fValue, std::uint32_t uBits)
+	{
+		const float fScale(static_cast<float>((1u << (uBits - 1)) - 1));
+		std::int32_t nValue(
+			Detail::RoundToInt(Detail::Saturate(fValue, -1.0f) * fScale));
+		return static_cast<std::uint32_t>(nValue) & ((1u << uBits) - 1);
+	}
+
+	FORCEINLINE float UnpackSNorm(std::uint32_t uValue, std::uint32_t uBits)
+	{
+		const float fScale(static_cast<float>((1u << (uBits - 1)) - 1));
+
+		// Sign extend the field
+		std::int32_t nValue(static_cast<std::int32_t>(uValue << (32 - uBits)) >>
+							(32 - uBits));
+		float fValue(static_cast<float>(nValue) / fScale);
+		return fValue < -1.0f ? -1.0f : fValue;
+	}
+
+	// R8G8B8A8, R10G10B10A2 and R16G16B16A16 layouts, x in the low bits.
+	// The snorm 10:10:10:2 layout has no D3D format but suits normals and
+	// tangents; its 2 bit w holds -1, 0 or 1. IOEVector converts to and
+	// from __m128, so it can be passed and assigned directly.
+	std::uint32_t PackUNorm4x8(__m128 vValue);
+	std::uint32_t PackSNorm4x8(__m128 vValue);
+	std::uint32_t PackUNorm1010102(__m128 vValue);
+	std::uint32_t PackSNorm1010102(__m128 vValue);
+	std::uint64_t PackUNorm4x16(__m128 vValue);
+	std::uint64_t PackSNorm4x16(__m128 vValue);
+
+	__m128 UnpackUNorm4x8(std::uint32_t uValue);
+	__m128 UnpackSNorm4x8(std::uint32_t uValue);
+	__m128 UnpackUNorm1010102(std::uint32_t uValue);
+	__m128 UnpackSNorm1010102(std::uint32_t uValue);
+	__m128 UnpackUNorm4x16(std::uint64_t uValue);
+	__m128 UnpackSNorm4x16(std::uint64_t uValue);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Octahedral unit vectors
+
+	// Maps a unit vector to the octahedron unfolded onto [-1, 1]^2
+	FORCEINLINE void EncodeOctahedral(float fX, float fY, float fZ,
+									  float &fU, float &fV)
+	{
+		float fInvL1(1.0f / ((fX < 0.0f ? -fX : fX) + (fY < 0.0f ? -fY : fY) +
+							 (fZ < 0.0f ? -fZ : fZ)));
+		fU = fX * fInvL1;
+		fV = fY * fInvL1;
+		if (fZ < 0.0f)
+		{
+			float fFoldU((1.0f - (fV < 0.0f ? -fV : fV)) *
+						 (fU >= 0.0f ? 1.0f : -1.0f));
+			float fFoldV((1.0f - (fU < 0.0f ? -fU : fU)) *
+						 (fV >= 0.0f ? 1.0f : -1.0f));
+			fU = fFoldU;
+			fV = fFoldV;
+		}
+	}
+
+	// The result is normalised
+	void DecodeOctahedral(float fU, float fV, float &fX, float &fY,
+						  float &fZ);
+
+	// Two snorm16 components, about 0.004 degrees of worst case error
+	std::uint32_t PackOctahedral16(float fX, float fY, float fZ);
+	void UnpackOctahedral16(std::uint32_t uValue, float &fX, float &fY,
+							float &fZ);
+
+	// uStride is the distance between consecutive vectors in floats, so
+	// normals can be read straight out of an interleaved vertex array
+	void PackOctahedral16(const float *pSrc, std::size_t uStride,
+						  std::uint32_t *pDst, std::size_t uCount);
+	void UnpackOctahedral16(const std::uint32_t *pSrc, float *pDst,
+							std::size_t uStride, std::size_t uCount);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Tangent frames
+
+	// Packs an orthonormalised (tangent, bitangent, normal) basis as a
+	// snorm16 quaternion, x in the low bits. The handedness is the sign of
+	// w, which is kept away from zero so it survives quantisation.
+	// Bitangent = cross(normal, tangent) * handedness.
+	std::uint64_t PackTangentFrame(const float *pNormal, const float *pTangent,
+								   float fHandedness);
+	void UnpackTangentFrame(std::uint64_t uValue, float *pNormal,
+							float *pTangent, float &fHandedness);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Shared exponent colour
+
+	// Negative and NaN inputs become 0 and values clamp to 65408
+	std::uint32_t PackRGB9E5(float fR, float fG, float fB);
+	void UnpackRGB9E5(std::uint32_t uValue, float &fR, float &fG, float &fB);
+
+	// Four texels per iteration; uStride as for PackOctahedral16
+	void PackRGB9E5(const float *pSrc, std::size_t uStride,
+					std::uint32_t *pDst, std::size_t uCount);
+	void UnpackRGB9E5(const std::uint32_t *pSrc, float *pDst,
+					  std::size_t uStride, std::size_t uCount);
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Packing
+} // namespace Maths
+} // namespace IOE
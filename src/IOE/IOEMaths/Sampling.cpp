@@ -0,0 +1,287 @@
+#include <atomic>
+
+#include "Sampling.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Maths
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		std::uint64_t SplitMix64(std::uint64_t &rState)
+		{
+			std::uint64_t uResult(rState += 0x9e3779b97f4a7c15ull);
+			uResult = (uResult ^ (uResult >> 30)) * 0xbf58476d1ce4e5b9ull;
+			uResult = (uResult ^ (uResult >> 27)) * 0x94d049bb133111ebull;
+			return uResult ^ (uResult >> 31);
+		}
+
+		//////////////////////////////////////////////////////////////////////
+
+		// Primitive polynomial degree, coefficients and initial direction
+		// numbers for Sobol dimensions 1 and up, from Joe and Kuo's
+		// new-joe-kuo-6.21201 table. Dimension 0 is the van der Corput
+		// sequence and needs no entry.
+		struct SobolPolynomial
+		{
+			std::uint32_t uDegree;
+			std::uint32_t uCoefficients;
+			std::uint32_t arrInitial[5];
+		};
+
+		const SobolPolynomial g_arrSobolPolynomials[] = {
+			{1, 0, {1}},
+			{2, 1, {1, 3}},
+			{3, 1, {1, 3, 1}},
+			{3, 2, {1, 1, 1}},
+			{4, 1, {1, 1, 3, 3}},
+			{4, 4, {1, 3, 5, 13}},
+			{5, 2, {1, 1, 5, 5, 17}},
+		};
+
+		static_assert(sizeof(g_arrSobolPolynomials) /
+							  sizeof(g_arrSobolPolynomials[0]) ==
+						  Sampling::ms_uSobolMaxDimensions - 1,
+					  "Sobol polynomial table size mismatch");
+
+		//////////////////////////////////////////////////////////////////////
+
+		struct SobolDirections
+		{
+			SobolDirections()
+			{
+				for (std::uint32_t uBit(0); uBit < 32; ++uBit)
+				{
+					arrDirections[0][uBit] = 1u << (31 - uBit);
+				}
+
+				for (std::uint32_t uDimension(1);
+					 uDimension < Sampling::ms_uSobolMaxDimensions;
+					 ++uDimension)
+				{
+					const SobolPolynomial &rPoly(
+						g_arrSobolPolynomials[uDimension - 1]);
+					std::uint32_t *pDirections(arrDirections[uDimension]);
+					const std::uint32_t uDegree(rPoly.uDegree);
+
+					for (std::uint32_t uBit(0); uBit < uDegree; ++uBit)
+					{
+						pDirections[uBit] = rPoly.arrInitial[uBit]
+											<< (31 - uBit);
+					}
+					for (std::uint32_t uBit(uDegree); uBit < 32; ++uBit)
+					{
+						std::uint32_t uValue(pDirections[uBit - uDegree]);
+						uValue ^= uValue >> uDegree;
+						for (std::uint32_t uTerm(1); uTerm < uDegree; ++uTerm)
+						{
+							if ((rPoly.uCoefficients >> (uDegree - 1 - uTerm)) &
+								1u)
+							{
+								uValue ^= pDirections[uBit - uTerm];
+							}
+						}
+						pDirections[uBit] = uValue;
+					}
+				}
+			}
+
+			std::uint32_t arrDirections[Sampling::ms_uSobolMaxDimensions][32];
+		};
+
+		const SobolDirections &GetSobolDirections()
+		{
+			static const SobolDirections s_tDirections;
+			return s_tDirections;
+		}
+
+		//////////////////////////////////////////////////////////////////////
+
+		const std::uint32_t g_arrPrimes[Sampling::ms_uHaltonMaxDimensions] = {
+			2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53};
+
+		std::atomic<std::uint64_t> g_uNextThreadStream(0);
+
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEPCG32::IOEPCG32(std::uint64_t uSeed /*=0x853c49e6748fea9bull*/,
+					   std::uint64_t uStream /*=0*/)
+	{
+		Seed(uSeed, uStream);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEPCG32::Seed(std::uint64_t uSeed, std::uint64_t uStream)
+	{
+		m_uState	 = 0;
+		m_uIncrement = (uStream << 1u) | 1u;
+		NextUInt();
+		m_uState += uSeed;
+		NextUInt();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEPCG32::Advance(std::uint64_t uDelta)
+	{
+		// Brown's jump ahead for LCGs, composing the affine step by squaring
+		std::uint64_t uAccMultiplier(1);
+		std::uint64_t uAccIncrement(0);
+		std::uint64_t uCurMultiplier(ms_uMultiplier);
+		std::uint64_t uCurIncrement(m_uIncrement);
+
+		while (uDelta > 0)
+		{
+			if (uDelta & 1u)
+			{
+				uAccMultiplier *= uCurMultiplier;
+				uAccIncrement = uAccIncrement * uCurMultiplier + uCurIncrement;
+			}
+			uCurIncrement = (uCurMultiplier + 1) * uCurIncrement;
+			uCurMultiplier *= uCurMultiplier;
+			uDelta >>= 1u;
+		}
+		m_uState = uAccMultiplier * m_uState + uAccIncrement;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t IOEPCG32::NextUInt(std::uint32_t uBound)
+	{
+		IOE_ASSERT(uBound > 0, "PCG32: Bound must be positive");
+
+		// Reject the low values that would bias the modulo
+		std::uint32_t uThreshold((0u - uBound) % uBound);
+		for (;;)
+		{
+			std::uint32_t uValue(NextUInt());
+			if (uValue >= uThreshold)
+			{
+				return uValue % uBound;
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEXoshiro128x4::IOEXoshiro128x4(std::uint64_t uSeed /*=0*/,
+									 std::uint64_t uStream /*=0*/)
+	{
+		Seed(uSeed, uStream);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEXoshiro128x4::Seed(std::uint64_t uSeed, std::uint64_t uStream)
+	{
+		alignas(16) std::uint32_t arrState[4][4];
+
+		std::uint64_t uMixer(uSeed ^ (uStream * 0xd1b54a32d192ed03ull));
+		for (std::uint32_t uLane(0); uLane < 4; ++uLane)
+		{
+			std::uint64_t uLow(SplitMix64(uMixer));
+			std::uint64_t uHigh(SplitMix64(uMixer));
+
+			arrState[0][uLane] = static_cast<std::uint32_t>(uLow);
+			arrState[1][uLane] = static_cast<std::uint32_t>(uLow >> 32);
+			arrState[2][uLane] = static_cast<std::uint32_t>(uHigh);
+			arrState[3][uLane] = static_cast<std::uint32_t>(uHigh >> 32);
+
+			// The all zero state is the one fixed point of xoshiro
+			if ((uLow | uHigh) == 0)
+			{
+				arrState[0][uLane] = 1;
+			}
+		}
+
+		for (std::uint32_t uWord(0); uWord < 4; ++uWord)
+		{
+			m_arrState[uWord] = _mm_load_si128(
+				reinterpret_cast<const __m128i *>(arrState[uWord]));
+		}
+	}
+
+namespace Sampling
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t SobolUInt(std::uint32_t uIndex, std::uint32_t uDimension)
+	{
+		IOE_ASSERT(uDimension < ms_uSobolMaxDimensions,
+				   "Sobol: Dimension out of range");
+
+		const std::uint32_t *pDirections(
+			GetSobolDirections().arrDirections[uDimension]);
+
+		std::uint32_t uResult(0);
+		for (std::uint32_t uBit(0); uIndex != 0; uIndex >>= 1, ++uBit)
+		{
+			if (uIndex & 1u)
+			{
+				uResult ^= pDirections[uBit];
+			}
+		}
+		return uResult;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	float RadicalInverse(std::uint32_t uBase, std::uint32_t uIndex)
+	{
+		if (uBase == 2)
+		{
+			return UIntToUnitFloat(ReverseBits(uIndex));
+		}
+
+		// Accumulate the reversed digits as an integer and scale once at
+		// the end, which keeps the result exact until the final divide
+		const double fInvBase(1.0 / uBase);
+		double fInvBaseN(1.0);
+		std::uint64_t uReversed(0);
+		while (uIndex != 0)
+		{
+			std::uint32_t uNext(uIndex / uBase);
+			uReversed = uReversed * uBase + (uIndex - uNext * uBase);
+			fInvBaseN *= fInvBase;
+			uIndex = uNext;
+		}
+
+		// Clamp below 1 as the conversion to float can round up
+		return Min(static_cast<float>(uReversed * fInvBaseN),
+				   0.99999994f);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	float Halton(std::uint32_t uIndex, std::uint32_t uDimension)
+	{
+		IOE_ASSERT(uDimension < ms_uHaltonMaxDimensions,
+				   "Halton: Dimension out of range");
+
+		return RadicalInverse(g_arrPrimes[uDimension], uIndex);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEPCG32 &GetThreadRandom()
+	{
+		thread_local IOEPCG32 t_tGenerator(
+			0x853c49e6748fea9bull,
+			g_uNextThreadStream.fetch_add(1, std::memory_order_relaxed));
+		return t_tGenerator;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sampling
+} // namespace Maths
+} // namespace IOE
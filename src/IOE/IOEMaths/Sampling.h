@@ -0,0 +1,406 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include <emmintrin.h>
+
+#include <IOE/IOECore/IOEDefines.h>
+#include <IOE/IOEMaths/Math.h>
+#include <IOE/IOEMaths/Vector.h>
+#include <IOE/IOEMaths/VectorMath.h>
+
+//////////////////////////////////////////////////////////////////////////
+// Random and quasi-random sample generation plus the warps that map unit
+// square samples onto discs, spheres and hemispheres.
+//
+// Generators:
+//	IOEPCG32         - scalar PCG-XSH-RR, 2^63 independent streams.
+//	IOEXoshiro128x4  - four xoshiro128+ generators in SSE2 lanes.
+//
+// Sequences (all indexed, so any sample can be generated on any thread):
+//	Sobol      - up to ms_uSobolMaxDimensions, Joe-Kuo direction numbers.
+//	Halton     - radical inverse over the first ms_uHaltonMaxDimensions
+//	             primes.
+//	R1 / R2    - Roberts' additive recurrences, the best general purpose
+//	             choice when the sample count is not known up front.
+//
+// Sobol points can be Owen scrambled (hash based, Burley 2020) to
+// decorrelate dimensions and to give every frame or pixel its own
+// well-stratified set by changing only the seed.
+//
+// Hemispheres are oriented around +Y, the engine's up vector.
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Maths
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// PCG-XSH-RR with 64 bits of state. Generators with different stream
+	// indices produce independent sequences, so a stream per thread or per
+	// task needs no synchronisation.
+	class IOEPCG32
+	{
+	public:
+		explicit IOEPCG32(std::uint64_t uSeed = 0x853c49e6748fea9bull,
+						  std::uint64_t uStream = 0);
+
+		void Seed(std::uint64_t uSeed, std::uint64_t uStream);
+
+		// Skips uDelta outputs in O(log uDelta)
+		void Advance(std::uint64_t uDelta);
+
+		FORCEINLINE std::uint32_t NextUInt()
+		{
+			std::uint64_t uOldState(m_uState);
+			m_uState = uOldState * ms_uMultiplier + m_uIncrement;
+
+			std::uint32_t uXorShifted(static_cast<std::uint32_t>(
+				((uOldState >> 18u) ^ uOldState) >> 27u));
+			std::uint32_t uRotation(
+				static_cast<std::uint32_t>(uOldState >> 59u));
+			return (uXorShifted >> uRotation) |
+				   (uXorShifted << ((0u - uRotation) & 31u));
+		}
+
+		// Unbiased integer in [0, uBound)
+		std::uint32_t NextUInt(std::uint32_t uBound);
+
+		// Uniform float in [0, 1)
+		FORCEINLINE float NextFloat();
+
+	private:
+		static const std::uint64_t ms_uMultiplier = 6364136223846793005ull;
+
+		std::uint64_t m_uState;
+		std::uint64_t m_uIncrement;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Four xoshiro128+ generators, one per SSE2 lane. Lanes and streams are
+	// seeded through SplitMix64, so distinct (seed, stream) pairs start at
+	// unrelated points of the 2^128 - 1 period.
+	class alignas(16) IOEXoshiro128x4
+	{
+	public:
+		explicit IOEXoshiro128x4(std::uint64_t uSeed = 0,
+								 std::uint64_t uStream = 0);
+
+		void Seed(std::uint64_t uSeed, std::uint64_t uStream);
+
+		FORCEINLINE __m128i NextUInt4()
+		{
+			__m128i vResult(_mm_add_epi32(m_arrState[0], m_arrState[3]));
+			__m128i vT(_mm_slli_epi32(m_arrState[1], 9));
+
+			m_arrState[2] = _mm_xor_si128(m_arrState[2], m_arrState[0]);
+			m_arrState[3] = _mm_xor_si128(m_arrState[3], m_arrState[1]);
+			m_arrState[1] = _mm_xor_si128(m_arrState[1], m_arrState[2]);
+			m_arrState[0] = _mm_xor_si128(m_arrState[0], m_arrState[3]);
+			m_arrState[2] = _mm_xor_si128(m_arrState[2], vT);
+			m_arrState[3] = _mm_or_si128(_mm_slli_epi32(m_arrState[3], 11),
+										 _mm_srli_epi32(m_arrState[3], 21));
+			return vResult;
+		}
+
+		// Uniform floats in [0, 1) built from the 23 high bits, which are
+		// the statistically strong bits of xoshiro128+
+		FORCEINLINE __m128 NextFloat4()
+		{
+			__m128i vMantissa(_mm_or_si128(_mm_srli_epi32(NextUInt4(), 9),
+										   _mm_set1_epi32(0x3f800000)));
+			return _mm_sub_ps(_mm_castsi128_ps(vMantissa), _mm_set1_ps(1.0f));
+		}
+
+		FORCEINLINE IOEVector NextVector()
+		{
+			return IOEVector(NextFloat4());
+		}
+
+	private:
+		__m128i m_arrState[4];
+	};
+
+namespace Sampling
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	static const std::uint32_t ms_uSobolMaxDimensions  = 8;
+	static const std::uint32_t ms_uHaltonMaxDimensions = 16;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Bit and hash helpers
+
+	FORCEINLINE std::uint32_t ReverseBits(std::uint32_t uValue)
+	{
+		uValue = (uValue << 16) | (uValue >> 16);
+		uValue = ((uValue & 0x00ff00ffu) << 8) | ((uValue & 0xff00ff00u) >> 8);
+		uValue = ((uValue & 0x0f0f0f0fu) << 4) | ((uValue & 0xf0f0f0f0u) >> 4);
+		uValue = ((uValue & 0x33333333u) << 2) | ((uValue & 0xccccccccu) >> 2);
+		uValue = ((uValue & 0x55555555u) << 1) | ((uValue & 0xaaaaaaaau) >> 1);
+		return uValue;
+	}
+
+	// Well mixed 32 bit integer hash, used to derive independent seeds
+	FORCEINLINE std::uint32_t HashUInt(std::uint32_t uValue)
+	{
+		uValue ^= uValue >> 16;
+		uValue *= 0x7feb352du;
+		uValue ^= uValue >> 15;
+		uValue *= 0x846ca68bu;
+		uValue ^= uValue >> 16;
+		return uValue;
+	}
+
+	FORCEINLINE std::uint32_t HashCombine(std::uint32_t uSeed,
+										  std::uint32_t uValue)
+	{
+		return uSeed ^ (uValue + 0x9e3779b9u + (uSeed << 6) + (uSeed >> 2));
+	}
+
+	// Maps all 32 bits to [0, 1) without ever rounding up to 1
+	FORCEINLINE float UIntToUnitFloat(std::uint32_t uValue)
+	{
+		return static_cast<float>(uValue >> 8) * (1.0f / 16777216.0f);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Owen scrambling
+
+	// Nested uniform scramble of a 0.32 fixed point value. Every seed is a
+	// different random permutation that preserves the stratification of
+	// (t, m, s)-nets.
+	FORCEINLINE std::uint32_t OwenScramble(std::uint32_t uValue,
+										   std::uint32_t uSeed)
+	{
+		uValue = ReverseBits(uValue);
+		uValue += uSeed;
+		uValue ^= uValue * 0x6c50b47cu;
+		uValue ^= uValue * 0xb82f1e52u;
+		uValue ^= uValue * 0xc7afe638u;
+		uValue ^= uValue * 0x8d22f6e6u;
+		return ReverseBits(uValue);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Sequences
+
+	// Raw 0.32 fixed point Sobol coordinate
+	std::uint32_t SobolUInt(std::uint32_t uIndex, std::uint32_t uDimension);
+
+	FORCEINLINE float Sobol(std::uint32_t uIndex, std::uint32_t uDimension)
+	{
+		return UIntToUnitFloat(SobolUInt(uIndex, uDimension));
+	}
+
+	// Owen scrambled and index shuffled Sobol. Each seed yields a new point
+	// set with the same stratification, so prefixes of any length stay
+	// well distributed.
+	FORCEINLINE float ScrambledSobol(std::uint32_t uIndex,
+									 std::uint32_t uDimension,
+									 std::uint32_t uSeed)
+	{
+		std::uint32_t uShuffled(OwenScramble(uIndex, HashUInt(uSeed)));
+		std::uint32_t uDimensionSeed(HashUInt(HashCombine(uSeed, uDimension)));
+		return UIntToUnitFloat(
+			OwenScramble(SobolUInt(uShuffled, uDimension), uDimensionSeed));
+	}
+
+	float RadicalInverse(std::uint32_t uBase, std::uint32_t uIndex);
+
+	// Uses the uDimension'th prime as its base
+	float Halton(std::uint32_t uIndex, std::uint32_t uDimension);
+
+	// Roberts' R1 (golden ratio) and R2 (plastic number) sequences in 0.32
+	// fixed point, offset by the optional Cranley-Patterson rotation
+	FORCEINLINE float R1(std::uint32_t uIndex, float fOffset = 0.5f)
+	{
+		std::uint32_t uOffset(static_cast<std::uint32_t>(
+			static_cast<double>(fOffset) * 4294967296.0));
+		return UIntToUnitFloat(uOffset + uIndex * 0x9e3779b9u);
+	}
+
+	FORCEINLINE void R2(std::uint32_t uIndex, float &fX, float &fY,
+						float fOffsetX = 0.5f, float fOffsetY = 0.5f)
+	{
+		std::uint32_t uOffsetX(static_cast<std::uint32_t>(
+			static_cast<double>(fOffsetX) * 4294967296.0));
+		std::uint32_t uOffsetY(static_cast<std::uint32_t>(
+			static_cast<double>(fOffsetY) * 4294967296.0));
+		fX = UIntToUnitFloat(uOffsetX + uIndex * 0xc13fa9a9u);
+		fY = UIntToUnitFloat(uOffsetY + uIndex * 0x91e10da6u);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Per-thread generators
+
+	// Lazily seeded generator owned by the calling thread. Every thread
+	// gets its own PCG stream, so the result must not be shared.
+	IOEPCG32 &GetThreadRandom();
+
+	//////////////////////////////////////////////////////////////////////////
+	// Scalar warps
+
+	FORCEINLINE float UniformSpherePdf()
+	{
+		return 1.0f / (4.0f * IOE_PI_F);
+	}
+
+	FORCEINLINE float UniformHemispherePdf()
+	{
+		return 1.0f / IOE_TWO_PI_F;
+	}
+
+	FORCEINLINE float CosineHemispherePdf(float fCosTheta)
+	{
+		return fCosTheta * (1.0f / IOE_PI_F);
+	}
+
+	// Shirley-Chiu concentric map onto the unit disc, which keeps the
+	// strata of the input intact
+	FORCEINLINE void ConcentricSampleDisc(float fU1, float fU2, float &fX,
+										  float &fY)
+	{
+		float fA(2.0f * fU1 - 1.0f);
+		float fB(2.0f * fU2 - 1.0f);
+		if (fA == 0.0f && fB == 0.0f)
+		{
+			fX = fY = 0.0f;
+			return;
+		}
+
+		float fRadius, fPhi;
+		if (Abs(fA) > Abs(fB))
+		{
+			fRadius = fA;
+			fPhi	= (IOE_PI_F * 0.25f) * (fB / fA);
+		}
+		else
+		{
+			fRadius = fB;
+			fPhi	= (IOE_PI_F * 0.5f) - (IOE_PI_F * 0.25f) * (fA / fB);
+		}
+		fX = fRadius * Cos(fPhi);
+		fY = fRadius * Sin(fPhi);
+	}
+
+	// Uniform over the band of the unit sphere with fYMin <= y <= fYMax.
+	// Equal areas of the unit square map to equal solid angles.
+	FORCEINLINE void UniformSampleZone(float fU1, float fU2, float fYMin,
+									   float fYMax, float &fX, float &fY,
+									   float &fZ)
+	{
+		fY = fYMin + (fYMax - fYMin) * fU1;
+		float fRadius(std::sqrt(Max(0.0f, 1.0f - fY * fY)));
+		float fPhi(IOE_TWO_PI_F * fU2);
+		fX = fRadius * Cos(fPhi);
+		fZ = fRadius * Sin(fPhi);
+	}
+
+	FORCEINLINE void UniformSampleSphere(float fU1, float fU2, float &fX,
+										 float &fY, float &fZ)
+	{
+		UniformSampleZone(fU1, fU2, -1.0f, 1.0f, fX, fY, fZ);
+	}
+
+	FORCEINLINE void UniformSampleHemisphere(float fU1, float fU2, float &fX,
+											 float &fY, float &fZ)
+	{
+		UniformSampleZone(fU1, fU2, 0.0f, 1.0f, fX, fY, fZ);
+	}
+
+	// Malley's method: project concentric disc samples up onto +Y
+	FORCEINLINE void CosineSampleHemisphere(float fU1, float fU2, float &fX,
+											float &fY, float &fZ)
+	{
+		ConcentricSampleDisc(fU1, fU2, fX, fZ);
+		fY = std::sqrt(Max(0.0f, 1.0f - fX * fX - fZ * fZ));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// Packet warps, four samples at a time
+
+	FORCEINLINE void ConcentricSampleDisc(__m128 vU1, __m128 vU2, __m128 &vX,
+										  __m128 &vY)
+	{
+		using namespace SIMD::Detail;
+
+		__m128 vA(_mm_sub_ps(_mm_add_ps(vU1, vU1), Splat(1.0f)));
+		__m128 vB(_mm_sub_ps(_mm_add_ps(vU2, vU2), Splat(1.0f)));
+
+		// The first branch of the scalar version where |a| > |b|
+		__m128 vMajorA(_mm_cmpgt_ps(Abs(vA), Abs(vB)));
+		__m128 vRadius(Select(vB, vA, vMajorA));
+		__m128 vNumerator(Select(vA, vB, vMajorA));
+
+		// Only zero when a == b == 0, where the radius is zero as well
+		__m128 vDenominator(Select(
+			vRadius, Splat(1.0f), _mm_cmpeq_ps(vRadius, _mm_setzero_ps())));
+		__m128 vRatio(_mm_mul_ps(_mm_div_ps(vNumerator, vDenominator),
+								 Splat(IOE_PI_F * 0.25f)));
+		__m128 vPhi(Select(_mm_sub_ps(Splat(IOE_PI_F * 0.5f), vRatio), vRatio,
+						   vMajorA));
+
+		__m128 vSin, vCos;
+		SIMD::SinCos(vPhi, vSin, vCos);
+		vX = _mm_mul_ps(vRadius, vCos);
+		vY = _mm_mul_ps(vRadius, vSin);
+	}
+
+	FORCEINLINE void UniformSampleZone(__m128 vU1, __m128 vU2, float fYMin,
+									   float fYMax, __m128 &vX, __m128 &vY,
+									   __m128 &vZ)
+	{
+		using namespace SIMD::Detail;
+
+		vY = Madd(vU1, Splat(fYMax - fYMin), Splat(fYMin));
+		__m128 vRadius(_mm_sqrt_ps(_mm_max_ps(
+			_mm_setzero_ps(), _mm_sub_ps(Splat(1.0f), _mm_mul_ps(vY, vY)))));
+
+		__m128 vSin, vCos;
+		SIMD::SinCos(_mm_mul_ps(vU2, Splat(IOE_TWO_PI_F)), vSin, vCos);
+		vX = _mm_mul_ps(vRadius, vCos);
+		vZ = _mm_mul_ps(vRadius, vSin);
+	}
+
+	FORCEINLINE void UniformSampleSphere(__m128 vU1, __m128 vU2, __m128 &vX,
+										 __m128 &vY, __m128 &vZ)
+	{
+		UniformSampleZone(vU1, vU2, -1.0f, 1.0f, vX, vY, vZ);
+	}
+
+	FORCEINLINE void UniformSampleHemisphere(__m128 vU1, __m128 vU2,
+											 __m128 &vX, __m128 &vY,
+											 __m128 &vZ)
+	{
+		UniformSampleZone(vU1, vU2, 0.0f, 1.0f, vX, vY, vZ);
+	}
+
+	FORCEINLINE void CosineSampleHemisphere(__m128 vU1, __m128 vU2,
+											__m128 &vX, __m128 &vY,
+											__m128 &vZ)
+	{
+		ConcentricSampleDisc(vU1, vU2, vX, vZ);
+		__m128 vRadiusSq(_mm_add_ps(_mm_mul_ps(vX, vX), _mm_mul_ps(vZ, vZ)));
+		vY = _mm_sqrt_ps(_mm_max_ps(
+			_mm_setzero_ps(), _mm_sub_ps(_mm_set1_ps(1.0f), vRadiusSq)));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Sampling
+
+	//////////////////////////////////////////////////////////////////////////
+
+	FORCEINLINE float IOEPCG32::NextFloat()
+	{
+		return Sampling::UIntToUnitFloat(NextUInt());
+	}
+
+} // namespace Maths
+} // namespace IOE
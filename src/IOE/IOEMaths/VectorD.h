@@ -0,0 +1,404 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include <immintrin.h>
+
+#include <IOE/IOECore/IOEDefines.h>
+#include <IOE/IOEMaths/Vector.h>
+
+//////////////////////////////////////////////////////////////////////////
+// Double precision vector for world placement. Positions far from the
+// origin are kept in these and only rebased to float relative to the
+// camera's world origin when they are handed to the renderer.
+//
+// Builds with AVX enabled (/arch:AVX) keep the four doubles in one ymm
+// register; otherwise they are split across two SSE2 registers, so the
+// default build runs on any x64 CPU. It is meant for locals and arguments;
+// long lived positions should be stored as plain doubles (see
+// IOEWorldPositionArray) as heap allocations are only 16 byte aligned.
+//////////////////////////////////////////////////////////////////////////
+
+#if defined(__AVX__)
+#define IOE_VECTORD_AVX IOE_ON
+#else
+#define IOE_VECTORD_AVX IOE_OFF
+#endif
+
+namespace IOE
+{
+namespace Maths
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace DoubleSIMD
+	{
+#if (IOE_VECTORD_AVX == IOE_ON)
+		typedef __m256d Double4;
+
+		FORCEINLINE Double4 Set(double fX, double fY, double fZ, double fW)
+		{
+			return _mm256_setr_pd(fX, fY, fZ, fW);
+		}
+		FORCEINLINE Double4 Splat(double fValue)
+		{
+			return _mm256_set1_pd(fValue);
+		}
+		FORCEINLINE Double4 Load(const double *pData)
+		{
+			return _mm256_loadu_pd(pData);
+		}
+		FORCEINLINE void Store(double *pData, const Double4 &vValue)
+		{
+			_mm256_storeu_pd(pData, vValue);
+		}
+		FORCEINLINE Double4 FromFloat(const __m128 &vValue)
+		{
+			return _mm256_cvtps_pd(vValue);
+		}
+		FORCEINLINE __m128 ToFloat(const Double4 &vValue)
+		{
+			return _mm256_cvtpd_ps(vValue);
+		}
+		FORCEINLINE Double4 Add(const Double4 &lhs, const Double4 &rhs)
+		{
+			return _mm256_add_pd(lhs, rhs);
+		}
+		FORCEINLINE Double4 Sub(const Double4 &lhs, const Double4 &rhs)
+		{
+			return _mm256_sub_pd(lhs, rhs);
+		}
+		FORCEINLINE Double4 Mul(const Double4 &lhs, const Double4 &rhs)
+		{
+			return _mm256_mul_pd(lhs, rhs);
+		}
+		FORCEINLINE Double4 Min(const Double4 &lhs, const Double4 &rhs)
+		{
+			return _mm256_min_pd(lhs, rhs);
+		}
+		FORCEINLINE Double4 Max(const Double4 &lhs, const Double4 &rhs)
+		{
+			return _mm256_max_pd(lhs, rhs);
+		}
+		FORCEINLINE bool AllEqual(const Double4 &lhs, const Double4 &rhs)
+		{
+			return _mm256_movemask_pd(_mm256_cmp_pd(lhs, rhs, _CMP_EQ_OQ)) ==
+				   0xf;
+		}
+#else  // IOE_VECTORD_AVX == IOE_ON
+		struct Double4
+		{
+			__m128d vXY;
+			__m128d vZW;
+		};
+
+		FORCEINLINE Double4 Set(double fX, double fY, double fZ, double fW)
+		{
+			Double4 vResult = {_mm_setr_pd(fX, fY), _mm_setr_pd(fZ, fW)};
+			return vResult;
+		}
+		FORCEINLINE Double4 Splat(double fValue)
+		{
+			Double4 vResult = {_mm_set1_pd(fValue), _mm_set1_pd(fValue)};
+			return vResult;
+		}
+		FORCEINLINE Double4 Load(const double *pData)
+		{
+			Double4 vResult = {_mm_loadu_pd(pData), _mm_loadu_pd(pData + 2)};
+			return vResult;
+		}
+		FORCEINLINE void Store(double *pData, const Double4 &vValue)
+		{
+			_mm_storeu_pd(pData, vValue.vXY);
+			_mm_storeu_pd(pData + 2, vValue.vZW);
+		}
+		FORCEINLINE Double4 FromFloat(const __m128 &vValue)
+		{
+			Double4 vResult = {_mm_cvtps_pd(vValue),
+							   _mm_cvtps_pd(_mm_movehl_ps(vValue, vValue))};
+			return vResult;
+		}
+		FORCEINLINE __m128 ToFloat(const Double4 &vValue)
+		{
+			return _mm_movelh_ps(_mm_cvtpd_ps(vValue.vXY),
+								 _mm_cvtpd_ps(vValue.vZW));
+		}
+		FORCEINLINE Double4 Add(const Double4 &lhs, const Double4 &rhs)
+		{
+			Double4 vResult = {_mm_add_pd(lhs.vXY, rhs.vXY),
+							   _mm_add_pd(lhs.vZW, rhs.vZW)};
+			return vResult;
+		}
+		FORCEINLINE Double4 Sub(const Double4 &lhs, const Double4 &rhs)
+		{
+			Double4 vResult = {_mm_sub_pd(lhs.vXY, rhs.vXY),
+							   _mm_sub_pd(lhs.vZW, rhs.vZW)};
+			return vResult;
+		}
+		FORCEINLINE Double4 Mul(const Double4 &lhs, const Double4 &rhs)
+		{
+			Double4 vResult = {_mm_mul_pd(lhs.vXY, rhs.vXY),
+							   _mm_mul_pd(lhs.vZW, rhs.vZW)};
+			return vResult;
+		}
+		FORCEINLINE Double4 Min(const Double4 &lhs, const Double4 &rhs)
+		{
+			Double4 vResult = {_mm_min_pd(lhs.vXY, rhs.vXY),
+							   _mm_min_pd(lhs.vZW, rhs.vZW)};
+			return vResult;
+		}
+		FORCEINLINE Double4 Max(const Double4 &lhs, const Double4 &rhs)
+		{
+			Double4 vResult = {_mm_max_pd(lhs.vXY, rhs.vXY),
+							   _mm_max_pd(lhs.vZW, rhs.vZW)};
+			return vResult;
+		}
+		FORCEINLINE bool AllEqual(const Double4 &lhs, const Double4 &rhs)
+		{
+			const __m128d vEqual(_mm_and_pd(_mm_cmpeq_pd(lhs.vXY, rhs.vXY),
+											_mm_cmpeq_pd(lhs.vZW, rhs.vZW)));
+			return _mm_movemask_pd(vEqual) == 0x3;
+		}
+#endif // IOE_VECTORD_AVX == IOE_ON
+	} // namespace DoubleSIMD
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class alignas(32) IOEVectorD
+	{
+	public:
+		FORCEINLINE IOEVectorD()
+		{
+		}
+
+		FORCEINLINE explicit IOEVectorD(double fValue)
+			: m_vVector(DoubleSIMD::Splat(fValue))
+		{
+		}
+
+		FORCEINLINE IOEVectorD(double fX, double fY, double fZ,
+							   double fW = 1.0)
+			: m_vVector(DoubleSIMD::Set(fX, fY, fZ, fW))
+		{
+		}
+
+		FORCEINLINE explicit IOEVectorD(const DoubleSIMD::Double4 &vData)
+			: m_vVector(vData)
+		{
+		}
+
+		FORCEINLINE explicit IOEVectorD(const IOEVector &vData)
+			: m_vVector(DoubleSIMD::FromFloat(vData.GetRaw()))
+		{
+		}
+
+	public:
+		FORCEINLINE const DoubleSIMD::Double4 &GetRaw() const
+		{
+			return m_vVector;
+		}
+
+		// Four doubles, no alignment requirement
+		FORCEINLINE static IOEVectorD Load(const double *pData)
+		{
+			return IOEVectorD(DoubleSIMD::Load(pData));
+		}
+
+		// x, y and z only, w is set to fW
+		FORCEINLINE static IOEVectorD Load3(const double *pData,
+											double fW = 1.0)
+		{
+			return IOEVectorD(pData[0], pData[1], pData[2], fW);
+		}
+
+		FORCEINLINE void Store(double *pData) const
+		{
+			DoubleSIMD::Store(pData, m_vVector);
+		}
+
+		FORCEINLINE void Store3(double *pData) const
+		{
+			double arrData[4];
+			DoubleSIMD::Store(arrData, m_vVector);
+			pData[0] = arrData[0];
+			pData[1] = arrData[1];
+			pData[2] = arrData[2];
+		}
+
+	public:
+		FORCEINLINE void Set(double fX, double fY, double fZ,
+							 double fW = 1.0)
+		{
+			m_vVector = DoubleSIMD::Set(fX, fY, fZ, fW);
+		}
+
+		FORCEINLINE void Get(double &fX, double &fY, double &fZ) const
+		{
+			double fW;
+			Get(fX, fY, fZ, fW);
+		}
+
+		FORCEINLINE void Get(double &fX, double &fY, double &fZ,
+							 double &fW) const
+		{
+			double arrData[4];
+			DoubleSIMD::Store(arrData, m_vVector);
+			fX = arrData[0];
+			fY = arrData[1];
+			fZ = arrData[2];
+			fW = arrData[3];
+		}
+
+		FORCEINLINE double GetX() const
+		{
+			return GetComponent(0);
+		}
+
+		FORCEINLINE double GetY() const
+		{
+			return GetComponent(1);
+		}
+
+		FORCEINLINE double GetZ() const
+		{
+			return GetComponent(2);
+		}
+
+		FORCEINLINE double GetW() const
+		{
+			return GetComponent(3);
+		}
+
+		// Rounds each component to the nearest float
+		FORCEINLINE IOEVector ToFloat() const
+		{
+			return IOEVector(DoubleSIMD::ToFloat(m_vVector));
+		}
+
+		// The difference is taken in double precision and then rounded, so
+		// the result is exact to float precision however far both points
+		// are from the origin. w is set to 1.
+		FORCEINLINE IOEVector GetRelativeTo(const IOEVectorD &vOrigin) const
+		{
+			__m128 vResult(DoubleSIMD::ToFloat(
+				DoubleSIMD::Sub(m_vVector, vOrigin.m_vVector)));
+			return IOEVector(_mm_shuffle_ps(
+				vResult, _mm_unpackhi_ps(vResult, _mm_set1_ps(1.0f)),
+				_MM_SHUFFLE(1, 0, 1, 0)));
+		}
+
+	public:
+		FORCEINLINE IOEVectorD operator+(const IOEVectorD &rhs) const
+		{
+			return IOEVectorD(DoubleSIMD::Add(m_vVector, rhs.m_vVector));
+		}
+
+		FORCEINLINE IOEVectorD operator-(const IOEVectorD &rhs) const
+		{
+			return IOEVectorD(DoubleSIMD::Sub(m_vVector, rhs.m_vVector));
+		}
+
+		FORCEINLINE IOEVectorD operator*(const IOEVectorD &rhs) const
+		{
+			return IOEVectorD(DoubleSIMD::Mul(m_vVector, rhs.m_vVector));
+		}
+
+		FORCEINLINE IOEVectorD operator*(double fScale) const
+		{
+			return IOEVectorD(
+				DoubleSIMD::Mul(m_vVector, DoubleSIMD::Splat(fScale)));
+		}
+
+		FORCEINLINE IOEVectorD operator-() const
+		{
+			return IOEVectorD(
+				DoubleSIMD::Sub(DoubleSIMD::Splat(0.0), m_vVector));
+		}
+
+		FORCEINLINE IOEVectorD &operator+=(const IOEVectorD &rhs)
+		{
+			m_vVector = DoubleSIMD::Add(m_vVector, rhs.m_vVector);
+			return *this;
+		}
+
+		FORCEINLINE IOEVectorD &operator-=(const IOEVectorD &rhs)
+		{
+			m_vVector = DoubleSIMD::Sub(m_vVector, rhs.m_vVector);
+			return *this;
+		}
+
+		FORCEINLINE IOEVectorD &operator*=(double fScale)
+		{
+			m_vVector = DoubleSIMD::Mul(m_vVector, DoubleSIMD::Splat(fScale));
+			return *this;
+		}
+
+		FORCEINLINE bool operator==(const IOEVectorD &rhs) const
+		{
+			return DoubleSIMD::AllEqual(m_vVector, rhs.m_vVector);
+		}
+
+		FORCEINLINE bool operator!=(const IOEVectorD &rhs) const
+		{
+			return !(operator==(rhs));
+		}
+
+	public:
+		FORCEINLINE static IOEVectorD Min(const IOEVectorD &lhs,
+										  const IOEVectorD &rhs)
+		{
+			return IOEVectorD(DoubleSIMD::Min(lhs.m_vVector, rhs.m_vVector));
+		}
+
+		FORCEINLINE static IOEVectorD Max(const IOEVectorD &lhs,
+										  const IOEVectorD &rhs)
+		{
+			return IOEVectorD(DoubleSIMD::Max(lhs.m_vVector, rhs.m_vVector));
+		}
+
+		FORCEINLINE double Dot(const IOEVectorD &rhs) const
+		{
+			// Sum of x, y and z
+			double arrProduct[4];
+			DoubleSIMD::Store(arrProduct,
+							  DoubleSIMD::Mul(m_vVector, rhs.m_vVector));
+			return arrProduct[0] + arrProduct[1] + arrProduct[2];
+		}
+
+		FORCEINLINE double LengthSquared() const
+		{
+			return Dot(*this);
+		}
+
+		FORCEINLINE double Length() const
+		{
+			return std::sqrt(LengthSquared());
+		}
+
+		FORCEINLINE IOEVectorD Cross(const IOEVectorD &rhs) const
+		{
+			double fX0, fY0, fZ0, fX1, fY1, fZ1;
+			Get(fX0, fY0, fZ0);
+			rhs.Get(fX1, fY1, fZ1);
+			return IOEVectorD(fY0 * fZ1 - fZ0 * fY1, fZ0 * fX1 - fX0 * fZ1,
+							  fX0 * fY1 - fY0 * fX1, 0.0);
+		}
+
+	private:
+		FORCEINLINE double GetComponent(std::int32_t nIdx) const
+		{
+			double arrData[4];
+			DoubleSIMD::Store(arrData, m_vVector);
+			return arrData[nIdx];
+		}
+
+	private:
+		DoubleSIMD::Double4 m_vVector;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Maths
+} // namespace IOE
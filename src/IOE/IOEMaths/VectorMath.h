@@ -0,0 +1,531 @@
+#pragma once
+
+#include <cfloat>
+#include <limits>
+
+#include <emmintrin.h>
+
+#include <IOE/IOECore/IOEPortable.h>
+
+//////////////////////////////////////////////////////////////////////////
+// Packet (4-wide SSE2) polynomial approximations of the transcendental
+// functions in Math.h. Every function exists in three precision tiers:
+//
+//	Fast   - short polynomials and hardware reciprocal estimates.
+//	Medium - full polynomials, Newton-refined reciprocals.
+//	Full   - full polynomials, exact divides and extended range reduction.
+//
+// Maximum errors were measured against the double precision CRT on random
+// inputs over the stated domain, in units in the last place (ULP) of the
+// float result or as absolute error where the result crosses zero. The
+// unit-tests/VectorMathTest project measures them again and fails when a
+// tier exceeds its bound. Non-finite inputs are only handled where stated
+// and denormal results are flushed to zero.
+//
+//	Function   Domain                     Fast         Medium       Full
+//	Sin/Cos    |x| <= pi/4                610 ULP      1 ULP        1 ULP
+//	           |x| <= pi                  3.7e-5 abs   7.8e-8 abs   7.8e-8 abs
+//	           |x| <= 8192                4.7e-4 abs   1.5e-7 abs   7.9e-8 abs
+//	ATan2      |x|, |y| <= 1000           6800 ULP     6 ULP        4 ULP
+//	Exp        [-87.3, 88.7]              670 ULP      3 ULP        1 ULP
+//	Log        [FLT_MIN, FLT_MAX]         4800 ULP     1 ULP        1 ULP
+//	           [FLT_MIN, FLT_MAX]         9.7e-5 abs   3.9e-6 abs   3.9e-6 abs
+//	Pow        x in [1e-3, 1e3], |y| <= 4 6100 ULP     33 ULP       33 ULP
+//	RSqrt      [FLT_MIN, FLT_MAX]         5000 ULP     4 ULP        2 ULP
+//
+// The Fast Log divides by a reciprocal estimate, so its error is relative
+// to the result and is largest in ULP just either side of x = 1. Its
+// absolute error stays small everywhere. The absolute error of the other
+// tiers is that of rounding results up to 88 in magnitude.
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Maths
+{
+
+	enum class EMathPrecision
+	{
+		Fast,
+		Medium,
+		Full,
+	};
+
+namespace SIMD
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace Detail
+	{
+		FORCEINLINE __m128 Splat(float fValue)
+		{
+			return _mm_set1_ps(fValue);
+		}
+
+		FORCEINLINE __m128 Madd(__m128 vA, __m128 vB, __m128 vC)
+		{
+			return _mm_add_ps(_mm_mul_ps(vA, vB), vC);
+		}
+
+		FORCEINLINE __m128 Select(__m128 vFalse, __m128 vTrue, __m128 vMask)
+		{
+			return _mm_or_ps(_mm_and_ps(vMask, vTrue),
+							 _mm_andnot_ps(vMask, vFalse));
+		}
+
+		FORCEINLINE __m128 SignBit()
+		{
+			return _mm_set1_ps(-0.0f);
+		}
+
+		FORCEINLINE __m128 Infinity()
+		{
+			return _mm_set1_ps(std::numeric_limits<float>::infinity());
+		}
+
+		FORCEINLINE __m128 Abs(__m128 vX)
+		{
+			return _mm_andnot_ps(SignBit(), vX);
+		}
+
+		// 2^n for integer n in [-126, 127]
+		FORCEINLINE __m128 Pow2(__m128i vN)
+		{
+			return _mm_castsi128_ps(_mm_slli_epi32(
+				_mm_add_epi32(vN, _mm_set1_epi32(127)), 23));
+		}
+
+		FORCEINLINE __m128 ReciprocalNR(__m128 vX)
+		{
+			__m128 vEst(_mm_rcp_ps(vX));
+			return _mm_mul_ps(vEst,
+							  _mm_sub_ps(Splat(2.0f), _mm_mul_ps(vX, vEst)));
+		}
+
+		//////////////////////////////////////////////////////////////////////
+
+		template <EMathPrecision ePrecision>
+		struct Kernels;
+
+		//////////////////////////////////////////////////////////////////////
+
+		template <>
+		struct Kernels<EMathPrecision::Fast>
+		{
+			static FORCEINLINE __m128 ReducePiOver2(__m128 vX, __m128 vJ)
+			{
+				return _mm_sub_ps(vX, _mm_mul_ps(vJ, Splat(1.57079632679f)));
+			}
+
+			// Taylor to r^5 / r^6 on [-pi/4, pi/4]
+			static FORCEINLINE __m128 SinPoly(__m128 vR, __m128 vZ)
+			{
+				__m128 vP(Splat(8.3333333e-3f));
+				vP = Madd(vP, vZ, Splat(-1.6666667e-1f));
+				return Madd(_mm_mul_ps(vP, vZ), vR, vR);
+			}
+
+			static FORCEINLINE __m128 CosPoly(__m128 vZ)
+			{
+				__m128 vP(Splat(-1.3888889e-3f));
+				vP = Madd(vP, vZ, Splat(4.1666667e-2f));
+				vP = Madd(vP, vZ, Splat(-0.5f));
+				return Madd(vP, vZ, Splat(1.0f));
+			}
+
+			static FORCEINLINE __m128 Divide(__m128 vA, __m128 vB)
+			{
+				return _mm_mul_ps(vA, _mm_rcp_ps(vB));
+			}
+
+			// Abramowitz & Stegun 4.4.49 on [0, 1]
+			static FORCEINLINE __m128 ATanUnit(__m128 vA)
+			{
+				__m128 vZ(_mm_mul_ps(vA, vA));
+				__m128 vP(Splat(0.0208351f));
+				vP = Madd(vP, vZ, Splat(-0.0851330f));
+				vP = Madd(vP, vZ, Splat(0.1801410f));
+				vP = Madd(vP, vZ, Splat(-0.3302995f));
+				vP = Madd(vP, vZ, Splat(0.9998660f));
+				return _mm_mul_ps(vP, vA);
+			}
+
+			// Taylor to r^4 on [-ln2/2, ln2/2]
+			static FORCEINLINE __m128 ExpPoly(__m128 vR)
+			{
+				__m128 vP(Splat(4.1666667e-2f));
+				vP = Madd(vP, vR, Splat(1.6666667e-1f));
+				vP = Madd(vP, vR, Splat(0.5f));
+				vP = Madd(vP, _mm_mul_ps(vR, vR), vR);
+				return _mm_add_ps(vP, Splat(1.0f));
+			}
+
+			// log(1 + f) = 2 atanh(f / (2 + f)), to s^5
+			static FORCEINLINE __m128 LogPoly(__m128 vF)
+			{
+				__m128 vS(Divide(vF, _mm_add_ps(vF, Splat(2.0f))));
+				__m128 vS2(_mm_mul_ps(vS, vS));
+				__m128 vP(Splat(0.4f));
+				vP = Madd(vP, vS2, Splat(0.6666667f));
+				vP = Madd(vP, vS2, Splat(2.0f));
+				return _mm_mul_ps(vP, vS);
+			}
+
+			static FORCEINLINE __m128 RSqrt(__m128 vX)
+			{
+				return _mm_rsqrt_ps(vX);
+			}
+		};
+
+		//////////////////////////////////////////////////////////////////////
+
+		template <>
+		struct Kernels<EMathPrecision::Full>
+		{
+			// Three-part Cody-Waite split of pi/2
+			static FORCEINLINE __m128 ReducePiOver2(__m128 vX, __m128 vJ)
+			{
+				vX = Madd(vJ, Splat(-1.5703125f), vX);
+				vX = Madd(vJ, Splat(-4.837512969970703125e-4f), vX);
+				return Madd(vJ, Splat(-7.54978995489188216e-8f), vX);
+			}
+
+			// Cephes sinf/cosf minimax on [-pi/4, pi/4]
+			static FORCEINLINE __m128 SinPoly(__m128 vR, __m128 vZ)
+			{
+				__m128 vP(Splat(-1.9515295891e-4f));
+				vP = Madd(vP, vZ, Splat(8.3321608736e-3f));
+				vP = Madd(vP, vZ, Splat(-1.6666654611e-1f));
+				return Madd(_mm_mul_ps(vP, vZ), vR, vR);
+			}
+
+			static FORCEINLINE __m128 CosPoly(__m128 vZ)
+			{
+				__m128 vP(Splat(2.443315711809948e-5f));
+				vP = Madd(vP, vZ, Splat(-1.388731625493765e-3f));
+				vP = Madd(vP, vZ, Splat(4.166664568298827e-2f));
+				vP = _mm_mul_ps(_mm_mul_ps(vP, vZ), vZ);
+				vP = Madd(vZ, Splat(-0.5f), vP);
+				return _mm_add_ps(vP, Splat(1.0f));
+			}
+
+			static FORCEINLINE __m128 Divide(__m128 vA, __m128 vB)
+			{
+				return _mm_div_ps(vA, vB);
+			}
+
+			// Cephes atanf on [0, 1] with an extra reduction above tan(pi/8)
+			static FORCEINLINE __m128 ATanUnit(__m128 vA)
+			{
+				__m128 vAbove(_mm_cmpgt_ps(vA, Splat(0.4142135623730950f)));
+				__m128 vReduced(Divide(_mm_sub_ps(vA, Splat(1.0f)),
+									   _mm_add_ps(vA, Splat(1.0f))));
+				vA = Select(vA, vReduced, vAbove);
+
+				__m128 vZ(_mm_mul_ps(vA, vA));
+				__m128 vP(Splat(8.05374449538e-2f));
+				vP = Madd(vP, vZ, Splat(-1.38776856032e-1f));
+				vP = Madd(vP, vZ, Splat(1.99777106478e-1f));
+				vP = Madd(vP, vZ, Splat(-3.33329491539e-1f));
+				vP = Madd(_mm_mul_ps(vP, vZ), vA, vA);
+
+				return _mm_add_ps(vP,
+								  _mm_and_ps(vAbove, Splat(0.78539816339f)));
+			}
+
+			// Cephes expf on [-ln2/2, ln2/2]
+			static FORCEINLINE __m128 ExpPoly(__m128 vR)
+			{
+				__m128 vP(Splat(1.9875691500e-4f));
+				vP = Madd(vP, vR, Splat(1.3981999507e-3f));
+				vP = Madd(vP, vR, Splat(8.3334519073e-3f));
+				vP = Madd(vP, vR, Splat(4.1665795894e-2f));
+				vP = Madd(vP, vR, Splat(1.6666665459e-1f));
+				vP = Madd(vP, vR, Splat(5.0000001201e-1f));
+				vP = Madd(vP, _mm_mul_ps(vR, vR), vR);
+				return _mm_add_ps(vP, Splat(1.0f));
+			}
+
+			// Cephes logf on [sqrt(0.5) - 1, sqrt(2) - 1]
+			static FORCEINLINE __m128 LogPoly(__m128 vF)
+			{
+				__m128 vZ(_mm_mul_ps(vF, vF));
+				__m128 vP(Splat(7.0376836292e-2f));
+				vP = Madd(vP, vF, Splat(-1.1514610310e-1f));
+				vP = Madd(vP, vF, Splat(1.1676998740e-1f));
+				vP = Madd(vP, vF, Splat(-1.2420140846e-1f));
+				vP = Madd(vP, vF, Splat(1.4249322787e-1f));
+				vP = Madd(vP, vF, Splat(-1.6668057665e-1f));
+				vP = Madd(vP, vF, Splat(2.0000714765e-1f));
+				vP = Madd(vP, vF, Splat(-2.4999993993e-1f));
+				vP = Madd(vP, vF, Splat(3.3333331174e-1f));
+				vP = _mm_mul_ps(_mm_mul_ps(vP, vF), vZ);
+				vP = Madd(vZ, Splat(-0.5f), vP);
+				return _mm_add_ps(vF, vP);
+			}
+
+			static FORCEINLINE __m128 RSqrt(__m128 vX)
+			{
+				return _mm_div_ps(Splat(1.0f), _mm_sqrt_ps(vX));
+			}
+		};
+
+		//////////////////////////////////////////////////////////////////////
+
+		template <>
+		struct Kernels<EMathPrecision::Medium> : Kernels<EMathPrecision::Full>
+		{
+			// Two-part Cody-Waite split of pi/2
+			static FORCEINLINE __m128 ReducePiOver2(__m128 vX, __m128 vJ)
+			{
+				vX = Madd(vJ, Splat(-1.5703125f), vX);
+				return Madd(vJ, Splat(-4.8382679e-4f), vX);
+			}
+
+			static FORCEINLINE __m128 Divide(__m128 vA, __m128 vB)
+			{
+				return _mm_mul_ps(vA, ReciprocalNR(vB));
+			}
+
+			static FORCEINLINE __m128 ATanUnit(__m128 vA)
+			{
+				__m128 vAbove(_mm_cmpgt_ps(vA, Splat(0.4142135623730950f)));
+				__m128 vReduced(Divide(_mm_sub_ps(vA, Splat(1.0f)),
+									   _mm_add_ps(vA, Splat(1.0f))));
+				vA = Select(vA, vReduced, vAbove);
+
+				__m128 vZ(_mm_mul_ps(vA, vA));
+				__m128 vP(Splat(8.05374449538e-2f));
+				vP = Madd(vP, vZ, Splat(-1.38776856032e-1f));
+				vP = Madd(vP, vZ, Splat(1.99777106478e-1f));
+				vP = Madd(vP, vZ, Splat(-3.33329491539e-1f));
+				vP = Madd(_mm_mul_ps(vP, vZ), vA, vA);
+
+				return _mm_add_ps(vP,
+								  _mm_and_ps(vAbove, Splat(0.78539816339f)));
+			}
+
+			// Taylor to r^6 on [-ln2/2, ln2/2]
+			static FORCEINLINE __m128 ExpPoly(__m128 vR)
+			{
+				__m128 vP(Splat(1.3888889e-3f));
+				vP = Madd(vP, vR, Splat(8.3333333e-3f));
+				vP = Madd(vP, vR, Splat(4.1666667e-2f));
+				vP = Madd(vP, vR, Splat(1.6666667e-1f));
+				vP = Madd(vP, vR, Splat(0.5f));
+				vP = Madd(vP, _mm_mul_ps(vR, vR), vR);
+				return _mm_add_ps(vP, Splat(1.0f));
+			}
+
+			static FORCEINLINE __m128 RSqrt(__m128 vX)
+			{
+				// One Newton-Raphson step on the hardware estimate
+				__m128 vEst(_mm_rsqrt_ps(vX));
+				__m128 vHalfX(_mm_mul_ps(vX, Splat(0.5f)));
+				__m128 vStep(_mm_sub_ps(
+					Splat(1.5f), _mm_mul_ps(vHalfX, _mm_mul_ps(vEst, vEst))));
+				return _mm_mul_ps(vEst, vStep);
+			}
+		};
+
+		//////////////////////////////////////////////////////////////////////
+
+		// Reduces x to r in [-pi/4, pi/4] with x = r + j * pi/2 and evaluates
+		// both polynomials. The quadrant j is returned for the caller to pick
+		// and sign the result.
+		template <EMathPrecision ePrecision>
+		FORCEINLINE __m128i SinCosReduced(__m128 vX, __m128 &vSinR,
+										   __m128 &vCosR)
+		{
+			__m128i vJ(_mm_cvtps_epi32(_mm_mul_ps(vX, Splat(0.636619772367f))));
+			__m128 vR(Kernels<ePrecision>::ReducePiOver2(
+				vX, _mm_cvtepi32_ps(vJ)));
+			__m128 vZ(_mm_mul_ps(vR, vR));
+
+			vSinR = Kernels<ePrecision>::SinPoly(vR, vZ);
+			vCosR = Kernels<ePrecision>::CosPoly(vZ);
+			return vJ;
+		}
+
+		// Sign bit set where bit 1 of the quadrant is set
+		FORCEINLINE __m128 QuadrantSign(__m128i vJ)
+		{
+			return _mm_castsi128_ps(
+				_mm_slli_epi32(_mm_and_si128(vJ, _mm_set1_epi32(2)), 30));
+		}
+
+		FORCEINLINE __m128 QuadrantOdd(__m128i vJ)
+		{
+			__m128i vOne(_mm_set1_epi32(1));
+			return _mm_castsi128_ps(
+				_mm_cmpeq_epi32(_mm_and_si128(vJ, vOne), vOne));
+		}
+	} // namespace Detail
+
+	//////////////////////////////////////////////////////////////////////////
+
+	template <EMathPrecision ePrecision = EMathPrecision::Full>
+	FORCEINLINE void SinCos(__m128 vX, __m128 &vSin, __m128 &vCos)
+	{
+		__m128 vSinR, vCosR;
+		__m128i vJ(Detail::SinCosReduced<ePrecision>(vX, vSinR, vCosR));
+		__m128 vOdd(Detail::QuadrantOdd(vJ));
+
+		vSin = _mm_xor_ps(Detail::Select(vSinR, vCosR, vOdd),
+						  Detail::QuadrantSign(vJ));
+		vCos = _mm_xor_ps(
+			Detail::Select(vCosR, vSinR, vOdd),
+			Detail::QuadrantSign(_mm_add_epi32(vJ, _mm_set1_epi32(1))));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	template <EMathPrecision ePrecision = EMathPrecision::Full>
+	FORCEINLINE __m128 Sin(__m128 vX)
+	{
+		__m128 vSinR, vCosR;
+		__m128i vJ(Detail::SinCosReduced<ePrecision>(vX, vSinR, vCosR));
+
+		return _mm_xor_ps(
+			Detail::Select(vSinR, vCosR, Detail::QuadrantOdd(vJ)),
+			Detail::QuadrantSign(vJ));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	template <EMathPrecision ePrecision = EMathPrecision::Full>
+	FORCEINLINE __m128 Cos(__m128 vX)
+	{
+		__m128 vSinR, vCosR;
+		__m128i vJ(Detail::SinCosReduced<ePrecision>(vX, vSinR, vCosR));
+
+		return _mm_xor_ps(
+			Detail::Select(vCosR, vSinR, Detail::QuadrantOdd(vJ)),
+			Detail::QuadrantSign(_mm_add_epi32(vJ, _mm_set1_epi32(1))));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Same argument order as std::atan2. atan2(0, 0) returns 0 and the sign
+	// of a zero x is ignored.
+	template <EMathPrecision ePrecision = EMathPrecision::Full>
+	FORCEINLINE __m128 ATan2(__m128 vY, __m128 vX)
+	{
+		__m128 vAbsX(Detail::Abs(vX));
+		__m128 vAbsY(Detail::Abs(vY));
+		__m128 vMax(_mm_max_ps(vAbsX, vAbsY));
+		__m128 vMin(_mm_min_ps(vAbsX, vAbsY));
+
+		__m128 vRatio(Detail::Kernels<ePrecision>::Divide(vMin, vMax));
+		vRatio = _mm_andnot_ps(_mm_cmpeq_ps(vMax, _mm_setzero_ps()), vRatio);
+
+		__m128 vAngle(Detail::Kernels<ePrecision>::ATanUnit(vRatio));
+		vAngle = Detail::Select(
+			vAngle, _mm_sub_ps(Detail::Splat(1.57079632679f), vAngle),
+			_mm_cmpgt_ps(vAbsY, vAbsX));
+		vAngle = Detail::Select(
+			vAngle, _mm_sub_ps(Detail::Splat(3.14159265359f), vAngle),
+			_mm_cmplt_ps(vX, _mm_setzero_ps()));
+
+		return _mm_or_ps(vAngle, _mm_and_ps(vY, Detail::SignBit()));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Returns +inf above ln(FLT_MAX) and 0 below ln(FLT_MIN). NaN is
+	// propagated.
+	template <EMathPrecision ePrecision = EMathPrecision::Full>
+	FORCEINLINE __m128 Exp(__m128 vX)
+	{
+		const __m128 vUpper(Detail::Splat(88.7228391f));
+		const __m128 vLower(Detail::Splat(-87.3365448f));
+
+		// The clamp below would replace NaN with the lower bound
+		__m128 vNaN(_mm_cmpunord_ps(vX, vX));
+		__m128 vOverflow(_mm_cmpgt_ps(vX, vUpper));
+		__m128 vUnderflow(_mm_cmplt_ps(vX, vLower));
+		vX = _mm_min_ps(_mm_max_ps(vX, vLower), vUpper);
+
+		__m128i vN(_mm_cvtps_epi32(
+			_mm_mul_ps(vX, Detail::Splat(1.44269504089f))));
+		__m128 vFN(_mm_cvtepi32_ps(vN));
+		__m128 vR(Detail::Madd(vFN, Detail::Splat(-0.693359375f), vX));
+		vR = Detail::Madd(vFN, Detail::Splat(2.12194440e-4f), vR);
+
+		// Split the scale in two so n = 128 does not overflow the exponent
+		__m128i vHalfN(_mm_srai_epi32(vN, 1));
+		__m128 vResult(Detail::Kernels<ePrecision>::ExpPoly(vR));
+		vResult = _mm_mul_ps(vResult, Detail::Pow2(vHalfN));
+		vResult = _mm_mul_ps(vResult, Detail::Pow2(_mm_sub_epi32(vN, vHalfN)));
+
+		vResult = Detail::Select(vResult, Detail::Infinity(), vOverflow);
+		return _mm_or_ps(_mm_andnot_ps(vUnderflow, vResult), vNaN);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Natural log. Negative inputs return NaN, zero and denormals return
+	// -inf and +inf is preserved.
+	template <EMathPrecision ePrecision = EMathPrecision::Full>
+	FORCEINLINE __m128 Log(__m128 vX)
+	{
+		__m128 vZero(_mm_cmplt_ps(Detail::Abs(vX), Detail::Splat(FLT_MIN)));
+		__m128 vInvalid(
+			_mm_andnot_ps(vZero, _mm_cmpnge_ps(vX, _mm_setzero_ps())));
+		__m128 vInfinite(_mm_cmpeq_ps(vX, Detail::Infinity()));
+
+		// x = m * 2^e with m in [0.5, 1)
+		__m128i vBits(_mm_castps_si128(vX));
+		__m128i vExponent(_mm_sub_epi32(_mm_srli_epi32(vBits, 23),
+										_mm_set1_epi32(126)));
+		__m128 vM(_mm_castsi128_ps(_mm_or_si128(
+			_mm_and_si128(vBits, _mm_set1_epi32(0x007fffff)),
+			_mm_set1_epi32(0x3f000000))));
+
+		// Re-centre m on 1 to keep the polynomial argument in
+		// [sqrt(0.5) - 1, sqrt(2) - 1]
+		__m128 vSmall(_mm_cmplt_ps(vM, Detail::Splat(0.707106781186547524f)));
+		__m128 vE(_mm_cvtepi32_ps(vExponent));
+		vE = _mm_sub_ps(vE, _mm_and_ps(vSmall, Detail::Splat(1.0f)));
+		__m128 vF(_mm_sub_ps(_mm_add_ps(vM, _mm_and_ps(vSmall, vM)),
+							 Detail::Splat(1.0f)));
+
+		__m128 vResult(Detail::Kernels<ePrecision>::LogPoly(vF));
+		vResult = Detail::Madd(vE, Detail::Splat(-2.12194440e-4f), vResult);
+		vResult = Detail::Madd(vE, Detail::Splat(0.693359375f), vResult);
+
+		vResult = Detail::Select(vResult, vX, vInfinite);
+		vResult = Detail::Select(
+			vResult, _mm_or_ps(Detail::Infinity(), Detail::SignBit()), vZero);
+		return Detail::Select(
+			vResult, Detail::Splat(std::numeric_limits<float>::quiet_NaN()),
+			vInvalid);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// exp(y * log(x)) for x >= 0; negative bases return NaN. The error is
+	// that of Exp plus |y * log(x)| times the absolute error of Log, so it
+	// grows with the magnitude of the result's exponent.
+	template <EMathPrecision ePrecision = EMathPrecision::Full>
+	FORCEINLINE __m128 Pow(__m128 vX, __m128 vY)
+	{
+		__m128 vResult(Exp<ePrecision>(_mm_mul_ps(vY, Log<ePrecision>(vX))));
+
+		// 0^0 = 1 and x^0 = 1 regardless of the Log result
+		return Detail::Select(vResult, Detail::Splat(1.0f),
+							  _mm_cmpeq_ps(vY, _mm_setzero_ps()));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	template <EMathPrecision ePrecision = EMathPrecision::Full>
+	FORCEINLINE __m128 RSqrt(__m128 vX)
+	{
+		return Detail::Kernels<ePrecision>::RSqrt(vX);
+	}
+
+} // namespace SIMD
+} // namespace Maths
+} // namespace IOE
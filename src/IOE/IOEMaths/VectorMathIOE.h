@@ -0,0 +1,77 @@
+#pragma once
+
+#include <IOE/IOEMaths/Vector.h>
+#include <IOE/IOEMaths/VectorMath.h>
+
+//////////////////////////////////////////////////////////////////////////
+// IOEVector overloads of the packet transcendentals in VectorMath.h. They
+// live apart so that VectorMath.h needs nothing but SSE2 and builds
+// wherever DirectXMath is not available.
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Maths
+{
+namespace SIMD
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	template <EMathPrecision ePrecision = EMathPrecision::Full>
+	FORCEINLINE IOEVector Sin(const IOEVector &vX)
+	{
+		return Sin<ePrecision>(vX.GetRaw());
+	}
+
+	template <EMathPrecision ePrecision = EMathPrecision::Full>
+	FORCEINLINE IOEVector Cos(const IOEVector &vX)
+	{
+		return Cos<ePrecision>(vX.GetRaw());
+	}
+
+	template <EMathPrecision ePrecision = EMathPrecision::Full>
+	FORCEINLINE void SinCos(const IOEVector &vX, IOEVector &vSin,
+							IOEVector &vCos)
+	{
+		__m128 vS, vC;
+		SinCos<ePrecision>(vX.GetRaw(), vS, vC);
+		vSin = vS;
+		vCos = vC;
+	}
+
+	template <EMathPrecision ePrecision = EMathPrecision::Full>
+	FORCEINLINE IOEVector ATan2(const IOEVector &vY, const IOEVector &vX)
+	{
+		return ATan2<ePrecision>(vY.GetRaw(), vX.GetRaw());
+	}
+
+	template <EMathPrecision ePrecision = EMathPrecision::Full>
+	FORCEINLINE IOEVector Exp(const IOEVector &vX)
+	{
+		return Exp<ePrecision>(vX.GetRaw());
+	}
+
+	template <EMathPrecision ePrecision = EMathPrecision::Full>
+	FORCEINLINE IOEVector Log(const IOEVector &vX)
+	{
+		return Log<ePrecision>(vX.GetRaw());
+	}
+
+	template <EMathPrecision ePrecision = EMathPrecision::Full>
+	FORCEINLINE IOEVector Pow(const IOEVector &vX, const IOEVector &vY)
+	{
+		return Pow<ePrecision>(vX.GetRaw(), vY.GetRaw());
+	}
+
+	template <EMathPrecision ePrecision = EMathPrecision::Full>
+	FORCEINLINE IOEVector RSqrt(const IOEVector &vX)
+	{
+		return RSqrt<ePrecision>(vX.GetRaw());
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace SIMD
+} // namespace Maths
+} // namespace IOE
@@ -1,8 +1,8 @@
 #include <d3d11.h>
 
+#include <vector>
+
 #include "IOEFont_Platform.h"
-#include "../IOEFont.h"
-#include "../IOERPI.h"
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -12,7 +12,8 @@ CreateWinFont(HDC hDC, const std::string &szFontName, std::uint32_t uHeight,
 {
 	LOGFONT tLogFont;
 
-	tLogFont.lfHeight = -MulDiv(uHeight, GetDeviceCaps(hDC, LOGPIXELSY), 72);
+	// Negative for the height of the em rather than the cell
+	tLogFont.lfHeight = -static_cast<LONG>(uHeight);
 	tLogFont.lfWidth	   = 0;
 	tLogFont.lfEscapement  = 0;
 	tLogFont.lfOrientation = 0;
@@ -36,76 +37,70 @@ CreateWinFont(HDC hDC, const std::string &szFontName, std::uint32_t uHeight,
 
 //////////////////////////////////////////////////////////////////////////
 
-static bool GenerateGlyphs(HDC hDC, int nWidth, int nHeight,
-						   IOE::Renderer::IOEFont *pFont)
+static bool RasteriseWinGlyph(HDC hDC, WCHAR wchCharacter,
+							  IOE::Renderer::IOEGlyphBitmap &rBitmap)
 {
-	SIZE tGlyphSize;
-
-	char chCharacter = 'x';
-	GetTextExtentPoint32(hDC, &chCharacter, 1, &tGlyphSize);
-
-	int nGlyphSpacing = int(ceilf(tGlyphSize.cy * .3f));
-
-	int nGlyphWidth  = 0;
-	int nGlyphHeight = 0;
-	LONG uMaxHeight  = 0;
-
-	for (int chCharacter = 32; chCharacter < 127; ++chCharacter)
+	// Characters the font lacks would otherwise come back as its missing
+	// glyph box
+	WORD uGlyphIndex(0);
+	if (GetGlyphIndicesW(hDC, &wchCharacter, 1, &uGlyphIndex,
+						 GGI_MARK_NONEXISTING_GLYPHS) == GDI_ERROR ||
+		uGlyphIndex == 0xFFFF)
 	{
-		char chGlyphCharacterCode = (char)chCharacter;
-		if (!GetTextExtentPoint32(hDC, &chGlyphCharacterCode, 1, &tGlyphSize))
-		{
-			tGlyphSize.cx = 0;
-			tGlyphSize.cy = 0;
-		}
-
-		if (nGlyphWidth + tGlyphSize.cx + nGlyphSpacing > nWidth)
-		{
-			nGlyphWidth = 0;
-			nGlyphHeight += uMaxHeight + 1;
-
-			uMaxHeight = 0;
-		}
-
-		if (nGlyphHeight + tGlyphSize.cy > nHeight)
-		{
-			if (pFont)
-			{
-				pFont->SetTextureSize((float)nWidth, (float)nHeight);
-			}
-			return false;
-		}
-
-		if (tGlyphSize.cy > uMaxHeight)
-		{
-			uMaxHeight = tGlyphSize.cy;
-		}
-
-		if (pFont != nullptr)
-		{
-			ExtTextOut(hDC, nGlyphWidth, nGlyphHeight, ETO_OPAQUE, nullptr,
-					   &chGlyphCharacterCode, 1, nullptr);
+		return false;
+	}
 
-			IOE::Renderer::IOEFontGlyph &rGlyph(
-				pFont->GetGlyph(chCharacter - 32));
+	TEXTMETRICW tTextMetrics;
+	if (!GetTextMetricsW(hDC, &tTextMetrics))
+	{
+		return false;
+	}
 
-			rGlyph.fTexMinX = nGlyphWidth / float(nWidth);
-			rGlyph.fTexMinY = nGlyphHeight / float(nHeight);
+	const MAT2 tIdentity = {{0, 1}, {0, 0}, {0, 0}, {0, 1}};
+	GLYPHMETRICS tGlyphMetrics;
+	const DWORD uSize(GetGlyphOutlineW(hDC, wchCharacter, GGO_GRAY8_BITMAP,
+									   &tGlyphMetrics, 0, nullptr,
+									   &tIdentity));
+	if (uSize == GDI_ERROR)
+	{
+		return false;
+	}
 
-			rGlyph.fTexMaxX = (nGlyphWidth + tGlyphSize.cx) / float(nWidth);
-			rGlyph.fTexMaxY = (nGlyphHeight + tGlyphSize.cy) / float(nHeight);
+	rBitmap.fAdvance	= static_cast<float>(tGlyphMetrics.gmCellIncX);
+	rBitmap.fLineHeight = static_cast<float>(tTextMetrics.tmHeight);
 
-			rGlyph.fSizeX = float(tGlyphSize.cx);
-			rGlyph.fSizeY = float(tGlyphSize.cy);
-		}
-		nGlyphWidth += tGlyphSize.cx + nGlyphSpacing;
+	// Blank glyphs such as space have an advance but no bitmap
+	if (uSize == 0)
+	{
+		return true;
 	}
 
-	if (pFont)
+	std::vector<BYTE> arrGrey(uSize);
+	if (GetGlyphOutlineW(hDC, wchCharacter, GGO_GRAY8_BITMAP, &tGlyphMetrics,
+						 uSize, arrGrey.data(), &tIdentity) == GDI_ERROR)
 	{
-		pFont->SetTextureSize((float)nWidth, (float)nHeight);
+		return false;
 	}
 
+	rBitmap.uWidth	  = tGlyphMetrics.gmBlackBoxX;
+	rBitmap.uHeight	  = tGlyphMetrics.gmBlackBoxY;
+	rBitmap.fBearingX = static_cast<float>(tGlyphMetrics.gmptGlyphOrigin.x);
+	rBitmap.fBearingY = static_cast<float>(
+		tTextMetrics.tmDescent + tGlyphMetrics.gmptGlyphOrigin.y -
+		static_cast<LONG>(tGlyphMetrics.gmBlackBoxY));
+
+	// Rows are padded to a DWORD, with 65 levels of coverage
+	const UINT uPitch((tGlyphMetrics.gmBlackBoxX + 3) & ~3u);
+	rBitmap.arrCoverage.resize(rBitmap.uWidth * rBitmap.uHeight);
+	for (UINT uY(0); uY < rBitmap.uHeight; ++uY)
+	{
+		for (UINT uX(0); uX < rBitmap.uWidth; ++uX)
+		{
+			const UINT uCoverage(arrGrey[uY * uPitch + uX] * 255u / 64u);
+			rBitmap.arrCoverage[uY * rBitmap.uWidth + uX] =
+				static_cast<std::uint8_t>(uCoverage > 255 ? 255 : uCoverage);
+		}
+	}
 	return true;
 }
 
@@ -118,90 +113,45 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
-	IOEFont_Platform::IOEFont_Platform(IOEFont *pFont)
-		: IOEFont_PlatformBase(pFont)
+	IOEFont_Platform::IOEFont_Platform(const std::string &szName,
+									   EFontCreationFlags::Enum eCreationFlags)
+		: IOEFont_PlatformBase(szName, eCreationFlags)
 	{
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOEFont_Platform::Setup(class IOERPI *pRPI)
+	bool IOEFont_Platform::RasteriseGlyph(std::uint32_t uCodePoint,
+										  std::uint32_t uPixelHeight,
+										  IOEGlyphBitmap &rBitmap)
 	{
-	}
-
-	//////////////////////////////////////////////////////////////////////////
+		if (uCodePoint > 0xFFFF ||
+			(uCodePoint >= 0xD800 && uCodePoint <= 0xDFFF))
+		{
+			return false;
+		}
 
-	void IOEFont_Platform::SetFontName(const std::string &szName)
-	{
+		// Only ever used from the atlas's worker, so a DC of its own each
+		// time rather than one shared with any other thread
 		HDC hDC = CreateCompatibleDC(NULL);
-
 		SetMapMode(hDC, MM_TEXT);
-		SaveDC(hDC);
-
-		HFONT hFont		= NULL;
-		HBITMAP hBitmap = NULL;
-
-		hFont = CreateWinFont(hDC, szName, GetFont()->GetHeight(),
-							  GetFont()->GetCreationFlags());
 
+		HFONT hFont = CreateWinFont(hDC, GetFontName(), uPixelHeight,
+									GetCreationFlags());
+		bool bRasterised(false);
 		if (hFont)
 		{
-			SelectObject(hDC, hFont);
-
-			int nRequiredTextureWidth = 128, nRequiredTextureHeight = 128;
-
-			// Find the best texture size to use to fit all glyphs onto the
-			// sheet at the given size.
-			// Make sure we only go up to 4k, don't want to go crazy!
-			while (!GenerateGlyphs(hDC, nRequiredTextureWidth,
-								   nRequiredTextureHeight, nullptr) &&
-				   (nRequiredTextureWidth != 4096 &&
-					nRequiredTextureHeight != 4096))
-			{
-				nRequiredTextureWidth *= 2;
-				nRequiredTextureHeight *= 2;
-			}
-			if (!(nRequiredTextureWidth == 4096 ||
-				  nRequiredTextureHeight == 4096))
-			{
-				BITMAPINFO tBitmapInfo;
-				memset(&tBitmapInfo, 0, sizeof tBitmapInfo);
-
-				tBitmapInfo.bmiHeader.biSize  = sizeof tBitmapInfo.bmiHeader;
-				tBitmapInfo.bmiHeader.biWidth = nRequiredTextureWidth;
-				tBitmapInfo.bmiHeader.biHeight =
-					-nRequiredTextureHeight; //-ve = top down
-				tBitmapInfo.bmiHeader.biPlanes		= 1;
-				tBitmapInfo.bmiHeader.biCompression = BI_RGB;
-				tBitmapInfo.bmiHeader.biBitCount	= 32;
-
-				DWORD *pByteData;
-
-				hBitmap = CreateDIBSection(hDC, &tBitmapInfo, DIB_RGB_COLORS,
-										   (void **)&pByteData, nullptr, 0);
-				if (hBitmap)
-				{
-					SelectObject(hDC, hBitmap);
-
-					SetTextColor(hDC, RGB(255, 255, 255));
-					SetBkColor(hDC, RGB(0, 0, 0));
-					SetTextAlign(hDC, TA_TOP);
-
-					GenerateGlyphs(hDC, nRequiredTextureWidth,
-								   nRequiredTextureHeight, GetFont());
-
-					GdiFlush();
-
-					for (int i = 0;
-						 i < nRequiredTextureWidth * nRequiredTextureHeight;
-						 ++i)
-					{
-						GetFont()->EmplaceTextureByte(
-							i, ((pByteData[i] & 0xFF) << 24) | 0x00FFFFFF);
-					}
-				}
-			}
+			HGDIOBJ hOldFont = SelectObject(hDC, hFont);
+
+			bRasterised = RasteriseWinGlyph(
+				hDC, static_cast<WCHAR>(uCodePoint), rBitmap);
+
+			SelectObject(hDC, hOldFont);
+			DeleteObject(hFont);
 		}
+
+		DeleteDC(hDC);
+		return bRasterised;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -5,7 +5,6 @@
 
 #include "IOEModel_Platform.h"
 #include "../IOEShader.h"
-#include "../IOEVisibilityBounds.h"
 
 namespace IOE
 {
@@ -103,6 +102,9 @@ namespace Renderer
 				pRPI->SetPrimitiveTopology(EPrimitiveTopology::TriangleList);
 				pDeviceContext->DrawIndexed(rIndex.m_nNumIndices,
 											rIndex.m_nStartIdx, 0);
+				pRPI->GetRenderStats().AddDraw(
+					EPrimitiveTopology::TriangleList,
+					static_cast<std::uint64_t>(rIndex.m_nNumIndices));
 			}
 		}
 	}
@@ -110,7 +112,8 @@ namespace Renderer
 	//////////////////////////////////////////////////////////////////////////
 
 	void IOEModel_Platform::OnRender(IOERPI *pRPI,
-									 IOEVisibilityLink *pHead,
+									 const std::uint32_t *pSubsets,
+									 std::uint32_t uNumSubsets,
 									 bool bSetShaderVariables /*=true*/)
 	{
 		if (m_pVertexBuffer != nullptr && m_pIndexBuffer != nullptr)
@@ -125,9 +128,10 @@ namespace Renderer
 			pDeviceContext->IASetIndexBuffer(m_pIndexBuffer.get(),
 											 DXGI_FORMAT_R32_UINT, 0);
 
-			while (pHead != nullptr)
+			for (std::uint32_t uIdx(0); uIdx < uNumSubsets; ++uIdx)
 			{
-				const MeshIndex &rIndex(*(pHead->pMeshIndex));
+				const MeshIndex &rIndex(GetModel().GetSubset(
+					static_cast<std::int32_t>(pSubsets[uIdx])));
 
 				// if (bSetShaderVariables)
 				{
@@ -137,13 +141,49 @@ namespace Renderer
 				pRPI->SetPrimitiveTopology(EPrimitiveTopology::TriangleList);
 				pDeviceContext->DrawIndexed(rIndex.m_nNumIndices,
 											rIndex.m_nStartIdx, 0);
-
-				pHead = pHead->pNext;
+				pRPI->GetRenderStats().AddDraw(
+					EPrimitiveTopology::TriangleList,
+					static_cast<std::uint64_t>(rIndex.m_nNumIndices));
 			}
 		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
+	void IOEModel_Platform::OnRenderInstanced(IOERPI *pRPI,
+											  std::uint32_t uSubset,
+											  std::uint32_t uNumInstances)
+	{
+		if (m_pVertexBuffer != nullptr && m_pIndexBuffer != nullptr)
+		{
+			ID3D11DeviceContext *pDeviceContext(
+				pRPI->GetPlatform().GetDeviceContext());
+
+			UINT uOffset(0);
+			UINT uStride(static_cast<UINT>(sizeof(ModelVertex)));
+			pDeviceContext->IASetVertexBuffers(0, 1, &m_pVertexBuffer,
+											   &uStride, &uOffset);
+			pDeviceContext->IASetIndexBuffer(m_pIndexBuffer.get(),
+											 DXGI_FORMAT_R32_UINT, 0);
+
+			const MeshIndex &rIndex(
+				GetModel().GetSubset(static_cast<std::int32_t>(uSubset)));
+			rIndex.m_pMaterial->SetAllVariables(pRPI);
+
+			// SV_InstanceID restarts from zero for every draw, so the first
+			// instance is passed to the shader rather than here
+			pRPI->SetPrimitiveTopology(EPrimitiveTopology::TriangleList);
+			pDeviceContext->DrawIndexedInstanced(
+				static_cast<UINT>(rIndex.m_nNumIndices), uNumInstances,
+				static_cast<UINT>(rIndex.m_nStartIdx), 0, 0);
+			pRPI->GetRenderStats().AddDraw(
+				EPrimitiveTopology::TriangleList,
+				static_cast<std::uint64_t>(rIndex.m_nNumIndices),
+				uNumInstances);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 } // namespace Renderer
 } // namespace IOE
\ No newline at end of file
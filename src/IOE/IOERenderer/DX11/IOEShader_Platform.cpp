@@ -13,6 +13,7 @@
 #include <IOE/IOERenderer/IOEShader.h>
 
 #include <D3Dcompiler.h>
+#include <d3d11_1.h>
 
 namespace IOE
 {
@@ -21,15 +22,90 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	namespace
+	{
+		const UINT g_uCompileFlags(
+#if (IOE_SHADER_DEBUG == IOE_ON)
+			D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION | D3DCOMPILE_PREFER_FLOW_CONTROL |
+			D3DCOMPILE_OPTIMIZATION_LEVEL0 |
+#else
+			D3DCOMPILE_OPTIMIZATION_LEVEL3 | D3DCOMPILE_AVOID_FLOW_CONTROL |
+#endif
+			D3DCOMPILE_WARNINGS_ARE_ERRORS);
+
+		void SetStageConstantBuffers(ID3D11DeviceContext *pDeviceContext, EShaderType::Enum eShaderType, UINT uStartSlot,
+									 UINT uNumSlots, ID3D11Buffer *const *ppBuffers)
+		{
+			switch (eShaderType)
+			{
+			case EShaderType::Vertex:
+				pDeviceContext->VSSetConstantBuffers(uStartSlot, uNumSlots, ppBuffers);
+				break;
+			case EShaderType::Geometry:
+				pDeviceContext->GSSetConstantBuffers(uStartSlot, uNumSlots, ppBuffers);
+				break;
+			case EShaderType::Hull:
+				pDeviceContext->HSSetConstantBuffers(uStartSlot, uNumSlots, ppBuffers);
+				break;
+			case EShaderType::Domain:
+				pDeviceContext->DSSetConstantBuffers(uStartSlot, uNumSlots, ppBuffers);
+				break;
+			case EShaderType::Fragment:
+				pDeviceContext->PSSetConstantBuffers(uStartSlot, uNumSlots, ppBuffers);
+				break;
+			case EShaderType::Compute:
+				pDeviceContext->CSSetConstantBuffers(uStartSlot, uNumSlots, ppBuffers);
+				break;
+			}
+		}
+
+		void SetStageConstantBuffers1(ID3D11DeviceContext1 *pDeviceContext, EShaderType::Enum eShaderType,
+									  UINT uStartSlot, UINT uNumSlots, ID3D11Buffer *const *ppBuffers,
+									  const UINT *pFirstConstants, const UINT *pNumConstants)
+		{
+			switch (eShaderType)
+			{
+			case EShaderType::Vertex:
+				pDeviceContext->VSSetConstantBuffers1(uStartSlot, uNumSlots, ppBuffers, pFirstConstants, pNumConstants);
+				break;
+			case EShaderType::Geometry:
+				pDeviceContext->GSSetConstantBuffers1(uStartSlot, uNumSlots, ppBuffers, pFirstConstants, pNumConstants);
+				break;
+			case EShaderType::Hull:
+				pDeviceContext->HSSetConstantBuffers1(uStartSlot, uNumSlots, ppBuffers, pFirstConstants, pNumConstants);
+				break;
+			case EShaderType::Domain:
+				pDeviceContext->DSSetConstantBuffers1(uStartSlot, uNumSlots, ppBuffers, pFirstConstants, pNumConstants);
+				break;
+			case EShaderType::Fragment:
+				pDeviceContext->PSSetConstantBuffers1(uStartSlot, uNumSlots, ppBuffers, pFirstConstants, pNumConstants);
+				break;
+			case EShaderType::Compute:
+				pDeviceContext->CSSetConstantBuffers1(uStartSlot, uNumSlots, ppBuffers, pFirstConstants, pNumConstants);
+				break;
+			}
+		}
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
 	IOEShader_Platform::IOEShader_Platform(IOEShader &rShader)
 		: IOEShader_PlatformBase(rShader)
 		, m_uNumCBuffers(0)
 	{
+		m_arrNumConstants.fill(16);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOEShader_Platform::Compile(const IOEShaderCompilationOptions &rOptions)
+	std::string IOEShader_Platform::GetCompilerSignature() const
+	{
+		return "D3DCompiler_" + std::to_string(D3D_COMPILER_VERSION) + " " + std::to_string(g_uCompileFlags);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShader_Platform::CompileShader(const IOEShaderCompilationOptions &rOptions, IOEShaderBinary &rBinary)
 	{
 		std::cout << "Compiling shader: " << IOE::Core::Algorithm::ConvertWideToNarrow(rOptions.szPath).c_str()
 #if (IOE_SHADER_DEBUG == IOE_ON)
@@ -37,8 +113,6 @@ namespace Renderer
 #endif
 				  << std::endl;
 
-		Cleanup();
-		m_rShader.SetVertexFormat(rOptions.pVertexFormat);
 		if (rOptions.pMacros != nullptr && rOptions.pMacros->size() > 0)
 		{
 			std::copy(std::begin(*rOptions.pMacros), std::end(*rOptions.pMacros), std::back_inserter(m_arrMacros));
@@ -63,19 +137,12 @@ namespace Renderer
 		}
 		std::wstring szPath(IOE::Core::g_pEngine->GetMediaPath() +
 							IOE::Core::IOEPlatformStatics_Platform::GetPathSplit() + rOptions.szPath);
+		TComSharedPtr<ID3DBlob> pCompiledShader;
 		TComSharedPtr<ID3DBlob> pErrors;
 
 		HRESULT tResult(D3DCompileFromFile(szPath.c_str(), pMacros, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-										   rOptions.szEntryPoint.c_str(), rOptions.szProfile.c_str(),
-
-#if (IOE_SHADER_DEBUG == IOE_ON)
-										   D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION |
-											   D3DCOMPILE_PREFER_FLOW_CONTROL | D3DCOMPILE_OPTIMIZATION_LEVEL0 |
-#else
-										   D3DCOMPILE_OPTIMIZATION_LEVEL3 | D3DCOMPILE_AVOID_FLOW_CONTROL |
-#endif
-											   D3DCOMPILE_WARNINGS_ARE_ERRORS,
-										   0, &m_pCompiledShader, &pErrors));
+										   rOptions.szEntryPoint.c_str(), rOptions.szProfile.c_str(), g_uCompileFlags,
+										   0, &pCompiledShader, &pErrors));
 		if (FAILED(tResult))
 		{
 			static const std::uint32_t uBufferSize = 1024 * 4;
@@ -89,16 +156,29 @@ namespace Renderer
 											   buffer);
 		}
 
+		const std::uint8_t *pBytecode(static_cast<const std::uint8_t *>(pCompiledShader->GetBufferPointer()));
+		rBinary.arrBytecode.assign(pBytecode, pBytecode + pCompiledShader->GetBufferSize());
+
+		FindShaderVariables(rBinary.arrBytecode, rBinary.arrConstantBuffers, rBinary.arrGlobalVariables);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShader_Platform::Create(const IOEShaderCompilationOptions &rOptions, const IOEShaderBinary &rBinary)
+	{
+		Cleanup();
+		m_rShader.SetVertexFormat(rOptions.pVertexFormat);
+
 		auto pPtr = IOERPI::GetSingletonPtr();
 		IOERPI_Platform &rPlatform(pPtr->GetPlatform());
 
-		tResult = E_FAIL;
+		HRESULT tResult(E_FAIL);
 
 		switch (rOptions.eShaderType)
 		{
 		case EShaderType::Vertex:
 			tResult = rPlatform.GetDevice()->CreateVertexShader(
-				m_pCompiledShader->GetBufferPointer(), m_pCompiledShader->GetBufferSize(), nullptr,
+				rBinary.arrBytecode.data(), rBinary.arrBytecode.size(), nullptr,
 				reinterpret_cast<ID3D11VertexShader **>(&m_pCreatedShader));
 			break;
 		case EShaderType::Geometry:
@@ -107,27 +187,27 @@ namespace Renderer
 			// m_pCompiledShader->GetBufferSize(), nullptr,
 			// reinterpret_cast<ID3D11GeometryShader**>(&m_pCreatedShader));
 			tResult = rPlatform.GetDevice()->CreateGeometryShader(
-				m_pCompiledShader->GetBufferPointer(), m_pCompiledShader->GetBufferSize(), nullptr,
+				rBinary.arrBytecode.data(), rBinary.arrBytecode.size(), nullptr,
 				reinterpret_cast<ID3D11GeometryShader **>(&m_pCreatedShader));
 			break;
 		case EShaderType::Hull:
 			tResult = rPlatform.GetDevice()->CreateHullShader(
-				m_pCompiledShader->GetBufferPointer(), m_pCompiledShader->GetBufferSize(), nullptr,
+				rBinary.arrBytecode.data(), rBinary.arrBytecode.size(), nullptr,
 				reinterpret_cast<ID3D11HullShader **>(&m_pCreatedShader));
 			break;
 		case EShaderType::Domain:
 			tResult = rPlatform.GetDevice()->CreateDomainShader(
-				m_pCompiledShader->GetBufferPointer(), m_pCompiledShader->GetBufferSize(), nullptr,
+				rBinary.arrBytecode.data(), rBinary.arrBytecode.size(), nullptr,
 				reinterpret_cast<ID3D11DomainShader **>(&m_pCreatedShader));
 			break;
 		case EShaderType::Fragment:
 			tResult = rPlatform.GetDevice()->CreatePixelShader(
-				m_pCompiledShader->GetBufferPointer(), m_pCompiledShader->GetBufferSize(), nullptr,
+				rBinary.arrBytecode.data(), rBinary.arrBytecode.size(), nullptr,
 				reinterpret_cast<ID3D11PixelShader **>(&m_pCreatedShader));
 			break;
 		case EShaderType::Compute:
 			tResult = rPlatform.GetDevice()->CreateComputeShader(
-				m_pCompiledShader->GetBufferPointer(), m_pCompiledShader->GetBufferSize(), nullptr,
+				rBinary.arrBytecode.data(), rBinary.arrBytecode.size(), nullptr,
 				reinterpret_cast<ID3D11ComputeShader **>(&m_pCreatedShader));
 			break;
 		}
@@ -138,8 +218,9 @@ namespace Renderer
 
 		if (rOptions.eShaderType == EShaderType::Vertex)
 		{
-			CreateInputLayout();
+			CreateInputLayout(rBinary);
 		}
+		CreateConstantBuffers(rBinary.arrConstantBuffers);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -148,12 +229,16 @@ namespace Renderer
 	{
 		m_pInputLayout.reset();
 		m_pCreatedShader.reset();
-		m_pCompiledShader.reset();
+		for (auto &pBuffer : m_arrConstantD3D11Buffers)
+		{
+			pBuffer.reset();
+		}
+		m_uNumCBuffers = 0;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOEShader_Platform::CreateInputLayout()
+	void IOEShader_Platform::CreateInputLayout(const IOEShaderBinary &rBinary)
 	{
 		auto pPtr = IOERPI::GetSingletonPtr();
 		IOERPI_Platform &rPlatform(pPtr->GetPlatform());
@@ -162,7 +247,7 @@ namespace Renderer
 
 		if (FAILED(rPlatform.GetDevice()->CreateInputLayout(
 				pVertexFormat->GetPlatform().GetInputDescription().data(), pVertexFormat->GetNumSemantics(),
-				m_pCompiledShader->GetBufferPointer(), m_pCompiledShader->GetBufferSize(), &m_pInputLayout)))
+				rBinary.arrBytecode.data(), rBinary.arrBytecode.size(), &m_pInputLayout)))
 		{
 			THROW_IOE_RENDERER_EXCEPTION("Failed to create input layout for shader", E_ERROR_FAILED_TO_COMPILE_SHADER);
 		}
@@ -170,14 +255,55 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOEShader_Platform::FindShaderVariables(ShaderConstantBuffers &arrConstantBuffers,
+	void IOEShader_Platform::CreateConstantBuffers(const ShaderConstantBuffers &arrConstantBuffers)
+	{
+		m_uNumCBuffers = 0;
+		for (const ShaderConstantBufferDescription &rBuffer : arrConstantBuffers)
+		{
+			if (rBuffer.nSizeBytes == 0)
+			{
+				continue;
+			}
+
+			// Bound in whole blocks of sixteen constants when other slots are bound at offsets
+			m_arrNumConstants[rBuffer.nSlotIdx] = static_cast<UINT>((rBuffer.nSizeBytes + 255) / 256 * 16);
+
+			// Create the D3D11 buffer of where to store the CBuffer data
+			D3D11_BUFFER_DESC tBufferDesc;
+
+			tBufferDesc.ByteWidth	  = static_cast<UINT>(rBuffer.nSizeBytes);
+			tBufferDesc.Usage		   = D3D11_USAGE_DYNAMIC;
+			tBufferDesc.BindFlags	  = D3D11_BIND_CONSTANT_BUFFER;
+			tBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+			tBufferDesc.MiscFlags	  = 0;
+
+			tBufferDesc.StructureByteStride = 0;
+
+			if (FAILED(IOERPI::GetSingletonPtr()->GetPlatform().GetDevice()->CreateBuffer(
+					&tBufferDesc, nullptr, &m_arrConstantD3D11Buffers[rBuffer.nSlotIdx])))
+			{
+				THROW_IOE_RENDERER_EXCEPTION_VARGS("Failed to create D3D11 Buffer to map CBuffer '%s'",
+												   E_ERROR_FAILED_TO_FIND_VARIABLES, rBuffer.szName);
+			}
+
+			if (rBuffer.nSlotIdx >= m_uNumCBuffers)
+			{
+				m_uNumCBuffers = static_cast<std::uint32_t>(rBuffer.nSlotIdx) + 1;
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShader_Platform::FindShaderVariables(const std::vector<std::uint8_t> &arrBytecode,
+												 ShaderConstantBuffers &arrConstantBuffers,
 												 ShaderCategories &arrDescriptions)
 	{
 		ID3D11ShaderReflection *pShaderVars;
 		// if (FAILED(D3DReflect(m_pCompiledShader->GetBufferPointer(),
 		// m_pCompiledShader->GetBufferSize(), IID_ID3D11ShaderReflection,
 		// (void **)&pRShader)))
-		if (FAILED(D3DReflect(m_pCompiledShader->GetBufferPointer(), m_pCompiledShader->GetBufferSize(),
+		if (FAILED(D3DReflect(arrBytecode.data(), arrBytecode.size(),
 							  /*__uuidof(ID3D11ShaderReflection)*/ IID_ID3D11ShaderReflection, (void **)&pShaderVars)))
 		{
 			THROW_IOE_RENDERER_EXCEPTION("Failed to get shader reflectioin parameters",
@@ -187,9 +313,6 @@ namespace Renderer
 		D3D11_SHADER_DESC tShaderDesc;
 		pShaderVars->GetDesc(&tShaderDesc);
 
-		m_uNumCBuffers		 = tShaderDesc.ConstantBuffers;
-		m_uNumBoundResources = tShaderDesc.BoundResources;
-
 		// Add variables from constant buffers.
 		for (std::uint32_t uBufferIdx(0); uBufferIdx < tShaderDesc.BoundResources; ++uBufferIdx)
 		{
@@ -252,9 +375,12 @@ namespace Renderer
 					E_ERROR_FAILED_TO_FIND_VARIABLES, bufferBindDesc.BindPoint,
 					ShaderConstantBufferDescription::ms_nMaxCBufferSlots);
 			}
-			if (bufferBindDesc.Type != D3D_SIT_CBUFFER && bufferBindDesc.Type != D3D_SIT_TBUFFER)
+			if (IOEEngineConstants::IsEngineSlot(bufferBindDesc.BindPoint))
+			{
+				// Bound once by the RPI for every shader
+			}
+			else if (bufferBindDesc.Type != D3D_SIT_CBUFFER && bufferBindDesc.Type != D3D_SIT_TBUFFER)
 			{
-				--m_uNumCBuffers;
 				/*switch (bufferBindDesc.Type)
 				{
 				case D3D_SIT_TEXTURE:
@@ -293,24 +419,6 @@ namespace Renderer
 				strcpy_s<64>(pCBuffer->szName, _strdup(bufferDesc.Name));
 				pCBuffer->nSizeBytes = bufferDesc.Size;
 
-				// Create the D3D11 buffer of where to store the CBuffer data
-				D3D11_BUFFER_DESC tBufferDesc;
-
-				tBufferDesc.ByteWidth	  = static_cast<UINT>(pCBuffer->nSizeBytes);
-				tBufferDesc.Usage		   = D3D11_USAGE_DYNAMIC;
-				tBufferDesc.BindFlags	  = D3D11_BIND_CONSTANT_BUFFER;
-				tBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-				tBufferDesc.MiscFlags	  = 0;
-
-				tBufferDesc.StructureByteStride = 0;
-
-				if (FAILED(IOERPI::GetSingletonPtr()->GetPlatform().GetDevice()->CreateBuffer(
-						&tBufferDesc, nullptr, &m_arrConstantD3D11Buffers[bufferBindDesc.BindPoint])))
-				{
-					THROW_IOE_RENDERER_EXCEPTION_VARGS("Failed to create D3D11 Buffer to map CBuffer '%s'",
-													   E_ERROR_FAILED_TO_FIND_VARIABLES, pCBuffer->szName);
-				}
-
 				for (std::uint32_t uVariableIdx(0); uVariableIdx < bufferDesc.Variables; ++uVariableIdx)
 				{
 					ID3D11ShaderReflectionVariable *pShaderVariable =
@@ -616,49 +724,94 @@ namespace Renderer
 
 	void IOEShader_Platform::Set(IOERPI *pRPI)
 	{
-		std::array<ID3D11Buffer *, ShaderConstantBufferDescription::ms_nMaxCBufferSlots> arrConstantD3D11Buffers;
-		std::transform(std::begin(m_arrConstantD3D11Buffers), std::end(m_arrConstantD3D11Buffers),
-					   std::begin(arrConstantD3D11Buffers),
-					   [](TComSharedPtr<ID3D11Buffer> &rVal) { return rVal.get(); });
-		ID3D11Buffer (**pBuffer)(arrConstantD3D11Buffers.data());
+		SetConstantBuffers(pRPI, 0, m_uNumCBuffers);
 		switch (m_rShader.GetShaderType())
 		{
 		case EShaderType::Vertex:
-			pRPI->GetPlatform().GetDeviceContext()->VSSetConstantBuffers(0, m_uNumCBuffers, pBuffer);
 			pRPI->GetPlatform().GetDeviceContext()->VSSetShader(
 				reinterpret_cast<ID3D11VertexShader *>(m_pCreatedShader.get()), nullptr, 0);
 			pRPI->GetPlatform().GetDeviceContext()->IASetInputLayout(m_pInputLayout.get());
 			break;
 		case EShaderType::Geometry:
-			pRPI->GetPlatform().GetDeviceContext()->GSSetConstantBuffers(0, m_uNumCBuffers, pBuffer);
 			pRPI->GetPlatform().GetDeviceContext()->GSSetShader(
 				reinterpret_cast<ID3D11GeometryShader *>(m_pCreatedShader.get()), nullptr, 0);
 			break;
 		case EShaderType::Hull:
-			pRPI->GetPlatform().GetDeviceContext()->HSSetConstantBuffers(0, m_uNumCBuffers, pBuffer);
 			pRPI->GetPlatform().GetDeviceContext()->HSSetShader(
 				reinterpret_cast<ID3D11HullShader *>(m_pCreatedShader.get()), nullptr, 0);
 			break;
 		case EShaderType::Domain:
-			pRPI->GetPlatform().GetDeviceContext()->DSSetConstantBuffers(0, m_uNumCBuffers, pBuffer);
 			pRPI->GetPlatform().GetDeviceContext()->DSSetShader(
 				reinterpret_cast<ID3D11DomainShader *>(m_pCreatedShader.get()), nullptr, 0);
 			break;
 		case EShaderType::Fragment:
-			pRPI->GetPlatform().GetDeviceContext()->PSSetConstantBuffers(0, m_uNumCBuffers, pBuffer);
 			pRPI->GetPlatform().GetDeviceContext()->PSSetShader(
 				reinterpret_cast<ID3D11PixelShader *>(m_pCreatedShader.get()), nullptr, 0);
 			break;
 		case EShaderType::Compute:
 			pRPI->GetPlatform().GetDeviceContext()->CSSetShader(
 				reinterpret_cast<ID3D11ComputeShader *>(m_pCreatedShader.get()), nullptr, 0);
-			pRPI->GetPlatform().GetDeviceContext()->CSSetConstantBuffers(0, m_uNumCBuffers, pBuffer);
 			break;
 		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
+	void IOEShader_Platform::BindConstantBuffer(IOERPI *pRPI, std::uint32_t uSlotIdx)
+	{
+		SetConstantBuffers(pRPI, uSlotIdx, 1);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShader_Platform::SetConstantBuffers(IOERPI *pRPI, std::uint32_t uStartSlot, std::uint32_t uNumSlots)
+	{
+		if (uNumSlots == 0)
+		{
+			return;
+		}
+
+		IOERPI_Platform &rPlatform(pRPI->GetPlatform());
+		std::array<ID3D11Buffer *, ShaderConstantBufferDescription::ms_nMaxCBufferSlots> arrBuffers;
+		std::array<UINT, ShaderConstantBufferDescription::ms_nMaxCBufferSlots> arrFirstConstants;
+		std::array<UINT, ShaderConstantBufferDescription::ms_nMaxCBufferSlots> arrNumConstants;
+		bool bAnyUploaded(false);
+		for (std::uint32_t uIdx(0); uIdx < uNumSlots; ++uIdx)
+		{
+			const std::uint32_t uSlotIdx(uStartSlot + uIdx);
+			std::uint32_t uOffset(0);
+			std::uint32_t uSizeBytes(0);
+			if (m_rShader.GetCBufferUpload(uSlotIdx, uOffset, uSizeBytes))
+			{
+				// Offsets and sizes are counted in sixteen byte constants
+				arrBuffers[uIdx]		= rPlatform.GetUploadRingBuffer(EUploadRing::Constant);
+				arrFirstConstants[uIdx] = uOffset / 16;
+				arrNumConstants[uIdx]   = uSizeBytes / 16;
+				bAnyUploaded			= true;
+			}
+			else
+			{
+				arrBuffers[uIdx]		= m_arrConstantD3D11Buffers[uSlotIdx].get();
+				arrFirstConstants[uIdx] = 0;
+				arrNumConstants[uIdx]   = m_arrNumConstants[uSlotIdx];
+			}
+		}
+
+		// The ring is only used when the context can bind at offsets
+		if (bAnyUploaded)
+		{
+			SetStageConstantBuffers1(rPlatform.GetDeviceContext1(), m_rShader.GetShaderType(), uStartSlot, uNumSlots,
+									 arrBuffers.data(), arrFirstConstants.data(), arrNumConstants.data());
+		}
+		else
+		{
+			SetStageConstantBuffers(rPlatform.GetDeviceContext(), m_rShader.GetShaderType(), uStartSlot, uNumSlots,
+									arrBuffers.data());
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 	bool IOEShader_Platform::SetTextureVariable(IOERPI *pRPI, const char *szTextureName, IOETexture *pTexture,
 												int arrOffset /*=0*/)
 	{
@@ -19,14 +19,17 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	// Rasterises through GDI, which takes UTF-16 code units, so only the
+	// basic multilingual plane has glyphs
 	class IOEFont_Platform : public IOEFont_PlatformBase
 	{
 	public:
-		IOEFont_Platform(class IOEFont *pFont);
+		IOEFont_Platform(const std::string &szName,
+						 EFontCreationFlags::Enum eCreationFlags);
 
-		virtual void Setup(class IOERPI *pRPI) override final;
-
-		virtual void SetFontName(const std::string &szName) override final;
+		virtual bool RasteriseGlyph(std::uint32_t uCodePoint,
+									std::uint32_t uPixelHeight,
+									IOEGlyphBitmap &rBitmap) override final;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
@@ -26,8 +26,13 @@ namespace Renderer
 		virtual void OnRender(class IOERPI *pRPI,
 							  bool bSetShaderVariables = true) override final;
 		virtual void OnRender(class IOERPI *pRPI,
-							  struct IOEVisibilityLink *pHead,
+							  const std::uint32_t *pSubsets,
+							  std::uint32_t uNumSubsets,
 							  bool bSetShaderVariables = true) override final;
+		virtual void OnRenderInstanced(class IOERPI *pRPI,
+									   std::uint32_t uSubset,
+									   std::uint32_t uNumInstances)
+			override final;
 		virtual void OnSetup(class IOERPI *pRPI) override final;
 
 	private:
@@ -1,4 +1,5 @@
 #include <memory>
+#include <thread>
 
 #include <d3d12.h>
 
@@ -266,6 +267,100 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	IOEGPUFence_Platform::IOEGPUFence_Platform()
+		: m_pDevice(nullptr)
+		, m_pDeviceContext(nullptr)
+		, m_uCompletedValue(0)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEGPUFence_Platform::Setup(ID3D11Device *pDevice, ID3D11DeviceContext *pDeviceContext)
+	{
+		m_pDevice		 = pDevice;
+		m_pDeviceContext = pDeviceContext;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEGPUFence_Platform::Release()
+	{
+		m_arrPendingQueries.clear();
+		m_arrFreeQueries.clear();
+		m_pDevice		 = nullptr;
+		m_pDeviceContext = nullptr;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEGPUFence_Platform::Signal(std::uint64_t uValue)
+	{
+		PendingQuery tQuery;
+		tQuery.uValue = uValue;
+		if (!m_arrFreeQueries.empty())
+		{
+			tQuery.pQuery = m_arrFreeQueries.back();
+			m_arrFreeQueries.pop_back();
+		}
+		else
+		{
+			D3D11_QUERY_DESC tQueryDesc;
+			tQueryDesc.Query	 = D3D11_QUERY_EVENT;
+			tQueryDesc.MiscFlags = 0;
+			if (FAILED(m_pDevice->CreateQuery(&tQueryDesc, &tQuery.pQuery)))
+			{
+				THROW_IOE_RENDERER_EXCEPTION("Failed to create fence query", E_ERROR_RENDERER_UNKNOWN);
+			}
+		}
+
+		m_pDeviceContext->End(tQuery.pQuery.get());
+		m_arrPendingQueries.push_back(tQuery);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint64_t IOEGPUFence_Platform::GetCompletedValue()
+	{
+		while (!m_arrPendingQueries.empty() &&
+			   m_pDeviceContext->GetData(m_arrPendingQueries.front().pQuery.get(), nullptr, 0,
+										 D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_FALSE)
+		{
+			RetireQuery();
+		}
+		return m_uCompletedValue;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEGPUFence_Platform::Wait(std::uint64_t uValue)
+	{
+		// Polling with flushes, so the queries waited on are submitted. A removed device fails every query, and
+		// nothing is left to wait for.
+		while (m_uCompletedValue < uValue && !m_arrPendingQueries.empty())
+		{
+			if (m_pDeviceContext->GetData(m_arrPendingQueries.front().pQuery.get(), nullptr, 0, 0) != S_FALSE)
+			{
+				RetireQuery();
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEGPUFence_Platform::RetireQuery()
+	{
+		m_uCompletedValue = m_arrPendingQueries.front().uValue;
+		m_arrFreeQueries.push_back(m_arrPendingQueries.front().pQuery);
+		m_arrPendingQueries.pop_front();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 	IOERPI_Platform::IOERPI_Platform()
 		: m_nNumRenderTargets(0)
 		, m_nNumUAVs(0)
@@ -274,6 +369,7 @@ namespace Renderer
 		{
 			m_arrUAVsWriteOffsets[nIdx] = 0;
 		}
+		m_arrUploadRingsDiscarded.fill(false);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -542,6 +638,8 @@ namespace Renderer
 		GetRPI()->Resize(static_cast<float>(rPlatform.GetWidth()), static_cast<float>(rPlatform.GetHeight()));
 
 		m_pD3DDevice->QueryInterface(__uuidof(ID3D11Debug), (void **)&m_pD3DDebug);
+		m_pD3DDeviceContext->QueryInterface(__uuidof(ID3D11DeviceContext1), (void **)&m_pD3DDeviceContext1);
+		m_tFence.Setup(m_pD3DDevice.get(), m_pD3DDeviceContext.get());
 
 #if (IOE_DEBUG_ENABLED == IOE_ON && IOE_RPI_PROFILE_MARKERS == IOE_ON)
 		m_pD3DDevice->QueryInterface(__uuidof(ID3DUserDefinedAnnotation), (void **)&m_pPerfAnnotations);
@@ -609,7 +707,14 @@ namespace Renderer
 
 		m_pDXGISwapChain.reset();
 		m_pD3DDebug.reset();
+		m_tFence.Release();
+		for (auto &pRing : m_arrUploadRings)
+		{
+			pRing.reset();
+		}
+
 		m_pD3DDevice.reset();
+		m_pD3DDeviceContext1.reset();
 		m_pD3DDeviceContext.reset();
 
 #if (IOE_DEBUG_ENABLED == IOE_ON && IOE_RPI_PROFILE_MARKERS == IOE_ON)
@@ -643,24 +748,39 @@ namespace Renderer
 	void IOERPI_Platform::FinishRender()
 	{
 		// Render the debug buffers
-
-		// Map and update the debug vertex buffer
-		D3D11_MAPPED_SUBRESOURCE tMappedBuffer;
-		if (!SUCCEEDED(m_pD3DDeviceContext->Map(m_pVertexBuffer.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &tMappedBuffer)))
-		{
-			THROW_IOE_RENDERER_EXCEPTION("Unable to map debug vertex buffer", E_ERROR_RENDERER_UNKNOWN);
-		}
-		DebugVertex *pVertices(static_cast<DebugVertex *>(tMappedBuffer.pData));
-		bool bRenderDebug(IOERPI::GetSingletonPtr()->WriteDebugData(pVertices) > 0);
-		m_pD3DDeviceContext->Unmap(m_pVertexBuffer.get(), 0);
-		if (bRenderDebug)
+		IOERPI *pRPI(GetRPI());
+		const std::uint32_t uNumVertices(pRPI->GetNumDebugVertices());
+		if (uNumVertices > 0)
 		{
-			IOERPI *pRPI(GetRPI());
+			const std::uint32_t uSizeBytes(uNumVertices * static_cast<std::uint32_t>(sizeof(DebugVertex)));
+			UINT uOffset(0);
+			ID3D11Buffer *pBuffer(m_arrUploadRings[EUploadRing::Vertex].get());
+			void *pData(pRPI->MapUpload(EUploadRing::Vertex, uSizeBytes, 16, uOffset));
+			if (pData == nullptr)
+			{
+				// More than the ring can hold in a frame, so the debug buffer is discarded and written instead
+				pBuffer = m_pVertexBuffer.get();
+				D3D11_MAPPED_SUBRESOURCE tMappedBuffer;
+				if (!SUCCEEDED(m_pD3DDeviceContext->Map(pBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &tMappedBuffer)))
+				{
+					THROW_IOE_RENDERER_EXCEPTION("Unable to map debug vertex buffer", E_ERROR_RENDERER_UNKNOWN);
+				}
+				pData = tMappedBuffer.pData;
+			}
+			pRPI->WriteDebugData(static_cast<DebugVertex *>(pData));
+			if (pBuffer == m_pVertexBuffer.get())
+			{
+				m_pD3DDeviceContext->Unmap(pBuffer, 0);
+			}
+			else
+			{
+				pRPI->UnmapUpload(EUploadRing::Vertex);
+			}
+
 			pRPI->GetDebugDrawMaterial()->Set(pRPI);
 
-			uint32_t uRendered(0);
 			UINT uStride(static_cast<UINT>(sizeof(DebugVertex)));
-			m_pD3DDeviceContext->IASetVertexBuffers(0, 1, &m_pVertexBuffer, &uStride, &uRendered);
+			m_pD3DDeviceContext->IASetVertexBuffers(0, 1, &pBuffer, &uStride, &uOffset);
 
 			std::uint32_t uNumPoints(pRPI->GetNumDebugPoints());
 			std::uint32_t uNumLines(pRPI->GetNumDebugLines());
@@ -726,10 +846,8 @@ namespace Renderer
 	void IOERPI_Platform::CreateDebugBuffers()
 	{
 		D3D11_BUFFER_DESC tBufferDesc;
-		tBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-		tBufferDesc.ByteWidth = sizeof(DebugVertex) * IOERPI::ms_uNumDebugPoints +
-			sizeof(DebugVertex) * IOERPI::ms_uNumDebugLines * 2 +
-			sizeof(DebugVertex) * IOERPI::ms_uNumDebugTriangles * 3;
+		tBufferDesc.BindFlags			= D3D11_BIND_VERTEX_BUFFER;
+		tBufferDesc.ByteWidth			= sizeof(DebugVertex) * IOERPI::ms_uMaxDebugVertices;
 		tBufferDesc.CPUAccessFlags		= D3D11_CPU_ACCESS_WRITE;
 		tBufferDesc.MiscFlags			= 0;
 		tBufferDesc.Usage				= D3D11_USAGE_DYNAMIC;
@@ -774,13 +892,13 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOERPI_Platform::SetRenderTargets(std::vector<IOE::Renderer::IOETexture> arrTextures, bool bSet /*=true*/)
+	void IOERPI_Platform::SetRenderTargets(IOETextureSpan arrTextures, bool bSet /*=true*/)
 	{
 		m_nNumRenderTargets = 0;
-		for (auto &rTexture : arrTextures)
+		for (IOETexture *pTexture : arrTextures)
 		{
 			m_arrRenderTargets[m_nNumRenderTargets++] =
-				TComPtrCast<ID3D11RenderTargetView>(rTexture.GetPlatform().GetViewShared());
+				TComPtrCast<ID3D11RenderTargetView>(pTexture->GetPlatform().GetViewShared());
 		}
 		if (bSet)
 		{
@@ -899,7 +1017,7 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOERPI_Platform::SetUAVs(std::vector<IOE::Renderer::IOETexture> arrTextures, EUAVSet bSet)
+	void IOERPI_Platform::SetUAVs(IOETextureSpan arrTextures, EUAVSet bSet)
 	{
 #if 0
 		m_nNumUAVs = 0;
@@ -1046,15 +1164,48 @@ namespace Renderer
 		m_pD3DDeviceContext->HSSetShader(nullptr, nullptr, 0);
 		m_pD3DDeviceContext->PSSetShader(nullptr, nullptr, 0);
 		m_pD3DDeviceContext->CSSetShader(nullptr, nullptr, 0);
+	}
 
-		/*IOERPI *pRPI(GetRPI());
+	//////////////////////////////////////////////////////////////////////////
 
-		for (int i=0; i < EShaderType::NumShaders; ++i)
+	void IOERPI_Platform::UnsetShader(EShaderType::Enum eShaderType)
+	{
+		switch (eShaderType)
 		{
-			pRPI->SetShaderIndex((EShaderType::Enum)i,
-		IOEShader::INVALID_RESOURCE_INDEX);
+		case EShaderType::Vertex:
+			m_pD3DDeviceContext->VSSetShader(nullptr, nullptr, 0);
+			break;
+		case EShaderType::Geometry:
+			m_pD3DDeviceContext->GSSetShader(nullptr, nullptr, 0);
+			break;
+		case EShaderType::Hull:
+			m_pD3DDeviceContext->HSSetShader(nullptr, nullptr, 0);
+			break;
+		case EShaderType::Domain:
+			m_pD3DDeviceContext->DSSetShader(nullptr, nullptr, 0);
+			break;
+		case EShaderType::Fragment:
+			m_pD3DDeviceContext->PSSetShader(nullptr, nullptr, 0);
+			break;
+		case EShaderType::Compute:
+			m_pD3DDeviceContext->CSSetShader(nullptr, nullptr, 0);
+			break;
+		default:
+			break;
 		}
-		pRPI->SetMaterialIndex(IOEMaterial::INVALID_RESOURCE_INDEX);*/
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::SetConstantBuffer(std::uint32_t uSlot, IOEBufferBase *pBuffer)
+	{
+		ID3D11Buffer *pD3DBuffer(pBuffer != nullptr ? pBuffer->GetPlatform().GetD3DBuffer() : nullptr);
+		m_pD3DDeviceContext->VSSetConstantBuffers(uSlot, 1, &pD3DBuffer);
+		m_pD3DDeviceContext->GSSetConstantBuffers(uSlot, 1, &pD3DBuffer);
+		m_pD3DDeviceContext->HSSetConstantBuffers(uSlot, 1, &pD3DBuffer);
+		m_pD3DDeviceContext->DSSetConstantBuffers(uSlot, 1, &pD3DBuffer);
+		m_pD3DDeviceContext->PSSetConstantBuffers(uSlot, 1, &pD3DBuffer);
+		m_pD3DDeviceContext->CSSetConstantBuffers(uSlot, 1, &pD3DBuffer);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -1099,6 +1250,93 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	void IOERPI_Platform::DrawUploadBuffer(std::uint32_t uOffset, std::uint32_t uStride, EPrimitiveTopology eTopology,
+										   std::uint32_t uNumElements, IOEBufferBase *pIndexBuffer /*= nullptr*/)
+	{
+		ID3D11Buffer *pD3DVertexBuffer(m_arrUploadRings[EUploadRing::Vertex].get());
+		UINT uD3DOffset(uOffset);
+		UINT uD3DStride(uStride);
+		m_pD3DDeviceContext->IASetVertexBuffers(0, 1, &pD3DVertexBuffer, &uD3DStride, &uD3DOffset);
+		GetDeviceContext()->IASetPrimitiveTopology(GetPrimitiveFromEPrimitive(eTopology));
+
+		if (pIndexBuffer != nullptr)
+		{
+			DXGI_FORMAT tFormat(pIndexBuffer->GetElementSize() == sizeof(std::uint32_t) ? DXGI_FORMAT_R32_UINT
+																						 : DXGI_FORMAT_R16_UINT);
+			m_pD3DDeviceContext->IASetIndexBuffer(pIndexBuffer->GetPlatform().GetD3DBuffer(), tFormat, 0);
+			m_pD3DDeviceContext->DrawIndexed(uNumElements, 0, 0);
+		}
+		else
+		{
+			m_pD3DDeviceContext->Draw(uNumElements, 0);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEGPUFence *IOERPI_Platform::GetFence()
+	{
+		return &m_tFence;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOERPI_Platform::CreateUploadRing(EUploadRing::Enum eRing, std::uint32_t uSizeBytes)
+	{
+		D3D11_BUFFER_DESC tBufferDesc;
+		tBufferDesc.ByteWidth			= uSizeBytes;
+		tBufferDesc.BindFlags			= D3D11_BIND_VERTEX_BUFFER;
+		tBufferDesc.CPUAccessFlags		= D3D11_CPU_ACCESS_WRITE;
+		tBufferDesc.MiscFlags			= 0;
+		tBufferDesc.Usage				= D3D11_USAGE_DYNAMIC;
+		tBufferDesc.StructureByteStride = 0;
+
+		if (eRing == EUploadRing::Constant)
+		{
+			// Constants can only be bound at offsets, and mapped without discarding, from D3D11.1
+			D3D11_FEATURE_DATA_D3D11_OPTIONS tOptions;
+			if (m_pD3DDeviceContext1 == nullptr ||
+				FAILED(m_pD3DDevice->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &tOptions, sizeof(tOptions))) ||
+				!tOptions.ConstantBufferOffsetting || !tOptions.MapNoOverwriteOnDynamicConstantBuffer)
+			{
+				return false;
+			}
+			tBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		}
+
+		if (FAILED(m_pD3DDevice->CreateBuffer(&tBufferDesc, nullptr, &m_arrUploadRings[eRing])))
+		{
+			THROW_IOE_RENDERER_EXCEPTION("Failed to create upload ring", E_ERROR_RENDERER_UNKNOWN);
+		}
+		m_arrUploadRingsDiscarded[eRing] = false;
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void *IOERPI_Platform::MapUploadRing(EUploadRing::Enum eRing, std::uint32_t uOffset, std::uint32_t /*uSizeBytes*/)
+	{
+		D3D11_MAPPED_SUBRESOURCE tMappedBuffer;
+		if (FAILED(m_pD3DDeviceContext->Map(m_arrUploadRings[eRing].get(), 0,
+											m_arrUploadRingsDiscarded[eRing] ? D3D11_MAP_WRITE_NO_OVERWRITE
+																			 : D3D11_MAP_WRITE_DISCARD,
+											0, &tMappedBuffer)))
+		{
+			THROW_IOE_RENDERER_EXCEPTION("Unable to map upload ring", E_ERROR_RENDERER_UNKNOWN);
+		}
+		m_arrUploadRingsDiscarded[eRing] = true;
+		return static_cast<std::uint8_t *>(tMappedBuffer.pData) + uOffset;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::UnmapUploadRing(EUploadRing::Enum eRing)
+	{
+		m_pD3DDeviceContext->Unmap(m_arrUploadRings[eRing].get(), 0);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 	D3D11_CULL_MODE GetCullMode(ECullMode eCullMode)
 	{
 		switch (eCullMode)
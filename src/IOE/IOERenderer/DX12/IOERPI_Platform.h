@@ -1,11 +1,19 @@
 #pragma once
 
+#include <array>
+#include <deque>
+
 #include <IOE/IOERenderer/IOERPI_PlatformBase.h>
 
+// For binding constants at offsets
+#include <d3d11_1.h>
+
 struct IDXGISwapChain;
 struct ID3D11Device;
 struct ID3D11Debug;
 struct ID3D11DeviceContext;
+struct ID3D11DeviceContext1;
+struct ID3D11Query;
 struct ID3D11RenderTargetView;
 struct ID3D11DepthStencilView;
 struct ID3D11Texture2D;
@@ -164,6 +172,41 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	// D3D11.0 has no fence object, so each signal ends an event query, and
+	// the queries finish in the order they were ended
+	class IOEGPUFence_Platform : public IOEGPUFence
+	{
+	public:
+		IOEGPUFence_Platform();
+
+		void Setup(ID3D11Device *pDevice,
+				   ID3D11DeviceContext *pDeviceContext);
+		void Release();
+
+		virtual void Signal(std::uint64_t uValue) override final;
+		virtual std::uint64_t GetCompletedValue() override final;
+		virtual void Wait(std::uint64_t uValue) override final;
+
+	private:
+		void RetireQuery();
+
+	private:
+		struct PendingQuery
+		{
+			std::uint64_t uValue;
+			TComSharedPtr<ID3D11Query> pQuery;
+		};
+
+		ID3D11Device *m_pDevice;
+		ID3D11DeviceContext *m_pDeviceContext;
+
+		std::deque<PendingQuery> m_arrPendingQueries;
+		std::vector<TComSharedPtr<ID3D11Query> > m_arrFreeQueries;
+		std::uint64_t m_uCompletedValue;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
 	class IOERPI_Platform : public IOERPI_PlatformBase
 	{
 		static const int32_t ms_nNumRenderTargets = 8;
@@ -245,17 +288,31 @@ namespace Renderer
 			return m_pD3DDeviceContext.get();
 		}
 
+		// Null without the D3D11.1 runtime
+		FORCEINLINE ID3D11DeviceContext1 *GetDeviceContext1()
+		{
+			return m_pD3DDeviceContext1.get();
+		}
+
+		FORCEINLINE ID3D11Buffer *
+		GetUploadRingBuffer(EUploadRing::Enum eRing)
+		{
+			return m_arrUploadRings[eRing].get();
+		}
+
 	public:
 		virtual void ResetState() override final;
+		virtual void UnsetShader(EShaderType::Enum eShaderType) override final;
+		virtual void SetConstantBuffer(std::uint32_t uSlot,
+									   IOEBufferBase *pBuffer) override final;
 
 		virtual void
 		UnsetRenderTarget(int32_t nRenderTarget = 0) override final;
 		virtual void SetRenderTarget(IOE::Renderer::IOETexture &rTexture,
 									 int32_t nRenderTargetIdx = 0,
 									 bool bSet = true) override final;
-		virtual void
-		SetRenderTargets(std::vector<IOE::Renderer::IOETexture> arrTextures,
-						 bool bSet = true) override final;
+		virtual void SetRenderTargets(IOETextureSpan arrTextures,
+									  bool bSet = true) override final;
 
 		virtual int32_t GetNumRenderTargets() const;
 
@@ -267,9 +324,8 @@ namespace Renderer
 		virtual void SetUAV(IOE::Renderer::IOETexture &rTexture,
 							int32_t nUAVIdx, EUAVSet bSet,
 							int arrOffset = 0) override final;
-		virtual void
-		SetUAVs(std::vector<IOE::Renderer::IOETexture> arrTextures,
-				EUAVSet bSet) override final;
+		virtual void SetUAVs(IOETextureSpan arrTextures,
+							 EUAVSet bSet) override final;
 
 		virtual int32_t GetNumUAVs() const;
 		int32_t GetMaxUAVIndex() const;
@@ -284,6 +340,22 @@ namespace Renderer
 		virtual void
 		SetPrimitiveTopology(EPrimitiveTopology eTopology) override final;
 
+	public:
+		virtual IOEGPUFence *GetFence() override final;
+
+		virtual bool CreateUploadRing(EUploadRing::Enum eRing,
+									  std::uint32_t uSizeBytes) override final;
+		virtual void *MapUploadRing(EUploadRing::Enum eRing,
+									std::uint32_t uOffset,
+									std::uint32_t uSizeBytes) override final;
+		virtual void UnmapUploadRing(EUploadRing::Enum eRing) override final;
+
+		virtual void
+		DrawUploadBuffer(std::uint32_t uOffset, std::uint32_t uStride,
+						 EPrimitiveTopology eTopology,
+						 std::uint32_t uNumElements,
+						 IOEBufferBase *pIndexBuffer = nullptr) override final;
+
 	private:
 		void SetupD3D();
 		void ReleaseD3D();
@@ -296,6 +368,7 @@ namespace Renderer
 		TComSharedPtr<ID3D11Device> m_pD3DDevice;
 		TComSharedPtr<ID3D11Debug> m_pD3DDebug;
 		TComSharedPtr<ID3D11DeviceContext> m_pD3DDeviceContext;
+		TComSharedPtr<ID3D11DeviceContext1> m_pD3DDeviceContext1;
 
 #if (IOE_DEBUG_ENABLED == IOE_ON && IOE_RPI_PROFILE_MARKERS == IOE_ON)
 		TComSharedPtr<ID3DUserDefinedAnnotation> m_pPerfAnnotations;
@@ -312,6 +385,7 @@ namespace Renderer
 		TComSharedPtr<ID3D11SamplerState> m_pDefaultSamplerState;
 		// TComSharedPtr<ID3D11BlendState> m_pDefaultBlendState;
 
+		// Only drawn from when the debug vertices do not fit in the vertex ring
 		TComSharedPtr<ID3D11Buffer> m_pVertexBuffer;
 		TComSharedPtr<ID3D11InputLayout> m_pDebugInputLayout;
 
@@ -321,6 +395,13 @@ namespace Renderer
 		std::array<TComSharedPtr<ID3D11UnorderedAccessView>, ms_nNumUAVs> m_arrUAVs;
 		uint32_t m_arrUAVsWriteOffsets[ms_nNumUAVs];
 		int32_t m_nNumUAVs;
+
+		// Each ring is discarded by its first map alone, as the RPI's fence
+		// keeps it from writing over anything the GPU may still read
+		std::array<TComSharedPtr<ID3D11Buffer>, EUploadRing::NumRings>
+			m_arrUploadRings;
+		std::array<bool, EUploadRing::NumRings> m_arrUploadRingsDiscarded;
+		IOEGPUFence_Platform m_tFence;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
@@ -2,6 +2,8 @@
 
 #include <cstdint>
 #include <array>
+#include <string>
+#include <vector>
 
 #include <d3d12.h>
 
@@ -35,21 +37,24 @@ namespace Renderer
 		IOEShader_Platform(IOEShader &rShader);
 
 	public:
-		virtual void
-		Compile(const IOEShaderCompilationOptions &rOptions) override final;
+		virtual std::string GetCompilerSignature() const override final;
+		virtual void CompileShader(const IOEShaderCompilationOptions &rOptions,
+								   IOEShaderBinary &rBinary) override final;
+
+		virtual void Create(const IOEShaderCompilationOptions &rOptions,
+							const IOEShaderBinary &rBinary) override final;
 		virtual void Cleanup() override final;
 
 		virtual void Set(IOERPI *pRPI) override final;
 
-		virtual void
-		FindShaderVariables(ShaderConstantBuffers &arrConstantBuffers,
-							ShaderCategories &arrDescriptions) override final;
 		virtual void *MapConstantBuffers(
 			IOERPI *pRPI, std::int32_t nSlotIdx,
 			ShaderConstantBufferDescription *pBuffer) override final;
 		virtual void UnmapConstantBuffers(
 			IOERPI *pRPI, std::int32_t nSlotIdx,
 			ShaderConstantBufferDescription *pBuffer) override final;
+		virtual void BindConstantBuffer(IOERPI *pRPI,
+										std::uint32_t uSlotIdx) override final;
 
 		virtual bool SetTextureVariable(IOERPI *pRPI,
 										const char *szTextureName,
@@ -77,7 +82,17 @@ namespace Renderer
 									   int arrOffset = 0);
 
 	private:
-		void CreateInputLayout();
+		void CreateInputLayout(const IOEShaderBinary &rBinary);
+		void
+		CreateConstantBuffers(const ShaderConstantBuffers &arrConstantBuffers);
+		// Binds each slot to its own buffer, or to its upload in the constant
+		// ring
+		void SetConstantBuffers(IOERPI *pRPI, std::uint32_t uStartSlot,
+								std::uint32_t uNumSlots);
+
+		void FindShaderVariables(const std::vector<std::uint8_t> &arrBytecode,
+								 ShaderConstantBuffers &arrConstantBuffers,
+								 ShaderCategories &arrDescriptions);
 
 		void FindGlobalResource(ID3D11ShaderReflection *pShaderReflection,
 								int nInputType,
@@ -98,11 +113,12 @@ namespace Renderer
 		std::array<TComSharedPtr<ID3D11Buffer>,
 				   ShaderConstantBufferDescription::ms_nMaxCBufferSlots>
 			m_arrConstantD3D11Buffers;
+		std::array<UINT, ShaderConstantBufferDescription::ms_nMaxCBufferSlots>
+			m_arrNumConstants;
 
 	private:
+		// Slots bound by Set, up to the last one the shader uses
 		std::uint32_t m_uNumCBuffers;
-		std::uint32_t m_uNumBoundResources;
-		TComSharedPtr<ID3DBlob> m_pCompiledShader;
 		TComSharedPtr<ID3D11DeviceChild> m_pCreatedShader;
 		TComSharedPtr<ID3D11InputLayout> m_pInputLayout;
 	};
@@ -0,0 +1,409 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "IOEDebugDraw.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		// Corner pairs of a box whose corners are numbered by their bits,
+		// X in the first, Y in the second and Z in the third
+		const std::uint32_t g_arrBoxEdges[12][2] = {
+			{0, 1}, {2, 3}, {4, 5}, {6, 7}, // Along X
+			{0, 2}, {1, 3}, {4, 6}, {5, 7}, // Along Y
+			{0, 4}, {1, 5}, {2, 6}, {3, 7}, // Along Z
+		};
+
+		void WriteBoxEdges(DebugVertex *pVertices,
+						   const IOEVector (&arrCorners)[8],
+						   const IOEVector &vColour)
+		{
+			for (const auto &rEdge : g_arrBoxEdges)
+			{
+				(pVertices++)->Set(arrCorners[rEdge[0]], vColour);
+				(pVertices++)->Set(arrCorners[rEdge[1]], vColour);
+			}
+		}
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEDebugDraw::IOEDebugDraw()
+	{
+		m_arrNumVertices.fill(0);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	DebugVertex *IOEDebugDraw::Allocate(EDebugPrimitive::Enum ePrimitive,
+										std::uint32_t uNumPrimitives,
+										float fDuration /*=0.0f*/)
+	{
+		const std::uint32_t uNumVertices(uNumPrimitives *
+										 GetVerticesPerPrimitive(ePrimitive));
+		IOE_ASSERT(uNumVertices <= ms_uVerticesPerPage,
+				   "Debug primitive batch is larger than a page");
+		if (uNumVertices == 0 || uNumVertices > ms_uVerticesPerPage)
+		{
+			return nullptr;
+		}
+
+		ThreadBuffers &rBuffers(m_tThreadBuffers.local());
+		if (fDuration > 0.0f)
+		{
+			RetainedList &rRetained(rBuffers.arrRetained[ePrimitive]);
+			const std::size_t uStart(rRetained.arrVertices.size());
+			rRetained.arrVertices.resize(uStart + uNumVertices);
+			rRetained.arrRemaining.resize(
+				rRetained.arrRemaining.size() + uNumPrimitives, fDuration);
+			return &rRetained.arrVertices[uStart];
+		}
+
+		PageList &rList(rBuffers.arrPages[ePrimitive]);
+		if (rList.uNumPages == 0 ||
+			rList.arrPages[rList.uNumPages - 1]->uNumVertices + uNumVertices >
+				ms_uVerticesPerPage)
+		{
+			if (rList.uNumPages == rList.arrPages.size())
+			{
+				rList.arrPages.emplace_back(new Page());
+			}
+			rList.arrPages[rList.uNumPages++]->uNumVertices = 0;
+		}
+
+		Page &rPage(*rList.arrPages[rList.uNumPages - 1]);
+		DebugVertex *pVertices(&rPage.arrVertices[rPage.uNumVertices]);
+		rPage.uNumVertices += uNumVertices;
+		return pVertices;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEDebugDraw::AddPoint(
+		const IOEVector &vPosition,
+		const IOEVector &vColour /*=Maths::ColourList::Red*/,
+		float fDuration /*=0.0f*/)
+	{
+		DebugVertex *pVertices(
+			Allocate(EDebugPrimitive::Point, 1, fDuration));
+		if (pVertices != nullptr)
+		{
+			pVertices[0].Set(vPosition, vColour);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEDebugDraw::AddLine(
+		const IOEVector &vStart, const IOEVector &vEnd,
+		const IOEVector &vStartColour /*=Maths::ColourList::Red*/,
+		const IOEVector &vEndColour /*=Maths::ColourList::Red*/,
+		float fDuration /*=0.0f*/)
+	{
+		DebugVertex *pVertices(Allocate(EDebugPrimitive::Line, 1, fDuration));
+		if (pVertices != nullptr)
+		{
+			pVertices[0].Set(vStart, vStartColour);
+			pVertices[1].Set(vEnd, vEndColour);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEDebugDraw::AddTriangle(
+		const IOEVector &vP0, const IOEVector &vP1, const IOEVector &vP2,
+		const IOEVector &vColour0 /*=Maths::ColourList::Red*/,
+		const IOEVector &vColour1 /*=Maths::ColourList::Red*/,
+		const IOEVector &vColour2 /*=Maths::ColourList::Red*/,
+		float fDuration /*=0.0f*/)
+	{
+		DebugVertex *pVertices(
+			Allocate(EDebugPrimitive::Triangle, 1, fDuration));
+		if (pVertices != nullptr)
+		{
+			pVertices[0].Set(vP0, vColour0);
+			pVertices[1].Set(vP1, vColour1);
+			pVertices[2].Set(vP2, vColour2);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEDebugDraw::AddLines(const DebugVertex *pVertices,
+								std::uint32_t uNumLines,
+								float fDuration /*=0.0f*/)
+	{
+		const std::uint32_t uLinesPerPage(ms_uVerticesPerPage / 2);
+		while (uNumLines > 0)
+		{
+			const std::uint32_t uBatch(
+				uNumLines < uLinesPerPage ? uNumLines : uLinesPerPage);
+			DebugVertex *pDest(
+				Allocate(EDebugPrimitive::Line, uBatch, fDuration));
+			memcpy(pDest, pVertices, uBatch * 2 * sizeof(DebugVertex));
+			pVertices += uBatch * 2;
+			uNumLines -= uBatch;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEDebugDraw::AddBox(
+		const IOEVector &vCentre, const IOEVector &vExtents,
+		const IOEVector &vColour /*=Maths::ColourList::Red*/,
+		float fDuration /*=0.0f*/)
+	{
+		float fXMin, fYMin, fZMin;
+		float fXMax, fYMax, fZMax;
+		(vCentre - vExtents).Get(fXMin, fYMin, fZMin);
+		(vCentre + vExtents).Get(fXMax, fYMax, fZMax);
+
+		IOEVector arrCorners[8];
+		for (std::uint32_t uIdx(0); uIdx < 8; ++uIdx)
+		{
+			arrCorners[uIdx] = IOEVector((uIdx & 1) ? fXMax : fXMin,
+										 (uIdx & 2) ? fYMax : fYMin,
+										 (uIdx & 4) ? fZMax : fZMin);
+		}
+
+		DebugVertex *pVertices(
+			Allocate(EDebugPrimitive::Line, 12, fDuration));
+		if (pVertices != nullptr)
+		{
+			WriteBoxEdges(pVertices, arrCorners, vColour);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEDebugDraw::AddFrustum(
+		const IOEMatrix &mInvViewProj,
+		const IOEVector &vColour /*=Maths::ColourList::Red*/,
+		float fDuration /*=0.0f*/)
+	{
+		// Clip space runs from -1 to 1 across, and from 0 to 1 in depth
+		IOEVector arrCorners[8];
+		for (std::uint32_t uIdx(0); uIdx < 8; ++uIdx)
+		{
+			const IOEVector vClip((uIdx & 1) ? 1.0f : -1.0f,
+								  (uIdx & 2) ? 1.0f : -1.0f,
+								  (uIdx & 4) ? 1.0f : 0.0f, 1.0f);
+			const IOEVector vCorner(mInvViewProj * vClip);
+			arrCorners[uIdx] = vCorner / vCorner.GetW();
+		}
+
+		DebugVertex *pVertices(
+			Allocate(EDebugPrimitive::Line, 12, fDuration));
+		if (pVertices != nullptr)
+		{
+			WriteBoxEdges(pVertices, arrCorners, vColour);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEDebugDraw::AddSphere(
+		const IOEVector &vCentre, float fRadius,
+		const IOEVector &vColour /*=Maths::ColourList::Red*/,
+		std::uint32_t uNumSegments /*=24*/, float fDuration /*=0.0f*/)
+	{
+		DebugVertex *pVertices(
+			Allocate(EDebugPrimitive::Line, uNumSegments * 3, fDuration));
+		if (pVertices == nullptr)
+		{
+			return;
+		}
+
+		const float fStep(6.28318530718f / static_cast<float>(uNumSegments));
+		IOEVector vPrevious[3];
+		for (std::uint32_t uIdx(0); uIdx <= uNumSegments; ++uIdx)
+		{
+			const float fAngle(fStep * static_cast<float>(uIdx % uNumSegments));
+			const float fCos(std::cos(fAngle) * fRadius);
+			const float fSin(std::sin(fAngle) * fRadius);
+
+			// Around X, then Y, then Z
+			const IOEVector arrPoints[3] = {
+				vCentre + IOEVector(0.0f, fCos, fSin, 0.0f),
+				vCentre + IOEVector(fCos, 0.0f, fSin, 0.0f),
+				vCentre + IOEVector(fCos, fSin, 0.0f, 0.0f),
+			};
+			for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+			{
+				if (uIdx > 0)
+				{
+					(pVertices++)->Set(vPrevious[uAxis], vColour);
+					(pVertices++)->Set(arrPoints[uAxis], vColour);
+				}
+				vPrevious[uAxis] = arrPoints[uAxis];
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEDebugDraw::Merge(std::uint32_t uMaxVertices)
+	{
+		for (std::uint32_t uPrimitive(0);
+			 uPrimitive < EDebugPrimitive::NumPrimitives; ++uPrimitive)
+		{
+			m_arrSpans[uPrimitive].clear();
+			m_arrNumVertices[uPrimitive] = 0;
+		}
+
+		std::uint32_t uBudget(uMaxVertices);
+		for (std::uint32_t uPrimitive(0);
+			 uPrimitive < EDebugPrimitive::NumPrimitives; ++uPrimitive)
+		{
+			const EDebugPrimitive::Enum ePrimitive(
+				static_cast<EDebugPrimitive::Enum>(uPrimitive));
+			RetainedList &rOwned(m_arrRetained[uPrimitive]);
+
+			for (ThreadBuffers &rBuffers : m_tThreadBuffers)
+			{
+				const PageList &rList(rBuffers.arrPages[uPrimitive]);
+				for (std::uint32_t uPage(0); uPage < rList.uNumPages; ++uPage)
+				{
+					const Page &rPage(*rList.arrPages[uPage]);
+					AddSpan(ePrimitive, rPage.arrVertices.data(),
+							rPage.uNumVertices, uBudget);
+				}
+
+				// Retained primitives move to the render thread, so the
+				// thread need never add them again
+				RetainedList &rRetained(rBuffers.arrRetained[uPrimitive]);
+				rOwned.arrVertices.insert(rOwned.arrVertices.end(),
+										  rRetained.arrVertices.begin(),
+										  rRetained.arrVertices.end());
+				rOwned.arrRemaining.insert(rOwned.arrRemaining.end(),
+										   rRetained.arrRemaining.begin(),
+										   rRetained.arrRemaining.end());
+				rRetained.arrVertices.clear();
+				rRetained.arrRemaining.clear();
+			}
+
+			AddSpan(ePrimitive, rOwned.arrVertices.data(),
+					static_cast<std::uint32_t>(rOwned.arrVertices.size()),
+					uBudget);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEDebugDraw::AddSpan(EDebugPrimitive::Enum ePrimitive,
+							   const DebugVertex *pVertices,
+							   std::uint32_t uNumVertices,
+							   std::uint32_t &ruBudget)
+	{
+		if (uNumVertices > ruBudget)
+		{
+			IOE_ASSERT(false, "Too many debug primitives, some were dropped");
+			const std::uint32_t uVerticesPerPrimitive(
+				GetVerticesPerPrimitive(ePrimitive));
+			uNumVertices = ruBudget / uVerticesPerPrimitive *
+				uVerticesPerPrimitive;
+		}
+		if (uNumVertices == 0)
+		{
+			return;
+		}
+
+		Span tSpan;
+		tSpan.pVertices	= pVertices;
+		tSpan.uNumVertices = uNumVertices;
+		m_arrSpans[ePrimitive].push_back(tSpan);
+		m_arrNumVertices[ePrimitive] += uNumVertices;
+		ruBudget -= uNumVertices;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t IOEDebugDraw::Write(DebugVertex *pVertices) const
+	{
+		for (const std::vector<Span> &rSpans : m_arrSpans)
+		{
+			for (const Span &rSpan : rSpans)
+			{
+				memcpy(pVertices, rSpan.pVertices,
+					   rSpan.uNumVertices * sizeof(DebugVertex));
+				pVertices += rSpan.uNumVertices;
+			}
+		}
+		return GetNumVertices();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEDebugDraw::Flush(float fDeltaTime)
+	{
+		for (ThreadBuffers &rBuffers : m_tThreadBuffers)
+		{
+			for (PageList &rList : rBuffers.arrPages)
+			{
+				rList.uNumPages = 0;
+			}
+		}
+
+		for (std::uint32_t uPrimitive(0);
+			 uPrimitive < EDebugPrimitive::NumPrimitives; ++uPrimitive)
+		{
+			m_arrSpans[uPrimitive].clear();
+			m_arrNumVertices[uPrimitive] = 0;
+
+			// Live primitives are packed down in order
+			RetainedList &rRetained(m_arrRetained[uPrimitive]);
+			const std::size_t uVerticesPerPrimitive(GetVerticesPerPrimitive(
+				static_cast<EDebugPrimitive::Enum>(uPrimitive)));
+			std::size_t uNumLive(0);
+			for (std::size_t uIdx(0); uIdx < rRetained.arrRemaining.size();
+				 ++uIdx)
+			{
+				const float fRemaining(rRetained.arrRemaining[uIdx] -
+									   fDeltaTime);
+				if (fRemaining <= 0.0f)
+				{
+					continue;
+				}
+				if (uNumLive != uIdx)
+				{
+					std::copy_n(&rRetained.arrVertices[uIdx *
+													   uVerticesPerPrimitive],
+								uVerticesPerPrimitive,
+								&rRetained.arrVertices[uNumLive *
+													   uVerticesPerPrimitive]);
+				}
+				rRetained.arrRemaining[uNumLive++] = fRemaining;
+			}
+			rRetained.arrRemaining.resize(uNumLive);
+			rRetained.arrVertices.resize(uNumLive * uVerticesPerPrimitive);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t IOEDebugDraw::GetNumPages() const
+	{
+		std::size_t uNumPages(0);
+		for (const ThreadBuffers &rBuffers : m_tThreadBuffers)
+		{
+			for (const PageList &rList : rBuffers.arrPages)
+			{
+				uNumPages += rList.arrPages.size();
+			}
+		}
+		return static_cast<std::uint32_t>(uNumPages);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
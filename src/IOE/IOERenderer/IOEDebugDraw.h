@@ -0,0 +1,202 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <tbb/enumerable_thread_specific.h>
+
+#include <IOE/IOECore/IOEDefines.h>
+#include <IOE/IOEMaths/Matrix.h>
+#include <IOE/IOEMaths/Vector.h>
+
+#include "IOEVertexFormat.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	using IOE::Maths::IOEMatrix;
+	using IOE::Maths::IOEVector;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// In the order they are drawn
+	namespace EDebugPrimitive
+	{
+		enum Enum
+		{
+			Point,
+			Line,
+			Triangle,
+
+			NumPrimitives
+		};
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Points, lines and triangles drawn over the scene for one frame, or
+	// retained for as many seconds as they were added with. Each thread
+	// appends to pages of its own, so any job may add primitives without
+	// locking. Pages are kept from frame to frame, so storage only grows
+	// when a frame adds more than any before it.
+	class IOEDebugDraw
+	{
+	public:
+		// A whole number of every primitive, so none straddles two pages
+		static const std::uint32_t ms_uVerticesPerPage = 6 * 1024;
+
+	public:
+		IOEDebugDraw();
+
+		// Safe to call from any number of threads at once, but not at the
+		// same time as Merge or Flush.
+		//
+		// Space for the vertices of uNumPrimitives, which must be written
+		// before the thread adds anything else. A batch may fill at most a
+		// page. Primitives with a duration are drawn every frame until
+		// that many seconds have passed.
+		DebugVertex *Allocate(EDebugPrimitive::Enum ePrimitive,
+							  std::uint32_t uNumPrimitives,
+							  float fDuration = 0.0f);
+
+		void AddPoint(const IOEVector &vPosition,
+					  const IOEVector &vColour = Maths::ColourList::Red,
+					  float fDuration = 0.0f);
+		void AddLine(const IOEVector &vStart, const IOEVector &vEnd,
+					 const IOEVector &vStartColour = Maths::ColourList::Red,
+					 const IOEVector &vEndColour = Maths::ColourList::Red,
+					 float fDuration = 0.0f);
+		void AddTriangle(const IOEVector &vP0, const IOEVector &vP1,
+						 const IOEVector &vP2,
+						 const IOEVector &vColour0 = Maths::ColourList::Red,
+						 const IOEVector &vColour1 = Maths::ColourList::Red,
+						 const IOEVector &vColour2 = Maths::ColourList::Red,
+						 float fDuration = 0.0f);
+
+		// Pairs of vertices, split over as many pages as they need
+		void AddLines(const DebugVertex *pVertices, std::uint32_t uNumLines,
+					  float fDuration = 0.0f);
+
+		void AddBox(const IOEVector &vCentre, const IOEVector &vExtents,
+					const IOEVector &vColour = Maths::ColourList::Red,
+					float fDuration = 0.0f);
+
+		// Edges of the volume mInvViewProj takes clip space to
+		void AddFrustum(const IOEMatrix &mInvViewProj,
+						const IOEVector &vColour = Maths::ColourList::Red,
+						float fDuration = 0.0f);
+
+		// A circle of uNumSegments lines around each axis
+		void AddSphere(const IOEVector &vCentre, float fRadius,
+					   const IOEVector &vColour = Maths::ColourList::Red,
+					   std::uint32_t uNumSegments = 24,
+					   float fDuration = 0.0f);
+
+	public:
+		// Render thread only, between frames.
+		//
+		// Gathers every thread's primitives for drawing. Any beyond
+		// uMaxVertices are dropped for this frame, triangles first.
+		void Merge(std::uint32_t uMaxVertices);
+
+		// Writes the merged vertices a primitive at a time, in the order
+		// of EDebugPrimitive, and returns how many were written
+		std::uint32_t Write(DebugVertex *pVertices) const;
+
+		// Drops this frame's primitives, and ages the retained ones by
+		// fDeltaTime seconds
+		void Flush(float fDeltaTime);
+
+		// Merged counts
+		FORCEINLINE std::uint32_t
+		GetNumPrimitives(EDebugPrimitive::Enum ePrimitive) const
+		{
+			return m_arrNumVertices[ePrimitive] /
+				GetVerticesPerPrimitive(ePrimitive);
+		}
+		FORCEINLINE std::uint32_t GetNumVertices() const
+		{
+			return m_arrNumVertices[EDebugPrimitive::Point] +
+				m_arrNumVertices[EDebugPrimitive::Line] +
+				m_arrNumVertices[EDebugPrimitive::Triangle];
+		}
+
+		// Allocated storage, in pages, over every thread
+		std::uint32_t GetNumPages() const;
+
+		FORCEINLINE static std::uint32_t
+		GetVerticesPerPrimitive(EDebugPrimitive::Enum ePrimitive)
+		{
+			return static_cast<std::uint32_t>(ePrimitive) + 1;
+		}
+
+	private:
+		struct Page
+		{
+			std::uint32_t uNumVertices;
+			std::array<DebugVertex, ms_uVerticesPerPage> arrVertices;
+		};
+
+		struct PageList
+		{
+			PageList()
+				: uNumPages(0)
+			{
+			}
+
+			// Pages past uNumPages are free for later frames
+			std::vector<std::unique_ptr<Page> > arrPages;
+			std::uint32_t uNumPages;
+		};
+
+		// Seconds left per primitive, alongside its vertices
+		struct RetainedList
+		{
+			std::vector<DebugVertex> arrVertices;
+			std::vector<float> arrRemaining;
+		};
+
+		struct ThreadBuffers
+		{
+			std::array<PageList, EDebugPrimitive::NumPrimitives> arrPages;
+			std::array<RetainedList, EDebugPrimitive::NumPrimitives>
+				arrRetained;
+		};
+
+		struct Span
+		{
+			const DebugVertex *pVertices;
+			std::uint32_t uNumVertices;
+		};
+
+	private:
+		void AddSpan(EDebugPrimitive::Enum ePrimitive,
+					 const DebugVertex *pVertices, std::uint32_t uNumVertices,
+					 std::uint32_t &ruBudget);
+
+	private:
+		tbb::enumerable_thread_specific<ThreadBuffers> m_tThreadBuffers;
+
+		// Retained primitives taken from the threads by Merge
+		std::array<RetainedList, EDebugPrimitive::NumPrimitives> m_arrRetained;
+
+		std::array<std::vector<Span>, EDebugPrimitive::NumPrimitives>
+			m_arrSpans;
+		std::array<std::uint32_t, EDebugPrimitive::NumPrimitives>
+			m_arrNumVertices;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
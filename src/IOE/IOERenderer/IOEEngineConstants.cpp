@@ -0,0 +1,207 @@
+#include <cstring>
+
+#include <IOE/IOEMaths/Camera.h>
+
+#include "IOEBuffer.h"
+#include "IOEEngineConstants.h"
+#include "IOERPI.h"
+#include "IOEViewport.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		static_assert(sizeof(IOEFrameConstants) % 16 == 0,
+					  "Constant buffers must be a multiple of 16 bytes");
+		static_assert(sizeof(IOEViewConstants) % 16 == 0,
+					  "Constant buffers must be a multiple of 16 bytes");
+		static_assert(sizeof(IOEObjectConstants) % 16 == 0,
+					  "Constant buffers must be a multiple of 16 bytes");
+
+		FORCEINLINE bool IsSameMatrix(const IOE::Maths::IOEMatrix &lhs,
+									  const IOE::Maths::IOEMatrix &rhs)
+		{
+			return std::memcmp(&lhs, &rhs, sizeof(IOE::Maths::IOEMatrix)) ==
+				   0;
+		}
+
+		template <typename _T>
+		std::shared_ptr<IOEBufferBase> CreateConstantBuffer(IOERPI *pRPI,
+															const _T &rData)
+		{
+			auto pBuffer(std::make_shared<IOEBuffer<_T> >(1));
+			pBuffer->Set(0, rData);
+			pBuffer->SetBufferDescription(EBufferDescription::Constant);
+			pBuffer->SetCPUAccess(ECPUAccess::GPUReadCPUWrite);
+			pBuffer->Setup(pRPI);
+			return pBuffer;
+		}
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEEngineConstants::IOEEngineConstants()
+		: m_mView(IOE::Maths::g_mIdentity)
+		, m_mProjection(IOE::Maths::g_mIdentity)
+		, m_mViewProj(IOE::Maths::g_mIdentity)
+		, m_mWorld(IOE::Maths::g_mIdentity)
+		, m_uViewGeneration(0)
+		, m_uObjectViewGeneration(0)
+		, m_bHasView(false)
+		, m_bHasObject(false)
+	{
+		std::memset(&m_tFrame, 0, sizeof(m_tFrame));
+
+		m_tView.mViewProj		   = IOE::Maths::g_mIdentity;
+		m_tView.vView			   = IOE::Maths::g_vZeroVector;
+		m_tView.arrViewportSize[0] = 0.0f;
+		m_tView.arrViewportSize[1] = 0.0f;
+		m_tView.arrPadding[0]	  = 0.0f;
+		m_tView.arrPadding[1]	  = 0.0f;
+
+		m_tObject.mWorldViewProj	 = IOE::Maths::g_mIdentity;
+		m_tObject.mWorldInvTranspose = IOE::Maths::g_mIdentity;
+
+		m_arrBound.fill(false);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEEngineConstants::Setup(IOERPI *pRPI)
+	{
+		m_arrBuffers[EConstantFrequency::PerFrame] =
+			CreateConstantBuffer(pRPI, m_tFrame);
+		m_arrBuffers[EConstantFrequency::PerView] =
+			CreateConstantBuffer(pRPI, m_tView);
+		m_arrBuffers[EConstantFrequency::PerObject] =
+			CreateConstantBuffer(pRPI, m_tObject);
+
+		Invalidate();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEEngineConstants::Invalidate()
+	{
+		m_arrBound.fill(false);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEEngineConstants::SetFrame(IOERPI *pRPI, float fDeltaTime)
+	{
+		m_tFrame.fTime += fDeltaTime;
+		m_tFrame.fDeltaTime = fDeltaTime;
+		++m_tFrame.uFrameIndex;
+
+		Upload(pRPI, EConstantFrequency::PerFrame, &m_tFrame,
+			   sizeof(m_tFrame));
+		Bind(pRPI, EConstantFrequency::PerFrame);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEEngineConstants::SetView(IOERPI *pRPI,
+									 const IOE::Maths::IOECamera &rCamera,
+									 const IOEViewport &rViewport)
+	{
+		const float fWidth(rViewport.GetWidth());
+		const float fHeight(rViewport.GetHeight());
+		if (!m_bHasView || !IsSameMatrix(m_mView, rCamera.GetViewMatrix()) ||
+			!IsSameMatrix(m_mProjection, rCamera.GetProjectionMatrix()) ||
+			m_tView.arrViewportSize[0] != fWidth ||
+			m_tView.arrViewportSize[1] != fHeight)
+		{
+			m_mView		  = rCamera.GetViewMatrix();
+			m_mProjection = rCamera.GetProjectionMatrix();
+			m_mViewProj   = m_mView * m_mProjection;
+
+			m_tView.mViewProj = m_mViewProj.Transpose();
+			m_tView.vView	 = rCamera.GetTransform().GetTranslation();
+			m_tView.arrViewportSize[0] = fWidth;
+			m_tView.arrViewportSize[1] = fHeight;
+
+			m_bHasView = true;
+			++m_uViewGeneration;
+
+			Upload(pRPI, EConstantFrequency::PerView, &m_tView,
+				   sizeof(m_tView));
+		}
+		Bind(pRPI, EConstantFrequency::PerView);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEEngineConstants::SetObject(IOERPI *pRPI,
+									   const IOE::Maths::IOEMatrix &rWorld)
+	{
+		const bool bWorldChanged(!m_bHasObject ||
+								 !IsSameMatrix(m_mWorld, rWorld));
+		if (bWorldChanged || m_uObjectViewGeneration != m_uViewGeneration)
+		{
+			if (bWorldChanged)
+			{
+				m_mWorld = rWorld;
+
+				// Stored transposed, so the inverse transpose is the inverse
+				m_tObject.mWorldInvTranspose =
+					IsSameMatrix(rWorld, IOE::Maths::g_mIdentity)
+						? IOE::Maths::g_mIdentity
+						: rWorld.Inverse();
+			}
+			m_tObject.mWorldViewProj =
+				IOE::Maths::IOEMatrix::MultiplyTranspose(rWorld, m_mViewProj);
+
+			m_bHasObject			= true;
+			m_uObjectViewGeneration = m_uViewGeneration;
+
+			Upload(pRPI, EConstantFrequency::PerObject, &m_tObject,
+				   sizeof(m_tObject));
+		}
+		Bind(pRPI, EConstantFrequency::PerObject);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEEngineConstants::Upload(IOERPI *pRPI,
+									EConstantFrequency::Enum eFrequency,
+									const void *pData, std::size_t uSizeBytes)
+	{
+		IOEBufferBase *pBuffer(m_arrBuffers[eFrequency].get());
+		void *pMapped(nullptr);
+		if (pBuffer != nullptr &&
+			pBuffer->Map(EBufferMapType::WriteDiscard, pMapped) &&
+			pMapped != nullptr)
+		{
+			std::memcpy(pMapped, pData, uSizeBytes);
+			pBuffer->Unmap();
+			pRPI->GetRenderStats().Add(ERenderStat::ConstantBufferMaps);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEEngineConstants::Bind(IOERPI *pRPI,
+								  EConstantFrequency::Enum eFrequency)
+	{
+		IOEBufferBase *pBuffer(m_arrBuffers[eFrequency].get());
+		if (!m_arrBound[eFrequency] && pBuffer != nullptr)
+		{
+			pRPI->GetPlatform().SetConstantBuffer(GetSlot(eFrequency),
+												  pBuffer);
+			pRPI->GetRenderStats().Add(ERenderStat::StateChanges);
+			m_arrBound[eFrequency] = true;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
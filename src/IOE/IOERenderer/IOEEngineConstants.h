@@ -0,0 +1,159 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+#include <IOE/IOECore/IOEDefines.h>
+
+#include <IOE/IOEMaths/Matrix.h>
+#include <IOE/IOEMaths/Vector.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Maths
+{
+	class IOECamera;
+}
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class IOERPI;
+	class IOEBufferBase;
+	class IOEViewport;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Engine owned constant buffers, by how often they change. Per-material
+	// data stays in each material's own buffers, which are only bound when
+	// the material changes.
+	namespace EConstantFrequency
+	{
+		enum Enum
+		{
+			PerFrame,
+			PerView,
+			PerObject,
+
+			NumFrequencies
+		};
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Layouts of the buffers in Shaders/Common/engine_constants.h. Matrices
+	// are stored transposed, as HLSL reads them.
+	struct IOEFrameConstants
+	{
+		float fTime;
+		float fDeltaTime;
+		std::uint32_t uFrameIndex;
+		std::uint32_t uPadding;
+	};
+
+	struct IOEViewConstants
+	{
+		IOE::Maths::IOEMatrix mViewProj;
+		IOE::Maths::IOEVector vView;
+		float arrViewportSize[2];
+		float arrPadding[2];
+	};
+
+	struct IOEObjectConstants
+	{
+		IOE::Maths::IOEMatrix mWorldViewProj;
+		IOE::Maths::IOEMatrix mWorldInvTranspose;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Keeps a CPU copy of each engine constant buffer, and only uploads a
+	// buffer when what it is built from has changed since its last upload.
+	// Each buffer is bound once to every stage at its own register, and
+	// stays bound until the bound state is invalidated.
+	class IOEEngineConstants
+	{
+	public:
+		// Register of PerFrame, the others follow it. Kept above the
+		// registers the compiler hands out to a shader's own buffers.
+		static const std::uint32_t ms_uFirstSlot = 11;
+
+	public:
+		IOEEngineConstants();
+
+		void Setup(IOERPI *pRPI);
+
+		// Every buffer is bound again before its next use
+		void Invalidate();
+
+		void SetFrame(IOERPI *pRPI, float fDeltaTime);
+		void SetView(IOERPI *pRPI, const IOE::Maths::IOECamera &rCamera,
+					 const IOEViewport &rViewport);
+		void SetObject(IOERPI *pRPI, const IOE::Maths::IOEMatrix &rWorld);
+
+	public:
+		FORCEINLINE static std::uint32_t
+		GetSlot(EConstantFrequency::Enum eFrequency)
+		{
+			return ms_uFirstSlot + static_cast<std::uint32_t>(eFrequency);
+		}
+		FORCEINLINE static bool IsEngineSlot(std::uint32_t uSlot)
+		{
+			return uSlot >= ms_uFirstSlot &&
+				   uSlot < GetSlot(EConstantFrequency::NumFrequencies);
+		}
+
+		// Changes whenever the view buffer is uploaded, so anything built
+		// from the view can tell when it is stale
+		FORCEINLINE std::uint32_t GetViewGeneration() const
+		{
+			return m_uViewGeneration;
+		}
+
+		FORCEINLINE const IOEViewConstants &GetViewConstants() const
+		{
+			return m_tView;
+		}
+
+		// World matrix the object buffer was last built from
+		FORCEINLINE const IOE::Maths::IOEMatrix &GetWorld() const
+		{
+			return m_mWorld;
+		}
+
+	private:
+		void Upload(IOERPI *pRPI, EConstantFrequency::Enum eFrequency,
+					const void *pData, std::size_t uSizeBytes);
+		void Bind(IOERPI *pRPI, EConstantFrequency::Enum eFrequency);
+
+	private:
+		std::array<std::shared_ptr<IOEBufferBase>,
+				   EConstantFrequency::NumFrequencies>
+			m_arrBuffers;
+		std::array<bool, EConstantFrequency::NumFrequencies> m_arrBound;
+
+		IOEFrameConstants m_tFrame;
+		IOEViewConstants m_tView;
+		IOEObjectConstants m_tObject;
+
+		// What the view and object buffers were last built from
+		IOE::Maths::IOEMatrix m_mView;
+		IOE::Maths::IOEMatrix m_mProjection;
+		IOE::Maths::IOEMatrix m_mViewProj;
+		IOE::Maths::IOEMatrix m_mWorld;
+		std::uint32_t m_uViewGeneration;
+		std::uint32_t m_uObjectViewGeneration;
+		bool m_bHasView;
+		bool m_bHasObject;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -1,9 +1,15 @@
 #include "IOEFont.h"
 
+#include <algorithm>
+#include <functional>
+#include <map>
+
 #include <IOE/IOECore/IOEEngine.h>
 #include <IOE/IOERenderer/IOEMaterial.h>
 #include <IOE/IOEMaths/Camera.h>
 
+#include RPI_INCLUDE(IOEFont_Platform.h)
+
 namespace IOE
 {
 namespace Renderer
@@ -11,6 +17,16 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	namespace
+	{
+		typedef std::pair<std::string, EFontCreationFlags::Enum> FaceKey;
+
+		// Faces are only looked up by fonts being created, on the main thread
+		std::map<FaceKey, std::weak_ptr<IOEFontFace> > g_mapFaces;
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
 	IOEFontStyle::IOEFontStyle(const IOEVector &vColour_, float fScaleX_,
 							   float fScaleY_)
 		: vColour(vColour_)
@@ -21,33 +37,89 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
-	IOEFont::IOEFont()
-		: m_tIndexBuffer(IOEText::ms_uMaxNumChars * 6)
-		, m_tPlatform(this)
+	IOEFontFace::IOEFontFace(const std::string &szName,
+							 EFontCreationFlags::Enum eFlags)
+		: m_tAtlas(std::unique_ptr<IOEGlyphRasteriser>(
+			  new IOEFont_Platform(szName, eFlags)))
+		, m_uFrame(0)
 	{
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOEFont::Setup(IOERPI *pRPI)
+	std::shared_ptr<IOEFontFace>
+	IOEFontFace::FindFace(const std::string &szName,
+						  EFontCreationFlags::Enum eFlags)
+	{
+		std::weak_ptr<IOEFontFace> &rpFace(
+			g_mapFaces[FaceKey(szName, eFlags)]);
+		std::shared_ptr<IOEFontFace> pFace(rpFace.lock());
+		if (!pFace)
+		{
+			pFace  = std::make_shared<IOEFontFace>(szName, eFlags);
+			rpFace = pFace;
+		}
+		return pFace;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEFontFace::Update(std::uint32_t uFrame)
 	{
-		m_tPlatform.Setup(pRPI);
+		if (m_pTexture && m_uFrame == uFrame)
+		{
+			return;
+		}
+		m_uFrame = uFrame;
 
-		m_pTexture = std::make_shared<IOETexture>(
-			ETextureFormat::B8G8R8A8_UNORM, m_fTextureWidth, m_fTextureHeight);
-		m_pTexture->SetBufferAccess(ECPUAccess::GPUReadOnlyConst);
-		m_pTexture->SetBufferDescription(EBufferDescription::ShaderResource);
+		const bool bChanged(m_tAtlas.Update(uFrame));
+		if (m_pTexture && !bChanged)
+		{
+			return;
+		}
+
+		// Glyphs arrive in bursts as new text appears, so the texture is
+		// made again from the whole image rather than patched
+		if (m_pTexture)
+		{
+			m_pTexture->Cleanup();
+		}
+		else
+		{
+			m_pTexture = std::make_shared<IOETexture>(
+				ETextureFormat::R8_UNORM,
+				static_cast<float>(m_tAtlas.GetWidth()),
+				static_cast<float>(m_tAtlas.GetHeight()));
+			m_pTexture->SetBufferAccess(ECPUAccess::GPUReadOnlyConst);
+			m_pTexture->SetBufferDescription(
+				EBufferDescription::ShaderResource);
+		}
 
 		IOETextureSource tSource;
-		tSource.pSrc = (void *)(m_arrTextureSource.data());
+		tSource.pSrc = const_cast<std::uint8_t *>(m_tAtlas.GetImage().data());
 		tSource.uNumMipMaps		= 1;
-		tSource.uPixelSizeBytes = 4;
+		tSource.uPixelSizeBytes = 1;
 
 		m_pTexture->Setup(&tSource);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEFont::IOEFont()
+		: m_tIndexBuffer(ms_uMaxCharsPerDraw * 6)
+		, m_uHeight(0)
+		, m_eCreationFlag((EFontCreationFlags::Enum)0)
+		, m_fGlyphScale(1.0f)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
 
+	void IOEFont::Setup(IOERPI *pRPI)
+	{
 		m_tIndexBuffer.SetBufferDescription(EBufferDescription::Index);
 		m_tIndexBuffer.SetCPUAccess(ECPUAccess::GPUReadOnlyConst);
-		for (std::uint32_t uIdx(0); uIdx < IOEText::ms_uMaxNumChars; ++uIdx)
+		for (std::uint32_t uIdx(0); uIdx < ms_uMaxCharsPerDraw; ++uIdx)
 		{
 			m_tIndexBuffer.Set(uIdx * 6 + 0, uIdx * 4 + 0);
 			m_tIndexBuffer.Set(uIdx * 6 + 1, uIdx * 4 + 2);
@@ -71,7 +143,11 @@ namespace Renderer
 
 		pFont->m_uHeight	   = uHeight;
 		pFont->m_eCreationFlag = eFlags;
-		pFont->m_tPlatform.SetFontName(szFontName);
+		pFont->m_pFace		   = IOEFontFace::FindFace(szFontName, eFlags);
+
+		// Points to pixels at the 96 DPI GDI assumes
+		pFont->m_fGlyphScale = uHeight * 96.0f / 72.0f /
+			static_cast<float>(IOEGlyphAtlas::ms_uGlyphHeight);
 
 		return pFont;
 	}
@@ -90,21 +166,22 @@ namespace Renderer
 		, m_bSetup(false)
 		, m_vColourBegin(vColourBegin)
 		, m_vColourEnd(vColourEnd)
-		, m_tVertexBuffer(ms_uMaxNumChars * 4)
 		, m_fScaleX(1.0f)
 		, m_fScaleY(1.0f)
+		, m_fRenderWidth(0.0f)
+		, m_fRenderHeight(0.0f)
+		, m_uGlyphGeneration(0)
+		, m_uNumLayouts(0)
+		, m_bLayoutDirty(true)
+		, m_bColoursDirty(true)
 	{
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOEText::Setup(IOERPI *pRPI)
+	void IOEText::Setup(IOERPI * /*pRPI*/)
 	{
-		UpdateData();
-
-		m_tVertexBuffer.SetCPUAccess(ECPUAccess::GPUReadCPUWrite);
-		m_tVertexBuffer.SetBufferDescription(EBufferDescription::Vertex);
-		m_tVertexBuffer.Setup(pRPI);
+		UpdateLayout();
 
 		m_bSetup = true;
 	}
@@ -113,9 +190,12 @@ namespace Renderer
 
 	void IOEText::UpdateScale(float fScaleX, float fScaleY)
 	{
-		m_fScaleX = fScaleX;
-		m_fScaleY = fScaleY;
-		UpdateData();
+		if (m_fScaleX != fScaleX || m_fScaleY != fScaleY)
+		{
+			m_fScaleX	  = fScaleX;
+			m_fScaleY	  = fScaleY;
+			m_bLayoutDirty = true;
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -124,9 +204,8 @@ namespace Renderer
 	{
 		if (m_szData != szData)
 		{
-			m_szData = szData;
-
-			UpdateData();
+			m_szData	   = szData;
+			m_bLayoutDirty = true;
 		}
 	}
 
@@ -136,15 +215,13 @@ namespace Renderer
 	{
 		m_fX = fX;
 		m_fY = fY;
-		UpdateData();
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
 	void IOEText::UpdateColour(const IOEVector &vColour)
 	{
-		m_vColourBegin = m_vColourEnd = vColour;
-		UpdateData();
+		UpdateColour(vColour, vColour);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -152,140 +229,146 @@ namespace Renderer
 	void IOEText::UpdateColour(const IOEVector &vColourBegin,
 							   const IOEVector &vColourEnd)
 	{
-		m_vColourBegin = vColourBegin;
-		m_vColourEnd   = vColourEnd;
-		UpdateData();
+		m_vColourBegin   = vColourBegin;
+		m_vColourEnd	   = vColourEnd;
+		m_bColoursDirty = true;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOEText::OnRender(IOE::Renderer::IOERPI *pPtr)
+	std::uint32_t IOEText::GetNumQuads()
 	{
-		pPtr->DrawBuffer(&m_tVertexBuffer, EPrimitiveTopology::TriangleList,
-						 m_pFont->GetIndexBuffer(),
-						 (std::int32_t)(m_szData.size()) * 6);
+		UpdateLayout();
+		return static_cast<std::uint32_t>(m_arrVertices.size() / 4);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	bool IOEText::Map(void *&rpData)
+	void IOEText::WriteVertices(FontVertex *pVertices)
 	{
-		return m_tVertexBuffer.Map(EBufferMapType::WriteDiscard, rpData);
-	}
+		UpdateLayout();
+		UpdateColours();
 
-	//////////////////////////////////////////////////////////////////////////
+		for (std::uint32_t uCodePoint : m_arrCodePoints)
+		{
+			m_pFont->FindGlyph(uCodePoint);
+		}
 
-	bool IOEText::Unmap()
-	{
-		return m_tVertexBuffer.Unmap();
+		for (const FontVertex &rVertex : m_arrVertices)
+		{
+			*pVertices = rVertex;
+			pVertices->vPos.x += m_fX;
+			pVertices->vPos.y += m_fY;
+			++pVertices;
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
 	float IOEText::GetRenderWidth()
 	{
-		float fStringSize(0.0f);
-		for (size_t nIdx(0); nIdx < m_szData.size(); ++nIdx)
-		{
-			char chCharacter = m_szData.at(nIdx);
-			const IOEFontGlyph *pGlyph(m_pFont->GetGlyphFromChar(chCharacter));
-			if (pGlyph != nullptr)
-			{
-				fStringSize += pGlyph->fSizeX;
-			}
-		}
-		return fStringSize * m_fScaleX;
+		UpdateLayout();
+		return m_fRenderWidth;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
 	float IOEText::GetRenderHeight()
 	{
-		float fStringSize(0.0f);
-		for (size_t nIdx(0); nIdx < m_szData.size(); ++nIdx)
-		{
-			char chCharacter = m_szData.at(nIdx);
-			const IOEFontGlyph *pGlyph(m_pFont->GetGlyphFromChar(chCharacter));
-			if (pGlyph != nullptr)
-			{
-				fStringSize += pGlyph->fSizeY;
-			}
-		}
-		return fStringSize * m_fScaleY;
+		UpdateLayout();
+		return m_fRenderHeight;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOEText::UpdateData()
+	void IOEText::UpdateLayout()
 	{
-		void *pSrcData = nullptr;
-		if (m_bSetup)
+		if (!m_bLayoutDirty &&
+			m_uGlyphGeneration == m_pFont->GetGlyphGeneration())
 		{
-			bool bSuccessful(Map(pSrcData));
-			IOE_ASSERT(bSuccessful, "Not Successfull!");
-			if (!bSuccessful)
-			{
-				return;
-			}
+			return;
 		}
+		++m_uNumLayouts;
 
-		float fRenderWidth(GetRenderWidth());
+		m_arrVertices.clear();
+		m_arrCodePoints.clear();
+		m_fRenderWidth  = 0.0f;
+		m_fRenderHeight = 0.0f;
 
-		float fCurrentX(m_fX);
+		const float fScaleX(m_pFont->GetGlyphScale() * m_fScaleX);
+		const float fScaleY(m_pFont->GetGlyphScale() * m_fScaleY);
 
-		for (size_t nIdx(0); nIdx < m_szData.size(); ++nIdx)
+		size_t nIdx(0);
+		while (nIdx < m_szData.size())
 		{
-			char chCharacter = m_szData.at(nIdx);
-			const IOEFontGlyph *pGlyph(m_pFont->GetGlyphFromChar(chCharacter));
-			if (pGlyph != nullptr)
+			const std::uint32_t uCodePoint(DecodeUTF8(m_szData, nIdx));
+			if (uCodePoint < 32)
 			{
-				IOEVector vColourStart(
-					IOEVector::Lerp(m_vColourBegin, m_vColourEnd,
-									(fCurrentX - m_fX) / fRenderWidth));
-				IOEVector vColourEnd(IOEVector::Lerp(
-					m_vColourBegin, m_vColourEnd,
-					(fCurrentX - m_fX + pGlyph->fSizeX) / fRenderWidth));
-
-				m_tVertexBuffer.SetEmplace(
-					nIdx * 4, IOEVector(fCurrentX, m_fY, 0.0f, 1.0f),
-					vColourStart, pGlyph->fTexMinX, pGlyph->fTexMaxY);
-
-				m_tVertexBuffer.SetEmplace(
-					nIdx * 4 + 1,
-					IOEVector(fCurrentX + pGlyph->fSizeX * m_fScaleX, m_fY,
-							  0.0f, 1.0f),
-					vColourEnd, pGlyph->fTexMaxX, pGlyph->fTexMaxY);
-
-				m_tVertexBuffer.SetEmplace(
-					nIdx * 4 + 2,
-					IOEVector(fCurrentX, m_fY + pGlyph->fSizeY * m_fScaleY,
-							  0.0f, 1.0f),
-					vColourStart, pGlyph->fTexMinX, pGlyph->fTexMinY);
-
-				m_tVertexBuffer.SetEmplace(
-					nIdx * 4 + 3,
-					IOEVector(fCurrentX + pGlyph->fSizeX * m_fScaleX,
-							  m_fY + pGlyph->fSizeY * m_fScaleY, 0.0f, 1.0f),
-					vColourEnd, pGlyph->fTexMaxX, pGlyph->fTexMinY);
-
-				fCurrentX += pGlyph->fSizeX * m_fScaleX;
+				continue;
 			}
-		}
 
-		if (m_bSetup)
-		{
-			FontVertex *pTypedData(reinterpret_cast<FontVertex *>(pSrcData));
-			memcpy(pTypedData, m_tVertexBuffer.GetRawData(),
-				   m_tVertexBuffer.GetNumElements() *
-					   m_tVertexBuffer.GetElementSize());
-
-			bool bSuccessful(Unmap());
-			IOE_ASSERT(bSuccessful, "Not Successfull!");
-			if (!bSuccessful)
+			// Glyphs still being rasterised are left out until the atlas
+			// changes generation with them in it
+			const IOEAtlasGlyph *pGlyph(m_pFont->FindGlyph(uCodePoint));
+			if (pGlyph == nullptr)
 			{
-				return;
+				continue;
 			}
+			m_arrCodePoints.push_back(uCodePoint);
+
+			if (pGlyph->uWidth > 0)
+			{
+				const float fMinX(m_fRenderWidth + pGlyph->fOffsetX * fScaleX);
+				const float fMaxX(fMinX + pGlyph->fSizeX * fScaleX);
+				const float fMinY(pGlyph->fOffsetY * fScaleY);
+				const float fMaxY(fMinY + pGlyph->fSizeY * fScaleY);
+
+				m_arrVertices.emplace_back(IOEVector(fMinX, fMinY, 0.0f, 1.0f),
+										   m_vColourBegin, pGlyph->fTexMinX,
+										   pGlyph->fTexMaxY);
+				m_arrVertices.emplace_back(IOEVector(fMaxX, fMinY, 0.0f, 1.0f),
+										   m_vColourBegin, pGlyph->fTexMaxX,
+										   pGlyph->fTexMaxY);
+				m_arrVertices.emplace_back(IOEVector(fMinX, fMaxY, 0.0f, 1.0f),
+										   m_vColourBegin, pGlyph->fTexMinX,
+										   pGlyph->fTexMinY);
+				m_arrVertices.emplace_back(IOEVector(fMaxX, fMaxY, 0.0f, 1.0f),
+										   m_vColourBegin, pGlyph->fTexMaxX,
+										   pGlyph->fTexMinY);
+			}
+
+			m_fRenderWidth += pGlyph->fAdvance * fScaleX;
+			m_fRenderHeight += pGlyph->fLineHeight * fScaleY;
+		}
+
+		m_uGlyphGeneration = m_pFont->GetGlyphGeneration();
+		m_bLayoutDirty	 = false;
+		m_bColoursDirty	= true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEText::UpdateColours()
+	{
+		if (!m_bColoursDirty)
+		{
+			return;
 		}
+
+		// Blended along the text by how far across it each vertex lies,
+		// the borders of the first and last glyphs reaching a little past
+		// either end
+		const float fInvWidth(m_fRenderWidth > 0.0f ? 1.0f / m_fRenderWidth
+													: 0.0f);
+		for (FontVertex &rVertex : m_arrVertices)
+		{
+			float fAlong(rVertex.vPos.x * fInvWidth);
+			fAlong = fAlong < 0.0f ? 0.0f : (fAlong > 1.0f ? 1.0f : fAlong);
+			rVertex.vColour =
+				IOEVector::Lerp(m_vColourBegin, m_vColourEnd, fAlong);
+		}
+
+		m_bColoursDirty = false;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -295,6 +378,7 @@ namespace Renderer
 		, tDepthDisable(IOEDepthState::Default())
 		, tAlphaBlending(IOEBlendState::DefaultAlpha())
 		, m_bVisible(true)
+		, m_uFrame(0)
 	{
 		tDepthDisable.tData.bDepthEnable = false;
 	}
@@ -323,6 +407,9 @@ namespace Renderer
 			Core::Algorithm::JoinPath(IOE::Core::g_pEngine->GetMediaPath(),
 									  L"Materials", L"RenderText.ioe.xml"));
 
+		m_tWorldViewProj =
+			m_pFontShader->GetShaderParameter("Globals", "WorldViewProj");
+
 		tDepthDisable.Setup(IOERPI::GetSingletonPtr());
 		tAlphaBlending.Setup(IOERPI::GetSingletonPtr());
 	}
@@ -348,24 +435,58 @@ namespace Renderer
 				IOE::Maths::IOECamera::EProjectionMethod::Orthographic;
 			IOE::Maths::IOECamera mCameraTemp;
 
-			mCameraTemp.SetOrthographic();
+			// Sized to the colour buffer the text is drawn into
+			const IOEViewport &rViewport(pPtr->GetDefaultViewport());
+			mCameraTemp.SetOrthographic(rViewport.GetWidth(),
+										rViewport.GetHeight());
 			mCameraTemp.UpdateViewMatrices();
 
 			IOE::Maths::IOECamera tOldCamera(pPtr->GetCamera());
 			pPtr->SetCamera(mCameraTemp);
 
+			m_pFontShader->SetShaderParameter(
+				m_tWorldViewProj, mCameraTemp.GetProjectionMatrix());
 			m_pFontShader->Set(pPtr, false);
 
-			m_pFontShader->MapCBuffer("Globals");
-			m_pFontShader->SetShaderVariableValue(
-				"Globals", "WorldViewProj", mCameraTemp.GetProjectionMatrix());
-			m_pFontShader->UnmapCBuffer("Globals");
+			// Every atlas takes its new glyphs before any text is laid out
+			++m_uFrame;
+			for (auto &rText : m_arrTextInstances)
+			{
+				rText->GetFont()->GetFace()->Update(m_uFrame);
+			}
 
+			m_arrBatch.clear();
 			for (auto &rText : m_arrTextInstances)
 			{
-				m_pFontShader->SetTextureVariable(pPtr,
-					"GlyphSampler", rText->GetFont()->GetTexture());
-				rText->OnRender(pPtr);
+				if (rText->IsSetup() && rText->GetNumQuads() > 0)
+				{
+					m_arrBatch.push_back(rText.get());
+				}
+			}
+			std::stable_sort(m_arrBatch.begin(), m_arrBatch.end(),
+							 [](const IOEText *pLHS, const IOEText *pRHS) {
+								 return std::less<const IOEFontFace *>()(
+									 pLHS->GetFont()->GetFace(),
+									 pRHS->GetFont()->GetFace());
+							 });
+
+			// Fonts of any size share their face's atlas, and so a draw
+			size_t uBegin(0);
+			while (uBegin < m_arrBatch.size())
+			{
+				IOEFont *pFont(m_arrBatch[uBegin]->GetFont());
+				size_t uEnd(uBegin);
+				std::uint32_t uNumQuads(0);
+				while (uEnd < m_arrBatch.size() &&
+					   m_arrBatch[uEnd]->GetFont()->GetFace() ==
+						   pFont->GetFace())
+				{
+					uNumQuads += m_arrBatch[uEnd]->GetNumQuads();
+					++uEnd;
+				}
+
+				RenderBatch(pPtr, pFont, uBegin, uEnd, uNumQuads);
+				uBegin = uEnd;
 			}
 
 			pPtr->SetCamera(tOldCamera);
@@ -376,5 +497,49 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	void IOETextManager::RenderBatch(IOERPI *pPtr, IOEFont *pFont,
+									 size_t uBegin, size_t uEnd,
+									 std::uint32_t uNumQuads)
+	{
+		const std::uint32_t uStride(
+			static_cast<std::uint32_t>(sizeof(FontVertex)));
+		std::uint32_t uOffset(0);
+		void *pData(pPtr->MapUpload(EUploadRing::Vertex,
+									uNumQuads * 4 * uStride, 16, uOffset));
+		IOE_ASSERT(pData != nullptr, "Vertex upload ring is full");
+		if (pData == nullptr)
+		{
+			return;
+		}
+
+		FontVertex *pVertices(static_cast<FontVertex *>(pData));
+		for (size_t uIdx(uBegin); uIdx < uEnd; ++uIdx)
+		{
+			IOEText *pText(m_arrBatch[uIdx]);
+			pText->WriteVertices(pVertices);
+			pVertices += pText->GetNumQuads() * 4;
+		}
+		pPtr->UnmapUpload(EUploadRing::Vertex);
+
+		m_pFontShader->SetTextureVariable(pPtr, "GlyphSampler",
+										  pFont->GetTexture());
+
+		// Only more quads than the index buffer covers need another draw
+		for (std::uint32_t uFirst(0); uFirst < uNumQuads;
+			 uFirst += IOEFont::ms_uMaxCharsPerDraw)
+		{
+			const std::uint32_t uRemaining(uNumQuads - uFirst);
+			const std::uint32_t uDrawQuads(
+				uRemaining < IOEFont::ms_uMaxCharsPerDraw
+					? uRemaining
+					: IOEFont::ms_uMaxCharsPerDraw);
+			pPtr->DrawUpload(uOffset + uFirst * 4 * uStride, uStride,
+							 EPrimitiveTopology::TriangleList, uDrawQuads * 6,
+							 pFont->GetIndexBuffer());
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 } // namespace Renderer
 } // namespace IOE
\ No newline at end of file
@@ -1,20 +1,22 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
-#include <array>
 #include <utility>
+#include <vector>
 
 #include <IOE/IOECore/IOEDefines.h>
 #include <IOE/IOECore/IOEManager.h>
 
 #include <IOE/IOEMaths/Vector.h>
 #include <IOE/IOERenderer/IOEBuffer.h>
+#include <IOE/IOERenderer/IOEFont_PlatformBase.h>
+#include <IOE/IOERenderer/IOEGlyphAtlas.h>
+#include <IOE/IOERenderer/IOEMaterial.h>
 #include <IOE/IOERenderer/IOEVertexFormat.h>
 #include <IOE/IOERenderer/IOERPI.h>
 
-#include RPI_INCLUDE(IOEFont_Platform.h)
-
 using IOE::Maths::IOEVector;
 
 namespace IOE
@@ -30,16 +32,6 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
-	namespace EFontCreationFlags
-	{
-		enum Enum
-		{
-			Bold,
-		};
-	}
-
-	//////////////////////////////////////////////////////////////////////////
-
 	struct IOEFontStyle
 	{
 		IOEVector vColour;
@@ -51,78 +43,54 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
-	struct IOEFontGlyph
+	// A typeface in one style, its glyphs kept in an atlas of distance
+	// fields shared by every size of the font
+	class IOEFontFace
 	{
-		float fSizeX, fSizeY;
-		float fTexMinX, fTexMinY;
-		float fTexMaxX, fTexMaxY;
-
-		IOEFontGlyph()
-			: fSizeX(0.0f)
-			, fSizeY(0.0f)
-			, fTexMinX(0.0f)
-			, fTexMinY(0.0f)
-			, fTexMaxX(0.0f)
-			, fTexMaxY(0.0f)
-		{
-		}
+	public:
+		IOEFontFace(const std::string &szName,
+					EFontCreationFlags::Enum eFlags);
 
-		IOEFontGlyph(float fSizeX_, float fSizeY_, float fTexMinX_,
-					 float fTexMinY_, float fTexMaxX_, float fTexMaxY_)
-			: fSizeX(fSizeX_)
-			, fSizeY(fSizeY_)
-			, fTexMinX(fTexMinX_)
-			, fTexMinY(fTexMinY_)
-			, fTexMaxX(fTexMaxX_)
-			, fTexMaxY(fTexMaxY_)
-		{
-		}
+		// The face of that name and style any font still holds, or a new one
+		static std::shared_ptr<IOEFontFace>
+		FindFace(const std::string &szName, EFontCreationFlags::Enum eFlags);
+
+		// Once a frame, before any text is laid out. Publishes the glyphs
+		// rasterised since, and uploads the atlas when it changed.
+		void Update(std::uint32_t uFrame);
 
-		IOEFontGlyph(IOEFontGlyph &&rhs)
-			: fSizeX(std::move(rhs.fSizeX))
-			, fSizeY(std::move(rhs.fSizeY))
-			, fTexMinX(std::move(rhs.fTexMinX))
-			, fTexMinY(std::move(rhs.fTexMinY))
-			, fTexMaxX(std::move(rhs.fTexMaxX))
-			, fTexMaxY(std::move(rhs.fTexMaxY))
+		IOEGlyphAtlas &GetAtlas()
 		{
+			return m_tAtlas;
 		}
-
-		IOEFontGlyph(const IOEFontGlyph &rhs)
-			: fSizeX(rhs.fSizeX)
-			, fSizeY(rhs.fSizeY)
-			, fTexMinX(rhs.fTexMinX)
-			, fTexMinY(rhs.fTexMinY)
-			, fTexMaxX(rhs.fTexMaxX)
-			, fTexMaxY(rhs.fTexMaxY)
+		const IOEGlyphAtlas &GetAtlas() const
 		{
+			return m_tAtlas;
 		}
 
-		IOEFontGlyph &operator=(IOEFontGlyph &&rhs)
+		IOETexture *GetTexture()
 		{
-			fSizeX   = std::move(rhs.fSizeX);
-			fSizeY   = std::move(rhs.fSizeY);
-			fTexMinX = std::move(rhs.fTexMinX);
-			fTexMinY = std::move(rhs.fTexMinY);
-			fTexMaxX = std::move(rhs.fTexMaxX);
-			fTexMaxY = std::move(rhs.fTexMaxY);
+			return m_pTexture.get();
 		}
-
-		IOEFontGlyph &operator=(const IOEFontGlyph &rhs)
+		const IOETexture *GetTexture() const
 		{
-			fSizeX   = rhs.fSizeX;
-			fSizeY   = rhs.fSizeY;
-			fTexMinX = rhs.fTexMinX;
-			fTexMinY = rhs.fTexMinY;
-			fTexMaxX = rhs.fTexMaxX;
-			fTexMaxY = rhs.fTexMaxY;
+			return m_pTexture.get();
 		}
+
+	private:
+		IOEGlyphAtlas m_tAtlas;
+		std::shared_ptr<IOETexture> m_pTexture;
+		std::uint32_t m_uFrame;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
 
 	class IOEFont
 	{
+	public:
+		// Quads the index buffer covers, so the most one draw can take
+		static const std::uint32_t ms_uMaxCharsPerDraw = 4096;
+
 	public:
 		IOEFont();
 
@@ -141,44 +109,31 @@ namespace Renderer
 			return m_eCreationFlag;
 		}
 
-		void EmplaceGlyph(std::uint32_t uGlyphIdx, float fSizeX_,
-						  float fSizeY_, float fTexMinX_, float fTexMinY_,
-						  float fTexMaxX_, float fTexMaxY_)
+		// Glyph sizes are in pixels of the atlas's em, so this takes them
+		// to pixels of the font's height in points
+		float GetGlyphScale() const
 		{
-			m_arrGlyphs[uGlyphIdx] = IOEFontGlyph(
-				fSizeX_, fSizeY_, fTexMinX_, fTexMinY_, fTexMaxX_, fTexMaxY_);
+			return m_fGlyphScale;
 		}
 
-		void EmplaceTextureByte(std::uint32_t uTextureIdx,
-								std::uint32_t uTextureByte)
+		// nullptr until the glyph has been rasterised
+		const IOEAtlasGlyph *FindGlyph(std::uint32_t uCodePoint)
 		{
-			m_arrTextureSource[uTextureIdx] = uTextureByte;
+			return m_pFace->GetAtlas().FindGlyph(uCodePoint);
 		}
 
-		IOEFontGlyph &GetGlyph(std::uint32_t uGlyphIndex)
+		std::uint32_t GetGlyphGeneration() const
 		{
-			return m_arrGlyphs[uGlyphIndex];
-		}
-		const IOEFontGlyph &GetGlyph(std::uint32_t uGlyphIndex) const
-		{
-			return m_arrGlyphs[uGlyphIndex];
+			return m_pFace->GetAtlas().GetGeneration();
 		}
 
-		IOEFontGlyph *GetGlyphFromChar(char chCharacter)
-		{
-			return chCharacter >= 32 ? &m_arrGlyphs[chCharacter - 32]
-									 : nullptr;
-		}
-		const IOEFontGlyph *GetGlyphFromChar(char chCharacter) const
+		IOEFontFace *GetFace()
 		{
-			return chCharacter >= 32 ? &m_arrGlyphs[chCharacter - 32]
-									 : nullptr;
+			return m_pFace.get();
 		}
-
-		void SetTextureSize(float fWidth, float fHeight)
+		const IOEFontFace *GetFace() const
 		{
-			m_fTextureWidth  = fWidth;
-			m_fTextureHeight = fHeight;
+			return m_pFace.get();
 		}
 
 		IOEBufferBase *GetIndexBuffer()
@@ -190,50 +145,30 @@ namespace Renderer
 			return &m_tIndexBuffer;
 		}
 
-		std::shared_ptr<IOETexture> GetTextureShared()
-		{
-			return m_pTexture;
-		}
-
-		const std::shared_ptr<IOETexture> GetTextureShared() const
-		{
-			return m_pTexture;
-		}
-
 		IOETexture *GetTexture()
 		{
-			return m_pTexture.get();
+			return m_pFace->GetTexture();
 		}
 
 		const IOETexture *GetTexture() const
 		{
-			return m_pTexture.get();
+			return m_pFace->GetTexture();
 		}
 
 	private:
-		IOEFont_Platform m_tPlatform;
-
-		std::shared_ptr<IOETexture> m_pTexture;
+		std::shared_ptr<IOEFontFace> m_pFace;
 
 		IOEBuffer<std::uint32_t> m_tIndexBuffer;
 
 		std::uint32_t m_uHeight;
 		EFontCreationFlags::Enum m_eCreationFlag;
-
-		std::array<IOEFontGlyph, 128> m_arrGlyphs;
-		std::array<std::uint32_t, 4096 * 4096> m_arrTextureSource;
-
-		float m_fTextureWidth;
-		float m_fTextureHeight;
+		float m_fGlyphScale;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
 
 	class IOEText
 	{
-	public:
-		static const std::uint32_t ms_uMaxNumChars = 128;
-
 	public:
 		IOEText(const std::string &szData, float fX, float fY,
 				std::shared_ptr<IOEFont> pFont,
@@ -242,6 +177,9 @@ namespace Renderer
 
 		void Setup(IOERPI *pRPI);
 
+		// Only a new text or scale, or glyphs arriving in or leaving the
+		// font's atlas, lay the text out again. A new position or colour is
+		// applied to the cached layout. Text is UTF-8.
 		void UpdateScale(float fScaleX, float fScaleY);
 		void UpdateText(const std::string &szData);
 		void UpdatePosition(float fX, float fY);
@@ -249,10 +187,13 @@ namespace Renderer
 		void UpdateColour(const IOEVector &vColourBegin,
 						  const IOEVector &vColourEnd);
 
-		void OnRender(IOE::Renderer::IOERPI *pPtr);
+		// One quad per visible character whose glyph is in the atlas
+		std::uint32_t GetNumQuads();
 
-		bool Map(void *&rpData);
-		bool Unmap();
+		// Writes GetNumQuads() quads, four vertices each, at the text's
+		// position. Called by the text manager as it batches every text of
+		// an atlas into one draw.
+		void WriteVertices(FontVertex *pVertices);
 
 		float GetRenderWidth();
 		float GetRenderHeight();
@@ -266,8 +207,21 @@ namespace Renderer
 			return m_pFont.get();
 		}
 
+		bool IsSetup() const
+		{
+			return m_bSetup;
+		}
+
+		// Times the quads have been laid out, which only a change that
+		// moves them should add to
+		std::uint32_t GetNumLayouts() const
+		{
+			return m_uNumLayouts;
+		}
+
 	private:
-		void UpdateData();
+		void UpdateLayout();
+		void UpdateColours();
 
 	private:
 		std::shared_ptr<IOEFont> m_pFont;
@@ -277,8 +231,19 @@ namespace Renderer
 		IOEVector m_vColourBegin;
 		IOEVector m_vColourEnd;
 
-		IOEBuffer<FontVertex> m_tVertexBuffer;
+		// Quads laid out from the origin, so moving the text leaves them be
+		std::vector<FontVertex> m_arrVertices;
+		float m_fRenderWidth;
+		float m_fRenderHeight;
+
+		// Looked up again each frame the text is drawn, so the atlas keeps
+		// its glyphs over those of text no longer drawn
+		std::vector<std::uint32_t> m_arrCodePoints;
+		std::uint32_t m_uGlyphGeneration;
+		std::uint32_t m_uNumLayouts;
 
+		bool m_bLayoutDirty;
+		bool m_bColoursDirty;
 		bool m_bSetup;
 	};
 
@@ -309,11 +274,22 @@ namespace Renderer
 
 		virtual void OnRender(IOE::Renderer::IOERPI *pPtr) override final;
 
+	private:
+		// Uploads the quads of m_arrBatch[uBegin, uEnd), which all use the
+		// atlas of pFont, and draws them together
+		void RenderBatch(IOERPI *pPtr, IOEFont *pFont, size_t uBegin,
+						 size_t uEnd, std::uint32_t uNumQuads);
+
 	private:
 		std::shared_ptr<IOEMaterial> m_pFontShader;
+		IOEShaderParameterHandle m_tWorldViewProj;
 
 		std::vector<std::shared_ptr<IOEText> > m_arrTextInstances;
 
+		// Texts of this frame, sorted so each atlas's are side by side
+		std::vector<IOEText *> m_arrBatch;
+		std::uint32_t m_uFrame;
+
 		bool m_bVisible;
 
 		IOEBlendState tAlphaBlending;
@@ -4,6 +4,8 @@
 
 #include <IOE/IOECore/IOEDefines.h>
 
+#include "IOEGlyphAtlas.h"
+
 namespace IOE
 {
 namespace Renderer
@@ -11,35 +13,40 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
-	class IOEFont;
+	namespace EFontCreationFlags
+	{
+		enum Enum
+		{
+			Bold,
+		};
+	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	abstract_class IOEFont_PlatformBase
+	// Rasterises the glyphs of one typeface for its atlas
+	abstract_class IOEFont_PlatformBase : public IOEGlyphRasteriser
 	{
 	public:
-		IOEFont_PlatformBase(IOEFont * pFont)
-			: m_pFont(pFont)
+		IOEFont_PlatformBase(const std::string &szName,
+							 EFontCreationFlags::Enum eCreationFlags)
+			: m_szName(szName)
+			, m_eCreationFlags(eCreationFlags)
 		{
 		}
 
-	public:
-		virtual void Setup(class IOERPI * pRPI) = 0;
-
-		virtual void SetFontName(const std::string &szName) = 0;
-
 	protected:
-		IOEFont *GetFont()
+		const std::string &GetFontName() const
 		{
-			return m_pFont;
+			return m_szName;
 		}
-		const IOEFont *GetFont() const
+		EFontCreationFlags::Enum GetCreationFlags() const
 		{
-			return m_pFont;
+			return m_eCreationFlags;
 		}
 
 	private:
-		IOEFont *m_pFont;
+		std::string m_szName;
+		EFontCreationFlags::Enum m_eCreationFlags;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,578 @@
+#include "IOEGlyphAtlas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		// Distance to the nearest texel on the other side of the glyph's
+		// edge, searched out to the spread and stored with 0.5 on the edge,
+		// above inside and below outside. The field has a border of the
+		// spread around the bitmap, so the outside fades off in every
+		// direction.
+		void GenerateDistanceField(const IOEGlyphBitmap &rBitmap,
+								   std::vector<std::uint8_t> &rarrField)
+		{
+			const int nSpread(static_cast<int>(IOEGlyphAtlas::ms_uSpread));
+			const int nWidth(static_cast<int>(rBitmap.uWidth) + nSpread * 2);
+			const int nHeight(static_cast<int>(rBitmap.uHeight) +
+							  nSpread * 2);
+
+			std::vector<std::uint8_t> arrInside(nWidth * nHeight, 0);
+			for (std::uint32_t uY(0); uY < rBitmap.uHeight; ++uY)
+			{
+				for (std::uint32_t uX(0); uX < rBitmap.uWidth; ++uX)
+				{
+					arrInside[(uY + nSpread) * nWidth + uX + nSpread] =
+						rBitmap.arrCoverage[uY * rBitmap.uWidth + uX] >= 128
+						? 1
+						: 0;
+				}
+			}
+
+			rarrField.resize(nWidth * nHeight);
+			for (int nY(0); nY < nHeight; ++nY)
+			{
+				for (int nX(0); nX < nWidth; ++nX)
+				{
+					const std::uint8_t uInside(arrInside[nY * nWidth + nX]);
+
+					int nNearestSq((nSpread + 1) * (nSpread + 1));
+					for (int nDY(-nSpread); nDY <= nSpread; ++nDY)
+					{
+						for (int nDX(-nSpread); nDX <= nSpread; ++nDX)
+						{
+							const int nOtherX(nX + nDX);
+							const int nOtherY(nY + nDY);
+							const std::uint8_t uOtherInside(
+								nOtherX >= 0 && nOtherX < nWidth &&
+										nOtherY >= 0 && nOtherY < nHeight
+									? arrInside[nOtherY * nWidth + nOtherX]
+									: 0);
+							const int nDistanceSq(nDX * nDX + nDY * nDY);
+							if (uOtherInside != uInside &&
+								nDistanceSq < nNearestSq)
+							{
+								nNearestSq = nDistanceSq;
+							}
+						}
+					}
+
+					// The edge lies halfway between the two texels
+					const float fDistance(
+						std::sqrt(static_cast<float>(nNearestSq)) - 0.5f);
+					float fValue(0.5f +
+								 (uInside != 0 ? fDistance : -fDistance) /
+									 (2.0f * nSpread));
+					fValue = fValue < 0.0f ? 0.0f
+										   : (fValue > 1.0f ? 1.0f : fValue);
+					rarrField[nY * nWidth + nX] =
+						static_cast<std::uint8_t>(fValue * 255.0f + 0.5f);
+				}
+			}
+		}
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t DecodeUTF8(const std::string &szData, size_t &ruIdx)
+	{
+		const std::uint8_t uLead(static_cast<std::uint8_t>(szData[ruIdx++]));
+		if (uLead < 0x80)
+		{
+			return uLead;
+		}
+
+		std::uint32_t uCodePoint(0), uNumTrailing(0), uMinimum(0);
+		if ((uLead & 0xE0) == 0xC0)
+		{
+			uCodePoint   = uLead & 0x1F;
+			uNumTrailing = 1;
+			uMinimum	 = 0x80;
+		}
+		else if ((uLead & 0xF0) == 0xE0)
+		{
+			uCodePoint   = uLead & 0x0F;
+			uNumTrailing = 2;
+			uMinimum	 = 0x800;
+		}
+		else if ((uLead & 0xF8) == 0xF0)
+		{
+			uCodePoint   = uLead & 0x07;
+			uNumTrailing = 3;
+			uMinimum	 = 0x10000;
+		}
+		else
+		{
+			return 0xFFFD;
+		}
+
+		for (std::uint32_t uIdx(0); uIdx < uNumTrailing; ++uIdx)
+		{
+			if (ruIdx >= szData.size() ||
+				(static_cast<std::uint8_t>(szData[ruIdx]) & 0xC0) != 0x80)
+			{
+				return 0xFFFD;
+			}
+			uCodePoint = (uCodePoint << 6) |
+				(static_cast<std::uint8_t>(szData[ruIdx++]) & 0x3F);
+		}
+
+		// Overlong forms, surrogates and anything past the last plane
+		if (uCodePoint < uMinimum || uCodePoint > 0x10FFFF ||
+			(uCodePoint >= 0xD800 && uCodePoint <= 0xDFFF))
+		{
+			return 0xFFFD;
+		}
+		return uCodePoint;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEGlyphBitmap::IOEGlyphBitmap()
+		: uWidth(0)
+		, uHeight(0)
+		, fAdvance(0.0f)
+		, fBearingX(0.0f)
+		, fBearingY(0.0f)
+		, fLineHeight(0.0f)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOESkylinePacker::IOESkylinePacker()
+		: m_uWidth(0)
+		, m_uHeight(0)
+		, m_uUsedArea(0)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOESkylinePacker::Reset(std::uint32_t uWidth, std::uint32_t uHeight)
+	{
+		m_uWidth	= uWidth;
+		m_uHeight   = uHeight;
+		m_uUsedArea = 0;
+
+		Segment tGround;
+		tGround.uX	 = 0;
+		tGround.uY	 = 0;
+		tGround.uWidth = uWidth;
+		m_arrSkyline.assign(1, tGround);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOESkylinePacker::Fit(size_t uIdx, std::uint32_t uWidth,
+							   std::uint32_t uHeight, std::uint32_t &ruY) const
+	{
+		if (m_arrSkyline[uIdx].uX + uWidth > m_uWidth)
+		{
+			return false;
+		}
+
+		// Segments cover the whole width, so the ones after uIdx always
+		// reach past the rectangle
+		std::uint32_t uY(0);
+		std::uint32_t uRemaining(uWidth);
+		for (size_t uSegment(uIdx); uRemaining > 0; ++uSegment)
+		{
+			const Segment &rSegment(m_arrSkyline[uSegment]);
+			uY = rSegment.uY > uY ? rSegment.uY : uY;
+			if (uY + uHeight > m_uHeight)
+			{
+				return false;
+			}
+			uRemaining = rSegment.uWidth < uRemaining
+				? uRemaining - rSegment.uWidth
+				: 0;
+		}
+
+		ruY = uY;
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOESkylinePacker::Insert(std::uint32_t uWidth, std::uint32_t uHeight,
+								  std::uint32_t &ruX, std::uint32_t &ruY)
+	{
+		IOE_ASSERT(uWidth > 0 && uHeight > 0, "Cannot pack an empty rectangle");
+
+		size_t uBest(m_arrSkyline.size());
+		std::uint32_t uBestY(0);
+		std::uint32_t uBestBottom(m_uHeight + 1);
+		std::uint32_t uBestWidth(0);
+		for (size_t uIdx(0); uIdx < m_arrSkyline.size(); ++uIdx)
+		{
+			std::uint32_t uY(0);
+			if (!Fit(uIdx, uWidth, uHeight, uY))
+			{
+				continue;
+			}
+
+			// Lowest bottom edge first, then the narrowest segment, so
+			// wide gaps are left for wide rectangles
+			const std::uint32_t uBottom(uY + uHeight);
+			if (uBottom < uBestBottom ||
+				(uBottom == uBestBottom &&
+				 m_arrSkyline[uIdx].uWidth < uBestWidth))
+			{
+				uBest		= uIdx;
+				uBestY		= uY;
+				uBestBottom = uBottom;
+				uBestWidth  = m_arrSkyline[uIdx].uWidth;
+			}
+		}
+		if (uBest == m_arrSkyline.size())
+		{
+			return false;
+		}
+
+		Segment tSegment;
+		tSegment.uX	 = m_arrSkyline[uBest].uX;
+		tSegment.uY	 = uBestBottom;
+		tSegment.uWidth = uWidth;
+		m_arrSkyline.insert(m_arrSkyline.begin() + uBest, tSegment);
+
+		// Trim the segments the new one now covers
+		const std::uint32_t uRight(tSegment.uX + uWidth);
+		size_t uNext(uBest + 1);
+		while (uNext < m_arrSkyline.size() && m_arrSkyline[uNext].uX < uRight)
+		{
+			Segment &rNext(m_arrSkyline[uNext]);
+			const std::uint32_t uOverlap(uRight - rNext.uX);
+			if (rNext.uWidth <= uOverlap)
+			{
+				m_arrSkyline.erase(m_arrSkyline.begin() + uNext);
+				continue;
+			}
+			rNext.uX += uOverlap;
+			rNext.uWidth -= uOverlap;
+			break;
+		}
+
+		for (size_t uIdx(0); uIdx + 1 < m_arrSkyline.size();)
+		{
+			if (m_arrSkyline[uIdx].uY == m_arrSkyline[uIdx + 1].uY)
+			{
+				m_arrSkyline[uIdx].uWidth += m_arrSkyline[uIdx + 1].uWidth;
+				m_arrSkyline.erase(m_arrSkyline.begin() + uIdx + 1);
+			}
+			else
+			{
+				++uIdx;
+			}
+		}
+
+		m_uUsedArea += uWidth * uHeight;
+		ruX = tSegment.uX;
+		ruY = uBestY;
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEGlyphAtlas::IOEGlyphAtlas(
+		std::unique_ptr<IOEGlyphRasteriser> pRasteriser,
+		std::uint32_t uWidth /*=1024*/, std::uint32_t uHeight /*=1024*/)
+		: m_pRasteriser(std::move(pRasteriser))
+		, m_uWidth(uWidth)
+		, m_uHeight(uHeight)
+		, m_arrImage(uWidth * uHeight, 0)
+		, m_uGeneration(0)
+		, m_uFrame(0)
+		, m_bWorking(false)
+		, m_bQuit(false)
+		, m_arrWorkerImage(uWidth * uHeight, 0)
+		, m_uWorkerGeneration(0)
+		, m_uWorkerFrame(0)
+		, m_uNumEvictions(0)
+	{
+		IOE_ASSERT(uWidth <= 0xFFFF && uHeight <= 0xFFFF,
+				   "Glyph atlas is too large to address");
+		m_tPacker.Reset(uWidth, uHeight);
+
+		m_tWorker = std::thread([this]() { ProcessRequests(); });
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEGlyphAtlas::~IOEGlyphAtlas()
+	{
+		{
+			std::lock_guard<std::mutex> tLock(m_tLock);
+			m_arrRequests.clear();
+			m_bQuit = true;
+		}
+		m_tWake.notify_one();
+		m_tWorker.join();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	const IOEAtlasGlyph *IOEGlyphAtlas::FindGlyph(std::uint32_t uCodePoint)
+	{
+		auto pIter(m_mapGlyphs.find(uCodePoint));
+		if (pIter != m_mapGlyphs.end())
+		{
+			pIter->second.uLastUsed = m_uFrame;
+			return &pIter->second;
+		}
+
+		if (m_setMissing.count(uCodePoint) == 0 &&
+			m_setQueued.insert(uCodePoint).second)
+		{
+			{
+				std::lock_guard<std::mutex> tLock(m_tLock);
+				m_arrRequests.push_back(uCodePoint);
+			}
+			m_tWake.notify_one();
+		}
+		return nullptr;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEGlyphAtlas::Update(std::uint32_t uFrame)
+	{
+		m_uFrame = uFrame;
+
+		std::lock_guard<std::mutex> tLock(m_tLock);
+		m_uWorkerFrame = uFrame;
+
+		// Glyphs looked up since the last Update are the last to be evicted
+		for (const auto &rPair : m_mapGlyphs)
+		{
+			auto pIter(m_mapWorkerGlyphs.find(rPair.first));
+			if (pIter != m_mapWorkerGlyphs.end() &&
+				pIter->second.uLastUsed < rPair.second.uLastUsed)
+			{
+				pIter->second.uLastUsed = rPair.second.uLastUsed;
+			}
+		}
+
+		for (std::uint32_t uCodePoint : m_arrFinished)
+		{
+			m_setQueued.erase(uCodePoint);
+		}
+		m_arrFinished.clear();
+		m_setMissing.insert(m_arrMissing.begin(), m_arrMissing.end());
+		m_arrMissing.clear();
+
+		if (m_uGeneration == m_uWorkerGeneration)
+		{
+			return false;
+		}
+
+		m_mapGlyphs   = m_mapWorkerGlyphs;
+		m_arrImage	= m_arrWorkerImage;
+		m_uGeneration = m_uWorkerGeneration;
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEGlyphAtlas::Flush()
+	{
+		std::unique_lock<std::mutex> tLock(m_tLock);
+		m_tIdle.wait(tLock, [this]() {
+			return m_arrRequests.empty() && !m_bWorking;
+		});
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t IOEGlyphAtlas::GetNumEvictions()
+	{
+		std::lock_guard<std::mutex> tLock(m_tLock);
+		return m_uNumEvictions;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEGlyphAtlas::ProcessRequests()
+	{
+		for (;;)
+		{
+			std::uint32_t uCodePoint(0);
+			{
+				std::unique_lock<std::mutex> tLock(m_tLock);
+				m_bWorking = false;
+				while (m_arrRequests.empty() && !m_bQuit)
+				{
+					m_tIdle.notify_all();
+					m_tWake.wait(tLock);
+				}
+				if (m_bQuit)
+				{
+					return;
+				}
+				uCodePoint = m_arrRequests.front();
+				m_arrRequests.pop_front();
+				m_bWorking = true;
+			}
+
+			// The slow part, done without holding the lock
+			IOEGlyphBitmap tBitmap;
+			std::vector<std::uint8_t> arrField;
+			const bool bRasterised(
+				m_pRasteriser->RasteriseGlyph(uCodePoint, ms_uGlyphHeight,
+											  tBitmap) &&
+				tBitmap.arrCoverage.size() ==
+					static_cast<size_t>(tBitmap.uWidth) * tBitmap.uHeight);
+			if (bRasterised && tBitmap.uWidth > 0 && tBitmap.uHeight > 0)
+			{
+				GenerateDistanceField(tBitmap, arrField);
+			}
+
+			std::lock_guard<std::mutex> tLock(m_tLock);
+			if (bRasterised && PlaceGlyph(uCodePoint, tBitmap, arrField))
+			{
+				++m_uWorkerGeneration;
+			}
+			else
+			{
+				m_arrMissing.push_back(uCodePoint);
+			}
+			m_arrFinished.push_back(uCodePoint);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEGlyphAtlas::PlaceGlyph(std::uint32_t uCodePoint,
+								   const IOEGlyphBitmap &rBitmap,
+								   const std::vector<std::uint8_t> &rarrField)
+	{
+		IOEAtlasGlyph tGlyph;
+		std::memset(&tGlyph, 0, sizeof(tGlyph));
+		tGlyph.fAdvance	= rBitmap.fAdvance;
+		tGlyph.fLineHeight = rBitmap.fLineHeight;
+		tGlyph.uLastUsed   = m_uWorkerFrame;
+
+		// Nothing to draw, only to advance by
+		if (rarrField.empty())
+		{
+			m_mapWorkerGlyphs[uCodePoint] = tGlyph;
+			return true;
+		}
+
+		const std::uint32_t uFieldWidth(rBitmap.uWidth + ms_uSpread * 2);
+		const std::uint32_t uFieldHeight(rBitmap.uHeight + ms_uSpread * 2);
+
+		// A texel apart, so filtering never reads a neighbour
+		std::uint32_t uX(0), uY(0);
+		if (!m_tPacker.Insert(uFieldWidth + 1, uFieldHeight + 1, uX, uY) &&
+			!Repack(uFieldWidth + 1, uFieldHeight + 1, uX, uY))
+		{
+			return false;
+		}
+
+		tGlyph.fOffsetX = rBitmap.fBearingX - ms_uSpread;
+		tGlyph.fOffsetY = rBitmap.fBearingY - ms_uSpread;
+		tGlyph.fSizeX   = static_cast<float>(uFieldWidth);
+		tGlyph.fSizeY   = static_cast<float>(uFieldHeight);
+		tGlyph.uWidth   = static_cast<std::uint16_t>(uFieldWidth);
+		tGlyph.uHeight  = static_cast<std::uint16_t>(uFieldHeight);
+		SetTexels(tGlyph, uX, uY);
+
+		for (std::uint32_t uRow(0); uRow < uFieldHeight; ++uRow)
+		{
+			std::memcpy(&m_arrWorkerImage[(uY + uRow) * m_uWidth + uX],
+						&rarrField[uRow * uFieldWidth], uFieldWidth);
+		}
+
+		m_mapWorkerGlyphs[uCodePoint] = tGlyph;
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEGlyphAtlas::Repack(std::uint32_t uWidth, std::uint32_t uHeight,
+							   std::uint32_t &ruX, std::uint32_t &ruY)
+	{
+		IOESkylinePacker tPacker;
+		tPacker.Reset(m_uWidth, m_uHeight);
+		if (!tPacker.Insert(uWidth, uHeight, ruX, ruY))
+		{
+			return false;
+		}
+
+		// Most recently used first, so the glyphs left without room are
+		// the least recently used
+		std::vector<std::pair<std::uint32_t, IOEAtlasGlyph> > arrGlyphs(
+			m_mapWorkerGlyphs.begin(), m_mapWorkerGlyphs.end());
+		std::sort(arrGlyphs.begin(), arrGlyphs.end(),
+				  [](const std::pair<std::uint32_t, IOEAtlasGlyph> &rLHS,
+					 const std::pair<std::uint32_t, IOEAtlasGlyph> &rRHS) {
+					  return rLHS.second.uLastUsed > rRHS.second.uLastUsed;
+				  });
+
+		std::vector<std::uint8_t> arrImage(m_uWidth * m_uHeight, 0);
+		GlyphMap mapGlyphs;
+		for (auto &rPair : arrGlyphs)
+		{
+			IOEAtlasGlyph &rGlyph(rPair.second);
+			if (rGlyph.uWidth == 0)
+			{
+				mapGlyphs.insert(rPair);
+				continue;
+			}
+
+			std::uint32_t uX(0), uY(0);
+			if (!tPacker.Insert(rGlyph.uWidth + 1u, rGlyph.uHeight + 1u, uX,
+								uY))
+			{
+				++m_uNumEvictions;
+				continue;
+			}
+
+			for (std::uint32_t uRow(0); uRow < rGlyph.uHeight; ++uRow)
+			{
+				const std::uint32_t uOldRow(rGlyph.uY + uRow);
+				std::memcpy(&arrImage[(uY + uRow) * m_uWidth + uX],
+							&m_arrWorkerImage[uOldRow * m_uWidth + rGlyph.uX],
+							rGlyph.uWidth);
+			}
+			SetTexels(rGlyph, uX, uY);
+			mapGlyphs.insert(rPair);
+		}
+
+		m_mapWorkerGlyphs.swap(mapGlyphs);
+		m_arrWorkerImage.swap(arrImage);
+		m_tPacker = tPacker;
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEGlyphAtlas::SetTexels(IOEAtlasGlyph &rGlyph, std::uint32_t uX,
+								  std::uint32_t uY) const
+	{
+		rGlyph.uX	   = static_cast<std::uint16_t>(uX);
+		rGlyph.uY	   = static_cast<std::uint16_t>(uY);
+		rGlyph.fTexMinX = uX / static_cast<float>(m_uWidth);
+		rGlyph.fTexMinY = uY / static_cast<float>(m_uHeight);
+		rGlyph.fTexMaxX = (uX + rGlyph.uWidth) / static_cast<float>(m_uWidth);
+		rGlyph.fTexMaxY =
+			(uY + rGlyph.uHeight) / static_cast<float>(m_uHeight);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,246 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <IOE/IOECore/IOEPortable.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Next code point of a UTF-8 string, advancing ruIdx past it. Each
+	// malformed sequence, overlong form or surrogate decodes to U+FFFD.
+	std::uint32_t DecodeUTF8(const std::string &szData, size_t &ruIdx);
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Coverage of one glyph as a platform rasterised it. Positions are in
+	// pixels with y up, the bearing placing the bottom left of the bitmap
+	// from the pen at the bottom of the line.
+	struct IOEGlyphBitmap
+	{
+		IOEGlyphBitmap();
+
+		std::uint32_t uWidth, uHeight;
+		float fAdvance;
+		float fBearingX, fBearingY;
+		float fLineHeight;
+
+		// Rows from the top, 0 outside the glyph to 255 inside
+		std::vector<std::uint8_t> arrCoverage;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	interface_class IOEGlyphRasteriser
+	{
+	public:
+		virtual ~IOEGlyphRasteriser()
+		{
+		}
+
+		// Called from the atlas's worker thread only, with the height of
+		// the font's em in pixels. Returns false for code points the font
+		// has no glyph for.
+		virtual bool RasteriseGlyph(std::uint32_t uCodePoint,
+									std::uint32_t uPixelHeight,
+									IOEGlyphBitmap &rBitmap) = 0;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Packs rectangles bottom left first under a skyline, the top edge of
+	// everything placed so far. Space under the skyline is never handed out
+	// again, so the packer is reset rather than freed from.
+	class IOESkylinePacker
+	{
+	public:
+		IOESkylinePacker();
+
+		void Reset(std::uint32_t uWidth, std::uint32_t uHeight);
+
+		bool Insert(std::uint32_t uWidth, std::uint32_t uHeight,
+					std::uint32_t &ruX, std::uint32_t &ruY);
+
+		FORCEINLINE std::uint32_t GetUsedArea() const
+		{
+			return m_uUsedArea;
+		}
+
+	private:
+		struct Segment
+		{
+			std::uint32_t uX, uY;
+			std::uint32_t uWidth;
+		};
+
+	private:
+		// Lowest y a rectangle starting at segment uIdx can sit at
+		bool Fit(size_t uIdx, std::uint32_t uWidth, std::uint32_t uHeight,
+				 std::uint32_t &ruY) const;
+
+	private:
+		std::vector<Segment> m_arrSkyline;
+		std::uint32_t m_uWidth, m_uHeight;
+		std::uint32_t m_uUsedArea;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// A glyph in the atlas. Sizes are in pixels of an em of
+	// IOEGlyphAtlas::ms_uGlyphHeight, and the quad includes the border of
+	// the distance field. Glyphs with nothing to draw have no texels.
+	struct IOEAtlasGlyph
+	{
+		float fAdvance;
+		float fOffsetX, fOffsetY;
+		float fSizeX, fSizeY;
+		float fLineHeight;
+		float fTexMinX, fTexMinY;
+		float fTexMaxX, fTexMaxY;
+
+		std::uint16_t uX, uY;
+		std::uint16_t uWidth, uHeight;
+
+		// Frame the glyph was last looked up on
+		std::uint32_t uLastUsed;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Signed distance fields of glyphs for any code point, rasterised on
+	// demand at one size and scaled to any other. Rasterising and packing
+	// happen on a thread of the atlas's own rather than a task, so neither
+	// can ever be run by a render thread waiting on other work. Glyphs the
+	// worker finishes are published at the next Update. When the atlas is
+	// full it is packed again from the most recently used glyphs, and those
+	// that no longer fit are evicted.
+	//
+	// Apart from the worker, only use it from the render thread.
+	class IOEGlyphAtlas
+	{
+	public:
+		static const std::uint32_t ms_uGlyphHeight = 32;
+
+		// Texels either side of an edge the distance field spans
+		static const std::uint32_t ms_uSpread = 4;
+
+	public:
+		IOEGlyphAtlas(std::unique_ptr<IOEGlyphRasteriser> pRasteriser,
+					  std::uint32_t uWidth = 1024,
+					  std::uint32_t uHeight = 1024);
+		~IOEGlyphAtlas();
+
+		// nullptr until the glyph has been rasterised, the first miss
+		// queueing it for the worker
+		const IOEAtlasGlyph *FindGlyph(std::uint32_t uCodePoint);
+
+		// Once a frame. Takes the glyphs finished since, and returns true
+		// when the image changed.
+		bool Update(std::uint32_t uFrame);
+
+		// Waits for every queued glyph, which the next Update publishes
+		void Flush();
+
+	public:
+		FORCEINLINE std::uint32_t GetWidth() const
+		{
+			return m_uWidth;
+		}
+		FORCEINLINE std::uint32_t GetHeight() const
+		{
+			return m_uHeight;
+		}
+
+		// One byte a texel, rows from the top
+		FORCEINLINE const std::vector<std::uint8_t> &GetImage() const
+		{
+			return m_arrImage;
+		}
+
+		// Changes whenever a glyph is added, moved or evicted, so anything
+		// laid out from an older generation must be laid out again
+		FORCEINLINE std::uint32_t GetGeneration() const
+		{
+			return m_uGeneration;
+		}
+
+		FORCEINLINE std::uint32_t GetNumGlyphs() const
+		{
+			return static_cast<std::uint32_t>(m_mapGlyphs.size());
+		}
+		std::uint32_t GetNumEvictions();
+
+	private:
+		typedef std::unordered_map<std::uint32_t, IOEAtlasGlyph> GlyphMap;
+
+	private:
+		// Worker thread only
+		void ProcessRequests();
+
+		// With m_tLock held
+		bool PlaceGlyph(std::uint32_t uCodePoint,
+						const IOEGlyphBitmap &rBitmap,
+						const std::vector<std::uint8_t> &rarrField);
+		bool Repack(std::uint32_t uWidth, std::uint32_t uHeight,
+					std::uint32_t &ruX, std::uint32_t &ruY);
+		void SetTexels(IOEAtlasGlyph &rGlyph, std::uint32_t uX,
+					   std::uint32_t uY) const;
+
+	private:
+		std::unique_ptr<IOEGlyphRasteriser> m_pRasteriser;
+		std::uint32_t m_uWidth, m_uHeight;
+
+		// The render thread's copy, replaced as the worker publishes
+		GlyphMap m_mapGlyphs;
+		std::unordered_set<std::uint32_t> m_setQueued;
+		std::unordered_set<std::uint32_t> m_setMissing;
+		std::vector<std::uint8_t> m_arrImage;
+		std::uint32_t m_uGeneration;
+		std::uint32_t m_uFrame;
+
+		// Everything below is shared with the worker
+		std::mutex m_tLock;
+
+		std::condition_variable m_tWake;
+		std::condition_variable m_tIdle;
+		std::deque<std::uint32_t> m_arrRequests;
+		bool m_bWorking;
+		bool m_bQuit;
+
+		GlyphMap m_mapWorkerGlyphs;
+		std::vector<std::uint8_t> m_arrWorkerImage;
+		IOESkylinePacker m_tPacker;
+
+		// Requests finished since the last Update, and those of them that
+		// had no glyph or could not fit
+		std::vector<std::uint32_t> m_arrFinished;
+		std::vector<std::uint32_t> m_arrMissing;
+
+		std::uint32_t m_uWorkerGeneration;
+		std::uint32_t m_uWorkerFrame;
+		std::uint32_t m_uNumEvictions;
+
+		std::thread m_tWorker;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <cstring>
+
+#include <IOE/IOEMaths/Matrix.h>
+#include <IOE/IOERenderer/IOEModel.h>
+#include <IOE/IOERenderer/IOERPI.h>
+#include <IOE/IOERenderer/IOETexture.h>
+#include <IOE/IOERenderer/IOEVisibilityBounds.h>
+
+#include "IOEInstanceBatcher.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		// Smallest instance buffer created, so early frames do not
+		// reallocate it for every few instances
+		const std::uint32_t g_uMinInstanceCapacity = 256;
+
+		void StoreMatrix(const Maths::IOEMatrix &rMatrix, float *pOut)
+		{
+			rMatrix.Get(pOut[0], pOut[1], pOut[2], pOut[3], pOut[4], pOut[5],
+						pOut[6], pOut[7], pOut[8], pOut[9], pOut[10],
+						pOut[11], pOut[12], pOut[13], pOut[14], pOut[15]);
+		}
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEInstanceBatcher::IOEInstanceBatcher()
+		: m_uInstanceCapacity(0)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEInstanceBatcher::Build(const IOEVisibilityBounds &rBounds)
+	{
+		m_arrBatches.clear();
+		m_arrInstances.clear();
+		m_tStats = IOEInstancingStats();
+
+		for (std::uint32_t uModel(0); uModel < rBounds.GetNumModels();
+			 ++uModel)
+		{
+			const IOEVisibleModel &rVisible(rBounds.GetModel(uModel));
+			const IOEModel &rModel(*rVisible.pModel);
+			const std::uint32_t *pSubsets(rBounds.GetVisibleSubsets() +
+										  rVisible.uFirst);
+
+			m_arrEntries.resize(rVisible.uCount);
+			for (std::uint32_t uIdx(0); uIdx < rVisible.uCount; ++uIdx)
+			{
+				const std::int32_t nSubset(
+					static_cast<std::int32_t>(pSubsets[uIdx]));
+				m_arrEntries[uIdx].uShape  = rModel.GetSubsetShape(nSubset);
+				m_arrEntries[uIdx].uSubset = pSubsets[uIdx];
+			}
+			std::sort(m_arrEntries.begin(), m_arrEntries.end());
+
+			for (const SortEntry &rEntry : m_arrEntries)
+			{
+				if (m_arrBatches.empty() ||
+					m_arrBatches.back().pModel != rVisible.pModel ||
+					m_arrBatches.back().uSubset != rEntry.uShape)
+				{
+					IOEInstanceBatch tBatch;
+					tBatch.pModel		  = rVisible.pModel;
+					tBatch.uSubset		  = rEntry.uShape;
+					tBatch.uFirstInstance =
+						static_cast<std::uint32_t>(m_arrInstances.size());
+					tBatch.uNumInstances = 0;
+					m_arrBatches.push_back(tBatch);
+				}
+
+				AddInstance(rModel, rEntry.uSubset);
+				++m_arrBatches.back().uNumInstances;
+			}
+
+			m_tStats.uDrawsBefore += rVisible.uCount;
+		}
+
+		m_tStats.uDrawsAfter = static_cast<std::uint32_t>(m_arrBatches.size());
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEInstanceBatcher::AddInstance(const IOEModel &rModel,
+										 std::uint32_t uSubset)
+	{
+		const float *pOffset(
+			rModel.GetSubsetShapeOffset(static_cast<std::int32_t>(uSubset)));
+		const Maths::IOEMatrix mWorld(Maths::IOEMatrix::Translation(
+			Maths::IOEVector(pOffset[0], pOffset[1], pOffset[2])));
+
+		Maths::IOEMatrix mInvXPose(mWorld.Inverse());
+		mInvXPose.TransposeSet();
+
+		m_arrInstances.emplace_back();
+		IOEInstanceData &rInstance(m_arrInstances.back());
+		StoreMatrix(mWorld, rInstance.arrWorld);
+		StoreMatrix(mInvXPose, rInstance.arrWorldInvTranspose);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEInstanceBatcher::Execute(IOERPI *pRPI,
+									 bool bSetShaderParams /*=true*/)
+	{
+		if (m_arrBatches.empty())
+		{
+			return;
+		}
+
+		const std::uint32_t uNumInstances(GetNumInstances());
+		ReserveInstanceBuffer(uNumInstances);
+
+		void *pData(nullptr);
+		if (!m_pInstanceBuffer->MapBuffer(EBufferMapType::WriteDiscard, pData))
+		{
+			return;
+		}
+		std::memcpy(pData, m_arrInstances.data(),
+					uNumInstances * sizeof(IOEInstanceData));
+		m_pInstanceBuffer->UnmapBuffer();
+
+		// Batches of one model are contiguous, so its material is set once
+		IOEModel *pCurrent(nullptr);
+		for (const IOEInstanceBatch &rBatch : m_arrBatches)
+		{
+			if (rBatch.pModel != pCurrent)
+			{
+				if (pCurrent != nullptr)
+				{
+					pCurrent->EndInstanced(pRPI);
+				}
+				pCurrent = rBatch.pModel;
+				pCurrent->BeginInstanced(pRPI, m_pInstanceBuffer.get(),
+										 bSetShaderParams);
+			}
+
+			pCurrent->OnRenderInstanced(pRPI, rBatch.uSubset,
+										rBatch.uFirstInstance,
+										rBatch.uNumInstances);
+		}
+		pCurrent->EndInstanced(pRPI);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEInstanceBatcher::ReserveInstanceBuffer(std::uint32_t uNumInstances)
+	{
+		if (m_pInstanceBuffer != nullptr &&
+			uNumInstances <= m_uInstanceCapacity)
+		{
+			return;
+		}
+
+		m_uInstanceCapacity = std::max<std::uint32_t>(
+			std::max<std::uint32_t>(uNumInstances, m_uInstanceCapacity * 2),
+			g_uMinInstanceCapacity);
+
+		m_pInstanceBuffer = std::make_shared<IOETexture>(
+			ETextureFormat::Unknown,
+			static_cast<float>(sizeof(IOEInstanceData)),
+			static_cast<std::int32_t>(m_uInstanceCapacity));
+		m_pInstanceBuffer->SetDebugName("Instances");
+		m_pInstanceBuffer->SetBufferAccess(ECPUAccess::GPUReadCPUWrite);
+		m_pInstanceBuffer->SetBufferDescription(
+			EBufferDescription::ShaderResource);
+		m_pInstanceBuffer->SetTextureType(ETextureType::GenericBuffer);
+		m_pInstanceBuffer->Setup();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,141 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <IOE/IOECore/IOEDefines.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class IOEModel;
+	class IOERPI;
+	class IOETexture;
+	class IOEVisibilityBounds;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Model space placement of one instance, laid out as the Instances
+	// buffer of Default.vs.hlsl. Matrices are stored as the material system
+	// writes them to constant buffers.
+	struct IOEInstanceData
+	{
+		float arrWorld[16];
+		float arrWorldInvTranspose[16];
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Copies of one subset drawn with a single call, placed by the instances
+	// from uFirstInstance of the frame's instance buffer
+	struct IOEInstanceBatch
+	{
+		IOEModel *pModel;
+		std::uint32_t uSubset;
+		std::uint32_t uFirstInstance;
+		std::uint32_t uNumInstances;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Draw calls needed by the last Build with one draw per visible subset
+	// and with instancing
+	struct IOEInstancingStats
+	{
+		IOEInstancingStats()
+			: uDrawsBefore(0)
+			, uDrawsAfter(0)
+		{
+		}
+
+		std::uint32_t uDrawsBefore;
+		std::uint32_t uDrawsAfter;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Merges visible subsets that repeat the same geometry into instanced
+	// draws. Every subset of a model shares its vertex format and buffers,
+	// so draws are grouped by model and by subset shape, which already
+	// requires the same textures and index pattern. The transforms of every
+	// instance are packed into one structured buffer uploaded once a frame.
+	class IOEInstanceBatcher
+	{
+	public:
+		IOEInstanceBatcher();
+
+	public:
+		// Groups the visible subsets of rBounds. Instances are placed in
+		// model space, so the view only matters to the culling.
+		void Build(const IOEVisibilityBounds &rBounds);
+
+		// Uploads the instances and issues one draw per batch
+		void Execute(IOERPI *pRPI, bool bSetShaderParams = true);
+
+		FORCEINLINE std::uint32_t GetNumBatches() const
+		{
+			return static_cast<std::uint32_t>(m_arrBatches.size());
+		}
+		FORCEINLINE const IOEInstanceBatch &GetBatch(std::uint32_t uIdx) const
+		{
+			return m_arrBatches[uIdx];
+		}
+
+		FORCEINLINE std::uint32_t GetNumInstances() const
+		{
+			return static_cast<std::uint32_t>(m_arrInstances.size());
+		}
+		FORCEINLINE const IOEInstanceData &GetInstance(std::uint32_t uIdx) const
+		{
+			return m_arrInstances[uIdx];
+		}
+
+		FORCEINLINE const IOEInstancingStats &GetStats() const
+		{
+			return m_tStats;
+		}
+
+	private:
+		// A visible subset keyed by its shape, so that sorting brings the
+		// copies of each shape together
+		struct SortEntry
+		{
+			bool operator<(const SortEntry &rhs) const
+			{
+				return uShape != rhs.uShape ? uShape < rhs.uShape
+											: uSubset < rhs.uSubset;
+			}
+
+			std::uint32_t uShape;
+			std::uint32_t uSubset;
+		};
+
+	private:
+		void AddInstance(const IOEModel &rModel, std::uint32_t uSubset);
+		void ReserveInstanceBuffer(std::uint32_t uNumInstances);
+
+	private:
+		std::vector<SortEntry> m_arrEntries;
+		std::vector<IOEInstanceBatch> m_arrBatches;
+		std::vector<IOEInstanceData> m_arrInstances;
+
+		// Grows to the largest frame seen so far
+		std::shared_ptr<IOETexture> m_pInstanceBuffer;
+		std::uint32_t m_uInstanceCapacity;
+
+		IOEInstancingStats m_tStats;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -1,5 +1,6 @@
 #include "IOEMaterial.h"
 
+#include <cstring>
 #include <fstream>
 #include <locale>
 #include <codecvt>
@@ -27,20 +28,102 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	namespace
+	{
+		// Permutation masks are 64 bits wide
+		const std::uint32_t g_uMaxPermutationBits(64);
+
+		std::vector<std::string> SplitValues(const char *szValues)
+		{
+			std::vector<std::string> arrValues;
+			std::string szValue;
+			for (const char *pChar(szValues);; ++pChar)
+			{
+				if (*pChar == ',' || *pChar == '\0')
+				{
+					if (!szValue.empty())
+					{
+						arrValues.push_back(szValue);
+					}
+					szValue.clear();
+					if (*pChar == '\0')
+					{
+						break;
+					}
+				}
+				else if (*pChar != ' ')
+				{
+					szValue += *pChar;
+				}
+			}
+			return arrValues;
+		}
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
 	IOEMaterial::IOEMaterial()
+		: m_mGlobalSettingsWorld(IOE::Maths::g_mIdentity)
+		, m_uGlobalSettingsView(0)
+		, m_bGlobalSettingsValid(false)
+		, m_bHasGlobalSettings(false)
+		, m_uFirstInstance(0)
+		, m_uNumInstances(0)
+		, m_bInstanceSettingsValid(false)
+		, m_bComputeOnly(false)
 	{
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
 	IOEMaterial::IOEMaterial(const std::wstring &szPath)
+		: IOEMaterial()
 	{
 		LoadMaterial(szPath);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
+	template <class... TArgs>
+	void IOEMaterial::WriteShaderParameter(
+		const IOEShaderParameterHandle &rHandle, std::size_t uSize,
+		TArgs &&... tArgs)
+	{
+		for (std::uint32_t uIdx(0); uIdx < rHandle.uNumBindings; ++uIdx)
+		{
+			const IOEShaderParameterHandle::Binding &rBinding(
+				rHandle.arrBindings[uIdx]);
+			IOEShader *pShader(m_arrShaders[rBinding.uShader].get());
+			pShader->SetShaderVariableValue(
+				pShader->WriteCBuffer(rBinding.uBuffer, rBinding.uOffset,
+									  static_cast<std::uint32_t>(uSize)),
+				tArgs...);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 	void IOEMaterial::LoadMaterial(const std::wstring &szPath)
+	{
+		std::vector<IOEShaderCompilationOptions> arrOptions;
+		ParseMaterial(szPath, arrOptions);
+		CompileShaders(arrOptions);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMaterial::LoadMaterial(rapidxml::xml_node<char> *pNode)
+	{
+		std::vector<IOEShaderCompilationOptions> arrOptions;
+		ParseMaterial(pNode, arrOptions);
+		CompileShaders(arrOptions);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMaterial::ParseMaterial(
+		const std::wstring &szPath,
+		std::vector<IOEShaderCompilationOptions> &arrOptions)
 	{
 		std::ifstream fStream(szPath, std::ios::in);
 		if (fStream.is_open())
@@ -97,7 +180,7 @@ namespace Renderer
 				if (_strnicmp(pChild->name(), "material",
 							  pChild->name_size()) == 0)
 				{
-					LoadMaterial(pChild);
+					ParseMaterial(pChild, arrOptions);
 				}
 			}
 
@@ -113,7 +196,9 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOEMaterial::LoadMaterial(rapidxml::xml_node<char> *pNode)
+	void IOEMaterial::ParseMaterial(
+		rapidxml::xml_node<char> *pNode,
+		std::vector<IOEShaderCompilationOptions> &arrOptions)
 	{
 		IOE_ASSERT(_strnicmp(pNode->name(), "material", pNode->name_size()) ==
 					   0,
@@ -148,6 +233,49 @@ namespace Renderer
 				m_arrDefinitions.emplace_back(pNameNode->value(),
 											  pValueNode->value());
 			}
+			else if (_strnicmp(pChild->name(), "permutation",
+							   pChild->name_size()) == 0)
+			{
+				auto *pNameNode(pChild->first_attribute("name", 4, false));
+				if (pNameNode == nullptr)
+				{
+					THROW_IOE_RENDERER_EXCEPTION(
+						"Name in permutation element has not been assigned",
+						E_ERROR_FAILED_TO_READ_MATERIAL);
+				}
+
+				// Without values the axis is a boolean defined as 1
+				IOEPermutationAxis tAxis;
+				tAxis.szName = pNameNode->value();
+				auto *pValuesNode(pChild->first_attribute("values", 6, false));
+				tAxis.arrValues = pValuesNode != nullptr
+									  ? SplitValues(pValuesNode->value())
+									  : std::vector<std::string>(1, "1");
+				if (tAxis.arrValues.empty())
+				{
+					THROW_IOE_RENDERER_EXCEPTION_VARGS(
+						"Permutation '%s' has no values",
+						E_ERROR_FAILED_TO_READ_MATERIAL, tAxis.szName.c_str());
+				}
+
+				tAxis.uShift = m_arrPermutationAxes.empty()
+								   ? 0
+								   : m_arrPermutationAxes.back().uShift +
+										 m_arrPermutationAxes.back().uNumBits;
+				tAxis.uNumBits = 1;
+				while ((1ULL << tAxis.uNumBits) < tAxis.arrValues.size() + 1)
+				{
+					++tAxis.uNumBits;
+				}
+				if (tAxis.uShift + tAxis.uNumBits > g_uMaxPermutationBits)
+				{
+					THROW_IOE_RENDERER_EXCEPTION_VARGS(
+						"Permutation '%s' does not fit in %u bits",
+						E_ERROR_FAILED_TO_READ_MATERIAL, tAxis.szName.c_str(),
+						g_uMaxPermutationBits);
+				}
+				m_arrPermutationAxes.push_back(tAxis);
+			}
 			else if (_strnicmp(pChild->name(), "shader",
 							   pChild->name_size()) == 0)
 			{
@@ -237,9 +365,7 @@ namespace Renderer
 								->GetVertexFormatShared("Default");
 					}
 
-					auto pShader(std::make_shared<IOEShader>());
-					pShader->Compile(tOptions);
-					m_arrShaders.push_back(pShader);
+					arrOptions.push_back(tOptions);
 				}
 			}
 		}
@@ -247,6 +373,84 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	void IOEMaterial::CompileShaders(
+		const std::vector<IOEShaderCompilationOptions> &arrOptions)
+	{
+		std::vector<std::shared_ptr<IOEShader> > arrShaders;
+		for (const IOEShaderCompilationOptions &rOptions : arrOptions)
+		{
+			auto pShader(std::make_shared<IOEShader>());
+			pShader->Compile(rOptions);
+			arrShaders.push_back(pShader);
+		}
+		AddShaders(arrShaders);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMaterial::PrepareVariant(
+		const IOEMaterial &rTemplate, std::uint64_t uPermutation,
+		const std::vector<IOEShaderCompilationOptions> &arrTemplateOptions,
+		std::vector<IOEShaderCompilationOptions> &arrOptions)
+	{
+		m_szMaterialName	 = rTemplate.m_szMaterialName;
+		m_arrDefinitions	 = rTemplate.m_arrDefinitions;
+		m_arrPermutationAxes = rTemplate.m_arrPermutationAxes;
+
+		for (const IOEPermutationAxis &rAxis : m_arrPermutationAxes)
+		{
+			const std::uint32_t uState(rAxis.GetState(uPermutation));
+			if (uState > rAxis.arrValues.size())
+			{
+				THROW_IOE_RENDERER_EXCEPTION_VARGS(
+					"Permutation '%s' has no state %u",
+					E_ERROR_FAILED_TO_READ_MATERIAL, rAxis.szName.c_str(),
+					uState);
+			}
+			if (uState > 0)
+			{
+				AddDefinition(rAxis.szName, rAxis.arrValues[uState - 1]);
+			}
+		}
+
+		arrOptions = arrTemplateOptions;
+		for (IOEShaderCompilationOptions &rOptions : arrOptions)
+		{
+			rOptions.pMacros = &m_arrDefinitions;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMaterial::AddShaders(
+		const std::vector<std::shared_ptr<IOEShader> > &arrShaders)
+	{
+		m_arrShaders.insert(m_arrShaders.end(), arrShaders.begin(),
+							arrShaders.end());
+
+		m_bHasGlobalSettings = false;
+		m_bComputeOnly		 = !m_arrShaders.empty();
+		for (auto pShader : m_arrShaders)
+		{
+			if (pShader->FindConstantBuffer("GlobalSettings") != nullptr)
+			{
+				m_bHasGlobalSettings = true;
+			}
+			if (pShader->GetShaderType() != EShaderType::Compute)
+			{
+				m_bComputeOnly = false;
+			}
+		}
+
+		m_tFirstInstance =
+			GetShaderParameter("InstanceSettings", "FirstInstance");
+		m_tNumInstances =
+			GetShaderParameter("InstanceSettings", "NumInstances");
+		m_bInstanceSettingsValid = false;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 	void IOEMaterial::SetShaderVariableValue(const char *szGlobalVariable,
 											 EShaderVariableType eType,
 											 float fU)
@@ -260,7 +464,8 @@ namespace Renderer
 											 const char *szVariableName,
 											 float fU)
 	{
-		SetCBufferVariableValue(szConstantBuffer, szVariableName, fU);
+		SetShaderParameter(
+			GetShaderParameter(szConstantBuffer, szVariableName), fU);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -278,7 +483,8 @@ namespace Renderer
 											 const char *szVariableName,
 											 std::int32_t nValue)
 	{
-		SetCBufferVariableValue(szConstantBuffer, szVariableName, nValue);
+		SetShaderParameter(
+			GetShaderParameter(szConstantBuffer, szVariableName), nValue);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -296,7 +502,8 @@ namespace Renderer
 											 const char *szVariableName,
 											 std::uint32_t nValue)
 	{
-		SetCBufferVariableValue(szConstantBuffer, szVariableName, nValue);
+		SetShaderParameter(
+			GetShaderParameter(szConstantBuffer, szVariableName), nValue);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -314,7 +521,8 @@ namespace Renderer
 											 const char *szVariableName,
 											 float fU, float fV)
 	{
-		SetCBufferVariableValue(szConstantBuffer, szVariableName, fU, fV);
+		SetShaderParameter(
+			GetShaderParameter(szConstantBuffer, szVariableName), fU, fV);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -332,7 +540,8 @@ namespace Renderer
 											 const char *szVariableName,
 											 float fX, float fY, float fZ)
 	{
-		SetCBufferVariableValue(szConstantBuffer, szVariableName, fX, fY, fZ);
+		SetShaderParameter(
+			GetShaderParameter(szConstantBuffer, szVariableName), fX, fY, fZ);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -352,8 +561,9 @@ namespace Renderer
 											 float fX, float fY, float fZ,
 											 float fW)
 	{
-		SetCBufferVariableValue(szConstantBuffer, szVariableName, fX, fY, fZ,
-								fW);
+		SetShaderParameter(
+			GetShaderParameter(szConstantBuffer, szVariableName), fX, fY, fZ,
+			fW);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -373,7 +583,8 @@ namespace Renderer
 										const char *szVariableName,
 										const IOE::Maths::IOEVector &rvVector)
 	{
-		SetCBufferVariableValue(szConstantBuffer, szVariableName, rvVector);
+		SetShaderParameter(
+			GetShaderParameter(szConstantBuffer, szVariableName), rvVector);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -392,66 +603,282 @@ namespace Renderer
 	IOEMaterial::SetShaderVariableValue(const char *szConstantBuffer,
 										const char *szVariableName,
 										const IOE::Maths::IOEMatrix &rmMatrix)
+	{
+		SetShaderParameter(
+			GetShaderParameter(szConstantBuffer, szVariableName), rmMatrix);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEShaderParameterHandle
+	IOEMaterial::GetShaderParameter(const char *szConstantBuffer,
+									const char *szVariableName)
+	{
+		IOEShaderParameterHandle tHandle;
+		for (std::size_t uShader(0);
+			 uShader < m_arrShaders.size() &&
+			 tHandle.uNumBindings < tHandle.arrBindings.size();
+			 ++uShader)
+		{
+			IOEShader *pShader(m_arrShaders[uShader].get());
+			ShaderConstantBufferDescription *pCBufferDescription(
+				pShader->FindConstantBuffer(szConstantBuffer));
+			if (pCBufferDescription == nullptr)
+			{
+				continue;
+			}
+			ShaderVariableDescription *pVariableDescription(
+				pShader->FindConstantBufferVariable(pCBufferDescription,
+													szVariableName));
+			if (pVariableDescription != nullptr)
+			{
+				IOE_ASSERT(pVariableDescription->nSlot >= 0 &&
+							   pVariableDescription->nSlot <= 0xFFFF,
+						   "Variable offset does not fit a handle");
+				IOEShaderParameterHandle::Binding &rBinding(
+					tHandle.arrBindings[tHandle.uNumBindings++]);
+				rBinding.uOffset =
+					static_cast<std::uint16_t>(pVariableDescription->nSlot);
+				rBinding.uShader = static_cast<std::uint8_t>(uShader);
+				rBinding.uBuffer =
+					static_cast<std::uint8_t>(pCBufferDescription->nSlotIdx);
+			}
+		}
+		return tHandle;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void
+	IOEMaterial::SetShaderParameter(const IOEShaderParameterHandle &rHandle,
+									float fU)
+	{
+		WriteShaderParameter(rHandle, sizeof(float), fU);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void
+	IOEMaterial::SetShaderParameter(const IOEShaderParameterHandle &rHandle,
+									std::int32_t nValue)
+	{
+		WriteShaderParameter(rHandle, sizeof(std::int32_t), nValue);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void
+	IOEMaterial::SetShaderParameter(const IOEShaderParameterHandle &rHandle,
+									std::uint32_t nValue)
+	{
+		WriteShaderParameter(rHandle, sizeof(std::uint32_t), nValue);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void
+	IOEMaterial::SetShaderParameter(const IOEShaderParameterHandle &rHandle,
+									float fU, float fV)
+	{
+		WriteShaderParameter(rHandle, sizeof(float) * 2, fU, fV);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void
+	IOEMaterial::SetShaderParameter(const IOEShaderParameterHandle &rHandle,
+									float fX, float fY, float fZ)
+	{
+		WriteShaderParameter(rHandle, sizeof(float) * 3, fX, fY, fZ);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void
+	IOEMaterial::SetShaderParameter(const IOEShaderParameterHandle &rHandle,
+									float fX, float fY, float fZ, float fW)
+	{
+		WriteShaderParameter(rHandle, sizeof(float) * 4, fX, fY, fZ, fW);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void
+	IOEMaterial::SetShaderParameter(const IOEShaderParameterHandle &rHandle,
+									const IOE::Maths::IOEVector &rvVector)
+	{
+		WriteShaderParameter(rHandle, sizeof(float) * 4, rvVector);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void
+	IOEMaterial::SetShaderParameter(const IOEShaderParameterHandle &rHandle,
+									const IOE::Maths::IOEMatrix &rmMatrix)
 	{
 		// WHY TRANSPOSED!!!!!!! 5 hours debugging this shit to find out HLSL
 		// accepts matrix differently to directx math... Go figure...
-		SetCBufferVariableValue(szConstantBuffer, szVariableName,
-								rmMatrix.Transpose());
+		WriteShaderParameter(rHandle, sizeof(float) * 16,
+							 rmMatrix.Transpose());
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMaterial::CommitShaderParameters(IOERPI *pRPI)
+	{
+		for (auto &rShader : m_arrShaders)
+		{
+			rShader->CommitCBuffers(pRPI);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMaterial::Set(IOE::Renderer::IOERPI *pRPI,
+						  bool bSetShaderParams /*=true*/)
+	{
+		Set(pRPI, IOE::Maths::g_mIdentity, bSetShaderParams);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
 	void IOEMaterial::Set(IOE::Renderer::IOERPI *pRPI,
+						  const IOE::Maths::IOEMatrix &rWorld,
 						  bool bSetShaderParams /*=true*/)
 	{
-		pRPI->ResetState();
-		if (bSetShaderParams /*&& pRPI->GetMaterialIndex() != GetResourceIndex()*/)
+		if (bSetShaderParams)
+		{
+			IOEEngineConstants &rConstants(pRPI->GetEngineConstants());
+			rConstants.SetView(pRPI, pRPI->GetCamera(), pRPI->GetViewport(0));
+			rConstants.SetObject(pRPI, rWorld);
+
+			if (m_bHasGlobalSettings)
+			{
+				SetGlobalSettings(pRPI, rWorld);
+			}
+			SetInstancing(0, 0);
+		}
+
+		// Shaders, and the buffers they own, stay bound until another
+		// material replaces them
+		if (pRPI->GetMaterialIndex() != GetResourceIndex())
 		{
-			const IOE::Maths::IOECamera &rCamera(pRPI->GetCamera());
-			IOE::Maths::IOEMatrix mWorld(IOE::Maths::g_mIdentity);
-
-			IOE::Maths::IOEMatrix wvp(mWorld * rCamera.GetViewMatrix() *
-									  rCamera.GetProjectionMatrix());
-
-			IOE::Maths::IOEMatrix mInvXPose(mWorld.Inverse());
-			mInvXPose.TransposeSet();
-
-			const IOEViewport &rViewport(pRPI->GetViewport(0));
-			MapCBuffer("GlobalSettings");
-			SetShaderVariableValue("GlobalSettings", "View",
-								   rCamera.GetTransform().GetTranslation());
-			SetShaderVariableValue("GlobalSettings", "WorldViewProj", wvp);
-			SetShaderVariableValue("GlobalSettings", "WorldInvTranspose",
-								   mInvXPose);
-			SetShaderVariableValue("GlobalSettings", "ViewportSize",
-								   rViewport.GetWidth(),
-								   rViewport.GetHeight());
-			UnmapCBuffer("GlobalSettings");
+			for (auto pShader : m_arrShaders)
+			{
+				pShader->Set(pRPI);
+			}
+
+			// Compute only materials leave the draw pipeline as it is
+			if (!m_bComputeOnly)
+			{
+				for (std::int32_t nType(EShaderType::Vertex);
+					 nType <= EShaderType::Fragment; ++nType)
+				{
+					const EShaderType::Enum eType(
+						static_cast<EShaderType::Enum>(nType));
+					if (!HasShader(eType))
+					{
+						pRPI->UnsetShader(eType);
+					}
+				}
+			}
 
 			pRPI->SetMaterialIndex(GetResourceIndex());
+			pRPI->SetMaterialInstance(nullptr);
 		}
 
-		for (auto pShader : m_arrShaders)
+		CommitShaderParameters(pRPI);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMaterial::SetGlobalSettings(IOE::Renderer::IOERPI *pRPI,
+										const IOE::Maths::IOEMatrix &rWorld)
+	{
+		const IOEEngineConstants &rConstants(pRPI->GetEngineConstants());
+		if (m_bGlobalSettingsValid &&
+			m_uGlobalSettingsView == rConstants.GetViewGeneration() &&
+			std::memcmp(&m_mGlobalSettingsWorld, &rWorld,
+						sizeof(IOE::Maths::IOEMatrix)) == 0)
+		{
+			return;
+		}
+
+		const IOE::Maths::IOECamera &rCamera(pRPI->GetCamera());
+
+		IOE::Maths::IOEMatrix wvp(rWorld * rCamera.GetViewMatrix() *
+								  rCamera.GetProjectionMatrix());
+
+		IOE::Maths::IOEMatrix mInvXPose(rWorld.Inverse());
+		mInvXPose.TransposeSet();
+
+		const IOEViewport &rViewport(pRPI->GetViewport(0));
+		MapCBuffer("GlobalSettings");
+		SetShaderVariableValue("GlobalSettings", "View",
+							   rCamera.GetTransform().GetTranslation());
+		SetShaderVariableValue("GlobalSettings", "WorldViewProj", wvp);
+		SetShaderVariableValue("GlobalSettings", "WorldInvTranspose",
+							   mInvXPose);
+		SetShaderVariableValue("GlobalSettings", "ViewportSize",
+							   rViewport.GetWidth(), rViewport.GetHeight());
+		UnmapCBuffer("GlobalSettings");
+
+		m_mGlobalSettingsWorld = rWorld;
+		m_uGlobalSettingsView  = rConstants.GetViewGeneration();
+		m_bGlobalSettingsValid = true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMaterial::SetInstancing(std::uint32_t uFirstInstance,
+									std::uint32_t uNumInstances)
+	{
+		if (!m_tNumInstances.IsValid() ||
+			(m_bInstanceSettingsValid && m_uFirstInstance == uFirstInstance &&
+			 m_uNumInstances == uNumInstances))
 		{
-			pShader->Set(pRPI);
+			return;
 		}
+
+		// Uploaded straight away, as the draw that follows reads it
+		SetShaderParameter(m_tFirstInstance, uFirstInstance);
+		SetShaderParameter(m_tNumInstances, uNumInstances);
+		CommitShaderParameters(IOERPI::GetSingletonPtr());
+
+		m_uFirstInstance		 = uFirstInstance;
+		m_uNumInstances			 = uNumInstances;
+		m_bInstanceSettingsValid = true;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOEMaterial::MapCBuffer(const char *szConstantBufferName)
+	bool IOEMaterial::HasShader(EShaderType::Enum eShaderType) const
 	{
 		for (auto pShader : m_arrShaders)
 		{
-			ShaderConstantBufferDescription *pCBufferDescription(
-				pShader->FindConstantBuffer(szConstantBufferName));
-			if (pCBufferDescription != nullptr)
+			if (pShader->GetShaderType() == eShaderType)
 			{
-				void *pBaseAddress(pShader->MapCBuffer(
-					IOERPI::GetSingletonPtr(), 0, pCBufferDescription));
-				pCBufferDescription->pMappedAddress = pBaseAddress;
+				return true;
 			}
 		}
+		return false;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMaterial::MapCBuffer(const char *szConstantBufferName)
+	{
+		// Filled by the caller, so neither Set nor an instance can assume
+		// what the buffer holds
+		if (std::strcmp(szConstantBufferName, "GlobalSettings") == 0)
+		{
+			m_bGlobalSettingsValid = false;
+		}
+		else if (std::strcmp(szConstantBufferName, "InstanceSettings") == 0)
+		{
+			m_bInstanceSettingsValid = false;
+		}
+		IOERPI::GetSingletonPtr()->SetMaterialInstance(nullptr);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -464,9 +891,9 @@ namespace Renderer
 				pShader->FindConstantBuffer(szConstantBufferName));
 			if (pCBufferDescription != nullptr)
 			{
-				pShader->UnmapCBuffer(IOERPI::GetSingletonPtr(), 0,
-									  pCBufferDescription);
-				pCBufferDescription->pMappedAddress = nullptr;
+				pShader->CommitCBuffer(
+					IOERPI::GetSingletonPtr(),
+					static_cast<std::uint32_t>(pCBufferDescription->nSlotIdx));
 			}
 		}
 	}
@@ -475,6 +902,8 @@ namespace Renderer
 
 	bool IOEMaterial::SetTextureVariable(IOERPI *pRPI, const char *szTextureName, IOETexture *pTexture, int arrOffset /*=0*/)
 	{
+		pRPI->SetMaterialInstance(nullptr);
+
 		bool bAnySet(false);
 		for (std::shared_ptr<IOEShader> pShader : m_arrShaders)
 		{
@@ -491,6 +920,8 @@ namespace Renderer
 	bool IOEMaterial::SetSamplerVariable(const char *szSamplerName,
 										 IOESamplerState *pSampler)
 	{
+		IOERPI::GetSingletonPtr()->SetMaterialInstance(nullptr);
+
 		bool bAnySet(false);
 		for (auto pShader : m_arrShaders)
 		{
@@ -508,6 +939,8 @@ namespace Renderer
 	bool IOEMaterial::SetSamplers(
 		const vector<pair<string, IOESamplerState *> > &arrSamplers)
 	{
+		IOERPI::GetSingletonPtr()->SetMaterialInstance(nullptr);
+
 		bool bAnySet(false);
 		for (auto pShader : m_arrShaders)
 		{
@@ -540,6 +973,7 @@ namespace Renderer
 		if (m_arrShaders.size() == 1 &&
 			m_arrShaders.at(0)->GetShaderType() == EShaderType::Compute)
 		{
+			m_arrShaders.at(0)->CommitCBuffers(pRPI);
 			m_arrShaders.at(0)->Dispatch(pRPI, nNumThreadGroupsX,
 										 nNumThreadGroupsY, nNumThreadGroupsZ);
 		}
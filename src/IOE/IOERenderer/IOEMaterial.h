@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
@@ -40,6 +42,55 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	// A constant buffer variable found once in each of a material's shaders,
+	// so it can be written again without looking up its names. Only valid
+	// with the material that made it.
+	struct IOEShaderParameterHandle
+	{
+		struct Binding
+		{
+			std::uint16_t uOffset;
+			std::uint8_t uShader;
+			std::uint8_t uBuffer;
+		};
+
+		IOEShaderParameterHandle()
+			: uNumBindings(0)
+		{
+		}
+
+		FORCEINLINE bool IsValid() const
+		{
+			return uNumBindings > 0;
+		}
+
+		std::array<Binding, EShaderType::NumShaders> arrBindings;
+		std::uint32_t uNumBindings;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// A define the material can be compiled with or without, declared as
+	// <permutation name="X"/> for X=1, or with values="a,b" for X=a or
+	// X=b. State zero leaves the define out, and states 1 onwards select
+	// the values in order.
+	struct IOEPermutationAxis
+	{
+		std::string szName;
+		std::vector<std::string> arrValues;
+		// Bits of the permutation mask holding the state
+		std::uint32_t uShift;
+		std::uint32_t uNumBits;
+
+		FORCEINLINE std::uint32_t GetState(std::uint64_t uPermutation) const
+		{
+			return static_cast<std::uint32_t>(
+				(uPermutation >> uShift) & ((1ULL << uNumBits) - 1));
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
 	class IOEMaterial : public IOE::Core::IOEResourceCounter<IOEMaterial>
 	{
 	public:
@@ -100,6 +151,35 @@ namespace Renderer
 									const char *szVariableName,
 									const IOE::Maths::IOEMatrix &rmMatrix);
 
+		// Finds szVariableName in szConstantBuffer of every shader. The name
+		// setters above do this on each call, so keep the handle of anything
+		// set every frame.
+		IOEShaderParameterHandle
+		GetShaderParameter(const char *szConstantBuffer,
+						   const char *szVariableName);
+
+		// Writes into each shader's copy of the buffer. Set, Dispatch and
+		// UnmapCBuffer upload the buffers that were written.
+		void SetShaderParameter(const IOEShaderParameterHandle &rHandle,
+								float fU);
+		void SetShaderParameter(const IOEShaderParameterHandle &rHandle,
+								std::int32_t nValue);
+		void SetShaderParameter(const IOEShaderParameterHandle &rHandle,
+								std::uint32_t nValue);
+		void SetShaderParameter(const IOEShaderParameterHandle &rHandle,
+								float fU, float fV);
+		void SetShaderParameter(const IOEShaderParameterHandle &rHandle,
+								float fX, float fY, float fZ);
+		void SetShaderParameter(const IOEShaderParameterHandle &rHandle,
+								float fX, float fY, float fZ, float fW);
+		void SetShaderParameter(const IOEShaderParameterHandle &rHandle,
+								const IOE::Maths::IOEVector &rvVector);
+		void SetShaderParameter(const IOEShaderParameterHandle &rHandle,
+								const IOE::Maths::IOEMatrix &rmMatrix);
+
+		// Uploads every buffer written since its last upload
+		void CommitShaderParameters(IOERPI *pRPI);
+
 		bool SetTextureVariable(IOERPI *pRPI, const char *szTextureName,
 								IOETexture *pTexture, int arrOffset = 0);
 		bool SetSamplerVariable(const char *szTextureName,
@@ -111,49 +191,90 @@ namespace Renderer
 
 		void Set(IOE::Renderer::IOERPI *pRPI, bool bSetShaderParams = true);
 
+		// rWorld places the geometry relative to the camera's world origin.
+		// Shaders are only bound when the RPI holds another material, and
+		// the engine constants are only uploaded when they change.
+		void Set(IOE::Renderer::IOERPI *pRPI,
+				 const IOE::Maths::IOEMatrix &rWorld,
+				 bool bSetShaderParams = true);
+
+		// Makes the vertex shader place each vertex by its instance,
+		// starting from uFirstInstance of the bound Instances buffer. Set
+		// turns this off again with zero instances. Only uploaded when
+		// either count changes.
+		void SetInstancing(std::uint32_t uFirstInstance,
+						   std::uint32_t uNumInstances);
+
 		void LoadMaterial(const std::wstring &szPath);
 		void LoadMaterial(rapidxml::xml_node<char> *pNode);
 
 		void MapCBuffer(const char *szConstantBufferName);
 		void UnmapCBuffer(const char *szConstantBufferName);
 
+		bool HasShader(EShaderType::Enum eShaderType) const;
+
 		void Dispatch(IOERPI *pRPI, int32_t nNumThreadGroupsX,
 					  int32_t nNumThreadGroupsY, int32_t nNumThreadGroupsZ);
 
 		void AddDefinition(const std::string &szName,
 						   const std::string &szDefinition);
 
-	private:
-		template <class... TArgs>
-		FORCEINLINE void
-		SetCBufferVariableValue(const char *szConstantBufferName,
-								const char *szVariableName, TArgs &&... tArgs)
+		// Unique to this material, for grouping the draws that share it
+		FORCEINLINE std::uint32_t GetMaterialID() const
 		{
-			for (auto pShader : m_arrShaders)
-			{
-				ShaderConstantBufferDescription *pCBufferDescription(
-					pShader->FindConstantBuffer(szConstantBufferName));
-				if (pCBufferDescription != nullptr)
-				{
-					ShaderVariableDescription *pVariableDescription(
-						pShader->FindConstantBufferVariable(
-							pCBufferDescription, szVariableName));
-					if (pVariableDescription != nullptr)
-					{
-						// Map the buffer
-						IOE_ASSERT(pCBufferDescription->pMappedAddress !=
-									   nullptr,
-								   "CBuffer must be mapped");
-						pShader->SetShaderVariableValue(
-							static_cast<std::uint8_t *>(
-								pCBufferDescription->pMappedAddress) +
-								pVariableDescription->nSlot,
-							tArgs...);
-					}
-				}
-			}
+			return GetResourceIndex();
 		}
 
+		FORCEINLINE const std::vector<std::shared_ptr<IOEShader> > &
+		GetShaders() const
+		{
+			return m_arrShaders;
+		}
+
+		// Declared by the file, in the order their bits are packed
+		FORCEINLINE const std::vector<IOEPermutationAxis> &
+		GetPermutationAxes() const
+		{
+			return m_arrPermutationAxes;
+		}
+
+	private:
+		friend class IOEMaterialBatch;
+		friend class IOEMaterialTemplate;
+
+		// Reads the shaders of every material in the file, or of the one
+		// material node, without compiling them
+		void ParseMaterial(
+			const std::wstring &szPath,
+			std::vector<IOEShaderCompilationOptions> &arrOptions);
+		void ParseMaterial(
+			rapidxml::xml_node<char> *pNode,
+			std::vector<IOEShaderCompilationOptions> &arrOptions);
+
+		void CompileShaders(
+			const std::vector<IOEShaderCompilationOptions> &arrOptions);
+
+		// Copies a parsed template, with the defines of each axis state in
+		// uPermutation added, and fills arrOptions with its shaders
+		void PrepareVariant(
+			const IOEMaterial &rTemplate, std::uint64_t uPermutation,
+			const std::vector<IOEShaderCompilationOptions> &arrTemplateOptions,
+			std::vector<IOEShaderCompilationOptions> &arrOptions);
+
+		// Takes shaders already created from the parsed options, in the
+		// order they were parsed
+		void
+		AddShaders(const std::vector<std::shared_ptr<IOEShader> > &arrShaders);
+
+		// Fills the GlobalSettings of shaders still declaring it, unless it
+		// already holds rWorld and the current view
+		void SetGlobalSettings(IOE::Renderer::IOERPI *pRPI,
+							   const IOE::Maths::IOEMatrix &rWorld);
+
+		template <class... TArgs>
+		void WriteShaderParameter(const IOEShaderParameterHandle &rHandle,
+								  std::size_t uSize, TArgs &&... tArgs);
+
 		template <class... TArgs>
 		FORCEINLINE void SetGlobalVariableValue(const char *szVariableName,
 												EShaderVariableType eType,
@@ -179,6 +300,23 @@ namespace Renderer
 		std::string m_szMaterialName;
 		std::vector<std::shared_ptr<IOEShader> > m_arrShaders;
 		std::vector<IOEShaderMacroDefinition> m_arrDefinitions;
+		std::vector<IOEPermutationAxis> m_arrPermutationAxes;
+
+		// What GlobalSettings was last filled from
+		IOE::Maths::IOEMatrix m_mGlobalSettingsWorld;
+		std::uint32_t m_uGlobalSettingsView;
+		bool m_bGlobalSettingsValid;
+
+		bool m_bHasGlobalSettings;
+
+		// Found when the shaders are added, and what InstanceSettings was
+		// last filled with
+		IOEShaderParameterHandle m_tFirstInstance;
+		IOEShaderParameterHandle m_tNumInstances;
+		std::uint32_t m_uFirstInstance;
+		std::uint32_t m_uNumInstances;
+		bool m_bInstanceSettingsValid;
+		bool m_bComputeOnly;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
@@ -189,13 +327,34 @@ namespace Renderer
 								const std::string &szVariable_)
 			: szBuffer(szBuffer_)
 			, szVariable(szVariable_)
+			, bDirty(true)
+			, bResolved(false)
 		{
 		}
 
 		virtual void SetShaderValue(IOEMaterial *pMaterial) = 0;
 
+		// Found the first time the variable is applied, an instance only
+		// ever applies to the one material
+		FORCEINLINE const IOEShaderParameterHandle &
+		GetHandle(IOEMaterial *pMaterial)
+		{
+			if (!bResolved)
+			{
+				tHandle = pMaterial->GetShaderParameter(szBuffer.c_str(),
+														szVariable.c_str());
+				bResolved = true;
+			}
+			return tHandle;
+		}
+
 		std::string szBuffer;
 		std::string szVariable;
+		IOEShaderParameterHandle tHandle;
+		bool bResolved;
+
+		// Changed since the instance last applied it
+		bool bDirty;
 	};
 
 	struct IOEMaterialVariableInstance_Float : public IOEMaterialVariableBase
@@ -211,12 +370,12 @@ namespace Renderer
 		void UpdateValue(float fValue_)
 		{
 			fValue = fValue_;
+			bDirty = true;
 		}
 
 		virtual void SetShaderValue(IOEMaterial *pMaterial) override final
 		{
-			pMaterial->SetShaderVariableValue(szBuffer.c_str(),
-											  szVariable.c_str(), fValue);
+			pMaterial->SetShaderParameter(GetHandle(pMaterial), fValue);
 		}
 		float fValue;
 	};
@@ -236,12 +395,12 @@ namespace Renderer
 		{
 			fU = fU_;
 			fV = fV_;
+			bDirty = true;
 		}
 
 		virtual void SetShaderValue(IOEMaterial *pMaterial) override final
 		{
-			pMaterial->SetShaderVariableValue(szBuffer.c_str(),
-											  szVariable.c_str(), fU, fV);
+			pMaterial->SetShaderParameter(GetHandle(pMaterial), fU, fV);
 		}
 		float fU;
 		float fV;
@@ -264,12 +423,12 @@ namespace Renderer
 			fX = fX_;
 			fY = fY_;
 			fZ = fZ_;
+			bDirty = true;
 		}
 
 		virtual void SetShaderValue(IOEMaterial *pMaterial) override final
 		{
-			pMaterial->SetShaderVariableValue(szBuffer.c_str(),
-											  szVariable.c_str(), fX, fY, fZ);
+			pMaterial->SetShaderParameter(GetHandle(pMaterial), fX, fY, fZ);
 		}
 		float fX;
 		float fY;
@@ -298,17 +457,18 @@ namespace Renderer
 		void UpdateValue(float fX_, float fY_, float fZ_, float fW_)
 		{
 			vVector.Set(fX_, fY_, fZ_, fW_);
+			bDirty = true;
 		}
 
 		void UpdateValue(const IOE::Maths::IOEVector &vVector_)
 		{
 			vVector = vVector_;
+			bDirty = true;
 		}
 
 		virtual void SetShaderValue(IOEMaterial *pMaterial) override final
 		{
-			pMaterial->SetShaderVariableValue(szBuffer.c_str(),
-											  szVariable.c_str(), vVector);
+			pMaterial->SetShaderParameter(GetHandle(pMaterial), vVector);
 		}
 
 		IOE::Maths::IOEVector vVector;
@@ -326,12 +486,12 @@ namespace Renderer
 		void UpdateValue(const IOE::Maths::IOEMatrix &mMatrix_)
 		{
 			mMatrix = mMatrix_;
+			bDirty = true;
 		}
 
 		virtual void SetShaderValue(IOEMaterial *pMaterial) override final
 		{
-			pMaterial->SetShaderVariableValue(szBuffer.c_str(),
-											  szVariable.c_str(), mMatrix);
+			pMaterial->SetShaderParameter(GetHandle(pMaterial), mMatrix);
 		}
 
 		IOE::Maths::IOEMatrix mMatrix;
@@ -344,6 +504,7 @@ namespace Renderer
 	public:
 		IOEMaterialInstance(shared_ptr<IOEMaterial> pMaterial)
 			: m_pMaterial(pMaterial)
+			, m_bDirty(true)
 		{
 		}
 
@@ -351,6 +512,7 @@ namespace Renderer
 		AddVariableInstance(const std::string &szBuffer,
 							const std::string &szData, float fU)
 		{
+			m_bDirty = true;
 			m_arrVariableInstances.push_back(
 				make_shared<IOEMaterialVariableInstance_Float>(szBuffer,
 															   szData, fU));
@@ -361,6 +523,7 @@ namespace Renderer
 		AddVariableInstance(const std::string &szBuffer,
 							const std::string &szData, float fU, float fV)
 		{
+			m_bDirty = true;
 			m_arrVariableInstances.push_back(
 				make_shared<IOEMaterialVariableInstance_UV>(szBuffer, szData,
 															fU, fV));
@@ -372,6 +535,7 @@ namespace Renderer
 							const std::string &szData, float fX, float fY,
 							float fZ)
 		{
+			m_bDirty = true;
 			m_arrVariableInstances.push_back(
 				make_shared<IOEMaterialVariableInstance_XYZ>(szBuffer, szData,
 															 fX, fY, fZ));
@@ -383,6 +547,7 @@ namespace Renderer
 							const std::string &szData, float fX, float fY,
 							float fZ, float fW)
 		{
+			m_bDirty = true;
 			m_arrVariableInstances.push_back(
 				make_shared<IOEMaterialVariableInstance_Vector>(
 					szBuffer, szData, fX, fY, fZ, fW));
@@ -394,6 +559,7 @@ namespace Renderer
 							const std::string &szData,
 							const IOE::Maths::IOEVector &vVector)
 		{
+			m_bDirty = true;
 			m_arrVariableInstances.push_back(
 				make_shared<IOEMaterialVariableInstance_Vector>(
 					szBuffer, szData, vVector));
@@ -405,6 +571,7 @@ namespace Renderer
 							const std::string &szData,
 							const IOE::Maths::IOEMatrix &mMatrix)
 		{
+			m_bDirty = true;
 			m_arrVariableInstances.push_back(
 				make_shared<IOEMaterialVariableInstance_Matrix>(
 					szBuffer, szData, mMatrix));
@@ -415,6 +582,7 @@ namespace Renderer
 		AddVariableInstance(const std::string &szTexture,
 							shared_ptr<IOETexture> pTexture)
 		{
+			m_bDirty = true;
 			m_arrTextures.push_back(std::make_pair(szTexture, pTexture));
 		}
 
@@ -422,18 +590,28 @@ namespace Renderer
 		AddVariableInstance(const std::string &szSampler,
 							shared_ptr<IOESamplerState> pSampler)
 		{
+			m_bDirty = true;
 			m_arrSamplers.push_back(std::make_pair(szSampler, pSampler));
 		}
 
+		// Skipped when this instance was the last applied, and nothing has
+		// changed its values or the material's bindings since
 		FORCEINLINE_DEBUGGABLE void SetAllVariables(IOERPI *pRPI)
 		{
+			if (pRPI->GetMaterialInstance() == this && !IsDirty())
+			{
+				return;
+			}
+
 			m_pMaterial->SetTextureVariable(pRPI, "DiffuseTexture", nullptr);
 			m_pMaterial->SetTextureVariable(pRPI, "BumpTexture", nullptr);
 
 			for (auto pMaterialVariable : m_arrVariableInstances)
 			{
 				pMaterialVariable->SetShaderValue(m_pMaterial.get());
+				pMaterialVariable->bDirty = false;
 			}
+			m_pMaterial->CommitShaderParameters(pRPI);
 			for (auto &rPair : m_arrTextures)
 			{
 				m_pMaterial->SetTextureVariable(pRPI, rPair.first.c_str(),
@@ -443,6 +621,25 @@ namespace Renderer
 			{
 				m_pMaterial->SetSamplerVariable(rPair.first.c_str(), rPair.second.get());
 			}
+
+			m_bDirty = false;
+			pRPI->SetMaterialInstance(this);
+		}
+
+		FORCEINLINE_DEBUGGABLE bool IsDirty() const
+		{
+			if (m_bDirty)
+			{
+				return true;
+			}
+			for (const auto &pMaterialVariable : m_arrVariableInstances)
+			{
+				if (pMaterialVariable->bDirty)
+				{
+					return true;
+				}
+			}
+			return false;
 		}
 
 		FORCEINLINE_DEBUGGABLE bool
@@ -468,6 +665,7 @@ namespace Renderer
 		vector<pair<string, shared_ptr<IOETexture> > > m_arrTextures;
 		vector<pair<string, shared_ptr<IOESamplerState> > > m_arrSamplers;
 		shared_ptr<IOEMaterial> m_pMaterial;
+		bool m_bDirty;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,217 @@
+#include <unordered_map>
+
+#include <tbb/parallel_for.h>
+
+#include "IOEMaterial.h"
+#include "IOEMaterialBatch.h"
+#include "IOEMaterialTemplate.h"
+#include "IOERPI.h"
+#include "IOEShader.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		struct PendingCompile
+		{
+			std::uint64_t uKey;
+			const IOEShaderCompilationOptions *pOptions;
+			// Platform of the first shader needing the binary
+			IOEShaderCompiler *pCompiler;
+			std::shared_ptr<IOEShaderBinary> pBinary;
+		};
+
+		struct PendingShader
+		{
+			std::shared_ptr<IOEShader> pShader;
+			// Filled by its compile when it was not in the cache
+			std::shared_ptr<const IOEShaderBinary> pBinary;
+		};
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEMaterialBatch::IOEMaterialBatch()
+		: m_uNumShaders(0)
+		, m_uNumCompiles(0)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMaterialBatch::Add(const std::shared_ptr<IOEMaterial> &pMaterial,
+							   const std::wstring &szPath)
+	{
+		Entry tEntry;
+		tEntry.pMaterial	= pMaterial;
+		tEntry.szPath		= szPath;
+		tEntry.pTemplate	= nullptr;
+		tEntry.uPermutation = 0;
+		m_arrEntries.push_back(tEntry);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::shared_ptr<IOEMaterial>
+	IOEMaterialBatch::Add(const std::wstring &szPath)
+	{
+		auto pMaterial(std::make_shared<IOEMaterial>());
+		Add(pMaterial, szPath);
+		return pMaterial;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::shared_ptr<IOEMaterial>
+	IOEMaterialBatch::Add(IOEMaterialTemplate &rTemplate,
+						  std::uint64_t uPermutation)
+	{
+		std::shared_ptr<IOEMaterial> pMaterial(
+			rTemplate.FindVariant(uPermutation));
+		if (pMaterial == nullptr)
+		{
+			Entry tEntry;
+			tEntry.pMaterial =
+				rTemplate.CreateVariant(uPermutation, tEntry.arrOptions);
+			tEntry.pTemplate	= &rTemplate;
+			tEntry.uPermutation = uPermutation;
+			m_arrEntries.push_back(tEntry);
+			pMaterial = m_arrEntries.back().pMaterial;
+		}
+		return pMaterial;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMaterialBatch::Load(IOERPI *pRPI)
+	{
+		try
+		{
+			LoadEntries(pRPI);
+		}
+		catch (...)
+		{
+			RemoveVariants();
+			m_arrEntries.clear();
+			throw;
+		}
+		m_arrEntries.clear();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMaterialBatch::RemoveVariants()
+	{
+		for (const Entry &rEntry : m_arrEntries)
+		{
+			// Unless the template has since been given another variant
+			if (rEntry.pTemplate != nullptr &&
+				rEntry.pTemplate->FindVariant(rEntry.uPermutation) ==
+					rEntry.pMaterial)
+			{
+				rEntry.pTemplate->m_mapVariants.erase(rEntry.uPermutation);
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMaterialBatch::LoadEntries(IOERPI *pRPI)
+	{
+		IOEShaderCache &rCache(pRPI->GetShaderCache());
+
+		std::vector<std::vector<IOEShaderCompilationOptions> > arrOptions(
+			m_arrEntries.size());
+		for (std::size_t uIdx(0); uIdx < m_arrEntries.size(); ++uIdx)
+		{
+			Entry &rEntry(m_arrEntries[uIdx]);
+			if (rEntry.szPath.empty())
+			{
+				arrOptions[uIdx] = rEntry.arrOptions;
+			}
+			else
+			{
+				rEntry.pMaterial->ParseMaterial(rEntry.szPath,
+												arrOptions[uIdx]);
+			}
+		}
+
+		// Each shader takes its binary from the cache, or from the one
+		// compile of its key in this batch
+		std::vector<PendingShader> arrShaders;
+		std::vector<PendingCompile> arrCompiles;
+		std::unordered_map<std::uint64_t, std::size_t> mapCompiles;
+		for (const auto &rarrOptions : arrOptions)
+		{
+			for (const IOEShaderCompilationOptions &rOptions : rarrOptions)
+			{
+				PendingShader tShader;
+				tShader.pShader = std::make_shared<IOEShader>();
+
+				const std::uint64_t uKey(rCache.CalculateKey(
+					rOptions, tShader.pShader->GetPlatform()));
+				tShader.pBinary = rCache.Find(uKey);
+				if (tShader.pBinary == nullptr)
+				{
+					auto tFound(mapCompiles.emplace(uKey, arrCompiles.size()));
+					if (tFound.second)
+					{
+						PendingCompile tCompile;
+						tCompile.uKey	  = uKey;
+						tCompile.pOptions  = &rOptions;
+						tCompile.pCompiler = &tShader.pShader->GetPlatform();
+						tCompile.pBinary = std::make_shared<IOEShaderBinary>();
+						arrCompiles.push_back(tCompile);
+					}
+					tShader.pBinary = arrCompiles[tFound.first->second].pBinary;
+				}
+				arrShaders.push_back(tShader);
+			}
+		}
+
+		// Each compile only writes to its own binary and to the platform
+		// of its own shader
+		auto CompileShader = [&arrCompiles](std::size_t uIdx) {
+			PendingCompile &rCompile(arrCompiles[uIdx]);
+			rCompile.pCompiler->CompileShader(*rCompile.pOptions,
+											  *rCompile.pBinary);
+		};
+		tbb::parallel_for(std::size_t(0), arrCompiles.size(), CompileShader);
+
+		for (const PendingCompile &rCompile : arrCompiles)
+		{
+			rCache.Add(rCompile.uKey, rCompile.pBinary);
+		}
+
+		// Nothing is created on the device until every compile succeeded
+		std::size_t uShaderIdx(0);
+		for (std::size_t uIdx(0); uIdx < m_arrEntries.size(); ++uIdx)
+		{
+			std::vector<std::shared_ptr<IOEShader> > arrMaterialShaders;
+			for (const IOEShaderCompilationOptions &rOptions : arrOptions[uIdx])
+			{
+				PendingShader &rShader(arrShaders[uShaderIdx++]);
+				rShader.pShader->Create(rOptions, rShader.pBinary);
+				arrMaterialShaders.push_back(rShader.pShader);
+			}
+			m_arrEntries[uIdx].pMaterial->AddShaders(arrMaterialShaders);
+
+			// Loaded, so it stays with its template whatever fails next
+			m_arrEntries[uIdx].pTemplate = nullptr;
+		}
+
+		m_uNumShaders  = static_cast<std::uint32_t>(arrShaders.size());
+		m_uNumCompiles = static_cast<std::uint32_t>(arrCompiles.size());
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,94 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <IOE/IOECore/IOEDefines.h>
+
+#include "IOEShader_PlatformBase.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class IOERPI;
+	class IOEMaterial;
+	class IOEMaterialTemplate;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Loads many materials together. Every material is parsed before any
+	// shader is compiled, so a shader shared by several materials, or
+	// already in the shader cache, is compiled at most once, and the
+	// remaining compiles are spread across the worker threads. The
+	// materials are only usable once Load has returned.
+	class IOEMaterialBatch
+	{
+	public:
+		IOEMaterialBatch();
+
+		// pMaterial is loaded from szPath by the next Load, so any
+		// definitions must be added to it beforehand
+		void Add(const std::shared_ptr<IOEMaterial> &pMaterial,
+				 const std::wstring &szPath);
+		std::shared_ptr<IOEMaterial> Add(const std::wstring &szPath);
+
+		// The variant of rTemplate, compiled by the next Load unless the
+		// template already holds it
+		std::shared_ptr<IOEMaterial> Add(IOEMaterialTemplate &rTemplate,
+										 std::uint64_t uPermutation);
+
+		// Loads every material added since the last Load, throwing as
+		// LoadMaterial does when any of them fails. A failed batch is
+		// dropped, and the variants it had not yet loaded are removed from
+		// their templates, as GetVariant does when a compile fails.
+		void Load(IOERPI *pRPI);
+
+	public:
+		// Shaders the last Load created, and how many of them it compiled
+		FORCEINLINE std::uint32_t GetNumShaders() const
+		{
+			return m_uNumShaders;
+		}
+		FORCEINLINE std::uint32_t GetNumCompiles() const
+		{
+			return m_uNumCompiles;
+		}
+
+	private:
+		void LoadEntries(IOERPI *pRPI);
+		void RemoveVariants();
+
+	private:
+		struct Entry
+		{
+			std::shared_ptr<IOEMaterial> pMaterial;
+			// Parsed by Load, unless the shaders were already parsed into
+			// arrOptions by a template
+			std::wstring szPath;
+			std::vector<IOEShaderCompilationOptions> arrOptions;
+
+			// Template the variant is registered with until it has loaded
+			IOEMaterialTemplate *pTemplate;
+			std::uint64_t uPermutation;
+		};
+
+		std::vector<Entry> m_arrEntries;
+
+		std::uint32_t m_uNumShaders;
+		std::uint32_t m_uNumCompiles;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,144 @@
+#include <cstring>
+
+#include <IOE/IOEExceptions/IOEException_Renderer.h>
+#include <IOE/IOEExceptions/IOEException_Enum.h>
+
+#include "IOEMaterialTemplate.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEMaterialTemplate::IOEMaterialTemplate()
+		: m_uPermutationBits(0)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMaterialTemplate::AddDefinition(const std::string &szName,
+											const std::string &szDefinition)
+	{
+		m_tTemplate.AddDefinition(szName, szDefinition);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMaterialTemplate::LoadTemplate(const std::wstring &szPath)
+	{
+		m_tTemplate.ParseMaterial(szPath, m_arrOptions);
+
+		m_uPermutationBits = 0;
+		for (const IOEPermutationAxis &rAxis : m_tTemplate.GetPermutationAxes())
+		{
+			m_uPermutationBits |= ((1ULL << rAxis.uNumBits) - 1)
+								  << rAxis.uShift;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	const IOEPermutationAxis &
+	IOEMaterialTemplate::FindAxis(const char *szAxis) const
+	{
+		for (const IOEPermutationAxis &rAxis : m_tTemplate.GetPermutationAxes())
+		{
+			if (rAxis.szName == szAxis)
+			{
+				return rAxis;
+			}
+		}
+		THROW_IOE_RENDERER_EXCEPTION_VARGS("Unknown permutation '%s'",
+										   E_ERROR_FAILED_TO_READ_MATERIAL,
+										   szAxis);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint64_t IOEMaterialTemplate::GetPermutation(const char *szAxis,
+													  const char *szValue) const
+	{
+		const IOEPermutationAxis &rAxis(FindAxis(szAxis));
+		for (std::size_t uIdx(0); uIdx < rAxis.arrValues.size(); ++uIdx)
+		{
+			if (rAxis.arrValues[uIdx] == szValue)
+			{
+				// State zero is the axis left undefined
+				return static_cast<std::uint64_t>(uIdx + 1) << rAxis.uShift;
+			}
+		}
+		THROW_IOE_RENDERER_EXCEPTION_VARGS(
+			"Permutation '%s' has no value '%s'",
+			E_ERROR_FAILED_TO_READ_MATERIAL, szAxis, szValue);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint64_t IOEMaterialTemplate::GetPermutation(const char *szAxis) const
+	{
+		return 1ULL << FindAxis(szAxis).uShift;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::shared_ptr<IOEMaterial>
+	IOEMaterialTemplate::GetVariant(std::uint64_t uPermutation)
+	{
+		std::shared_ptr<IOEMaterial> pVariant(FindVariant(uPermutation));
+		if (pVariant == nullptr)
+		{
+			std::vector<IOEShaderCompilationOptions> arrOptions;
+			pVariant = CreateVariant(uPermutation, arrOptions);
+			try
+			{
+				pVariant->CompileShaders(arrOptions);
+			}
+			catch (...)
+			{
+				m_mapVariants.erase(uPermutation);
+				throw;
+			}
+		}
+		return pVariant;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::shared_ptr<IOEMaterial>
+	IOEMaterialTemplate::FindVariant(std::uint64_t uPermutation) const
+	{
+		auto tFound(m_mapVariants.find(uPermutation));
+		return tFound != m_mapVariants.end() ? tFound->second : nullptr;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::shared_ptr<IOEMaterial> IOEMaterialTemplate::CreateVariant(
+		std::uint64_t uPermutation,
+		std::vector<IOEShaderCompilationOptions> &arrOptions)
+	{
+		if ((uPermutation & ~m_uPermutationBits) != 0)
+		{
+			THROW_IOE_RENDERER_EXCEPTION_VARGS(
+				"Permutation 0x%llx is outside of the axes of '%s'",
+				E_ERROR_FAILED_TO_READ_MATERIAL,
+				static_cast<unsigned long long>(uPermutation),
+				m_tTemplate.m_szMaterialName.c_str());
+		}
+
+		auto pVariant(std::make_shared<IOEMaterial>());
+		pVariant->PrepareVariant(m_tTemplate, uPermutation, m_arrOptions,
+								 arrOptions);
+		m_mapVariants.emplace(uPermutation, pVariant);
+		return pVariant;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
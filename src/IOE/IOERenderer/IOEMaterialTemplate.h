@@ -0,0 +1,91 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <IOE/IOECore/IOEDefines.h>
+
+#include "IOEMaterial.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class IOEMaterialBatch;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// A material file parsed once, from which the variants selected by its
+	// permutation axes are compiled the first time each is asked for.
+	// Variants are kept by a mask holding the state of every axis, so
+	// choosing one per draw is a single hash probe. Each variant compiles
+	// with its own definitions, so the shader cache only saves compiling a
+	// variant another material or an earlier run compiled already, and
+	// every variant keeps its own copy of the reflected buffer layout.
+	class IOEMaterialTemplate
+	{
+	public:
+		IOEMaterialTemplate();
+
+		// Defined in every variant, so must be added before LoadTemplate
+		void AddDefinition(const std::string &szName,
+						   const std::string &szDefinition);
+
+		void LoadTemplate(const std::wstring &szPath);
+
+		// Mask selecting szValue of the axis szAxis, or turning szAxis on
+		// when it is a boolean. Masks of different axes are combined with
+		// |, and an axis left out of the mask is not defined at all.
+		std::uint64_t GetPermutation(const char *szAxis,
+									 const char *szValue) const;
+		std::uint64_t GetPermutation(const char *szAxis) const;
+
+		// Compiled on the first call for each mask
+		std::shared_ptr<IOEMaterial> GetVariant(std::uint64_t uPermutation);
+
+	public:
+		FORCEINLINE std::size_t GetNumVariants() const
+		{
+			return m_mapVariants.size();
+		}
+
+	private:
+		friend class IOEMaterialBatch;
+
+		// Null when the variant has not been asked for yet
+		std::shared_ptr<IOEMaterial>
+		FindVariant(std::uint64_t uPermutation) const;
+
+		// Adds the variant uncompiled, leaving its shaders to arrOptions
+		std::shared_ptr<IOEMaterial>
+		CreateVariant(std::uint64_t uPermutation,
+					  std::vector<IOEShaderCompilationOptions> &arrOptions);
+
+		const IOEPermutationAxis &FindAxis(const char *szAxis) const;
+
+	private:
+		// Holds the parsed name, definitions and axes, never compiled
+		IOEMaterial m_tTemplate;
+		std::vector<IOEShaderCompilationOptions> m_arrOptions;
+
+		// Bits used by any axis, a mask outside of them names no variant
+		std::uint64_t m_uPermutationBits;
+
+		std::unordered_map<std::uint64_t, std::shared_ptr<IOEMaterial> >
+			m_mapVariants;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
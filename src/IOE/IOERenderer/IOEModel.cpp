@@ -1,4 +1,8 @@
+#include <cmath>
+#include <cstring>
 #include <limits>
+#include <unordered_map>
+#include <utility>
 
 #include <fbxsdk.h>
 
@@ -9,6 +13,7 @@
 #include <IOE/IOEExceptions/IOEException_Renderer.h>
 #include <IOE/IOEExceptions/IOEException_Enum.h>
 
+#include <IOE/IOEMaths/Math.h>
 #include <IOE/IOEMaths/Vector.h>
 
 #include "IOEModelManager.h"
@@ -25,6 +30,53 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	namespace
+	{
+		// Largest difference between a repeated position and its shape's,
+		// relative to the position's magnitude
+		const float g_fShapeTolerance = 1.0e-5f;
+
+		void GetVertexRange(const int32_t *pIndices, int32_t nNumIndices,
+							int32_t &rMin, int32_t &rMax)
+		{
+			rMin = nNumIndices > 0 ? pIndices[0] : 0;
+			rMax = nNumIndices > 0 ? pIndices[0] : -1;
+			for (int32_t nIdx(1); nIdx < nNumIndices; ++nIdx)
+			{
+				if (pIndices[nIdx] < rMin)
+				{
+					rMin = pIndices[nIdx];
+				}
+				else if (pIndices[nIdx] > rMax)
+				{
+					rMax = pIndices[nIdx];
+				}
+			}
+		}
+
+		bool AttributesMatch(const ModelVertex &rA, const ModelVertex &rB)
+		{
+			// Copies of one mesh share every attribute but their position
+			return std::memcmp(&rA.m_vNormal, &rB.m_vNormal,
+							   sizeof(rA.m_vNormal)) == 0 &&
+				   std::memcmp(&rA.m_vColour, &rB.m_vColour,
+							   sizeof(rA.m_vColour)) == 0 &&
+				   std::memcmp(&rA.m_vUV, &rB.m_vUV, sizeof(rA.m_vUV)) == 0 &&
+				   std::memcmp(&rA.m_vTangent, &rB.m_vTangent,
+							   sizeof(rA.m_vTangent)) == 0 &&
+				   std::memcmp(&rA.m_vBinormal, &rB.m_vBinormal,
+							   sizeof(rA.m_vBinormal)) == 0;
+		}
+
+		bool PositionMatches(float fShape, float fSubset, float fOffset)
+		{
+			return std::abs(fSubset - fShape - fOffset) <=
+				   g_fShapeTolerance * (1.0f + std::abs(fSubset));
+		}
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
 	void SetFloat2FromDoublePtr(XMFLOAT2 &rOutput, double *pData)
 	{
 		rOutput = XMFLOAT2(static_cast<float>(pData[0]),
@@ -54,12 +106,69 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	// The origin is subtracted in double precision before the cast, so far
+	// away vertices keep their float precision relative to each other
+	void SetPositionFromDoublePtr(XMFLOAT4 &rOutput, const double *pData,
+								  const double *pOrigin)
+	{
+		rOutput = XMFLOAT4(static_cast<float>(pData[0] - pOrigin[0]),
+						   static_cast<float>(pData[1] - pOrigin[1]),
+						   static_cast<float>(pData[2] - pOrigin[2]),
+						   static_cast<float>(pData[3]));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void AccumulateControlPointBounds(FbxNode *pNode, double *pMin,
+									  double *pMax)
+	{
+		FbxNodeAttribute *pAttribute(pNode->GetNodeAttribute());
+		if (pAttribute != nullptr &&
+			pAttribute->GetAttributeType() == FbxNodeAttribute::eMesh)
+		{
+			FbxMesh *pMesh(static_cast<FbxMesh *>(pAttribute));
+			FbxVector4 *arrControlPoints(pMesh->GetControlPoints());
+			for (std::int32_t nControlPointIdx(0);
+				 nControlPointIdx < pMesh->GetControlPointsCount();
+				 ++nControlPointIdx)
+			{
+				const double *pData(arrControlPoints[nControlPointIdx]);
+				for (std::int32_t nAxis(0); nAxis < 3; ++nAxis)
+				{
+					pMin[nAxis] = Min(pMin[nAxis], pData[nAxis]);
+					pMax[nAxis] = Max(pMax[nAxis], pData[nAxis]);
+				}
+			}
+		}
+
+		for (std::int32_t nChildIdx(0); nChildIdx < pNode->GetChildCount();
+			 ++nChildIdx)
+		{
+			AccumulateControlPointBounds(pNode->GetChild(nChildIdx), pMin,
+										 pMax);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	const double IOEModel::ms_fLargeWorldThreshold = 65536.0;
+
+	//////////////////////////////////////////////////////////////////////////
+
 	IOEModel::IOEModel(const std::wstring &szPath,
 					   const std::string &szPassword)
 		: m_szPath(szPath)
 		, m_szPassword(szPassword)
 		, m_tPlatform(*this)
+		, m_uNumSubsetShapes(0)
+		, m_uWorldPositionIdx(0)
 	{
+		for (int32_t nAxis(0); nAxis < 3; ++nAxis)
+		{
+			m_arrBoundsCentre[nAxis] = 0.0f;
+			m_arrBoundsExtent[nAxis] = 0.0f;
+			m_arrOrigin[nAxis]		 = 0.0;
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -84,6 +193,8 @@ namespace Renderer
 
 		if (pRoot != nullptr)
 		{
+			ComputeOrigin(pRoot);
+
 			for (std::int32_t nChildIdx(0); nChildIdx < pRoot->GetChildCount();
 				 ++nChildIdx)
 			{
@@ -92,6 +203,28 @@ namespace Renderer
 			}
 		}
 
+		return OnLoaded();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEModel::Load(std::vector<ModelVertex> arrVertices,
+						std::vector<int32_t> arrIndices,
+						std::vector<MeshIndex> arrSubsets)
+	{
+		m_arrVertices = std::move(arrVertices);
+		m_arrIndices  = std::move(arrIndices);
+		m_arrSubsets  = std::move(arrSubsets);
+		return OnLoaded();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEModel::OnLoaded()
+	{
+		BuildSubsetBounds();
+		BuildSubsetShapes();
+
 		// Setup our platform data
 		try
 		{
@@ -712,9 +845,9 @@ namespace Renderer
 		{
 			// Load vertices
 			double *pData(arrControlPoints[nControlPointIdx]);
-			SetFloat4FromDoublePtr(
+			SetPositionFromDoublePtr(
 				m_arrVertices[nVertOffset + nControlPointIdx].m_vPosition,
-				pData);
+				pData, m_arrOrigin);
 		}
 
 		if (pMesh->GetPolygonCount() == 0)
@@ -925,6 +1058,245 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	void IOEModel::ComputeOrigin(FbxNode *pRoot)
+	{
+		double arrMin[3], arrMax[3];
+		for (std::int32_t nAxis(0); nAxis < 3; ++nAxis)
+		{
+			arrMin[nAxis] = std::numeric_limits<double>::infinity();
+			arrMax[nAxis] = -std::numeric_limits<double>::infinity();
+			m_arrOrigin[nAxis] = 0.0;
+		}
+		AccumulateControlPointBounds(pRoot, arrMin, arrMax);
+
+		// Models that fit comfortably in float precision stay in world space
+		// so existing content is untouched; anything further out is stored
+		// relative to its centre and placed through its world position
+		double fMaxCoordinate(0.0);
+		for (std::int32_t nAxis(0); nAxis < 3; ++nAxis)
+		{
+			if (arrMin[nAxis] <= arrMax[nAxis])
+			{
+				fMaxCoordinate = Max(fMaxCoordinate, Abs(arrMin[nAxis]));
+				fMaxCoordinate = Max(fMaxCoordinate, Abs(arrMax[nAxis]));
+			}
+		}
+
+		if (fMaxCoordinate > ms_fLargeWorldThreshold)
+		{
+			for (std::int32_t nAxis(0); nAxis < 3; ++nAxis)
+			{
+				m_arrOrigin[nAxis] = (arrMin[nAxis] + arrMax[nAxis]) * 0.5;
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEVectorD IOEModel::GetWorldPosition() const
+	{
+		return IOEModelManager::GetSingletonPtr()->GetModelWorldPosition(
+			m_uWorldPositionIdx);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEModel::SetWorldPosition(const IOEVectorD &vPosition)
+	{
+		IOEModelManager::GetSingletonPtr()->SetModelWorldPosition(
+			m_uWorldPositionIdx, vPosition);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEModel::GetRenderOffset(float &fX, float &fY, float &fZ) const
+	{
+		IOEModelManager::GetSingletonPtr()->GetModelRenderOffset(
+			m_uWorldPositionIdx, fX, fY, fZ);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEMatrix IOEModel::GetRenderTransform(const IOECamera &rView) const
+	{
+		float fX, fY, fZ;
+		GetRenderOffset(fX, fY, fZ);
+
+		float fViewX, fViewY, fViewZ;
+		IOEModelManager::GetSingletonPtr()->GetViewOffset(rView, fViewX,
+														   fViewY, fViewZ);
+		return IOEMatrix::Translation(
+			IOEVector(fX + fViewX, fY + fViewY, fZ + fViewZ));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEModel::BuildSubsetBounds()
+	{
+		const std::size_t uNumSubsets(m_arrSubsets.size());
+		m_arrSubsetBoundsData.resize(uNumSubsets * 6);
+
+		float *pData(m_arrSubsetBoundsData.data());
+		m_tSubsetBounds.pCentreX = pData;
+		m_tSubsetBounds.pCentreY = pData + uNumSubsets;
+		m_tSubsetBounds.pCentreZ = pData + uNumSubsets * 2;
+		m_tSubsetBounds.pExtentX = pData + uNumSubsets * 3;
+		m_tSubsetBounds.pExtentY = pData + uNumSubsets * 4;
+		m_tSubsetBounds.pExtentZ = pData + uNumSubsets * 5;
+		m_tSubsetBounds.uCount	 = static_cast<std::uint32_t>(uNumSubsets);
+
+		for (std::size_t uIdx(0); uIdx < uNumSubsets; ++uIdx)
+		{
+			const IOEAABB &rAABB(m_arrSubsets[uIdx].m_tAABB);
+			IOEVector vExtent((rAABB.m_vBounds[1] - rAABB.m_vBounds[0]) * 0.5f);
+			IOEVector vCentre(rAABB.m_vBounds[0] + vExtent);
+
+			vCentre.Get(pData[uIdx], pData[uIdx + uNumSubsets],
+						pData[uIdx + uNumSubsets * 2]);
+			vExtent.Get(pData[uIdx + uNumSubsets * 3],
+						pData[uIdx + uNumSubsets * 4],
+						pData[uIdx + uNumSubsets * 5]);
+		}
+
+		IOEAABB tAABB(GetAABB());
+		IOEVector vExtent((tAABB.m_vBounds[1] - tAABB.m_vBounds[0]) * 0.5f);
+		IOEVector vCentre(tAABB.m_vBounds[0] + vExtent);
+		vCentre.Get(m_arrBoundsCentre[0], m_arrBoundsCentre[1],
+					m_arrBoundsCentre[2]);
+		vExtent.Get(m_arrBoundsExtent[0], m_arrBoundsExtent[1],
+					m_arrBoundsExtent[2]);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEModel::BuildSubsetShapes()
+	{
+		const std::size_t uNumSubsets(m_arrSubsets.size());
+		m_arrSubsetShapes.resize(uNumSubsets);
+		m_arrSubsetShapeOffsets.assign(uNumSubsets * 3, 0.0f);
+		m_uNumSubsetShapes = 0;
+
+		// Shapes bucketed by a hash of their textures and index pattern,
+		// then compared vertex by vertex
+		std::unordered_map<std::uint64_t, std::vector<std::uint32_t> >
+			tShapes;
+
+		for (std::uint32_t uSubset(0); uSubset < uNumSubsets; ++uSubset)
+		{
+			const MeshIndex &rIndex(m_arrSubsets[uSubset]);
+			const int32_t *pIndices(m_arrIndices.data() + rIndex.m_nStartIdx);
+
+			int32_t nMinVertex, nMaxVertex;
+			GetVertexRange(pIndices, rIndex.m_nNumIndices, nMinVertex,
+						   nMaxVertex);
+
+			// FNV-1a
+			std::uint64_t uHash(14695981039346656037ull);
+			auto Hash = [&uHash](std::uint64_t uValue) {
+				uHash = (uHash ^ uValue) * 1099511628211ull;
+			};
+			Hash(static_cast<std::uint64_t>(nMaxVertex - nMinVertex));
+			for (auto &pTexture : rIndex.m_arrTextures)
+			{
+				Hash(reinterpret_cast<std::uintptr_t>(pTexture.get()));
+			}
+			for (int32_t nIdx(0); nIdx < rIndex.m_nNumIndices; ++nIdx)
+			{
+				Hash(static_cast<std::uint64_t>(pIndices[nIdx] - nMinVertex));
+			}
+
+			std::vector<std::uint32_t> &rCandidates(tShapes[uHash]);
+			float *pOffset(&m_arrSubsetShapeOffsets[uSubset * 3]);
+
+			std::uint32_t uShape(uSubset);
+			for (std::uint32_t uCandidate : rCandidates)
+			{
+				if (MatchSubsetShape(uCandidate, uSubset, pOffset))
+				{
+					uShape = uCandidate;
+					break;
+				}
+			}
+
+			if (uShape == uSubset)
+			{
+				pOffset[0] = pOffset[1] = pOffset[2] = 0.0f;
+				rCandidates.push_back(uSubset);
+				++m_uNumSubsetShapes;
+			}
+			m_arrSubsetShapes[uSubset] = uShape;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEModel::MatchSubsetShape(std::uint32_t uShape,
+									std::uint32_t uSubset,
+									float *pOffset) const
+	{
+		const MeshIndex &rShape(m_arrSubsets[uShape]);
+		const MeshIndex &rSubset(m_arrSubsets[uSubset]);
+		if (rShape.m_nNumIndices != rSubset.m_nNumIndices ||
+			rShape.m_nNumIndices == 0 ||
+			rShape.m_arrTextures != rSubset.m_arrTextures)
+		{
+			return false;
+		}
+
+		const int32_t *pShapeIndices(m_arrIndices.data() + rShape.m_nStartIdx);
+		const int32_t *pSubsetIndices(m_arrIndices.data() +
+									  rSubset.m_nStartIdx);
+
+		int32_t nShapeMin, nShapeMax, nSubsetMin, nSubsetMax;
+		GetVertexRange(pShapeIndices, rShape.m_nNumIndices, nShapeMin,
+					   nShapeMax);
+		GetVertexRange(pSubsetIndices, rSubset.m_nNumIndices, nSubsetMin,
+					   nSubsetMax);
+		if (nShapeMax - nShapeMin != nSubsetMax - nSubsetMin)
+		{
+			return false;
+		}
+
+		for (int32_t nIdx(0); nIdx < rShape.m_nNumIndices; ++nIdx)
+		{
+			if (pShapeIndices[nIdx] - nShapeMin !=
+				pSubsetIndices[nIdx] - nSubsetMin)
+			{
+				return false;
+			}
+		}
+
+		// The first vertices give the translation the rest must share
+		const XMFLOAT4 &rShapeFirst(m_arrVertices[nShapeMin].m_vPosition);
+		const XMFLOAT4 &rSubsetFirst(m_arrVertices[nSubsetMin].m_vPosition);
+		const float fOffsetX(rSubsetFirst.x - rShapeFirst.x);
+		const float fOffsetY(rSubsetFirst.y - rShapeFirst.y);
+		const float fOffsetZ(rSubsetFirst.z - rShapeFirst.z);
+
+		for (int32_t nVertex(0); nVertex <= nShapeMax - nShapeMin; ++nVertex)
+		{
+			const ModelVertex &rA(m_arrVertices[nShapeMin + nVertex]);
+			const ModelVertex &rB(m_arrVertices[nSubsetMin + nVertex]);
+			if (!PositionMatches(rA.m_vPosition.x, rB.m_vPosition.x,
+								 fOffsetX) ||
+				!PositionMatches(rA.m_vPosition.y, rB.m_vPosition.y,
+								 fOffsetY) ||
+				!PositionMatches(rA.m_vPosition.z, rB.m_vPosition.z,
+								 fOffsetZ) ||
+				!AttributesMatch(rA, rB))
+			{
+				return false;
+			}
+		}
+
+		pOffset[0] = fOffsetX;
+		pOffset[1] = fOffsetY;
+		pOffset[2] = fOffsetZ;
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 	void IOEModel::SetMaterial(
 		IOERPI *pRPI,
 		std::shared_ptr<IOE::Renderer::IOEMaterial> pMaterial,
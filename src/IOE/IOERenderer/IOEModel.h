@@ -9,7 +9,10 @@
 
 #include <IOE/IOECore/IOEDefines.h>
 #include <IOE/IOEMaths/Vector.h>
+#include <IOE/IOEMaths/Matrix.h>
+#include <IOE/IOEMaths/VectorD.h>
 #include <IOE/IOEMaths/AABB.h>
+#include <IOE/IOEMaths/Frustum.h>
 #include <IOE/IOERenderer/IOEMaterial.h>
 #include <IOE/IOERenderer/IOEVertexFormat.h>
 
@@ -66,25 +69,63 @@ namespace Renderer
 
 	public:
 		bool Load(IOEModelManager *pManager);
+		// Takes geometry built in memory in place of the file. Positions
+		// are kept as given, so the origin stays at zero.
+		bool Load(std::vector<ModelVertex> arrVertices,
+				  std::vector<int32_t> arrIndices,
+				  std::vector<MeshIndex> arrSubsets);
 
 		FORCEINLINE void OnRender(IOERPI *pRPI, bool bSetShaderParams = true)
 		{
 			IOE_ASSERT(m_pMaterial != nullptr,
 					   "Material must be set before model can be rendered");
-			m_pMaterial->Set(pRPI, bSetShaderParams);
+			m_pMaterial->Set(pRPI, GetRenderTransform(pRPI->GetCamera()),
+							 bSetShaderParams);
 			m_tPlatform.OnRender(pRPI, bSetShaderParams);
 		}
-		void OnRender(IOERPI *pRPI, struct IOEVisibilityLink *pHead,
-					  bool bSetShaderParams = true)
+		// Draws only the listed subsets, such as a model's range from
+		// IOEVisibilityBounds
+		void OnRender(IOERPI *pRPI, const std::uint32_t *pSubsets,
+					  std::uint32_t uNumSubsets, bool bSetShaderParams = true)
 		{
 			IOE_ASSERT(m_pMaterial != nullptr,
 					   "Material must be set before model can be rendered");
-			m_pMaterial->Set(pRPI, bSetShaderParams);
-			m_tPlatform.OnRender(pRPI, pHead, bSetShaderParams);
+			m_pMaterial->Set(pRPI, GetRenderTransform(pRPI->GetCamera()),
+							 bSetShaderParams);
+			m_tPlatform.OnRender(pRPI, pSubsets, uNumSubsets, bSetShaderParams);
+		}
+
+		// Instanced drawing. Each draw places copies of a subset by the
+		// model space transforms in pInstances, a structured buffer of
+		// IOEInstanceData, starting from uFirstInstance.
+		void BeginInstanced(IOERPI *pRPI, IOETexture *pInstances,
+							bool bSetShaderParams = true)
+		{
+			IOE_ASSERT(m_pMaterial != nullptr,
+					   "Material must be set before model can be rendered");
+			m_pMaterial->Set(pRPI, GetRenderTransform(pRPI->GetCamera()),
+							 bSetShaderParams);
+			m_pMaterial->SetTextureVariable(pRPI, "Instances", pInstances);
+		}
+		void OnRenderInstanced(IOERPI *pRPI, std::uint32_t uSubset,
+							   std::uint32_t uFirstInstance,
+							   std::uint32_t uNumInstances)
+		{
+			m_pMaterial->SetInstancing(uFirstInstance, uNumInstances);
+			m_tPlatform.OnRenderInstanced(pRPI, uSubset, uNumInstances);
+		}
+		void EndInstanced(IOERPI *pRPI)
+		{
+			m_pMaterial->SetInstancing(0, 0);
+			m_pMaterial->SetTextureVariable(pRPI, "Instances", nullptr);
 		}
 
 		void SetMaterial(IOERPI *pRPI, std::shared_ptr<IOE::Renderer::IOEMaterial> pMaterial,
 						 bool bSetVariables = true);
+		FORCEINLINE const IOEMaterial *GetMaterial() const
+		{
+			return m_pMaterial.get();
+		}
 
 		FORCEINLINE std::int32_t GetNumSubsets() const
 		{
@@ -99,6 +140,64 @@ namespace Renderer
 			return m_arrSubsets[nIdx];
 		}
 
+		// Subset bounds as centre/extents arrays for batch culling, built once
+		// the model has loaded. Like the vertices they are relative to
+		// GetOrigin().
+		FORCEINLINE const IOEAABBArray &GetSubsetBounds() const
+		{
+			return m_tSubsetBounds;
+		}
+		FORCEINLINE const float *GetBoundsCentre() const
+		{
+			return m_arrBoundsCentre;
+		}
+		FORCEINLINE const float *GetBoundsExtent() const
+		{
+			return m_arrBoundsExtent;
+		}
+
+		// Subsets with the same textures whose geometry repeats an earlier
+		// subset's up to a translation share that subset as their shape,
+		// so can be drawn as instances of it. Built once the model has
+		// loaded.
+		FORCEINLINE std::uint32_t GetSubsetShape(std::int32_t nIdx) const
+		{
+			return m_arrSubsetShapes[nIdx];
+		}
+		// Translation from the shape's vertices to this subset's
+		FORCEINLINE const float *GetSubsetShapeOffset(std::int32_t nIdx) const
+		{
+			return &m_arrSubsetShapeOffsets[nIdx * 3];
+		}
+		FORCEINLINE std::uint32_t GetNumSubsetShapes() const
+		{
+			return m_uNumSubsetShapes;
+		}
+
+		// Vertex positions and bounds are relative to this double precision
+		// point. It is zero unless the model lies far from the world origin.
+		FORCEINLINE IOEVectorD GetOrigin() const
+		{
+			return IOEVectorD::Load3(m_arrOrigin);
+		}
+
+		// Where the origin is placed in the world, initially GetOrigin()
+		IOEVectorD GetWorldPosition() const;
+		void SetWorldPosition(const IOEVectorD &vPosition);
+
+		// World position relative to the frame's world origin, which the
+		// model manager rebases against once a frame
+		void GetRenderOffset(float &fX, float &fY, float &fZ) const;
+
+		// World matrix placing the model relative to rView's world origin,
+		// so views that do not share the frame's origin still line up
+		IOEMatrix GetRenderTransform(const IOECamera &rView) const;
+
+		FORCEINLINE void SetWorldPositionIndex(std::uint32_t uIdx)
+		{
+			m_uWorldPositionIdx = uIdx;
+		}
+
 		FORCEINLINE const std::vector<ModelVertex> &GetVertexBuffer() const
 		{
 			return m_arrVertices;
@@ -121,42 +220,16 @@ namespace Renderer
 			IOEVector(rVertex.m_vPosition) + IOEVector(rVertex.m_vNormal),
 					Maths::ColourList::Green, Maths::ColourList::Red);
 			}*/
+			float fOffsetX, fOffsetY, fOffsetZ;
+			GetRenderOffset(fOffsetX, fOffsetY, fOffsetZ);
+			const IOEVector vOffset(fOffsetX, fOffsetY, fOffsetZ, 0.0f);
+
+			IOEDebugDraw &rDebugDraw(pRPI->GetDebugDraw());
 			for (auto &rSubset : m_arrSubsets)
 			{
-				float fXMin, fYMin, fZMin;
-				float fXMax, fYMax, fZMax;
-				rSubset.m_tAABB.m_vBounds[0].Get(fXMin, fYMin, fZMin);
-				rSubset.m_tAABB.m_vBounds[1].Get(fXMax, fYMax, fZMax);
-
-				// Front face
-				pRPI->AddDebugLine(IOEVector(fXMin, fYMin, fZMin),
-								   IOEVector(fXMin, fYMax, fZMin));
-				pRPI->AddDebugLine(IOEVector(fXMin, fYMax, fZMin),
-								   IOEVector(fXMax, fYMax, fZMin));
-				pRPI->AddDebugLine(IOEVector(fXMax, fYMax, fZMin),
-								   IOEVector(fXMax, fYMin, fZMin));
-				pRPI->AddDebugLine(IOEVector(fXMax, fYMin, fZMin),
-								   IOEVector(fXMin, fYMin, fZMin));
-
-				// Rear face
-				pRPI->AddDebugLine(IOEVector(fXMin, fYMin, fZMax),
-								   IOEVector(fXMin, fYMax, fZMax));
-				pRPI->AddDebugLine(IOEVector(fXMin, fYMax, fZMax),
-								   IOEVector(fXMax, fYMax, fZMax));
-				pRPI->AddDebugLine(IOEVector(fXMax, fYMax, fZMax),
-								   IOEVector(fXMax, fYMin, fZMax));
-				pRPI->AddDebugLine(IOEVector(fXMax, fYMin, fZMax),
-								   IOEVector(fXMin, fYMin, fZMax));
-
-				// Connectors
-				pRPI->AddDebugLine(IOEVector(fXMin, fYMin, fZMin),
-								   IOEVector(fXMin, fYMin, fZMax));
-				pRPI->AddDebugLine(IOEVector(fXMin, fYMax, fZMin),
-								   IOEVector(fXMin, fYMax, fZMax));
-				pRPI->AddDebugLine(IOEVector(fXMax, fYMax, fZMin),
-								   IOEVector(fXMax, fYMax, fZMax));
-				pRPI->AddDebugLine(IOEVector(fXMax, fYMin, fZMin),
-								   IOEVector(fXMax, fYMin, fZMax));
+				const IOEVector vMin(rSubset.m_tAABB.m_vBounds[0] + vOffset);
+				const IOEVector vMax(rSubset.m_tAABB.m_vBounds[1] + vOffset);
+				rDebugDraw.AddBox((vMin + vMax) * 0.5f, (vMax - vMin) * 0.5f);
 			}
 		}
 
@@ -180,6 +253,17 @@ namespace Renderer
 		bool LoadScene(IOEModelManager *pManager);
 		bool LoadNode(FbxNode *pNode, IOEModelManager *pManager);
 		bool LoadGeometry(FbxMesh *pMesh, IOEModelManager *pManager);
+		void ComputeOrigin(FbxNode *pRoot);
+		// Builds what is derived from the geometry and sets up the platform
+		bool OnLoaded();
+		void BuildSubsetBounds();
+		void BuildSubsetShapes();
+		bool MatchSubsetShape(std::uint32_t uShape, std::uint32_t uSubset,
+							  float *pOffset) const;
+
+	private:
+		// Coordinates beyond this are stored relative to the model's centre
+		static const double ms_fLargeWorldThreshold;
 
 	private:
 		IOEModel_Platform m_tPlatform;
@@ -193,6 +277,18 @@ namespace Renderer
 		std::vector<ModelVertex> m_arrVertices;
 		std::vector<int32_t> m_arrIndices;
 		std::vector<MeshIndex> m_arrSubsets;
+
+		std::vector<float> m_arrSubsetBoundsData;
+		IOEAABBArray m_tSubsetBounds;
+		float m_arrBoundsCentre[3];
+		float m_arrBoundsExtent[3];
+
+		std::vector<std::uint32_t> m_arrSubsetShapes;
+		std::vector<float> m_arrSubsetShapeOffsets;
+		std::uint32_t m_uNumSubsetShapes;
+
+		double m_arrOrigin[3];
+		std::uint32_t m_uWorldPositionIdx;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
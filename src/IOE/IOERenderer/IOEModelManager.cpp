@@ -6,8 +6,12 @@
 #include <IOE/IOEExceptions/IOEException_Renderer.h>
 #include <IOE/IOEApplication/IOEApplication.h>
 
+#include <tbb/parallel_for.h>
+
 #include "IOEModelManager.h"
 #include "IOEModel.h"
+#include "IOERPI.h"
+#include "IOEStateCache.h"
 #include "IOEVisibilityBounds.h"
 
 //////////////////////////////////////////////////////////////////////////
@@ -31,10 +35,20 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	namespace
+	{
+		// Below this many subsets a single thread queues faster
+		const std::uint32_t g_uQueueParallelThreshold = 1024;
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
 	IOEModelManager::IOEModelManager()
 		: IOEManager("IOEModelManager")
 		, m_pManager(nullptr)
 		, m_pGeometryConverter(nullptr)
+		, m_uHierarchyEpoch(0)
+		, m_uBoundsEpoch(0)
 	{
 	}
 
@@ -87,8 +101,18 @@ namespace Renderer
 	{
 		auto pPtr = std::make_shared<IOEModel>(szPath, szPassword);
 		pPtr->Load(this);
-		m_arrModels.push_back(pPtr);
-		return pPtr;
+		return AddModel(pPtr);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	shared_ptr<IOEModel>
+	IOEModelManager::AddModel(const shared_ptr<IOEModel> &pModel)
+	{
+		pModel->SetWorldPositionIndex(
+			m_tWorldPositions.Add(pModel->GetOrigin()));
+		m_arrModels.push_back(pModel);
+		return pModel;
 	}
 
 	//////////////////////////////////////////////////////////////////////////}
@@ -121,9 +145,261 @@ namespace Renderer
 	{
 		for (std::uint32_t uIdx(0); uIdx < rBounds.GetNumModels(); ++uIdx)
 		{
-			IOEVisbilityModel &rModel(rBounds.GetModel(uIdx));
-			rModel.pModel->OnRender(pRPI, rModel.pHead, bSetShaderParams);
+			const IOEVisibleModel &rModel(rBounds.GetModel(uIdx));
+			rModel.pModel->OnRender(pRPI,
+									rBounds.GetVisibleSubsets() + rModel.uFirst,
+									rModel.uCount, bSetShaderParams);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEModelManager::QueueModels(IOERenderQueue &rQueue,
+									  const Maths::IOECamera &rCamera,
+									  const IOEVisibilityBounds &rBounds,
+									  IOEStateCache &rPipelines,
+									  const IOEPipelineDescription &rPassStates,
+									  EViewport eViewport /*=Viewport0*/,
+									  std::uint8_t uLayer /*=0*/)
+	{
+		// Interning is render thread only, so every pipeline is found
+		// before any worker queues. Models sharing a material are often
+		// adjacent, so only a change of material is looked up.
+		const std::uint32_t uNumModels(rBounds.GetNumModels());
+		m_arrQueuePipelineIDs.resize(uNumModels);
+		IOEPipelineDescription tPipeline(rPassStates);
+		const IOEMaterial *pLastMaterial(nullptr);
+		std::uint32_t uPipelineID(0);
+		for (std::uint32_t uIdx(0); uIdx < uNumModels; ++uIdx)
+		{
+			const IOEMaterial *pMaterial(
+				rBounds.GetModel(uIdx).pModel->GetMaterial());
+			IOE_ASSERT(pMaterial != nullptr,
+					   "Material must be set before model can be rendered");
+			if (pMaterial != pLastMaterial)
+			{
+				tPipeline.SetMaterial(*pMaterial);
+				uPipelineID   = rPipelines.GetPipelineID(tPipeline);
+				pLastMaterial = pMaterial;
+			}
+			m_arrQueuePipelineIDs[uIdx] = uPipelineID;
+		}
+
+		// Depth runs from the near plane to the far plane, both facing
+		// into the frustum. The planes are moved to the frame's origin,
+		// which the render offsets are relative to.
+		float fViewX, fViewY, fViewZ;
+		GetViewOffset(rCamera, fViewX, fViewY, fViewZ);
+		Maths::IOEFrustumPlanes tPlanes(rCamera.GetFrustumPlanes());
+		tPlanes.Offset(fViewX, fViewY, fViewZ);
+		const std::uint32_t uNear(Maths::EFrustumPlane::Near);
+		const std::uint32_t uFar(Maths::EFrustumPlane::Far);
+
+		auto QueueModel = [&](std::uint32_t uIdx) {
+			const IOEVisibleModel &rModel(rBounds.GetModel(uIdx));
+			const IOEModel *pModel(rModel.pModel);
+			const std::uint32_t uModelPipelineID(m_arrQueuePipelineIDs[uIdx]);
+
+			float fOffsetX, fOffsetY, fOffsetZ;
+			pModel->GetRenderOffset(fOffsetX, fOffsetY, fOffsetZ);
+
+			const IOEAABBArray &rSubsetBounds(pModel->GetSubsetBounds());
+			const std::uint32_t *pSubsets(rBounds.GetVisibleSubsets() +
+										  rModel.uFirst);
+			for (std::uint32_t uSubsetIdx(0); uSubsetIdx < rModel.uCount;
+				 ++uSubsetIdx)
+			{
+				const std::uint32_t uSubset(pSubsets[uSubsetIdx]);
+				const float fX(rSubsetBounds.pCentreX[uSubset] + fOffsetX);
+				const float fY(rSubsetBounds.pCentreY[uSubset] + fOffsetY);
+				const float fZ(rSubsetBounds.pCentreZ[uSubset] + fOffsetZ);
+
+				const float fNear(tPlanes.arrNormalX[uNear] * fX +
+								  tPlanes.arrNormalY[uNear] * fY +
+								  tPlanes.arrNormalZ[uNear] * fZ +
+								  tPlanes.arrDistance[uNear]);
+				const float fFar(tPlanes.arrNormalX[uFar] * fX +
+								 tPlanes.arrNormalY[uFar] * fY +
+								 tPlanes.arrNormalZ[uFar] * fZ +
+								 tPlanes.arrDistance[uFar]);
+				const float fRange(fNear + fFar);
+
+				IOERenderQueueItem tItem;
+				tItem.SetRenderCommandID(
+					ERenderMode::Normal, eViewport, uLayer, false,
+					IOERenderQueueItem::QuantiseDepth(
+						fRange > 0.0f ? fNear / fRange : 0.0f, false),
+					uModelPipelineID);
+				rQueue.Add(tItem, rModel.pModel, uSubset);
+			}
+		};
+
+		if (rBounds.GetNumVisibleMeshes() >= g_uQueueParallelThreshold)
+		{
+			tbb::parallel_for(std::uint32_t(0), uNumModels, QueueModel);
+		}
+		else
+		{
+			for (std::uint32_t uIdx(0); uIdx < uNumModels; ++uIdx)
+			{
+				QueueModel(uIdx);
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	const Maths::IOEBVH &IOEModelManager::GetSubsetHierarchy()
+	{
+		if (m_arrFirstSubsetRef.size() != m_arrModels.size() + 1)
+		{
+			BuildSubsetHierarchy();
+			return m_tSubsetHierarchy;
+		}
+
+		bool bMoved(false);
+		for (std::uint32_t uModelIdx(0); uModelIdx < m_arrModels.size();
+			 ++uModelIdx)
+		{
+			float arrOffset[3];
+			GetModelRenderOffset(uModelIdx, arrOffset[0], arrOffset[1],
+								 arrOffset[2]);
+
+			float *pLastOffset(&m_arrHierarchyOffsets[uModelIdx * 3]);
+			if (pLastOffset[0] == arrOffset[0] &&
+				pLastOffset[1] == arrOffset[1] && pLastOffset[2] == arrOffset[2])
+			{
+				continue;
+			}
+			pLastOffset[0] = arrOffset[0];
+			pLastOffset[1] = arrOffset[1];
+			pLastOffset[2] = arrOffset[2];
+
+			// Everything moved this call shares the next bounds epoch
+			m_arrModelMovedEpochs[uModelIdx] = m_uBoundsEpoch + 1;
+			bMoved							 = true;
+
+			// Only the placement changes, the subsets keep their extents
+			const Maths::IOEAABBArray &rBounds(
+				m_arrModels[uModelIdx]->GetSubsetBounds());
+			for (std::uint32_t uSubsetIdx(0); uSubsetIdx < rBounds.uCount;
+				 ++uSubsetIdx)
+			{
+				const float arrCentre[3] = {
+					rBounds.pCentreX[uSubsetIdx] + arrOffset[0],
+					rBounds.pCentreY[uSubsetIdx] + arrOffset[1],
+					rBounds.pCentreZ[uSubsetIdx] + arrOffset[2]};
+				const float arrExtent[3] = {rBounds.pExtentX[uSubsetIdx],
+											rBounds.pExtentY[uSubsetIdx],
+											rBounds.pExtentZ[uSubsetIdx]};
+				m_tSubsetHierarchy.SetBounds(
+					m_arrFirstSubsetRef[uModelIdx] + uSubsetIdx, arrCentre,
+					arrExtent);
+			}
+		}
+
+		if (bMoved)
+		{
+			++m_uBoundsEpoch;
+		}
+
+		m_tSubsetHierarchy.Update();
+		return m_tSubsetHierarchy;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEModelManager::GetItemsMovedSince(
+		std::uint32_t uBoundsEpoch, std::vector<std::uint32_t> &rItems) const
+	{
+		for (std::uint32_t uModelIdx(0);
+			 uModelIdx < m_arrModelMovedEpochs.size(); ++uModelIdx)
+		{
+			if (m_arrModelMovedEpochs[uModelIdx] <= uBoundsEpoch)
+			{
+				continue;
+			}
+
+			for (std::uint32_t uItem(m_arrFirstSubsetRef[uModelIdx]);
+				 uItem < m_arrFirstSubsetRef[uModelIdx + 1]; ++uItem)
+			{
+				rItems.push_back(uItem);
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEModelManager::BuildSubsetHierarchy()
+	{
+		m_arrSubsetRefs.clear();
+		m_arrFirstSubsetRef.clear();
+		m_arrHierarchyOffsets.resize(m_arrModels.size() * 3);
+
+		for (std::uint32_t uModelIdx(0); uModelIdx < m_arrModels.size();
+			 ++uModelIdx)
+		{
+			m_arrFirstSubsetRef.push_back(
+				static_cast<std::uint32_t>(m_arrSubsetRefs.size()));
+
+			IOESubsetRef tRef;
+			tRef.uModelIdx = uModelIdx;
+			for (tRef.uSubsetIdx = 0;
+				 tRef.uSubsetIdx <
+				 m_arrModels[uModelIdx]->GetSubsetBounds().uCount;
+				 ++tRef.uSubsetIdx)
+			{
+				m_arrSubsetRefs.push_back(tRef);
+			}
 		}
+		m_arrFirstSubsetRef.push_back(
+			static_cast<std::uint32_t>(m_arrSubsetRefs.size()));
+
+		// Gather every subset's bounds, moved to its model's placement
+		const std::uint32_t uNumItems(
+			static_cast<std::uint32_t>(m_arrSubsetRefs.size()));
+		std::vector<float> arrData(uNumItems * 6);
+		float *pData(arrData.data());
+
+		for (std::uint32_t uModelIdx(0); uModelIdx < m_arrModels.size();
+			 ++uModelIdx)
+		{
+			float *pOffset(&m_arrHierarchyOffsets[uModelIdx * 3]);
+			GetModelRenderOffset(uModelIdx, pOffset[0], pOffset[1],
+								 pOffset[2]);
+
+			const Maths::IOEAABBArray &rBounds(
+				m_arrModels[uModelIdx]->GetSubsetBounds());
+			const std::uint32_t uFirst(m_arrFirstSubsetRef[uModelIdx]);
+			for (std::uint32_t uSubsetIdx(0); uSubsetIdx < rBounds.uCount;
+				 ++uSubsetIdx)
+			{
+				const std::uint32_t uItem(uFirst + uSubsetIdx);
+				pData[uItem] = rBounds.pCentreX[uSubsetIdx] + pOffset[0];
+				pData[uItem + uNumItems] =
+					rBounds.pCentreY[uSubsetIdx] + pOffset[1];
+				pData[uItem + uNumItems * 2] =
+					rBounds.pCentreZ[uSubsetIdx] + pOffset[2];
+				pData[uItem + uNumItems * 3] = rBounds.pExtentX[uSubsetIdx];
+				pData[uItem + uNumItems * 4] = rBounds.pExtentY[uSubsetIdx];
+				pData[uItem + uNumItems * 5] = rBounds.pExtentZ[uSubsetIdx];
+			}
+		}
+
+		Maths::IOEAABBArray tBoxes;
+		tBoxes.pCentreX = pData;
+		tBoxes.pCentreY = pData + uNumItems;
+		tBoxes.pCentreZ = pData + uNumItems * 2;
+		tBoxes.pExtentX = pData + uNumItems * 3;
+		tBoxes.pExtentY = pData + uNumItems * 4;
+		tBoxes.pExtentZ = pData + uNumItems * 5;
+		tBoxes.uCount	= uNumItems;
+
+		m_tSubsetHierarchy.Build(tBoxes);
+
+		// Item numbers have changed so nothing cached can be patched up
+		++m_uHierarchyEpoch;
+		m_arrModelMovedEpochs.assign(m_arrModels.size(), m_uBoundsEpoch);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -138,5 +414,14 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	void IOEModelManager::OnPreRender(IOE::Renderer::IOERPI *pRPI)
+	{
+		// The application has moved and recentred its camera by now, and
+		// the RPI renders from a copy of it
+		RebaseModels(pRPI->GetDefaultCamera());
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 } // namespace Renderer
 } // namespace IOE
\ No newline at end of file
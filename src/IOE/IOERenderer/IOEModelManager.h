@@ -8,6 +8,11 @@
 #include <fbxsdk.h>
 
 #include <IOE/IOECore/IOEManager.h>
+#include <IOE/IOEMaths/BVH.h>
+#include <IOE/IOEMaths/Camera.h>
+#include <IOE/IOEMaths/LargeWorld.h>
+#include <IOE/IOEMaths/VectorD.h>
+#include <IOE/IOERenderer/IOERenderQueue.h>
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -20,6 +25,8 @@ namespace Renderer
 
 	class IOEModel;
 	class IOERPI;
+	class IOEStateCache;
+	struct IOEPipelineDescription;
 
 	using std::shared_ptr;
 	using std::weak_ptr;
@@ -27,6 +34,14 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	struct IOESubsetRef
+	{
+		std::uint32_t uModelIdx;
+		std::uint32_t uSubsetIdx;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
 	class IOEModelManager : public IOE::Core::IOEManager<IOEModelManager>
 	{
 	public:
@@ -36,9 +51,16 @@ namespace Renderer
 		virtual void OnUpdate(IOE::Core::IOETimeDelta TimeDelta) override;
 		virtual void OnDestroy() override;
 
+		// Rebases the models against the main view, the RPI's default
+		// camera, once at the start of each frame's rendering
+		virtual void OnPreRender(IOE::Renderer::IOERPI *pRPI) override;
+
 	public:
 		shared_ptr<IOEModel> LoadModel(const std::wstring &szPath,
 									   const std::string &szPassword = "");
+		// Places and culls a model loaded elsewhere, such as from memory,
+		// alongside the ones loaded from files
+		shared_ptr<IOEModel> AddModel(const shared_ptr<IOEModel> &pModel);
 
 		FbxManager *GetFbxManager()
 		{
@@ -76,6 +98,84 @@ namespace Renderer
 			m_arrToRender.push_back(pModel);
 		}
 
+		// Double precision placement of each model, indexed as GetModel
+		void SetModelWorldPosition(std::uint32_t uIdx,
+								   const Maths::IOEVectorD &vPosition)
+		{
+			m_tWorldPositions.Set(uIdx, vPosition);
+		}
+		Maths::IOEVectorD GetModelWorldPosition(std::uint32_t uIdx) const
+		{
+			return m_tWorldPositions.Get(uIdx);
+		}
+
+		// Offset from the frame's world origin, the origin of the last
+		// rebase. Moving a model updates its offset straight away.
+		void GetModelRenderOffset(std::uint32_t uIdx, float &fX, float &fY,
+								  float &fZ) const
+		{
+			m_tWorldPositions.GetRebased(uIdx, fX, fY, fZ);
+		}
+
+		// Rebases every model against the camera's world origin in one
+		// batched pass, which is skipped if the origin has not moved. Done
+		// by OnPreRender, so only code that draws outside the engine's
+		// frame needs to call it.
+		void RebaseModels(const Maths::IOECamera &rCamera)
+		{
+			m_tWorldPositions.Rebase(rCamera.GetWorldOrigin());
+		}
+
+		Maths::IOEVectorD GetWorldOrigin() const
+		{
+			return m_tWorldPositions.GetOrigin();
+		}
+
+		// What to add to a render offset to place the model relative to
+		// rCamera's world origin rather than the frame's. Zero for the main
+		// view, and for any camera sharing its origin.
+		void GetViewOffset(const Maths::IOECamera &rCamera, float &fX,
+						   float &fY, float &fZ) const
+		{
+			double dX, dY, dZ;
+			(GetWorldOrigin() - rCamera.GetWorldOrigin()).Get(dX, dY, dZ);
+			fX = static_cast<float>(dX);
+			fY = static_cast<float>(dY);
+			fZ = static_cast<float>(dZ);
+		}
+
+		// Every subset of every model in one hierarchy, placed relative to
+		// the camera's world origin as of the last rebase. Rebuilt when
+		// models are loaded and refit when they move.
+		const Maths::IOEBVH &GetSubsetHierarchy();
+
+		// Items of the subset hierarchy are numbered model by model in
+		// subset order
+		const IOESubsetRef &GetSubsetRef(std::uint32_t uItem) const
+		{
+			return m_arrSubsetRefs[uItem];
+		}
+
+		// Epochs let cached visibility tell what changed since it was
+		// computed. The hierarchy epoch advances when items are renumbered,
+		// which invalidates any cached item. The bounds epoch advances once
+		// per GetSubsetHierarchy that moves anything, and each model records
+		// the bounds epoch it last moved in. Only valid after a call to
+		// GetSubsetHierarchy.
+		std::uint32_t GetHierarchyEpoch() const
+		{
+			return m_uHierarchyEpoch;
+		}
+		std::uint32_t GetBoundsEpoch() const
+		{
+			return m_uBoundsEpoch;
+		}
+
+		// Appends, in item order, every hierarchy item of a model that has
+		// moved since uBoundsEpoch
+		void GetItemsMovedSince(std::uint32_t uBoundsEpoch,
+								std::vector<std::uint32_t> &rItems) const;
+
 	public:
 		void RenderAllModels(IOE::Renderer::IOERPI *pRPI,
 							 bool bSetShaderParams = true);
@@ -83,6 +183,19 @@ namespace Renderer
 							 class IOEVisibilityBounds &rBounds,
 							 bool bSetShaderParams = true);
 
+		// Adds a draw of every visible subset to rQueue, keyed by its depth
+		// from rCamera and by the ID rPipelines gives the pipeline of its
+		// material under the states of rPassStates. Pipelines are resolved
+		// on the calling thread, then large sets are submitted from the
+		// TBB worker threads.
+		void QueueModels(IOERenderQueue &rQueue,
+						 const Maths::IOECamera &rCamera,
+						 const class IOEVisibilityBounds &rBounds,
+						 IOEStateCache &rPipelines,
+						 const IOEPipelineDescription &rPassStates,
+						 EViewport eViewport = EViewport::Viewport0,
+						 std::uint8_t uLayer = 0);
+
 	public:
 		bool IsValidFileVersion(FbxImporter *pImporter) const;
 
@@ -93,6 +206,21 @@ namespace Renderer
 		class FbxGeometryConverter *m_pGeometryConverter;
 		vector<shared_ptr<IOEModel> > m_arrModels;
 		vector<weak_ptr<IOEModel> > m_arrToRender;
+		Maths::IOEWorldPositionArray m_tWorldPositions;
+
+		void BuildSubsetHierarchy();
+
+		Maths::IOEBVH m_tSubsetHierarchy;
+		vector<IOESubsetRef> m_arrSubsetRefs;
+		vector<std::uint32_t> m_arrFirstSubsetRef;
+		vector<float> m_arrHierarchyOffsets;
+
+		std::uint32_t m_uHierarchyEpoch;
+		std::uint32_t m_uBoundsEpoch;
+		vector<std::uint32_t> m_arrModelMovedEpochs;
+
+		// Pipeline of each visible model, by its index in the bounds
+		vector<std::uint32_t> m_arrQueuePipelineIDs;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include <IOE/IOECore/IOEDefines.h>
 
 namespace IOE
@@ -24,8 +26,13 @@ namespace Renderer
 		virtual void OnRender(class IOERPI * pRPI,
 							  bool bSetShaderVariables = true) = 0;
 		virtual void OnRender(class IOERPI * pRPI,
-							  struct IOEVisibilityLink * pHead,
+							  const std::uint32_t *pSubsets,
+							  std::uint32_t uNumSubsets,
 							  bool bSetShaderVariables = true) = 0;
+		// Draws uNumInstances copies of one subset with a single call
+		virtual void OnRenderInstanced(class IOERPI * pRPI,
+									   std::uint32_t uSubset,
+									   std::uint32_t uNumInstances) = 0;
 		virtual void OnSetup(class IOERPI * pRPI) = 0;
 
 	protected:
@@ -0,0 +1,191 @@
+#include <algorithm>
+
+#include <IOE/IOEMaths/VectorD.h>
+
+#include <IOE/IOERenderer/IOEModelManager.h>
+
+#include "IOEMultiViewVisibility.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		bool ItemLess(const IOEMultiViewObject &lhs,
+					  const IOEMultiViewObject &rhs)
+		{
+			return lhs.uItem < rhs.uItem;
+		}
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEMultiViewVisibility::IOEMultiViewVisibility()
+		: m_uResultEpoch(0)
+		, m_bCacheValid(false)
+		, m_uCachedHierarchyEpoch(0)
+		, m_uCachedBoundsEpoch(0)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMultiViewVisibility::ClearViews()
+	{
+		m_tViews.Clear();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t
+	IOEMultiViewVisibility::AddView(const Maths::IOECamera &rCamera)
+	{
+		// Move the planes from this camera's origin to the frame's
+		float fX, fY, fZ;
+		IOEModelManager::GetSingletonPtr()->GetViewOffset(rCamera, fX, fY,
+														   fZ);
+
+		Maths::IOEFrustumPlanes tPlanes(rCamera.GetFrustumPlanes());
+		tPlanes.Offset(fX, fY, fZ);
+		return m_tViews.Add(tPlanes);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t
+	IOEMultiViewVisibility::AddView(const Maths::IOEFrustumPlanes &rPlanes)
+	{
+		return m_tViews.Add(rPlanes);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t
+	IOEMultiViewVisibility::AddHalfSpace(const IOEVector &vOrigin,
+										 const IOEVector &vNormal)
+	{
+		float fNX, fNY, fNZ;
+		vNormal.Get(fNX, fNY, fNZ);
+
+		Maths::IOEFrustumPlanes tPlanes;
+		tPlanes.SetPlane(Maths::EFrustumPlane::Near, fNX, fNY, fNZ,
+						 -vOrigin.Dot(vNormal));
+		return m_tViews.Add(tPlanes, 1u << Maths::EFrustumPlane::Near);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEMultiViewVisibility::UpdateVisibility()
+	{
+		IOEModelManager *pManager(IOEModelManager::GetSingletonPtr());
+		const Maths::IOEBVH &rHierarchy(pManager->GetSubsetHierarchy());
+
+		++m_tCacheStats.uUpdates;
+		if (m_bCacheValid &&
+			m_uCachedHierarchyEpoch == pManager->GetHierarchyEpoch() &&
+			m_tCachedViews == m_tViews)
+		{
+			if (m_uCachedBoundsEpoch == pManager->GetBoundsEpoch())
+			{
+				++m_tCacheStats.uReused;
+				m_tCullStats				= Maths::IOEBVHCullStats();
+				m_tCullStats.uItemsVisible = GetNumVisibleObjects();
+				return;
+			}
+
+			if (Patch(rHierarchy))
+			{
+				++m_tCacheStats.uPatched;
+				m_uCachedBoundsEpoch = pManager->GetBoundsEpoch();
+				++m_uResultEpoch;
+				return;
+			}
+		}
+
+		m_arrItems.clear();
+		m_arrViewMasks.clear();
+		rHierarchy.CullViews(m_tViews, m_tViews.GetAllViewsMask(), m_arrItems,
+							 m_arrViewMasks, &m_tCullStats);
+
+		m_arrObjects.resize(m_arrItems.size());
+		for (std::size_t uIdx(0); uIdx < m_arrItems.size(); ++uIdx)
+		{
+			m_arrObjects[uIdx].uItem	 = m_arrItems[uIdx];
+			m_arrObjects[uIdx].uViewMask = m_arrViewMasks[uIdx];
+		}
+
+		// Item order groups each model's subsets together in draw order,
+		// so per view results come out ready to render
+		std::sort(m_arrObjects.begin(), m_arrObjects.end(), ItemLess);
+
+		m_bCacheValid			= true;
+		m_tCachedViews			= m_tViews;
+		m_uCachedHierarchyEpoch = pManager->GetHierarchyEpoch();
+		m_uCachedBoundsEpoch	= pManager->GetBoundsEpoch();
+		++m_uResultEpoch;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEMultiViewVisibility::Patch(const Maths::IOEBVH &rHierarchy)
+	{
+		m_arrMovedItems.clear();
+		IOEModelManager::GetSingletonPtr()->GetItemsMovedSince(
+			m_uCachedBoundsEpoch, m_arrMovedItems);
+		if (m_arrMovedItems.size() * IOEVisibilityBounds::ms_uPatchLimit >
+			rHierarchy.GetNumItems())
+		{
+			return false;
+		}
+
+		// Drop the moved subsets, keeping the rest in item order
+		m_arrObjects.erase(
+			std::remove_if(m_arrObjects.begin(), m_arrObjects.end(),
+						   [this](const IOEMultiViewObject &rObject) {
+							   return std::binary_search(m_arrMovedItems.begin(),
+														 m_arrMovedItems.end(),
+														 rObject.uItem);
+						   }),
+			m_arrObjects.end());
+		const std::size_t uNumKept(m_arrObjects.size());
+
+		// Moved items come out in item order too, so one merge restores it
+		const std::uint64_t uAllViews(m_tViews.GetAllViewsMask());
+		for (std::uint32_t uItem : m_arrMovedItems)
+		{
+			float arrCentre[3], arrExtent[3];
+			rHierarchy.GetBounds(uItem, arrCentre, arrExtent);
+
+			std::uint64_t uInside;
+			IOEMultiViewObject tObject;
+			tObject.uItem = uItem;
+			tObject.uViewMask =
+				m_tViews.Classify(arrCentre, arrExtent, uAllViews, uInside);
+			if (tObject.uViewMask != 0)
+			{
+				m_arrObjects.push_back(tObject);
+			}
+		}
+		std::inplace_merge(m_arrObjects.begin(),
+						   m_arrObjects.begin() + uNumKept, m_arrObjects.end(),
+						   ItemLess);
+
+		const std::uint32_t uNumMoved(
+			static_cast<std::uint32_t>(m_arrMovedItems.size()));
+		m_tCullStats				= Maths::IOEBVHCullStats();
+		m_tCullStats.uItemsTested	= uNumMoved;
+		m_tCullStats.uItemsVisible = GetNumVisibleObjects();
+		m_tCacheStats.uItemsRetested += uNumMoved;
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
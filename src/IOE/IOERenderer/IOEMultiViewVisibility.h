@@ -0,0 +1,140 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <vector>
+
+#include <IOE/IOECore/IOEDefines.h>
+#include <IOE/IOEMaths/BVH.h>
+#include <IOE/IOEMaths/Camera.h>
+#include <IOE/IOEMaths/FrustumSet.h>
+#include <IOE/IOEMaths/Vector.h>
+
+#include <IOE/IOERenderer/IOEVisibilityBounds.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Subset visible in at least one view, with a bit set for each view
+	struct IOEMultiViewObject
+	{
+		std::uint32_t uItem;
+		std::uint64_t uViewMask;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Culls the scene against up to 64 views at once, e.g. the faces of a
+	// cube map, both halves of a paraboloid map, the main camera and the
+	// ray bundle cameras. The subset hierarchy is walked once and each
+	// node is tested against four views per SSE instruction, dropping
+	// views as soon as they are decided, so extra views add plane tests
+	// rather than whole traversals.
+	//
+	// Views are relative to the world origin of the first camera added.
+	// Later cameras with a different world origin are moved into that
+	// space, and half spaces are given in it.
+	//
+	// Views may be cleared and added again every update. If they come out
+	// the same as last time the previous result is reused, or patched when
+	// only some models have moved, as IOEVisibilityBounds does.
+	class IOEMultiViewVisibility
+	{
+	public:
+		IOEMultiViewVisibility();
+
+	public:
+		void ClearViews();
+
+		// Each returns the view's bit index. A camera's planes are moved to
+		// the frame's world origin as it is when the view is added, and raw
+		// planes must already be relative to it.
+		std::uint32_t AddView(const Maths::IOECamera &rCamera);
+		std::uint32_t AddView(const Maths::IOEFrustumPlanes &rPlanes);
+
+		// Everything with any part in front of the plane through vOrigin,
+		// as used for each half of a dual paraboloid map
+		std::uint32_t AddHalfSpace(const IOEVector &vOrigin,
+								   const IOEVector &vNormal);
+
+		FORCEINLINE std::uint32_t GetNumViews() const
+		{
+			return m_tViews.GetNumViews();
+		}
+
+		// Culls every view in one traversal, unless the cached result can
+		// be reused
+		void UpdateVisibility();
+
+		// Advances whenever the visible objects change
+		FORCEINLINE std::uint32_t GetResultEpoch() const
+		{
+			return m_uResultEpoch;
+		}
+
+		// Subsets seen by any view, in hierarchy item order. A single
+		// view's results are read back with
+		// IOEVisibilityBounds::UpdateVisibility(*this, uView).
+		FORCEINLINE std::uint32_t GetNumVisibleObjects() const
+		{
+			return static_cast<std::uint32_t>(m_arrObjects.size());
+		}
+		FORCEINLINE const IOEMultiViewObject &GetVisibleObject(
+			std::uint32_t uIdx) const
+		{
+			return m_arrObjects[uIdx];
+		}
+
+		FORCEINLINE const Maths::IOEBVHCullStats &GetCullStats() const
+		{
+			return m_tCullStats;
+		}
+
+		FORCEINLINE const IOEVisibilityCacheStats &GetCacheStats() const
+		{
+			return m_tCacheStats;
+		}
+		void ResetCacheStats()
+		{
+			m_tCacheStats = IOEVisibilityCacheStats();
+		}
+
+		// Forces the next update to cull from scratch
+		void InvalidateCache()
+		{
+			m_bCacheValid = false;
+		}
+
+	private:
+		bool Patch(const Maths::IOEBVH &rHierarchy);
+
+	private:
+		Maths::IOEFrustumSet m_tViews;
+
+		std::vector<std::uint32_t> m_arrItems;
+		std::vector<std::uint64_t> m_arrViewMasks;
+		std::vector<IOEMultiViewObject> m_arrObjects;
+		Maths::IOEBVHCullStats m_tCullStats;
+		std::uint32_t m_uResultEpoch;
+
+		// Views and scene state behind the current result
+		bool m_bCacheValid;
+		Maths::IOEFrustumSet m_tCachedViews;
+		std::uint32_t m_uCachedHierarchyEpoch;
+		std::uint32_t m_uCachedBoundsEpoch;
+
+		std::vector<std::uint32_t> m_arrMovedItems;
+		IOEVisibilityCacheStats m_tCacheStats;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,185 @@
+#include <algorithm>
+
+#include <IOE/IOERenderer/IOEModelManager.h>
+
+#include "IOEOcclusionCulling.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		// Defaults keep the fill cost to well under a millisecond
+		const std::uint32_t g_uDefaultMaxOccluders = 64;
+		const float g_fDefaultMinScreenArea		= 0.01f;
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEOcclusionCulling::IOEOcclusionCulling(std::uint32_t uWidth /*=256*/,
+											 std::uint32_t uHeight /*=128*/)
+		: m_tBuffer(uWidth, uHeight)
+		, m_uMaxOccluders(g_uDefaultMaxOccluders)
+		, m_fMinScreenArea(g_fDefaultMinScreenArea)
+		, m_uNumTested(0)
+		, m_uNumRejected(0)
+		, m_uNumOccluders(0)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEOcclusionCulling::SetOccluderLimits(std::uint32_t uMaxOccluders,
+												float fMinScreenArea)
+	{
+		m_uMaxOccluders  = uMaxOccluders;
+		m_fMinScreenArea = fMinScreenArea;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEOcclusionCulling::SetProxy(std::uint32_t uModelIdx,
+									   const float *pPositions,
+									   std::uint32_t uNumVertices,
+									   const std::int32_t *pIndices,
+									   std::uint32_t uNumIndices)
+	{
+		if (uModelIdx >= m_arrProxies.size())
+		{
+			m_arrProxies.resize(uModelIdx + 1);
+		}
+
+		Proxy &rProxy(m_arrProxies[uModelIdx]);
+		rProxy.arrPositions.assign(pPositions, pPositions + uNumVertices * 3);
+		rProxy.arrIndices.assign(pIndices, pIndices + uNumIndices);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEOcclusionCulling::ClearProxies()
+	{
+		m_arrProxies.clear();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEOcclusionCulling::Cull(const Maths::IOECamera &rCamera,
+								   IOEVisibilityBounds &rBounds)
+	{
+		float arrViewProjection[16];
+		rCamera.GetViewProjection(arrViewProjection);
+
+		// Occluders are placed relative to the frame's origin, so fold the
+		// move to the camera's origin into the translation row
+		float arrView[3];
+		IOEModelManager::GetSingletonPtr()->GetViewOffset(
+			rCamera, arrView[0], arrView[1], arrView[2]);
+		for (std::uint32_t uCol(0); uCol < 4; ++uCol)
+		{
+			arrViewProjection[12 + uCol] +=
+				arrView[0] * arrViewProjection[uCol] +
+				arrView[1] * arrViewProjection[4 + uCol] +
+				arrView[2] * arrViewProjection[8 + uCol];
+		}
+
+		m_tBuffer.Begin(arrViewProjection);
+		AddOccluders(rBounds);
+		m_tBuffer.Rasterise();
+
+		rBounds.RemoveOccluded(m_tBuffer);
+		m_uNumTested   = rBounds.GetNumVisibleItems();
+		m_uNumRejected = rBounds.GetNumOccluded();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEOcclusionCulling::AddOccluders(const IOEVisibilityBounds &rBounds)
+	{
+		IOEModelManager *pManager(IOEModelManager::GetSingletonPtr());
+		const Maths::IOEBVH &rHierarchy(pManager->GetSubsetHierarchy());
+
+		// Screen area of every frustum visible subset, largest first
+		m_arrCandidates.clear();
+		const std::uint32_t *pItems(rBounds.GetVisibleItems());
+		for (std::uint32_t uIdx(0); uIdx < rBounds.GetNumVisibleItems();
+			 ++uIdx)
+		{
+			float arrCentre[3], arrExtent[3];
+			rHierarchy.GetBounds(pItems[uIdx], arrCentre, arrExtent);
+
+			Candidate tCandidate;
+			tCandidate.fArea = m_tBuffer.GetScreenArea(arrCentre, arrExtent);
+			tCandidate.uItem = pItems[uIdx];
+			if (tCandidate.fArea >= m_fMinScreenArea)
+			{
+				m_arrCandidates.push_back(tCandidate);
+			}
+		}
+
+		const std::size_t uNumOccluders(std::min<std::size_t>(
+			m_uMaxOccluders, m_arrCandidates.size()));
+		std::partial_sort(m_arrCandidates.begin(),
+						  m_arrCandidates.begin() + uNumOccluders,
+						  m_arrCandidates.end(),
+						  [](const Candidate &lhs, const Candidate &rhs) {
+							  return lhs.fArea > rhs.fArea;
+						  });
+
+		m_arrModelAdded.assign(pManager->GetNumModels(), 0);
+		m_uNumOccluders = 0;
+		for (std::size_t uIdx(0); uIdx < uNumOccluders; ++uIdx)
+		{
+			const IOESubsetRef &rRef(
+				pManager->GetSubsetRef(m_arrCandidates[uIdx].uItem));
+
+			float arrOffset[3];
+			pManager->GetModelRenderOffset(rRef.uModelIdx, arrOffset[0],
+										   arrOffset[1], arrOffset[2]);
+
+			// A proxy stands in for all of its model's subsets at once
+			if (rRef.uModelIdx < m_arrProxies.size() &&
+				!m_arrProxies[rRef.uModelIdx].arrIndices.empty())
+			{
+				if (m_arrModelAdded[rRef.uModelIdx] != 0)
+				{
+					continue;
+				}
+				m_arrModelAdded[rRef.uModelIdx] = 1;
+
+				const Proxy &rProxy(m_arrProxies[rRef.uModelIdx]);
+				m_tBuffer.AddOccluder(
+					rProxy.arrPositions.data(), sizeof(float) * 3,
+					rProxy.arrIndices.data(),
+					static_cast<std::uint32_t>(rProxy.arrIndices.size()),
+					arrOffset);
+				++m_uNumOccluders;
+				continue;
+			}
+
+			const IOEModel *pModel(pManager->GetModel(rRef.uModelIdx));
+			const MeshIndex &rSubset(pModel->GetSubset(rRef.uSubsetIdx));
+			const std::vector<ModelVertex> &rVertices(
+				pModel->GetVertexBuffer());
+			const std::vector<std::int32_t> &rIndices(
+				pModel->GetIndexBuffer());
+
+			m_tBuffer.AddOccluder(&rVertices[0].m_vPosition.x,
+								  sizeof(ModelVertex),
+								  &rIndices[rSubset.m_nStartIdx],
+								  static_cast<std::uint32_t>(
+									  rSubset.m_nNumIndices),
+								  arrOffset);
+			++m_uNumOccluders;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
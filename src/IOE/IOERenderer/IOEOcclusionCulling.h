@@ -0,0 +1,121 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <vector>
+
+#include <IOE/IOECore/IOEDefines.h>
+#include <IOE/IOEMaths/Camera.h>
+#include <IOE/IOEMaths/OcclusionBuffer.h>
+
+#include <IOE/IOERenderer/IOEVisibilityBounds.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Removes subsets hidden behind others from a view's frustum result.
+	// The subsets covering the most screen are drawn into a small software
+	// depth buffer as occluders, then every frustum visible subset is tested
+	// against it. Models with a low polygon proxy are drawn as that instead
+	// of their own subsets. Runs entirely on the CPU, so results are ready
+	// the same frame.
+	class IOEOcclusionCulling
+	{
+	public:
+		IOEOcclusionCulling(std::uint32_t uWidth = 256,
+							std::uint32_t uHeight = 128);
+
+	public:
+		// Occluders are the largest uMaxOccluders subsets covering at least
+		// fMinScreenArea of the screen
+		void SetOccluderLimits(std::uint32_t uMaxOccluders,
+							   float fMinScreenArea);
+
+		// Triangle list in the model's space, drawn in place of its subsets.
+		// It must lie inside the model or it will hide visible subsets.
+		void SetProxy(std::uint32_t uModelIdx, const float *pPositions,
+					  std::uint32_t uNumVertices, const std::int32_t *pIndices,
+					  std::uint32_t uNumIndices);
+		void ClearProxies();
+
+		// Draws the occluders for rCamera and removes the subsets they hide
+		// from rBounds, which must already be updated for the same camera
+		void Cull(const Maths::IOECamera &rCamera,
+				  IOEVisibilityBounds &rBounds);
+
+		FORCEINLINE const Maths::IOEOcclusionBuffer &GetBuffer() const
+		{
+			return m_tBuffer;
+		}
+
+		// Depth buffer from the last cull as a greyscale PGM image
+		bool DumpDepth(const char *szPath) const
+		{
+			return m_tBuffer.DumpDepth(szPath);
+		}
+
+		// Subsets tested and rejected by the last cull
+		FORCEINLINE std::uint32_t GetNumTested() const
+		{
+			return m_uNumTested;
+		}
+		FORCEINLINE std::uint32_t GetNumRejected() const
+		{
+			return m_uNumRejected;
+		}
+		FORCEINLINE std::uint32_t GetNumOccluders() const
+		{
+			return m_uNumOccluders;
+		}
+		float GetRejectedPercentage() const
+		{
+			return m_uNumTested > 0 ? 100.0f *
+										  static_cast<float>(m_uNumRejected) /
+										  static_cast<float>(m_uNumTested)
+									: 0.0f;
+		}
+
+	private:
+		struct Proxy
+		{
+			std::vector<float> arrPositions;
+			std::vector<std::int32_t> arrIndices;
+		};
+
+		struct Candidate
+		{
+			float fArea;
+			std::uint32_t uItem;
+		};
+
+	private:
+		void AddOccluders(const IOEVisibilityBounds &rBounds);
+
+	private:
+		Maths::IOEOcclusionBuffer m_tBuffer;
+
+		std::uint32_t m_uMaxOccluders;
+		float m_fMinScreenArea;
+
+		// Indexed by model, empty when the model has no proxy
+		std::vector<Proxy> m_arrProxies;
+
+		std::vector<Candidate> m_arrCandidates;
+		std::vector<std::uint8_t> m_arrModelAdded;
+
+		std::uint32_t m_uNumTested;
+		std::uint32_t m_uNumRejected;
+		std::uint32_t m_uNumOccluders;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
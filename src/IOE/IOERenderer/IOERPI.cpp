@@ -9,6 +9,7 @@
 
 #include <IOE/IOEApplication/IOEApplication.h>
 
+#include "IOEBuffer.h"
 #include "IOEModel.h"
 #include "IOEModelManager.h"
 #include "IOEShader.h"
@@ -26,6 +27,216 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	namespace
+	{
+		const std::uint64_t g_uHashBasis(14695981039346656037ULL);
+
+		// FNV-1a, folded a field at a time so struct padding never reaches
+		// the hash
+		template <typename T>
+		void HashCombine(std::uint64_t &ruHash, const T &rValue)
+		{
+			const std::uint8_t *pBytes(reinterpret_cast<const std::uint8_t *>(&rValue));
+			for (std::size_t uIdx(0); uIdx < sizeof(T); ++uIdx)
+			{
+				ruHash = (ruHash ^ pBytes[uIdx]) * 1099511628211ULL;
+			}
+		}
+
+		void HashCombine(std::uint64_t &ruHash, const IOE::Maths::IOEVector &rValue)
+		{
+			float fX, fY, fZ, fW;
+			rValue.Get(fX, fY, fZ, fW);
+			HashCombine(ruHash, fX);
+			HashCombine(ruHash, fY);
+			HashCombine(ruHash, fZ);
+			HashCombine(ruHash, fW);
+		}
+
+		// Zero is kept to mean a state that cannot be filtered
+		std::uint64_t FinishHash(std::uint64_t uHash)
+		{
+			return uHash != 0 ? uHash : 1;
+		}
+
+		// Exact, unlike IOEVector's own comparison
+		bool IsSameVector(const IOE::Maths::IOEVector &vLHS, const IOE::Maths::IOEVector &vRHS)
+		{
+			float arrLHS[4], arrRHS[4];
+			vLHS.Get(arrLHS[0], arrLHS[1], arrLHS[2], arrLHS[3]);
+			vRHS.Get(arrRHS[0], arrRHS[1], arrRHS[2], arrRHS[3]);
+			return arrLHS[0] == arrRHS[0] && arrLHS[1] == arrRHS[1] && arrLHS[2] == arrRHS[2] &&
+				   arrLHS[3] == arrRHS[3];
+		}
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint64_t IOERasterizerState::CalculateHash() const
+	{
+		std::uint64_t uHash(g_uHashBasis);
+		HashCombine(uHash, tData.eFillMode);
+		HashCombine(uHash, tData.eCullMode);
+		HashCombine(uHash, tData.bFrontCounterClockwise);
+		HashCombine(uHash, tData.nDepthBias);
+		HashCombine(uHash, tData.fDepthBiasClamp);
+		HashCombine(uHash, tData.fSlopeScaledDepthBias);
+		HashCombine(uHash, tData.bDepthClipEnable);
+		HashCombine(uHash, tData.bScissorEnable);
+		HashCombine(uHash, tData.bMultisampleEnable);
+		HashCombine(uHash, tData.bAntialiasedLineEnable);
+		return FinishHash(uHash);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERasterizerState::Setup(IOERPI *pRPI)
+	{
+		m_uHash = CalculateHash();
+		IOERasterizerState &rInterned(pRPI->GetStateCache().Intern(*this));
+		m_uID		= rInterned.m_uID;
+		m_pInterned = &rInterned;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOERasterizerState::HasSameDescription(const IOERasterizerState &rhs) const
+	{
+		return tData.eFillMode == rhs.tData.eFillMode && tData.eCullMode == rhs.tData.eCullMode &&
+			   tData.bFrontCounterClockwise == rhs.tData.bFrontCounterClockwise &&
+			   tData.nDepthBias == rhs.tData.nDepthBias && tData.fDepthBiasClamp == rhs.tData.fDepthBiasClamp &&
+			   tData.fSlopeScaledDepthBias == rhs.tData.fSlopeScaledDepthBias &&
+			   tData.bDepthClipEnable == rhs.tData.bDepthClipEnable &&
+			   tData.bScissorEnable == rhs.tData.bScissorEnable &&
+			   tData.bMultisampleEnable == rhs.tData.bMultisampleEnable &&
+			   tData.bAntialiasedLineEnable == rhs.tData.bAntialiasedLineEnable;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint64_t IOEBlendState::CalculateHash() const
+	{
+		std::uint64_t uHash(g_uHashBasis);
+		HashCombine(uHash, tData.bBlendEnable);
+		HashCombine(uHash, tData.eSrcBlend);
+		HashCombine(uHash, tData.eDestBlend);
+		HashCombine(uHash, tData.eBlendOp);
+		HashCombine(uHash, tData.eSrcBlendAlpha);
+		HashCombine(uHash, tData.eDestBlendAlpha);
+		HashCombine(uHash, tData.eBlendOpAlpha);
+		HashCombine(uHash, tData.nRenderTargetWriteMask);
+		return FinishHash(uHash);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEBlendState::Setup(IOERPI *pRPI)
+	{
+		m_uHash = CalculateHash();
+		IOEBlendState &rInterned(pRPI->GetStateCache().Intern(*this));
+		m_uID		= rInterned.m_uID;
+		m_pInterned = &rInterned;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEBlendState::HasSameDescription(const IOEBlendState &rhs) const
+	{
+		return tData.bBlendEnable == rhs.tData.bBlendEnable && tData.eSrcBlend == rhs.tData.eSrcBlend &&
+			   tData.eDestBlend == rhs.tData.eDestBlend && tData.eBlendOp == rhs.tData.eBlendOp &&
+			   tData.eSrcBlendAlpha == rhs.tData.eSrcBlendAlpha && tData.eDestBlendAlpha == rhs.tData.eDestBlendAlpha &&
+			   tData.eBlendOpAlpha == rhs.tData.eBlendOpAlpha &&
+			   tData.nRenderTargetWriteMask == rhs.tData.nRenderTargetWriteMask;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint64_t IOESamplerState::CalculateHash() const
+	{
+		std::uint64_t uHash(g_uHashBasis);
+		HashCombine(uHash, tData.eFilter);
+		HashCombine(uHash, tData.eAddressModeU);
+		HashCombine(uHash, tData.eAddressModeV);
+		HashCombine(uHash, tData.eAddressModeW);
+		HashCombine(uHash, tData.fLODBias);
+		HashCombine(uHash, tData.uMaxAnisotropy);
+		HashCombine(uHash, tData.eComparison);
+		HashCombine(uHash, tData.vBorderColour);
+		HashCombine(uHash, tData.fMinLOD);
+		HashCombine(uHash, tData.fMaxLOD);
+		return FinishHash(uHash);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOESamplerState::Setup(IOERPI *pRPI)
+	{
+		m_uHash = CalculateHash();
+		IOESamplerState &rInterned(pRPI->GetStateCache().Intern(*this));
+		m_uID		= rInterned.m_uID;
+		m_pInterned = &rInterned;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOESamplerState::HasSameDescription(const IOESamplerState &rhs) const
+	{
+		return tData.eFilter == rhs.tData.eFilter && tData.eAddressModeU == rhs.tData.eAddressModeU &&
+			   tData.eAddressModeV == rhs.tData.eAddressModeV && tData.eAddressModeW == rhs.tData.eAddressModeW &&
+			   tData.fLODBias == rhs.tData.fLODBias && tData.uMaxAnisotropy == rhs.tData.uMaxAnisotropy &&
+			   tData.eComparison == rhs.tData.eComparison &&
+			   IsSameVector(tData.vBorderColour, rhs.tData.vBorderColour) && tData.fMinLOD == rhs.tData.fMinLOD &&
+			   tData.fMaxLOD == rhs.tData.fMaxLOD;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint64_t IOEDepthState::CalculateHash() const
+	{
+		std::uint64_t uHash(g_uHashBasis);
+		HashCombine(uHash, tData.bDepthEnable);
+		HashCombine(uHash, tData.uDepthWriteMask);
+		HashCombine(uHash, tData.eDepthFunc);
+		HashCombine(uHash, tData.bStencilEnable);
+		HashCombine(uHash, tData.uStencilReadMask);
+		HashCombine(uHash, tData.uStencilWriteMask);
+		for (const auto *pFace : {&tData.tFrontFace, &tData.tRearFace})
+		{
+			HashCombine(uHash, pFace->eStencilFailOp);
+			HashCombine(uHash, pFace->eStencilDepthFailOp);
+			HashCombine(uHash, pFace->eStencilPassOp);
+			HashCombine(uHash, pFace->eStencilFunc);
+		}
+		return FinishHash(uHash);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEDepthState::Setup(IOERPI *pRPI)
+	{
+		m_uHash = CalculateHash();
+		IOEDepthState &rInterned(pRPI->GetStateCache().Intern(*this));
+		m_uID		= rInterned.m_uID;
+		m_pInterned = &rInterned;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEDepthState::HasSameDescription(const IOEDepthState &rhs) const
+	{
+		auto IsSameFace = [](const _::_Stencil &rLHS, const _::_Stencil &rRHS) {
+			return rLHS.eStencilFailOp == rRHS.eStencilFailOp && rLHS.eStencilDepthFailOp == rRHS.eStencilDepthFailOp &&
+				   rLHS.eStencilPassOp == rRHS.eStencilPassOp && rLHS.eStencilFunc == rRHS.eStencilFunc;
+		};
+		return tData.bDepthEnable == rhs.tData.bDepthEnable && tData.uDepthWriteMask == rhs.tData.uDepthWriteMask &&
+			   tData.eDepthFunc == rhs.tData.eDepthFunc && tData.bStencilEnable == rhs.tData.bStencilEnable &&
+			   tData.uStencilReadMask == rhs.tData.uStencilReadMask &&
+			   tData.uStencilWriteMask == rhs.tData.uStencilWriteMask &&
+			   IsSameFace(tData.tFrontFace, rhs.tData.tFrontFace) && IsSameFace(tData.tRearFace, rhs.tData.tRearFace);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 	IOERPI::IOERPI()
 		: IOEManager("IOERPI")
 		, m_tPlatform()
@@ -34,14 +245,12 @@ namespace Renderer
 								 IOE::Application::GetDefaultResY<float>(), 1, true)
 		, m_tDefaultDepthStencil(ETextureFormat::D24_UNORM_S8_UINT, IOE::Application::GetDefaultResX<float>(),
 								 IOE::Application::GetDefaultResY<float>())
-		, m_uNumDebugPoints(0)
-		, m_uNumDebugLines(0)
-		, m_uNumDebugTriangles(0)
 		, m_tRasterizerState(IOERasterizerState::Default())
 		, m_tBlendState(IOEBlendState::Default())
 		, m_tDefaultSamplerState(IOESamplerState::Default())
 		, m_tDefaultDepthState(IOEDepthState::Default())
 		, m_eTopology(EPrimitiveTopology::TriangleList)
+		, m_uUploadFrame(1)
 	{
 		m_tDefaultColourBuffer.SetBufferDescription(EBufferDescription::RenderTarget);
 		m_tDefaultDepthStencil.SetBufferDescription(EBufferDescription::DepthStencil);
@@ -54,11 +263,7 @@ namespace Renderer
 		tCameraProperties.fFOV  = 90.0f;
 		m_mDefaultCamera.SetCameraProperties(tCameraProperties);
 
-		m_uCurrentMaterialIndex = IOEMaterial::INVALID_RESOURCE_INDEX;
-		for (int32_t nIdx(0); nIdx < EShaderType::NumShaders; ++nIdx)
-		{
-			m_arrCurrentShaderIndexes[nIdx] = IOEShader::INVALID_RESOURCE_INDEX;
-		}
+		InvalidateBoundState();
 
 		m_mCamera = m_mDefaultCamera;
 	}
@@ -70,7 +275,21 @@ namespace Renderer
 		m_tPlatform.OnInit(shared_from_this());
 		// m_tDefaultDepthStencil.Setup();
 
+		// A ring the device cannot bind at offsets is left empty, so every upload to it fails and its users fall
+		// back to their own buffers
+		if (m_tPlatform.CreateUploadRing(EUploadRing::Vertex, ms_uVertexUploadRingSize))
+		{
+			m_arrUploadRings[EUploadRing::Vertex].Setup(ms_uVertexUploadRingSize, m_tPlatform.GetFence());
+		}
+		if (m_tPlatform.CreateUploadRing(EUploadRing::Constant, ms_uConstantUploadRingSize))
+		{
+			m_arrUploadRings[EUploadRing::Constant].Setup(ms_uConstantUploadRingSize, m_tPlatform.GetFence());
+		}
+
 		wstring szMediaDir(IOE::Core::g_pEngine->GetMediaPath());
+		m_tShaderCache.Setup(szMediaDir, IOE::Core::Algorithm::JoinPath(szMediaDir, L"ShaderCache.bin"));
+		m_tStateCache.Setup(this);
+
 		std::wstring szPath(IOE::Core::Algorithm::JoinPath(szMediaDir, L"Materials", L"DebugDraw.ioe.xml"));
 
 		m_pDebugDrawShader = std::make_shared<IOEMaterial>(szPath);
@@ -81,6 +300,7 @@ namespace Renderer
 		m_tDefaultDepthState.Setup(this);
 		m_tDefaultColourBuffer.Setup();
 		m_tDefaultDepthStencil.Setup();
+		m_tEngineConstants.Setup(this);
 
 		m_tPlatform.SetPrimitiveTopology(m_eTopology);
 
@@ -128,6 +348,13 @@ namespace Renderer
 
 		m_tPlatform.Resize(fNewWidth, fNewHeight);
 
+		// The platform rebinds the default targets, and may have cleared
+		// the device state to do so
+		InvalidateBoundState();
+		m_arrRenderTargets.fill(IOEBoundTexture());
+		m_arrRenderTargets[0].Set(&m_tDefaultColourBuffer);
+		m_tDepthTarget.Set(&m_tDefaultDepthStencil);
+
 		IOE::Maths::IOECamera::CCameraProperties tCameraProperties;
 		tCameraProperties.fAspect = fNewWidth / fNewHeight;
 		tCameraProperties.fFar	= 1000.0f;
@@ -142,8 +369,17 @@ namespace Renderer
 
 	void IOERPI::OnPreRender(IOE::Renderer::IOERPI *pPtr)
 	{
+		m_tLastFrameBindStats = m_tBindStats;
+		m_tBindStats		  = IOERPIBindStats();
+
+		// Nothing is carried over between frames, so state bound behind the
+		// RPI's back is only ever stale until the next frame
+		InvalidateBoundState();
+
 		ResetState();
 
+		m_tEngineConstants.SetFrame(this, IOE::Core::g_pEngine->GetFrameDelta());
+
 		ResetViewports();
 		SetCamera(m_mDefaultCamera);
 		SetDepthTarget(m_tDefaultDepthStencil, false);
@@ -159,6 +395,11 @@ namespace Renderer
 
 	void IOERPI::OnRender(IOE::Renderer::IOERPI *pPtr)
 	{
+		// Binds the default colour buffer alone
+		m_arrRenderTargets.fill(IOEBoundTexture());
+		m_arrRenderTargets[0].Set(&m_tDefaultColourBuffer);
+		m_arrBoundKeys[ERPIBind::RenderTargets] = GetRenderTargetsKey();
+
 		m_tPlatform.StartRender();
 	}
 
@@ -166,9 +407,195 @@ namespace Renderer
 
 	void IOERPI::OnPostRender(IOE::Renderer::IOERPI *pPtr)
 	{
+		// Every job has finished adding debug primitives by now. They are drawn a topology at a time by the platform.
+		m_tDebugDraw.Merge(ms_uMaxDebugVertices);
+		if (GetNumDebugPoints() > 0)
+		{
+			m_tRenderStats.AddDraw(EPrimitiveTopology::Point, GetNumDebugPoints());
+		}
+		if (GetNumDebugLines() > 0)
+		{
+			m_tRenderStats.AddDraw(EPrimitiveTopology::LineList, GetNumDebugLines() * 2);
+		}
+		if (GetNumDebugTriangles() > 0)
+		{
+			m_tRenderStats.AddDraw(EPrimitiveTopology::TriangleList, GetNumDebugTriangles() * 3);
+		}
+		m_tRenderStats.Add(ERenderStat::StateChanges, m_tBindStats.GetNumForwarded());
+
+#if (IOE_DEBUG_ENABLED == IOE_ON && IOE_RPI_PROFILE_MARKERS == IOE_ON)
+		// Set before presenting, so the counters land in captures of the frame
+		SetProfileMarker(m_tRenderStats.FormatCurrent(), EProfileMarkerType::Single, Maths::ColourList::White);
+#endif
+
 		m_tPlatform.FinishRender();
+		m_tRenderStats.EndFrame();
+
+		// What this frame uploaded is handed out again once the GPU has passed the fence
+		m_tPlatform.GetFence()->Signal(m_uUploadFrame);
+		for (IOEUploadRing &rRing : m_arrUploadRings)
+		{
+			rRing.EndFrame(m_uUploadFrame);
+		}
+		++m_uUploadFrame;
+
+		// Every render target is unbound once the frame is presented
+		m_arrRenderTargets.fill(IOEBoundTexture());
+		m_arrBoundKeys[ERPIBind::RenderTargets] = GetRenderTargetsKey();
+
+		m_tDebugDraw.Flush(IOE::Core::g_pEngine->GetFrameDelta());
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI::DrawBuffer(IOEBufferBase *pVertexBuffer, EPrimitiveTopology eTopology,
+							IOEBufferBase *pIndexBuffer /*=nullptr*/, std::int32_t nNumElements /*=-1*/)
+	{
+		std::size_t uNumVerts(static_cast<std::size_t>(nNumElements));
+		if (nNumElements <= 0)
+		{
+			uNumVerts = pIndexBuffer != nullptr ? pIndexBuffer->GetNumElements() : pVertexBuffer->GetNumElements();
+		}
+		m_tRenderStats.AddDraw(eTopology, uNumVerts);
+
+		m_tPlatform.DrawBuffer(pVertexBuffer, eTopology, pIndexBuffer, nNumElements);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void *IOERPI::MapUpload(EUploadRing::Enum eRing, std::uint32_t uSizeBytes, std::uint32_t uAlignment,
+							std::uint32_t &ruOffset)
+	{
+		if (!m_arrUploadRings[eRing].Allocate(uSizeBytes, uAlignment, ruOffset))
+		{
+			return nullptr;
+		}
+		m_tRenderStats.Add(ERenderStat::UploadBytes, uSizeBytes);
+		return m_tPlatform.MapUploadRing(eRing, ruOffset, uSizeBytes);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI::DrawUpload(std::uint32_t uOffset, std::uint32_t uStride, EPrimitiveTopology eTopology,
+							std::uint32_t uNumElements, IOEBufferBase *pIndexBuffer /*=nullptr*/)
+	{
+		m_tRenderStats.AddDraw(eTopology, uNumElements);
+		m_tPlatform.DrawUploadBuffer(uOffset, uStride, eTopology, uNumElements, pIndexBuffer);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI::InvalidateBoundState()
+	{
+		m_arrBoundKeys.fill(0);
+		m_arrUAVKeys.fill(0);
+
+		m_tEngineConstants.Invalidate();
+
+		m_uCurrentMaterialIndex = IOEMaterial::INVALID_RESOURCE_INDEX;
+		for (int32_t nIdx(0); nIdx < EShaderType::NumShaders; ++nIdx)
+		{
+			m_arrCurrentShaderIndexes[nIdx] = IOEShader::INVALID_RESOURCE_INDEX;
+		}
+		m_pCurrentMaterialInstance = nullptr;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOERPI::FilterBind(ERPIBind::Enum eBind, std::uint64_t uKey)
+	{
+		++m_tBindStats.arrRequested[eBind];
+		if (uKey != 0 && m_arrBoundKeys[eBind] == uKey)
+		{
+			return false;
+		}
+		++m_tBindStats.arrForwarded[eBind];
+		m_arrBoundKeys[eBind] = uKey;
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI::SetRasterizerState(const IOERasterizerState &rhs)
+	{
+		if (FilterBind(ERPIBind::RasterizerState, rhs.GetID()))
+		{
+			m_tPlatform.SetRasterizerState(rhs);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI::SetDepthState(const IOEDepthState &rhs, std::uint32_t uStencilRef /*=0*/)
+	{
+		// The reference takes the upper half, so the key is exact
+		std::uint64_t uKey(0);
+		if (rhs.GetID() != 0)
+		{
+			uKey = (static_cast<std::uint64_t>(uStencilRef) << 32) | rhs.GetID();
+		}
+		if (FilterBind(ERPIBind::DepthState, uKey))
+		{
+			m_tPlatform.SetDepthState(rhs, uStencilRef);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI::SetBlendState(const IOEBlendState &rhs, std::uint32_t uWriteMask /*=0xFFFFFFFF*/,
+							   const IOE::Maths::IOEVector &arrBlendFactor /*=IOE::Maths::g_vOneVector*/)
+	{
+		std::uint64_t uKey(0);
+		if (rhs.GetID() != 0)
+		{
+			uKey = g_uHashBasis;
+			HashCombine(uKey, rhs.GetID());
+			HashCombine(uKey, uWriteMask);
+			HashCombine(uKey, arrBlendFactor);
+			uKey = FinishHash(uKey);
+		}
+		if (FilterBind(ERPIBind::BlendState, uKey))
+		{
+			m_tPlatform.SetBlendState(rhs, uWriteMask, arrBlendFactor);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
 
-		FlushDebugBuffers();
+	std::uint64_t IOERPI::GetRenderTargetsKey() const
+	{
+		std::uint64_t uHash(g_uHashBasis);
+		for (const IOEBoundTexture &rBound : m_arrRenderTargets)
+		{
+			HashCombine(uHash, rBound.pTexture);
+			HashCombine(uHash, rBound.uGeneration);
+		}
+		HashCombine(uHash, m_tDepthTarget.pTexture);
+		HashCombine(uHash, m_tDepthTarget.uGeneration);
+		return FinishHash(uHash);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOERPI::FilterRenderTargets(std::uint64_t uPreviousKey)
+	{
+		// A changed set must reach the platform even when it matches what is
+		// bound, as only then does the platform hold the same targets
+		const std::uint64_t uKey(GetRenderTargetsKey());
+		if (uKey != uPreviousKey)
+		{
+			m_arrBoundKeys[ERPIBind::RenderTargets] = 0;
+		}
+		return FilterBind(ERPIBind::RenderTargets, uKey);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI::OnOutputMergerRefreshed()
+	{
+		// The platform binds the render targets along with the output merger
+		// UAVs, so whatever targets were held are now the ones bound
+		m_arrBoundKeys[ERPIBind::RenderTargets] = GetRenderTargetsKey();
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -176,35 +603,95 @@ namespace Renderer
 	void IOERPI::SetRenderTarget(IOE::Renderer::IOETexture &rRenderTargets, int32_t m_nRenderTargetIdx /*=0*/,
 								 bool bSet /*=true*/)
 	{
-		m_tPlatform.SetRenderTarget(rRenderTargets, m_nRenderTargetIdx, bSet);
+		const std::uint64_t uPreviousKey(GetRenderTargetsKey());
+		m_arrRenderTargets[m_nRenderTargetIdx].Set(&rRenderTargets);
+
+		// Targets that are only held cost the platform nothing, so only the
+		// binds are filtered
+		if (!bSet || FilterRenderTargets(uPreviousKey))
+		{
+			m_tPlatform.SetRenderTarget(rRenderTargets, m_nRenderTargetIdx, bSet);
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
 	void IOERPI::SetDepthTarget(IOE::Renderer::IOETexture &rDepthTexture, bool bSet /*=true*/)
 	{
-		m_tPlatform.SetDepthTarget(rDepthTexture, bSet);
+		const std::uint64_t uPreviousKey(GetRenderTargetsKey());
+		m_tDepthTarget.Set(&rDepthTexture);
+		if (!bSet || FilterRenderTargets(uPreviousKey))
+		{
+			m_tPlatform.SetDepthTarget(rDepthTexture, bSet);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI::SetRenderTargets(IOETextureSpan arrRenderTargets, bool bSet /*=true*/)
+	{
+		IOE_ASSERT(arrRenderTargets.size() <= ms_uMaxRenderTargets, "Too many render targets");
+
+		const std::uint64_t uPreviousKey(GetRenderTargetsKey());
+		m_arrRenderTargets.fill(IOEBoundTexture());
+		for (std::size_t uIdx(0); uIdx < arrRenderTargets.size(); ++uIdx)
+		{
+			m_arrRenderTargets[uIdx].Set(arrRenderTargets[uIdx]);
+		}
+		if (!bSet || FilterRenderTargets(uPreviousKey))
+		{
+			m_tPlatform.SetRenderTargets(arrRenderTargets, bSet);
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOERPI::SetRenderTargets(std::vector<IOE::Renderer::IOETexture> arrRenderTargets, bool bSet /*=true*/)
+	void IOERPI::UnsetRenderTarget(int32_t nRenderTarget /*=0*/)
 	{
-		m_tPlatform.SetRenderTargets(arrRenderTargets, bSet);
+		const std::uint64_t uPreviousKey(GetRenderTargetsKey());
+		m_arrRenderTargets[nRenderTarget] = IOEBoundTexture();
+		if (FilterRenderTargets(uPreviousKey))
+		{
+			m_tPlatform.UnsetRenderTarget(nRenderTarget);
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
 	void IOERPI::ResetUAVs()
 	{
+		m_arrUAVKeys.fill(0);
 		m_tPlatform.ResetUAVs();
+		OnOutputMergerRefreshed();
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOERPI::SetUAVs(std::vector<IOE::Renderer::IOETexture> arrUAVs, EUAVSet bSet /*= EUAVSet::OutputMerger*/)
+	void IOERPI::SetUAVs(IOETextureSpan arrUAVs, EUAVSet bSet /*= EUAVSet::OutputMerger*/)
 	{
+		std::uint64_t uKey(g_uHashBasis);
+		for (const IOETexture *pUAV : arrUAVs)
+		{
+			HashCombine(uKey, pUAV);
+			HashCombine(uKey, pUAV->GetGeneration());
+		}
+		uKey = FinishHash(uKey);
+
+		// Only whole sets are filtered; a single UAV change forgets the set
+		std::uint64_t &ruBoundKey(m_arrUAVKeys[static_cast<std::size_t>(bSet)]);
+		++m_tBindStats.arrRequested[ERPIBind::UAVs];
+		if (ruBoundKey == uKey)
+		{
+			return;
+		}
+		++m_tBindStats.arrForwarded[ERPIBind::UAVs];
+		ruBoundKey = uKey;
+
 		m_tPlatform.SetUAVs(arrUAVs, bSet);
+		if (bSet == EUAVSet::OutputMerger)
+		{
+			OnOutputMergerRefreshed();
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -212,28 +699,56 @@ namespace Renderer
 	void IOERPI::SetUAV(IOE::Renderer::IOETexture &rUAV, int32_t m_nUAVIdx /*=0*/,
 						EUAVSet bSet /*= EUAVSet::OutputMerger*/, int arrOffset /*=0*/)
 	{
+		++m_tBindStats.arrRequested[ERPIBind::UAVs];
+		++m_tBindStats.arrForwarded[ERPIBind::UAVs];
+
+		m_arrUAVKeys[static_cast<std::size_t>(bSet)] = 0;
 		m_tPlatform.SetUAV(rUAV, m_nUAVIdx, bSet, arrOffset);
+		if (bSet == EUAVSet::OutputMerger)
+		{
+			OnOutputMergerRefreshed();
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOERPI::UnsetRenderTarget(int32_t nRenderTarget /*=0*/)
+	void IOERPI::UnsetUAV(int32_t nUAV /*=0*/, EUAVSet bSet /*= EUAVSet::OutputMerger*/)
 	{
-		m_tPlatform.UnsetRenderTarget(nRenderTarget);
+		++m_tBindStats.arrRequested[ERPIBind::UAVs];
+		++m_tBindStats.arrForwarded[ERPIBind::UAVs];
+
+		m_arrUAVKeys[static_cast<std::size_t>(bSet)] = 0;
+		m_tPlatform.UnsetUAV(nUAV, bSet);
+		if (bSet == EUAVSet::OutputMerger)
+		{
+			OnOutputMergerRefreshed();
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOERPI::UnsetUAV(int32_t nUAV /*=0*/, EUAVSet bSet /*= EUAVSet::OutputMerger*/)
+	void IOERPI::ResetState()
 	{
-		m_tPlatform.UnsetUAV(nUAV, bSet);
+		m_tPlatform.ResetState();
+
+		// Every shader was removed, so the next material binds all of its own
+		m_uCurrentMaterialIndex = IOEMaterial::INVALID_RESOURCE_INDEX;
+		for (int32_t nIdx(0); nIdx < EShaderType::NumShaders; ++nIdx)
+		{
+			m_arrCurrentShaderIndexes[nIdx] = IOEShader::INVALID_RESOURCE_INDEX;
+		}
+		m_pCurrentMaterialInstance = nullptr;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOERPI::ResetState()
+	void IOERPI::UnsetShader(EShaderType::Enum eShaderType)
 	{
-		m_tPlatform.ResetState();
+		if (m_arrCurrentShaderIndexes[eShaderType] != IOEShader::INVALID_RESOURCE_INDEX)
+		{
+			m_tPlatform.UnsetShader(eShaderType);
+			m_arrCurrentShaderIndexes[eShaderType] = IOEShader::INVALID_RESOURCE_INDEX;
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -245,59 +760,59 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOERPI::UnsetTextureSampler(std::string szName)
+	std::uint32_t IOERPI::GetTextureSamplerHandle(const std::string &szName)
 	{
-		for (auto tIt(std::begin(m_arrTextureSamplers)); tIt != std::end(m_arrTextureSamplers); ++tIt)
+		std::uint64_t uNameHash(g_uHashBasis);
+		for (char cChar : szName)
 		{
-			if ((*tIt).first == szName)
+			HashCombine(uNameHash, cChar);
+		}
+
+		for (std::size_t uIdx(0); uIdx < m_arrTextureSamplers.size(); ++uIdx)
+		{
+			const IOETextureSamplerSlot &rSlot(m_arrTextureSamplers[uIdx]);
+			if (rSlot.uNameHash == uNameHash && rSlot.szName == szName)
 			{
-				tIt = m_arrTextureSamplers.erase(tIt);
+				return static_cast<std::uint32_t>(uIdx);
 			}
 		}
+		m_arrTextureSamplers.emplace_back(uNameHash, szName);
+		return static_cast<std::uint32_t>(m_arrTextureSamplers.size() - 1);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOERPI::SetTextureSampler(std::string szName, IOESamplerState *pSampler)
+	void IOERPI::UnsetTextureSampler(const std::string &szName)
 	{
-		for (auto tIt(std::begin(m_arrTextureSamplers)); tIt != std::end(m_arrTextureSamplers); ++tIt)
-		{
-			if ((*tIt).first == szName)
-			{
-				(*tIt).second = pSampler;
-				return;
-			}
-		}
-		m_arrTextureSamplers.emplace_back(szName, pSampler);
+		UnsetTextureSampler(GetTextureSamplerHandle(szName));
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOERPI::AddDebugBox(const IOEVector &vCentre, const IOEVector &vExtents,
-							 const IOEVector &vColour /*=Maths::ColourList::Red*/)
+	void IOERPI::UnsetTextureSampler(std::uint32_t uHandle)
 	{
-		float fXMin, fYMin, fZMin;
-		float fXMax, fYMax, fZMax;
+		SetTextureSampler(uHandle, nullptr);
+	}
 
-		(vCentre - vExtents).Get(fXMin, fYMin, fZMin);
-		(vCentre + vExtents).Get(fXMax, fYMax, fZMax);
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI::SetTextureSampler(const std::string &szName, IOESamplerState *pSampler)
+	{
+		SetTextureSampler(GetTextureSamplerHandle(szName), pSampler);
+	}
 
-		AddDebugLine(IOEVector(fXMin, fYMin, fZMin), IOEVector(fXMin, fYMax, fZMin), vColour, vColour);
-		AddDebugLine(IOEVector(fXMin, fYMax, fZMin), IOEVector(fXMax, fYMax, fZMin), vColour, vColour);
-		AddDebugLine(IOEVector(fXMax, fYMax, fZMin), IOEVector(fXMax, fYMin, fZMin), vColour, vColour);
-		AddDebugLine(IOEVector(fXMax, fYMin, fZMin), IOEVector(fXMin, fYMin, fZMin), vColour, vColour);
+	//////////////////////////////////////////////////////////////////////////
 
-		// Rear face
-		AddDebugLine(IOEVector(fXMin, fYMin, fZMax), IOEVector(fXMin, fYMax, fZMax), vColour, vColour);
-		AddDebugLine(IOEVector(fXMin, fYMax, fZMax), IOEVector(fXMax, fYMax, fZMax), vColour, vColour);
-		AddDebugLine(IOEVector(fXMax, fYMax, fZMax), IOEVector(fXMax, fYMin, fZMax), vColour, vColour);
-		AddDebugLine(IOEVector(fXMax, fYMin, fZMax), IOEVector(fXMin, fYMin, fZMax), vColour, vColour);
+	void IOERPI::SetTextureSampler(std::uint32_t uHandle, IOESamplerState *pSampler)
+	{
+		IOETextureSamplerSlot &rSlot(m_arrTextureSamplers[uHandle]);
 
-		// Connectors
-		AddDebugLine(IOEVector(fXMin, fYMin, fZMin), IOEVector(fXMin, fYMin, fZMax), vColour, vColour);
-		AddDebugLine(IOEVector(fXMin, fYMax, fZMin), IOEVector(fXMin, fYMax, fZMax), vColour, vColour);
-		AddDebugLine(IOEVector(fXMax, fYMax, fZMin), IOEVector(fXMax, fYMax, fZMax), vColour, vColour);
-		AddDebugLine(IOEVector(fXMax, fYMin, fZMin), IOEVector(fXMax, fYMin, fZMax), vColour, vColour);
+		++m_tBindStats.arrRequested[ERPIBind::TextureSampler];
+		if (rSlot.pSampler != pSampler)
+		{
+			++m_tBindStats.arrForwarded[ERPIBind::TextureSampler];
+			rSlot.pSampler = pSampler;
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -8,11 +8,18 @@
 
 #include <IOE/IOECore/IOEDefines.h>
 #include <IOE/IOECore/IOEManager.h>
+#include <IOE/IOECore/IOESpan.h>
 
 #include <IOE/IOEMaths/Vector.h>
 #include <IOE/IOEMaths/Camera.h>
 
 #include "IOERPI_Defines.h"
+#include "IOEDebugDraw.h"
+#include "IOEEngineConstants.h"
+#include "IOERenderStats.h"
+#include "IOEShaderCache.h"
+#include "IOEStateCache.h"
+#include "IOEUploadRing.h"
 #include RPI_INCLUDE(IOERPI_Platform.h)
 #include <IOE/IOERenderer/IOEVertexFormat.h>
 #include "IOEShader_PlatformBase.h"
@@ -75,17 +82,26 @@ namespace Renderer
 	{
 		IOERasterizerState()
 			: m_tPlatform(*this)
+			, m_uHash(0)
+			, m_uID(0)
+			, m_pInterned(nullptr)
 		{
 		}
 
 		IOERasterizerState(const IOERasterizerState &rhs)
 			: tData(rhs.tData)
 			, m_tPlatform(*this)
+			, m_uHash(rhs.m_uHash)
+			, m_uID(rhs.m_uID)
+			, m_pInterned(rhs.m_pInterned)
 		{
 		}
 		IOERasterizerState(IOERasterizerState &&rhs)
 			: tData(std::move(rhs.tData))
 			, m_tPlatform(*this)
+			, m_uHash(rhs.m_uHash)
+			, m_uID(rhs.m_uID)
+			, m_pInterned(rhs.m_pInterned)
 		{
 		}
 
@@ -109,18 +125,37 @@ namespace Renderer
 			return tState;
 		}
 
-		void Setup(IOERPI *pRPI)
+		// Interns the state with the RPI's state cache, after which tData
+		// must not change
+		void Setup(IOERPI *pRPI);
+
+		// Hash of tData taken when the state is set up. Equal descriptions
+		// hash alike, but states that collide are told apart by
+		// HasSameDescription.
+		FORCEINLINE std::uint64_t GetHash() const
+		{
+			return m_uHash;
+		}
+
+		// Shared by every set up state with the same description, and zero
+		// until the state is set up
+		FORCEINLINE std::uint32_t GetID() const
 		{
-			m_tPlatform.Setup(pRPI);
+			return m_uID;
 		}
 
+		bool HasSameDescription(const IOERasterizerState &rhs) const;
+
+		// The backend object of the interned copy, once set up
 		IOERasterizerState_Platform &GetPlatform()
 		{
-			return m_tPlatform;
+			return m_pInterned != nullptr ? m_pInterned->m_tPlatform
+										  : m_tPlatform;
 		}
 		const IOERasterizerState_Platform &GetPlatform() const
 		{
-			return m_tPlatform;
+			return m_pInterned != nullptr ? m_pInterned->m_tPlatform
+										  : m_tPlatform;
 		}
 
 		struct _
@@ -137,6 +172,15 @@ namespace Renderer
 			bool bAntialiasedLineEnable;
 		} tData;
 		IOERasterizerState_Platform m_tPlatform;
+
+	private:
+		friend class IOEStateCache;
+
+		std::uint64_t CalculateHash() const;
+
+		std::uint64_t m_uHash;
+		std::uint32_t m_uID;
+		IOERasterizerState *m_pInterned;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
@@ -184,17 +228,26 @@ namespace Renderer
 	{
 		IOEBlendState()
 			: m_tPlatform(*this)
+			, m_uHash(0)
+			, m_uID(0)
+			, m_pInterned(nullptr)
 		{
 		}
 
 		IOEBlendState(const IOEBlendState &rhs)
 			: tData(rhs.tData)
 			, m_tPlatform(*this)
+			, m_uHash(rhs.m_uHash)
+			, m_uID(rhs.m_uID)
+			, m_pInterned(rhs.m_pInterned)
 		{
 		}
 		IOEBlendState(IOEBlendState &&rhs)
 			: tData(std::move(rhs.tData))
 			, m_tPlatform(*this)
+			, m_uHash(rhs.m_uHash)
+			, m_uID(rhs.m_uID)
+			, m_pInterned(rhs.m_pInterned)
 		{
 		}
 
@@ -272,19 +325,47 @@ namespace Renderer
 
 		IOEBlendState_Platform m_tPlatform;
 
-		void Setup(IOERPI *pRPI)
+		// Interns the state with the RPI's state cache, after which tData
+		// must not change
+		void Setup(IOERPI *pRPI);
+
+		// Hash of tData taken when the state is set up. Equal descriptions
+		// hash alike, but states that collide are told apart by
+		// HasSameDescription.
+		FORCEINLINE std::uint64_t GetHash() const
 		{
-			m_tPlatform.Setup(pRPI);
+			return m_uHash;
 		}
 
+		// Shared by every set up state with the same description, and zero
+		// until the state is set up
+		FORCEINLINE std::uint32_t GetID() const
+		{
+			return m_uID;
+		}
+
+		bool HasSameDescription(const IOEBlendState &rhs) const;
+
+		// The backend object of the interned copy, once set up
 		IOEBlendState_Platform &GetPlatform()
 		{
-			return m_tPlatform;
+			return m_pInterned != nullptr ? m_pInterned->m_tPlatform
+										  : m_tPlatform;
 		}
 		const IOEBlendState_Platform &GetPlatform() const
 		{
-			return m_tPlatform;
+			return m_pInterned != nullptr ? m_pInterned->m_tPlatform
+										  : m_tPlatform;
 		}
+
+	private:
+		friend class IOEStateCache;
+
+		std::uint64_t CalculateHash() const;
+
+		std::uint64_t m_uHash;
+		std::uint32_t m_uID;
+		IOEBlendState *m_pInterned;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
@@ -354,17 +435,26 @@ namespace Renderer
 	public:
 		IOESamplerState()
 			: m_tPlatform(*this)
+			, m_uHash(0)
+			, m_uID(0)
+			, m_pInterned(nullptr)
 		{
 		}
 
 		IOESamplerState(const IOESamplerState &rhs)
 			: tData(rhs.tData)
 			, m_tPlatform(*this)
+			, m_uHash(rhs.m_uHash)
+			, m_uID(rhs.m_uID)
+			, m_pInterned(rhs.m_pInterned)
 		{
 		}
 		IOESamplerState(IOESamplerState &&rhs)
 			: tData(std::move(rhs.tData))
 			, m_tPlatform(*this)
+			, m_uHash(rhs.m_uHash)
+			, m_uID(rhs.m_uID)
+			, m_pInterned(rhs.m_pInterned)
 		{
 		}
 
@@ -409,19 +499,47 @@ namespace Renderer
 
 		IOESamplerState_Platform m_tPlatform;
 
-		void Setup(IOERPI *pRPI)
+		// Interns the state with the RPI's state cache, after which tData
+		// must not change
+		void Setup(IOERPI *pRPI);
+
+		// Hash of tData taken when the state is set up. Equal descriptions
+		// hash alike, but states that collide are told apart by
+		// HasSameDescription.
+		FORCEINLINE std::uint64_t GetHash() const
+		{
+			return m_uHash;
+		}
+
+		// Shared by every set up state with the same description, and zero
+		// until the state is set up
+		FORCEINLINE std::uint32_t GetID() const
 		{
-			m_tPlatform.Setup(pRPI);
+			return m_uID;
 		}
 
+		bool HasSameDescription(const IOESamplerState &rhs) const;
+
+		// The backend object of the interned copy, once set up
 		IOESamplerState_Platform &GetPlatform()
 		{
-			return m_tPlatform;
+			return m_pInterned != nullptr ? m_pInterned->m_tPlatform
+										  : m_tPlatform;
 		}
 		const IOESamplerState_Platform &GetPlatform() const
 		{
-			return m_tPlatform;
+			return m_pInterned != nullptr ? m_pInterned->m_tPlatform
+										  : m_tPlatform;
 		}
+
+	private:
+		friend class IOEStateCache;
+
+		std::uint64_t CalculateHash() const;
+
+		std::uint64_t m_uHash;
+		std::uint32_t m_uID;
+		IOESamplerState *m_pInterned;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
@@ -443,17 +561,26 @@ namespace Renderer
 	public:
 		IOEDepthState()
 			: m_tPlatform(*this)
+			, m_uHash(0)
+			, m_uID(0)
+			, m_pInterned(nullptr)
 		{
 		}
 
 		IOEDepthState(const IOEDepthState &rhs)
 			: tData(rhs.tData)
 			, m_tPlatform(*this)
+			, m_uHash(rhs.m_uHash)
+			, m_uID(rhs.m_uID)
+			, m_pInterned(rhs.m_pInterned)
 		{
 		}
 		IOEDepthState(IOEDepthState &&rhs)
 			: tData(std::move(rhs.tData))
 			, m_tPlatform(*this)
+			, m_uHash(rhs.m_uHash)
+			, m_uID(rhs.m_uID)
+			, m_pInterned(rhs.m_pInterned)
 		{
 		}
 
@@ -486,17 +613,37 @@ namespace Renderer
 
 		IOEDepthState_Platform m_tPlatform;
 
-		void Setup(IOERPI *pRPI)
+		// Interns the state with the RPI's state cache, after which tData
+		// must not change
+		void Setup(IOERPI *pRPI);
+
+		// Hash of tData taken when the state is set up. Equal descriptions
+		// hash alike, but states that collide are told apart by
+		// HasSameDescription.
+		FORCEINLINE std::uint64_t GetHash() const
+		{
+			return m_uHash;
+		}
+
+		// Shared by every set up state with the same description, and zero
+		// until the state is set up
+		FORCEINLINE std::uint32_t GetID() const
 		{
-			m_tPlatform.Setup(pRPI);
+			return m_uID;
 		}
+
+		bool HasSameDescription(const IOEDepthState &rhs) const;
+
+		// The backend object of the interned copy, once set up
 		IOEDepthState_Platform &GetPlatform()
 		{
-			return m_tPlatform;
+			return m_pInterned != nullptr ? m_pInterned->m_tPlatform
+										  : m_tPlatform;
 		}
 		const IOEDepthState_Platform &GetPlatform() const
 		{
-			return m_tPlatform;
+			return m_pInterned != nullptr ? m_pInterned->m_tPlatform
+										  : m_tPlatform;
 		}
 
 		struct _
@@ -520,6 +667,67 @@ namespace Renderer
 			_Stencil tFrontFace;
 			_Stencil tRearFace;
 		} tData;
+
+	private:
+		friend class IOEStateCache;
+
+		std::uint64_t CalculateHash() const;
+
+		std::uint64_t m_uHash;
+		std::uint32_t m_uID;
+		IOEDepthState *m_pInterned;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace ERPIBind
+	{
+		enum Enum
+		{
+			RasterizerState,
+			BlendState,
+			DepthState,
+			RenderTargets,
+			UAVs,
+			TextureSampler,
+			PrimitiveTopology,
+
+			NumBinds
+		};
+	}
+
+	// Binds asked of the RPI, and how many of them reached the platform or,
+	// for texture samplers, changed the slot. The difference was dropped for
+	// setting what was already bound.
+	struct IOERPIBindStats
+	{
+		IOERPIBindStats()
+		{
+			arrRequested.fill(0);
+			arrForwarded.fill(0);
+		}
+
+		std::uint32_t GetNumRequested() const
+		{
+			std::uint32_t uTotal(0);
+			for (std::uint32_t uCount : arrRequested)
+			{
+				uTotal += uCount;
+			}
+			return uTotal;
+		}
+		std::uint32_t GetNumForwarded() const
+		{
+			std::uint32_t uTotal(0);
+			for (std::uint32_t uCount : arrForwarded)
+			{
+				uTotal += uCount;
+			}
+			return uTotal;
+		}
+
+		std::array<std::uint32_t, ERPIBind::NumBinds> arrRequested;
+		std::array<std::uint32_t, ERPIBind::NumBinds> arrForwarded;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
@@ -530,9 +738,15 @@ namespace Renderer
 	class IOERPI : public IOE::Core::IOEManager<IOERPI>
 	{
 	public:
-		static const std::uint32_t ms_uNumDebugPoints	= 64 * 1024;
-		static const std::uint32_t ms_uNumDebugLines	 = 256 * 1024;
-		static const std::uint32_t ms_uNumDebugTriangles = 128 * 1024;
+		// Debug vertices drawn in a frame at most, and the size of the
+		// platform's debug buffer for when they do not fit in the ring
+		static const std::uint32_t ms_uMaxDebugVertices = 1024 * 1024;
+
+		static const std::uint32_t ms_uMaxRenderTargets = 8;
+
+		// Bytes of each ring shared by the frames the GPU is still drawing
+		static const std::uint32_t ms_uVertexUploadRingSize   = 8 * 1024 * 1024;
+		static const std::uint32_t ms_uConstantUploadRingSize = 4 * 1024 * 1024;
 
 	public:
 		IOERPI();
@@ -581,25 +795,108 @@ namespace Renderer
 			return m_tPlatform;
 		}
 
+		// Targets, UAVs and states are only passed on to the platform when
+		// they differ from what is bound. Anything that changes the device
+		// state without going through the RPI must invalidate this.
+		void InvalidateBoundState();
+
 		void UnsetRenderTarget(int32_t nRenderTarget = 0);
-		void SetRenderTargets(
-			std::vector<IOE::Renderer::IOETexture> arrRenderTargets,
-			bool bSet = true);
+		void SetRenderTargets(IOETextureSpan arrRenderTargets,
+							  bool bSet = true);
 		void SetRenderTarget(IOE::Renderer::IOETexture &rRenderTargets,
 							 int32_t m_nRenderTargetIdx = 0, bool bSet = true);
 		void SetDepthTarget(IOE::Renderer::IOETexture &rDepthTexture,
 							bool bSet = true);
 
-		void UnsetTextureSampler(std::string szName);
-		void SetTextureSampler(std::string szName, IOESamplerState *pSampler);
+		// Samplers are held in slots that never move, so the handle from
+		// the first lookup of a name can be kept in place of the name
+		std::uint32_t GetTextureSamplerHandle(const std::string &szName);
+		void UnsetTextureSampler(const std::string &szName);
+		void UnsetTextureSampler(std::uint32_t uHandle);
+		void SetTextureSampler(const std::string &szName,
+							   IOESamplerState *pSampler);
+		void SetTextureSampler(std::uint32_t uHandle,
+							   IOESamplerState *pSampler);
+		FORCEINLINE IOESamplerState *
+		GetTextureSampler(std::uint32_t uHandle) const
+		{
+			return m_arrTextureSamplers[uHandle].pSampler;
+		}
 
 		void ResetUAVs();
 		void UnsetUAV(int32_t nUAV = 0, EUAVSet bSet = EUAVSet::OutputMerger);
-		void SetUAVs(std::vector<IOE::Renderer::IOETexture> arrUAVs,
+		void SetUAVs(IOETextureSpan arrUAVs,
 					 EUAVSet bSet = EUAVSet::OutputMerger);
 		void SetUAV(IOE::Renderer::IOETexture &rUAV, int32_t m_nUAVIdx = 0,
 					EUAVSet bSet = EUAVSet::OutputMerger, int arrOffset = 0);
 
+		// Draws, triangles and the other per-frame counters. Platforms and
+		// shaders add to it as they submit; the window moves on as each
+		// frame is presented.
+		FORCEINLINE IOERenderStats &GetRenderStats()
+		{
+			return m_tRenderStats;
+		}
+		FORCEINLINE const IOERenderStats &GetRenderStats() const
+		{
+			return m_tRenderStats;
+		}
+
+		// Per-frame, per-view and per-object constants shared by every
+		// material, bound once at their own registers
+		FORCEINLINE IOEEngineConstants &GetEngineConstants()
+		{
+			return m_tEngineConstants;
+		}
+		FORCEINLINE const IOEEngineConstants &GetEngineConstants() const
+		{
+			return m_tEngineConstants;
+		}
+
+		// Compiled shaders, shared by every material and kept between runs
+		FORCEINLINE IOEShaderCache &GetShaderCache()
+		{
+			return m_tShaderCache;
+		}
+
+		// Interned states and pipelines, shared by every technique
+		FORCEINLINE IOEStateCache &GetStateCache()
+		{
+			return m_tStateCache;
+		}
+
+		// Space for uSizeBytes that only the frame being built will read,
+		// mapped until UnmapUpload. Null when the ring cannot hold it, in
+		// which case there is nothing to unmap.
+		void *MapUpload(EUploadRing::Enum eRing, std::uint32_t uSizeBytes,
+						std::uint32_t uAlignment, std::uint32_t &ruOffset);
+		FORCEINLINE void UnmapUpload(EUploadRing::Enum eRing)
+		{
+			m_tPlatform.UnmapUploadRing(eRing);
+		}
+
+		// Uploads are only valid in the frame they were made in, anything
+		// kept for later frames must be uploaded again
+		FORCEINLINE std::uint64_t GetUploadFrame() const
+		{
+			return m_uUploadFrame;
+		}
+		FORCEINLINE const IOEUploadRing &
+		GetUploadRing(EUploadRing::Enum eRing) const
+		{
+			return m_arrUploadRings[eRing];
+		}
+
+		// Counts of the frame being built, and of the last whole frame
+		FORCEINLINE const IOERPIBindStats &GetBindStats() const
+		{
+			return m_tBindStats;
+		}
+		FORCEINLINE const IOERPIBindStats &GetLastFrameBindStats() const
+		{
+			return m_tLastFrameBindStats;
+		}
+
 	public:
 		void AddViewport(float fTop, float fLeft, float fWidth, float fHeight,
 						 float fMinDepth = 0.0f, float fMaxDepth = 1.0f);
@@ -674,19 +971,23 @@ namespace Renderer
 			m_mCamera = rCamera;
 		}
 
-		FORCEINLINE void DrawBuffer(IOEBufferBase *pVertexBuffer,
-									EPrimitiveTopology eTopology,
-									IOEBufferBase *pIndexBuffer = nullptr,
-									std::int32_t nNumElements = -1)
-		{
-			m_tPlatform.DrawBuffer(pVertexBuffer, eTopology, pIndexBuffer,
-								   nNumElements);
-		}
+		void DrawBuffer(IOEBufferBase *pVertexBuffer,
+						EPrimitiveTopology eTopology,
+						IOEBufferBase *pIndexBuffer = nullptr,
+						std::int32_t nNumElements = -1);
+
+		// Draws vertices uploaded to the vertex ring in this frame
+		void DrawUpload(std::uint32_t uOffset, std::uint32_t uStride,
+						EPrimitiveTopology eTopology,
+						std::uint32_t uNumElements,
+						IOEBufferBase *pIndexBuffer = nullptr);
 
 		FORCEINLINE void SetPrimitiveTopology(EPrimitiveTopology eTopology)
 		{
+			++m_tBindStats.arrRequested[ERPIBind::PrimitiveTopology];
 			if (m_eTopology != eTopology)
 			{
+				++m_tBindStats.arrForwarded[ERPIBind::PrimitiveTopology];
 				m_tPlatform.SetPrimitiveTopology(eTopology);
 				m_eTopology = eTopology;
 			}
@@ -698,90 +999,64 @@ namespace Renderer
 		}
 
 	public:
+		// Safe from any thread, see IOEDebugDraw. Primitives with a
+		// duration are drawn until that many seconds have passed.
 		FORCEINLINE_DEBUGGABLE void
 		AddDebugPoint(const IOEVector &vWorldPosition,
-					  const IOEVector &vColour = Maths::ColourList::Red)
+					  const IOEVector &vColour = Maths::ColourList::Red,
+					  float fDuration = 0.0f)
 		{
-			IOE_ASSERT(m_uNumDebugPoints < ms_uNumDebugPoints,
-					   "Too many points! Increase static buffer size");
-			if (m_uNumDebugPoints < ms_uNumDebugPoints)
-			{
-				m_arrDebugPointList.at(m_uNumDebugPoints++)
-					.Set(vWorldPosition, vColour);
-			}
+			m_tDebugDraw.AddPoint(vWorldPosition, vColour, fDuration);
 		}
 		FORCEINLINE_DEBUGGABLE void
 		AddDebugLine(const IOEVector &vWorldStart, const IOEVector &vWorldEnd,
 					 const IOEVector &vStartColour = Maths::ColourList::Red,
-					 const IOEVector &vEndColour = Maths::ColourList::Red)
+					 const IOEVector &vEndColour = Maths::ColourList::Red,
+					 float fDuration = 0.0f)
 		{
-			IOE_ASSERT(m_uNumDebugLines < ms_uNumDebugLines,
-					   "Too many lines! Increase static buffer size");
-
-			if (m_uNumDebugLines < ms_uNumDebugLines)
-			{
-				m_arrDebugLineList.at((m_uNumDebugLines * 2))
-					.Set(vWorldStart, vStartColour);
-				m_arrDebugLineList.at((m_uNumDebugLines * 2) + 1)
-					.Set(vWorldEnd, vEndColour);
-			}
-
-			++m_uNumDebugLines;
+			m_tDebugDraw.AddLine(vWorldStart, vWorldEnd, vStartColour,
+								 vEndColour, fDuration);
 		}
 		FORCEINLINE_DEBUGGABLE void
 		AddDebugTriangle(const IOEVector &vP0, const IOEVector &vP1,
 						 const IOEVector &vP2,
 						 const IOEVector &vColour0 = Maths::ColourList::Red,
 						 const IOEVector &vColour1 = Maths::ColourList::Red,
-						 const IOEVector &vColour2 = Maths::ColourList::Red)
+						 const IOEVector &vColour2 = Maths::ColourList::Red,
+						 float fDuration = 0.0f)
 		{
-			IOE_ASSERT(m_uNumDebugTriangles < ms_uNumDebugTriangles,
-					   "Too many triangles! Increase static buffer size");
-
-			if (m_uNumDebugTriangles < ms_uNumDebugTriangles)
-			{
-				m_arrDebugTriangleList.at((m_uNumDebugTriangles * 3))
-					.Set(vP0, vColour0);
-				m_arrDebugTriangleList.at((m_uNumDebugTriangles * 3) + 1)
-					.Set(vP1, vColour1);
-				m_arrDebugTriangleList.at((m_uNumDebugTriangles * 3) + 2)
-					.Set(vP2, vColour2);
-
-				++m_uNumDebugTriangles;
-			}
+			m_tDebugDraw.AddTriangle(vP0, vP1, vP2, vColour0, vColour1,
+									 vColour2, fDuration);
+		}
+		FORCEINLINE_DEBUGGABLE void
+		AddDebugBox(const IOEVector &vCentre, const IOEVector &vExtents,
+					const IOEVector &vColour = Maths::ColourList::Red,
+					float fDuration = 0.0f)
+		{
+			m_tDebugDraw.AddBox(vCentre, vExtents, vColour, fDuration);
 		}
 
-		void AddDebugBox(const IOEVector &vCentre, const IOEVector &vExtents,
-						 const IOEVector &vColour = Maths::ColourList::Red);
-
-		FORCEINLINE_DEBUGGABLE void FlushDebugBuffers()
+		// Batches for boxes, frusta, spheres and lists of lines
+		FORCEINLINE IOEDebugDraw &GetDebugDraw()
 		{
-			m_uNumDebugPoints	= 0;
-			m_uNumDebugLines	 = 0;
-			m_uNumDebugTriangles = 0;
+			return m_tDebugDraw;
 		}
 
 		FORCEINLINE const IOERasterizerState &GetRasterizerState() const
 		{
 			return m_tRasterizerState;
 		}
-		FORCEINLINE void SetRasterizerState(const IOERasterizerState &rhs)
-		{
-			m_tPlatform.SetRasterizerState(rhs);
-		}
-		FORCEINLINE void SetDepthState(const IOEDepthState &rhs,
-									   std::uint32_t uStencilRef = 0)
+		FORCEINLINE const IOEBlendState &GetBlendState() const
 		{
-			m_tPlatform.SetDepthState(rhs, uStencilRef);
-		}
-		FORCEINLINE void
-		SetBlendState(const IOEBlendState &rhs,
-					  std::uint32_t uWriteMask = 0xFFFFFFFF,
-					  const IOE::Maths::IOEVector &arrBlendFactor =
-						  IOE::Maths::g_vOneVector)
-		{
-			m_tPlatform.SetBlendState(rhs, uWriteMask, arrBlendFactor);
+			return m_tBlendState;
 		}
+		void SetRasterizerState(const IOERasterizerState &rhs);
+		void SetDepthState(const IOEDepthState &rhs,
+						   std::uint32_t uStencilRef = 0);
+		void SetBlendState(const IOEBlendState &rhs,
+						   std::uint32_t uWriteMask = 0xFFFFFFFF,
+						   const IOE::Maths::IOEVector &arrBlendFactor =
+							   IOE::Maths::g_vOneVector);
 
 		FORCEINLINE const IOEDepthState &GetDefaultDepthState() const
 		{
@@ -789,42 +1064,28 @@ namespace Renderer
 		}
 
 	public:
+		// The primitives merged for this frame, valid until it is presented
 		std::uint32_t WriteDebugData(DebugVertex *pStartVertices)
 		{
-			if (m_uNumDebugPoints)
-			{
-				memcpy(pStartVertices, m_arrDebugPointList.data(),
-					   m_uNumDebugPoints * sizeof(DebugVertex));
-				pStartVertices += m_uNumDebugPoints;
-			}
-			if (m_uNumDebugLines)
-			{
-				memcpy(pStartVertices, m_arrDebugLineList.data(),
-					   m_uNumDebugLines * sizeof(DebugVertex) * 2);
-				pStartVertices += m_uNumDebugLines * 2;
-			}
-			if (m_uNumDebugTriangles)
-			{
-				memcpy(pStartVertices, m_arrDebugTriangleList.data(),
-					   m_uNumDebugTriangles * sizeof(DebugVertex) * 3);
-				pStartVertices += m_uNumDebugTriangles * 3;
-			}
 			// Return num bytes written to buffer
-			return (m_uNumDebugPoints + m_uNumDebugLines * 2 +
-					m_uNumDebugTriangles * 3) *
-				sizeof(DebugVertex);
+			return m_tDebugDraw.Write(pStartVertices) *
+				static_cast<std::uint32_t>(sizeof(DebugVertex));
+		}
+		std::uint32_t GetNumDebugVertices() const
+		{
+			return m_tDebugDraw.GetNumVertices();
 		}
 		std::uint32_t GetNumDebugPoints() const
 		{
-			return m_uNumDebugPoints;
+			return m_tDebugDraw.GetNumPrimitives(EDebugPrimitive::Point);
 		}
 		std::uint32_t GetNumDebugLines() const
 		{
-			return m_uNumDebugLines;
+			return m_tDebugDraw.GetNumPrimitives(EDebugPrimitive::Line);
 		}
 		std::uint32_t GetNumDebugTriangles() const
 		{
-			return m_uNumDebugTriangles;
+			return m_tDebugDraw.GetNumPrimitives(EDebugPrimitive::Triangle);
 		}
 
 	public:
@@ -857,6 +1118,65 @@ namespace Renderer
 			return m_uCurrentMaterialIndex;
 		}
 
+		// Removes the shader bound to a stage, if any
+		void UnsetShader(EShaderType::Enum eShaderType);
+
+		// Instance whose variables were last applied, reset whenever the
+		// material's values or bindings may have been changed by others
+		FORCEINLINE void
+		SetMaterialInstance(const class IOEMaterialInstance *pInstance)
+		{
+			m_pCurrentMaterialInstance = pInstance;
+		}
+		FORCEINLINE const class IOEMaterialInstance *
+		GetMaterialInstance() const
+		{
+			return m_pCurrentMaterialInstance;
+		}
+
+	private:
+		struct IOETextureSamplerSlot
+		{
+			IOETextureSamplerSlot(std::uint64_t uNameHash_,
+								  const std::string &szName_)
+				: uNameHash(uNameHash_)
+				, szName(szName_)
+				, pSampler(nullptr)
+			{
+			}
+
+			std::uint64_t uNameHash;
+			std::string szName;
+			IOESamplerState *pSampler;
+		};
+
+		struct IOEBoundTexture
+		{
+			IOEBoundTexture()
+				: pTexture(nullptr)
+				, uGeneration(0)
+			{
+			}
+
+			void Set(const IOETexture *pTexture_)
+			{
+				pTexture	= pTexture_;
+				uGeneration = pTexture_ != nullptr ? pTexture_->GetGeneration()
+												   : 0;
+			}
+
+			const IOETexture *pTexture;
+			std::uint32_t uGeneration;
+		};
+
+		// Passes a bind on when its key differs from the one bound last.
+		// A key of zero is never taken as bound.
+		bool FilterBind(ERPIBind::Enum eBind, std::uint64_t uKey);
+
+		std::uint64_t GetRenderTargetsKey() const;
+		bool FilterRenderTargets(std::uint64_t uPreviousKey);
+		void OnOutputMergerRefreshed();
+
 	private:
 		IOE::Maths::IOECamera m_mCamera;
 		IOE::Maths::IOECamera m_mDefaultCamera;
@@ -870,19 +1190,10 @@ namespace Renderer
 		shared_ptr<class IOEMaterial> m_pDebugDrawShader;
 		// IOEShader m_tDebugDrawShaderWidth;
 
-		std::array<DebugVertex, ms_uNumDebugPoints> m_arrDebugPointList;
-		std::uint32_t m_uNumDebugPoints;
-
-		std::array<DebugVertex, ms_uNumDebugLines * 2> m_arrDebugLineList;
-		std::uint32_t m_uNumDebugLines;
-
-		std::array<DebugVertex, ms_uNumDebugTriangles * 3>
-			m_arrDebugTriangleList;
-		std::uint32_t m_uNumDebugTriangles;
+		IOEDebugDraw m_tDebugDraw;
 
 		std::vector<IOEViewport> m_arrViewports;
-		std::vector<std::pair<std::string, IOESamplerState *> >
-			m_arrTextureSamplers;
+		std::vector<IOETextureSamplerSlot> m_arrTextureSamplers;
 
 		IOERasterizerState m_tRasterizerState;
 		IOEBlendState m_tBlendState;
@@ -891,9 +1202,29 @@ namespace Renderer
 
 		EPrimitiveTopology m_eTopology;
 
+		// Targets the platform holds, bound or not, and the key of each bind
+		// last passed on. The UAV keys are of the last whole set, and are
+		// cleared by any single UAV change.
+		std::array<IOEBoundTexture, ms_uMaxRenderTargets> m_arrRenderTargets;
+		IOEBoundTexture m_tDepthTarget;
+		std::array<std::uint64_t, ERPIBind::NumBinds> m_arrBoundKeys;
+		std::array<std::uint64_t, 2> m_arrUAVKeys;
+
+		IOERPIBindStats m_tBindStats;
+		IOERPIBindStats m_tLastFrameBindStats;
+
+		IOERenderStats m_tRenderStats;
+		IOEEngineConstants m_tEngineConstants;
+		IOEShaderCache m_tShaderCache;
+		IOEStateCache m_tStateCache;
+
+		std::array<IOEUploadRing, EUploadRing::NumRings> m_arrUploadRings;
+		std::uint64_t m_uUploadFrame;
+
 	private:
 		std::uint32_t m_uCurrentMaterialIndex;
 		std::uint32_t m_arrCurrentShaderIndexes[EShaderType::NumShaders];
+		const class IOEMaterialInstance *m_pCurrentMaterialInstance;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
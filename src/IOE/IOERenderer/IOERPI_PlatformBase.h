@@ -4,7 +4,10 @@
 
 #include "IOEComSharedPtr.h"
 #include <IOE/IOECore/IOEDefines.h>
+#include <IOE/IOECore/IOESpan.h>
 #include <IOE/IOERenderer/IOETexture.h>
+#include <IOE/IOERenderer/IOEUploadRing.h>
+#include "IOEShader_PlatformBase.h"
 
 namespace IOE
 {
@@ -23,6 +26,8 @@ namespace Renderer
 	struct IOESamplerState;
 	struct IOEDepthState;
 
+	typedef IOE::Core::IOESpan<IOETexture *const> IOETextureSpan;
+
 	//////////////////////////////////////////////////////////////////////////
 
 	enum class EProfileMarkerType
@@ -165,6 +170,10 @@ namespace Renderer
 		virtual void FinishRender() = 0;
 
 		virtual void ResetState() = 0;
+		virtual void UnsetShader(EShaderType::Enum eShaderType) = 0;
+
+		// Binds a constant buffer at uSlot of every shader stage
+		virtual void SetConstantBuffer(std::uint32_t uSlot, IOEBufferBase *pBuffer) = 0;
 
 		virtual void SetRasterizerState(const IOERasterizerState &rhs)									   = 0;
 		virtual void SetBlendState(const IOEBlendState &rhs, std::uint32_t uWriteMask = 0xFFFFFFFF,
@@ -175,12 +184,12 @@ namespace Renderer
 		virtual void UnsetRenderTarget(int32_t nRenderTarget = 0)											= 0;
 		virtual void SetRenderTarget(IOE::Renderer::IOETexture & rTexture, int32_t nRenderTargetIdx = 0,
 									 bool bSet = true)														= 0;
-		virtual void SetRenderTargets(std::vector<IOE::Renderer::IOETexture> arrTextures, bool bSet = true) = 0;
+		virtual void SetRenderTargets(IOETextureSpan arrTextures, bool bSet = true)							= 0;
 
 		virtual void UnsetUAV(int32_t nUAV, EUAVSet bSet)									   = 0;
 		virtual void SetUAV(IOE::Renderer::IOETexture & rTexture, int32_t nUAVIdx, EUAVSet bSet,
 							int arrOffset = 0)												   = 0;
-		virtual void SetUAVs(std::vector<IOE::Renderer::IOETexture> arrTextures, EUAVSet bSet) = 0;
+		virtual void SetUAVs(IOETextureSpan arrTextures, EUAVSet bSet)							   = 0;
 
 		virtual void SetDepthTarget(IOE::Renderer::IOETexture & rDepthTexture, bool bSet = true) = 0;
 
@@ -188,6 +197,20 @@ namespace Renderer
 								IOEBufferBase *pIndexBuffer = nullptr, std::int32_t nNumElements = -1) = 0;
 		virtual void SetPrimitiveTopology(EPrimitiveTopology eTopology)								   = 0;
 
+		// Signalled by the RPI as each frame is submitted
+		virtual IOEGPUFence *GetFence() = 0;
+
+		// Creates the buffer behind an upload ring, failing when the device cannot bind that kind of data at an
+		// offset. Mapping must keep the rest of the buffer as it was, as the GPU may still be reading from it.
+		virtual bool CreateUploadRing(EUploadRing::Enum eRing, std::uint32_t uSizeBytes)					  = 0;
+		virtual void *MapUploadRing(EUploadRing::Enum eRing, std::uint32_t uOffset, std::uint32_t uSizeBytes) = 0;
+		virtual void UnmapUploadRing(EUploadRing::Enum eRing)												  = 0;
+
+		// Draws vertices of uStride bytes from uOffset in the vertex ring. uNumElements counts the indices when
+		// there is an index buffer.
+		virtual void DrawUploadBuffer(std::uint32_t uOffset, std::uint32_t uStride, EPrimitiveTopology eTopology,
+									  std::uint32_t uNumElements, IOEBufferBase *pIndexBuffer = nullptr) = 0;
+
 		virtual void SetProfileMarker(const std::string &szProfilerMark, EProfileMarkerType eProfileMarker,
 									  const IOE::Maths::IOEVector &vColour) = 0;
 
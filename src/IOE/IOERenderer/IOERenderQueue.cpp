@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <cstring>
+
+#include "IOERenderQueue.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOERenderQueue g_tRenderQueue;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		const std::uint32_t g_uRadixBits  = 8;
+		const std::uint32_t g_uRadixSize  = 1 << g_uRadixBits;
+		const std::uint32_t g_uNumPasses  = 64 / g_uRadixBits;
+		const std::uint64_t g_uRadixMask  = g_uRadixSize - 1;
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOERenderQueue::IOERenderQueue()
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERenderQueue::Add(const IOERenderQueueItem &rItem, IOEModel *pModel,
+							 std::uint32_t uSubset)
+	{
+		Bucket &rBucket(m_tBuckets.local());
+
+		IOERenderQueueDraw tDraw;
+		tDraw.pModel  = pModel;
+		tDraw.uSubset = uSubset;
+
+		rBucket.arrKeys.push_back(rItem.GetRenderCommandID());
+		rBucket.arrDraws.push_back(tDraw);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERenderQueue::AddCommand(const IOERenderQueueItem &rItem)
+	{
+		IOE_ASSERT(rItem.GetRenderCommandType() !=
+					   ERenderCommandType::NoCustomCommand,
+				   "Draws must be added with their model");
+		Add(rItem, nullptr, 0);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERenderQueue::Sort()
+	{
+		std::size_t uNumItems(0);
+		for (const Bucket &rBucket : m_tBuckets)
+		{
+			uNumItems += rBucket.arrKeys.size();
+		}
+
+		m_arrDraws.resize(uNumItems);
+		m_arrSorted.resize(uNumItems);
+
+		std::uint32_t uBase(0);
+		for (const Bucket &rBucket : m_tBuckets)
+		{
+			const std::uint32_t uCount(
+				static_cast<std::uint32_t>(rBucket.arrKeys.size()));
+			if (uCount == 0)
+			{
+				continue;
+			}
+
+			std::memcpy(&m_arrDraws[uBase], rBucket.arrDraws.data(),
+						uCount * sizeof(IOERenderQueueDraw));
+			for (std::uint32_t uIdx(0); uIdx < uCount; ++uIdx)
+			{
+				m_arrSorted[uBase + uIdx].uKey   = rBucket.arrKeys[uIdx];
+				m_arrSorted[uBase + uIdx].uIndex = uBase + uIdx;
+			}
+			uBase += uCount;
+		}
+
+		RadixSort();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERenderQueue::RadixSort()
+	{
+		const std::size_t uNumItems(m_arrSorted.size());
+		if (uNumItems < 2)
+		{
+			return;
+		}
+		m_arrScratch.resize(uNumItems);
+
+		// One read of the keys counts the digits for every pass
+		std::vector<std::uint32_t> arrCounts(g_uNumPasses * g_uRadixSize, 0);
+		for (const SortEntry &rEntry : m_arrSorted)
+		{
+			std::uint64_t uKey(rEntry.uKey);
+			for (std::uint32_t uPass(0); uPass < g_uNumPasses; ++uPass)
+			{
+				++arrCounts[uPass * g_uRadixSize + (uKey & g_uRadixMask)];
+				uKey >>= g_uRadixBits;
+			}
+		}
+
+		SortEntry *pSrc(m_arrSorted.data());
+		SortEntry *pDst(m_arrScratch.data());
+		for (std::uint32_t uPass(0); uPass < g_uNumPasses; ++uPass)
+		{
+			const std::uint32_t uShift(uPass * g_uRadixBits);
+			std::uint32_t *pCounts(&arrCounts[uPass * g_uRadixSize]);
+
+			// A digit every key shares leaves the order as it is
+			const std::uint64_t uFirstDigit((pSrc[0].uKey >> uShift) &
+											g_uRadixMask);
+			if (pCounts[uFirstDigit] == uNumItems)
+			{
+				continue;
+			}
+
+			std::uint32_t uOffset(0);
+			for (std::uint32_t uDigit(0); uDigit < g_uRadixSize; ++uDigit)
+			{
+				const std::uint32_t uCount(pCounts[uDigit]);
+				pCounts[uDigit] = uOffset;
+				uOffset += uCount;
+			}
+
+			for (std::size_t uIdx(0); uIdx < uNumItems; ++uIdx)
+			{
+				const std::uint64_t uDigit((pSrc[uIdx].uKey >> uShift) &
+										   g_uRadixMask);
+				pDst[pCounts[uDigit]++] = pSrc[uIdx];
+			}
+			std::swap(pSrc, pDst);
+		}
+
+		if (pSrc != m_arrSorted.data())
+		{
+			m_arrSorted.swap(m_arrScratch);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERenderQueue::Clear()
+	{
+		for (Bucket &rBucket : m_tBuckets)
+		{
+			rBucket.arrKeys.clear();
+			rBucket.arrDraws.clear();
+		}
+		m_arrDraws.clear();
+		m_arrSorted.clear();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
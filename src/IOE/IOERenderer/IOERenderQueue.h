@@ -1,7 +1,11 @@
 #pragma once
 
-#include <array>
 #include <cstdint>
+#include <vector>
+
+#include <tbb/enumerable_thread_specific.h>
+
+#include <IOE/IOECore/IOEPortable.h>
 
 namespace IOE
 {
@@ -10,9 +14,15 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	class IOEModel;
+	class IOERPI;
+
+	//////////////////////////////////////////////////////////////////////////
+
 	enum class ERenderCommand : std::uint32_t
 	{
-		ClearScreen
+		ClearScreen,
+		ClearDepth
 	};
 
 	//////////////////////////////////////////////////////////////////////////
@@ -49,9 +59,9 @@ namespace Renderer
 
 //////////////////////////////////////////////////////////////////////////
 
-#define GET_RENDER_MASK(num_bits) ((1 << (num_bits)) - 1)
+#define GET_RENDER_MASK(num_bits) ((std::uint64_t(1) << (num_bits)) - 1)
 #define SHIFT_RENDER_MASK(value, mask_bits, shift_bits)                       \
-	((static_cast<std::uint32_t>(value) & GET_RENDER_MASK(mask_bits))         \
+	((static_cast<std::uint64_t>(value) & GET_RENDER_MASK(mask_bits))         \
 	 << shift_bits)
 
 	struct IOERenderQueueItem
@@ -60,41 +70,33 @@ namespace Renderer
 		 * The ID of the render command. This is used to sort the render queue
 		 * to ensure the fewest state changes possible.
 		 *
-		 *																			+---------------------+
-		 *                                                                          |
-		 *22                  |
-		 *			+-------------+----------+-------+-------------+----------------+-------+-------------+
-		 * Bits:	| 2           | 3        | 2     | 1           | 2
-		 *| 5     | 17          |
-		 *			+-------------+----------+-------+-------------+----------------+-------+-------------+
-		 * Meaning	| Render Mode | Viewport | Layer | Translucent | Custom
-		 *Command | Depth | Material ID |
-		 *			+-------------+----------+-------+-------------+----------------+-------+-------------+
-		 *																			| Custom command enum
-		 *|
-		 *																			+---------------------+
+		 *                                                 +------------------+
+		 *                                                 |        54        |
+		 *         +------+----------+-------+-------+-----+--------+---------+
+		 * Bits:   | 2    | 3        | 2     | 1     | 2   | 24     | 30      |
+		 *         +------+----------+-------+-------+-----+--------+---------+
+		 * Meaning | Mode | Viewport | Layer | Trans | Cmd | Depth  | Mat ID  |
+		 *         +------+----------+-------+-------+-----+--------+---------+
+		 *                                                 | Command enum     |
+		 *                                                 +------------------+
 		 *
 		 * Render mode: Normal, Post-effect or HUD
 		 * Viewport: Viewports 0 - 7
 		 * Layer: Individual layer within a viewport (0 - 3)
 		 * Translucent: opaque or translucent
 		 * Custom Command: Either pre-draw calls (0), an ordinary draw call (1)
-		 *or a post-draw call (2).
-		 *  If anything other than 1, then depth/material id are treated as a
-		 *custom command enum.
-		 * Depth: Custom depth sorting for the object
-		 * Material ID: A unique ID for a material. 17 bits allows us 131k
-		 *unique materials which should
-		 *	certainly be plentiful for any future situations. Could always
-		 *decrease depth to give us more
-		 *  materials if needed.
+		 *  or a post-draw call (2). If anything other than 1, then depth and
+		 *  material id are treated as a custom command enum.
+		 * Depth: Custom depth sorting for the object, see QuantiseDepth
+		 * Material ID: A unique ID for a material, or the pipeline ID the
+		 *  RPI's state cache gives the shaders, vertex format and states.
 		 * Custom command enum: If custom command is anything other than 1,
-		 *then we treat this as a single
-		 *  enum and match it against specific render commands.
+		 *  then we treat this as a single enum and match it against specific
+		 *  render commands.
 		 */
 
-		static const std::uint32_t NUM_BITS_MATERIAL_ID = 17;
-		static const std::uint32_t NUM_BITS_DEPTH		= 5;
+		static const std::uint32_t NUM_BITS_MATERIAL_ID = 30;
+		static const std::uint32_t NUM_BITS_DEPTH		= 24;
 		static const std::uint32_t NUM_BITS_RENDER_COMMAND =
 			NUM_BITS_MATERIAL_ID + NUM_BITS_DEPTH;
 		static const std::uint32_t NUM_BITS_CUSTOM_COMMAND = 2;
@@ -106,28 +108,33 @@ namespace Renderer
 		static const std::uint32_t BIT_POS_MATERIAL_ID = 0;
 		static const std::uint32_t BIT_POS_DEPTH =
 			BIT_POS_MATERIAL_ID + NUM_BITS_MATERIAL_ID;
-		static const std::uint32_t BIT_POS_RENDER_COMMAND = BIT_POS_DEPTH;
+		static const std::uint32_t BIT_POS_RENDER_COMMAND = BIT_POS_MATERIAL_ID;
 		static const std::uint32_t BIT_POS_CUSTOM_COMMAND =
 			BIT_POS_DEPTH + NUM_BITS_DEPTH;
 		static const std::uint32_t BIT_POS_TRANSLUCENT =
-			BIT_POS_CUSTOM_COMMAND + BIT_POS_CUSTOM_COMMAND;
+			BIT_POS_CUSTOM_COMMAND + NUM_BITS_CUSTOM_COMMAND;
 		static const std::uint32_t BIT_POS_LAYER =
-			BIT_POS_TRANSLUCENT + BIT_POS_TRANSLUCENT;
+			BIT_POS_TRANSLUCENT + NUM_BITS_TRANSLUCENT;
 		static const std::uint32_t BIT_POS_VIEWPORT =
 			BIT_POS_LAYER + NUM_BITS_LAYER;
 		static const std::uint32_t BIT_POS_RENDER_MODE =
 			BIT_POS_VIEWPORT + NUM_BITS_VIEWPORT;
 
-		static_assert(BIT_POS_RENDER_MODE + NUM_BITS_RENDER_MODE == 32,
-					  "All subsections of command must add up to 32 bits");
+		static_assert(BIT_POS_RENDER_MODE + NUM_BITS_RENDER_MODE == 64,
+					  "All subsections of command must add up to 64 bits");
 
 		IOERenderQueueItem()
 			: m_uCommandID(0)
 		{
 		}
 
+		explicit IOERenderQueueItem(std::uint64_t uCommandID)
+			: m_uCommandID(uCommandID)
+		{
+		}
+
 	public:
-		std::uint32_t GetRenderCommandID() const
+		std::uint64_t GetRenderCommandID() const
 		{
 			return m_uCommandID;
 		}
@@ -155,7 +162,7 @@ namespace Renderer
 		FORCEINLINE_DEBUGGABLE void
 		SetRenderCommandID(ERenderMode eRenderMode, EViewport eViewport,
 						   std::uint8_t uViewportLayer, bool bTranslucent,
-						   std::uint8_t uDepth, std::uint32_t uMaterialID)
+						   std::uint32_t uDepth, std::uint32_t uMaterialID)
 		{
 			m_uCommandID = SHIFT_RENDER_MASK(eRenderMode, NUM_BITS_RENDER_MODE,
 											 BIT_POS_RENDER_MODE) |
@@ -165,26 +172,129 @@ namespace Renderer
 								  BIT_POS_LAYER) |
 				SHIFT_RENDER_MASK(bTranslucent, NUM_BITS_TRANSLUCENT,
 								  BIT_POS_TRANSLUCENT) |
+				SHIFT_RENDER_MASK(ERenderCommandType::NoCustomCommand,
+								  NUM_BITS_CUSTOM_COMMAND,
+								  BIT_POS_CUSTOM_COMMAND) |
 				SHIFT_RENDER_MASK(uDepth, NUM_BITS_DEPTH, BIT_POS_DEPTH) |
 				SHIFT_RENDER_MASK(uMaterialID, NUM_BITS_MATERIAL_ID,
 								  BIT_POS_MATERIAL_ID);
 		}
 
+		FORCEINLINE ERenderCommandType GetRenderCommandType() const
+		{
+			return static_cast<ERenderCommandType>(
+				(m_uCommandID >> BIT_POS_CUSTOM_COMMAND) &
+				GET_RENDER_MASK(NUM_BITS_CUSTOM_COMMAND));
+		}
+
+		// Only meaningful for custom commands
+		FORCEINLINE ERenderCommand GetRenderCommand() const
+		{
+			return static_cast<ERenderCommand>(
+				(m_uCommandID >> BIT_POS_RENDER_COMMAND) &
+				GET_RENDER_MASK(NUM_BITS_RENDER_COMMAND));
+		}
+
+		// Maps a depth from 0 at the near plane to 1 at the far plane onto the
+		// depth bits. Translucent items are inverted so they sort back to
+		// front.
+		static std::uint32_t QuantiseDepth(float fDepth, bool bTranslucent)
+		{
+			const std::uint32_t uMax(
+				static_cast<std::uint32_t>(GET_RENDER_MASK(NUM_BITS_DEPTH)));
+			const float fClamped(
+				fDepth < 0.0f ? 0.0f : (fDepth > 1.0f ? 1.0f : fDepth));
+			const std::uint32_t uDepth(static_cast<std::uint32_t>(
+				fClamped * static_cast<float>(uMax)));
+			return bTranslucent ? uMax - uDepth : uDepth;
+		}
+
 	private:
-		std::uint32_t m_uCommandID;
+		std::uint64_t m_uCommandID;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// The subset of a model an item draws. Custom commands draw nothing.
+	struct IOERenderQueueDraw
+	{
+		IOEModel *pModel;
+		std::uint32_t uSubset;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
 
+	// Draws and commands for one frame, submitted in any order from any
+	// number of threads then executed sorted by their keys.
+	//
+	// Each thread appends to its own bucket, so submission takes no locks
+	// once a thread has made its first submission. Sort merges the buckets
+	// and orders them with a stable least significant digit radix sort on
+	// the 64-bit keys, carrying the index of each item's draw. Eight bits
+	// are sorted per pass, skipping digits that every key shares, which
+	// with only a few modes and viewports in use is most of the upper ones.
 	class IOERenderQueue
 	{
-		static const std::int32_t ms_nRenderQueueCount = 16 * 1024;
+	public:
+		IOERenderQueue();
 
 	public:
+		// Safe to call from any number of threads at once, but not at the
+		// same time as Sort, Execute or Clear
+		void Add(const IOERenderQueueItem &rItem, IOEModel *pModel,
+				 std::uint32_t uSubset);
+		void AddCommand(const IOERenderQueueItem &rItem);
+
+		// Merges every thread's items and sorts them by key. Items with
+		// equal keys stay in their thread's submission order.
+		void Sort();
+
+		// Runs the sorted items in order. Neighbouring draws of one model
+		// are issued as a single draw of those subsets.
+		void Execute(IOERPI *pRPI, bool bSetShaderParams = true);
+
+		// Drops every item, keeping the memory for the next frame
+		void Clear();
+
+		// Items in sorted order, valid after Sort
+		FORCEINLINE std::uint32_t GetNumItems() const
+		{
+			return static_cast<std::uint32_t>(m_arrSorted.size());
+		}
+		FORCEINLINE IOERenderQueueItem GetItem(std::uint32_t uIdx) const
+		{
+			return IOERenderQueueItem(m_arrSorted[uIdx].uKey);
+		}
+		FORCEINLINE const IOERenderQueueDraw &
+		GetDraw(std::uint32_t uIdx) const
+		{
+			return m_arrDraws[m_arrSorted[uIdx].uIndex];
+		}
+
+	private:
+		struct Bucket
+		{
+			std::vector<std::uint64_t> arrKeys;
+			std::vector<IOERenderQueueDraw> arrDraws;
+		};
+
+		struct SortEntry
+		{
+			std::uint64_t uKey;
+			std::uint32_t uIndex;
+		};
+
+	private:
+		void RadixSort();
+		void ExecuteCommand(IOERPI *pRPI, ERenderCommand eCommand);
+
 	private:
-		std::array<IOERenderQueueItem, ms_nRenderQueueCount> m_arrQueue;
+		tbb::enumerable_thread_specific<Bucket> m_tBuckets;
 
-		std::int32_t m_nNumQueue;
+		std::vector<IOERenderQueueDraw> m_arrDraws;
+		std::vector<SortEntry> m_arrSorted;
+		std::vector<SortEntry> m_arrScratch;
+		std::vector<std::uint32_t> m_arrRunSubsets;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,72 @@
+#include <IOE/IOERenderer/IOEModel.h>
+#include <IOE/IOERenderer/IOERPI.h>
+
+#include "IOERenderQueue.h"
+
+//////////////////////////////////////////////////////////////////////////
+// Execution lives apart from the rest of IOERenderQueue.cpp so queueing
+// and sorting link without the RPI or models, as in RenderQueueTest.
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERenderQueue::Execute(IOERPI *pRPI,
+								 bool bSetShaderParams /*=true*/)
+	{
+		const std::size_t uNumItems(m_arrSorted.size());
+		std::size_t uIdx(0);
+		while (uIdx < uNumItems)
+		{
+			const IOERenderQueueItem tItem(m_arrSorted[uIdx].uKey);
+			if (tItem.GetRenderCommandType() !=
+				ERenderCommandType::NoCustomCommand)
+			{
+				ExecuteCommand(pRPI, tItem.GetRenderCommand());
+				++uIdx;
+				continue;
+			}
+
+			IOEModel *pModel(m_arrDraws[m_arrSorted[uIdx].uIndex].pModel);
+			m_arrRunSubsets.clear();
+			for (; uIdx < uNumItems; ++uIdx)
+			{
+				const IOERenderQueueDraw &rDraw(
+					m_arrDraws[m_arrSorted[uIdx].uIndex]);
+				if (rDraw.pModel != pModel)
+				{
+					break;
+				}
+				m_arrRunSubsets.push_back(rDraw.uSubset);
+			}
+
+			pModel->OnRender(
+				pRPI, m_arrRunSubsets.data(),
+				static_cast<std::uint32_t>(m_arrRunSubsets.size()),
+				bSetShaderParams);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERenderQueue::ExecuteCommand(IOERPI *pRPI, ERenderCommand eCommand)
+	{
+		switch (eCommand)
+		{
+		case ERenderCommand::ClearScreen:
+			pRPI->Clear();
+			break;
+		case ERenderCommand::ClearDepth:
+			pRPI->ClearDepth();
+			break;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,166 @@
+#include <cstdio>
+
+#include "IOERPI.h"
+#include "IOERenderStats.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace ERenderStat
+	{
+		const char *ToName(Enum eStat)
+		{
+			switch (eStat)
+			{
+			case Draws:
+				return "Draws";
+			case Triangles:
+				return "Triangles";
+			case StateChanges:
+				return "State Changes";
+			case ConstantBufferMaps:
+				return "CBuffer Maps";
+			case TextureBinds:
+				return "Texture Binds";
+			case VisibleSubsets:
+				return "Visible Subsets";
+			case UploadBytes:
+				return "Upload Bytes";
+			case NumStats:
+			default:
+				return "Unknown";
+			}
+		}
+	} // namespace ERenderStat
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOERenderStats::IOERenderStats()
+		: m_arrHistory(ms_uWindowSize)
+	{
+		Reset();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERenderStats::AddDraw(EPrimitiveTopology eTopology,
+								 std::uint64_t uNumVertices,
+								 std::uint64_t uNumInstances /*=1*/)
+	{
+		std::uint64_t uNumTriangles(0);
+		switch (eTopology)
+		{
+		case EPrimitiveTopology::TriangleList:
+			uNumTriangles = uNumVertices / 3;
+			break;
+		case EPrimitiveTopology::TriangleListWithAdjacency:
+			uNumTriangles = uNumVertices / 6;
+			break;
+		case EPrimitiveTopology::TriangleStrip:
+			uNumTriangles = uNumVertices > 2 ? uNumVertices - 2 : 0;
+			break;
+		case EPrimitiveTopology::TriangleStripWithAdjacency:
+			uNumTriangles = uNumVertices > 5 ? (uNumVertices - 4) / 2 : 0;
+			break;
+		default:
+			break;
+		}
+
+		++m_arrCurrent[ERenderStat::Draws];
+		m_arrCurrent[ERenderStat::Triangles] += uNumTriangles * uNumInstances;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERenderStats::EndFrame()
+	{
+		Counters &rFrame(m_arrHistory[m_uNextFrame]);
+		for (std::uint32_t uStat(0); uStat < ERenderStat::NumStats; ++uStat)
+		{
+			if (m_uNumFrames == ms_uWindowSize)
+			{
+				m_arrSum[uStat] -= rFrame[uStat];
+			}
+			m_arrSum[uStat] += m_arrCurrent[uStat];
+		}
+		rFrame = m_arrCurrent;
+		m_arrCurrent.fill(0);
+
+		m_uNextFrame = (m_uNextFrame + 1) % ms_uWindowSize;
+		if (m_uNumFrames < ms_uWindowSize)
+		{
+			++m_uNumFrames;
+		}
+
+		m_arrMin = m_arrHistory[GetLastFrameIdx()];
+		m_arrMax = m_arrMin;
+		for (std::uint32_t uFrame(0); uFrame < m_uNumFrames; ++uFrame)
+		{
+			const Counters &rCounters(m_arrHistory[uFrame]);
+			for (std::uint32_t uStat(0); uStat < ERenderStat::NumStats;
+				 ++uStat)
+			{
+				if (rCounters[uStat] < m_arrMin[uStat])
+				{
+					m_arrMin[uStat] = rCounters[uStat];
+				}
+				if (rCounters[uStat] > m_arrMax[uStat])
+				{
+					m_arrMax[uStat] = rCounters[uStat];
+				}
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERenderStats::Reset()
+	{
+		m_arrCurrent.fill(0);
+		m_arrSum.fill(0);
+		m_arrMin.fill(0);
+		m_arrMax.fill(0);
+		m_uNextFrame = 0;
+		m_uNumFrames = 0;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::string IOERenderStats::Format(ERenderStat::Enum eStat) const
+	{
+		char szBuffer[96];
+		std::snprintf(szBuffer, sizeof(szBuffer), "%llu (%llu/%.1f/%llu)",
+					  static_cast<unsigned long long>(GetLast(eStat)),
+					  static_cast<unsigned long long>(GetMin(eStat)),
+					  GetAverage(eStat),
+					  static_cast<unsigned long long>(GetMax(eStat)));
+		return szBuffer;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::string IOERenderStats::FormatCurrent() const
+	{
+		std::string szResult("Render Stats:");
+		for (std::uint32_t uStat(0); uStat < ERenderStat::NumStats; ++uStat)
+		{
+			char szBuffer[64];
+			std::snprintf(
+				szBuffer, sizeof(szBuffer), " %s=%llu",
+				ERenderStat::ToName(static_cast<ERenderStat::Enum>(uStat)),
+				static_cast<unsigned long long>(m_arrCurrent[uStat]));
+			szResult += szBuffer;
+		}
+		return szResult;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,140 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <IOE/IOECore/IOEDefines.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	enum class EPrimitiveTopology;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace ERenderStat
+	{
+		enum Enum
+		{
+			Draws,
+			Triangles,
+			StateChanges,
+			ConstantBufferMaps,
+			TextureBinds,
+			VisibleSubsets,
+			// Bytes written to the upload rings
+			UploadBytes,
+
+			NumStats
+		};
+
+		const char *ToName(Enum eStat);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Per-frame renderer counters, and their min, average and max over the
+	// last ms_uWindowSize frames. Counts are added through the frame and
+	// moved into the window by EndFrame. Like the RPI it must only be used
+	// from the render thread.
+	class IOERenderStats
+	{
+	public:
+		static const std::uint32_t ms_uWindowSize = 120;
+
+	public:
+		IOERenderStats();
+
+	public:
+		FORCEINLINE void Add(ERenderStat::Enum eStat, std::uint64_t uCount = 1)
+		{
+			m_arrCurrent[eStat] += uCount;
+		}
+
+		// Counts a draw and the triangles it makes with the given topology
+		void AddDraw(EPrimitiveTopology eTopology, std::uint64_t uNumVertices,
+					 std::uint64_t uNumInstances = 1);
+
+		void EndFrame();
+
+		// Clears the window and the frame being counted
+		void Reset();
+
+	public:
+		// Counts of the frame being built
+		FORCEINLINE std::uint64_t GetCurrent(ERenderStat::Enum eStat) const
+		{
+			return m_arrCurrent[eStat];
+		}
+
+		// Counts of the last ended frame
+		FORCEINLINE std::uint64_t GetLast(ERenderStat::Enum eStat) const
+		{
+			return m_uNumFrames > 0 ? m_arrHistory[GetLastFrameIdx()][eStat]
+									: 0;
+		}
+
+		FORCEINLINE std::uint64_t GetMin(ERenderStat::Enum eStat) const
+		{
+			return m_arrMin[eStat];
+		}
+		FORCEINLINE std::uint64_t GetMax(ERenderStat::Enum eStat) const
+		{
+			return m_arrMax[eStat];
+		}
+		FORCEINLINE double GetAverage(ERenderStat::Enum eStat) const
+		{
+			return m_uNumFrames > 0 ? static_cast<double>(m_arrSum[eStat]) /
+										  static_cast<double>(m_uNumFrames)
+									: 0.0;
+		}
+
+		// Frames held in the window, up to ms_uWindowSize
+		FORCEINLINE std::uint32_t GetNumFrames() const
+		{
+			return m_uNumFrames;
+		}
+
+		// "last (min/avg/max)" of one counter, as drawn on the HUD
+		std::string Format(ERenderStat::Enum eStat) const;
+
+		// Every counter of the frame being built on one line, for profiler
+		// markers
+		std::string FormatCurrent() const;
+
+	private:
+		typedef std::array<std::uint64_t, ERenderStat::NumStats> Counters;
+
+		FORCEINLINE std::uint32_t GetLastFrameIdx() const
+		{
+			return (m_uNextFrame + ms_uWindowSize - 1) % ms_uWindowSize;
+		}
+
+	private:
+		Counters m_arrCurrent;
+
+		// Ring of ended frames, with the sum kept as frames come and go. The
+		// extremes are found again from the ring once per frame.
+		std::vector<Counters> m_arrHistory;
+		std::uint32_t m_uNextFrame;
+		std::uint32_t m_uNumFrames;
+
+		Counters m_arrSum;
+		Counters m_arrMin;
+		Counters m_arrMax;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -1,6 +1,7 @@
 #include <IOE/IOEMaths/Vector.h>
 #include <IOE/IOEMaths/Matrix.h>
 
+#include <IOE/IOERenderer/IOERPI.h>
 #include <IOE/IOERenderer/IOEShader.h>
 #include <IOE/IOERenderer/IOEVertexFormat.h>
 
@@ -17,12 +18,25 @@ namespace Renderer
 		: m_tPlatform(*this)
 		, m_eShaderType(IOE::Renderer::EShaderType::Unknown)
 		, m_pVertexFormat(nullptr)
+		, m_uDirtyCBuffers(0)
+		, m_uUploadedCBuffers(0)
 	{
+		m_arrCBufferUploads.fill(CBufferUpload());
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
 	void IOEShader::Compile(const IOEShaderCompilationOptions &rOptions)
+	{
+		Create(rOptions, IOERPI::GetSingletonPtr()->GetShaderCache().Compile(
+							 rOptions, m_tPlatform));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void
+	IOEShader::Create(const IOEShaderCompilationOptions &rOptions,
+					  const std::shared_ptr<const IOEShaderBinary> &pBinary)
 	{
 		if (m_pVertexFormat == nullptr)
 		{
@@ -31,7 +45,8 @@ namespace Renderer
 		}
 		m_eShaderType = rOptions.eShaderType;
 		m_szPath	  = rOptions.szPath;
-		m_tPlatform.Compile(rOptions);
+		m_pBinary	  = pBinary;
+		m_tPlatform.Create(rOptions, *m_pBinary);
 		FindShaderVariables();
 	}
 
@@ -39,8 +54,27 @@ namespace Renderer
 
 	void IOEShader::FindShaderVariables()
 	{
-		m_tPlatform.FindShaderVariables(m_arrConstantBuffers,
-										m_arrGlobalVariables);
+		m_arrConstantBuffers = m_pBinary->arrConstantBuffers;
+		m_arrGlobalVariables = m_pBinary->arrGlobalVariables;
+
+		// Every buffer starts zeroed, and is uploaded before its first use
+		m_uDirtyCBuffers	= 0;
+		m_uUploadedCBuffers = 0;
+		for (std::uint32_t uIdx(0);
+			 uIdx < ShaderConstantBufferDescription::ms_nMaxCBufferSlots;
+			 ++uIdx)
+		{
+			ShaderConstantBufferDescription &rBuffer(
+				m_arrConstantBuffers[uIdx]);
+			rBuffer.arrShadow.assign(rBuffer.nSizeBytes, 0);
+			rBuffer.ClearDirty();
+			m_arrCBufferUploads[uIdx] = CBufferUpload();
+			if (rBuffer.nSizeBytes > 0)
+			{
+				rBuffer.MarkDirty(0, rBuffer.nSizeBytes);
+				m_uDirtyCBuffers |= 1u << uIdx;
+			}
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -169,7 +203,13 @@ namespace Renderer
 	{
 		if (pBuffer != nullptr)
 		{
-			return m_tPlatform.MapConstantBuffers(pRPI, nSlotIdx, pBuffer);
+			void *pData(
+				m_tPlatform.MapConstantBuffers(pRPI, nSlotIdx, pBuffer));
+			if (pData != nullptr)
+			{
+				pRPI->GetRenderStats().Add(ERenderStat::ConstantBufferMaps);
+			}
+			return pData;
 		}
 		return nullptr;
 	}
@@ -201,6 +241,86 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	void IOEShader::CommitCBuffer(IOERPI *pRPI, std::uint32_t uSlotIdx)
+	{
+		ShaderConstantBufferDescription &rBuffer(
+			m_arrConstantBuffers[uSlotIdx]);
+		if (rBuffer.IsDirty())
+		{
+			const bool bWasUploaded((m_uUploadedCBuffers & (1u << uSlotIdx)) !=
+									0);
+			UploadCBuffer(pRPI, uSlotIdx);
+			rBuffer.ClearDirty();
+
+			// The slot of a bound shader is moved to the new upload, or
+			// back to its own buffer, which stays bound as it is renamed
+			const bool bUploaded((m_uUploadedCBuffers & (1u << uSlotIdx)) !=
+								 0);
+			if ((bUploaded || bWasUploaded) &&
+				pRPI->GetShaderIndex(m_eShaderType) == GetResourceIndex())
+			{
+				m_tPlatform.BindConstantBuffer(pRPI, uSlotIdx);
+			}
+		}
+		m_uDirtyCBuffers &= ~(1u << uSlotIdx);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShader::UploadCBuffer(IOERPI *pRPI, std::uint32_t uSlotIdx)
+	{
+		ShaderConstantBufferDescription &rBuffer(
+			m_arrConstantBuffers[uSlotIdx]);
+		CBufferUpload &rUpload(m_arrCBufferUploads[uSlotIdx]);
+
+		const std::uint32_t uAlignment(
+			static_cast<std::uint32_t>(ms_uCBufferUploadAlignment));
+		const std::uint32_t uSizeBytes(
+			(static_cast<std::uint32_t>(rBuffer.nSizeBytes) + uAlignment - 1) &
+			~(uAlignment - 1));
+		void *pData(pRPI->MapUpload(EUploadRing::Constant, uSizeBytes,
+									uAlignment, rUpload.uOffset));
+		if (pData != nullptr)
+		{
+			memcpy(pData, rBuffer.arrShadow.data(), rBuffer.nSizeBytes);
+			pRPI->UnmapUpload(EUploadRing::Constant);
+			pRPI->GetRenderStats().Add(ERenderStat::ConstantBufferMaps);
+
+			rUpload.uSizeBytes = uSizeBytes;
+			rUpload.uFrame	 = pRPI->GetUploadFrame();
+			m_uUploadedCBuffers |= 1u << uSlotIdx;
+			return;
+		}
+
+		// Mapping discards the buffer, so all of it is written again
+		rUpload = CBufferUpload();
+		m_uUploadedCBuffers &= ~(1u << uSlotIdx);
+		pData = MapCBuffer(pRPI, 0, &rBuffer);
+		if (pData != nullptr)
+		{
+			memcpy(pData, rBuffer.arrShadow.data(), rBuffer.nSizeBytes);
+			UnmapCBuffer(pRPI, 0, &rBuffer);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShader::CommitDirtyCBuffers(IOERPI *pRPI)
+	{
+		for (std::uint32_t uIdx(0);
+			 m_uDirtyCBuffers != 0 &&
+			 uIdx < ShaderConstantBufferDescription::ms_nMaxCBufferSlots;
+			 ++uIdx)
+		{
+			if ((m_uDirtyCBuffers & (1u << uIdx)) != 0)
+			{
+				CommitCBuffer(pRPI, uIdx);
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 	void IOEShader::SetShaderVariableValue(void *pAddress, float fU)
 	{
 		(static_cast<float *>(pAddress)[0]) = fU;
@@ -279,9 +399,23 @@ namespace Renderer
 
 	void IOEShader::Set(IOERPI *pRPI)
 	{
-		// if (pRPI->GetShaderIndex(m_eShaderType) != GetResourceIndex())
+		if (pRPI->GetShaderIndex(m_eShaderType) != GetResourceIndex())
 		{
+			// Uploads of earlier frames may have been written over since,
+			// so they are made again. Slots written since are uploaded by
+			// the commit that follows every set.
+			for (std::uint32_t uIdx(0); (m_uUploadedCBuffers >> uIdx) != 0;
+				 ++uIdx)
+			{
+				if ((m_uUploadedCBuffers & (1u << uIdx)) != 0 &&
+					m_arrCBufferUploads[uIdx].uFrame != pRPI->GetUploadFrame() &&
+					!m_arrConstantBuffers[uIdx].IsDirty())
+				{
+					UploadCBuffer(pRPI, uIdx);
+				}
+			}
 			m_tPlatform.Set(pRPI);
+			pRPI->GetRenderStats().Add(ERenderStat::StateChanges);
 
 			pRPI->SetShaderIndex(m_eShaderType, GetResourceIndex());
 		}
@@ -289,6 +423,21 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
+	bool IOEShader::SetTextureVariable(IOERPI *pRPI, const char *szTextureName,
+									   IOETexture *pTexture,
+									   int arrOffset /*=0*/)
+	{
+		const bool bFound(m_tPlatform.SetTextureVariable(pRPI, szTextureName,
+														 pTexture, arrOffset));
+		if (bFound && pTexture != nullptr)
+		{
+			pRPI->GetRenderStats().Add(ERenderStat::TextureBinds);
+		}
+		return bFound;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
 	std::uint32_t IOEShader::GetStructuredBufferSize(const char *szName) const
 	{
 		const ShaderVariableDescription *pDescription(FindGlobalVariable(
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <string>
 #include <memory>
 #include <cstdint>
@@ -30,16 +31,32 @@ namespace Renderer
 
 	class IOEShader : public IOE::Core::IOEResourceCounter<IOEMaterial>
 	{
+	public:
+		// Constant buffers in the upload ring start on, and span, whole
+		// blocks of sixteen registers, as they are bound at offsets
+		static const std::uint32_t ms_uCBufferUploadAlignment = 256;
+
 	public:
 		IOEShader();
 
+		// Takes the binary of rOptions from the RPI's shader cache
 		void Compile(const IOEShaderCompilationOptions &rOptions);
 
+		// Creates the shader from a binary compiled beforehand
+		void Create(const IOEShaderCompilationOptions &rOptions,
+					const std::shared_ptr<const IOEShaderBinary> &pBinary);
+
 		EShaderType::Enum GetShaderType() const
 		{
 			return m_eShaderType;
 		}
 
+		// Unique to this shader, for grouping the pipelines that share it
+		FORCEINLINE std::uint32_t GetShaderID() const
+		{
+			return GetResourceIndex();
+		}
+
 		void Set(IOERPI *pRPI);
 
 	public:
@@ -53,6 +70,7 @@ namespace Renderer
 		}
 
 	public:
+		// Copies the reflection of the compiled binary
 		void FindShaderVariables();
 		void *MapCBuffer(IOERPI *pRPI, const char *szName);
 		void *MapCBuffer(IOERPI *pRPI, std::int32_t nSlotIdx,
@@ -61,6 +79,43 @@ namespace Renderer
 		void UnmapCBuffer(IOERPI *pRPI, std::int32_t nSlotIdx,
 						  ShaderConstantBufferDescription *pBuffer);
 
+		// Address of uSize bytes at uOffset of a constant buffer's CPU
+		// copy, which is marked to be uploaded by the next commit
+		FORCEINLINE void *WriteCBuffer(std::uint32_t uSlotIdx,
+									   std::uint32_t uOffset,
+									   std::uint32_t uSize)
+		{
+			ShaderConstantBufferDescription &rBuffer(
+				m_arrConstantBuffers[uSlotIdx]);
+			IOE_ASSERT(uOffset + uSize <= rBuffer.arrShadow.size(),
+					   "Write is outside of the constant buffer");
+			rBuffer.MarkDirty(uOffset, uSize);
+			m_uDirtyCBuffers |= 1u << uSlotIdx;
+			return rBuffer.arrShadow.data() + uOffset;
+		}
+
+		// Uploads the constant buffers written since their last upload
+		FORCEINLINE void CommitCBuffers(IOERPI *pRPI)
+		{
+			if (m_uDirtyCBuffers != 0)
+			{
+				CommitDirtyCBuffers(pRPI);
+			}
+		}
+		void CommitCBuffer(IOERPI *pRPI, std::uint32_t uSlotIdx);
+
+		// Where a constant buffer was last uploaded in the RPI's constant
+		// ring, false when it is in the slot's own buffer instead
+		FORCEINLINE bool GetCBufferUpload(std::uint32_t uSlotIdx,
+										  std::uint32_t &ruOffset,
+										  std::uint32_t &ruSizeBytes) const
+		{
+			const CBufferUpload &rUpload(m_arrCBufferUploads[uSlotIdx]);
+			ruOffset	= rUpload.uOffset;
+			ruSizeBytes = rUpload.uSizeBytes;
+			return rUpload.uFrame != 0;
+		}
+
 		ShaderConstantBufferDescription *
 		FindConstantBuffer(const char *szName);
 		ShaderVariableDescription *
@@ -113,14 +168,8 @@ namespace Renderer
 		}
 
 	public:
-		FORCEINLINE bool SetTextureVariable(IOERPI *pRPI,
-											const char *szTextureName,
-											IOETexture *pTexture,
-											int arrOffset = 0)
-		{
-			return m_tPlatform.SetTextureVariable(pRPI, szTextureName,
-												  pTexture, arrOffset);
-		}
+		bool SetTextureVariable(IOERPI *pRPI, const char *szTextureName,
+								IOETexture *pTexture, int arrOffset = 0);
 
 		FORCEINLINE bool SetSamplerVariable(IOERPI *pRPI,
 											const char *szSamplerName,
@@ -152,15 +201,42 @@ namespace Renderer
 		void SetShaderVariableValue(void *pAddress,
 									const IOE::Maths::IOEMatrix &rmMatrix);
 
+	private:
+		void CommitDirtyCBuffers(IOERPI *pRPI);
+
+		// Copies the CPU copy of a constant buffer into the constant ring,
+		// or into the slot's own buffer when the ring has no room
+		void UploadCBuffer(IOERPI *pRPI, std::uint32_t uSlotIdx);
+
+	private:
+		struct CBufferUpload
+		{
+			std::uint32_t uOffset;
+			std::uint32_t uSizeBytes;
+			// Upload frame of the RPI it was made in, zero when it went
+			// to the slot's own buffer
+			std::uint64_t uFrame;
+		};
+
 	private:
 		IOEShader_Platform m_tPlatform;
 		shared_ptr<IOEVertexFormat> m_pVertexFormat;
+		// Owned by the shader cache, and shared with every shader compiled
+		// the same way
+		shared_ptr<const IOEShaderBinary> m_pBinary;
 
 		EShaderType::Enum m_eShaderType;
 		std::wstring m_szPath;
 
 		ShaderCategories m_arrGlobalVariables;
 		ShaderConstantBuffers m_arrConstantBuffers;
+		// Bit per slot of m_arrConstantBuffers with a dirty range
+		std::uint32_t m_uDirtyCBuffers;
+		// Bit per slot last uploaded to the constant ring
+		std::uint32_t m_uUploadedCBuffers;
+		std::array<CBufferUpload,
+				   ShaderConstantBufferDescription::ms_nMaxCBufferSlots>
+			m_arrCBufferUploads;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
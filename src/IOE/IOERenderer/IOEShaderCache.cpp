@@ -0,0 +1,535 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "IOEShaderCache.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		const std::uint64_t g_uHashBasis(14695981039346656037ULL);
+
+		// "IOES" at the start of every cache file
+		const std::uint32_t g_uCacheMagic(0x53454F49);
+
+		// Anything larger is a damaged file rather than a shader
+		const std::uint32_t g_uMaxBytecodeSize(64 * 1024 * 1024);
+		const std::uint32_t g_uMaxVariables(4096);
+
+		// FNV-1a
+		void HashBytes(std::uint64_t &ruHash, const void *pData,
+					   std::size_t uSize)
+		{
+			const std::uint8_t *pBytes(
+				static_cast<const std::uint8_t *>(pData));
+			for (std::size_t uIdx(0); uIdx < uSize; ++uIdx)
+			{
+				ruHash = (ruHash ^ pBytes[uIdx]) * 1099511628211ULL;
+			}
+		}
+
+		template <typename T>
+		void HashCombine(std::uint64_t &ruHash, const T &rValue)
+		{
+			HashBytes(ruHash, &rValue, sizeof(T));
+		}
+
+		// Length first, so that "ab" + "c" and "a" + "bc" differ
+		template <typename TStringType>
+		void HashString(std::uint64_t &ruHash, const TStringType &szValue)
+		{
+			HashCombine(ruHash, static_cast<std::uint64_t>(szValue.size()));
+			typedef typename TStringType::value_type Char;
+			HashBytes(ruHash, szValue.data(), szValue.size() * sizeof(Char));
+		}
+
+		// fstream only takes wide paths with MSVC. Elsewhere, where the
+		// cache is tested with a stub compiler, paths are narrowed as
+		// ConvertWideToNarrow does.
+		template <typename TStream>
+		bool OpenStream(TStream &rStream, const std::wstring &szPath,
+						std::ios::openmode eMode)
+		{
+#if defined(_WIN32)
+			rStream.open(szPath, eMode);
+#else
+			rStream.open(std::string(szPath.begin(), szPath.end()), eMode);
+#endif
+			return rStream.is_open();
+		}
+
+		// Forward slashes only, with "dir/../" removed, so one file found
+		// through different relative paths is only read once
+		std::wstring NormalisePath(std::wstring szPath)
+		{
+			std::replace(szPath.begin(), szPath.end(), L'\\', L'/');
+
+			std::size_t uPos(0);
+			while ((uPos = szPath.find(L"/../", uPos)) != std::wstring::npos)
+			{
+				const std::size_t uStart(uPos > 0 ? szPath.rfind(L'/', uPos - 1)
+												  : std::wstring::npos);
+				const std::size_t uBegin(uStart == std::wstring::npos
+											 ? 0
+											 : uStart + 1);
+				if (uPos == uBegin ||
+					szPath.compare(uBegin, uPos - uBegin, L"..") == 0)
+				{
+					// Nothing left to go back through
+					uPos += 3;
+					continue;
+				}
+				szPath.erase(uBegin, uPos + 4 - uBegin);
+				uPos = uBegin;
+			}
+			return szPath;
+		}
+
+		std::wstring GetDirectory(const std::wstring &szPath)
+		{
+			const std::size_t uPos(szPath.rfind(L'/'));
+			return uPos == std::wstring::npos ? std::wstring()
+											  : szPath.substr(0, uPos + 1);
+		}
+
+		// Every #include of the source, whether or not the preprocessor
+		// would reach it. A key may change more often than it has to, but
+		// never misses a change.
+		void FindIncludes(const std::string &szSource,
+						  const std::wstring &szDirectory,
+						  std::vector<std::wstring> &arrIncludes)
+		{
+			std::istringstream tStream(szSource);
+			std::string szLine;
+			while (std::getline(tStream, szLine))
+			{
+				std::size_t uPos(szLine.find_first_not_of(" \t"));
+				if (uPos == std::string::npos || szLine[uPos] != '#')
+				{
+					continue;
+				}
+				uPos = szLine.find_first_not_of(" \t", uPos + 1);
+				if (uPos == std::string::npos ||
+					szLine.compare(uPos, 7, "include") != 0)
+				{
+					continue;
+				}
+				uPos = szLine.find_first_of("\"<", uPos + 7);
+				if (uPos == std::string::npos)
+				{
+					continue;
+				}
+				const std::size_t uEnd(
+					szLine.find(szLine[uPos] == '"' ? '"' : '>', uPos + 1));
+				if (uEnd == std::string::npos)
+				{
+					continue;
+				}
+				const std::string szName(
+					szLine.substr(uPos + 1, uEnd - uPos - 1));
+				arrIncludes.push_back(NormalisePath(
+					szDirectory + std::wstring(szName.begin(), szName.end())));
+			}
+		}
+
+		template <typename T>
+		void WriteValue(std::ostream &rStream, const T &rValue)
+		{
+			rStream.write(reinterpret_cast<const char *>(&rValue), sizeof(T));
+		}
+
+		template <typename T>
+		bool ReadValue(std::istream &rStream, T &rValue)
+		{
+			rStream.read(reinterpret_cast<char *>(&rValue), sizeof(T));
+			return rStream.good();
+		}
+
+		void WriteVariable(std::ostream &rStream,
+						   const ShaderVariableDescription &rVariable)
+		{
+			rStream.write(rVariable.szName, sizeof(rVariable.szName));
+			WriteValue(rStream, static_cast<std::int32_t>(rVariable.eType));
+			WriteValue(rStream, rVariable.nSlot);
+			WriteValue(rStream, rVariable.nSizeOrSamples);
+			WriteValue(rStream,
+					   static_cast<std::uint8_t>(rVariable.bGPUWriteable));
+		}
+
+		bool ReadVariable(std::istream &rStream,
+						  ShaderVariableDescription &rVariable)
+		{
+			std::int32_t nType(0);
+			std::uint8_t uGPUWriteable(0);
+			rStream.read(rVariable.szName, sizeof(rVariable.szName));
+			if (!ReadValue(rStream, nType) ||
+				!ReadValue(rStream, rVariable.nSlot) ||
+				!ReadValue(rStream, rVariable.nSizeOrSamples) ||
+				!ReadValue(rStream, uGPUWriteable))
+			{
+				return false;
+			}
+			rVariable.szName[sizeof(rVariable.szName) - 1] = '\0';
+			rVariable.eType			= static_cast<EShaderVariableType>(nType);
+			rVariable.bGPUWriteable = uGPUWriteable != 0;
+			return true;
+		}
+
+		void WriteVariables(std::ostream &rStream,
+							const ShaderDescription &arrVariables)
+		{
+			WriteValue(rStream,
+					   static_cast<std::uint32_t>(arrVariables.size()));
+			for (const ShaderVariableDescription &rVariable : arrVariables)
+			{
+				WriteVariable(rStream, rVariable);
+			}
+		}
+
+		bool ReadVariables(std::istream &rStream,
+						   ShaderDescription &arrVariables)
+		{
+			std::uint32_t uNumVariables(0);
+			if (!ReadValue(rStream, uNumVariables) ||
+				uNumVariables > g_uMaxVariables)
+			{
+				return false;
+			}
+			arrVariables.resize(uNumVariables);
+			for (ShaderVariableDescription &rVariable : arrVariables)
+			{
+				if (!ReadVariable(rStream, rVariable))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEShaderCache::IOEShaderCache()
+		: m_uNumCompiles(0)
+		, m_uNumHits(0)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShaderCache::Setup(const std::wstring &szSourcePath,
+							   const std::wstring &szCacheFile)
+	{
+		m_szSourcePath = NormalisePath(szSourcePath);
+		if (!m_szSourcePath.empty() && m_szSourcePath.back() != L'/')
+		{
+			m_szSourcePath += L'/';
+		}
+		m_szCacheFile = szCacheFile;
+
+		Clear();
+		Load();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::shared_ptr<const IOEShaderBinary>
+	IOEShaderCache::Compile(const IOEShaderCompilationOptions &rOptions,
+							IOEShaderCompiler &rCompiler)
+	{
+		const std::uint64_t uKey(CalculateKey(rOptions, rCompiler));
+
+		std::shared_ptr<const IOEShaderBinary> pFound(Find(uKey));
+		if (pFound != nullptr)
+		{
+			return pFound;
+		}
+
+		auto pBinary(std::make_shared<IOEShaderBinary>());
+		rCompiler.CompileShader(rOptions, *pBinary);
+		Add(uKey, pBinary);
+		return pBinary;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::shared_ptr<const IOEShaderBinary>
+	IOEShaderCache::Find(std::uint64_t uKey)
+	{
+		auto tFound(m_mapBinaries.find(uKey));
+		if (tFound == m_mapBinaries.end())
+		{
+			return nullptr;
+		}
+		++m_uNumHits;
+		return tFound->second;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void
+	IOEShaderCache::Add(std::uint64_t uKey,
+						const std::shared_ptr<const IOEShaderBinary> &pBinary)
+	{
+		++m_uNumCompiles;
+		if (m_mapBinaries.emplace(uKey, pBinary).second)
+		{
+			Append(uKey, *pBinary);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint64_t
+	IOEShaderCache::CalculateKey(const IOEShaderCompilationOptions &rOptions,
+								 const IOEShaderCompiler &rCompiler)
+	{
+		std::uint64_t uHash(g_uHashBasis);
+		HashString(uHash, rCompiler.GetCompilerSignature());
+		HashCombine(uHash, static_cast<std::int32_t>(rOptions.eShaderType));
+		HashString(uHash, rOptions.szEntryPoint);
+		HashString(uHash, rOptions.szProfile);
+		HashString(uHash, NormalisePath(rOptions.szPath));
+
+		const std::size_t uNumMacros(
+			rOptions.pMacros != nullptr ? rOptions.pMacros->size() : 0);
+		HashCombine(uHash, static_cast<std::uint64_t>(uNumMacros));
+		for (std::size_t uIdx(0); uIdx < uNumMacros; ++uIdx)
+		{
+			const IOEShaderMacroDefinition &rMacro(rOptions.pMacros->at(uIdx));
+			HashString(uHash, rMacro.m_szName);
+			HashString(uHash, rMacro.m_szDefinition);
+		}
+
+		std::vector<std::wstring> arrVisited;
+		HashFile(uHash, NormalisePath(m_szSourcePath + rOptions.szPath),
+				 arrVisited);
+		return uHash;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShaderCache::Clear()
+	{
+		m_mapBinaries.clear();
+		m_mapSources.clear();
+		m_uNumCompiles = 0;
+		m_uNumHits	 = 0;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	const IOEShaderCache::SourceFile &
+	IOEShaderCache::FindSourceFile(const std::wstring &szPath)
+	{
+		auto tFound(m_mapSources.find(szPath));
+		if (tFound != m_mapSources.end())
+		{
+			return tFound->second;
+		}
+
+		SourceFile tFile;
+		tFile.uHash = g_uHashBasis;
+
+		std::ifstream tStream;
+		if (OpenStream(tStream, szPath, std::ios::in | std::ios::binary))
+		{
+			std::ostringstream tContents;
+			tContents << tStream.rdbuf();
+			const std::string szSource(tContents.str());
+
+			HashString(tFile.uHash, szSource);
+			FindIncludes(szSource, GetDirectory(szPath), tFile.arrIncludes);
+		}
+		else
+		{
+			// Left for the compiler to report, the key only has to differ
+			// from any file that was found
+			HashCombine(tFile.uHash, ~0ULL);
+		}
+
+		return m_mapSources.emplace(szPath, std::move(tFile)).first->second;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShaderCache::HashFile(std::uint64_t &ruHash,
+								  const std::wstring &szPath,
+								  std::vector<std::wstring> &arrVisited)
+	{
+		arrVisited.push_back(szPath);
+
+		const SourceFile &rFile(FindSourceFile(szPath));
+		HashCombine(ruHash, rFile.uHash);
+		for (const std::wstring &szInclude : rFile.arrIncludes)
+		{
+			// Each file counts once, however often it is included
+			if (std::find(arrVisited.begin(), arrVisited.end(), szInclude) ==
+				arrVisited.end())
+			{
+				HashFile(ruHash, szInclude, arrVisited);
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShaderCache::Load()
+	{
+		if (m_szCacheFile.empty())
+		{
+			return;
+		}
+
+		std::ifstream tStream;
+		std::uint32_t uMagic(0);
+		std::uint32_t uVersion(0);
+		if (!OpenStream(tStream, m_szCacheFile,
+						std::ios::in | std::ios::binary) ||
+			!ReadValue(tStream, uMagic) || !ReadValue(tStream, uVersion) ||
+			uMagic != g_uCacheMagic || uVersion != ms_uVersion)
+		{
+			// Missing, or written by another version, so start again
+			tStream.close();
+			Save();
+			return;
+		}
+
+		bool bDamaged(false);
+		while (tStream.peek() != std::char_traits<char>::eof())
+		{
+			std::uint64_t uKey(0);
+			auto pBinary(std::make_shared<IOEShaderBinary>());
+			if (!Read(tStream, uKey, *pBinary))
+			{
+				bDamaged = true;
+				break;
+			}
+			m_mapBinaries[uKey] = pBinary;
+		}
+
+		if (bDamaged)
+		{
+			// Keep everything read before the damage
+			tStream.close();
+			Save();
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShaderCache::Save() const
+	{
+		std::ofstream tStream;
+		if (m_szCacheFile.empty() ||
+			!OpenStream(tStream, m_szCacheFile,
+						std::ios::out | std::ios::binary | std::ios::trunc))
+		{
+			return;
+		}
+
+		WriteValue(tStream, g_uCacheMagic);
+		WriteValue(tStream, static_cast<std::uint32_t>(ms_uVersion));
+		for (const auto &rPair : m_mapBinaries)
+		{
+			Write(tStream, rPair.first, *rPair.second);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShaderCache::Append(std::uint64_t uKey,
+								const IOEShaderBinary &rBinary) const
+	{
+		std::ofstream tStream;
+		if (!m_szCacheFile.empty() &&
+			OpenStream(tStream, m_szCacheFile,
+					   std::ios::out | std::ios::binary | std::ios::app))
+		{
+			Write(tStream, uKey, rBinary);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShaderCache::Write(std::ostream &rStream, std::uint64_t uKey,
+							   const IOEShaderBinary &rBinary)
+	{
+		WriteValue(rStream, uKey);
+
+		WriteValue(rStream,
+				   static_cast<std::uint32_t>(rBinary.arrBytecode.size()));
+		rStream.write(
+			reinterpret_cast<const char *>(rBinary.arrBytecode.data()),
+			rBinary.arrBytecode.size());
+
+		for (const ShaderConstantBufferDescription &rBuffer :
+			 rBinary.arrConstantBuffers)
+		{
+			rStream.write(rBuffer.szName, sizeof(rBuffer.szName));
+			WriteValue(rStream, static_cast<std::uint32_t>(rBuffer.nSizeBytes));
+			WriteValue(rStream, static_cast<std::uint32_t>(rBuffer.nSlotIdx));
+			WriteVariables(rStream, rBuffer.arrVariables);
+		}
+
+		for (const ShaderDescription &arrVariables : rBinary.arrGlobalVariables)
+		{
+			WriteVariables(rStream, arrVariables);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEShaderCache::Read(std::istream &rStream, std::uint64_t &ruKey,
+							  IOEShaderBinary &rBinary)
+	{
+		std::uint32_t uBytecodeSize(0);
+		if (!ReadValue(rStream, ruKey) || !ReadValue(rStream, uBytecodeSize) ||
+			uBytecodeSize > g_uMaxBytecodeSize)
+		{
+			return false;
+		}
+		rBinary.arrBytecode.resize(uBytecodeSize);
+		rStream.read(reinterpret_cast<char *>(rBinary.arrBytecode.data()),
+					 uBytecodeSize);
+
+		for (ShaderConstantBufferDescription &rBuffer :
+			 rBinary.arrConstantBuffers)
+		{
+			std::uint32_t uSizeBytes(0);
+			std::uint32_t uSlotIdx(0);
+			rStream.read(rBuffer.szName, sizeof(rBuffer.szName));
+			if (!ReadValue(rStream, uSizeBytes) ||
+				!ReadValue(rStream, uSlotIdx) ||
+				!ReadVariables(rStream, rBuffer.arrVariables))
+			{
+				return false;
+			}
+			rBuffer.szName[sizeof(rBuffer.szName) - 1] = '\0';
+			rBuffer.nSizeBytes = uSizeBytes;
+			rBuffer.nSlotIdx   = uSlotIdx;
+		}
+
+		for (ShaderDescription &arrVariables : rBinary.arrGlobalVariables)
+		{
+			if (!ReadVariables(rStream, arrVariables))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,120 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <IOE/IOECore/IOEPortable.h>
+
+#include "IOEShader_PlatformBase.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Compiled shaders keyed by a hash of everything that decides their
+	// bytecode: the source and every file it includes, the entry point,
+	// the profile, the definitions and the compiler signature. Shaders
+	// compiled again with the same key share one binary, and binaries are
+	// kept in a file so that later runs skip the compiler altogether.
+	class IOEShaderCache
+	{
+	public:
+		// Changed whenever the layout of the cache file changes
+		static const std::uint32_t ms_uVersion = 1;
+
+	public:
+		IOEShaderCache();
+
+		// Shader paths are found under szSourcePath. Binaries already in
+		// szCacheFile are loaded, and each new one is added to it. Without
+		// a cache file binaries are only shared for this run.
+		void Setup(const std::wstring &szSourcePath,
+				   const std::wstring &szCacheFile);
+
+		// The binary of rOptions, only compiled by rCompiler when no
+		// binary with the same key was compiled before
+		std::shared_ptr<const IOEShaderBinary>
+		Compile(const IOEShaderCompilationOptions &rOptions,
+				IOEShaderCompiler &rCompiler);
+
+		std::uint64_t
+		CalculateKey(const IOEShaderCompilationOptions &rOptions,
+					 const IOEShaderCompiler &rCompiler);
+
+		// The binary kept under uKey, or null when it has not been compiled
+		std::shared_ptr<const IOEShaderBinary> Find(std::uint64_t uKey);
+
+		// Keeps a binary compiled outside of the cache, such as on a worker
+		// thread, under the key CalculateKey gave for it
+		void Add(std::uint64_t uKey,
+				 const std::shared_ptr<const IOEShaderBinary> &pBinary);
+
+		// Forgets the binaries and sources of this run, the cache file is
+		// untouched
+		void Clear();
+
+	public:
+		FORCEINLINE std::size_t GetNumBinaries() const
+		{
+			return m_mapBinaries.size();
+		}
+		FORCEINLINE std::uint32_t GetNumCompiles() const
+		{
+			return m_uNumCompiles;
+		}
+		FORCEINLINE std::uint32_t GetNumHits() const
+		{
+			return m_uNumHits;
+		}
+
+	private:
+		struct SourceFile
+		{
+			std::uint64_t uHash;
+			// Full paths of the files it includes
+			std::vector<std::wstring> arrIncludes;
+		};
+
+		const SourceFile &FindSourceFile(const std::wstring &szPath);
+		void HashFile(std::uint64_t &ruHash, const std::wstring &szPath,
+					  std::vector<std::wstring> &arrVisited);
+
+		void Load();
+		void Save() const;
+		void Append(std::uint64_t uKey, const IOEShaderBinary &rBinary) const;
+
+		static void Write(std::ostream &rStream, std::uint64_t uKey,
+						  const IOEShaderBinary &rBinary);
+		static bool Read(std::istream &rStream, std::uint64_t &ruKey,
+						 IOEShaderBinary &rBinary);
+
+	private:
+		std::unordered_map<std::uint64_t,
+						   std::shared_ptr<const IOEShaderBinary> >
+			m_mapBinaries;
+
+		// Each file already read this run, by path
+		std::unordered_map<std::wstring, SourceFile> m_mapSources;
+
+		std::wstring m_szSourcePath;
+		std::wstring m_szCacheFile;
+
+		std::uint32_t m_uNumCompiles;
+		std::uint32_t m_uNumHits;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <utility>
 #include <vector>
@@ -7,7 +9,7 @@
 #include <memory>
 #include <map>
 
-#include <IOE/IOECore/IOEDefines.h>
+#include <IOE/IOECore/IOEPortable.h>
 
 using std::shared_ptr;
 using std::vector;
@@ -116,6 +118,7 @@ namespace Renderer
 		{
 			m_szName	   = std::move(rhs.m_szName);
 			m_szDefinition = std::move(rhs.m_szDefinition);
+			return *this;
 		}
 
 	public:
@@ -315,7 +318,8 @@ namespace Renderer
 		ShaderConstantBufferDescription()
 			: nSizeBytes(0)
 			, nSlotIdx(0)
-			, pMappedAddress(nullptr)
+			, uDirtyBegin(0)
+			, uDirtyEnd(0)
 		{
 			szName[0] = '\0';
 		}
@@ -329,11 +333,41 @@ namespace Renderer
 		ShaderConstantBufferDescription &
 		operator=(ShaderConstantBufferDescription &&rhs) = default;
 
-		void *pMappedAddress;
+		FORCEINLINE void MarkDirty(std::size_t uOffset, std::size_t uSize)
+		{
+			if (uDirtyEnd <= uDirtyBegin)
+			{
+				uDirtyBegin = uOffset;
+				uDirtyEnd   = uOffset + uSize;
+			}
+			else
+			{
+				uDirtyBegin = uOffset < uDirtyBegin ? uOffset : uDirtyBegin;
+				uDirtyEnd   = uOffset + uSize > uDirtyEnd ? uOffset + uSize
+														  : uDirtyEnd;
+			}
+		}
+		FORCEINLINE bool IsDirty() const
+		{
+			return uDirtyEnd > uDirtyBegin;
+		}
+		FORCEINLINE void ClearDirty()
+		{
+			uDirtyBegin = 0;
+			uDirtyEnd   = 0;
+		}
+
 		char szName[64];
 		std::size_t nSizeBytes;
 		std::size_t nSlotIdx;
 		ShaderDescription arrVariables;
+
+		// CPU copy of the buffer, written by the material and uploaded
+		// whole when any byte of it has changed. The dirty range spans
+		// every write since the last upload.
+		std::vector<std::uint8_t> arrShadow;
+		std::size_t uDirtyBegin;
+		std::size_t uDirtyEnd;
 	};
 
 	typedef std::array<ShaderConstantBufferDescription,
@@ -354,7 +388,39 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
-	interface_class IOEShader_PlatformBase
+	// What a compile leaves behind: the bytecode the device creates the
+	// shader from, and what reflection found in it
+	struct IOEShaderBinary
+	{
+		std::vector<std::uint8_t> arrBytecode;
+		ShaderConstantBuffers arrConstantBuffers;
+		ShaderCategories arrGlobalVariables;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	interface_class IOEShaderCompiler
+	{
+	public:
+		virtual ~IOEShaderCompiler()
+		{
+		}
+
+		// Names the compiler and the flags it compiles with, anything
+		// compiled by another signature is compiled again
+		virtual std::string GetCompilerSignature() const = 0;
+
+		// Compiles and reflects rOptions into rBinary, throwing when the
+		// source does not compile
+		virtual void CompileShader(const IOEShaderCompilationOptions &rOptions,
+								   IOEShaderBinary &rBinary) = 0;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Compiles through IOEShaderCache, and creates the device objects from
+	// whichever binary the cache hands back
+	interface_class IOEShader_PlatformBase : public IOEShaderCompiler
 	{
 	public:
 		IOEShader_PlatformBase(IOEShader & rShader)
@@ -362,7 +428,8 @@ namespace Renderer
 		{
 		}
 
-		virtual void Compile(const IOEShaderCompilationOptions &rOptions) = 0;
+		virtual void Create(const IOEShaderCompilationOptions &rOptions,
+							const IOEShaderBinary &rBinary) = 0;
 		virtual void Cleanup()
 		{
 		}
@@ -376,9 +443,6 @@ namespace Renderer
 			m_arrMacros.emplace_back(szName, szDefinition);
 		}
 
-		virtual void FindShaderVariables(
-			ShaderConstantBuffers & arrConstantBuffers,
-			ShaderCategories & arrDescriptions) = 0;
 		virtual void *MapConstantBuffers(
 			IOERPI *pRPI, std::int32_t nSlotIdx,
 			ShaderConstantBufferDescription * pBuffer) = 0;
@@ -386,6 +450,10 @@ namespace Renderer
 			IOERPI *pRPI, std::int32_t nSlotIdx,
 			ShaderConstantBufferDescription * pBuffer) = 0;
 
+		// Binds a slot to wherever the shader last uploaded its buffer
+		virtual void BindConstantBuffer(IOERPI *pRPI,
+										std::uint32_t uSlotIdx) = 0;
+
 		virtual bool SetTextureVariable(
 			IOERPI *pRPI, const char *szTextureName,
 			class IOETexture *pTexture, int arrOffset = 0) = 0;
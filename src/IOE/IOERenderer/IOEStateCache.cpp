@@ -0,0 +1,201 @@
+#include <IOE/IOEExceptions/IOEException_Renderer.h>
+#include <IOE/IOEExceptions/IOEException_Enum.h>
+
+#include "IOEStateCache.h"
+#include "IOEMaterial.h"
+#include "IOERPI.h"
+#include "IOEShader.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		const std::uint64_t g_uHashBasis(14695981039346656037ULL);
+
+		template <typename T>
+		void HashCombine(std::uint64_t &ruHash, const T &rValue)
+		{
+			const std::uint8_t *pBytes(
+				reinterpret_cast<const std::uint8_t *>(&rValue));
+			for (std::size_t uIdx(0); uIdx < sizeof(T); ++uIdx)
+			{
+				ruHash = (ruHash ^ pBytes[uIdx]) * 1099511628211ULL;
+			}
+		}
+
+		std::uint64_t CalculatePipelineHash(const IOEPipelineDescription &rDesc)
+		{
+			std::uint64_t uHash(g_uHashBasis);
+			for (std::uint32_t uShaderID : rDesc.arrShaderIDs)
+			{
+				HashCombine(uHash, uShaderID);
+			}
+			HashCombine(uHash, rDesc.pVertexFormat);
+			HashCombine(uHash, rDesc.uRasterizerStateID);
+			HashCombine(uHash, rDesc.uBlendStateID);
+			HashCombine(uHash, rDesc.uDepthStateID);
+			return uHash;
+		}
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEPipelineDescription::IOEPipelineDescription()
+		: pVertexFormat(nullptr)
+		, uRasterizerStateID(0)
+		, uBlendStateID(0)
+		, uDepthStateID(0)
+	{
+		arrShaderIDs.fill(0);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEPipelineDescription::SetMaterial(const IOEMaterial &rMaterial)
+	{
+		arrShaderIDs.fill(0);
+		pVertexFormat = nullptr;
+		for (const std::shared_ptr<IOEShader> &pShader : rMaterial.GetShaders())
+		{
+			arrShaderIDs[pShader->GetShaderType()] = pShader->GetShaderID();
+			if (pShader->GetShaderType() == EShaderType::Vertex)
+			{
+				pVertexFormat = pShader->GetVertexFormat();
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEPipelineDescription::
+	operator==(const IOEPipelineDescription &rhs) const
+	{
+		return arrShaderIDs == rhs.arrShaderIDs &&
+			pVertexFormat == rhs.pVertexFormat &&
+			uRasterizerStateID == rhs.uRasterizerStateID &&
+			uBlendStateID == rhs.uBlendStateID &&
+			uDepthStateID == rhs.uDepthStateID;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEStateCache::IOEStateCache()
+		: m_pRPI(nullptr)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEStateCache::~IOEStateCache()
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEStateCache::Setup(IOERPI *pRPI)
+	{
+		m_pRPI = pRPI;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	template <typename TState>
+	TState &IOEStateCache::Intern(StatePool<TState> &rPool,
+								  const TState &rDesc)
+	{
+		IOE_ASSERT(rDesc.m_uHash != 0, "State must be hashed to be interned");
+
+		auto tRange(rPool.mapStates.equal_range(rDesc.m_uHash));
+		for (auto pIter(tRange.first); pIter != tRange.second; ++pIter)
+		{
+			if (pIter->second->HasSameDescription(rDesc))
+			{
+				return *pIter->second;
+			}
+		}
+
+		// The copy is the only state of its description to own a backend
+		// object, every other one borrows it
+		std::unique_ptr<TState> pState(new TState(rDesc));
+		pState->m_uID = static_cast<std::uint32_t>(rPool.arrStates.size() + 1);
+		pState->m_pInterned = pState.get();
+		pState->m_tPlatform.Setup(m_pRPI);
+
+		TState &rState(*pState);
+		rPool.mapStates.emplace(rDesc.m_uHash, pState.get());
+		rPool.arrStates.push_back(std::move(pState));
+		return rState;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOERasterizerState &IOEStateCache::Intern(const IOERasterizerState &rDesc)
+	{
+		return Intern(m_tRasterizerStates, rDesc);
+	}
+
+	IOEBlendState &IOEStateCache::Intern(const IOEBlendState &rDesc)
+	{
+		return Intern(m_tBlendStates, rDesc);
+	}
+
+	IOESamplerState &IOEStateCache::Intern(const IOESamplerState &rDesc)
+	{
+		return Intern(m_tSamplerStates, rDesc);
+	}
+
+	IOEDepthState &IOEStateCache::Intern(const IOEDepthState &rDesc)
+	{
+		return Intern(m_tDepthStates, rDesc);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t
+	IOEStateCache::GetPipelineID(const IOEPipelineDescription &rDesc)
+	{
+		const std::uint64_t uHash(CalculatePipelineHash(rDesc));
+		auto tRange(m_mapPipelines.equal_range(uHash));
+		for (auto pIter(tRange.first); pIter != tRange.second; ++pIter)
+		{
+			if (m_arrPipelines[pIter->second - 1] == rDesc)
+			{
+				return pIter->second;
+			}
+		}
+
+		if (m_arrPipelines.size() >= ms_uMaxPipelineID)
+		{
+			THROW_IOE_RENDERER_EXCEPTION("Out of pipeline IDs",
+										 E_ERROR_RENDERER_UNKNOWN);
+		}
+
+		m_arrPipelines.push_back(rDesc);
+		const std::uint32_t uID(
+			static_cast<std::uint32_t>(m_arrPipelines.size()));
+		m_mapPipelines.emplace(uHash, uID);
+		return uID;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t IOEStateCache::GetNumStates() const
+	{
+		return static_cast<std::uint32_t>(
+			m_tRasterizerStates.arrStates.size() +
+			m_tBlendStates.arrStates.size() +
+			m_tSamplerStates.arrStates.size() +
+			m_tDepthStates.arrStates.size());
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
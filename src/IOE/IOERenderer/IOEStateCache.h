@@ -0,0 +1,123 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <IOE/IOECore/IOEDefines.h>
+
+#include "IOEShader_PlatformBase.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class IOERPI;
+	class IOEMaterial;
+	class IOEVertexFormat;
+
+	struct IOERasterizerState;
+	struct IOEBlendState;
+	struct IOESamplerState;
+	struct IOEDepthState;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Everything a draw binds that is expensive to change. The states are
+	// given by the IDs they were interned under, zero leaving one unset.
+	struct IOEPipelineDescription
+	{
+		IOEPipelineDescription();
+
+		// Takes the IDs of the shaders of rMaterial, and the vertex format
+		// of its vertex shader
+		void SetMaterial(const IOEMaterial &rMaterial);
+
+		bool operator==(const IOEPipelineDescription &rhs) const;
+
+		std::array<std::uint32_t, EShaderType::NumShaders> arrShaderIDs;
+		const IOEVertexFormat *pVertexFormat;
+
+		std::uint32_t uRasterizerStateID;
+		std::uint32_t uBlendStateID;
+		std::uint32_t uDepthStateID;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Interns state descriptions, so that each unique description has one
+	// immutable copy with one backend object for the life of the RPI. A
+	// description is hashed once when it is interned, and the copy kept
+	// for it has an ID unique among states of its kind, so comparing two
+	// set up states is comparing their IDs. Pipelines are interned the
+	// same way into IDs small enough to be a render queue sort key.
+	//
+	// Only the render thread may intern, as states are set up on it.
+	class IOEStateCache
+	{
+	public:
+		// Pipeline IDs fit in the material bits of a render queue item
+		static const std::uint32_t ms_uMaxPipelineID = (1U << 30) - 1;
+
+	public:
+		IOEStateCache();
+		~IOEStateCache();
+
+		// Backend objects are created on pRPI's device
+		void Setup(IOERPI *pRPI);
+
+		// The interned copy of rDesc, created the first time its
+		// description is seen. rDesc must have been hashed.
+		IOERasterizerState &Intern(const IOERasterizerState &rDesc);
+		IOEBlendState &Intern(const IOEBlendState &rDesc);
+		IOESamplerState &Intern(const IOESamplerState &rDesc);
+		IOEDepthState &Intern(const IOEDepthState &rDesc);
+
+		// The same ID for every equal description, starting from one
+		std::uint32_t GetPipelineID(const IOEPipelineDescription &rDesc);
+
+	public:
+		// Unique descriptions, each with its own backend object
+		std::uint32_t GetNumStates() const;
+		FORCEINLINE std::uint32_t GetNumPipelines() const
+		{
+			return static_cast<std::uint32_t>(m_arrPipelines.size());
+		}
+
+	private:
+		template <typename TState>
+		struct StatePool
+		{
+			std::unordered_multimap<std::uint64_t, TState *> mapStates;
+			std::vector<std::unique_ptr<TState> > arrStates;
+		};
+
+		template <typename TState>
+		TState &Intern(StatePool<TState> &rPool, const TState &rDesc);
+
+	private:
+		IOERPI *m_pRPI;
+
+		StatePool<IOERasterizerState> m_tRasterizerStates;
+		StatePool<IOEBlendState> m_tBlendStates;
+		StatePool<IOESamplerState> m_tSamplerStates;
+		StatePool<IOEDepthState> m_tDepthStates;
+
+		// Index of each pipeline's description is its ID less one
+		std::unordered_multimap<std::uint64_t, std::uint32_t> m_mapPipelines;
+		std::vector<IOEPipelineDescription> m_arrPipelines;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -50,6 +50,7 @@ namespace Renderer
 		, m_nArrayToMapCount(1)
 		, m_bImplicitCounter(false)
 		, m_bAllowRawValues(false)
+		, m_uGeneration(0)
 	{
 	}
 
@@ -126,6 +127,7 @@ namespace Renderer
 					   m_eTextureType == ETextureType::Texture1DArray,
 				   "Must set all dimension!");
 		m_fWidth = fWidth;
+		++m_uGeneration;
 		m_tPlatform.OnResize();
 	}
 
@@ -138,6 +140,7 @@ namespace Renderer
 				   "Must set all dimension!");
 		m_fWidth  = fWidth;
 		m_fHeight = fHeight;
+		++m_uGeneration;
 		m_tPlatform.OnResize();
 	}
 
@@ -150,6 +153,7 @@ namespace Renderer
 		m_fWidth  = fWidth;
 		m_fHeight = fHeight;
 		m_fDepth  = fDepth;
+		++m_uGeneration;
 		m_tPlatform.OnResize();
 	}
 
@@ -181,13 +181,22 @@ namespace Renderer
 		}
 		FORCEINLINE bool Setup(IOETextureSource *pTextureSource = nullptr)
 		{
+			++m_uGeneration;
 			return m_tPlatform.Setup(pTextureSource);
 		}
 		FORCEINLINE void Cleanup()
 		{
+			++m_uGeneration;
 			m_tPlatform.Cleanup();
 		}
 
+		// Changes whenever the platform resource is recreated, so a binding
+		// made before can be told apart from one made after
+		FORCEINLINE std::uint32_t GetGeneration() const
+		{
+			return m_uGeneration;
+		}
+
 	public:
 		void Resize(float fWidth);
 		void Resize(float fWidth, float fHeight);
@@ -383,6 +392,8 @@ namespace Renderer
 
 		// Allow raw values for UAVs.
 		bool m_bAllowRawValues;
+
+		std::uint32_t m_uGeneration;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
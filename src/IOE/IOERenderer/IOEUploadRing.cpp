@@ -0,0 +1,121 @@
+#include "IOEUploadRing.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEUploadRing::IOEUploadRing()
+		: m_pFence(nullptr)
+		, m_uCapacity(0)
+		, m_uHead(0)
+		, m_uTail(0)
+		, m_uFrameStart(0)
+		, m_uNumWaits(0)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEUploadRing::Setup(std::uint32_t uCapacity, IOEGPUFence *pFence)
+	{
+		m_pFence	  = pFence;
+		m_uCapacity   = uCapacity;
+		m_uHead		  = 0;
+		m_uTail		  = 0;
+		m_uFrameStart = 0;
+		m_uNumWaits   = 0;
+		m_arrFrames.clear();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEUploadRing::Allocate(std::uint32_t uSize, std::uint32_t uAlignment,
+								 std::uint32_t &ruOffset)
+	{
+		IOE_ASSERT(uAlignment != 0 && (uAlignment & (uAlignment - 1)) == 0,
+				   "Upload alignment must be a power of two");
+		IOE_ASSERT(m_uCapacity % uAlignment == 0,
+				   "Upload ring capacity must be a multiple of the alignment");
+		if (m_uCapacity == 0)
+		{
+			return false;
+		}
+
+		std::uint64_t uStart((m_uHead + uAlignment - 1) &
+							 ~static_cast<std::uint64_t>(uAlignment - 1));
+		// An allocation never straddles the end, so it starts again from
+		// the beginning instead
+		if (uStart % m_uCapacity + uSize > m_uCapacity)
+		{
+			uStart = (uStart / m_uCapacity + 1) * m_uCapacity;
+		}
+		const std::uint64_t uEnd(uStart + uSize);
+		if (uEnd - m_uFrameStart > m_uCapacity)
+		{
+			return false;
+		}
+
+		while (uEnd - m_uTail > m_uCapacity)
+		{
+			RetireFrame(true);
+		}
+
+		m_uHead  = uEnd;
+		ruOffset = static_cast<std::uint32_t>(uStart % m_uCapacity);
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEUploadRing::EndFrame(std::uint64_t uFenceValue)
+	{
+		if (m_uHead != m_uFrameStart)
+		{
+			FencedFrame tFrame;
+			tFrame.uFenceValue = uFenceValue;
+			tFrame.uEnd		   = m_uHead;
+			m_arrFrames.push_back(tFrame);
+			m_uFrameStart = m_uHead;
+		}
+
+		// Frames already finished with are dropped without waiting, so
+		// the queue stays as short as the frames in flight
+		while (RetireFrame(false))
+		{
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEUploadRing::RetireFrame(bool bWait)
+	{
+		if (m_arrFrames.empty())
+		{
+			return false;
+		}
+
+		const FencedFrame &rFrame(m_arrFrames.front());
+		if (m_pFence->GetCompletedValue() < rFrame.uFenceValue)
+		{
+			if (!bWait)
+			{
+				return false;
+			}
+			m_pFence->Wait(rFrame.uFenceValue);
+			++m_uNumWaits;
+		}
+
+		m_uTail = rFrame.uEnd;
+		m_arrFrames.pop_front();
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,130 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <deque>
+
+#include <IOE/IOECore/IOEPortable.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace EUploadRing
+	{
+		// Constants have a ring of their own, as a device may not allow a
+		// constant buffer to be bound as anything else
+		enum Enum
+		{
+			Vertex,
+			Constant,
+
+			NumRings
+		};
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Monotonic marker the GPU passes once it has finished everything that
+	// was submitted before the marker was signalled
+	interface_class IOEGPUFence
+	{
+	public:
+		virtual ~IOEGPUFence()
+		{
+		}
+
+		virtual void Signal(std::uint64_t uValue) = 0;
+		virtual std::uint64_t GetCompletedValue() = 0;
+
+		// Blocks until the GPU has passed uValue
+		virtual void Wait(std::uint64_t uValue) = 0;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Linear allocator over one buffer the CPU writes and the GPU reads,
+	// handing out aligned offsets for data that only lives for a frame.
+	// Each frame's allocations are fenced as the frame ends, and the space
+	// they used is only handed out again once the GPU has passed the fence,
+	// waiting on it when the ring has caught up with the GPU.
+	//
+	// Only the offsets are managed here, the buffer itself belongs to the
+	// platform. Like the RPI it must only be used from the render thread.
+	class IOEUploadRing
+	{
+	public:
+		IOEUploadRing();
+
+		// uCapacity must be a multiple of every alignment asked for
+		void Setup(std::uint32_t uCapacity, IOEGPUFence *pFence);
+
+		// Offset of uSize free bytes, aligned to the power of two
+		// uAlignment. Fails when the frame being built would need more
+		// than the whole ring.
+		bool Allocate(std::uint32_t uSize, std::uint32_t uAlignment,
+					  std::uint32_t &ruOffset);
+
+		// Everything allocated since the last EndFrame is released once
+		// the fence passes uFenceValue
+		void EndFrame(std::uint64_t uFenceValue);
+
+	public:
+		FORCEINLINE std::uint32_t GetCapacity() const
+		{
+			return m_uCapacity;
+		}
+
+		// Bytes taken by the frame being built, padding included
+		FORCEINLINE std::uint32_t GetFrameBytes() const
+		{
+			return static_cast<std::uint32_t>(m_uHead - m_uFrameStart);
+		}
+
+		// Bytes the GPU may still be reading, as of the last retire
+		FORCEINLINE std::uint32_t GetBytesInFlight() const
+		{
+			return static_cast<std::uint32_t>(m_uFrameStart - m_uTail);
+		}
+
+		// Times an allocation had to wait on the GPU
+		FORCEINLINE std::uint32_t GetNumWaits() const
+		{
+			return m_uNumWaits;
+		}
+
+	private:
+		// Releases the oldest fenced frame, waiting for it if bWait is set
+		bool RetireFrame(bool bWait);
+
+	private:
+		struct FencedFrame
+		{
+			std::uint64_t uFenceValue;
+			std::uint64_t uEnd;
+		};
+
+		IOEGPUFence *m_pFence;
+		std::uint32_t m_uCapacity;
+
+		// Positions only ever grow, the offset of one being its remainder
+		// by the capacity. Everything from the tail to the head may still
+		// be read, and the frame being built starts at m_uFrameStart.
+		std::uint64_t m_uHead;
+		std::uint64_t m_uTail;
+		std::uint64_t m_uFrameStart;
+		std::deque<FencedFrame> m_arrFrames;
+
+		std::uint32_t m_uNumWaits;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -1,12 +1,17 @@
+#include <algorithm>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <tbb/task_scheduler_init.h>
+
 #include <IOE/IOEMaths/AABB.h>
 #include <IOE/IOEMaths/Vector.h>
 
 #include <IOE/IOERenderer/IOEModelManager.h>
+#include <IOE/IOERenderer/IOEMultiViewVisibility.h>
 
 #include "IOEVisibilityBounds.h"
 
-#include "DirectXCollision.h"
-
 //////////////////////////////////////////////////////////////////////////
 
 using std::uint32_t;
@@ -21,212 +26,349 @@ namespace Renderer
 
 	//////////////////////////////////////////////////////////////////////////
 
-	static DirectX::BoundingBox GetBoxFromAABB(const Maths::IOEAABB &rAABB)
+	IOEVisibilityBounds::IOEVisibilityBounds()
+		: m_uNumOccluded(0)
+		, m_bCacheValid(false)
+		, m_uCachedPlaneMask(0)
+		, m_pCachedViews(nullptr)
+		, m_uCachedView(0)
+		, m_uCachedResultEpoch(0)
+		, m_uCachedHierarchyEpoch(0)
+		, m_uCachedBoundsEpoch(0)
 	{
-		const Maths::IOEVector &rvMinBounds(rAABB.m_vBounds[0]);
-		const Maths::IOEVector &rvMaxBounds(rAABB.m_vBounds[1]);
-		Maths::IOEVector vHalfExtents((rvMaxBounds - rvMinBounds) * 0.5f);
-		Maths::IOEVector vCentre(rvMinBounds + vHalfExtents);
-
-		XMFLOAT3 arrHalfExtents;
-		vHalfExtents.Get(arrHalfExtents.x, arrHalfExtents.y, arrHalfExtents.z);
-
-		XMFLOAT3 arrCentre;
-		vCentre.Get(arrCentre.x, arrCentre.y, arrCentre.z);
+	}
 
-		DirectX::BoundingBox tBox(arrCentre, arrHalfExtents);
+	//////////////////////////////////////////////////////////////////////////
 
-		return tBox;
+	void IOEVisibilityBounds::UpdateVisibility(const IOECamera &rCamera)
+	{
+		// The hierarchy is placed relative to the frame's origin, which the
+		// camera may have moved away from since the last rebase
+		float fX, fY, fZ;
+		IOEModelManager::GetSingletonPtr()->GetViewOffset(rCamera, fX, fY,
+														   fZ);
+		Maths::IOEFrustumPlanes tPlanes(rCamera.GetFrustumPlanes());
+		tPlanes.Offset(fX, fY, fZ);
+
+		UpdateCached(tPlanes, Maths::IOEFrustumPlanes::ms_uAllPlanesMask);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	IOEVisibilityBounds::IOEVisibilityBounds()
-		: m_uNumLinks(0)
-		, m_uNumModels(0)
-		, m_bTakeIntoAccountLookAt(false)
+	void IOEVisibilityBounds::UpdateVisibility(const IOEVector &vOrigin,
+											   const IOEVector &vNormal)
 	{
+		// A subset is kept if any corner lies in front of the plane, which
+		// is a single plane frustum test
+		float fNX, fNY, fNZ;
+		vNormal.Get(fNX, fNY, fNZ);
+
+		Maths::IOEFrustumPlanes tPlanes;
+		tPlanes.SetPlane(Maths::EFrustumPlane::Near, fNX, fNY, fNZ,
+						 -vOrigin.Dot(vNormal));
+
+		UpdateCached(tPlanes, 1u << Maths::EFrustumPlane::Near);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOEVisibilityBounds::UpdateVisibility(IOECamera &rCamera)
+	void IOEVisibilityBounds::UpdateVisibility(
+		const IOEMultiViewVisibility &rViews, std::uint32_t uView)
 	{
-		m_uNumLinks  = 0;
-		m_uNumModels = 0;
-
-		DirectX::BoundingFrustum tFrustum;
-		DirectX::BoundingFrustum::CreateFromMatrix(
-			tFrustum, rCamera.GetProjectionMatrix().GetRaw());
-		// tFrustum.Transform(tFrustum,
-		// rCamera.GetTransform().ToMatrix().GetRaw());
-		if (m_bTakeIntoAccountLookAt)
+		IOE_ASSERT(uView < rViews.GetNumViews(), "View out of range");
+
+		++m_tCacheStats.uUpdates;
+		if (m_bCacheValid && m_pCachedViews == &rViews &&
+			m_uCachedView == uView &&
+			m_uCachedResultEpoch == rViews.GetResultEpoch())
 		{
-			IOEVector vLookAt(rCamera.GetLookAt() -
-							  rCamera.GetTransform().GetTranslation());
-			IOEVector vUp(rCamera.GetUpVector());
-			vLookAt.NormaliseSet();
-			IOEVector vSide(vUp.Cross(vLookAt));
-			IOEMatrix mRot(vSide, vUp, vLookAt, Maths::g_vIdentity);
-			tFrustum.Transform(tFrustum, mRot.GetRaw());
-			tFrustum.Transform(
-				tFrustum,
-				IOEMatrix::Translation(rCamera.GetTransform().GetTranslation())
-					.GetRaw());
+			++m_tCacheStats.uReused;
+			m_tCullStats				= Maths::IOEBVHCullStats();
+			m_tCullStats.uItemsVisible =
+				static_cast<std::uint32_t>(m_arrVisibleItems.size());
+
+			if (m_uNumOccluded > 0)
+			{
+				BuildModelRanges(m_arrVisibleItems);
+			}
+			return;
 		}
-		else
+
+		const std::uint64_t uViewBit(static_cast<std::uint64_t>(1) << uView);
+
+		// Objects are already in item order so no sort is needed
+		m_arrVisibleItems.clear();
+		for (std::uint32_t uIdx(0); uIdx < rViews.GetNumVisibleObjects();
+			 ++uIdx)
 		{
-			tFrustum.Transform(tFrustum,
-							   rCamera.GetTransform().ToMatrix().GetRaw());
+			const IOEMultiViewObject &rObject(rViews.GetVisibleObject(uIdx));
+			if ((rObject.uViewMask & uViewBit) != 0)
+			{
+				m_arrVisibleItems.push_back(rObject.uItem);
+			}
 		}
 
-		// tFrustum.Transform(tFrustum,
-		// rCamera.GetViewMatrix().ToMatrix().GetRaw());
+		m_tCullStats = rViews.GetCullStats();
+		BuildModelRanges(m_arrVisibleItems);
 
-		for (int32_t uIdx(0);
-			 uIdx < IOEModelManager::GetSingletonPtr()->GetNumModels(); ++uIdx)
-		{
-			IOEModel *pModel(
-				IOEModelManager::GetSingletonPtr()->GetModel(uIdx));
-			IOE_ASSERT(pModel != nullptr, "Model not found");
+		m_bCacheValid		 = true;
+		m_pCachedViews		 = &rViews;
+		m_uCachedView		 = uView;
+		m_uCachedResultEpoch = rViews.GetResultEpoch();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEVisibilityBounds::UpdateCached(
+		const Maths::IOEFrustumPlanes &rPlanes, std::uint32_t uPlaneMask)
+	{
+		IOEModelManager *pManager(IOEModelManager::GetSingletonPtr());
+		const Maths::IOEBVH &rHierarchy(pManager->GetSubsetHierarchy());
 
-			if (pModel != nullptr)
+		++m_tCacheStats.uUpdates;
+		if (m_bCacheValid && m_pCachedViews == nullptr &&
+			m_uCachedHierarchyEpoch == pManager->GetHierarchyEpoch() &&
+			m_uCachedPlaneMask == uPlaneMask && m_tCachedPlanes == rPlanes)
+		{
+			if (m_uCachedBoundsEpoch == pManager->GetBoundsEpoch())
 			{
-				DirectX::BoundingBox tBox(GetBoxFromAABB(pModel->GetAABB()));
+				++m_tCacheStats.uReused;
+				m_tCullStats				= Maths::IOEBVHCullStats();
+				m_tCullStats.uItemsVisible =
+					static_cast<std::uint32_t>(m_arrVisibleItems.size());
 
-				if (!tFrustum.Intersects(tBox) && !tFrustum.Contains(tBox))
+				// Occlusion only lasts until the next update
+				if (m_uNumOccluded > 0)
 				{
-					// Entire model is not contained, instantly reject all sub
-					// objects
-					continue;
+					BuildModelRanges(m_arrVisibleItems);
 				}
+				return;
+			}
 
-				std::int32_t nModelIdx(FindModelIndex(pModel));
-				if (nModelIdx == -1)
-				{
-					nModelIdx = static_cast<std::int32_t>(m_uNumModels);
-					m_arrModels[m_uNumModels].pModel = pModel;
-					m_arrModels[m_uNumModels].pHead =
-						m_arrModels[m_uNumModels].pTail = nullptr;
-					++m_uNumModels;
-				}
-				IOEVisbilityModel &rVisibilityModel(m_arrModels[nModelIdx]);
+			if (Patch(rHierarchy, rPlanes, uPlaneMask))
+			{
+				++m_tCacheStats.uPatched;
+				m_uCachedBoundsEpoch = pManager->GetBoundsEpoch();
+				return;
+			}
+		}
 
-				// TODO: Put some accelerated BSP method here to speed up
-				// searching
-				for (int32_t uMeshIdx(0); uMeshIdx < pModel->GetNumSubsets();
-					 ++uMeshIdx)
-				{
-					MeshIndex &rMeshIndex(pModel->GetSubset(uMeshIdx));
-
-					tBox = GetBoxFromAABB(rMeshIndex.m_tAABB);
-
-					if (tFrustum.Intersects(tBox))
-					{
-						m_arrVisibleLinks[m_uNumLinks].pMeshIndex =
-							&rMeshIndex;
-						m_arrVisibleLinks[m_uNumLinks].pNext = nullptr;
-
-						if (rVisibilityModel.pTail != nullptr)
-						{
-							rVisibilityModel.pTail->pNext =
-								&m_arrVisibleLinks[m_uNumLinks];
-						}
-						rVisibilityModel.pTail =
-							&m_arrVisibleLinks[m_uNumLinks];
-						if (rVisibilityModel.pHead == nullptr)
-						{
-							rVisibilityModel.pHead =
-								&m_arrVisibleLinks[m_uNumLinks];
-						}
-
-						++m_uNumLinks;
-					}
-				}
+		Cull(rHierarchy, rPlanes, uPlaneMask);
+
+		m_bCacheValid			= true;
+		m_tCachedPlanes			= rPlanes;
+		m_uCachedPlaneMask		= uPlaneMask;
+		m_pCachedViews			= nullptr;
+		m_uCachedHierarchyEpoch = pManager->GetHierarchyEpoch();
+		m_uCachedBoundsEpoch	= pManager->GetBoundsEpoch();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEVisibilityBounds::Patch(const Maths::IOEBVH &rHierarchy,
+									const Maths::IOEFrustumPlanes &rPlanes,
+									std::uint32_t uPlaneMask)
+	{
+		m_arrMovedItems.clear();
+		IOEModelManager::GetSingletonPtr()->GetItemsMovedSince(
+			m_uCachedBoundsEpoch, m_arrMovedItems);
+		if (m_arrMovedItems.size() * ms_uPatchLimit > rHierarchy.GetNumItems())
+		{
+			return false;
+		}
+
+		// Drop the moved subsets, keeping the rest in item order
+		m_arrVisibleItems.erase(
+			std::remove_if(m_arrVisibleItems.begin(), m_arrVisibleItems.end(),
+						   [this](std::uint32_t uItem) {
+							   return std::binary_search(m_arrMovedItems.begin(),
+														 m_arrMovedItems.end(),
+														 uItem);
+						   }),
+			m_arrVisibleItems.end());
+		const std::size_t uNumKept(m_arrVisibleItems.size());
+
+		// Moved items come out in item order too, so one merge restores it
+		for (std::uint32_t uItem : m_arrMovedItems)
+		{
+			float arrCentre[3], arrExtent[3];
+			rHierarchy.GetBounds(uItem, arrCentre, arrExtent);
+			if (Maths::CullAABB(rPlanes, arrCentre, arrExtent, uPlaneMask) !=
+				Maths::ECullResult::Outside)
+			{
+				m_arrVisibleItems.push_back(uItem);
 			}
 		}
+		std::inplace_merge(m_arrVisibleItems.begin(),
+						   m_arrVisibleItems.begin() + uNumKept,
+						   m_arrVisibleItems.end());
+
+		const std::uint32_t uNumMoved(
+			static_cast<std::uint32_t>(m_arrMovedItems.size()));
+		m_tCullStats				= Maths::IOEBVHCullStats();
+		m_tCullStats.uItemsTested	= uNumMoved;
+		m_tCullStats.uItemsVisible =
+			static_cast<std::uint32_t>(m_arrVisibleItems.size());
+		m_tCacheStats.uItemsRetested += uNumMoved;
+
+		BuildModelRanges(m_arrVisibleItems);
+		return true;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	void IOEVisibilityBounds::UpdateVisibility(const IOEVector &vOrigin,
-											   const IOEVector &vNormal)
+	void IOEVisibilityBounds::Cull(const Maths::IOEBVH &rHierarchy,
+								   const Maths::IOEFrustumPlanes &rPlanes,
+								   std::uint32_t uPlaneMask)
 	{
-		m_uNumLinks  = 0;
-		m_uNumModels = 0;
+		// A few pieces per worker so uneven subtrees still balance
+		const std::uint32_t uNumTasks(
+			rHierarchy.GetNumItems() < ms_uParallelThreshold
+				? 1
+				: static_cast<std::uint32_t>(
+					  tbb::task_scheduler_init::default_num_threads() * 4));
+		rHierarchy.GetSubtrees(uNumTasks, m_arrSubtrees);
+
+		const std::size_t uNumSubtrees(m_arrSubtrees.size());
+		if (m_arrTaskVisible.size() < uNumSubtrees)
+		{
+			m_arrTaskVisible.resize(uNumSubtrees);
+		}
+		m_arrTaskStats.resize(uNumSubtrees);
 
-		for (int32_t uIdx(0);
-			 uIdx < IOEModelManager::GetSingletonPtr()->GetNumModels(); ++uIdx)
+		if (uNumSubtrees > 1)
+		{
+			tbb::parallel_for(
+				std::size_t(0), uNumSubtrees, [&](std::size_t uTask) {
+					m_arrTaskVisible[uTask].clear();
+					rHierarchy.CullSubtree(m_arrSubtrees[uTask], rPlanes,
+										   uPlaneMask, m_arrTaskVisible[uTask],
+										   &m_arrTaskStats[uTask]);
+				});
+		}
+		else if (uNumSubtrees == 1)
 		{
-			IOEModel *pModel(
-				IOEModelManager::GetSingletonPtr()->GetModel(uIdx));
-			IOE_ASSERT(pModel != nullptr, "Model not found");
+			m_arrTaskVisible[0].clear();
+			rHierarchy.CullSubtree(m_arrSubtrees[0], rPlanes, uPlaneMask,
+								   m_arrTaskVisible[0], &m_arrTaskStats[0]);
+		}
 
-			if (pModel != nullptr)
-			{
-				if (!IsAnyInFront(pModel->GetAABB(), vOrigin, vNormal))
-				{
-					// Entire model is not contained, instantly reject all sub
-					// objects
-					continue;
-				}
+		MergeTaskResults();
+		BuildModelRanges(m_arrVisibleItems);
+	}
 
-				std::int32_t nModelIdx(FindModelIndex(pModel));
-				if (nModelIdx == -1)
-				{
-					nModelIdx = static_cast<std::int32_t>(m_uNumModels);
-					m_arrModels[m_uNumModels].pModel = pModel;
-					m_arrModels[m_uNumModels].pHead =
-						m_arrModels[m_uNumModels].pTail = nullptr;
-					++m_uNumModels;
-				}
-				IOEVisbilityModel &rVisibilityModel(m_arrModels[nModelIdx]);
+	//////////////////////////////////////////////////////////////////////////
 
-				// TODO: Put some accelerated BSP method here to speed up
-				// searching
-				for (int32_t uMeshIdx(0); uMeshIdx < pModel->GetNumSubsets();
-					 ++uMeshIdx)
-				{
-					MeshIndex &rMeshIndex(pModel->GetSubset(uMeshIdx));
-
-					if (IsAnyInFront(rMeshIndex.m_tAABB, vOrigin, vNormal))
-					{
-						m_arrVisibleLinks[m_uNumLinks].pMeshIndex =
-							&rMeshIndex;
-						m_arrVisibleLinks[m_uNumLinks].pNext = nullptr;
-
-						if (rVisibilityModel.pTail != nullptr)
-						{
-							rVisibilityModel.pTail->pNext =
-								&m_arrVisibleLinks[m_uNumLinks];
-						}
-						rVisibilityModel.pTail =
-							&m_arrVisibleLinks[m_uNumLinks];
-						if (rVisibilityModel.pHead == nullptr)
-						{
-							rVisibilityModel.pHead =
-								&m_arrVisibleLinks[m_uNumLinks];
-						}
-
-						++m_uNumLinks;
-					}
-				}
+	void IOEVisibilityBounds::MergeTaskResults()
+	{
+		// Every task owns a fixed slice of the output, found from the sizes
+		// of the tasks before it, so the copies need no synchronisation
+		const std::size_t uNumTasks(m_arrSubtrees.size());
+		m_arrTaskOffsets.resize(uNumTasks);
+		m_tCullStats = Maths::IOEBVHCullStats();
+
+		std::size_t uNumVisible(0);
+		for (std::size_t uTask(0); uTask < uNumTasks; ++uTask)
+		{
+			m_arrTaskOffsets[uTask] = uNumVisible;
+			uNumVisible += m_arrTaskVisible[uTask].size();
+			m_tCullStats += m_arrTaskStats[uTask];
+		}
+		m_arrVisibleItems.resize(uNumVisible);
+
+		auto CopyTask = [&](std::size_t uTask) {
+			const std::vector<std::uint32_t> &rTaskVisible(
+				m_arrTaskVisible[uTask]);
+			std::copy(rTaskVisible.begin(), rTaskVisible.end(),
+					  m_arrVisibleItems.begin() + m_arrTaskOffsets[uTask]);
+		};
+		if (uNumTasks > 1)
+		{
+			tbb::parallel_for(std::size_t(0), uNumTasks, CopyTask);
+		}
+		else if (uNumTasks == 1)
+		{
+			CopyTask(0);
+		}
+
+		// Items are numbered model by model in subset order, so sorting
+		// groups each model's subsets together in draw order
+		tbb::parallel_sort(m_arrVisibleItems.begin(), m_arrVisibleItems.end());
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEVisibilityBounds::RemoveOccluded(
+		const Maths::IOEOcclusionBuffer &rBuffer)
+	{
+		const Maths::IOEBVH &rHierarchy(
+			IOEModelManager::GetSingletonPtr()->GetSubsetHierarchy());
+
+		// Tests only read the buffer so large sets are split across
+		// workers, each writing its own flags
+		const std::size_t uNumItems(m_arrVisibleItems.size());
+		m_arrOccluded.resize(uNumItems);
+		auto TestItem = [&](std::size_t uIdx) {
+			float arrCentre[3], arrExtent[3];
+			rHierarchy.GetBounds(m_arrVisibleItems[uIdx], arrCentre,
+								 arrExtent);
+			m_arrOccluded[uIdx] =
+				rBuffer.IsOccluded(arrCentre, arrExtent) ? 1 : 0;
+		};
+		if (uNumItems >= ms_uParallelThreshold)
+		{
+			tbb::parallel_for(std::size_t(0), uNumItems, TestItem);
+		}
+		else
+		{
+			for (std::size_t uIdx(0); uIdx < uNumItems; ++uIdx)
+			{
+				TestItem(uIdx);
 			}
 		}
+
+		m_arrUnoccludedItems.clear();
+		for (std::size_t uIdx(0); uIdx < uNumItems; ++uIdx)
+		{
+			if (m_arrOccluded[uIdx] == 0)
+			{
+				m_arrUnoccludedItems.push_back(m_arrVisibleItems[uIdx]);
+			}
+		}
+
+		BuildModelRanges(m_arrUnoccludedItems);
+		m_uNumOccluded = static_cast<std::uint32_t>(
+			uNumItems - m_arrUnoccludedItems.size());
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	std::int32_t IOEVisibilityBounds::FindModelIndex(IOEModel *pModel) const
+	void IOEVisibilityBounds::BuildModelRanges(
+		const std::vector<std::uint32_t> &rItems)
 	{
-		for (uint32_t uIdx(0); uIdx < m_uNumModels; ++uIdx)
+		IOEModelManager *pManager(IOEModelManager::GetSingletonPtr());
+
+		m_arrVisibleSubsets.resize(rItems.size());
+		m_arrVisibleModels.clear();
+		m_uNumOccluded = 0;
+
+		std::uint32_t uLastModelIdx(~0u);
+		for (std::uint32_t uIdx(0); uIdx < rItems.size(); ++uIdx)
 		{
-			if (m_arrModels[uIdx].pModel == pModel)
+			const IOESubsetRef &rRef(pManager->GetSubsetRef(rItems[uIdx]));
+			m_arrVisibleSubsets[uIdx] = rRef.uSubsetIdx;
+
+			if (rRef.uModelIdx != uLastModelIdx)
 			{
-				return static_cast<std::int32_t>(uIdx);
+				IOEVisibleModel tModel;
+				tModel.pModel =
+					pManager->GetModel(static_cast<int32_t>(rRef.uModelIdx));
+				tModel.uFirst = uIdx;
+				m_arrVisibleModels.push_back(tModel);
+				uLastModelIdx = rRef.uModelIdx;
 			}
+			++m_arrVisibleModels.back().uCount;
 		}
-		return -1;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -2,10 +2,12 @@
 
 //////////////////////////////////////////////////////////////////////////
 
-#include <array>
 #include <cstdint>
+#include <vector>
 
 #include <IOE/IOECore/IOEDefines.h>
+#include <IOE/IOEMaths/BVH.h>
+#include <IOE/IOEMaths/OcclusionBuffer.h>
 #include <IOE/IOERenderer/IOEModel.h>
 
 //////////////////////////////////////////////////////////////////////////
@@ -18,161 +20,199 @@ namespace Renderer
 	//////////////////////////////////////////////////////////////////////////
 
 	class IOEModel;
+	class IOEMultiViewVisibility;
 
 	//////////////////////////////////////////////////////////////////////////
 
-	struct IOEVisibilityLink
+	// A run of one model's visible subsets within
+	// IOEVisibilityBounds::GetVisibleSubsets, in subset order
+	struct IOEVisibleModel
 	{
-		IOEVisibilityLink()
-			: pMeshIndex(nullptr)
-			, pNext(nullptr)
+		IOEVisibleModel()
+			: pModel(nullptr)
+			, uFirst(0)
+			, uCount(0)
 		{
 		}
 
-		MeshIndex *pMeshIndex;
-		IOEVisibilityLink *pNext;
+		IOEModel *pModel;
+		std::uint32_t uFirst;
+		std::uint32_t uCount;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
 
-	struct IOEVisbilityModel
+	// How often updates were answered from the previous result, counted
+	// from construction or the last ResetCacheStats
+	struct IOEVisibilityCacheStats
 	{
-		IOEVisbilityModel()
-			: pModel(nullptr)
-			, pHead(nullptr)
-			, pTail(nullptr)
+		IOEVisibilityCacheStats()
+			: uUpdates(0)
+			, uReused(0)
+			, uPatched(0)
+			, uItemsRetested(0)
 		{
 		}
 
-		IOEModel *pModel;
-		IOEVisibilityLink *pHead;
-		IOEVisibilityLink *pTail;
+		// Fraction of updates that avoided a full cull
+		float GetHitRate() const
+		{
+			return uUpdates > 0 ? static_cast<float>(uReused + uPatched) /
+									  static_cast<float>(uUpdates)
+								: 0.0f;
+		}
+
+		std::uint32_t uUpdates;
+
+		// Neither the view nor anything in the scene changed
+		std::uint32_t uReused;
+
+		// Only the subsets of moved models were tested again
+		std::uint32_t uPatched;
+		std::uint32_t uItemsRetested;
 	};
 
 	//////////////////////////////////////////////////////////////////////////
 
+	// Visible subsets of every model for one view. The output is a single
+	// contiguous array of subset indices split into per-model ranges, with
+	// no limit on the number of subsets or models. Buffers are kept from
+	// frame to frame so a steady scene culls without allocating.
+	//
+	// Large scenes are culled on the TBB worker threads, each taking a
+	// disjoint piece of the subset hierarchy and writing to its own output,
+	// which are then copied to their offsets in the shared array.
+	//
+	// The inputs of the last cull are kept alongside its result. When the
+	// view is unchanged the result is reused as is if nothing has moved
+	// since, or patched by testing only the subsets of moved models.
 	class IOEVisibilityBounds
 	{
-		static const std::uint32_t ms_uMaxNumVisibleLinks = 512;
-		static const std::uint32_t ms_uNumModels		  = 32;
+		// Below this many subsets a single thread is faster
+		static const std::uint32_t ms_uParallelThreshold = 1024;
+
+	public:
+		// Once more than one subset in this many has moved a full cull is
+		// cheaper than patching the previous result
+		static const std::uint32_t ms_uPatchLimit = 4;
 
 	public:
 		IOEVisibilityBounds();
 
 	public:
-		void UpdateVisibility(IOECamera &rCamera);
+		// Culls against rCamera's frustum. The models are only read, so
+		// views with other world origins may be culled at any point in the
+		// frame.
+		void UpdateVisibility(const IOECamera &rCamera);
 		void UpdateVisibility(const IOEVector &vOrigin,
 							  const IOEVector &vNormal);
 
+		// Takes one view's results from a multi-view cull
+		void UpdateVisibility(const IOEMultiViewVisibility &rViews,
+							  std::uint32_t uView);
+
+		// Drops the subsets hidden in rBuffer from the per-model ranges
+		// until the next update. The frustum result is kept, so cached
+		// updates stay valid.
+		void RemoveOccluded(const Maths::IOEOcclusionBuffer &rBuffer);
+
+		// Subset hierarchy items inside the frustum, before any occlusion,
+		// in item order
+		FORCEINLINE std::uint32_t GetNumVisibleItems() const
+		{
+			return static_cast<std::uint32_t>(m_arrVisibleItems.size());
+		}
+		FORCEINLINE const std::uint32_t *GetVisibleItems() const
+		{
+			return m_arrVisibleItems.data();
+		}
+
 		FORCEINLINE std::uint32_t GetNumVisibleMeshes() const
 		{
-			return m_uNumLinks;
+			return static_cast<std::uint32_t>(m_arrVisibleSubsets.size());
 		}
-		FORCEINLINE MeshIndex *GetMeshIndex(std::uint32_t uIdx)
+		FORCEINLINE const std::uint32_t *GetVisibleSubsets() const
 		{
-			return m_arrVisibleLinks[uIdx].pMeshIndex;
+			return m_arrVisibleSubsets.data();
 		}
 
 		FORCEINLINE std::uint32_t GetNumModels() const
 		{
-			return m_uNumModels;
+			return static_cast<std::uint32_t>(m_arrVisibleModels.size());
 		}
-		FORCEINLINE IOEVisbilityModel &GetModel(std::uint32_t uIdx)
+		FORCEINLINE const IOEVisibleModel &GetModel(std::uint32_t uIdx) const
 		{
-			return m_arrModels[uIdx];
+			return m_arrVisibleModels[uIdx];
 		}
 
-		FORCEINLINE void SetTakeIntoAccountLookAt(bool bValue)
+		// Nodes visited, subtrees accepted whole and subsets tested by the
+		// last update
+		FORCEINLINE const Maths::IOEBVHCullStats &GetCullStats() const
 		{
-			m_bTakeIntoAccountLookAt = bValue;
+			return m_tCullStats;
 		}
 
-	private:
-		FORCEINLINE bool IsInFront(const IOEVector &vPos,
-								   const IOEVector &vOrigin,
-								   const IOEVector &vDir) const
+		// Subsets removed by the last RemoveOccluded, zero after an update
+		FORCEINLINE std::uint32_t GetNumOccluded() const
 		{
-			return (vPos - vOrigin).Dot(vDir) >= 0.0f;
+			return m_uNumOccluded;
 		}
 
-		FORCEINLINE bool IsInFront(const IOEVector &vPos,
-								   const IOEVector &vDir) const
+		FORCEINLINE const IOEVisibilityCacheStats &GetCacheStats() const
 		{
-			return vPos.Dot(vDir) >= 0.0f;
+			return m_tCacheStats;
+		}
+		void ResetCacheStats()
+		{
+			m_tCacheStats = IOEVisibilityCacheStats();
 		}
 
-		FORCEINLINE bool IsAnyInFront(const IOEAABB &rAABB,
-									  const IOEVector &vOrigin,
-									  const IOEVector &vDir) const
+		// Forces the next update to cull from scratch
+		void InvalidateCache()
 		{
-			// Test min bound
-			IOEVector vMin(rAABB.m_vBounds[0] - vOrigin);
-			if (IsInFront(vMin, vDir))
-			{
-				return true;
-			}
-
-			// Test max bound
-			IOEVector vMax(rAABB.m_vBounds[1] - vOrigin);
-			if (IsInFront(vMax, vDir))
-			{
-				return true;
-			}
-
-			// Test all other corners
-			float arrMin[3], arrMax[3];
-			vMin.Get(arrMin[0], arrMin[1], arrMin[2]);
-			vMax.Get(arrMax[0], arrMax[1], arrMax[2]);
-
-			// 001
-			if (IsInFront(IOEVector(arrMin[0], arrMin[1], arrMax[2]), vDir))
-			{
-				return true;
-			}
-
-			// 010
-			if (IsInFront(IOEVector(arrMin[0], arrMax[1], arrMin[2]), vDir))
-			{
-				return true;
-			}
-
-			// 011
-			if (IsInFront(IOEVector(arrMin[0], arrMax[1], arrMax[2]), vDir))
-			{
-				return true;
-			}
-
-			// 100
-			if (IsInFront(IOEVector(arrMax[0], arrMin[1], arrMin[2]), vDir))
-			{
-				return true;
-			}
-
-			// 101
-			if (IsInFront(IOEVector(arrMax[0], arrMin[1], arrMax[2]), vDir))
-			{
-				return true;
-			}
-
-			// 110
-			if (IsInFront(IOEVector(arrMax[0], arrMax[1], arrMin[2]), vDir))
-			{
-				return true;
-			}
-
-			// No points in front, fully outside of plane, cull
-			return false;
+			m_bCacheValid = false;
 		}
 
-		std::int32_t FindModelIndex(IOEModel *pModel) const;
+	private:
+		void UpdateCached(const Maths::IOEFrustumPlanes &rPlanes,
+						  std::uint32_t uPlaneMask);
+		bool Patch(const Maths::IOEBVH &rHierarchy,
+				   const Maths::IOEFrustumPlanes &rPlanes,
+				   std::uint32_t uPlaneMask);
+		void Cull(const Maths::IOEBVH &rHierarchy,
+				  const Maths::IOEFrustumPlanes &rPlanes,
+				  std::uint32_t uPlaneMask);
+		void MergeTaskResults();
+		void BuildModelRanges(const std::vector<std::uint32_t> &rItems);
 
 	private:
-		std::array<IOEVisibilityLink, ms_uMaxNumVisibleLinks>
-			m_arrVisibleLinks;
-		std::array<IOEVisbilityModel, ms_uNumModels> m_arrModels;
-		std::uint32_t m_uNumLinks;
-		std::uint32_t m_uNumModels;
-		bool m_bTakeIntoAccountLookAt;
+		// Per task culling output, indexed by subtree
+		std::vector<std::uint32_t> m_arrSubtrees;
+		std::vector<std::vector<std::uint32_t> > m_arrTaskVisible;
+		std::vector<Maths::IOEBVHCullStats> m_arrTaskStats;
+		std::vector<std::size_t> m_arrTaskOffsets;
+
+		std::vector<std::uint32_t> m_arrVisibleItems;
+		std::vector<std::uint8_t> m_arrOccluded;
+		std::vector<std::uint32_t> m_arrUnoccludedItems;
+		std::uint32_t m_uNumOccluded;
+		std::vector<std::uint32_t> m_arrVisibleSubsets;
+		std::vector<IOEVisibleModel> m_arrVisibleModels;
+		Maths::IOEBVHCullStats m_tCullStats;
+
+		// Inputs of the current result. A multi-view result is identified
+		// by its source, view and result epoch instead of by planes.
+		bool m_bCacheValid;
+		Maths::IOEFrustumPlanes m_tCachedPlanes;
+		std::uint32_t m_uCachedPlaneMask;
+		const IOEMultiViewVisibility *m_pCachedViews;
+		std::uint32_t m_uCachedView;
+		std::uint32_t m_uCachedResultEpoch;
+		std::uint32_t m_uCachedHierarchyEpoch;
+		std::uint32_t m_uCachedBoundsEpoch;
+
+		std::vector<std::uint32_t> m_arrMovedItems;
+		IOEVisibilityCacheStats m_tCacheStats;
 	};
 
 } // namespace Renderer
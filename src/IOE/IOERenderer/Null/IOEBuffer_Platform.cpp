@@ -0,0 +1,77 @@
+#include <cstring>
+
+#include "IOEBuffer_Platform.h"
+#include "../IOEBuffer.h"
+#include "../IOERPI.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEBuffer_Platform::Setup(IOERPI *pRPI)
+	{
+		const std::size_t uSizeBytes(GetBuffer()->GetElementSize() *
+									 GetBuffer()->GetNumElements());
+		m_arrData.resize(uSizeBytes);
+		if (uSizeBytes > 0)
+		{
+			std::memcpy(m_arrData.data(), GetBuffer()->GetRawData(),
+						uSizeBytes);
+		}
+
+		pRPI->GetPlatform().GetCommandStream().Record(
+			ERPICommand::CreateBuffer, GetResource(), uSizeBytes);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEBuffer_Platform::Release()
+	{
+		m_arrData.clear();
+		m_arrData.shrink_to_fit();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEBuffer_Platform::Map(EBufferMapType eMapType, void *&rpData)
+	{
+		IOE_ASSERT(GetBuffer()->GetCPUAccess() != ECPUAccess::GPUWriteBack,
+				   "Staging buffers not supported!");
+
+		if (m_arrData.empty())
+		{
+			return false;
+		}
+		rpData			  = m_arrData.data();
+		m_bMappedForWrite = eMapType != EBufferMapType::ReadOnly;
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEBuffer_Platform::Unmap()
+	{
+		IOE_ASSERT(GetBuffer()->GetCPUAccess() != ECPUAccess::GPUWriteBack,
+				   "Staging buffers not supported!");
+
+		// The whole buffer is counted, as a discard upload would send it
+		if (m_bMappedForWrite)
+		{
+			IOE::Renderer::IOERPI::GetSingletonPtr()
+				->GetPlatform()
+				.GetCommandStream()
+				.Record(ERPICommand::Upload, GetResource(), m_arrData.size());
+			m_bMappedForWrite = false;
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+#include <cstdint>
+#include <vector>
+
+#include <IOE/IOECore/IOEDefines.h>
+#include "../IOEBuffer_PlatformBase.h"
+#include "IOEComSharedPtr.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	enum class EBufferMapType;
+
+	class IOEBufferBase;
+
+	using std::uint32_t;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// System memory copy of the buffer, standing in for the device buffer.
+	// Its address identifies the buffer in the command stream.
+	class IOEBuffer_Platform : public IOEBuffer_PlatformBase
+	{
+	public:
+		IOEBuffer_Platform(IOEBufferBase *pBase)
+			: IOEBuffer_PlatformBase(pBase)
+			, m_bMappedForWrite(false)
+		{
+		}
+
+		virtual void Setup(class IOERPI *pPtr) override final;
+		virtual void Release() override final;
+
+		virtual bool Map(EBufferMapType eMapType,
+						 void *&rpData) override final;
+		virtual bool Unmap() override final;
+
+		FORCEINLINE const void *GetResource() const
+		{
+			return m_arrData.empty() ? nullptr : m_arrData.data();
+		}
+		FORCEINLINE std::size_t GetSizeBytes() const
+		{
+			return m_arrData.size();
+		}
+
+	private:
+		std::vector<std::uint8_t> m_arrData;
+		bool m_bMappedForWrite;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <memory>
+#include <functional>
+
+namespace IOE
+{
+namespace Renderer
+{
+	//////////////////////////////////////////////////////////////////////////
+
+	// The null platform creates no COM objects. This header only exists so
+	// the shared platform headers find it as they do for the D3D platforms.
+
+	//////////////////////////////////////////////////////////////////////////
+} // namespace Renderer
+} // namespace IOE
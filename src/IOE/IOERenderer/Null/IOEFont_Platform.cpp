@@ -0,0 +1,61 @@
+#include <cmath>
+
+#include "IOEFont_Platform.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEFont_Platform::IOEFont_Platform(const std::string &szName,
+									   EFontCreationFlags::Enum eCreationFlags)
+		: IOEFont_PlatformBase(szName, eCreationFlags)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEFont_Platform::RasteriseGlyph(std::uint32_t uCodePoint,
+										  std::uint32_t uPixelHeight,
+										  IOEGlyphBitmap &rBitmap)
+	{
+		// Surrogates and anything past the last plane are not characters
+		if ((uCodePoint >= 0xD800 && uCodePoint <= 0xDFFF) ||
+			uCodePoint > 0x10FFFF)
+		{
+			return false;
+		}
+
+		// Line height as GDI gives for the em, and a monospace advance of
+		// roughly six tenths of it
+		const std::uint32_t uLineHeight(static_cast<std::uint32_t>(
+			std::ceil(uPixelHeight * 1.2f)));
+		const std::uint32_t uAdvance(static_cast<std::uint32_t>(
+			std::ceil(uPixelHeight * 0.6f)));
+		rBitmap.fAdvance	= static_cast<float>(uAdvance);
+		rBitmap.fLineHeight = static_cast<float>(uLineHeight);
+
+		if (uCodePoint == ' ')
+		{
+			return true;
+		}
+
+		// A box from the baseline to the cap height, a texel in from
+		// either side of the cell
+		const std::uint32_t uDescent(uLineHeight - uPixelHeight);
+		rBitmap.uWidth	  = uAdvance - 2;
+		rBitmap.uHeight	  = uPixelHeight * 7 / 10;
+		rBitmap.fBearingX = 1.0f;
+		rBitmap.fBearingY = static_cast<float>(uDescent);
+		rBitmap.arrCoverage.assign(rBitmap.uWidth * rBitmap.uHeight, 255);
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,33 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include "../IOEFont_PlatformBase.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Fills a fixed size cell for every glyph rather than rasterising it,
+	// so text still fills the atlas and produces the quads it would on a
+	// device
+	class IOEFont_Platform : public IOEFont_PlatformBase
+	{
+	public:
+		IOEFont_Platform(const std::string &szName,
+						 EFontCreationFlags::Enum eCreationFlags);
+
+		virtual bool RasteriseGlyph(std::uint32_t uCodePoint,
+									std::uint32_t uPixelHeight,
+									IOEGlyphBitmap &rBitmap) override final;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
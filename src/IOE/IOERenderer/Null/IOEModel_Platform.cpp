@@ -0,0 +1,134 @@
+#include <IOE/IOEExceptions/IOEException_Renderer.h>
+#include <IOE/IOEExceptions/IOEException_Enum.h>
+
+#include <IOE/IOERenderer/IOERPI.h>
+
+#include "IOEModel_Platform.h"
+#include "../IOEShader.h"
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEModel_Platform::OnSetup(class IOERPI *pRPI)
+	{
+		m_pIndexBuffer  = nullptr;
+		m_pVertexBuffer = nullptr;
+		if (GetModel().GetVertexBuffer().size() <= 0 ||
+			GetModel().GetIndexBuffer().size() <= 0)
+		{
+			THROW_IOE_RENDERER_EXCEPTION(
+				"Model must have at least 1 vertex and index",
+				E_ERROR_FAILED_TO_LOAD_MODEL);
+		}
+
+		IOERPICommandStream &rStream(pRPI->GetPlatform().GetCommandStream());
+
+		m_pVertexBuffer = GetModel().GetVertexBuffer().data();
+		rStream.Record(ERPICommand::CreateBuffer, m_pVertexBuffer,
+					   GetModel().GetVertexBuffer().size() *
+						   sizeof(GetModel().GetVertexBuffer().at(0)));
+
+		m_pIndexBuffer = GetModel().GetIndexBuffer().data();
+		rStream.Record(ERPICommand::CreateBuffer, m_pIndexBuffer,
+					   GetModel().GetIndexBuffer().size() *
+						   sizeof(GetModel().GetIndexBuffer().at(0)));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEModel_Platform::SetBuffers(IOERPI *pRPI)
+	{
+		IOERPICommandStream &rStream(pRPI->GetPlatform().GetCommandStream());
+		rStream.Record(ERPICommand::SetVertexBuffer, m_pVertexBuffer,
+					   sizeof(ModelVertex));
+		rStream.Record(ERPICommand::SetIndexBuffer, m_pIndexBuffer);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEModel_Platform::OnRender(IOERPI *pRPI,
+									 bool bSetShaderVariables /*=true*/)
+	{
+		if (m_pVertexBuffer != nullptr && m_pIndexBuffer != nullptr)
+		{
+			SetBuffers(pRPI);
+
+			for (std::int32_t nIdx(0); nIdx < GetModel().GetNumSubsets();
+				 ++nIdx)
+			{
+				const MeshIndex &rIndex(GetModel().GetSubset(nIdx));
+				rIndex.m_pMaterial->SetAllVariables(pRPI);
+
+				pRPI->SetPrimitiveTopology(EPrimitiveTopology::TriangleList);
+				pRPI->GetPlatform().GetCommandStream().Record(
+					ERPICommand::DrawIndexed, &GetModel(),
+					static_cast<std::uint64_t>(rIndex.m_nNumIndices));
+				pRPI->GetRenderStats().AddDraw(
+					EPrimitiveTopology::TriangleList,
+					static_cast<std::uint64_t>(rIndex.m_nNumIndices));
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEModel_Platform::OnRender(IOERPI *pRPI,
+									 const std::uint32_t *pSubsets,
+									 std::uint32_t uNumSubsets,
+									 bool bSetShaderVariables /*=true*/)
+	{
+		if (m_pVertexBuffer != nullptr && m_pIndexBuffer != nullptr)
+		{
+			SetBuffers(pRPI);
+
+			for (std::uint32_t uIdx(0); uIdx < uNumSubsets; ++uIdx)
+			{
+				const MeshIndex &rIndex(GetModel().GetSubset(
+					static_cast<std::int32_t>(pSubsets[uIdx])));
+				rIndex.m_pMaterial->SetAllVariables(pRPI);
+
+				pRPI->SetPrimitiveTopology(EPrimitiveTopology::TriangleList);
+				pRPI->GetPlatform().GetCommandStream().Record(
+					ERPICommand::DrawIndexed, &GetModel(),
+					static_cast<std::uint64_t>(rIndex.m_nNumIndices));
+				pRPI->GetRenderStats().AddDraw(
+					EPrimitiveTopology::TriangleList,
+					static_cast<std::uint64_t>(rIndex.m_nNumIndices));
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEModel_Platform::OnRenderInstanced(IOERPI *pRPI,
+											  std::uint32_t uSubset,
+											  std::uint32_t uNumInstances)
+	{
+		if (m_pVertexBuffer != nullptr && m_pIndexBuffer != nullptr)
+		{
+			SetBuffers(pRPI);
+
+			const MeshIndex &rIndex(
+				GetModel().GetSubset(static_cast<std::int32_t>(uSubset)));
+			rIndex.m_pMaterial->SetAllVariables(pRPI);
+
+			pRPI->SetPrimitiveTopology(EPrimitiveTopology::TriangleList);
+			pRPI->GetPlatform().GetCommandStream().Record(
+				ERPICommand::DrawIndexedInstanced, &GetModel(),
+				static_cast<std::uint64_t>(rIndex.m_nNumIndices),
+				uNumInstances);
+			pRPI->GetRenderStats().AddDraw(
+				EPrimitiveTopology::TriangleList,
+				static_cast<std::uint64_t>(rIndex.m_nNumIndices),
+				uNumInstances);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "../IOEModel_PlatformBase.h"
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class IOEModel;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class IOEModel_Platform : public IOEModel_PlatformBase
+	{
+	public:
+		IOEModel_Platform(IOEModel &rModel)
+			: IOEModel_PlatformBase(rModel)
+			, m_pVertexBuffer(nullptr)
+			, m_pIndexBuffer(nullptr)
+		{
+		}
+
+		virtual void OnRender(class IOERPI *pRPI,
+							  bool bSetShaderVariables = true) override final;
+		virtual void OnRender(class IOERPI *pRPI,
+							  const std::uint32_t *pSubsets,
+							  std::uint32_t uNumSubsets,
+							  bool bSetShaderVariables = true) override final;
+		virtual void OnRenderInstanced(class IOERPI *pRPI,
+									   std::uint32_t uSubset,
+									   std::uint32_t uNumInstances)
+			override final;
+		virtual void OnSetup(class IOERPI *pRPI) override final;
+
+	private:
+		void SetBuffers(class IOERPI *pRPI);
+
+	private:
+		// The model's own vertex and index data stand in for the device
+		// buffers once set up
+		const void *m_pVertexBuffer;
+		const void *m_pIndexBuffer;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+} // namespace Renderer
+} // namespace IOE
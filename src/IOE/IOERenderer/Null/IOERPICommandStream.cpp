@@ -0,0 +1,206 @@
+#include "IOERPICommandStream.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace ERPICommand
+	{
+		const char *ToName(Enum eCommand)
+		{
+			switch (eCommand)
+			{
+			case StartRender:
+				return "StartRender";
+			case FinishRender:
+				return "FinishRender";
+			case ResetState:
+				return "ResetState";
+			case Clear:
+				return "Clear";
+			case ClearDepth:
+				return "ClearDepth";
+			case ClearUAV:
+				return "ClearUAV";
+			case ClearBuffer:
+				return "ClearBuffer";
+			case SetRasterizerState:
+				return "SetRasterizerState";
+			case SetBlendState:
+				return "SetBlendState";
+			case SetSamplerState:
+				return "SetSamplerState";
+			case SetDepthState:
+				return "SetDepthState";
+			case SetRenderTargets:
+				return "SetRenderTargets";
+			case SetUAVs:
+				return "SetUAVs";
+			case SetViewports:
+				return "SetViewports";
+			case SetPrimitiveTopology:
+				return "SetPrimitiveTopology";
+			case SetShader:
+				return "SetShader";
+			case SetConstantBuffers:
+				return "SetConstantBuffers";
+			case SetTexture:
+				return "SetTexture";
+			case SetSampler:
+				return "SetSampler";
+			case SetVertexBuffer:
+				return "SetVertexBuffer";
+			case SetIndexBuffer:
+				return "SetIndexBuffer";
+			case Upload:
+				return "Upload";
+			case Draw:
+				return "Draw";
+			case DrawIndexed:
+				return "DrawIndexed";
+			case DrawIndexedInstanced:
+				return "DrawIndexedInstanced";
+			case Dispatch:
+				return "Dispatch";
+			case CreateBuffer:
+				return "CreateBuffer";
+			case CreateTexture:
+				return "CreateTexture";
+			case CreateShader:
+				return "CreateShader";
+			case CreateState:
+				return "CreateState";
+			case ProfileMarker:
+				return "ProfileMarker";
+			case NumCommands:
+			default:
+				return "Unknown";
+			}
+		}
+	} // namespace ERPICommand
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOERPICommandStream::IOERPICommandStream()
+		: m_bRecordCommands(true)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPICommandStream::Record(ERPICommand::Enum eCommand,
+									 const void *pObject,
+									 std::uint64_t uValue /*=0*/,
+									 std::uint32_t uSlot /*=0*/)
+	{
+		IOERPICommand tCommand;
+		tCommand.eCommand = eCommand;
+		tCommand.uSlot	= uSlot;
+		tCommand.pObject  = pObject;
+		tCommand.uValue   = uValue;
+
+		++m_tStats.arrCommandCounts[eCommand];
+
+		if (ERPICommand::IsStateChange(eCommand))
+		{
+			++m_tStats.uStateChanges;
+			if (!UpdateBoundState(tCommand))
+			{
+				++m_tStats.uRedundantStateChanges;
+			}
+		}
+		else if (ERPICommand::IsDraw(eCommand))
+		{
+			++m_tStats.uDraws;
+			m_tStats.uDrawnIndices += uValue;
+			m_tStats.uDrawnInstances +=
+				eCommand == ERPICommand::DrawIndexedInstanced ? uSlot : 1u;
+		}
+		else if (ERPICommand::IsCreate(eCommand))
+		{
+			++m_tStats.uResourcesCreated;
+			m_tStats.uBytesCreated += uValue;
+		}
+		else if (eCommand == ERPICommand::Upload ||
+				 eCommand == ERPICommand::ClearBuffer)
+		{
+			++m_tStats.uUploads;
+			m_tStats.uBytesUploaded += uValue;
+		}
+		else if (eCommand == ERPICommand::Dispatch)
+		{
+			++m_tStats.uDispatches;
+		}
+
+		if (m_bRecordCommands)
+		{
+			m_arrCommands.push_back(tCommand);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOERPICommandStream::UpdateBoundState(const IOERPICommand &rCommand)
+	{
+		const std::uint64_t uKey(
+			(static_cast<std::uint64_t>(rCommand.eCommand) << 32) |
+			rCommand.uSlot);
+		const std::pair<const void *, std::uint64_t> tBound(rCommand.pObject,
+															rCommand.uValue);
+
+		auto itFound(m_arrBoundState.find(uKey));
+		if (itFound == m_arrBoundState.end())
+		{
+			m_arrBoundState.emplace(uKey, tBound);
+			return true;
+		}
+		if (itFound->second == tBound)
+		{
+			return false;
+		}
+		itFound->second = tBound;
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPICommandStream::ResetBoundState()
+	{
+		m_arrBoundState.clear();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPICommandStream::ResetBoundState(ERPICommand::Enum eCommand)
+	{
+		for (auto itState(m_arrBoundState.begin());
+			 itState != m_arrBoundState.end();)
+		{
+			if ((itState->first >> 32) == static_cast<std::uint64_t>(eCommand))
+			{
+				itState = m_arrBoundState.erase(itState);
+			}
+			else
+			{
+				++itState;
+			}
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPICommandStream::Reset()
+	{
+		m_arrCommands.clear();
+		m_tStats = IOERPICommandStats();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,213 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <IOE/IOECore/IOEPortable.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace ERPICommand
+	{
+		enum Enum
+		{
+			StartRender,
+			FinishRender,
+			ResetState,
+
+			Clear,
+			ClearDepth,
+			ClearUAV,
+			ClearBuffer,
+
+			// State changes, each bound to a slot
+			SetRasterizerState,
+			SetBlendState,
+			SetSamplerState,
+			SetDepthState,
+			SetRenderTargets,
+			SetUAVs,
+			SetViewports,
+			SetPrimitiveTopology,
+			SetShader,
+			SetConstantBuffers,
+			SetTexture,
+			SetSampler,
+			SetVertexBuffer,
+			SetIndexBuffer,
+
+			// Writes of CPU data to a resource
+			Upload,
+
+			Draw,
+			DrawIndexed,
+			DrawIndexedInstanced,
+			Dispatch,
+
+			// Resource creation
+			CreateBuffer,
+			CreateTexture,
+			CreateShader,
+			CreateState,
+
+			ProfileMarker,
+
+			NumCommands
+		};
+
+		inline bool IsStateChange(Enum eCommand)
+		{
+			return eCommand >= SetRasterizerState && eCommand <= SetIndexBuffer;
+		}
+
+		inline bool IsDraw(Enum eCommand)
+		{
+			return eCommand >= Draw && eCommand <= DrawIndexedInstanced;
+		}
+
+		inline bool IsCreate(Enum eCommand)
+		{
+			return eCommand >= CreateBuffer && eCommand <= CreateState;
+		}
+
+		const char *ToName(Enum eCommand);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// One recorded call. pObject identifies what was bound, drawn from or
+	// created, and uValue carries the call's size: indices drawn, bytes
+	// uploaded or created, or the state-specific argument of a set. uSlot
+	// is the slot a state was bound to, or the instances of a draw.
+	struct IOERPICommand
+	{
+		ERPICommand::Enum eCommand;
+		std::uint32_t uSlot;
+		const void *pObject;
+		std::uint64_t uValue;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Totals of everything recorded since construction or the last Reset
+	struct IOERPICommandStats
+	{
+		IOERPICommandStats()
+			: uDraws(0)
+			, uDrawnIndices(0)
+			, uDrawnInstances(0)
+			, uDispatches(0)
+			, uStateChanges(0)
+			, uRedundantStateChanges(0)
+			, uUploads(0)
+			, uBytesUploaded(0)
+			, uResourcesCreated(0)
+			, uBytesCreated(0)
+		{
+			arrCommandCounts.fill(0);
+		}
+
+		std::array<std::uint32_t, ERPICommand::NumCommands> arrCommandCounts;
+
+		std::uint32_t uDraws;
+		std::uint64_t uDrawnIndices;
+		std::uint64_t uDrawnInstances;
+		std::uint32_t uDispatches;
+
+		// Sets that bound what their slot already held are counted in both
+		std::uint32_t uStateChanges;
+		std::uint32_t uRedundantStateChanges;
+
+		std::uint32_t uUploads;
+		std::uint64_t uBytesUploaded;
+
+		std::uint32_t uResourcesCreated;
+		std::uint64_t uBytesCreated;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// In-memory record of the calls the null RPI platform would have made
+	// on a device. Every command updates the totals; the commands themselves
+	// are only kept while recording is enabled, so long benchmarks can run
+	// on the totals without the stream growing.
+	//
+	// The object last bound to each state slot is remembered, so setting a
+	// slot to what it already holds is counted as a redundant state change.
+	// Like an immediate device context it must only be used from the render
+	// thread.
+	class IOERPICommandStream
+	{
+	public:
+		IOERPICommandStream();
+
+	public:
+		void Record(ERPICommand::Enum eCommand, const void *pObject,
+					std::uint64_t uValue = 0, std::uint32_t uSlot = 0);
+
+		// Forgets what each slot holds, so the next set of every slot is
+		// counted as a change
+		void ResetBoundState();
+		void ResetBoundState(ERPICommand::Enum eCommand);
+
+		// Clears the commands and totals, keeping what each slot holds
+		void Reset();
+
+		FORCEINLINE void SetRecordCommands(bool bRecord)
+		{
+			m_bRecordCommands = bRecord;
+		}
+		FORCEINLINE bool GetRecordCommands() const
+		{
+			return m_bRecordCommands;
+		}
+
+		FORCEINLINE std::uint32_t GetNumCommands() const
+		{
+			return static_cast<std::uint32_t>(m_arrCommands.size());
+		}
+		FORCEINLINE const IOERPICommand &GetCommand(std::uint32_t uIdx) const
+		{
+			return m_arrCommands[uIdx];
+		}
+
+		FORCEINLINE const IOERPICommandStats &GetStats() const
+		{
+			return m_tStats;
+		}
+		FORCEINLINE std::uint32_t GetCount(ERPICommand::Enum eCommand) const
+		{
+			return m_tStats.arrCommandCounts[eCommand];
+		}
+
+	private:
+		bool UpdateBoundState(const IOERPICommand &rCommand);
+
+	private:
+		std::vector<IOERPICommand> m_arrCommands;
+		bool m_bRecordCommands;
+
+		IOERPICommandStats m_tStats;
+
+		// Object and argument last bound, keyed by command and slot
+		std::unordered_map<std::uint64_t,
+						   std::pair<const void *, std::uint64_t> >
+			m_arrBoundState;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
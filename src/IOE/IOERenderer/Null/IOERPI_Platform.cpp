@@ -0,0 +1,633 @@
+#include <cstring>
+
+#include <IOE/IOECore/IOEHeaders.h>
+
+#include "../IOEBuffer.h"
+#include "../IOEMaterial.h"
+#include "../IOERPI.h"
+#include "../IOEVertexFormat.h"
+#include "../IOEViewport.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		// Folds a set of bound resources into one value, so rebinding the
+		// same set is seen as redundant even though it spans several slots
+		template <std::size_t uSize>
+		std::uint64_t HashBindings(const std::array<const void *, uSize> &rarr,
+								   const void *pExtra)
+		{
+			std::uint64_t uHash(14695981039346656037ULL);
+			for (const void *pBound : rarr)
+			{
+				uHash ^= reinterpret_cast<std::uintptr_t>(pBound);
+				uHash *= 1099511628211ULL;
+			}
+			uHash ^= reinterpret_cast<std::uintptr_t>(pExtra);
+			uHash *= 1099511628211ULL;
+			return uHash;
+		}
+
+		const void *GetResource(IOETexture &rTexture)
+		{
+			return rTexture.GetPlatform().GetResource();
+		}
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOERPI_Platform::IOERPI_Platform()
+		: m_pDepthTarget(nullptr)
+	{
+		m_arrRenderTargets.fill(nullptr);
+		m_arrUAVs.fill(nullptr);
+		m_arrCSUAVs.fill(nullptr);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::OnInit(weak_ptr<IOERPI> pRPI)
+	{
+		IOERPI_PlatformBase::OnInit(pRPI);
+
+		CreateDebugBuffers();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::Resize(float fNewWidth, float fNewHeight)
+	{
+		IOERPI *pRPI(GetRPI());
+		pRPI->GetDefaultColourBuffer().GetPlatform().Cleanup();
+		pRPI->GetDefaultDepthStencilbuffer().GetPlatform().Cleanup();
+
+		m_tCommandStream.ResetBoundState();
+
+		pRPI->GetDefaultColourBuffer().GetPlatform().Setup();
+		pRPI->GetDefaultDepthStencilbuffer().GetPlatform().Setup();
+
+		m_arrRenderTargets.fill(nullptr);
+		m_arrRenderTargets[0] = GetResource(pRPI->GetDefaultColourBuffer());
+		m_pDepthTarget = GetResource(pRPI->GetDefaultDepthStencilbuffer());
+
+		SetupViewports();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::CreateDebugBuffers()
+	{
+		m_arrDebugVertices.resize(sizeof(DebugVertex) *
+								  IOERPI::ms_uMaxDebugVertices);
+
+		m_tCommandStream.Record(ERPICommand::CreateBuffer,
+								m_arrDebugVertices.data(),
+								m_arrDebugVertices.size());
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::Clear(IOE::Maths::IOEVector &vColour)
+	{
+		for (const void *pTarget : m_arrRenderTargets)
+		{
+			if (pTarget != nullptr)
+			{
+				m_tCommandStream.Record(ERPICommand::Clear, pTarget);
+			}
+		}
+		m_tCommandStream.Record(ERPICommand::ClearDepth, m_pDepthTarget);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::ClearDepth(IOE::Maths::IOEVector &vColour)
+	{
+		m_tCommandStream.Record(ERPICommand::ClearDepth, m_pDepthTarget);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::ResetUAVs()
+	{
+		m_arrUAVs.fill(nullptr);
+		m_arrCSUAVs.fill(nullptr);
+
+		RefreshUAVs(EUAVSet::ComputeShader);
+		RefreshUAVs(EUAVSet::OutputMerger);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::ClearUAV(
+		IOETexture *pUAV,
+		IOE::Maths::IOEVector &vColour /*= Maths::ColourList::Black*/)
+	{
+		IOE_ASSERT(pUAV->GetBufferDescription() &
+					   EBufferDescription::UnorderedAccess,
+				   "Incompatable texture type");
+		m_tCommandStream.Record(ERPICommand::ClearUAV, GetResource(*pUAV));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::ClearUAV(IOETexture *pUAV, std::uint32_t uARGB)
+	{
+		IOE_ASSERT(pUAV->GetBufferDescription() &
+					   EBufferDescription::UnorderedAccess,
+				   "Incompatable texture type");
+		m_tCommandStream.Record(ERPICommand::ClearUAV, GetResource(*pUAV),
+								uARGB);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::ClearBuffer(IOETexture *pBuffer,
+									  const void *pSrcValue,
+									  std::size_t uSrcByteSize)
+	{
+		IOE_ASSERT(pBuffer->GetTextureType() == ETextureType::GenericBuffer &&
+					   pBuffer->GetTextureFormat() == ETextureFormat::Unknown,
+				   "Invalid texture type");
+
+		// The buffer is filled as UpdateSubresource would fill it, so
+		// mapping it afterwards reads back the cleared value. It is mapped
+		// read only so the clear is counted once, below.
+		void *pData(nullptr);
+		if (pBuffer->GetPlatform().MapBuffer(EBufferMapType::ReadOnly, pData))
+		{
+			const std::uint8_t *pTypedSrcValue(
+				static_cast<const std::uint8_t *>(pSrcValue));
+			std::uint8_t *pTypedData(static_cast<std::uint8_t *>(pData));
+
+			const std::size_t uNumBytes(pBuffer->GetPlatform().GetSizeBytes());
+			for (std::size_t uByteIdx(0); uByteIdx < uNumBytes; ++uByteIdx)
+			{
+				pTypedData[uByteIdx] = pTypedSrcValue[uByteIdx % uSrcByteSize];
+			}
+			pBuffer->GetPlatform().UnmapBuffer();
+		}
+
+		m_tCommandStream.Record(ERPICommand::ClearBuffer, GetResource(*pBuffer),
+								pBuffer->GetPlatform().GetSizeBytes());
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::SetupViewports()
+	{
+		m_tCommandStream.Record(
+			ERPICommand::SetViewports, GetRPI(),
+			static_cast<std::uint64_t>(GetRPI()->GetNumViewports()));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::FinishRender()
+	{
+		IOERPI *pRPI(GetRPI());
+		const std::uint32_t uNumVertices(pRPI->GetNumDebugVertices());
+		if (uNumVertices > 0)
+		{
+			const std::uint32_t uSizeBytes(
+				uNumVertices * static_cast<std::uint32_t>(sizeof(DebugVertex)));
+			std::uint32_t uOffset(0);
+			const void *pBuffer(m_arrUploadRings[EUploadRing::Vertex].data());
+			void *pData(pRPI->MapUpload(EUploadRing::Vertex, uSizeBytes, 16,
+										uOffset));
+			if (pData == nullptr)
+			{
+				pBuffer = m_arrDebugVertices.data();
+				pData   = m_arrDebugVertices.data();
+				m_tCommandStream.Record(ERPICommand::Upload, pBuffer,
+										uSizeBytes);
+			}
+			pRPI->WriteDebugData(static_cast<DebugVertex *>(pData));
+			if (pBuffer != m_arrDebugVertices.data())
+			{
+				pRPI->UnmapUpload(EUploadRing::Vertex);
+			}
+
+			pRPI->GetDebugDrawMaterial()->Set(pRPI);
+
+			m_tCommandStream.Record(
+				ERPICommand::SetVertexBuffer, pBuffer,
+				(static_cast<std::uint64_t>(uOffset) << 32) |
+					sizeof(DebugVertex));
+
+			std::uint32_t uNumPoints(pRPI->GetNumDebugPoints());
+			std::uint32_t uNumLines(pRPI->GetNumDebugLines());
+			std::uint32_t uNumTris(pRPI->GetNumDebugTriangles());
+
+			if (uNumPoints)
+			{
+				pRPI->SetPrimitiveTopology(EPrimitiveTopology::Point);
+				m_tCommandStream.Record(ERPICommand::Draw, pBuffer,
+										uNumPoints);
+			}
+			if (uNumLines)
+			{
+				pRPI->SetPrimitiveTopology(EPrimitiveTopology::LineList);
+				m_tCommandStream.Record(ERPICommand::Draw, pBuffer,
+										uNumLines * 2);
+			}
+			if (uNumTris)
+			{
+				pRPI->SetPrimitiveTopology(EPrimitiveTopology::TriangleList);
+				m_tCommandStream.Record(ERPICommand::Draw, pBuffer,
+										uNumTris * 3);
+			}
+		}
+
+		// Stands in for the present
+		m_tCommandStream.Record(ERPICommand::FinishRender, nullptr);
+
+		m_arrRenderTargets.fill(nullptr);
+		RefreshRenderTargets();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::StartRender()
+	{
+		IOERPI *pRPI(GetRPI());
+
+		m_tCommandStream.Record(ERPICommand::StartRender, nullptr);
+
+		pRPI->SetCamera(pRPI->GetDefaultCamera());
+
+		m_arrRenderTargets.fill(nullptr);
+		m_arrRenderTargets[0] = GetResource(pRPI->GetDefaultColourBuffer());
+		RefreshRenderTargets();
+
+		pRPI->SetRasterizerState(pRPI->GetRasterizerState());
+
+		pRPI->ResetViewports();
+		SetupViewports();
+
+		pRPI->GetCamera().UpdateViewMatrices();
+
+		// The default sampler is owned by the platform, as on D3D11
+		m_tCommandStream.Record(ERPICommand::SetSamplerState, this);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::UnsetRenderTarget(int32_t nRenderTarget /*=0*/)
+	{
+		m_arrRenderTargets[nRenderTarget] = nullptr;
+		RefreshRenderTargets();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::SetRenderTarget(IOE::Renderer::IOETexture &rTexture,
+										  int32_t nRenderTargetIdx /*=0*/,
+										  bool bSet /*=true*/)
+	{
+		m_arrRenderTargets[nRenderTargetIdx] = GetResource(rTexture);
+		if (bSet)
+		{
+			RefreshRenderTargets();
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::SetRenderTargets(IOETextureSpan arrTextures,
+										   bool bSet /*=true*/)
+	{
+		m_arrRenderTargets.fill(nullptr);
+
+		std::size_t uIdx(0);
+		for (IOETexture *pTexture : arrTextures)
+		{
+			m_arrRenderTargets[uIdx++] = GetResource(*pTexture);
+		}
+		if (bSet)
+		{
+			RefreshRenderTargets();
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::SetDepthTarget(
+		IOE::Renderer::IOETexture &rDepthTexture, bool bSet /*=true*/)
+	{
+		m_pDepthTarget = GetResource(rDepthTexture);
+		if (bSet)
+		{
+			RefreshRenderTargets();
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::RefreshRenderTargets()
+	{
+		m_tCommandStream.Record(ERPICommand::SetRenderTargets,
+								m_arrRenderTargets[0],
+								HashBindings(m_arrRenderTargets,
+											 m_pDepthTarget));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::UnsetUAV(int32_t nUAV, EUAVSet bSet)
+	{
+		auto &rarrUAVs(bSet == EUAVSet::ComputeShader ? m_arrCSUAVs
+													  : m_arrUAVs);
+		rarrUAVs[nUAV] = nullptr;
+		RefreshUAVs(bSet);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::SetUAV(IOE::Renderer::IOETexture &rTexture,
+								 int32_t nUAVIdx /*=0*/, EUAVSet bSet,
+								 int arrOffset /*=0*/)
+	{
+		auto &rarrUAVs(bSet == EUAVSet::ComputeShader ? m_arrCSUAVs
+													  : m_arrUAVs);
+		rarrUAVs[nUAVIdx] = GetResource(rTexture);
+		RefreshUAVs(bSet);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::SetUAVs(IOETextureSpan arrTextures, EUAVSet bSet)
+	{
+		auto &rarrUAVs(bSet == EUAVSet::ComputeShader ? m_arrCSUAVs
+													  : m_arrUAVs);
+		rarrUAVs.fill(nullptr);
+
+		std::size_t uIdx(0);
+		for (IOETexture *pTexture : arrTextures)
+		{
+			rarrUAVs[uIdx++] = GetResource(*pTexture);
+		}
+		RefreshUAVs(bSet);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::RefreshUAVs(EUAVSet bSet)
+	{
+		if (bSet == EUAVSet::ComputeShader)
+		{
+			m_tCommandStream.Record(ERPICommand::SetUAVs, m_arrCSUAVs[0],
+									HashBindings(m_arrCSUAVs, nullptr),
+									static_cast<std::uint32_t>(bSet));
+		}
+		else
+		{
+			// UAVs share the output merger slots with the render targets, so
+			// as on D3D11 they are bound with them
+			m_tCommandStream.Record(ERPICommand::SetUAVs, m_arrUAVs[0],
+									HashBindings(m_arrUAVs, nullptr),
+									static_cast<std::uint32_t>(bSet));
+			RefreshRenderTargets();
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::ResetState()
+	{
+		m_tCommandStream.Record(ERPICommand::ResetState, nullptr);
+
+		// Only the shaders are unbound, so only they must be set again
+		m_tCommandStream.ResetBoundState(ERPICommand::SetShader);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::UnsetShader(EShaderType::Enum eShaderType)
+	{
+		m_tCommandStream.Record(ERPICommand::SetShader, nullptr, 0,
+								static_cast<std::uint32_t>(eShaderType));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::SetConstantBuffer(std::uint32_t uSlot,
+											IOEBufferBase *pBuffer)
+	{
+		const void *pResource(
+			pBuffer != nullptr ? pBuffer->GetPlatform().GetResource()
+							   : nullptr);
+
+		// Slots match those the shaders record their own buffers at
+		for (std::uint32_t uShaderType(0);
+			 uShaderType < EShaderType::NumShaders; ++uShaderType)
+		{
+			m_tCommandStream.Record(
+				ERPICommand::SetConstantBuffers, pResource, 0,
+				uSlot + uShaderType *
+							ShaderConstantBufferDescription::
+								ms_nMaxCBufferSlots);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::DrawBuffer(IOEBufferBase *pVertexBuffer,
+									 EPrimitiveTopology eTopology,
+									 IOEBufferBase *pIndexBuffer /*=nullptr*/,
+									 std::int32_t nNumElements /*=-1*/)
+	{
+		const void *pVertexData(pVertexBuffer->GetPlatform().GetResource());
+		if (pVertexData == nullptr)
+		{
+			return;
+		}
+
+		m_tCommandStream.Record(ERPICommand::SetVertexBuffer, pVertexData,
+								pVertexBuffer->GetElementSize());
+		m_tCommandStream.Record(
+			ERPICommand::SetIndexBuffer,
+			pIndexBuffer ? pIndexBuffer->GetPlatform().GetResource() : nullptr,
+			pIndexBuffer ? pIndexBuffer->GetElementSize() : 0);
+
+		SetPrimitiveTopology(eTopology);
+
+		if (pIndexBuffer != nullptr)
+		{
+			std::size_t uNumVerts(nNumElements <= 0
+									  ? pIndexBuffer->GetNumElements()
+									  : static_cast<std::size_t>(nNumElements));
+			m_tCommandStream.Record(ERPICommand::DrawIndexed, pIndexBuffer,
+									uNumVerts);
+		}
+		else
+		{
+			std::size_t uNumVerts(nNumElements <= 0
+									  ? pVertexBuffer->GetNumElements()
+									  : static_cast<std::size_t>(nNumElements));
+			m_tCommandStream.Record(ERPICommand::Draw, pVertexBuffer,
+									uNumVerts);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::DrawUploadBuffer(
+		std::uint32_t uOffset, std::uint32_t uStride,
+		EPrimitiveTopology eTopology, std::uint32_t uNumElements,
+		IOEBufferBase *pIndexBuffer /*=nullptr*/)
+	{
+		const void *pVertexData(m_arrUploadRings[EUploadRing::Vertex].data());
+
+		// The offset is part of the binding, so a draw from another upload
+		// is a change of vertex buffer
+		m_tCommandStream.Record(
+			ERPICommand::SetVertexBuffer, pVertexData,
+			(static_cast<std::uint64_t>(uOffset) << 32) | uStride);
+		m_tCommandStream.Record(
+			ERPICommand::SetIndexBuffer,
+			pIndexBuffer ? pIndexBuffer->GetPlatform().GetResource() : nullptr,
+			pIndexBuffer ? pIndexBuffer->GetElementSize() : 0);
+
+		SetPrimitiveTopology(eTopology);
+
+		if (pIndexBuffer != nullptr)
+		{
+			m_tCommandStream.Record(ERPICommand::DrawIndexed, pIndexBuffer,
+									uNumElements);
+		}
+		else
+		{
+			m_tCommandStream.Record(ERPICommand::Draw, pVertexData,
+									uNumElements);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEGPUFence *IOERPI_Platform::GetFence()
+	{
+		return &m_tFence;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOERPI_Platform::CreateUploadRing(EUploadRing::Enum eRing,
+										   std::uint32_t uSizeBytes)
+	{
+		m_arrUploadRings[eRing].assign(uSizeBytes, 0);
+		m_tCommandStream.Record(ERPICommand::CreateBuffer,
+								m_arrUploadRings[eRing].data(), uSizeBytes);
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void *IOERPI_Platform::MapUploadRing(EUploadRing::Enum eRing,
+										 std::uint32_t uOffset,
+										 std::uint32_t uSizeBytes)
+	{
+		m_tCommandStream.Record(ERPICommand::Upload,
+								m_arrUploadRings[eRing].data(), uSizeBytes);
+		return m_arrUploadRings[eRing].data() + uOffset;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::UnmapUploadRing(EUploadRing::Enum eRing)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERasterizerState_Platform::Setup(IOERPI *pRPI)
+	{
+		pRPI->GetPlatform().GetCommandStream().Record(
+			ERPICommand::CreateState, &GetState(), sizeof(GetState().tData));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEBlendState_Platform::Setup(IOERPI *pRPI)
+	{
+		pRPI->GetPlatform().GetCommandStream().Record(
+			ERPICommand::CreateState, &GetState(), sizeof(GetState().tData));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOESamplerState_Platform::Setup(IOERPI *pRPI)
+	{
+		pRPI->GetPlatform().GetCommandStream().Record(
+			ERPICommand::CreateState, &GetState(), sizeof(GetState().tData));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEDepthState_Platform::Setup(IOERPI *pRPI)
+	{
+		pRPI->GetPlatform().GetCommandStream().Record(
+			ERPICommand::CreateState, &GetState(), sizeof(GetState().tData));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::SetRasterizerState(const IOERasterizerState &rhs)
+	{
+		m_tCommandStream.Record(ERPICommand::SetRasterizerState, &rhs);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::SetBlendState(
+		const IOEBlendState &rhs, std::uint32_t uWriteMask /*=0xFFFFFFFF*/,
+		const IOE::Maths::IOEVector &vBlendFactor /*=g_vOneVector*/)
+	{
+		m_tCommandStream.Record(ERPICommand::SetBlendState, &rhs, uWriteMask);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::SetSamplerState(const IOESamplerState &rhs)
+	{
+		m_tCommandStream.Record(ERPICommand::SetSamplerState, &rhs);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::SetDepthState(const IOEDepthState &rhs,
+										std::uint32_t uStencilRef /*=0*/)
+	{
+		m_tCommandStream.Record(ERPICommand::SetDepthState, &rhs, uStencilRef);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::SetProfileMarker(const std::string &szProfilerMark,
+										   EProfileMarkerType eProfileMarker,
+										   const IOE::Maths::IOEVector &vColour)
+	{
+		m_tCommandStream.Record(ERPICommand::ProfileMarker, nullptr,
+								static_cast<std::uint64_t>(eProfileMarker));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOERPI_Platform::SetPrimitiveTopology(EPrimitiveTopology eTopology)
+	{
+		m_tCommandStream.Record(ERPICommand::SetPrimitiveTopology, nullptr,
+								static_cast<std::uint64_t>(eTopology));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
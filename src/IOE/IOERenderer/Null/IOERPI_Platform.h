@@ -0,0 +1,240 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <IOE/IOERenderer/IOERPI_PlatformBase.h>
+#include "IOERPICommandStream.h"
+
+namespace IOE
+{
+namespace Renderer
+{
+	//////////////////////////////////////////////////////////////////////////
+
+	enum class EPrimitiveTopology;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	struct IOERasterizerState_Platform : public IOERasterizerState_PlatformBase
+	{
+		IOERasterizerState_Platform(IOERasterizerState &rState)
+			: IOERasterizerState_PlatformBase(rState)
+		{
+		}
+
+		virtual void Setup(IOERPI *pRPI) override final;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	struct IOEBlendState_Platform : public IOEBlendState_PlatformBase
+	{
+		IOEBlendState_Platform(IOEBlendState &rState)
+			: IOEBlendState_PlatformBase(rState)
+		{
+		}
+
+		virtual void Setup(IOERPI *pRPI) override final;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	struct IOESamplerState_Platform : public IOESamplerState_PlatformBase
+	{
+		IOESamplerState_Platform(IOESamplerState &rState)
+			: IOESamplerState_PlatformBase(rState)
+		{
+		}
+
+		virtual void Setup(IOERPI *pRPI) override final;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	struct IOEDepthState_Platform : public IOEDepthState_PlatformBase
+	{
+		IOEDepthState_Platform(IOEDepthState &rState)
+			: IOEDepthState_PlatformBase(rState)
+		{
+		}
+
+		virtual void Setup(IOERPI *pRPI) override final;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// The null device has nothing in flight, so each signal has been passed
+	// as soon as it is made
+	class IOEGPUFence_Platform : public IOEGPUFence
+	{
+	public:
+		IOEGPUFence_Platform()
+			: m_uCompletedValue(0)
+		{
+		}
+
+		virtual void Signal(std::uint64_t uValue) override final
+		{
+			m_uCompletedValue = uValue;
+		}
+		virtual std::uint64_t GetCompletedValue() override final
+		{
+			return m_uCompletedValue;
+		}
+		virtual void Wait(std::uint64_t uValue) override final
+		{
+		}
+
+	private:
+		std::uint64_t m_uCompletedValue;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Headless platform with no device. Every call that would reach the GPU
+	// is recorded into a command stream instead, so the CPU side of the
+	// renderer can run and be measured on machines without D3D. Bindings
+	// are tracked as the D3D11 platform tracks them, so a target change
+	// records one SetRenderTargets just as it would make one OMSet call.
+	class IOERPI_Platform : public IOERPI_PlatformBase
+	{
+		static const int32_t ms_nNumRenderTargets = 8;
+		static const int32_t ms_nNumUAVs		  = 8;
+
+	public:
+		IOERPI_Platform();
+
+		virtual void SetupViewports() override final;
+		virtual void ClearDepth(IOE::Maths::IOEVector &vColour) override final;
+		virtual void Clear(IOE::Maths::IOEVector &vColour) override final;
+		virtual void ClearUAV(IOETexture *pUAV,
+							  IOE::Maths::IOEVector &vColour =
+								  Maths::ColourList::Black) override final;
+		virtual void ClearUAV(IOETexture *pUAV,
+							  std::uint32_t uARGB) override final;
+		virtual void ResetUAVs() override final;
+		virtual void ClearBuffer(IOETexture *pBuffer, const void *pSrcValue,
+								 std::size_t uSrcByteSize) override final;
+
+		virtual void StartRender() override final;
+		virtual void FinishRender() override final;
+
+		virtual void SetRasterizerState(const IOERasterizerState &rhs)
+			override final;
+		virtual void
+		SetBlendState(const IOEBlendState &rhs,
+					  std::uint32_t uWriteMask = 0xFFFFFFFF,
+					  const IOE::Maths::IOEVector &srrBlendFactor =
+						  IOE::Maths::g_vOneVector) override final;
+		virtual void SetSamplerState(const IOESamplerState &rhs)
+			override final;
+		virtual void SetDepthState(const IOEDepthState &rhs,
+								   std::uint32_t uStencilRef = 0)
+			override final;
+
+		virtual void SetProfileMarker(const std::string &szProfilerMark,
+									  EProfileMarkerType eProfileMarker,
+									  const IOE::Maths::IOEVector &vColour)
+			override final;
+
+	public:
+		virtual void OnInit(weak_ptr<IOERPI> pRPI) override final;
+		virtual void Resize(float fNewWidth, float fNewHeight) override final;
+
+	public:
+		FORCEINLINE IOERPICommandStream &GetCommandStream()
+		{
+			return m_tCommandStream;
+		}
+		FORCEINLINE const IOERPICommandStream &GetCommandStream() const
+		{
+			return m_tCommandStream;
+		}
+
+	public:
+		virtual void ResetState() override final;
+		virtual void UnsetShader(EShaderType::Enum eShaderType)
+			override final;
+		virtual void SetConstantBuffer(std::uint32_t uSlot,
+									   IOEBufferBase *pBuffer) override final;
+
+		virtual void UnsetRenderTarget(int32_t nRenderTarget = 0)
+			override final;
+		virtual void SetRenderTarget(IOE::Renderer::IOETexture &rTexture,
+									 int32_t nRenderTargetIdx = 0,
+									 bool bSet = true) override final;
+		virtual void SetRenderTargets(IOETextureSpan arrTextures,
+									  bool bSet = true) override final;
+
+		virtual void SetDepthTarget(IOE::Renderer::IOETexture &rDepthTexture,
+									bool bSet = true) override final;
+
+	public:
+		virtual void UnsetUAV(int32_t nUAV, EUAVSet bSet) override final;
+		virtual void SetUAV(IOE::Renderer::IOETexture &rTexture,
+							int32_t nUAVIdx, EUAVSet bSet,
+							int arrOffset = 0) override final;
+		virtual void SetUAVs(IOETextureSpan arrTextures,
+							 EUAVSet bSet) override final;
+
+	public:
+		virtual void DrawBuffer(IOEBufferBase *pVertexBuffer,
+								EPrimitiveTopology eTopology,
+								IOEBufferBase *pIndexBuffer = nullptr,
+								std::int32_t nNumElements = -1) override final;
+
+		virtual void SetPrimitiveTopology(EPrimitiveTopology eTopology)
+			override final;
+
+	public:
+		virtual IOEGPUFence *GetFence() override final;
+
+		virtual bool CreateUploadRing(EUploadRing::Enum eRing,
+									  std::uint32_t uSizeBytes) override final;
+		virtual void *MapUploadRing(EUploadRing::Enum eRing,
+									std::uint32_t uOffset,
+									std::uint32_t uSizeBytes) override final;
+		virtual void UnmapUploadRing(EUploadRing::Enum eRing) override final;
+
+		virtual void DrawUploadBuffer(std::uint32_t uOffset,
+									  std::uint32_t uStride,
+									  EPrimitiveTopology eTopology,
+									  std::uint32_t uNumElements,
+									  IOEBufferBase *pIndexBuffer = nullptr)
+			override final;
+
+		// Identifies a ring as the upload ring's buffer would be
+		FORCEINLINE const void *GetUploadRingData(EUploadRing::Enum eRing) const
+		{
+			return m_arrUploadRings[eRing].data();
+		}
+
+	private:
+		void CreateDebugBuffers();
+
+		void RefreshRenderTargets();
+		void RefreshUAVs(EUAVSet bSet);
+
+	private:
+		IOERPICommandStream m_tCommandStream;
+
+		// Stands in for the dynamic debug vertex buffer, drawn from when the
+		// debug vertices do not fit in the vertex ring
+		std::vector<std::uint8_t> m_arrDebugVertices;
+
+		std::array<std::vector<std::uint8_t>, EUploadRing::NumRings>
+			m_arrUploadRings;
+		IOEGPUFence_Platform m_tFence;
+
+		// Resources bound to each slot, identified as the texture platform
+		// identifies them
+		std::array<const void *, ms_nNumRenderTargets> m_arrRenderTargets;
+		const void *m_pDepthTarget;
+		std::array<const void *, ms_nNumUAVs> m_arrUAVs;
+		std::array<const void *, ms_nNumUAVs> m_arrCSUAVs;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,204 @@
+#include "IOEShader_Platform.h"
+
+#include <IOE/IOERenderer/IOEModel.h>
+#include <IOE/IOERenderer/IOERPI.h>
+#include <IOE/IOERenderer/IOEShader.h>
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEShader_Platform::IOEShader_Platform(IOEShader &rShader)
+		: IOEShader_PlatformBase(rShader)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::string IOEShader_Platform::GetCompilerSignature() const
+	{
+		return "Null";
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShader_Platform::CompileShader(
+		const IOEShaderCompilationOptions &rOptions, IOEShaderBinary &rBinary)
+	{
+		// Without a compiler there is no bytecode and nothing to reflect
+		if (rOptions.pMacros != nullptr && rOptions.pMacros->size() > 0)
+		{
+			std::copy(std::begin(*rOptions.pMacros),
+					  std::end(*rOptions.pMacros),
+					  std::back_inserter(m_arrMacros));
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShader_Platform::Create(const IOEShaderCompilationOptions &rOptions,
+									const IOEShaderBinary &rBinary)
+	{
+		Cleanup();
+		m_rShader.SetVertexFormat(rOptions.pVertexFormat);
+
+		IOERPI::GetSingletonPtr()->GetPlatform().GetCommandStream().Record(
+			ERPICommand::CreateShader, this,
+			static_cast<std::uint64_t>(rOptions.eShaderType));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShader_Platform::Cleanup()
+	{
+		for (auto &rarrBuffer : m_arrConstantBuffers)
+		{
+			rarrBuffer.clear();
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void *IOEShader_Platform::MapConstantBuffers(
+		IOERPI *pRPI, std::int32_t nSlotIdx,
+		ShaderConstantBufferDescription *pBuffer)
+	{
+		std::vector<std::uint8_t> &rarrBuffer(
+			m_arrConstantBuffers[pBuffer->nSlotIdx]);
+		rarrBuffer.resize(pBuffer->nSizeBytes);
+		return rarrBuffer.data() + nSlotIdx;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShader_Platform::UnmapConstantBuffers(
+		IOERPI *pRPI, std::int32_t nSlotIdx,
+		ShaderConstantBufferDescription *pBuffer)
+	{
+		// Counts only the bytes written since the last upload, as a device
+		// able to update part of a buffer would send
+		const std::size_t uSizeBytes(
+			pBuffer->IsDirty() ? pBuffer->uDirtyEnd - pBuffer->uDirtyBegin
+							   : pBuffer->nSizeBytes);
+
+		IOERPICommandStream &rStream(pRPI->GetPlatform().GetCommandStream());
+		rStream.Record(ERPICommand::Upload,
+					   m_arrConstantBuffers[pBuffer->nSlotIdx].data(),
+					   uSizeBytes);
+		rStream.Record(ERPICommand::SetConstantBuffers,
+					   m_arrConstantBuffers[pBuffer->nSlotIdx].data(), 0,
+					   static_cast<std::uint32_t>(pBuffer->nSlotIdx) +
+						   static_cast<std::uint32_t>(
+							   m_rShader.GetShaderType()) *
+							   ShaderConstantBufferDescription::
+								   ms_nMaxCBufferSlots);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShader_Platform::BindConstantBuffer(IOERPI *pRPI,
+												std::uint32_t uSlotIdx)
+	{
+		IOERPI_Platform &rPlatform(pRPI->GetPlatform());
+		std::uint32_t uOffset(0);
+		std::uint32_t uSizeBytes(0);
+		const void *pResource(m_arrConstantBuffers[uSlotIdx].data());
+		if (m_rShader.GetCBufferUpload(uSlotIdx, uOffset, uSizeBytes))
+		{
+			pResource = rPlatform.GetUploadRingData(EUploadRing::Constant);
+		}
+
+		rPlatform.GetCommandStream().Record(
+			ERPICommand::SetConstantBuffers, pResource, uOffset,
+			uSlotIdx + static_cast<std::uint32_t>(m_rShader.GetShaderType()) *
+						   ShaderConstantBufferDescription::
+							   ms_nMaxCBufferSlots);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t IOEShader_Platform::GetVariableSlot(const char *szName) const
+	{
+		// FNV-1a of the name, mixed with the stage so each stage's binding
+		// of a name is its own slot
+		std::uint32_t uHash(2166136261u);
+		for (const char *pChar(szName); *pChar != '\0'; ++pChar)
+		{
+			uHash ^= static_cast<std::uint8_t>(*pChar);
+			uHash *= 16777619u;
+		}
+		uHash ^= static_cast<std::uint32_t>(m_rShader.GetShaderType());
+		uHash *= 16777619u;
+		return uHash;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEShader_Platform::SetTextureVariable(IOERPI *pRPI,
+												const char *szTextureName,
+												IOETexture *pTexture,
+												int arrOffset /*=0*/)
+	{
+		pRPI->GetPlatform().GetCommandStream().Record(
+			ERPICommand::SetTexture,
+			pTexture != nullptr ? pTexture->GetPlatform().GetResource()
+								: nullptr,
+			static_cast<std::uint64_t>(arrOffset),
+			GetVariableSlot(szTextureName));
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEShader_Platform::SetSamplerVariable(IOERPI *pRPI,
+												const char *szSamplerName,
+												IOESamplerState *pSamplers)
+	{
+		pRPI->GetPlatform().GetCommandStream().Record(
+			ERPICommand::SetSampler, pSamplers, 0,
+			GetVariableSlot(szSamplerName));
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOEShader_Platform::SetSamplers(
+		IOERPI *pRPI,
+		const vector<pair<string, IOESamplerState *> > &arrSamplers)
+	{
+		for (const auto &rSampler : arrSamplers)
+		{
+			SetSamplerVariable(pRPI, rSampler.first.c_str(), rSampler.second);
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShader_Platform::Set(IOERPI *pRPI)
+	{
+		pRPI->GetPlatform().GetCommandStream().Record(
+			ERPICommand::SetShader, this, 0,
+			static_cast<std::uint32_t>(m_rShader.GetShaderType()));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOEShader_Platform::Dispatch(IOERPI *pRPI, int32_t nNumThreadGroupsX,
+									  int32_t nNumThreadGroupsY,
+									  int32_t nNumThreadGroupsZ)
+	{
+		pRPI->GetPlatform().GetCommandStream().Record(
+			ERPICommand::Dispatch, this,
+			static_cast<std::uint64_t>(nNumThreadGroupsX) *
+				static_cast<std::uint64_t>(nNumThreadGroupsY) *
+				static_cast<std::uint64_t>(nNumThreadGroupsZ));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
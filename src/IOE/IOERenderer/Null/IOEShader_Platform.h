@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <IOE/IOERenderer/IOEModel.h>
+#include <IOE/IOERenderer/IOEShader_PlatformBase.h>
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class IOERPI;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Compiles nothing, so binaries are empty and the material sees a
+	// shader with no constant buffers. Resources are still bound by name,
+	// each name acting as its own slot in the command stream.
+	class IOEShader_Platform : public IOEShader_PlatformBase
+	{
+	public:
+		IOEShader_Platform(IOEShader &rShader);
+
+	public:
+		virtual std::string GetCompilerSignature() const override final;
+		virtual void
+		CompileShader(const IOEShaderCompilationOptions &rOptions,
+					  IOEShaderBinary &rBinary) override final;
+
+		virtual void Create(const IOEShaderCompilationOptions &rOptions,
+							const IOEShaderBinary &rBinary) override final;
+		virtual void Cleanup() override final;
+
+		virtual void Set(IOERPI *pRPI) override final;
+
+		virtual void *MapConstantBuffers(
+			IOERPI *pRPI, std::int32_t nSlotIdx,
+			ShaderConstantBufferDescription *pBuffer) override final;
+		virtual void UnmapConstantBuffers(
+			IOERPI *pRPI, std::int32_t nSlotIdx,
+			ShaderConstantBufferDescription *pBuffer) override final;
+		virtual void BindConstantBuffer(IOERPI *pRPI,
+										std::uint32_t uSlotIdx) override final;
+
+		virtual bool SetTextureVariable(IOERPI *pRPI,
+										const char *szTextureName,
+										IOETexture *pTexture,
+										int arrOffset = 0) override final;
+		virtual bool SetSamplerVariable(
+			IOERPI *pRPI, const char *szSamplerName,
+			struct IOESamplerState *pSamplers) override final;
+		virtual bool SetSamplers(
+			IOERPI *pRPI,
+			const vector<pair<string, struct IOESamplerState*> >
+				&arrSamplers) override final;
+
+		virtual void Dispatch(IOERPI *pRPI, int32_t nNumThreadGroupsX,
+							  int32_t nNumThreadGroupsY,
+							  int32_t nNumThreadGroupsZ) override final;
+
+	private:
+		std::uint32_t GetVariableSlot(const char *szName) const;
+
+	private:
+		// Stands in for each dynamic constant buffer while it is mapped
+		std::array<std::vector<std::uint8_t>,
+				   ShaderConstantBufferDescription::ms_nMaxCBufferSlots>
+			m_arrConstantBuffers;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
@@ -0,0 +1,255 @@
+#include <cstring>
+
+#include "IOETexture_Platform.h"
+#include "../IOERPI.h"
+#include "../IOETexture.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	namespace
+	{
+		std::size_t GetDimension(float fDimension)
+		{
+			return fDimension >= 1.0f ? static_cast<std::size_t>(fDimension)
+									  : 1;
+		}
+
+		std::size_t GetDimension(std::int32_t nDimension)
+		{
+			return nDimension >= 1 ? static_cast<std::size_t>(nDimension) : 1;
+		}
+
+		IOERPICommandStream &GetCommandStream()
+		{
+			return IOERPI::GetSingletonPtr()->GetPlatform().GetCommandStream();
+		}
+	} // namespace
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t GetFormatSizeBytes(ETextureFormat eFormat)
+	{
+		switch (eFormat)
+		{
+		case ETextureFormat::R32G32B32A32_TYPELESS:
+		case ETextureFormat::R32G32B32A32_FLOAT:
+		case ETextureFormat::R32G32B32A32_UINT:
+		case ETextureFormat::R32G32B32A32_SINT:
+			return 16;
+		case ETextureFormat::R32G32B32_TYPELESS:
+		case ETextureFormat::R32G32B32_FLOAT:
+		case ETextureFormat::R32G32B32_UINT:
+		case ETextureFormat::R32G32B32_SINT:
+			return 12;
+		case ETextureFormat::R16G16B16A16_TYPELESS:
+		case ETextureFormat::R16G16B16A16_FLOAT:
+		case ETextureFormat::R16G16B16A16_UNORM:
+		case ETextureFormat::R16G16B16A16_UINT:
+		case ETextureFormat::R16G16B16A16_SNORM:
+		case ETextureFormat::R16G16B16A16_SINT:
+		case ETextureFormat::R32G32_TYPELESS:
+		case ETextureFormat::R32G32_FLOAT:
+		case ETextureFormat::R32G32_UINT:
+		case ETextureFormat::R32G32_SINT:
+		case ETextureFormat::R32G8X24_TYPELESS:
+		case ETextureFormat::D32_FLOAT_S8X24_UINT:
+		case ETextureFormat::R32_FLOAT_X8X24_TYPELESS:
+		case ETextureFormat::X32_TYPELESS_G8X24_UINT:
+			return 8;
+		case ETextureFormat::R10G10B10A2_TYPELESS:
+		case ETextureFormat::R10G10B10A2_UNORM:
+		case ETextureFormat::R10G10B10A2_UINT:
+		case ETextureFormat::R11G11B10_FLOAT:
+		case ETextureFormat::R8G8B8A8_TYPELESS:
+		case ETextureFormat::R8G8B8A8_UNORM:
+		case ETextureFormat::R8G8B8A8_UNORM_SRGB:
+		case ETextureFormat::R8G8B8A8_UINT:
+		case ETextureFormat::R8G8B8A8_SNORM:
+		case ETextureFormat::R8G8B8A8_SINT:
+		case ETextureFormat::R16G16_TYPELESS:
+		case ETextureFormat::R16G16_FLOAT:
+		case ETextureFormat::R16G16_UNORM:
+		case ETextureFormat::R16G16_UINT:
+		case ETextureFormat::R16G16_SNORM:
+		case ETextureFormat::R16G16_SINT:
+		case ETextureFormat::R32_TYPELESS:
+		case ETextureFormat::D32_FLOAT:
+		case ETextureFormat::R32_FLOAT:
+		case ETextureFormat::R32_UINT:
+		case ETextureFormat::R32_SINT:
+		case ETextureFormat::R24G8_TYPELESS:
+		case ETextureFormat::D24_UNORM_S8_UINT:
+		case ETextureFormat::R24_UNORM_X8_TYPELESS:
+		case ETextureFormat::X24_TYPELESS_G8_UINT:
+		case ETextureFormat::B8G8R8A8_UNORM:
+			return 4;
+		case ETextureFormat::R8G8_TYPELESS:
+		case ETextureFormat::R8G8_UNORM:
+		case ETextureFormat::R8G8_UINT:
+		case ETextureFormat::R8G8_SNORM:
+		case ETextureFormat::R8G8_SINT:
+		case ETextureFormat::R16_TYPELESS:
+		case ETextureFormat::R16_FLOAT:
+		case ETextureFormat::D16_UNORM:
+		case ETextureFormat::R16_UNORM:
+		case ETextureFormat::R16_UINT:
+		case ETextureFormat::R16_SNORM:
+		case ETextureFormat::R16_SINT:
+			return 2;
+		case ETextureFormat::R8_TYPELESS:
+		case ETextureFormat::R8_UNORM:
+		case ETextureFormat::R8_UINT:
+		case ETextureFormat::R8_SNORM:
+		case ETextureFormat::R8_SINT:
+		case ETextureFormat::A8_UNORM:
+		// Rounded up to a whole byte per pixel
+		case ETextureFormat::R1_UNORM:
+			return 1;
+		case ETextureFormat::Unknown:
+		default:
+			return 0;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOETexture_Platform::IOETexture_Platform(IOETexture &rTexture)
+		: IOETexture_PlatformBase(rTexture)
+		, m_bMappedForWrite(false)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOETexture_Platform::~IOETexture_Platform()
+	{
+		Cleanup();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::size_t IOETexture_Platform::CalculateSizeBytes(
+		const IOETextureSource *pSource /*=nullptr*/) const
+	{
+		const IOETexture &rTexture(GetTexture());
+		if (rTexture.GetTextureType() == ETextureType::GenericBuffer)
+		{
+			// Width is the element stride, or the byte width of raw buffers
+			return static_cast<std::size_t>(rTexture.GetWidth()) *
+				GetDimension(rTexture.GetArrayLength());
+		}
+
+		const std::size_t uPixelSize(
+			pSource != nullptr
+				? pSource->uPixelSizeBytes
+				: GetFormatSizeBytes(rTexture.GetTextureFormat()));
+
+		std::size_t uNumFaces(1);
+		if (rTexture.GetTextureType() == ETextureType::TextureCube ||
+			rTexture.GetTextureType() == ETextureType::TextureCubeArray)
+		{
+			uNumFaces = static_cast<std::size_t>(ECubeFace::NumFaces);
+		}
+
+		return GetDimension(rTexture.GetWidth()) *
+			GetDimension(rTexture.GetHeight()) *
+			GetDimension(rTexture.GetDepth()) *
+			GetDimension(rTexture.GetArrayLength()) * uNumFaces * uPixelSize;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOETexture_Platform::Setup(IOETextureSource *pSource /*=nullptr*/)
+	{
+		Cleanup();
+
+		const std::size_t uSizeBytes(CalculateSizeBytes(pSource));
+		m_pData = std::make_shared<std::vector<std::uint8_t> >(uSizeBytes);
+		if (pSource != nullptr && pSource->pSrc != nullptr)
+		{
+			std::memcpy(m_pData->data(), pSource->pSrc, uSizeBytes);
+		}
+
+		GetCommandStream().Record(ERPICommand::CreateTexture, GetResource(),
+								  uSizeBytes);
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOETexture_Platform::Cleanup()
+	{
+		m_pData.reset();
+		m_bMappedForWrite = false;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOETexture_Platform::MapBuffer(EBufferMapType eMapType, void *&rpData,
+										std::uint32_t uSubresourceID /*=0*/)
+	{
+		if (m_pData == nullptr)
+		{
+			return false;
+		}
+		rpData			  = m_pData->data();
+		m_bMappedForWrite = eMapType != EBufferMapType::ReadOnly;
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool IOETexture_Platform::UnmapBuffer(std::uint32_t uSubresourceID /*=0*/)
+	{
+		// How much of a mapping was written is unknown, so the whole
+		// resource is counted as a discard upload would send it
+		if (m_bMappedForWrite)
+		{
+			GetCommandStream().Record(ERPICommand::Upload, GetResource(),
+									  GetSizeBytes());
+			m_bMappedForWrite = false;
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOETexture_Platform::OnResize()
+	{
+		Setup();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOETexture_Platform::LoadFromMemory(
+		std::uint8_t *pMemoryAddress, std::uint32_t uWidth,
+		std::uint32_t uHeight, std::uint32_t uPixelByteWidth /*=4*/)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOETexture_Platform::CopyTexture(IOETexture &rhs)
+	{
+		IOE_ASSERT(rhs.GetPlatform().m_pData != nullptr,
+				   "Texture not yet set up!");
+		m_pData = rhs.GetPlatform().m_pData;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void IOETexture_Platform::SetDebugName(const std::string &szName)
+	{
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
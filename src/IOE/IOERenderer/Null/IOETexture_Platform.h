@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../IOETexture_PlatformBase.h"
+#include "IOEComSharedPtr.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class IOETexture;
+	enum class EBufferMapType;
+	enum class ETextureFormat;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	extern std::uint32_t GetFormatSizeBytes(ETextureFormat eFormat);
+
+	// Keeps the top mip of the texture in system memory, so mapping it
+	// behaves as on a device. Copies share the memory as they would share
+	// the D3D resource, and its address identifies the resource in the
+	// command stream.
+	class IOETexture_Platform : public IOETexture_PlatformBase
+	{
+	public:
+		IOETexture_Platform(IOETexture &rTexture);
+		~IOETexture_Platform();
+
+	public:
+		virtual bool Setup(IOETextureSource *pSource = nullptr) override final;
+		virtual void Cleanup() override final;
+
+	public:
+		virtual bool
+		MapBuffer(EBufferMapType eMapType, void *&rpData,
+				  std::uint32_t uSubresourceID = 0) override final;
+		virtual bool
+		UnmapBuffer(std::uint32_t uSubresourceID = 0) override final;
+
+		virtual void OnResize() override final;
+
+		virtual void
+		LoadFromMemory(std::uint8_t *pMemoryAddress, std::uint32_t uWidth,
+					   std::uint32_t uHeight,
+					   std::uint32_t uPixelByteWidth = 4) override final;
+		virtual void CopyTexture(IOETexture &rhs) override final;
+
+		virtual void SetDebugName(const std::string &szName) override final;
+
+	public:
+		FORCEINLINE const void *GetResource() const
+		{
+			return m_pData.get();
+		}
+
+		FORCEINLINE std::size_t GetSizeBytes() const
+		{
+			return m_pData != nullptr ? m_pData->size() : 0;
+		}
+
+	private:
+		std::size_t CalculateSizeBytes(
+			const IOETextureSource *pSource = nullptr) const;
+
+	private:
+		std::shared_ptr<std::vector<std::uint8_t> > m_pData;
+		bool m_bMappedForWrite;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
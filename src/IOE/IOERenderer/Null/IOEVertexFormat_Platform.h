@@ -0,0 +1,33 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include "../IOEVertexFormat_PlatformBase.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class IOEVertexFormat;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Input layouts only exist on a device, so nothing is kept here
+	class IOEVertexFormat_Platform : public IOEVertexFormat_PlatformBase
+	{
+	public:
+		IOEVertexFormat_Platform(IOEVertexFormat &rFormat)
+			: IOEVertexFormat_PlatformBase(rFormat)
+		{
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
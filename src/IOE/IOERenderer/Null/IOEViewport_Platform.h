@@ -0,0 +1,27 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////
+
+#include <IOE/IOERenderer/IOEViewport_PlatformBase.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace IOE
+{
+namespace Renderer
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class IOEViewport_Platform : public IOEViewport_PlatformBase
+	{
+	public:
+		virtual void Init(float fWidth, float fHeight) override final
+		{
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace Renderer
+} // namespace IOE
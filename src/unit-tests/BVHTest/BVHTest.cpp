@@ -0,0 +1,544 @@
+// Checks the culling in IOEMaths/BVH.h against a brute force test of every
+// item, across builds, refits, rebuilds, subtree splits and multi view
+// culls, on scenes from empty up to several thousand items.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <IOE/IOEMaths/BVH.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Maths;
+
+	const std::uint32_t g_uNumTrials = 40;
+	const std::uint32_t g_uNumViews	 = 8;
+
+	// Node and item tests sum in different orders, so an item this close to
+	// a plane may land on either side of it
+	const float g_fPlaneEpsilon = 1e-3f;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	struct Matrix
+	{
+		float arrValues[16];
+	};
+
+	Matrix Multiply(const Matrix &rA, const Matrix &rB)
+	{
+		Matrix tResult;
+		for (std::uint32_t uRow(0); uRow < 4; ++uRow)
+		{
+			for (std::uint32_t uCol(0); uCol < 4; ++uCol)
+			{
+				float fSum(0.0f);
+				for (std::uint32_t uIdx(0); uIdx < 4; ++uIdx)
+				{
+					fSum += rA.arrValues[uRow * 4 + uIdx] *
+						rB.arrValues[uIdx * 4 + uCol];
+				}
+				tResult.arrValues[uRow * 4 + uCol] = fSum;
+			}
+		}
+		return tResult;
+	}
+
+	// Left handed perspective with a [0, 1] depth range, row-vector
+	// convention as IOEMatrix
+	Matrix Perspective(float fFovY, float fAspect, float fNear, float fFar)
+	{
+		const float fScaleY(1.0f / std::tan(fFovY * 0.5f));
+		const float fRange(fFar / (fFar - fNear));
+		const Matrix tResult = {{fScaleY / fAspect, 0, 0, 0, 0, fScaleY, 0, 0,
+								 0, 0, fRange, 1, 0, 0, -fRange * fNear, 0}};
+		return tResult;
+	}
+
+	// Inverse of a camera at the position looking along yaw and pitch
+	Matrix View(float fYaw, float fPitch, float fX, float fY, float fZ)
+	{
+		const float fCY(std::cos(fYaw)), fSY(std::sin(fYaw));
+		const float fCP(std::cos(fPitch)), fSP(std::sin(fPitch));
+
+		const float arrRight[3]	  = {fCY, 0.0f, -fSY};
+		const float arrUp[3]	  = {fSY * fSP, fCP, fCY * fSP};
+		const float arrForward[3] = {fSY * fCP, -fSP, fCY * fCP};
+		const float arrPos[3]	  = {fX, fY, fZ};
+
+		auto Dot = [](const float *pA, const float *pB) {
+			return pA[0] * pB[0] + pA[1] * pB[1] + pA[2] * pB[2];
+		};
+
+		const Matrix tResult = {
+			{arrRight[0], arrUp[0], arrForward[0], 0, arrRight[1], arrUp[1],
+			 arrForward[1], 0, arrRight[2], arrUp[2], arrForward[2], 0,
+			 -Dot(arrRight, arrPos), -Dot(arrUp, arrPos),
+			 -Dot(arrForward, arrPos), 1}};
+		return tResult;
+	}
+
+	IOEFrustumPlanes RandomPlanes(std::mt19937 &rRandom)
+	{
+		std::uniform_real_distribution<float> tAngle(-3.14159f, 3.14159f);
+		std::uniform_real_distribution<float> tPosition(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> tFov(0.5f, 2.0f);
+		std::uniform_real_distribution<float> tFar(50.0f, 400.0f);
+
+		const float fYaw(tAngle(rRandom));
+		const float fPitch(tAngle(rRandom) * 0.45f);
+		const float fX(tPosition(rRandom));
+		const float fY(tPosition(rRandom) * 0.25f);
+		const float fZ(tPosition(rRandom));
+		const float fFov(tFov(rRandom));
+		const float fFar(tFar(rRandom));
+
+		IOEFrustumPlanes tPlanes;
+		tPlanes.SetFromViewProjection(
+			Multiply(View(fYaw, fPitch, fX, fY, fZ),
+					 Perspective(fFov, 16.0f / 9.0f, 0.5f, fFar))
+				.arrValues);
+		return tPlanes;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	struct Boxes
+	{
+		explicit Boxes(std::uint32_t uCount)
+			: arrCentreX(uCount)
+			, arrCentreY(uCount)
+			, arrCentreZ(uCount)
+			, arrExtentX(uCount)
+			, arrExtentY(uCount)
+			, arrExtentZ(uCount)
+		{
+			tView.pCentreX = arrCentreX.data();
+			tView.pCentreY = arrCentreY.data();
+			tView.pCentreZ = arrCentreZ.data();
+			tView.pExtentX = arrExtentX.data();
+			tView.pExtentY = arrExtentY.data();
+			tView.pExtentZ = arrExtentZ.data();
+			tView.uCount   = uCount;
+		}
+
+		// Quarter units keep the min/max and centre/extent round trips in
+		// the BVH exact, so GetBounds can be compared bit for bit
+		static float Quantise(float fValue)
+		{
+			return std::floor(fValue * 4.0f) * 0.25f;
+		}
+
+		void Randomise(std::uint32_t uItem, std::mt19937 &rRandom,
+					   const float *pClusterCentre)
+		{
+			std::normal_distribution<float> tOffset(0.0f, 20.0f);
+			std::uniform_real_distribution<float> tExtent(0.25f, 6.0f);
+			arrCentreX[uItem] = Quantise(pClusterCentre[0] + tOffset(rRandom));
+			arrCentreY[uItem] = Quantise(pClusterCentre[1] + tOffset(rRandom));
+			arrCentreZ[uItem] = Quantise(pClusterCentre[2] + tOffset(rRandom));
+			arrExtentX[uItem] = Quantise(tExtent(rRandom));
+			arrExtentY[uItem] = Quantise(tExtent(rRandom));
+			arrExtentZ[uItem] = Quantise(tExtent(rRandom));
+		}
+
+		void GetBox(std::uint32_t uItem, float *pCentre, float *pExtent) const
+		{
+			pCentre[0] = arrCentreX[uItem];
+			pCentre[1] = arrCentreY[uItem];
+			pCentre[2] = arrCentreZ[uItem];
+			pExtent[0] = arrExtentX[uItem];
+			pExtent[1] = arrExtentY[uItem];
+			pExtent[2] = arrExtentZ[uItem];
+		}
+
+		std::vector<float> arrCentreX, arrCentreY, arrCentreZ;
+		std::vector<float> arrExtentX, arrExtentY, arrExtentZ;
+		IOEAABBArray tView;
+	};
+
+	// Items gathered in a few clusters spread over the scene, so the tree
+	// has both dense and empty regions to split
+	Boxes RandomScene(std::mt19937 &rRandom, std::uint32_t uCount)
+	{
+		std::uniform_real_distribution<float> tCluster(-250.0f, 250.0f);
+		float arrClusters[8][3];
+		for (float(&rCluster)[3] : arrClusters)
+		{
+			rCluster[0] = tCluster(rRandom);
+			rCluster[1] = tCluster(rRandom) * 0.25f;
+			rCluster[2] = tCluster(rRandom);
+		}
+
+		Boxes tBoxes(uCount);
+		for (std::uint32_t uItem(0); uItem < uCount; ++uItem)
+		{
+			tBoxes.Randomise(uItem, rRandom, arrClusters[rRandom() % 8]);
+		}
+		return tBoxes;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Whether the box is fully outside one of the planes in uPlaneMask once
+	// every plane is pushed outwards by fSlack
+	bool IsOutside(const IOEFrustumPlanes &rPlanes, const float *pCentre,
+				   const float *pExtent, std::uint32_t uPlaneMask,
+				   float fSlack)
+	{
+		for (std::uint32_t uPlane(0); uPlane < EFrustumPlane::NumPlanes;
+			 ++uPlane)
+		{
+			if ((uPlaneMask & (1u << uPlane)) == 0)
+			{
+				continue;
+			}
+
+			const float fDist(rPlanes.arrNormalX[uPlane] * pCentre[0] +
+							  rPlanes.arrNormalY[uPlane] * pCentre[1] +
+							  rPlanes.arrNormalZ[uPlane] * pCentre[2] +
+							  rPlanes.arrDistance[uPlane]);
+			const float fRadius(
+				std::fabs(rPlanes.arrNormalX[uPlane]) * pExtent[0] +
+				std::fabs(rPlanes.arrNormalY[uPlane]) * pExtent[1] +
+				std::fabs(rPlanes.arrNormalZ[uPlane]) * pExtent[2]);
+			if (fDist + fSlack < -fRadius)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Every item clearly visible is reported once, and nothing clearly
+	// outside is reported at all
+	bool CheckVisible(const char *szTest, const Boxes &rBoxes,
+					  const IOEFrustumPlanes &rPlanes,
+					  std::uint32_t uPlaneMask,
+					  const std::vector<std::uint32_t> &rVisible)
+	{
+		const std::uint32_t uCount(rBoxes.tView.uCount);
+		std::vector<std::uint8_t> arrReported(uCount, 0);
+		for (std::uint32_t uItem : rVisible)
+		{
+			if (uItem >= uCount || arrReported[uItem] != 0)
+			{
+				std::printf("%s: item %u reported twice or out of range\n",
+							szTest, uItem);
+				return false;
+			}
+			arrReported[uItem] = 1;
+		}
+
+		for (std::uint32_t uItem(0); uItem < uCount; ++uItem)
+		{
+			float arrCentre[3], arrExtent[3];
+			rBoxes.GetBox(uItem, arrCentre, arrExtent);
+
+			const bool bSurelyVisible(!IsOutside(rPlanes, arrCentre, arrExtent,
+												 uPlaneMask,
+												 -g_fPlaneEpsilon));
+			const bool bPossiblyVisible(!IsOutside(
+				rPlanes, arrCentre, arrExtent, uPlaneMask, g_fPlaneEpsilon));
+			const bool bReported(arrReported[uItem] != 0);
+			if ((bSurelyVisible && !bReported) ||
+				(bReported && !bPossiblyVisible))
+			{
+				std::printf("%s: item %u %s\n", szTest, uItem,
+							bReported ? "reported but outside"
+									  : "visible but not reported");
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool CheckCull(const char *szTest, const IOEBVH &rBVH,
+				   const Boxes &rBoxes, std::mt19937 &rRandom)
+	{
+		for (std::uint32_t uView(0); uView < g_uNumViews; ++uView)
+		{
+			const IOEFrustumPlanes tPlanes(RandomPlanes(rRandom));
+
+			// Half the views cull against a subset of the planes
+			const std::uint32_t uPlaneMask(
+				uView % 2 == 0 ? IOEFrustumPlanes::ms_uAllPlanesMask
+							   : (rRandom() & 0x3f));
+
+			std::vector<std::uint32_t> arrVisible;
+			IOEBVHCullStats tStats;
+			rBVH.Cull(tPlanes, uPlaneMask, arrVisible, &tStats);
+			if (!CheckVisible(szTest, rBoxes, tPlanes, uPlaneMask,
+							  arrVisible))
+			{
+				return false;
+			}
+			if (tStats.uItemsVisible != arrVisible.size() ||
+				tStats.uNodesVisited > rBVH.GetNumNodes())
+			{
+				std::printf("%s: stats disagree, %u visible of %u, %u nodes "
+							"visited of %u\n",
+							szTest, tStats.uItemsVisible,
+							static_cast<std::uint32_t>(arrVisible.size()),
+							tStats.uNodesVisited, rBVH.GetNumNodes());
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestBuild(std::mt19937 &rRandom, std::uint32_t uCount)
+	{
+		Boxes tBoxes(RandomScene(rRandom, uCount));
+		IOEBVH tBVH;
+		tBVH.Build(tBoxes.tView);
+
+		// A binary tree with at most ms_uMaxLeafSize items per leaf
+		const std::uint32_t uMaxNodes(uCount == 0 ? 0 : 2 * uCount - 1);
+		if (tBVH.GetNumItems() != uCount || tBVH.GetNumNodes() > uMaxNodes ||
+			(uCount != 0 && tBVH.GetNumNodes() == 0))
+		{
+			std::printf("Build: %u items gave %u items in %u nodes\n", uCount,
+						tBVH.GetNumItems(), tBVH.GetNumNodes());
+			return false;
+		}
+
+		for (std::uint32_t uItem(0); uItem < uCount; ++uItem)
+		{
+			float arrCentre[3], arrExtent[3], arrExpCentre[3], arrExpExtent[3];
+			tBVH.GetBounds(uItem, arrCentre, arrExtent);
+			tBoxes.GetBox(uItem, arrExpCentre, arrExpExtent);
+			if (!std::equal(arrCentre, arrCentre + 3, arrExpCentre) ||
+				!std::equal(arrExtent, arrExtent + 3, arrExpExtent))
+			{
+				std::printf("Build: bounds of item %u changed\n", uItem);
+				return false;
+			}
+		}
+
+		return CheckCull("Build", tBVH, tBoxes, rRandom);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestUpdate(std::mt19937 &rRandom, std::uint32_t uCount)
+	{
+		Boxes tBoxes(RandomScene(rRandom, uCount));
+		IOEBVH tBVH;
+		tBVH.Build(tBoxes.tView);
+
+		if (tBVH.Update())
+		{
+			std::printf("Update: rebuilt with nothing moved\n");
+			return false;
+		}
+
+		// Small moves are refit without a rebuild when the ratio allows
+		// any amount of degradation
+		for (std::uint32_t uMove(0); uMove < uCount / 10 + 1; ++uMove)
+		{
+			const std::uint32_t uItem(rRandom() % uCount);
+			float arrCentre[3], arrExtent[3];
+			tBoxes.GetBox(uItem, arrCentre, arrExtent);
+			tBoxes.Randomise(uItem, rRandom, arrCentre);
+
+			tBoxes.GetBox(uItem, arrCentre, arrExtent);
+			tBVH.SetBounds(uItem, arrCentre, arrExtent);
+		}
+		if (tBVH.Update(1e30f))
+		{
+			std::printf("Update: rebuilt despite an unbounded ratio\n");
+			return false;
+		}
+		if (!CheckCull("Refit", tBVH, tBoxes, rRandom))
+		{
+			return false;
+		}
+
+		// Scattering every item across the scene degrades the tree well
+		// past its built cost, and a rebuild restores it
+		Boxes tScattered(RandomScene(rRandom, uCount));
+		for (std::uint32_t uItem(0); uItem < uCount; ++uItem)
+		{
+			float arrCentre[3], arrExtent[3];
+			tScattered.GetBox(uItem, arrCentre, arrExtent);
+			tBVH.SetBounds(uItem, arrCentre, arrExtent);
+		}
+		if (!tBVH.Update(0.0f))
+		{
+			std::printf("Update: no rebuild with a zero ratio\n");
+			return false;
+		}
+		return CheckCull("Rebuild", tBVH, tScattered, rRandom);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestSubtrees(std::mt19937 &rRandom, std::uint32_t uCount)
+	{
+		Boxes tBoxes(RandomScene(rRandom, uCount));
+		IOEBVH tBVH;
+		tBVH.Build(tBoxes.tView);
+
+		const std::uint32_t uMinCount(1 + rRandom() % 16);
+		std::vector<std::uint32_t> arrRoots;
+		tBVH.GetSubtrees(uMinCount, arrRoots);
+
+		// Enough leaves exist to split this far
+		const std::uint32_t uLeaves(uCount / IOEBVH::ms_uMaxLeafSize);
+		if (uLeaves >= uMinCount * 2 && arrRoots.size() < uMinCount)
+		{
+			std::printf("Subtrees: %u of %u asked for\n",
+						static_cast<std::uint32_t>(arrRoots.size()),
+						uMinCount);
+			return false;
+		}
+
+		// With no planes every subtree is accepted whole, so the roots
+		// must cover each item exactly once
+		std::vector<std::uint32_t> arrAll;
+		for (std::uint32_t uRoot : arrRoots)
+		{
+			tBVH.CullSubtree(uRoot, IOEFrustumPlanes(), 0, arrAll);
+		}
+		std::sort(arrAll.begin(), arrAll.end());
+		for (std::uint32_t uIdx(0); uIdx < arrAll.size(); ++uIdx)
+		{
+			if (arrAll[uIdx] != uIdx)
+			{
+				std::printf("Subtrees: roots do not partition the items\n");
+				return false;
+			}
+		}
+		if (arrAll.size() != uCount)
+		{
+			std::printf("Subtrees: %u of %u items covered\n",
+						static_cast<std::uint32_t>(arrAll.size()), uCount);
+			return false;
+		}
+
+		// The pieces of a split cull add up to the whole cull
+		const IOEFrustumPlanes tPlanes(RandomPlanes(rRandom));
+		std::vector<std::uint32_t> arrWhole, arrSplit;
+		tBVH.Cull(tPlanes, IOEFrustumPlanes::ms_uAllPlanesMask, arrWhole);
+		for (std::uint32_t uRoot : arrRoots)
+		{
+			tBVH.CullSubtree(uRoot, tPlanes,
+							 IOEFrustumPlanes::ms_uAllPlanesMask, arrSplit);
+		}
+		std::sort(arrWhole.begin(), arrWhole.end());
+		std::sort(arrSplit.begin(), arrSplit.end());
+		if (arrWhole != arrSplit)
+		{
+			std::printf("Subtrees: split cull found %u items, whole %u\n",
+						static_cast<std::uint32_t>(arrSplit.size()),
+						static_cast<std::uint32_t>(arrWhole.size()));
+			return false;
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestCullViews(std::mt19937 &rRandom, std::uint32_t uCount)
+	{
+		Boxes tBoxes(RandomScene(rRandom, uCount));
+		IOEBVH tBVH;
+		tBVH.Build(tBoxes.tView);
+
+		const std::uint32_t uNumViews(1 +
+									  rRandom() % IOEFrustumSet::ms_uMaxViews);
+		std::vector<IOEFrustumPlanes> arrPlanes(uNumViews);
+		IOEFrustumSet tSet;
+		for (IOEFrustumPlanes &rPlanes : arrPlanes)
+		{
+			rPlanes = RandomPlanes(rRandom);
+			tSet.Add(rPlanes);
+		}
+		const std::uint64_t uViewMask(
+			(static_cast<std::uint64_t>(rRandom()) << 32 | rRandom()) &
+			tSet.GetAllViewsMask());
+
+		std::vector<std::uint32_t> arrVisible;
+		std::vector<std::uint64_t> arrViewMasks;
+		tBVH.CullViews(tSet, uViewMask, arrVisible, arrViewMasks);
+		if (arrVisible.size() != arrViewMasks.size())
+		{
+			std::printf("CullViews: %u items but %u view masks\n",
+						static_cast<std::uint32_t>(arrVisible.size()),
+						static_cast<std::uint32_t>(arrViewMasks.size()));
+			return false;
+		}
+
+		// Split back into one visible list per view and check each alone
+		for (std::uint32_t uView(0); uView < uNumViews; ++uView)
+		{
+			const std::uint64_t uBit(static_cast<std::uint64_t>(1) << uView);
+			std::vector<std::uint32_t> arrViewVisible;
+			for (std::size_t uIdx(0); uIdx < arrVisible.size(); ++uIdx)
+			{
+				if ((arrViewMasks[uIdx] & ~uViewMask) != 0)
+				{
+					std::printf("CullViews: item %u in an unrequested view\n",
+								arrVisible[uIdx]);
+					return false;
+				}
+				if ((arrViewMasks[uIdx] & uBit) != 0)
+				{
+					arrViewVisible.push_back(arrVisible[uIdx]);
+				}
+			}
+
+			const std::uint32_t uPlaneMask(
+				(uViewMask & uBit) != 0 ? IOEFrustumPlanes::ms_uAllPlanesMask
+										: 0);
+			if ((uViewMask & uBit) == 0 ? !arrViewVisible.empty()
+										: !CheckVisible("CullViews", tBoxes,
+														arrPlanes[uView],
+														uPlaneMask,
+														arrViewVisible))
+			{
+				std::printf("CullViews: view %u of %u disagrees\n", uView,
+							uNumViews);
+				return false;
+			}
+		}
+		return true;
+	}
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	std::mt19937 tRandom(0xB1A5);
+
+	// Empty, single leaf and just past one leaf, then real scenes
+	const std::uint32_t arrCounts[] = {0, 1, 3, 4, 5, 17, 1000, 5000};
+
+	bool bPassed(true);
+	for (std::uint32_t uCount : arrCounts)
+	{
+		for (std::uint32_t uTrial(0); uTrial < g_uNumTrials && bPassed;
+			 ++uTrial)
+		{
+			bPassed = TestBuild(tRandom, uCount) &&
+				(uCount == 0 || TestUpdate(tRandom, uCount)) &&
+				TestSubtrees(tRandom, uCount) && TestCullViews(tRandom, uCount);
+		}
+		std::printf("%u items: %s\n", uCount, bPassed ? "OK" : "FAILED");
+	}
+
+	std::printf("%s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
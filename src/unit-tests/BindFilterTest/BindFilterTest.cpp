@@ -0,0 +1,222 @@
+// Checks the RPI's bind filter through the Null platform: setting a state
+// that is already bound is dropped, anything in its key that changes gets
+// through, and a resize or a new frame forgets what was bound.
+//
+// Takes the media directory as its first argument, ../../Media otherwise.
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+#include <IOE/IOERenderer/IOERPI.h>
+#include <IOE/IOERenderer/IOETexture.h>
+
+#include "../Common/HeadlessRPI.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Renderer;
+
+	bool Expect(bool bPassed, const char *szCase)
+	{
+		if (!bPassed)
+		{
+			std::printf("%s\n", szCase);
+		}
+		return bPassed;
+	}
+
+	// Counts the commands of one kind that the calls in tFunc record
+	template <typename TFunc>
+	std::uint32_t CountRecorded(IOERPI &rRPI, ERPICommand::Enum eCommand,
+								TFunc tFunc)
+	{
+		IOERPICommandStream &rStream(UnitTests::GetCommandStream(rRPI));
+		rStream.Reset();
+		tFunc();
+		return rStream.GetCount(eCommand);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestRepeated(IOERPI &rRPI)
+	{
+		rRPI.OnPreRender(&rRPI);
+
+		// The frame has bound the RPI's states, so binding them again with
+		// the same arguments never reaches the platform
+		const IOERPIBindStats tBefore(rRPI.GetBindStats());
+		const std::uint32_t uRasterizer(
+			CountRecorded(rRPI, ERPICommand::SetRasterizerState, [&]() {
+				rRPI.SetRasterizerState(rRPI.GetRasterizerState());
+				rRPI.SetRasterizerState(rRPI.GetRasterizerState());
+			}));
+		const std::uint32_t uBlend(
+			CountRecorded(rRPI, ERPICommand::SetBlendState, [&]() {
+				rRPI.SetBlendState(rRPI.GetBlendState());
+				rRPI.SetBlendState(rRPI.GetBlendState());
+			}));
+		const std::uint32_t uDepth(
+			CountRecorded(rRPI, ERPICommand::SetDepthState, [&]() {
+				rRPI.SetDepthState(rRPI.GetDefaultDepthState());
+				rRPI.SetDepthState(rRPI.GetDefaultDepthState());
+			}));
+		const IOERPIBindStats &rAfter(rRPI.GetBindStats());
+
+		bool bPassed(Expect(uRasterizer == 0, "Rasterizer state rebound"));
+		bPassed &= Expect(uBlend == 0, "Blend state rebound");
+		bPassed &= Expect(uDepth == 0, "Depth state rebound");
+		bPassed &= Expect(rAfter.GetNumRequested() ==
+							  tBefore.GetNumRequested() + 6,
+						  "Dropped binds not counted as requested");
+		bPassed &= Expect(rAfter.GetNumForwarded() == tBefore.GetNumForwarded(),
+						  "Dropped binds counted as forwarded");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestChangedKey(IOERPI &rRPI)
+	{
+		const IOEDepthState &rDepth(rRPI.GetDefaultDepthState());
+		const IOEBlendState &rBlend(rRPI.GetBlendState());
+
+		// The stencil reference is the top half of the depth key, so a new
+		// reference is a new bind even though the state is the same
+		bool bPassed(Expect(
+			CountRecorded(rRPI, ERPICommand::SetDepthState, [&]() {
+				rRPI.SetDepthState(rDepth, 1);
+				rRPI.SetDepthState(rDepth, 1);
+				rRPI.SetDepthState(rDepth, 2);
+				rRPI.SetDepthState(rDepth, 0);
+			}) == 3,
+			"Stencil reference changes"));
+
+		// As are the write mask and blend factor of a blend state
+		bPassed &= Expect(
+			CountRecorded(rRPI, ERPICommand::SetBlendState, [&]() {
+				rRPI.SetBlendState(rBlend, 0x0000FFFF);
+				rRPI.SetBlendState(rBlend, 0x0000FFFF);
+				rRPI.SetBlendState(rBlend, 0x0000FFFF,
+								   IOE::Maths::g_vZeroVector);
+				rRPI.SetBlendState(rBlend);
+			}) == 3,
+			"Blend mask and factor changes");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestUAVGeneration(IOERPI &rRPI)
+	{
+		IOETexture tUAV(ETextureFormat::R32G32B32A32_FLOAT, 64.0f, 64.0f);
+		tUAV.SetBufferDescription(EBufferDescription::ShaderResource |
+								  EBufferDescription::UnorderedAccess);
+		tUAV.Setup();
+
+		IOETexture *const arrUAVs[] = {&tUAV};
+		const IOETextureSpan arrSpan(arrUAVs);
+
+		bool bPassed(Expect(
+			CountRecorded(rRPI, ERPICommand::SetUAVs, [&]() {
+				rRPI.SetUAVs(arrSpan, EUAVSet::ComputeShader);
+				rRPI.SetUAVs(arrSpan, EUAVSet::ComputeShader);
+			}) == 1,
+			"Same UAV set twice"));
+
+		// Recreating the texture leaves its address, but the view bound
+		// before is gone, so the same set must be passed on again
+		bPassed &= Expect(
+			CountRecorded(rRPI, ERPICommand::SetUAVs, [&]() {
+				tUAV.Setup();
+				rRPI.SetUAVs(arrSpan, EUAVSet::ComputeShader);
+				rRPI.SetUAVs(arrSpan, EUAVSet::ComputeShader);
+				tUAV.Resize(128.0f, 128.0f);
+				rRPI.SetUAVs(arrSpan, EUAVSet::ComputeShader);
+			}) == 2,
+			"Recreated UAV not rebound");
+
+		// The output merger set is filtered apart from the compute set
+		bPassed &= Expect(
+			CountRecorded(rRPI, ERPICommand::SetUAVs, [&]() {
+				rRPI.SetUAVs(arrSpan, EUAVSet::OutputMerger);
+				rRPI.SetUAVs(arrSpan, EUAVSet::ComputeShader);
+			}) == 1,
+			"UAV sets share a key");
+
+		rRPI.ResetUAVs();
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestReset(IOERPI &rRPI)
+	{
+		const IOERasterizerState &rRasterizer(rRPI.GetRasterizerState());
+
+		// A resize lets the platform clear the device state, so the next
+		// bind of the same state must get through
+		bool bPassed(Expect(
+			CountRecorded(rRPI, ERPICommand::SetRasterizerState, [&]() {
+				rRPI.SetRasterizerState(rRasterizer);
+				rRPI.Resize(640.0f, 480.0f);
+				rRPI.SetRasterizerState(rRasterizer);
+				rRPI.SetRasterizerState(rRasterizer);
+			}) == 1,
+			"Resize kept the bound rasterizer state"));
+		bPassed &= Expect(
+			CountRecorded(rRPI, ERPICommand::SetDepthState, [&]() {
+				rRPI.SetDepthState(rRPI.GetDefaultDepthState(), 0);
+				rRPI.SetDepthState(rRPI.GetDefaultDepthState(), 0);
+				rRPI.Resize(800.0f, 600.0f);
+				rRPI.SetDepthState(rRPI.GetDefaultDepthState(), 0);
+			}) == 2,
+			"Resize kept the bound depth state");
+
+		rRPI.OnRender(&rRPI);
+		rRPI.OnPostRender(&rRPI);
+
+		// Each frame starts with nothing bound and its own counts, so the
+		// states the last frame left bound are bound again
+		const IOERPIBindStats tFrame(rRPI.GetBindStats());
+		bPassed &= Expect(
+			CountRecorded(rRPI, ERPICommand::SetRasterizerState, [&]() {
+				rRPI.OnPreRender(&rRPI);
+				rRPI.SetRasterizerState(rRasterizer);
+			}) == 1,
+			"Frame kept the bound rasterizer state");
+
+		const IOERPIBindStats &rLast(rRPI.GetLastFrameBindStats());
+		const IOERPIBindStats &rNext(rRPI.GetBindStats());
+		bPassed &= Expect(rLast.GetNumRequested() == tFrame.GetNumRequested(),
+						  "Last frame's stats not kept");
+		bPassed &= Expect(rNext.GetNumRequested() < tFrame.GetNumRequested(),
+						  "Bind stats not reset for the frame");
+		bPassed &= Expect(rNext.arrForwarded[ERPIBind::RasterizerState] == 1,
+						  "Frame's rasterizer binds");
+
+		rRPI.OnRender(&rRPI);
+		rRPI.OnPostRender(&rRPI);
+		return bPassed;
+	}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main(int nArgC, char **arrArgV)
+{
+	std::shared_ptr<IOERPI> pRPI(
+		UnitTests::CreateHeadlessRPI(UnitTests::GetMediaPath(nArgC, arrArgV)));
+
+	bool bPassed(true);
+	bPassed &= TestRepeated(*pRPI);
+	bPassed &= TestChangedKey(*pRPI);
+	bPassed &= TestUAVGeneration(*pRPI);
+	bPassed &= TestReset(*pRPI);
+
+	std::printf("BindFilterTest %s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+// Runs the renderer without a window or a device, for the tests built in the
+// Null configurations. The engine has no application, so the RPI takes the
+// default resolution, and the RPI sits on the Null platform, so everything it
+// would have sent to a device is recorded in the platform's command stream.
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include <IOE/IOECore/IOEEngine.h>
+#include <IOE/IOECore/IOEManagerContainer.h>
+#include <IOE/IOERenderer/IOEFont.h>
+#include <IOE/IOERenderer/IOERPI.h>
+#include <IOE/IOERenderer/IOETexture.h>
+#include <IOE/IOERenderer/IOEVertexFormat.h>
+#include <IOE/IOERenderer/Null/IOERPICommandStream.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace UnitTests
+{
+
+	//////////////////////////////////////////////////////////////////////////
+
+	class HeadlessEngine : public IOE::Core::IOEEngineBase
+	{
+	public:
+		explicit HeadlessEngine(const std::wstring &szMediaPath)
+			: m_szMediaPath(szMediaPath)
+		{
+		}
+
+		virtual std::wstring GetBinPath() const override
+		{
+			return IOE::Core::Algorithm::GetBasePath(m_szMediaPath, false);
+		}
+		virtual std::wstring GetMediaPath() const override
+		{
+			return m_szMediaPath;
+		}
+
+		virtual IOE::Application::IOEApplicationBase *
+		GetApplication() override
+		{
+			return nullptr;
+		}
+		virtual const IOE::Application::IOEApplicationBase *
+		GetApplication() const override
+		{
+			return nullptr;
+		}
+		virtual std::shared_ptr<IOE::Application::IOEApplicationBase>
+		GetApplicationShared() override
+		{
+			return nullptr;
+		}
+		virtual std::shared_ptr<const IOE::Application::IOEApplicationBase>
+		GetApplicationShared() const override
+		{
+			return nullptr;
+		}
+
+	protected:
+		// Nothing runs the engine loop, the tests drive the RPI themselves
+		virtual std::int32_t EnginePreInit() override
+		{
+			return 0;
+		}
+		virtual std::int32_t EngineInit() override
+		{
+			return 0;
+		}
+		virtual std::int32_t EnginePostInit() override
+		{
+			return 0;
+		}
+		virtual std::int32_t EngineLoop() override
+		{
+			return 0;
+		}
+		virtual std::int32_t EnginePreStop() override
+		{
+			return 0;
+		}
+		virtual std::int32_t EngineStop() override
+		{
+			return 0;
+		}
+		virtual std::int32_t EnginePostStop() override
+		{
+			return 0;
+		}
+
+	private:
+		std::wstring m_szMediaPath;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// The first argument names the media directory, which is otherwise
+	// found from bin/unit-tests as the engine would from bin
+	inline std::wstring GetMediaPath(int nArgC, char **arrArgV)
+	{
+		if (nArgC > 1)
+		{
+			const std::string szPath(arrArgV[1]);
+			return std::wstring(szPath.begin(), szPath.end());
+		}
+		return IOE::Core::Algorithm::JoinPath(L"..", L"..", L"Media");
+	}
+
+	// Creates the engine and the renderer's managers, then initialises them
+	// as the engine would, which loads the debug draw material and the text
+	// manager's fonts from the media directory
+	inline std::shared_ptr<IOE::Renderer::IOERPI>
+	CreateHeadlessRPI(const std::wstring &szMediaPath)
+	{
+		using namespace IOE::Renderer;
+
+		IOE::Core::g_pEngine.reset(new HeadlessEngine(szMediaPath));
+
+		std::shared_ptr<IOERPI> pRPI(
+			IOE::Core::g_arrManagers.CreateManager<IOERPI>());
+		IOE::Core::g_arrManagers.CreateManager<IOETextureManager>();
+		IOE::Core::g_arrManagers.CreateManager<IOEVertexFormatContainer>();
+		IOE::Core::g_arrManagers.CreateManager<IOETextManager>();
+
+		IOE::Core::g_arrManagers.OnManagerPreInit();
+		IOE::Core::g_arrManagers.OnManagerInit();
+		IOE::Core::g_arrManagers.OnManagerPostInit();
+		return pRPI;
+	}
+
+	FORCEINLINE IOE::Renderer::IOERPICommandStream &
+	GetCommandStream(IOE::Renderer::IOERPI &rRPI)
+	{
+		return rRPI.GetPlatform().GetCommandStream();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+} // namespace UnitTests
@@ -0,0 +1,231 @@
+// Counts the constant buffer uploads and binds that reach the Null platform
+// when materials are set: the engine constants are only uploaded when the
+// view or world they are built from changes, and a material's own buffers,
+// InstanceSettings among them, only when what is written to them changes.
+//
+// Takes the media directory as its first argument, ../../Media otherwise.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <rapidxml/rapidxml.hpp>
+
+#include <IOE/IOEMaths/Camera.h>
+#include <IOE/IOERenderer/IOEEngineConstants.h>
+#include <IOE/IOERenderer/IOEMaterial.h>
+#include <IOE/IOERenderer/IOERPI.h>
+#include <IOE/IOERenderer/IOEShader.h>
+#include <IOE/IOERenderer/IOEShaderCache.h>
+
+#include "../Common/HeadlessRPI.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Renderer;
+
+	// The Null compiler reflects nothing, so the vertex shader of this
+	// material is given its InstanceSettings through the shader cache
+	const char g_szInstancedMaterial[] =
+		"<material name=\"Instanced\">"
+		"<shader platform=\"Null\" type=\"Vertex\" version=\"vs_5_0\" "
+		"entry=\"InstancedMain\" vertexformat=\"DebugDraw\">"
+		"Shaders\\Debug\\DebugDraw.vs.hlsl</shader>"
+		"</material>";
+
+	bool Expect(bool bPassed, const char *szCase)
+	{
+		if (!bPassed)
+		{
+			std::printf("%s\n", szCase);
+		}
+		return bPassed;
+	}
+
+	bool ExpectCounts(const IOERPICommandStream &rStream,
+					  std::uint32_t uUploads, std::uint32_t uBinds,
+					  const char *szCase)
+	{
+		const std::uint32_t uRecordedUploads(
+			rStream.GetCount(ERPICommand::Upload));
+		const std::uint32_t uRecordedBinds(
+			rStream.GetCount(ERPICommand::SetConstantBuffers));
+		if (uRecordedUploads != uUploads || uRecordedBinds != uBinds)
+		{
+			std::printf("%s: %u uploads and %u binds, expected %u and %u\n",
+						szCase, uRecordedUploads, uRecordedBinds, uUploads,
+						uBinds);
+			return false;
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Keeps the binary the compiler would have reflected InstanceSettings
+	// into under the key the instanced material's vertex shader compiles to
+	void AddReflectedBinary(IOERPI &rRPI)
+	{
+		std::shared_ptr<IOEShaderBinary> pBinary(
+			std::make_shared<IOEShaderBinary>());
+		ShaderConstantBufferDescription &rBuffer(
+			pBinary->arrConstantBuffers[0]);
+		std::strcpy(rBuffer.szName, "InstanceSettings");
+		rBuffer.nSizeBytes = 16;
+		rBuffer.nSlotIdx   = 0;
+
+		const char *arrNames[] = {"FirstInstance", "NumInstances"};
+		for (std::int32_t nIdx(0); nIdx < 2; ++nIdx)
+		{
+			ShaderVariableDescription tVariable;
+			std::strcpy(tVariable.szName, arrNames[nIdx]);
+			tVariable.eType			 = EShaderVariableType::UInt;
+			tVariable.nSlot			 = nIdx * 4;
+			tVariable.nSizeOrSamples = 4;
+			rBuffer.arrVariables.push_back(tVariable);
+		}
+
+		// The definitions ParseMaterial gives every material
+		std::vector<IOEShaderMacroDefinition> arrMacros;
+#if (IOE_SHADER_DEBUG == IOE_ON)
+		arrMacros.emplace_back("IOE_DEBUG", "1");
+#endif
+		IOEShaderCompilationOptions tOptions;
+		tOptions.szPath		  = L"Shaders\\Debug\\DebugDraw.vs.hlsl";
+		tOptions.szProfile	= "vs_5_0";
+		tOptions.szEntryPoint = "InstancedMain";
+		tOptions.eShaderType  = EShaderType::Vertex;
+		tOptions.pMacros	  = &arrMacros;
+
+		// Kept for this run only, so the cache file never holds it
+		IOEShaderCache &rCache(rRPI.GetShaderCache());
+		rCache.Setup(IOE::Core::g_pEngine->GetMediaPath(), L"");
+
+		IOEShader tCompiler;
+		rCache.Add(rCache.CalculateKey(tOptions, tCompiler.GetPlatform()),
+				   pBinary);
+	}
+
+	std::shared_ptr<IOEMaterial> LoadInstancedMaterial(IOERPI &rRPI)
+	{
+		AddReflectedBinary(rRPI);
+
+		std::vector<char> arrXML(std::begin(g_szInstancedMaterial),
+								 std::end(g_szInstancedMaterial));
+		rapidxml::xml_document<char> tDocument;
+		tDocument.parse<0>(arrXML.data());
+
+		std::shared_ptr<IOEMaterial> pMaterial(
+			std::make_shared<IOEMaterial>());
+		pMaterial->LoadMaterial(tDocument.first_node());
+		return pMaterial;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestEngineConstants(IOERPI &rRPI)
+	{
+		IOERPICommandStream &rStream(UnitTests::GetCommandStream(rRPI));
+		IOEEngineConstants &rConstants(rRPI.GetEngineConstants());
+		IOEMaterial *pMaterial(rRPI.GetDebugDrawMaterial());
+
+		rRPI.OnPreRender(&rRPI);
+		const IOE::Maths::IOEMatrix mWorld(
+			IOE::Maths::IOEMatrix::Translation(
+				IOE::Maths::IOEVector(1.0f, 2.0f, 3.0f, 1.0f)));
+		pMaterial->Set(&rRPI, mWorld);
+
+		// Nothing the buffers are built from has changed
+		rStream.Reset();
+		pMaterial->Set(&rRPI, mWorld);
+		pMaterial->Set(&rRPI, mWorld);
+		rConstants.SetView(&rRPI, rRPI.GetCamera(), rRPI.GetViewport(0));
+		rConstants.SetObject(&rRPI, mWorld);
+		bool bPassed(ExpectCounts(rStream, 0, 0, "Unchanged material sets"));
+
+		// A new world only uploads the object buffer, which stays bound
+		rStream.Reset();
+		pMaterial->Set(&rRPI, IOE::Maths::g_mIdentity);
+		bPassed &= ExpectCounts(rStream, 1, 0, "New world");
+
+		// A new view uploads the view buffer, and the object buffer too as
+		// it holds the world, view and projection combined
+		IOE::Maths::IOECamera tCamera(rRPI.GetCamera());
+		tCamera.GetTransform().SetTranslation(0.0f, 10.0f, 0.0f);
+		tCamera.UpdateViewMatrices();
+		rStream.Reset();
+		rConstants.SetView(&rRPI, tCamera, rRPI.GetViewport(0));
+		rConstants.SetView(&rRPI, tCamera, rRPI.GetViewport(0));
+		rConstants.SetObject(&rRPI, IOE::Maths::g_mIdentity);
+		rConstants.SetObject(&rRPI, IOE::Maths::g_mIdentity);
+		bPassed &= ExpectCounts(rStream, 2, 0, "New view");
+
+		rRPI.OnRender(&rRPI);
+		rRPI.OnPostRender(&rRPI);
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestInstanceSettings(IOERPI &rRPI)
+	{
+		IOERPICommandStream &rStream(UnitTests::GetCommandStream(rRPI));
+		std::shared_ptr<IOEMaterial> pMaterial(LoadInstancedMaterial(rRPI));
+
+		bool bPassed(Expect(
+			pMaterial->GetShaderParameter("InstanceSettings", "NumInstances")
+				.IsValid(),
+			"InstanceSettings not reflected"));
+
+		rRPI.OnPreRender(&rRPI);
+		pMaterial->Set(&rRPI);
+
+		// Each new count is one upload, rebound at its place in the ring
+		rStream.Reset();
+		pMaterial->SetInstancing(0, 64);
+		pMaterial->SetInstancing(0, 64);
+		bPassed &= ExpectCounts(rStream, 1, 1, "Repeated instance counts");
+
+		rStream.Reset();
+		pMaterial->SetInstancing(64, 64);
+		bPassed &= ExpectCounts(rStream, 1, 1, "New first instance");
+
+		// Set clears the counts once, after which they are left alone
+		rStream.Reset();
+		pMaterial->Set(&rRPI);
+		pMaterial->Set(&rRPI);
+		pMaterial->SetInstancing(0, 0);
+		bPassed &= ExpectCounts(rStream, 1, 1, "Instancing cleared by Set");
+
+		// Writing the buffer by name leaves its contents unknown
+		rStream.Reset();
+		pMaterial->MapCBuffer("InstanceSettings");
+		pMaterial->UnmapCBuffer("InstanceSettings");
+		pMaterial->SetInstancing(0, 0);
+		bPassed &= ExpectCounts(rStream, 1, 1, "Mapped InstanceSettings");
+
+		rRPI.OnRender(&rRPI);
+		rRPI.OnPostRender(&rRPI);
+		return bPassed;
+	}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main(int nArgC, char **arrArgV)
+{
+	std::shared_ptr<IOERPI> pRPI(
+		UnitTests::CreateHeadlessRPI(UnitTests::GetMediaPath(nArgC, arrArgV)));
+
+	bool bPassed(true);
+	bPassed &= TestEngineConstants(*pRPI);
+	bPassed &= TestInstanceSettings(*pRPI);
+
+	std::printf("ConstantUploadTest %s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
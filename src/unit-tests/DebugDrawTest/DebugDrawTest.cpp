@@ -0,0 +1,337 @@
+// Checks IOEDebugDraw: primitives added from many threads at once all reach
+// the merged vertices, each thread's in the order it added them, batches
+// that overflow a page move to a new one without splitting a primitive,
+// pages are reused by later frames, and retained primitives are drawn
+// until their duration runs out.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include <IOE/IOERenderer/IOEDebugDraw.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Renderer;
+
+	const std::uint32_t g_uNumThreads = 8;
+
+	// Each thread fills one page of lines and starts another
+	const std::uint32_t g_uLinesPerPage = IOEDebugDraw::ms_uVerticesPerPage / 2;
+	const std::uint32_t g_uLinesPerThread = g_uLinesPerPage + 100;
+	const std::uint32_t g_uPointsPerThread	= 200;
+	const std::uint32_t g_uTrianglesPerThread = 50;
+
+	bool Expect(bool bPassed, const char *szCase)
+	{
+		if (!bPassed)
+		{
+			std::printf("%s\n", szCase);
+		}
+		return bPassed;
+	}
+
+	// Vertices are tagged with who added them, the primitive's index and
+	// which of its vertices they are
+	IOEVector Tag(std::uint32_t uOwner, std::uint32_t uIdx,
+				  std::uint32_t uVertex)
+	{
+		return IOEVector(static_cast<float>(uOwner),
+						 static_cast<float>(uIdx),
+						 static_cast<float>(uVertex), 1.0f);
+	}
+
+	bool IsTagged(const DebugVertex &rVertex, std::uint32_t uOwner,
+				  std::uint32_t uIdx, std::uint32_t uVertex)
+	{
+		float fOwner, fIdx, fVertex;
+		rVertex.vPos.Get(fOwner, fIdx, fVertex);
+		return fOwner == static_cast<float>(uOwner) &&
+			fIdx == static_cast<float>(uIdx) &&
+			fVertex == static_cast<float>(uVertex);
+	}
+
+	std::vector<DebugVertex> Gather(IOEDebugDraw &rDraw)
+	{
+		rDraw.Merge(std::numeric_limits<std::uint32_t>::max());
+		std::vector<DebugVertex> arrVertices(rDraw.GetNumVertices());
+		const std::uint32_t uNumWritten(rDraw.Write(arrVertices.data()));
+		arrVertices.resize(uNumWritten);
+		return arrVertices;
+	}
+
+	// Checks uNumPrimitives of ePrimitive from each of uNumOwners start at
+	// ruFirst, every owner's in order, and moves ruFirst past them
+	bool ExpectPrimitives(const std::vector<DebugVertex> &arrVertices,
+						  std::uint32_t &ruFirst,
+						  EDebugPrimitive::Enum ePrimitive,
+						  std::uint32_t uNumOwners,
+						  std::uint32_t uNumPrimitives)
+	{
+		const std::uint32_t uVerticesPerPrimitive(
+			IOEDebugDraw::GetVerticesPerPrimitive(ePrimitive));
+		std::vector<std::uint32_t> arrNext(uNumOwners, 0);
+		const std::uint32_t uEnd(ruFirst + uNumOwners * uNumPrimitives *
+										 uVerticesPerPrimitive);
+		if (uEnd > arrVertices.size())
+		{
+			return false;
+		}
+
+		for (; ruFirst < uEnd; ruFirst += uVerticesPerPrimitive)
+		{
+			float fOwner, fIdx, fVertex;
+			arrVertices[ruFirst].vPos.Get(fOwner, fIdx, fVertex);
+			const std::uint32_t uOwner(static_cast<std::uint32_t>(fOwner));
+			if (uOwner >= uNumOwners)
+			{
+				return false;
+			}
+			for (std::uint32_t uVertex(0); uVertex < uVerticesPerPrimitive;
+				 ++uVertex)
+			{
+				if (!IsTagged(arrVertices[ruFirst + uVertex], uOwner,
+							  arrNext[uOwner], uVertex))
+				{
+					return false;
+				}
+			}
+			++arrNext[uOwner];
+		}
+		for (std::uint32_t uNext : arrNext)
+		{
+			if (uNext != uNumPrimitives)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void AddTagged(IOEDebugDraw &rDraw, std::uint32_t uOwner)
+	{
+		// Triangles first, as they are drawn last
+		for (std::uint32_t uIdx(0); uIdx < g_uTrianglesPerThread; ++uIdx)
+		{
+			rDraw.AddTriangle(Tag(uOwner, uIdx, 0), Tag(uOwner, uIdx, 1),
+							  Tag(uOwner, uIdx, 2));
+		}
+		for (std::uint32_t uIdx(0); uIdx < g_uLinesPerThread; ++uIdx)
+		{
+			rDraw.AddLine(Tag(uOwner, uIdx, 0), Tag(uOwner, uIdx, 1));
+			if (uIdx < g_uPointsPerThread)
+			{
+				rDraw.AddPoint(Tag(uOwner, uIdx, 0));
+			}
+		}
+	}
+
+	bool TestThreads()
+	{
+		IOEDebugDraw tDraw;
+		std::atomic<bool> bStart(false);
+		std::vector<std::thread> arrThreads;
+		for (std::uint32_t uOwner(0); uOwner < g_uNumThreads; ++uOwner)
+		{
+			arrThreads.emplace_back([&tDraw, &bStart, uOwner]() {
+				while (!bStart)
+				{
+					std::this_thread::yield();
+				}
+				AddTagged(tDraw, uOwner);
+			});
+		}
+		bStart = true;
+		for (std::thread &rThread : arrThreads)
+		{
+			rThread.join();
+		}
+
+		const std::vector<DebugVertex> arrVertices(Gather(tDraw));
+		bool bPassed(Expect(
+			tDraw.GetNumPrimitives(EDebugPrimitive::Line) ==
+				g_uNumThreads * g_uLinesPerThread,
+			"Lines lost between threads"));
+
+		// Points, lines, then triangles, whatever order they were added in
+		std::uint32_t uFirst(0);
+		bPassed &= Expect(ExpectPrimitives(arrVertices, uFirst,
+										   EDebugPrimitive::Point,
+										   g_uNumThreads, g_uPointsPerThread),
+						  "Points from threads");
+		bPassed &= Expect(ExpectPrimitives(arrVertices, uFirst,
+										   EDebugPrimitive::Line,
+										   g_uNumThreads, g_uLinesPerThread),
+						  "Lines from threads");
+		bPassed &=
+			Expect(ExpectPrimitives(arrVertices, uFirst,
+									EDebugPrimitive::Triangle, g_uNumThreads,
+									g_uTrianglesPerThread),
+				   "Triangles from threads");
+		bPassed &= Expect(uFirst == arrVertices.size(), "Stray vertices");
+
+		// A page of points, one of triangles, and two of lines each
+		bPassed &= Expect(tDraw.GetNumPages() == g_uNumThreads * 4,
+						  "Pages for every thread");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestPageOverflow()
+	{
+		IOEDebugDraw tDraw;
+		bool bPassed(true);
+
+		// Two frames alike, the second reusing the first's pages
+		for (std::uint32_t uFrame(0); uFrame < 2; ++uFrame)
+		{
+			// One line, then a batch too big for what is left of its page
+			DebugVertex *pFirst(tDraw.Allocate(EDebugPrimitive::Line, 1));
+			pFirst[0].Set(Tag(0, 0, 0), Tag(0, 0, 0));
+			pFirst[1].Set(Tag(0, 0, 1), Tag(0, 0, 1));
+			DebugVertex *pFull(
+				tDraw.Allocate(EDebugPrimitive::Line, g_uLinesPerPage));
+			for (std::uint32_t uIdx(0); uIdx < g_uLinesPerPage; ++uIdx)
+			{
+				pFull[uIdx * 2].Set(Tag(0, uIdx + 1, 0), Tag(0, 0, 0));
+				pFull[uIdx * 2 + 1].Set(Tag(0, uIdx + 1, 1), Tag(0, 0, 0));
+			}
+
+			// A page holds a whole number of triangles, so the one past it
+			// starts a page of its own
+			const std::uint32_t uTrianglesPerPage(
+				IOEDebugDraw::ms_uVerticesPerPage / 3);
+			for (std::uint32_t uIdx(0); uIdx <= uTrianglesPerPage; ++uIdx)
+			{
+				tDraw.AddTriangle(Tag(0, uIdx, 0), Tag(0, uIdx, 1),
+								  Tag(0, uIdx, 2));
+			}
+
+			const std::vector<DebugVertex> arrVertices(Gather(tDraw));
+			std::uint32_t uFirst(0);
+			bPassed &= Expect(ExpectPrimitives(arrVertices, uFirst,
+											   EDebugPrimitive::Line, 1,
+											   g_uLinesPerPage + 1),
+							  "Lines over a full page");
+			bPassed &= Expect(ExpectPrimitives(arrVertices, uFirst,
+											   EDebugPrimitive::Triangle, 1,
+											   uTrianglesPerPage + 1),
+							  "Triangles over a page");
+			bPassed &= Expect(tDraw.GetNumPages() == 4,
+							  uFrame == 0 ? "Pages for overflow"
+										  : "Pages not reused");
+			tDraw.Flush(0.0f);
+		}
+
+		// AddLines splits a run longer than a page over as many as it needs
+		std::vector<DebugVertex> arrLines;
+		const std::uint32_t uNumLines(g_uLinesPerPage * 2 + 5);
+		for (std::uint32_t uIdx(0); uIdx < uNumLines; ++uIdx)
+		{
+			arrLines.emplace_back(Tag(0, uIdx, 0), Tag(0, 0, 0));
+			arrLines.emplace_back(Tag(0, uIdx, 1), Tag(0, 0, 0));
+		}
+		tDraw.AddLines(arrLines.data(), uNumLines);
+
+		const std::vector<DebugVertex> arrVertices(Gather(tDraw));
+		std::uint32_t uFirst(0);
+		bPassed &= Expect(ExpectPrimitives(arrVertices, uFirst,
+										   EDebugPrimitive::Line, 1,
+										   uNumLines) &&
+							  uFirst == arrVertices.size(),
+						  "Lines split over pages");
+		bPassed &= Expect(tDraw.GetNumPages() == 5, "Pages for split lines");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Which of the merged lines are there, by owner
+	std::uint32_t GetLineOwners(IOEDebugDraw &rDraw)
+	{
+		const std::vector<DebugVertex> arrVertices(Gather(rDraw));
+		std::uint32_t uOwners(0);
+		for (std::uint32_t uIdx(rDraw.GetNumPrimitives(EDebugPrimitive::Point));
+			 uIdx + 1 < arrVertices.size(); uIdx += 2)
+		{
+			float fOwner, fIdx, fVertex;
+			arrVertices[uIdx].vPos.Get(fOwner, fIdx, fVertex);
+			const std::uint32_t uOwner(static_cast<std::uint32_t>(fOwner));
+			if (IsTagged(arrVertices[uIdx], uOwner, 0, 0) &&
+				IsTagged(arrVertices[uIdx + 1], uOwner, 0, 1))
+			{
+				uOwners |= 1 << uOwner;
+			}
+		}
+		return uOwners;
+	}
+
+	bool TestRetained()
+	{
+		IOEDebugDraw tDraw;
+
+		// Line 0 for this frame, 1 for a second and 2 for two seconds, the
+		// last from another thread
+		tDraw.AddLine(Tag(0, 0, 0), Tag(0, 0, 1));
+		tDraw.AddLine(Tag(1, 0, 0), Tag(1, 0, 1), IOE::Maths::g_vIdentity,
+					  IOE::Maths::g_vIdentity, 1.0f);
+		std::thread tThread([&tDraw]() {
+			tDraw.AddLine(Tag(2, 0, 0), Tag(2, 0, 1), IOE::Maths::g_vIdentity,
+						  IOE::Maths::g_vIdentity, 2.0f);
+		});
+		tThread.join();
+		tDraw.AddPoint(Tag(3, 0, 0), IOE::Maths::g_vIdentity, 0.5f);
+
+		bool bPassed(Expect(GetLineOwners(tDraw) == 0x7, "First frame"));
+		tDraw.Flush(0.25f);
+		bPassed &= Expect(GetLineOwners(tDraw) == 0x6 &&
+							  tDraw.GetNumPrimitives(EDebugPrimitive::Point) ==
+								  1,
+						  "Retained after a flush");
+		tDraw.Flush(0.5f);
+		bPassed &= Expect(GetLineOwners(tDraw) == 0x6 &&
+							  tDraw.GetNumPrimitives(EDebugPrimitive::Point) ==
+								  0,
+						  "Retained point outlived its duration");
+
+		// The line left over is packed down intact, whichever went first
+		tDraw.Flush(0.5f);
+		bPassed &= Expect(GetLineOwners(tDraw) == 0x4 &&
+							  tDraw.GetNumVertices() == 2,
+						  "Longest retained line");
+
+		// Added after the merge, so not aged until it has been drawn
+		tDraw.AddLine(Tag(4, 0, 0), Tag(4, 0, 1), IOE::Maths::g_vIdentity,
+					  IOE::Maths::g_vIdentity, 0.5f);
+		tDraw.Flush(1.0f);
+		bPassed &= Expect(GetLineOwners(tDraw) == 0x10,
+						  "Line added between merge and flush");
+		tDraw.Flush(1.0f);
+		bPassed &= Expect(GetLineOwners(tDraw) == 0 &&
+							  tDraw.GetNumVertices() == 0,
+						  "Nothing left retained");
+		return bPassed;
+	}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	bool bPassed(true);
+	bPassed &= TestThreads();
+	bPassed &= TestPageOverflow();
+	bPassed &= TestRetained();
+
+	std::printf("DebugDrawTest %s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
@@ -0,0 +1,421 @@
+// Compares the SIMD frustum culling in IOEMaths/Frustum.h and
+// IOEMaths/FrustumSet.h against a scalar brute force classification of the
+// same boxes, and checks the planes against clip space for every corner.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <IOE/IOEMaths/Frustum.h>
+#include <IOE/IOEMaths/FrustumSet.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Maths;
+
+	const std::uint32_t g_uNumTrials = 500;
+	const float g_fClipEpsilon		 = 1e-3f;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	struct Matrix
+	{
+		float arrValues[16];
+	};
+
+	Matrix Multiply(const Matrix &rA, const Matrix &rB)
+	{
+		Matrix tResult;
+		for (std::uint32_t uRow(0); uRow < 4; ++uRow)
+		{
+			for (std::uint32_t uCol(0); uCol < 4; ++uCol)
+			{
+				float fSum(0.0f);
+				for (std::uint32_t uIdx(0); uIdx < 4; ++uIdx)
+				{
+					fSum += rA.arrValues[uRow * 4 + uIdx] *
+						rB.arrValues[uIdx * 4 + uCol];
+				}
+				tResult.arrValues[uRow * 4 + uCol] = fSum;
+			}
+		}
+		return tResult;
+	}
+
+	// Left handed perspective with a [0, 1] depth range, row-vector
+	// convention as IOEMatrix
+	Matrix Perspective(float fFovY, float fAspect, float fNear, float fFar)
+	{
+		const float fScaleY(1.0f / std::tan(fFovY * 0.5f));
+		const float fRange(fFar / (fFar - fNear));
+		const Matrix tResult = {{fScaleY / fAspect, 0, 0, 0, 0, fScaleY, 0, 0,
+								 0, 0, fRange, 1, 0, 0, -fRange * fNear, 0}};
+		return tResult;
+	}
+
+	// Inverse of a camera at the position looking along yaw and pitch
+	Matrix View(float fYaw, float fPitch, float fX, float fY, float fZ)
+	{
+		const float fCY(std::cos(fYaw)), fSY(std::sin(fYaw));
+		const float fCP(std::cos(fPitch)), fSP(std::sin(fPitch));
+
+		// Camera axes as rows of the camera's world rotation
+		const float arrRight[3]   = {fCY, 0.0f, -fSY};
+		const float arrUp[3]	  = {fSY * fSP, fCP, fCY * fSP};
+		const float arrForward[3] = {fSY * fCP, -fSP, fCY * fCP};
+		const float arrPos[3]	 = {fX, fY, fZ};
+
+		auto Dot = [](const float *pA, const float *pB) {
+			return pA[0] * pB[0] + pA[1] * pB[1] + pA[2] * pB[2];
+		};
+
+		const Matrix tResult = {
+			{arrRight[0], arrUp[0], arrForward[0], 0, arrRight[1], arrUp[1],
+			 arrForward[1], 0, arrRight[2], arrUp[2], arrForward[2], 0,
+			 -Dot(arrRight, arrPos), -Dot(arrUp, arrPos),
+			 -Dot(arrForward, arrPos), 1}};
+		return tResult;
+	}
+
+	Matrix RandomViewProjection(std::mt19937 &rRandom)
+	{
+		std::uniform_real_distribution<float> tAngle(-3.14159f, 3.14159f);
+		std::uniform_real_distribution<float> tPosition(-50.0f, 50.0f);
+		std::uniform_real_distribution<float> tFov(0.5f, 2.0f);
+		std::uniform_real_distribution<float> tAspect(0.5f, 2.5f);
+		std::uniform_real_distribution<float> tNear(0.1f, 2.0f);
+		std::uniform_real_distribution<float> tFar(20.0f, 200.0f);
+
+		const float fYaw(tAngle(rRandom));
+		const float fPitch(tAngle(rRandom) * 0.45f);
+		const float fX(tPosition(rRandom));
+		const float fY(tPosition(rRandom));
+		const float fZ(tPosition(rRandom));
+		const float fFov(tFov(rRandom));
+		const float fAspect(tAspect(rRandom));
+		const float fNear(tNear(rRandom));
+		const float fFar(tFar(rRandom));
+		return Multiply(View(fYaw, fPitch, fX, fY, fZ),
+						Perspective(fFov, fAspect, fNear, fFar));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	struct Boxes
+	{
+		explicit Boxes(std::uint32_t uCount)
+			: arrCentreX(uCount)
+			, arrCentreY(uCount)
+			, arrCentreZ(uCount)
+			, arrExtentX(uCount)
+			, arrExtentY(uCount)
+			, arrExtentZ(uCount)
+		{
+			tView.pCentreX = arrCentreX.data();
+			tView.pCentreY = arrCentreY.data();
+			tView.pCentreZ = arrCentreZ.data();
+			tView.pExtentX = arrExtentX.data();
+			tView.pExtentY = arrExtentY.data();
+			tView.pExtentZ = arrExtentZ.data();
+			tView.uCount   = uCount;
+		}
+
+		std::vector<float> arrCentreX, arrCentreY, arrCentreZ;
+		std::vector<float> arrExtentX, arrExtentY, arrExtentZ;
+		IOEAABBArray tView;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// One plane at a time, summed in the same order as the kernels so the
+	// results agree to the bit
+	ECullResult::Enum ClassifyBruteForce(const IOEFrustumPlanes &rPlanes,
+										 const float *pCentre,
+										 const float *pExtent,
+										 std::uint32_t uPlaneMask,
+										 std::uint32_t &ruStraddled)
+	{
+		bool bStraddles(false);
+		ruStraddled = 0;
+		for (std::uint32_t uPlane(0); uPlane < EFrustumPlane::NumPlanes;
+			 ++uPlane)
+		{
+			if ((uPlaneMask & (1u << uPlane)) == 0)
+			{
+				continue;
+			}
+
+			const float fDist(
+				(rPlanes.arrNormalX[uPlane] * pCentre[0] +
+				 rPlanes.arrNormalY[uPlane] * pCentre[1]) +
+				(rPlanes.arrNormalZ[uPlane] * pCentre[2] +
+				 rPlanes.arrDistance[uPlane]));
+			const float fRadius(
+				(std::fabs(rPlanes.arrNormalX[uPlane]) * pExtent[0] +
+				 std::fabs(rPlanes.arrNormalY[uPlane]) * pExtent[1]) +
+				std::fabs(rPlanes.arrNormalZ[uPlane]) * pExtent[2]);
+
+			if (fDist < -fRadius)
+			{
+				return ECullResult::Outside;
+			}
+			if (fDist < fRadius)
+			{
+				bStraddles = true;
+				ruStraddled |= 1u << uPlane;
+			}
+		}
+		return bStraddles ? ECullResult::Intersect : ECullResult::Inside;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// A box inside the frustum has every corner inside clip space, and one
+	// outside has every corner beyond the same clip plane
+	bool CheckAgainstClipSpace(const Matrix &rViewProj, const float *pCentre,
+							   const float *pExtent, ECullResult::Enum eResult)
+	{
+		std::uint32_t uOutsideAll(0x3f);
+		bool bAllInside(true);
+		for (std::uint32_t uCorner(0); uCorner < 8; ++uCorner)
+		{
+			float arrCorner[4] = {
+				pCentre[0] + ((uCorner & 1) != 0 ? pExtent[0] : -pExtent[0]),
+				pCentre[1] + ((uCorner & 2) != 0 ? pExtent[1] : -pExtent[1]),
+				pCentre[2] + ((uCorner & 4) != 0 ? pExtent[2] : -pExtent[2]),
+				1.0f};
+
+			float arrClip[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+			for (std::uint32_t uCol(0); uCol < 4; ++uCol)
+			{
+				for (std::uint32_t uRow(0); uRow < 4; ++uRow)
+				{
+					arrClip[uCol] +=
+						arrCorner[uRow] * rViewProj.arrValues[uRow * 4 + uCol];
+				}
+			}
+
+			// Left, right, bottom, top, near and far as distances inside
+			const float fW(arrClip[3]);
+			const float fEpsilon(g_fClipEpsilon * (std::fabs(fW) + 1.0f));
+			const float arrInside[6] = {fW + arrClip[0], fW - arrClip[0],
+										fW + arrClip[1], fW - arrClip[1],
+										arrClip[2],		 fW - arrClip[2]};
+
+			std::uint32_t uOutside(0);
+			for (std::uint32_t uPlane(0); uPlane < 6; ++uPlane)
+			{
+				bAllInside = bAllInside && arrInside[uPlane] > -fEpsilon;
+				uOutside |= arrInside[uPlane] < fEpsilon ? 1u << uPlane : 0;
+			}
+			uOutsideAll &= uOutside;
+		}
+
+		if (eResult == ECullResult::Inside)
+		{
+			return bAllInside;
+		}
+		if (eResult == ECullResult::Outside)
+		{
+			return uOutsideAll != 0;
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestCullAABBArray(std::mt19937 &rRandom, std::uint32_t uTrial)
+	{
+		const Matrix tViewProj(RandomViewProjection(rRandom));
+		IOEFrustumPlanes tPlanes;
+		tPlanes.SetFromViewProjection(tViewProj.arrValues);
+
+		// Counts that are not a multiple of the 8 box batch
+		const std::uint32_t uCount(1 + rRandom() % 301);
+		Boxes tBoxes(uCount);
+		std::vector<std::uint8_t> arrInMasks(uCount), arrCoherent(uCount);
+		std::uniform_real_distribution<float> tCentre(-120.0f, 120.0f);
+		std::uniform_real_distribution<float> tExtent(0.0f, 15.0f);
+		for (std::uint32_t uBox(0); uBox < uCount; ++uBox)
+		{
+			tBoxes.arrCentreX[uBox] = tCentre(rRandom);
+			tBoxes.arrCentreY[uBox] = tCentre(rRandom);
+			tBoxes.arrCentreZ[uBox] = tCentre(rRandom);
+			tBoxes.arrExtentX[uBox] = tExtent(rRandom);
+			tBoxes.arrExtentY[uBox] = tExtent(rRandom);
+			tBoxes.arrExtentZ[uBox] = tExtent(rRandom);
+			arrInMasks[uBox] = static_cast<std::uint8_t>(rRandom() & 0x3f);
+			arrCoherent[uBox] = static_cast<std::uint8_t>(rRandom() % 6);
+		}
+
+		// Cover every combination of the options across trials
+		IOEFrustumCullOptions tOptions;
+		std::vector<std::uint8_t> arrOutMasks(uCount);
+		tOptions.uPlaneMask		= (uTrial & 1) != 0 ? 0x2f : 0x3f;
+		tOptions.pInPlaneMasks =
+			(uTrial & 2) != 0 ? arrInMasks.data() : nullptr;
+		tOptions.pOutPlaneMasks = arrOutMasks.data();
+		tOptions.pCoherentPlanes =
+			(uTrial & 4) != 0 ? arrCoherent.data() : nullptr;
+
+		// Twice, so the second pass starts from the coherent planes the
+		// first pass wrote
+		std::vector<std::uint8_t> arrResults(uCount);
+		for (std::uint32_t uPass(0); uPass < 2; ++uPass)
+		{
+			const std::uint32_t uVisible(CullAABBArray(
+				tPlanes, tBoxes.tView, arrResults.data(), tOptions));
+
+			std::uint32_t uExpectedVisible(0);
+			for (std::uint32_t uBox(0); uBox < uCount; ++uBox)
+			{
+				const float arrCentre[3] = {tBoxes.arrCentreX[uBox],
+											tBoxes.arrCentreY[uBox],
+											tBoxes.arrCentreZ[uBox]};
+				const float arrExtent[3] = {tBoxes.arrExtentX[uBox],
+											tBoxes.arrExtentY[uBox],
+											tBoxes.arrExtentZ[uBox]};
+				const std::uint32_t uMask(
+					tOptions.uPlaneMask &
+					(tOptions.pInPlaneMasks != nullptr ? arrInMasks[uBox]
+													   : 0xffu));
+
+				std::uint32_t uStraddled;
+				const ECullResult::Enum eExpected(ClassifyBruteForce(
+					tPlanes, arrCentre, arrExtent, uMask, uStraddled));
+				if (arrResults[uBox] != eExpected ||
+					(eExpected != ECullResult::Outside &&
+					 arrOutMasks[uBox] != uStraddled))
+				{
+					std::printf("CullAABBArray trial %u box %u: expected %u "
+								"planes %02x, got %u planes %02x\n",
+								uTrial, uBox, eExpected, uStraddled,
+								arrResults[uBox], arrOutMasks[uBox]);
+					return false;
+				}
+				if (uMask == 0x3f &&
+					!CheckAgainstClipSpace(tViewProj, arrCentre, arrExtent,
+										   eExpected))
+				{
+					std::printf("Planes disagree with clip space, trial %u "
+								"box %u\n",
+								uTrial, uBox);
+					return false;
+				}
+				uExpectedVisible += eExpected != ECullResult::Outside ? 1 : 0;
+			}
+
+			if (uVisible != uExpectedVisible)
+			{
+				std::printf("CullAABBArray trial %u: %u visible, expected %u\n",
+							uTrial, uVisible, uExpectedVisible);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestFrustumSet(std::mt19937 &rRandom, std::uint32_t uTrial)
+	{
+		const std::uint32_t uNumViews(1 +
+									  rRandom() % IOEFrustumSet::ms_uMaxViews);
+		std::vector<IOEFrustumPlanes> arrPlanes(uNumViews);
+		std::vector<std::uint32_t> arrPlaneMasks(uNumViews);
+
+		IOEFrustumSet tSet;
+		for (std::uint32_t uView(0); uView < uNumViews; ++uView)
+		{
+			arrPlanes[uView].SetFromViewProjection(
+				RandomViewProjection(rRandom).arrValues);
+
+			// Some views are a single plane, as a half space
+			arrPlaneMasks[uView] = rRandom() % 4 == 0
+				? 1u << (rRandom() % EFrustumPlane::NumPlanes)
+				: IOEFrustumPlanes::ms_uAllPlanesMask;
+			tSet.Add(arrPlanes[uView], arrPlaneMasks[uView]);
+		}
+
+		std::uniform_real_distribution<float> tCentre(-120.0f, 120.0f);
+		std::uniform_real_distribution<float> tExtent(0.0f, 15.0f);
+		for (std::uint32_t uBox(0); uBox < 256; ++uBox)
+		{
+			const float arrCentre[3] = {tCentre(rRandom), tCentre(rRandom),
+										tCentre(rRandom)};
+			const float arrExtent[3] = {tExtent(rRandom), tExtent(rRandom),
+										tExtent(rRandom)};
+			const std::uint64_t uViewMask(
+				(static_cast<std::uint64_t>(rRandom()) << 32 | rRandom()) &
+				tSet.GetAllViewsMask());
+
+			std::uint8_t arrInPlanes[IOEFrustumSet::ms_uNumGroups];
+			std::uint8_t arrOutPlanes[IOEFrustumSet::ms_uNumGroups];
+			for (std::uint8_t &rInPlanes : arrInPlanes)
+			{
+				rInPlanes = static_cast<std::uint8_t>(rRandom() & 0x3f);
+			}
+			const bool bInPlanes((uTrial & 1) != 0);
+
+			std::uint64_t uInside;
+			const std::uint64_t uTouching(tSet.Classify(
+				arrCentre, arrExtent, uViewMask, uInside,
+				bInPlanes ? arrInPlanes : nullptr, arrOutPlanes));
+
+			std::uint64_t uExpectedTouching(0), uExpectedInside(0);
+			for (std::uint32_t uView(0); uView < uNumViews; ++uView)
+			{
+				const std::uint64_t uBit(static_cast<std::uint64_t>(1)
+										 << uView);
+				if ((uViewMask & uBit) == 0)
+				{
+					continue;
+				}
+
+				const std::uint32_t uMask(
+					arrPlaneMasks[uView] &
+					(bInPlanes ? arrInPlanes[uView / 4] : 0xffu));
+				std::uint32_t uStraddled;
+				const ECullResult::Enum eResult(
+					ClassifyBruteForce(arrPlanes[uView], arrCentre, arrExtent,
+									   uMask, uStraddled));
+				uExpectedTouching |= eResult != ECullResult::Outside ? uBit : 0;
+				uExpectedInside |= eResult == ECullResult::Inside ? uBit : 0;
+			}
+
+			if (uTouching != uExpectedTouching || uInside != uExpectedInside)
+			{
+				std::printf("IOEFrustumSet trial %u box %u: touching %016llx "
+							"inside %016llx, expected %016llx %016llx\n",
+							uTrial, uBox,
+							static_cast<unsigned long long>(uTouching),
+							static_cast<unsigned long long>(uInside),
+							static_cast<unsigned long long>(uExpectedTouching),
+							static_cast<unsigned long long>(uExpectedInside));
+				return false;
+			}
+		}
+		return true;
+	}
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	std::mt19937 tRandom(0xC011);
+
+	bool bPassed(true);
+	for (std::uint32_t uTrial(0); uTrial < g_uNumTrials && bPassed; ++uTrial)
+	{
+		bPassed = TestCullAABBArray(tRandom, uTrial) &&
+			TestFrustumSet(tRandom, uTrial);
+	}
+
+	std::printf("%s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
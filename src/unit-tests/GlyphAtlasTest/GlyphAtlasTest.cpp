@@ -0,0 +1,483 @@
+// Checks IOEGlyphAtlas with a stub rasteriser of solid squares: the skyline
+// packer never overlaps or leaves the atlas, the distance field holds 0.5 on
+// the edge of a glyph, glyphs kept in use survive LRU eviction with their
+// texels intact, missing glyphs are never retried, and UTF-8 decodes to the
+// code points the atlas is looked up by.
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <IOE/IOERenderer/IOEGlyphAtlas.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Renderer;
+
+	const std::uint32_t g_uSpread = IOEGlyphAtlas::ms_uSpread;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Glyphs are solid squares of the size given for their code point, and
+	// a size of 0 is a glyph with nothing to draw. Code points without a
+	// size have no glyph.
+	class StubRasteriser : public IOEGlyphRasteriser
+	{
+	public:
+		StubRasteriser(std::map<std::uint32_t, std::uint32_t> &rmapSizes,
+					   std::map<std::uint32_t, std::uint32_t> &rmapCalls,
+					   bool &rbOnCaller)
+			: m_rmapSizes(rmapSizes)
+			, m_rmapCalls(rmapCalls)
+			, m_rbOnCaller(rbOnCaller)
+			, m_tCaller(std::this_thread::get_id())
+		{
+		}
+
+		virtual bool RasteriseGlyph(std::uint32_t uCodePoint,
+									std::uint32_t uPixelHeight,
+									IOEGlyphBitmap &rBitmap) override
+		{
+			++m_rmapCalls[uCodePoint];
+			m_rbOnCaller =
+				m_rbOnCaller || std::this_thread::get_id() == m_tCaller;
+
+			auto pIter(m_rmapSizes.find(uCodePoint));
+			if (pIter == m_rmapSizes.end())
+			{
+				return false;
+			}
+
+			const std::uint32_t uSize(pIter->second);
+			rBitmap.uWidth		= uSize;
+			rBitmap.uHeight		= uSize;
+			rBitmap.fAdvance	= uSize + 2.0f;
+			rBitmap.fBearingX	= 1.0f;
+			rBitmap.fBearingY	= 0.0f;
+			rBitmap.fLineHeight = static_cast<float>(uPixelHeight);
+			rBitmap.arrCoverage.assign(uSize * uSize, 255);
+			return true;
+		}
+
+	private:
+		std::map<std::uint32_t, std::uint32_t> &m_rmapSizes;
+		std::map<std::uint32_t, std::uint32_t> &m_rmapCalls;
+		bool &m_rbOnCaller;
+		std::thread::id m_tCaller;
+	};
+
+	// The atlas owns its rasteriser, so the test keeps what it sees
+	struct Fixture
+	{
+		std::map<std::uint32_t, std::uint32_t> mapSizes;
+		std::map<std::uint32_t, std::uint32_t> mapCalls;
+		bool bOnCaller = false;
+
+		std::unique_ptr<IOEGlyphRasteriser> CreateRasteriser()
+		{
+			return std::unique_ptr<IOEGlyphRasteriser>(
+				new StubRasteriser(mapSizes, mapCalls, bOnCaller));
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool Expect(bool bPassed, const char *szCase)
+	{
+		if (!bPassed)
+		{
+			std::printf("%s\n", szCase);
+		}
+		return bPassed;
+	}
+
+	bool ExpectInsert(IOESkylinePacker &rPacker, std::uint32_t uWidth,
+					  std::uint32_t uHeight, std::uint32_t uExpectedX,
+					  std::uint32_t uExpectedY)
+	{
+		std::uint32_t uX(~0U), uY(~0U);
+		if (!rPacker.Insert(uWidth, uHeight, uX, uY) || uX != uExpectedX ||
+			uY != uExpectedY)
+		{
+			std::printf("Insert %ux%u: at %u, %u, expected %u, %u\n", uWidth,
+						uHeight, uX, uY, uExpectedX, uExpectedY);
+			return false;
+		}
+		return true;
+	}
+
+	// Looks a glyph up until the worker has published it
+	const IOEAtlasGlyph *Load(IOEGlyphAtlas &rAtlas, std::uint32_t uCodePoint,
+							  std::uint32_t uFrame)
+	{
+		const IOEAtlasGlyph *pGlyph(rAtlas.FindGlyph(uCodePoint));
+		if (pGlyph == nullptr)
+		{
+			rAtlas.Flush();
+			rAtlas.Update(uFrame);
+			pGlyph = rAtlas.FindGlyph(uCodePoint);
+		}
+		return pGlyph;
+	}
+
+	std::vector<std::uint8_t> GetTexels(const IOEGlyphAtlas &rAtlas,
+										const IOEAtlasGlyph &rGlyph)
+	{
+		std::vector<std::uint8_t> arrTexels;
+		for (std::uint32_t uRow(0); uRow < rGlyph.uHeight; ++uRow)
+		{
+			const std::uint8_t *pRow(
+				&rAtlas.GetImage()[(rGlyph.uY + uRow) * rAtlas.GetWidth() +
+								   rGlyph.uX]);
+			arrTexels.insert(arrTexels.end(), pRow, pRow + rGlyph.uWidth);
+		}
+		return arrTexels;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestPacker()
+	{
+		IOESkylinePacker tPacker;
+		tPacker.Reset(100, 100);
+
+		// Lowest bottom edge first, wherever along the skyline that is
+		std::uint32_t uX(0), uY(0);
+		if (!ExpectInsert(tPacker, 60, 10, 0, 0) ||
+			!ExpectInsert(tPacker, 50, 10, 0, 10) ||
+			!ExpectInsert(tPacker, 40, 30, 60, 0) ||
+			!ExpectInsert(tPacker, 10, 5, 50, 10) ||
+			!Expect(!tPacker.Insert(101, 1, uX, uY), "Wider than the packer") ||
+			!Expect(!tPacker.Insert(1, 86, uX, uY), "Over the top") ||
+			!Expect(tPacker.GetUsedArea() == 2350, "Used area"))
+		{
+			return false;
+		}
+
+		tPacker.Reset(100, 100);
+		return Expect(tPacker.GetUsedArea() == 0, "Used area after reset") &&
+			ExpectInsert(tPacker, 100, 100, 0, 0);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Random rectangles until the packer is full, every one of them inside
+	// it and over no other
+	bool TestPackerRandom(std::mt19937 &rRandom)
+	{
+		const std::uint32_t uSize(256);
+
+		IOESkylinePacker tPacker;
+		tPacker.Reset(uSize, uSize);
+		std::vector<std::uint8_t> arrTaken(uSize * uSize, 0);
+		std::uniform_int_distribution<std::uint32_t> tSide(1, 40);
+
+		std::uint32_t uArea(0), uNumFailed(0);
+		while (uNumFailed < 20)
+		{
+			const std::uint32_t uWidth(tSide(rRandom));
+			const std::uint32_t uHeight(tSide(rRandom));
+			std::uint32_t uX(0), uY(0);
+			if (!tPacker.Insert(uWidth, uHeight, uX, uY))
+			{
+				++uNumFailed;
+				continue;
+			}
+			if (uX + uWidth > uSize || uY + uHeight > uSize)
+			{
+				std::printf("Packer: %ux%u at %u, %u is outside\n", uWidth,
+							uHeight, uX, uY);
+				return false;
+			}
+
+			for (std::uint32_t uRow(uY); uRow < uY + uHeight; ++uRow)
+			{
+				for (std::uint32_t uColumn(uX); uColumn < uX + uWidth;
+					 ++uColumn)
+				{
+					if (arrTaken[uRow * uSize + uColumn]++ != 0)
+					{
+						std::printf("Packer: %ux%u at %u, %u overlaps\n",
+									uWidth, uHeight, uX, uY);
+						return false;
+					}
+				}
+			}
+			uArea += uWidth * uHeight;
+		}
+
+		// Nearly full, as glyph sized rectangles should leave it
+		return Expect(tPacker.GetUsedArea() == uArea, "Packer: used area") &&
+			Expect(uArea > uSize * uSize * 3 / 4, "Packer: left too empty");
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestDistanceField()
+	{
+		const std::uint32_t uSize(16);
+		const std::uint32_t uField(uSize + g_uSpread * 2);
+
+		Fixture tFixture;
+		tFixture.mapSizes['A'] = uSize;
+		IOEGlyphAtlas tAtlas(tFixture.CreateRasteriser(), 128, 128);
+
+		const std::uint32_t uGeneration(tAtlas.GetGeneration());
+		if (!Expect(tAtlas.FindGlyph('A') == nullptr, "Found before loading"))
+		{
+			return false;
+		}
+		tAtlas.Flush();
+		if (!Expect(tAtlas.Update(1), "Image did not change") ||
+			!Expect(tAtlas.GetGeneration() != uGeneration, "Same generation"))
+		{
+			return false;
+		}
+
+		// The quad is the field, border and all
+		const IOEAtlasGlyph *pGlyph(tAtlas.FindGlyph('A'));
+		if (!Expect(pGlyph != nullptr, "Glyph not published") ||
+			!Expect(pGlyph->uWidth == uField && pGlyph->uHeight == uField &&
+						pGlyph->fSizeX == uField && pGlyph->fSizeY == uField,
+					"Field size") ||
+			!Expect(pGlyph->fOffsetX == 1.0f - g_uSpread &&
+						pGlyph->fOffsetY == 0.0f - g_uSpread &&
+						pGlyph->fAdvance == uSize + 2.0f,
+					"Metrics") ||
+			!Expect(pGlyph->fTexMinX == pGlyph->uX / 128.0f &&
+						pGlyph->fTexMaxY ==
+							(pGlyph->uY + uField) / 128.0f,
+					"Texture coordinates") ||
+			!Expect(!tFixture.bOnCaller, "Rasterised on the caller"))
+		{
+			return false;
+		}
+
+		// The edge lies between the texels either side of it, half a texel
+		// from each, scaled by twice the spread
+		const std::vector<std::uint8_t> arrTexels(GetTexels(tAtlas, *pGlyph));
+		const std::uint32_t uMiddle(uField / 2);
+		const std::uint8_t *pRow(&arrTexels[uMiddle * uField]);
+		if (!Expect(pRow[g_uSpread] == 143 && pRow[g_uSpread - 1] == 112,
+					"Values either side of the edge") ||
+			!Expect(pRow[uMiddle] == 255, "Clamped past the spread") ||
+			!Expect(pRow[0] == 16, "Edge of the border") ||
+			!Expect(arrTexels[0] == 0 && arrTexels.back() == 0,
+					"Corners of the border"))
+		{
+			return false;
+		}
+
+		// Rising into the glyph and symmetric about its middle
+		for (std::uint32_t uIdx(0); uIdx < uField; ++uIdx)
+		{
+			const std::uint8_t uColumn(arrTexels[uIdx * uField + uMiddle]);
+			if ((uIdx > 0 && uIdx <= uMiddle && pRow[uIdx] < pRow[uIdx - 1]) ||
+				pRow[uIdx] != pRow[uField - 1 - uIdx] || uColumn != pRow[uIdx])
+			{
+				std::printf("Field: texel %u is %u\n", uIdx, pRow[uIdx]);
+				return false;
+			}
+		}
+
+		// Nothing outside the glyph is written
+		size_t uNumSet(0);
+		for (std::uint8_t uTexel : tAtlas.GetImage())
+		{
+			uNumSet += uTexel != 0 ? 1 : 0;
+		}
+		size_t uNumGlyphSet(0);
+		for (std::uint8_t uTexel : arrTexels)
+		{
+			uNumGlyphSet += uTexel != 0 ? 1 : 0;
+		}
+		return Expect(uNumSet == uNumGlyphSet, "Texels outside the glyph");
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestMissing()
+	{
+		Fixture tFixture;
+		tFixture.mapSizes[' '] = 0;
+		tFixture.mapSizes['A'] = 8;
+		tFixture.mapSizes['W'] = 200;
+		IOEGlyphAtlas tAtlas(tFixture.CreateRasteriser(), 64, 64);
+
+		// A glyph with nothing to draw only advances
+		const IOEAtlasGlyph *pSpace(Load(tAtlas, ' ', 1));
+		if (!Expect(pSpace != nullptr && pSpace->uWidth == 0 &&
+						pSpace->fAdvance == 2.0f,
+					"Empty glyph") ||
+			!Expect(tAtlas.GetImage() == std::vector<std::uint8_t>(64 * 64, 0),
+					"Empty glyph wrote texels"))
+		{
+			return false;
+		}
+
+		// Neither a code point without a glyph nor a glyph larger than the
+		// atlas is ever asked for again, and the too large one evicts
+		// nothing on its way out
+		if (!Expect(Load(tAtlas, 'A', 2) != nullptr, "Glyph not loaded") ||
+			!Expect(Load(tAtlas, 0x4E2D, 3) == nullptr, "Missing glyph") ||
+			!Expect(Load(tAtlas, 'W', 4) == nullptr, "Glyph too large"))
+		{
+			return false;
+		}
+		for (std::uint32_t uFrame(5); uFrame < 10; ++uFrame)
+		{
+			Load(tAtlas, 0x4E2D, uFrame);
+			Load(tAtlas, 'W', uFrame);
+		}
+		return Expect(tFixture.mapCalls[0x4E2D] == 1 &&
+						  tFixture.mapCalls['W'] == 1,
+					  "Missing glyph retried") &&
+			Expect(tAtlas.GetNumGlyphs() == 2 &&
+					   tAtlas.GetNumEvictions() == 0 &&
+					   tAtlas.FindGlyph('A') != nullptr,
+				   "Glyph too large evicted others");
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Fields of 12 to 16 texels and a texel apart fit at most four to a row
+	// of a 64 texel atlas, so it holds no more than sixteen glyphs. Two
+	// glyphs looked up every frame must outlive the hundred streamed past
+	// them, keeping their texels as they are repacked.
+	bool TestEviction()
+	{
+		const std::uint32_t uFirstStreamed(0x100);
+		const std::uint32_t uNumStreamed(100);
+
+		Fixture tFixture;
+		tFixture.mapSizes['A'] = 8;
+		tFixture.mapSizes['B'] = 6;
+		for (std::uint32_t uIdx(0); uIdx < uNumStreamed; ++uIdx)
+		{
+			tFixture.mapSizes[uFirstStreamed + uIdx] = 4 + uIdx % 5;
+		}
+		IOEGlyphAtlas tAtlas(tFixture.CreateRasteriser(), 64, 64);
+
+		// Each Update replaces the glyphs, so A is found again after B
+		Load(tAtlas, 'A', 1);
+		const IOEAtlasGlyph *pB(Load(tAtlas, 'B', 1));
+		const IOEAtlasGlyph *pA(tAtlas.FindGlyph('A'));
+		if (!Expect(pA != nullptr && pB != nullptr, "Kept glyphs not loaded"))
+		{
+			return false;
+		}
+		const std::vector<std::uint8_t> arrTexelsA(GetTexels(tAtlas, *pA));
+		const std::vector<std::uint8_t> arrTexelsB(GetTexels(tAtlas, *pB));
+
+		std::uint32_t uFrame(2);
+		for (std::uint32_t uIdx(0); uIdx < uNumStreamed; ++uIdx, ++uFrame)
+		{
+			tAtlas.Update(uFrame);
+			pA = tAtlas.FindGlyph('A');
+			pB = tAtlas.FindGlyph('B');
+			if (pA == nullptr || pB == nullptr ||
+				GetTexels(tAtlas, *pA) != arrTexelsA ||
+				GetTexels(tAtlas, *pB) != arrTexelsB)
+			{
+				std::printf("Eviction: kept glyph lost at frame %u\n", uFrame);
+				return false;
+			}
+
+			tAtlas.FindGlyph(uFirstStreamed + uIdx);
+			tAtlas.Flush();
+		}
+		tAtlas.Update(uFrame);
+
+		// The newest glyph made it in, and everything loaded was placed
+		// or evicted
+		const std::uint32_t uNumEvictions(tAtlas.GetNumEvictions());
+		const bool bPassed(
+			tAtlas.FindGlyph(uFirstStreamed + uNumStreamed - 1) != nullptr &&
+			tAtlas.GetNumGlyphs() <= 16 &&
+			tAtlas.GetNumGlyphs() + uNumEvictions == uNumStreamed + 2 &&
+			tFixture.mapCalls.size() == uNumStreamed + 2);
+		if (!bPassed)
+		{
+			std::printf("Eviction: %u glyphs, %u evictions\n",
+						tAtlas.GetNumGlyphs(), uNumEvictions);
+		}
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool ExpectDecode(const std::string &szData,
+					  const std::vector<std::uint32_t> &rarrExpected)
+	{
+		std::vector<std::uint32_t> arrDecoded;
+		size_t uIdx(0);
+		while (uIdx < szData.size())
+		{
+			arrDecoded.push_back(DecodeUTF8(szData, uIdx));
+		}
+		if (arrDecoded != rarrExpected)
+		{
+			std::printf("Decode:");
+			for (std::uint32_t uCodePoint : arrDecoded)
+			{
+				std::printf(" U+%04X", uCodePoint);
+			}
+			std::printf("\n");
+			return false;
+		}
+		return true;
+	}
+
+	bool TestUTF8()
+	{
+		// Every length of sequence, up to the last code point there is
+		if (!ExpectDecode("A\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80",
+						  {'A', 0xE9, 0x20AC, 0x1F600}) ||
+			!ExpectDecode("\xC2\x80\xE0\xA0\x80\xF0\x90\x80\x80"
+						  "\xF4\x8F\xBF\xBF",
+						  {0x80, 0x800, 0x10000, 0x10FFFF}))
+		{
+			return false;
+		}
+
+		// Overlong forms, surrogates, past the last plane and invalid lead
+		// bytes are one replacement each
+		if (!ExpectDecode("\xC0\xAF\xE0\x80\xAF\xF0\x80\x80\xAF",
+						  {0xFFFD, 0xFFFD, 0xFFFD}) ||
+			!ExpectDecode("\xED\xA0\x80\xF4\x90\x80\x80",
+						  {0xFFFD, 0xFFFD}) ||
+			!ExpectDecode("\x80\xF8" "A", {0xFFFD, 0xFFFD, 'A'}))
+		{
+			return false;
+		}
+
+		// A sequence cut short keeps the byte that cut it
+		return ExpectDecode("\xE2\x82" "A", {0xFFFD, 'A'}) &&
+			ExpectDecode("A\xF0\x9F", {'A', 0xFFFD});
+	}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	bool bPassed(TestPacker() && TestDistanceField() && TestMissing() &&
+				 TestEviction() && TestUTF8());
+
+	std::mt19937 tRandom(0xA71A5);
+	for (std::uint32_t uTrial(0); uTrial < 20 && bPassed; ++uTrial)
+	{
+		bPassed = TestPackerRandom(tRandom);
+	}
+
+	std::printf("%s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
@@ -0,0 +1,423 @@
+// Checks the instancing path on the Null platform: subsets repeating an
+// earlier subset's geometry up to a translation, within the shape
+// tolerance and with the same textures, share it as their shape, however
+// far they are moved, and anything else makes a shape of its own. The
+// batcher then groups the visible subsets of each model by shape into
+// contiguous instance ranges, and draws each range with one call.
+//
+// Takes the media directory as its first argument, ../../Media otherwise.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include <IOE/IOECore/IOEManagerContainer.h>
+#include <IOE/IOEMaths/Matrix.h>
+#include <IOE/IOERenderer/IOEInstanceBatcher.h>
+#include <IOE/IOERenderer/IOEModel.h>
+#include <IOE/IOERenderer/IOEModelManager.h>
+#include <IOE/IOERenderer/IOERPI.h>
+#include <IOE/IOERenderer/IOETexture.h>
+#include <IOE/IOERenderer/IOEVisibilityBounds.h>
+
+#include "../Common/HeadlessRPI.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Renderer;
+
+	typedef std::vector<std::shared_ptr<IOETexture> > TextureSet;
+
+	// Corners of the quad every subset is made from, away from whole
+	// numbers so that moving it far rounds every one of them
+	const float g_arrCorners[4][2] = {
+		{0.3f, 0.1f}, {1.7f, 0.1f}, {1.7f, 1.3f}, {0.3f, 1.3f}};
+
+	bool Expect(bool bPassed, const char *szCase)
+	{
+		if (!bPassed)
+		{
+			std::printf("%s\n", szCase);
+		}
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Geometry of one model, built a quad at a time
+	class QuadBuilder
+	{
+	public:
+		// Adds the quad scaled by fScale then moved to fX, fY, fZ, returning
+		// its first vertex so that the caller can alter it
+		ModelVertex *Add(float fX, float fY, float fZ,
+						 const TextureSet &arrTextures = TextureSet(),
+						 bool bReversed = false, float fScale = 1.0f)
+		{
+			const std::int32_t nFirst(
+				static_cast<std::int32_t>(m_arrVertices.size()));
+			for (std::int32_t nCorner(0); nCorner < 4; ++nCorner)
+			{
+				ModelVertex tVertex;
+				tVertex.m_vPosition =
+					XMFLOAT4(fX + g_arrCorners[nCorner][0] * fScale,
+							 fY + g_arrCorners[nCorner][1] * fScale, fZ, 1.0f);
+				tVertex.m_vNormal = XMFLOAT4(0.0f, 0.0f, -1.0f, 0.0f);
+				tVertex.m_vUV	 = XMFLOAT2(g_arrCorners[nCorner][0],
+											g_arrCorners[nCorner][1]);
+				m_arrVertices.push_back(tVertex);
+			}
+
+			const std::int32_t arrFront[6] = {0, 1, 2, 0, 2, 3};
+			const std::int32_t arrBack[6]  = {0, 2, 1, 0, 3, 2};
+			MeshIndex tSubset(static_cast<std::int32_t>(m_arrIndices.size()),
+							  6);
+			for (std::int32_t nIdx(0); nIdx < 6; ++nIdx)
+			{
+				m_arrIndices.push_back(
+					nFirst + (bReversed ? arrBack[nIdx] : arrFront[nIdx]));
+			}
+			tSubset.m_arrTextures = arrTextures;
+			m_arrSubsets.push_back(tSubset);
+			return &m_arrVertices[nFirst];
+		}
+
+		std::shared_ptr<IOEModel>
+		Load(IOERPI &rRPI, const std::shared_ptr<IOEMaterial> &pMaterial)
+		{
+			// Bounds are taken from the vertices once they are final
+			for (MeshIndex &rSubset : m_arrSubsets)
+			{
+				const std::int32_t nFirst(m_arrIndices[rSubset.m_nStartIdx]);
+				IOE::Maths::IOEVector vMin(m_arrVertices[nFirst].m_vPosition);
+				IOE::Maths::IOEVector vMax(vMin);
+				for (std::int32_t nVertex(nFirst + 1); nVertex < nFirst + 4;
+					 ++nVertex)
+				{
+					const IOE::Maths::IOEVector vPosition(
+						m_arrVertices[nVertex].m_vPosition);
+					vMin = IOE::Maths::IOEVector::Min(vMin, vPosition);
+					vMax = IOE::Maths::IOEVector::Max(vMax, vPosition);
+				}
+				rSubset.SetAABB(vMin, vMax);
+			}
+
+			std::shared_ptr<IOEModel> pModel(
+				std::make_shared<IOEModel>(L"Quads", ""));
+			if (!pModel->Load(m_arrVertices, m_arrIndices, m_arrSubsets))
+			{
+				return nullptr;
+			}
+			pModel->SetMaterial(&rRPI, pMaterial);
+			return IOEModelManager::GetSingletonPtr()->AddModel(pModel);
+		}
+
+	private:
+		std::vector<ModelVertex> m_arrVertices;
+		std::vector<std::int32_t> m_arrIndices;
+		std::vector<MeshIndex> m_arrSubsets;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Subsets of the first model, and the shape each should share
+	namespace ESubset
+	{
+		enum Enum
+		{
+			Shape,
+			Moved,
+			FarAway,
+			WithinTolerance,
+			PastTolerance,
+			OtherNormal,
+			OtherUV,
+			OtherWinding,
+			Scaled,
+			Textured,
+			SameTextures,
+			OtherTextures,
+			NumSubsets
+		};
+	} // namespace ESubset
+
+	const std::uint32_t g_arrExpectedShapes[ESubset::NumSubsets] = {
+		ESubset::Shape,		   ESubset::Shape,
+		ESubset::Shape,		   ESubset::Shape,
+		ESubset::PastTolerance, ESubset::OtherNormal,
+		ESubset::OtherUV,	   ESubset::OtherWinding,
+		ESubset::Scaled,	   ESubset::Textured,
+		ESubset::Textured,	   ESubset::OtherTextures};
+	const std::uint32_t g_uNumShapes = 8;
+
+	std::shared_ptr<IOETexture> CreateTexture()
+	{
+		std::shared_ptr<IOETexture> pTexture(std::make_shared<IOETexture>(
+			ETextureFormat::R8G8B8A8_UNORM, 4.0f, 4.0f));
+		pTexture->Setup();
+		return pTexture;
+	}
+
+	std::shared_ptr<IOEModel>
+	LoadRepeats(IOERPI &rRPI, const std::shared_ptr<IOEMaterial> &pMaterial)
+	{
+		const TextureSet arrFirst(1, CreateTexture());
+		const TextureSet arrSecond(1, CreateTexture());
+
+		QuadBuilder tBuilder;
+		tBuilder.Add(0.0f, 0.0f, 0.0f);
+		tBuilder.Add(10.0f, 0.0f, 0.0f);
+		tBuilder.Add(100000.0f, 50.0f, -100000.0f);
+
+		// Positions a little off the translation, within and past the
+		// tolerance of about 1e-5 of their magnitude
+		tBuilder.Add(3.0f, 0.0f, 0.0f)[2].m_vPosition.x += 2e-5f;
+		tBuilder.Add(3.0f, 0.0f, 0.0f)[2].m_vPosition.x += 1e-3f;
+
+		tBuilder.Add(20.0f, 0.0f, 0.0f)[1].m_vNormal.z = 1.0f;
+		tBuilder.Add(30.0f, 0.0f, 0.0f)[3].m_vUV.x = 0.5f;
+		tBuilder.Add(40.0f, 0.0f, 0.0f, TextureSet(), true);
+		tBuilder.Add(50.0f, 0.0f, 0.0f, TextureSet(), false, 2.0f);
+
+		tBuilder.Add(60.0f, 0.0f, 0.0f, arrFirst);
+		tBuilder.Add(70.0f, 0.0f, 0.0f, arrFirst);
+		tBuilder.Add(80.0f, 0.0f, 0.0f, arrSecond);
+		return tBuilder.Load(rRPI, pMaterial);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestShapes(const IOEModel &rModel)
+	{
+		bool bPassed(Expect(rModel.GetNumSubsetShapes() == g_uNumShapes,
+							"Number of shapes"));
+		for (std::int32_t nSubset(0); nSubset < ESubset::NumSubsets;
+			 ++nSubset)
+		{
+			if (rModel.GetSubsetShape(nSubset) != g_arrExpectedShapes[nSubset])
+			{
+				std::printf("Subset %d has shape %u, expected %u\n", nSubset,
+							rModel.GetSubsetShape(nSubset),
+							g_arrExpectedShapes[nSubset]);
+				bPassed = false;
+			}
+		}
+
+		// Offsets are from the shape's vertices, so a shape has none. The
+		// far one is only as exact as floats are at 100000.
+		const float *pShape(rModel.GetSubsetShapeOffset(ESubset::Shape));
+		const float *pMoved(rModel.GetSubsetShapeOffset(ESubset::Moved));
+		const float *pFar(rModel.GetSubsetShapeOffset(ESubset::FarAway));
+		bPassed &= Expect(pShape[0] == 0.0f && pShape[1] == 0.0f &&
+							  pShape[2] == 0.0f,
+						  "Shape offset from itself");
+		bPassed &= Expect(pMoved[0] == 10.0f && pMoved[1] == 0.0f &&
+							  pMoved[2] == 0.0f,
+						  "Moved offset");
+		bPassed &= Expect(std::fabs(pFar[0] - 100000.0f) < 0.02f &&
+							  std::fabs(pFar[1] - 50.0f) < 0.02f &&
+							  std::fabs(pFar[2] + 100000.0f) < 0.02f,
+						  "Far away offset");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool ExpectBatch(const IOEInstanceBatch &rBatch, const IOEModel *pModel,
+					 std::uint32_t uSubset, std::uint32_t uFirstInstance,
+					 std::uint32_t uNumInstances, const char *szCase)
+	{
+		return Expect(rBatch.pModel == pModel && rBatch.uSubset == uSubset &&
+						  rBatch.uFirstInstance == uFirstInstance &&
+						  rBatch.uNumInstances == uNumInstances,
+					  szCase);
+	}
+
+	// Instances hold the translation to their subset, and its inverse
+	// transpose, as the material system stores matrices
+	bool ExpectInstance(const IOEInstanceData &rInstance, const float *pOffset)
+	{
+		const IOE::Maths::IOEMatrix mWorld(IOE::Maths::IOEMatrix::Translation(
+			IOE::Maths::IOEVector(pOffset[0], pOffset[1], pOffset[2])));
+		IOE::Maths::IOEMatrix mInvXPose(mWorld.Inverse());
+		mInvXPose.TransposeSet();
+
+		float arrWorld[16], arrInvXPose[16];
+		mWorld.Get(arrWorld[0], arrWorld[1], arrWorld[2], arrWorld[3],
+				   arrWorld[4], arrWorld[5], arrWorld[6], arrWorld[7],
+				   arrWorld[8], arrWorld[9], arrWorld[10], arrWorld[11],
+				   arrWorld[12], arrWorld[13], arrWorld[14], arrWorld[15]);
+		mInvXPose.Get(arrInvXPose[0], arrInvXPose[1], arrInvXPose[2],
+					  arrInvXPose[3], arrInvXPose[4], arrInvXPose[5],
+					  arrInvXPose[6], arrInvXPose[7], arrInvXPose[8],
+					  arrInvXPose[9], arrInvXPose[10], arrInvXPose[11],
+					  arrInvXPose[12], arrInvXPose[13], arrInvXPose[14],
+					  arrInvXPose[15]);
+
+		bool bEqual(true);
+		for (std::uint32_t uIdx(0); uIdx < 16; ++uIdx)
+		{
+			bEqual &= rInstance.arrWorld[uIdx] == arrWorld[uIdx] &&
+					  rInstance.arrWorldInvTranspose[uIdx] ==
+						  arrInvXPose[uIdx];
+		}
+		return bEqual;
+	}
+
+	bool TestBatches(const IOEModel &rRepeats, const IOEModel &rPair)
+	{
+		// Everything is in front of this plane
+		IOEVisibilityBounds tBounds;
+		tBounds.UpdateVisibility(IOE::Maths::IOEVector(-1e6f, 0.0f, 0.0f),
+								 IOE::Maths::IOEVector(1.0f, 0.0f, 0.0f));
+
+		IOEInstanceBatcher tBatcher;
+		tBatcher.Build(tBounds);
+
+		// The pair was added first, so its copies of its one shape come
+		// before a batch per shape of the repeats, in shape order. Both
+		// start with a batch of subset 0, which must stay apart.
+		bool bPassed(Expect(tBatcher.GetNumBatches() == g_uNumShapes + 1,
+							"Number of batches"));
+		bPassed &= Expect(tBatcher.GetNumInstances() == ESubset::NumSubsets + 2,
+						  "Number of instances");
+		bPassed &= Expect(tBatcher.GetStats().uDrawsBefore ==
+								  ESubset::NumSubsets + 2 &&
+							  tBatcher.GetStats().uDrawsAfter ==
+								  g_uNumShapes + 1,
+						  "Draw counts");
+		if (!bPassed)
+		{
+			return false;
+		}
+
+		bPassed &= ExpectBatch(tBatcher.GetBatch(0), &rPair, 0, 0, 2,
+							   "Batch of the pair");
+		bPassed &= ExpectBatch(tBatcher.GetBatch(1), &rRepeats, ESubset::Shape,
+							   2, 4, "Batch of the repeated shape");
+		bPassed &= ExpectBatch(tBatcher.GetBatch(2), &rRepeats,
+							   ESubset::PastTolerance, 6, 1,
+							   "Batch past the tolerance");
+		bPassed &= ExpectBatch(tBatcher.GetBatch(7), &rRepeats,
+							   ESubset::Textured, 11, 2,
+							   "Batch of the textured shape");
+		bPassed &= ExpectBatch(tBatcher.GetBatch(8), &rRepeats,
+							   ESubset::OtherTextures, 13, 1,
+							   "Batch of the other texture set");
+
+		// Instances of a batch run in subset order
+		bPassed &= Expect(ExpectInstance(tBatcher.GetInstance(1),
+										 rPair.GetSubsetShapeOffset(1)),
+						  "Pair's instance transform");
+		const std::uint32_t arrShapeSubsets[4] = {
+			ESubset::Shape, ESubset::Moved, ESubset::FarAway,
+			ESubset::WithinTolerance};
+		for (std::uint32_t uIdx(0); uIdx < 4; ++uIdx)
+		{
+			bPassed &= Expect(
+				ExpectInstance(tBatcher.GetInstance(2 + uIdx),
+							   rRepeats.GetSubsetShapeOffset(
+								   arrShapeSubsets[uIdx])),
+				"Instance transform");
+		}
+
+		// The shape itself hidden, its copies are still drawn from it
+		tBounds.UpdateVisibility(IOE::Maths::IOEVector(5.0f, 0.0f, 0.0f),
+								 IOE::Maths::IOEVector(1.0f, 0.0f, 0.0f));
+		tBatcher.Build(tBounds);
+		bPassed &= ExpectBatch(tBatcher.GetBatch(1), &rRepeats, ESubset::Shape,
+							   2, 2, "Copies of a hidden shape");
+		bPassed &= Expect(
+			ExpectInstance(tBatcher.GetInstance(2),
+						   rRepeats.GetSubsetShapeOffset(ESubset::Moved)),
+			"First copy of a hidden shape");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestExecute(IOERPI &rRPI)
+	{
+		IOEVisibilityBounds tBounds;
+		tBounds.UpdateVisibility(IOE::Maths::IOEVector(-1e6f, 0.0f, 0.0f),
+								 IOE::Maths::IOEVector(1.0f, 0.0f, 0.0f));
+		IOEInstanceBatcher tBatcher;
+		tBatcher.Build(tBounds);
+
+		IOERPICommandStream &rStream(UnitTests::GetCommandStream(rRPI));
+		rRPI.OnPreRender(&rRPI);
+		rStream.Reset();
+		rStream.SetRecordCommands(true);
+		tBatcher.Execute(&rRPI);
+		rStream.SetRecordCommands(false);
+
+		// Each batch is one draw of its own instance count
+		std::uint32_t uBatch(0);
+		bool bPassed(true);
+		for (std::uint32_t uIdx(0); uIdx < rStream.GetNumCommands(); ++uIdx)
+		{
+			const IOERPICommand &rCommand(rStream.GetCommand(uIdx));
+			if (rCommand.eCommand != ERPICommand::DrawIndexedInstanced)
+			{
+				continue;
+			}
+			bPassed &= uBatch < tBatcher.GetNumBatches() &&
+					   rCommand.pObject == tBatcher.GetBatch(uBatch).pModel &&
+					   rCommand.uSlot ==
+						   tBatcher.GetBatch(uBatch).uNumInstances;
+			++uBatch;
+		}
+		bPassed = Expect(bPassed && uBatch == tBatcher.GetNumBatches(),
+						 "Batches drawn");
+		bPassed &= Expect(rStream.GetCount(ERPICommand::DrawIndexed) == 0,
+						  "Subsets drawn one at a time");
+		bPassed &= Expect(rStream.GetStats().uDrawnInstances ==
+							  tBatcher.GetNumInstances(),
+						  "Instances drawn");
+
+		rRPI.OnRender(&rRPI);
+		rRPI.OnPostRender(&rRPI);
+		return bPassed;
+	}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main(int nArgC, char **arrArgV)
+{
+	std::shared_ptr<IOERPI> pRPI(
+		UnitTests::CreateHeadlessRPI(UnitTests::GetMediaPath(nArgC, arrArgV)));
+
+	// Only models built in memory are added, so the manager is never
+	// initialised and no FBX manager is created
+	std::shared_ptr<IOEModelManager> pModels(
+		IOE::Core::g_arrManagers.CreateManager<IOEModelManager>());
+
+	// Any material drawing with the Null shaders will do
+	std::shared_ptr<IOEMaterial> pMaterial(std::make_shared<IOEMaterial>(
+		IOE::Core::Algorithm::JoinPath(IOE::Core::g_pEngine->GetMediaPath(),
+									   L"Materials", L"DebugDraw.ioe.xml")));
+
+	QuadBuilder tPair;
+	tPair.Add(200.0f, 0.0f, 0.0f);
+	tPair.Add(210.0f, 5.0f, 0.0f);
+	std::shared_ptr<IOEModel> pPair(tPair.Load(*pRPI, pMaterial));
+	std::shared_ptr<IOEModel> pRepeats(LoadRepeats(*pRPI, pMaterial));
+
+	bool bPassed(Expect(pRepeats != nullptr && pPair != nullptr,
+						"Models not loaded"));
+	if (bPassed)
+	{
+		bPassed &= TestShapes(*pRepeats);
+		bPassed &= TestBatches(*pRepeats, *pPair);
+		bPassed &= TestExecute(*pRPI);
+	}
+
+	std::printf("InstanceBatcherTest %s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
@@ -0,0 +1,277 @@
+// Checks the camera relative placement in IOEMaths/LargeWorld.h: offsets
+// 1e7 units from the world's centre keep float precision once rebased, the
+// batched rebase matches the scalar one, offsets follow moved positions
+// without a rebase, and a camera only recentres its origin once it strays
+// past the distance given. Ends with the rebase's throughput.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <IOE/IOEMaths/Camera.h>
+#include <IOE/IOEMaths/LargeWorld.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Maths;
+
+	// Floats are spaced a whole unit apart at 1e7
+	const double g_fFarAway			= 1e7;
+	const float g_fRecentreDistance = 1024.0f;
+
+	bool Expect(bool bPassed, const char *szCase)
+	{
+		if (!bPassed)
+		{
+			std::printf("%s\n", szCase);
+		}
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestPrecision(std::mt19937 &rRandom)
+	{
+		// Positions within a few units of a camera far from the centre,
+		// placed to the millimetre
+		std::uniform_real_distribution<double> tNear(-8.0, 8.0);
+		const IOEVectorD vCamera(g_fFarAway + 0.25, -g_fFarAway, g_fFarAway);
+
+		IOEWorldPositionArray tPositions;
+		std::vector<IOEVectorD> arrPositions;
+		for (std::uint32_t uIdx(0); uIdx < 1000; ++uIdx)
+		{
+			arrPositions.push_back(
+				vCamera + IOEVectorD(std::floor(tNear(rRandom) * 1e3) / 1e3,
+									 std::floor(tNear(rRandom) * 1e3) / 1e3,
+									 std::floor(tNear(rRandom) * 1e3) / 1e3));
+			tPositions.Add(arrPositions.back());
+		}
+
+		bool bPassed(Expect(tPositions.Rebase(vCamera), "First rebase"));
+
+		double fWorstRebased(0.0), fWorstFloat(0.0);
+		for (std::uint32_t uIdx(0); uIdx < tPositions.GetCount(); ++uIdx)
+		{
+			double fX, fY, fZ;
+			(arrPositions[uIdx] - vCamera).Get(fX, fY, fZ);
+
+			float fRebasedX, fRebasedY, fRebasedZ;
+			tPositions.GetRebased(uIdx, fRebasedX, fRebasedY, fRebasedZ);
+			fWorstRebased = std::fmax(fWorstRebased,
+									  std::fabs(fRebasedX - fX) +
+										  std::fabs(fRebasedY - fY) +
+										  std::fabs(fRebasedZ - fZ));
+
+			// What rounding the world position to float would have cost
+			double fWorldX, fWorldY, fWorldZ;
+			arrPositions[uIdx].Get(fWorldX, fWorldY, fWorldZ);
+			fWorstFloat = std::fmax(
+				fWorstFloat, std::fabs(static_cast<float>(fWorldX) - fWorldX));
+		}
+
+		std::printf("Offsets at 1e7 worst error %.2e, as world floats %.2e\n",
+					fWorstRebased, fWorstFloat);
+		bPassed &= Expect(fWorstRebased < 1e-5, "Rebased offsets imprecise");
+		bPassed &= Expect(fWorstFloat > 0.1, "World floats not imprecise");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestBatched(std::mt19937 &rRandom)
+	{
+		// Every count of whole blocks and leftovers, against the scalar sum
+		std::uniform_real_distribution<double> tWorld(-2.0 * g_fFarAway,
+													  2.0 * g_fFarAway);
+		const IOEVectorD vOrigin(tWorld(rRandom), tWorld(rRandom),
+								 tWorld(rRandom));
+		double arrOrigin[3];
+		vOrigin.Store3(arrOrigin);
+
+		bool bPassed(true);
+		for (std::size_t uCount(0); uCount <= 13; ++uCount)
+		{
+			std::vector<double> arrIn(uCount * 3);
+			for (double &rfValue : arrIn)
+			{
+				rfValue = tWorld(rRandom);
+			}
+			std::vector<float> arrOut(uCount * 3 + 1, -1.0f);
+			RebaseTranslations(vOrigin, arrIn.data(), arrIn.data() + uCount,
+							   arrIn.data() + uCount * 2, arrOut.data(),
+							   arrOut.data() + uCount,
+							   arrOut.data() + uCount * 2, uCount);
+
+			for (std::size_t uIdx(0); uIdx < uCount * 3; ++uIdx)
+			{
+				const float fExpected(static_cast<float>(
+					arrIn[uIdx] - arrOrigin[uIdx / uCount]));
+				bPassed &= Expect(arrOut[uIdx] == fExpected,
+								  "Batched rebase differs from scalar");
+			}
+			bPassed &= Expect(arrOut[uCount * 3] == -1.0f,
+							  "Batched rebase wrote past the end");
+		}
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestMoves()
+	{
+		const IOEVectorD vOrigin(g_fFarAway, 0.0, 0.0);
+
+		IOEWorldPositionArray tPositions;
+		tPositions.Add(IOEVectorD(g_fFarAway + 1.0, 2.0, 3.0));
+		bool bPassed(Expect(tPositions.Rebase(vOrigin), "First rebase"));
+		bPassed &= Expect(!tPositions.Rebase(vOrigin),
+						  "Rebase ran with the origin unchanged");
+
+		// Adding and moving update the offset against the last origin, so
+		// nothing has to rebase between frames
+		tPositions.Add(IOEVectorD(g_fFarAway - 4.5, 0.0, 1.0));
+		tPositions.Set(0, IOEVectorD(g_fFarAway + 10.0, 20.0, 30.0));
+
+		float fX, fY, fZ;
+		tPositions.GetRebased(0, fX, fY, fZ);
+		bPassed &= Expect(fX == 10.0f && fY == 20.0f && fZ == 30.0f,
+						  "Moved position not rebased");
+		tPositions.GetRebased(1, fX, fY, fZ);
+		bPassed &= Expect(fX == -4.5f && fY == 0.0f && fZ == 1.0f,
+						  "Added position not rebased");
+
+		bPassed &= Expect(tPositions.Rebase(IOEVectorD(0.0, 0.0, 0.0)),
+						  "Rebase skipped a new origin");
+		tPositions.GetRebased(1, fX, fY, fZ);
+		bPassed &= Expect(fX == static_cast<float>(g_fFarAway - 4.5),
+						  "Offset from the new origin");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOECamera MakeCamera()
+	{
+		IOECamera tCamera(IOECamera::ECameraStyle::ECS_Fixed);
+		tCamera.SetCameraProperties(IOECamera::CCameraProperties());
+		tCamera.SetWorldOrigin(IOEVectorD(g_fFarAway, 0.0, -g_fFarAway));
+		tCamera.SetUpVector(g_vUpVector);
+		return tCamera;
+	}
+
+	void MoveCamera(IOECamera &rCamera, float fX, float fZ)
+	{
+		const IOEVector vPosition(fX, 0.0f, fZ, 1.0f);
+		rCamera.GetTransform().SetTranslation(vPosition);
+		rCamera.SetLookAt(vPosition + g_vForwardVector);
+		rCamera.UpdateViewMatrices();
+	}
+
+	bool IsNear(const IOEVectorD &vA, const IOEVectorD &vB, double fTolerance)
+	{
+		double fX, fY, fZ;
+		(vA - vB).Get(fX, fY, fZ);
+		return std::fabs(fX) <= fTolerance && std::fabs(fY) <= fTolerance &&
+			   std::fabs(fZ) <= fTolerance;
+	}
+
+	bool TestRecentre()
+	{
+		IOECamera tCamera(MakeCamera());
+		const IOEVectorD vStart(tCamera.GetWorldOrigin());
+
+		// Within the distance the origin stays, however often it is asked
+		bool bPassed(true);
+		for (float fX(0.0f); fX <= g_fRecentreDistance * 0.9f; fX += 100.0f)
+		{
+			MoveCamera(tCamera, fX, -fX * 0.5f);
+			bPassed &= Expect(!tCamera.RecentreWorldOrigin(g_fRecentreDistance),
+							  "Recentred within the distance");
+		}
+		bPassed &= Expect(IsNear(tCamera.GetWorldOrigin(), vStart, 0.0),
+						  "Origin moved within the distance");
+
+		// Past it the origin jumps onto the camera, which stays put in the
+		// world
+		MoveCamera(tCamera, 1500.0f, 250.0f);
+		const IOEVectorD vWorld(tCamera.GetWorldPosition());
+		IOEVector vShift(g_vZeroVector);
+		bPassed &= Expect(
+			tCamera.RecentreWorldOrigin(g_fRecentreDistance, &vShift),
+			"Not recentred past the distance");
+		bPassed &= Expect(IsNear(tCamera.GetWorldPosition(), vWorld, 1e-3),
+						  "Recentring moved the camera");
+		bPassed &=
+			Expect(IsNear(tCamera.GetWorldOrigin(),
+						  vStart + IOEVectorD(1500.0, 0.0, 250.0), 1e-3),
+				   "Origin not moved onto the camera");
+		bPassed &= Expect(std::fabs(vShift.GetX() - 1500.0f) < 1e-3f &&
+							  std::fabs(vShift.GetZ() - 250.0f) < 1e-3f,
+						  "Shift reported");
+
+		// The hysteresis: moving back most of the way does not recentre
+		// again, so a camera hovering near the threshold does not thrash
+		const IOEVectorD vRecentred(tCamera.GetWorldOrigin());
+		MoveCamera(tCamera, -1000.0f, 0.0f);
+		bPassed &= Expect(!tCamera.RecentreWorldOrigin(g_fRecentreDistance),
+						  "Recentred again moving back");
+		bPassed &= Expect(IsNear(tCamera.GetWorldOrigin(), vRecentred, 0.0),
+						  "Origin moved moving back");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	void Benchmark(std::mt19937 &rRandom)
+	{
+		const std::uint32_t uCount(1 << 16);
+		const std::uint32_t uRepeats(200);
+
+		std::uniform_real_distribution<double> tWorld(-g_fFarAway,
+													  g_fFarAway);
+		IOEWorldPositionArray tPositions;
+		for (std::uint32_t uIdx(0); uIdx < uCount; ++uIdx)
+		{
+			tPositions.Add(
+				IOEVectorD(tWorld(rRandom), tWorld(rRandom), tWorld(rRandom)));
+		}
+
+		// Alternate origins so that every pass runs
+		const auto tStart(std::chrono::steady_clock::now());
+		for (std::uint32_t uRepeat(0); uRepeat < uRepeats; ++uRepeat)
+		{
+			tPositions.Rebase(IOEVectorD(static_cast<double>(uRepeat & 1),
+										 0.0, 0.0));
+		}
+		const std::chrono::duration<double> tElapsed(
+			std::chrono::steady_clock::now() - tStart);
+
+		std::printf("Rebasing %u positions takes %.3f ms (AVX %s)\n", uCount,
+					tElapsed.count() * 1e3 / uRepeats,
+					IsAVXSupported() ? "available" : "not available");
+	}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	std::mt19937 tRandom(30);
+
+	bool bPassed(TestPrecision(tRandom));
+	bPassed = TestBatched(tRandom) && bPassed;
+	bPassed = TestMoves() && bPassed;
+	bPassed = TestRecentre() && bPassed;
+
+	Benchmark(tRandom);
+
+	std::printf("%s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+// Checks IOEMaterialTemplate on the Null platform: axes are packed into the
+// smallest bit fields that hold their states, masks outside of them are
+// refused, each variant is compiled once with the definitions of its axis
+// states, and asking for it again finds the same material.
+//
+// Takes the media directory as its first argument, ../../Media otherwise.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <IOE/IOEExceptions/IOEException_Renderer.h>
+#include <IOE/IOERenderer/IOEMaterialTemplate.h>
+#include <IOE/IOERenderer/IOERPI.h>
+#include <IOE/IOERenderer/IOEShader.h>
+#include <IOE/IOERenderer/IOEShaderCache.h>
+
+#include "../Common/HeadlessRPI.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Renderer;
+
+	// Written to and removed from the working directory
+	const char *g_szTemplate = "MaterialTemplateTest.ioe.xml";
+
+	// Four states and off take three bits, the boolean one, and five taps
+	// and off three, leaving states 6 and 7 of TAPS unused
+	const char g_szTemplateXML[] =
+		"<ioe><material name=\"Permuted\">"
+		"<permutation name=\"QUALITY\" values=\"Low,Medium,High,Ultra\"/>"
+		"<permutation name=\"SHADOWS\"/>"
+		"<permutation name=\"TAPS\" values=\"1,2,3,4,5\"/>"
+		"<shader platform=\"Null\" type=\"Fragment\" version=\"ps_5_0\" "
+		"entry=\"main\">Shaders\\Debug\\DebugDraw.ps.hlsl</shader>"
+		"</material></ioe>";
+
+	bool Expect(bool bPassed, const char *szCase)
+	{
+		if (!bPassed)
+		{
+			std::printf("%s\n", szCase);
+		}
+		return bPassed;
+	}
+
+	// Whether tFunc threw the renderer's exception
+	template <typename TFunc>
+	bool Throws(TFunc tFunc)
+	{
+		try
+		{
+			tFunc();
+		}
+		catch (const IOE::Exceptions::IOERendererException &)
+		{
+			return true;
+		}
+		return false;
+	}
+
+	// Whether the cache holds the fragment shader compiled with arrMacros,
+	// which are the definitions a variant has to have been given
+	bool IsCompiled(IOERPI &rRPI,
+					const std::vector<IOEShaderMacroDefinition> &arrMacros)
+	{
+		IOEShaderCompilationOptions tOptions;
+		tOptions.szPath		  = L"Shaders\\Debug\\DebugDraw.ps.hlsl";
+		tOptions.szProfile	= "ps_5_0";
+		tOptions.szEntryPoint = "main";
+		tOptions.eShaderType  = EShaderType::Fragment;
+		tOptions.pMacros	  = &arrMacros;
+
+		IOEShaderCache &rCache(rRPI.GetShaderCache());
+		IOEShader tCompiler;
+		return rCache.Find(rCache.CalculateKey(
+				   tOptions, tCompiler.GetPlatform())) != nullptr;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestPacking(const IOEMaterialTemplate &rTemplate)
+	{
+		bool bPassed(Expect(rTemplate.GetPermutation("QUALITY", "Low") == 1 &&
+								rTemplate.GetPermutation("QUALITY", "Ultra") ==
+									4,
+							"QUALITY not in bits 0-2"));
+		bPassed &= Expect(rTemplate.GetPermutation("SHADOWS") == 1 << 3,
+						  "SHADOWS not in bit 3");
+		bPassed &= Expect(rTemplate.GetPermutation("TAPS", "1") == 1 << 4 &&
+							  rTemplate.GetPermutation("TAPS", "5") == 5 << 4,
+						  "TAPS not in bits 4-6");
+
+		bPassed &= Expect(Throws([&]() { rTemplate.GetPermutation("LOD"); }),
+						  "Unknown axis accepted");
+		bPassed &= Expect(
+			Throws([&]() { rTemplate.GetPermutation("QUALITY", "Extreme"); }),
+			"Unknown value accepted");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestVariants(IOERPI &rRPI, IOEMaterialTemplate &rTemplate)
+	{
+		const IOEShaderCache &rCache(rRPI.GetShaderCache());
+
+		const std::uint64_t uPermutation(
+			rTemplate.GetPermutation("QUALITY", "Medium") |
+			rTemplate.GetPermutation("TAPS", "4"));
+		const std::uint32_t uNumCompiles(rCache.GetNumCompiles());
+		std::shared_ptr<IOEMaterial> pVariant(
+			rTemplate.GetVariant(uPermutation));
+
+		bool bPassed(Expect(rCache.GetNumCompiles() == uNumCompiles + 1,
+							"Variant not compiled"));
+		bPassed &= Expect(rTemplate.GetVariant(uPermutation) == pVariant &&
+							  rCache.GetNumCompiles() == uNumCompiles + 1,
+						  "Variant compiled again");
+
+		// The template's own definitions come first, then the axes in the
+		// order they were declared, leaving out SHADOWS as it is off
+		std::vector<IOEShaderMacroDefinition> arrMacros;
+		arrMacros.emplace_back("TEMPLATE", "1");
+#if (IOE_SHADER_DEBUG == IOE_ON)
+		arrMacros.emplace_back("IOE_DEBUG", "1");
+#endif
+		std::vector<IOEShaderMacroDefinition> arrNone(arrMacros);
+		arrMacros.emplace_back("QUALITY", "Medium");
+		arrMacros.emplace_back("TAPS", "4");
+		bPassed &= Expect(IsCompiled(rRPI, arrMacros), "Variant definitions");
+
+		// Mask zero defines no axis, and is a variant of its own
+		std::shared_ptr<IOEMaterial> pNone(rTemplate.GetVariant(0));
+		bPassed &= Expect(pNone != pVariant && IsCompiled(rRPI, arrNone),
+						  "Mask zero variant");
+
+		arrMacros.insert(arrMacros.end() - 1,
+						 IOEShaderMacroDefinition("SHADOWS", "1"));
+		std::shared_ptr<IOEMaterial> pShadows(rTemplate.GetVariant(
+			uPermutation | rTemplate.GetPermutation("SHADOWS")));
+		bPassed &= Expect(pShadows != pVariant && IsCompiled(rRPI, arrMacros),
+						  "Boolean axis definition");
+		bPassed &=
+			Expect(rTemplate.GetNumVariants() == 3, "Number of variants");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestRefused(IOEMaterialTemplate &rTemplate)
+	{
+		const std::size_t uNumVariants(rTemplate.GetNumVariants());
+
+		// A bit past the last axis, and TAPS in a state it does not have
+		bool bPassed(Expect(Throws([&]() { rTemplate.GetVariant(1 << 7); }),
+							"Stray bit accepted"));
+		bPassed &= Expect(Throws([&]() { rTemplate.GetVariant(6 << 4); }),
+						  "Unused state accepted");
+		bPassed &= Expect(rTemplate.GetNumVariants() == uNumVariants,
+						  "Refused variants kept");
+		return bPassed;
+	}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main(int nArgC, char **arrArgV)
+{
+	std::shared_ptr<IOERPI> pRPI(
+		UnitTests::CreateHeadlessRPI(UnitTests::GetMediaPath(nArgC, arrArgV)));
+
+	// Kept for this run only, so the cache file is left alone
+	pRPI->GetShaderCache().Setup(IOE::Core::g_pEngine->GetMediaPath(), L"");
+
+	{
+		std::ofstream tStream(g_szTemplate, std::ios::out | std::ios::binary);
+		tStream << g_szTemplateXML;
+	}
+	IOEMaterialTemplate tTemplate;
+	tTemplate.AddDefinition("TEMPLATE", "1");
+	tTemplate.LoadTemplate(
+		std::wstring(g_szTemplate, g_szTemplate + std::strlen(g_szTemplate)));
+	std::remove(g_szTemplate);
+
+	bool bPassed(true);
+	bPassed &= TestPacking(tTemplate);
+	bPassed &= TestVariants(*pRPI, tTemplate);
+	bPassed &= TestRefused(tTemplate);
+
+	std::printf("MaterialTemplateTest %s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
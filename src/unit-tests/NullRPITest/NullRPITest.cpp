@@ -0,0 +1,184 @@
+// Runs the RPI and the debug draw material headless on the Null platform,
+// and checks what reaches the recorded command stream: what loading creates,
+// what a frame records, and that binding what is already bound is dropped
+// before it gets to the platform.
+//
+// Takes the media directory as its first argument, ../../Media otherwise.
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+#include <IOE/IOERenderer/IOEMaterial.h>
+#include <IOE/IOERenderer/IOERPI.h>
+
+#include "../Common/HeadlessRPI.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Renderer;
+
+	bool Expect(bool bPassed, const char *szCase)
+	{
+		if (!bPassed)
+		{
+			std::printf("%s\n", szCase);
+		}
+		return bPassed;
+	}
+
+	bool ExpectCount(const IOERPICommandStream &rStream,
+					 ERPICommand::Enum eCommand, std::uint32_t uCount,
+					 const char *szCase)
+	{
+		const std::uint32_t uRecorded(rStream.GetCount(eCommand));
+		if (uRecorded != uCount)
+		{
+			std::printf("%s: %u %s, expected %u\n", szCase, uRecorded,
+						ERPICommand::ToName(eCommand), uCount);
+			return false;
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestLoad(IOERPI &rRPI)
+	{
+		const IOERPICommandStream &rStream(UnitTests::GetCommandStream(rRPI));
+
+		// The default states, targets and the debug draw material's shaders
+		// are made once the managers are initialised
+		bool bPassed(true);
+		bPassed &= Expect(rStream.GetCount(ERPICommand::CreateState) > 0,
+						  "No states created");
+		bPassed &= Expect(rStream.GetCount(ERPICommand::CreateTexture) > 0,
+						  "No targets created");
+		bPassed &= ExpectCount(rStream, ERPICommand::CreateShader, 2,
+							   "Debug draw shaders");
+
+		const IOEMaterial *pMaterial(rRPI.GetDebugDrawMaterial());
+		bPassed &= Expect(pMaterial != nullptr &&
+							  pMaterial->HasShader(EShaderType::Vertex) &&
+							  pMaterial->HasShader(EShaderType::Fragment),
+						  "Debug draw material has no Null shaders");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestMaterial(IOERPI &rRPI)
+	{
+		IOERPICommandStream &rStream(UnitTests::GetCommandStream(rRPI));
+		IOEMaterial *pMaterial(rRPI.GetDebugDrawMaterial());
+
+		// The material binds the frame's viewports, so start one
+		rRPI.OnPreRender(&rRPI);
+
+		rStream.Reset();
+		pMaterial->Set(&rRPI);
+		bool bPassed(ExpectCount(rStream, ERPICommand::SetShader, 2,
+								 "First material set"));
+
+		// Its shaders and constants are all still bound
+		rStream.Reset();
+		pMaterial->Set(&rRPI);
+		bPassed &= ExpectCount(rStream, ERPICommand::SetShader, 0,
+							   "Second material set");
+		bPassed &= ExpectCount(rStream, ERPICommand::Upload, 0,
+							   "Second material upload");
+		bPassed &= Expect(rStream.GetNumCommands() == 0,
+						  "Second material set recorded commands");
+
+		rRPI.OnRender(&rRPI);
+		rRPI.OnPostRender(&rRPI);
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestRedundantState(IOERPI &rRPI)
+	{
+		IOERPICommandStream &rStream(UnitTests::GetCommandStream(rRPI));
+		rRPI.OnPreRender(&rRPI);
+
+		// A state set up with the same description as the RPI's interns to
+		// the same ID, so setting either is the same bind
+		IOERasterizerState tCopy(IOERasterizerState::Default());
+		tCopy.Setup(&rRPI);
+
+		const IOERPIBindStats tBefore(rRPI.GetBindStats());
+		rStream.Reset();
+		rRPI.SetRasterizerState(rRPI.GetRasterizerState());
+		rRPI.SetRasterizerState(tCopy);
+		rRPI.SetRasterizerState(rRPI.GetRasterizerState());
+
+		const IOERPIBindStats &rAfter(rRPI.GetBindStats());
+		const std::uint32_t uRequested(
+			rAfter.arrRequested[ERPIBind::RasterizerState] -
+			tBefore.arrRequested[ERPIBind::RasterizerState]);
+		const std::uint32_t uForwarded(
+			rAfter.arrForwarded[ERPIBind::RasterizerState] -
+			tBefore.arrForwarded[ERPIBind::RasterizerState]);
+
+		bool bPassed(Expect(tCopy.GetID() == rRPI.GetRasterizerState().GetID(),
+							"Equal states interned apart"));
+		bPassed &= Expect(uRequested == 3, "Rasterizer binds not counted");
+		bPassed &= ExpectCount(rStream, ERPICommand::SetRasterizerState,
+							   uForwarded, "Forwarded binds");
+
+		// The frame already bound the state, so none of these get through
+		bPassed &= ExpectCount(rStream, ERPICommand::SetRasterizerState, 0,
+							   "Rebinding the rasterizer state");
+
+		rRPI.OnRender(&rRPI);
+		rRPI.OnPostRender(&rRPI);
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestFrame(IOERPI &rRPI)
+	{
+		IOERPICommandStream &rStream(UnitTests::GetCommandStream(rRPI));
+
+		rStream.Reset();
+		rRPI.OnPreRender(&rRPI);
+		rRPI.OnRender(&rRPI);
+		rRPI.OnPostRender(&rRPI);
+
+		bool bPassed(
+			ExpectCount(rStream, ERPICommand::StartRender, 1, "Frame start"));
+		bPassed &=
+			ExpectCount(rStream, ERPICommand::FinishRender, 1, "Frame end");
+		bPassed &= ExpectCount(rStream, ERPICommand::Clear, 1, "Frame clear");
+
+		// Each frame starts from nothing bound, so the frame's own state
+		// binds reach the platform once each
+		bPassed &= ExpectCount(rStream, ERPICommand::SetRasterizerState, 1,
+							   "Frame rasterizer state");
+		bPassed &= ExpectCount(rStream, ERPICommand::SetDepthState, 1,
+							   "Frame depth state");
+		return bPassed;
+	}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main(int nArgC, char **arrArgV)
+{
+	std::shared_ptr<IOERPI> pRPI(
+		UnitTests::CreateHeadlessRPI(UnitTests::GetMediaPath(nArgC, arrArgV)));
+
+	bool bPassed(true);
+	bPassed &= TestLoad(*pRPI);
+	bPassed &= TestMaterial(*pRPI);
+	bPassed &= TestRedundantState(*pRPI);
+	bPassed &= TestFrame(*pRPI);
+
+	std::printf("NullRPITest %s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
@@ -0,0 +1,545 @@
+// Compares the software rasteriser in IOEMaths/OcclusionBuffer.h against
+// rays cast through every pixel centre, and checks that a box reported as
+// occluded has nothing of it in front of the depth buffer.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <IOE/IOEMaths/OcclusionBuffer.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Maths;
+
+	const std::uint32_t g_uNumTrials = 60;
+	const std::uint32_t g_uWidth	 = 256;
+	const std::uint32_t g_uHeight	 = 128;
+
+	// Pixel centres this close to a triangle edge, in barycentric terms,
+	// may be covered either way
+	const double g_fEdgeEpsilon = 1e-4;
+
+	// Interpolated depth against depth at the exact hit point
+	const float g_fDepthEpsilon = 1e-4f;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Camera as its world axes and projection, from which both the view
+	// projection matrix and the ray through any pixel are built
+	struct Camera
+	{
+		float arrRight[3], arrUp[3], arrForward[3], arrPos[3];
+		float fTanHalfFov, fAspect, fNear, fFar;
+		float arrViewProj[16];
+	};
+
+	float Dot(const float *pA, const float *pB)
+	{
+		return pA[0] * pB[0] + pA[1] * pB[1] + pA[2] * pB[2];
+	}
+
+	// Row-vector view * projection as IOEMatrix, left handed with a
+	// [0, 1] depth range
+	void BuildViewProjection(Camera &rCamera)
+	{
+		const float fScaleY(1.0f / rCamera.fTanHalfFov);
+		const float fScaleX(fScaleY / rCamera.fAspect);
+		const float fRange(rCamera.fFar / (rCamera.fFar - rCamera.fNear));
+		const float arrScale[4] = {fScaleX, fScaleY, fRange, 1.0f};
+		const float *arrAxes[3] = {rCamera.arrRight, rCamera.arrUp,
+								   rCamera.arrForward};
+
+		// View columns are the axes, so column c of the product is the
+		// axis scaled, with z also feeding w
+		for (std::uint32_t uRow(0); uRow < 4; ++uRow)
+		{
+			for (std::uint32_t uCol(0); uCol < 4; ++uCol)
+			{
+				const std::uint32_t uAxis(uCol == 3 ? 2 : uCol);
+				const float fView(uRow < 3
+									  ? arrAxes[uAxis][uRow]
+									  : -Dot(arrAxes[uAxis], rCamera.arrPos));
+				float fValue(fView * arrScale[uCol]);
+				if (uCol == 2 && uRow == 3)
+				{
+					fValue -= fRange * rCamera.fNear;
+				}
+				rCamera.arrViewProj[uRow * 4 + uCol] = fValue;
+			}
+		}
+	}
+
+	Camera MakeCamera(float fYaw, float fPitch, float fX, float fY, float fZ,
+					  float fFovY)
+	{
+		const float fCY(std::cos(fYaw)), fSY(std::sin(fYaw));
+		const float fCP(std::cos(fPitch)), fSP(std::sin(fPitch));
+
+		Camera tCamera = {{fCY, 0.0f, -fSY},
+						  {fSY * fSP, fCP, fCY * fSP},
+						  {fSY * fCP, -fSP, fCY * fCP},
+						  {fX, fY, fZ},
+						  std::tan(fFovY * 0.5f),
+						  static_cast<float>(g_uWidth) / g_uHeight,
+						  0.5f,
+						  500.0f,
+						  {}};
+		BuildViewProjection(tCamera);
+		return tCamera;
+	}
+
+	void Project(const Camera &rCamera, const float *pPoint, float *pClip)
+	{
+		for (std::uint32_t uCol(0); uCol < 4; ++uCol)
+		{
+			pClip[uCol] = pPoint[0] * rCamera.arrViewProj[uCol] +
+				pPoint[1] * rCamera.arrViewProj[4 + uCol] +
+				pPoint[2] * rCamera.arrViewProj[8 + uCol] +
+				rCamera.arrViewProj[12 + uCol];
+		}
+	}
+
+	// World space direction through the centre of a pixel
+	void GetRay(const Camera &rCamera, std::uint32_t uX, std::uint32_t uY,
+				double *pDir)
+	{
+		const double fNdcX((uX + 0.5) / g_uWidth * 2.0 - 1.0);
+		const double fNdcY(1.0 - (uY + 0.5) / g_uHeight * 2.0);
+		const double fDX(fNdcX * rCamera.fTanHalfFov * rCamera.fAspect);
+		const double fDY(fNdcY * rCamera.fTanHalfFov);
+		for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+		{
+			pDir[uAxis] = rCamera.arrRight[uAxis] * fDX +
+				rCamera.arrUp[uAxis] * fDY + rCamera.arrForward[uAxis];
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	struct Mesh
+	{
+		std::vector<float> arrPositions;
+		std::vector<std::int32_t> arrIndices;
+
+		void AddTriangle(const float *pA, const float *pB, const float *pC)
+		{
+			const float *arrVerts[3] = {pA, pB, pC};
+			for (const float *pVert : arrVerts)
+			{
+				arrIndices.push_back(
+					static_cast<std::int32_t>(arrPositions.size() / 3));
+				arrPositions.insert(arrPositions.end(), pVert, pVert + 3);
+			}
+		}
+
+		const float *GetVertex(std::uint32_t uIdx) const
+		{
+			return &arrPositions[arrIndices[uIdx] * 3];
+		}
+	};
+
+	// Expected depth at one pixel centre: the nearest hit in the clip
+	// depth range, or 1 when nothing is hit. Returns false when the ray
+	// passes too close to an edge to know whether it is covered.
+	bool RayCast(const Camera &rCamera, const Mesh &rMesh, std::uint32_t uX,
+				 std::uint32_t uY, float &rDepth)
+	{
+		double arrDir[3];
+		GetRay(rCamera, uX, uY, arrDir);
+
+		rDepth = 1.0f;
+		for (std::uint32_t uIdx(0); uIdx + 2 < rMesh.arrIndices.size();
+			 uIdx += 3)
+		{
+			// Moller-Trumbore in double precision
+			const float *pA(rMesh.GetVertex(uIdx));
+			const float *pB(rMesh.GetVertex(uIdx + 1));
+			const float *pC(rMesh.GetVertex(uIdx + 2));
+			double arrE1[3], arrE2[3], arrT[3];
+			for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+			{
+				arrE1[uAxis] = static_cast<double>(pB[uAxis]) - pA[uAxis];
+				arrE2[uAxis] = static_cast<double>(pC[uAxis]) - pA[uAxis];
+				arrT[uAxis] =
+					static_cast<double>(rCamera.arrPos[uAxis]) - pA[uAxis];
+			}
+			auto Cross = [](const double *pL, const double *pR, double *pOut) {
+				pOut[0] = pL[1] * pR[2] - pL[2] * pR[1];
+				pOut[1] = pL[2] * pR[0] - pL[0] * pR[2];
+				pOut[2] = pL[0] * pR[1] - pL[1] * pR[0];
+			};
+			auto DotD = [](const double *pL, const double *pR) {
+				return pL[0] * pR[0] + pL[1] * pR[1] + pL[2] * pR[2];
+			};
+
+			double arrP[3], arrQ[3];
+			Cross(arrDir, arrE2, arrP);
+			const double fDet(DotD(arrE1, arrP));
+			if (std::fabs(fDet) < 1e-12)
+			{
+				continue;
+			}
+			Cross(arrT, arrE1, arrQ);
+			const double fU(DotD(arrT, arrP) / fDet);
+			const double fV(DotD(arrDir, arrQ) / fDet);
+			const double fDist(DotD(arrE2, arrQ) / fDet);
+			const double fW(1.0 - fU - fV);
+
+			const double fEdge(std::min(fU, std::min(fV, fW)));
+			if (fEdge < -g_fEdgeEpsilon || fDist <= 0.0)
+			{
+				continue;
+			}
+
+			float arrHit[3], arrClip[4];
+			for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+			{
+				arrHit[uAxis] = static_cast<float>(
+					rCamera.arrPos[uAxis] + arrDir[uAxis] * fDist);
+			}
+			Project(rCamera, arrHit, arrClip);
+			const float fDepth(arrClip[2] / arrClip[3]);
+			if (fDepth < 0.0f || fDepth >= rDepth)
+			{
+				continue;
+			}
+			if (fEdge < g_fEdgeEpsilon ||
+				std::fabs(fDepth) < g_fDepthEpsilon)
+			{
+				return false;
+			}
+			rDepth = fDepth;
+		}
+		return true;
+	}
+
+	// Fills the buffer with the mesh as the only occluder
+	void Draw(IOEOcclusionBuffer &rBuffer, const Camera &rCamera,
+			  const Mesh &rMesh)
+	{
+		rBuffer.Begin(rCamera.arrViewProj);
+		const std::uint32_t uNumIndices(
+			static_cast<std::uint32_t>(rMesh.arrIndices.size()));
+		rBuffer.AddOccluder(rMesh.arrPositions.data(), sizeof(float) * 3,
+							rMesh.arrIndices.data(), uNumIndices);
+		rBuffer.Rasterise();
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	Camera RandomCamera(std::mt19937 &rRandom)
+	{
+		std::uniform_real_distribution<float> tAngle(-3.14159f, 3.14159f);
+		std::uniform_real_distribution<float> tPosition(-10.0f, 10.0f);
+		std::uniform_real_distribution<float> tFov(0.6f, 1.8f);
+		return MakeCamera(tAngle(rRandom), tAngle(rRandom) * 0.4f,
+						  tPosition(rRandom), tPosition(rRandom),
+						  tPosition(rRandom), tFov(rRandom));
+	}
+
+	// Triangles scattered around the camera, many crossing the near plane
+	// or the screen edges, and some large enough to need the guard band
+	Mesh RandomMesh(std::mt19937 &rRandom, const Camera &rCamera,
+					std::uint32_t uNumTriangles)
+	{
+		std::uniform_real_distribution<float> tDistance(-5.0f, 60.0f);
+		std::uniform_real_distribution<float> tSpread(-30.0f, 30.0f);
+		std::uniform_real_distribution<float> tSize(0.5f, 15.0f);
+		std::uniform_real_distribution<float> tOffset(-1.0f, 1.0f);
+
+		Mesh tMesh;
+		for (std::uint32_t uTri(0); uTri < uNumTriangles; ++uTri)
+		{
+			const float fDistance(tDistance(rRandom));
+			const float fSide(tSpread(rRandom));
+			const float fHeight(tSpread(rRandom) * 0.5f);
+			const float fSize(uTri % 8 == 0 ? 200.0f : tSize(rRandom));
+
+			float arrCentre[3];
+			for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+			{
+				arrCentre[uAxis] = rCamera.arrPos[uAxis] +
+					rCamera.arrForward[uAxis] * fDistance +
+					rCamera.arrRight[uAxis] * fSide +
+					rCamera.arrUp[uAxis] * fHeight;
+			}
+
+			float arrVerts[3][3];
+			for (float(&rVert)[3] : arrVerts)
+			{
+				for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+				{
+					rVert[uAxis] = arrCentre[uAxis] + tOffset(rRandom) * fSize;
+				}
+			}
+			tMesh.AddTriangle(arrVerts[0], arrVerts[1], arrVerts[2]);
+		}
+		return tMesh;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestRasterise(std::mt19937 &rRandom, std::uint32_t uTrial)
+	{
+		const Camera tCamera(RandomCamera(rRandom));
+		const Mesh tMesh(RandomMesh(rRandom, tCamera, 1 + uTrial % 24));
+
+		IOEOcclusionBuffer tBuffer(g_uWidth, g_uHeight);
+		Draw(tBuffer, tCamera, tMesh);
+
+		std::uint32_t uChecked(0);
+		for (std::uint32_t uY(0); uY < g_uHeight; ++uY)
+		{
+			for (std::uint32_t uX(0); uX < g_uWidth; ++uX)
+			{
+				float fExpected;
+				if (!RayCast(tCamera, tMesh, uX, uY, fExpected))
+				{
+					continue;
+				}
+				++uChecked;
+
+				const float fDepth(tBuffer.GetDepth(uX, uY));
+				if (std::fabs(fDepth - fExpected) > g_fDepthEpsilon)
+				{
+					std::printf("Rasterise trial %u pixel (%u, %u): depth %f, "
+								"expected %f\n",
+								uTrial, uX, uY, fDepth, fExpected);
+					return false;
+				}
+			}
+		}
+
+		// Nearly every pixel is far enough from an edge to be checked
+		if (uChecked < g_uWidth * g_uHeight * 9 / 10)
+		{
+			std::printf("Rasterise trial %u: only %u pixels checked\n", uTrial,
+						uChecked);
+			return false;
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Positions read with a stride and moved by an offset draw exactly as
+	// the same positions moved beforehand
+	bool TestStrideAndOffset(std::mt19937 &rRandom, std::uint32_t uTrial)
+	{
+		const Camera tCamera(RandomCamera(rRandom));
+		const Mesh tMesh(RandomMesh(rRandom, tCamera, 16));
+		const float arrOffset[3] = {2.0f, -1.0f, 3.0f};
+
+		std::vector<float> arrPadded, arrMoved;
+		for (std::size_t uIdx(0); uIdx < tMesh.arrPositions.size(); ++uIdx)
+		{
+			arrPadded.push_back(tMesh.arrPositions[uIdx]);
+			arrMoved.push_back(tMesh.arrPositions[uIdx] + arrOffset[uIdx % 3]);
+			if (uIdx % 3 == 2)
+			{
+				arrPadded.push_back(-1.0f);
+			}
+		}
+
+		const std::uint32_t uNumIndices(
+			static_cast<std::uint32_t>(tMesh.arrIndices.size()));
+		IOEOcclusionBuffer tPadded(g_uWidth, g_uHeight);
+		tPadded.Begin(tCamera.arrViewProj);
+		tPadded.AddOccluder(arrPadded.data(), sizeof(float) * 4,
+							tMesh.arrIndices.data(), uNumIndices, arrOffset);
+		tPadded.Rasterise();
+
+		IOEOcclusionBuffer tMoved(g_uWidth, g_uHeight);
+		tMoved.Begin(tCamera.arrViewProj);
+		tMoved.AddOccluder(arrMoved.data(), sizeof(float) * 3,
+						   tMesh.arrIndices.data(), uNumIndices);
+		tMoved.Rasterise();
+
+		for (std::uint32_t uY(0); uY < g_uHeight; ++uY)
+		{
+			for (std::uint32_t uX(0); uX < g_uWidth; ++uX)
+			{
+				if (tPadded.GetDepth(uX, uY) != tMoved.GetDepth(uX, uY))
+				{
+					std::printf("Offset trial %u pixel (%u, %u) differs\n",
+								uTrial, uX, uY);
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Every point of an occluded box that lands on screen must be behind
+	// the depth of its pixel
+	bool CheckOccluded(const Camera &rCamera,
+					   const IOEOcclusionBuffer &rBuffer, const float *pCentre,
+					   const float *pExtent)
+	{
+		const std::uint32_t uSteps(6);
+		for (std::uint32_t uI(0); uI <= uSteps; ++uI)
+		{
+			for (std::uint32_t uJ(0); uJ <= uSteps; ++uJ)
+			{
+				for (std::uint32_t uK(0); uK <= uSteps; ++uK)
+				{
+					const float arrPoint[3] = {
+						pCentre[0] + pExtent[0] * (2.0f * uI / uSteps - 1.0f),
+						pCentre[1] + pExtent[1] * (2.0f * uJ / uSteps - 1.0f),
+						pCentre[2] + pExtent[2] * (2.0f * uK / uSteps - 1.0f)};
+					float arrClip[4];
+					Project(rCamera, arrPoint, arrClip);
+
+					const float fX((arrClip[0] / arrClip[3] * 0.5f + 0.5f) *
+								   g_uWidth);
+					const float fY((0.5f - arrClip[1] / arrClip[3] * 0.5f) *
+								   g_uHeight);
+					if (arrClip[3] <= 0.0f || fX < 0.0f || fY < 0.0f ||
+						fX >= g_uWidth || fY >= g_uHeight)
+					{
+						continue;
+					}
+
+					const float fDepth(arrClip[2] / arrClip[3]);
+					const float fBuffer(
+						rBuffer.GetDepth(static_cast<std::uint32_t>(fX),
+										 static_cast<std::uint32_t>(fY)));
+					if (fBuffer >= fDepth + g_fDepthEpsilon)
+					{
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	bool TestIsOccluded(std::mt19937 &rRandom, std::uint32_t uTrial)
+	{
+		const Camera tCamera(RandomCamera(rRandom));
+		const Mesh tMesh(RandomMesh(rRandom, tCamera, 32));
+
+		IOEOcclusionBuffer tBuffer(g_uWidth, g_uHeight);
+		Draw(tBuffer, tCamera, tMesh);
+
+		std::uniform_real_distribution<float> tDistance(-2.0f, 80.0f);
+		std::uniform_real_distribution<float> tSpread(-40.0f, 40.0f);
+		std::uniform_real_distribution<float> tExtent(0.1f, 4.0f);
+		for (std::uint32_t uBox(0); uBox < 200; ++uBox)
+		{
+			const float fDistance(tDistance(rRandom));
+			const float fSide(tSpread(rRandom));
+			const float fHeight(tSpread(rRandom) * 0.5f);
+			float arrCentre[3], arrExtent[3];
+			for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+			{
+				arrCentre[uAxis] = tCamera.arrPos[uAxis] +
+					tCamera.arrForward[uAxis] * fDistance +
+					tCamera.arrRight[uAxis] * fSide +
+					tCamera.arrUp[uAxis] * fHeight;
+				arrExtent[uAxis] = tExtent(rRandom);
+			}
+
+			if (tBuffer.IsOccluded(arrCentre, arrExtent) &&
+				!CheckOccluded(tCamera, tBuffer, arrCentre, arrExtent))
+			{
+				std::printf("IsOccluded trial %u box %u: occluded but in "
+							"front of the depth buffer\n",
+							uTrial, uBox);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// A wall across the whole view, inside the guard band so it is drawn
+	// unclipped, hides what is behind it and nothing in front of it
+	bool TestWall()
+	{
+		const Camera tCamera(MakeCamera(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.2f));
+
+		Mesh tMesh;
+		const float arrCorners[4][3] = {{-35.0f, -18.0f, 20.0f},
+										{35.0f, -18.0f, 20.0f},
+										{35.0f, 18.0f, 20.0f},
+										{-35.0f, 18.0f, 20.0f}};
+		tMesh.AddTriangle(arrCorners[0], arrCorners[1], arrCorners[2]);
+		tMesh.AddTriangle(arrCorners[0], arrCorners[2], arrCorners[3]);
+
+		IOEOcclusionBuffer tBuffer(g_uWidth, g_uHeight);
+		Draw(tBuffer, tCamera, tMesh);
+
+		const float arrExtent[3] = {1.0f, 1.0f, 1.0f};
+		const float arrBehind[3]	 = {2.0f, 1.0f, 40.0f};
+		const float arrInFront[3]	 = {2.0f, 1.0f, 10.0f};
+		const float arrStraddling[3] = {0.0f, 0.0f, 20.0f};
+		const float arrAtCamera[3]	 = {0.0f, 0.0f, 0.0f};
+		const float arrScreen[3]	 = {30.0f, 15.0f, 1.0f};
+		if (tBuffer.GetNumTriangles() != 2 ||
+			!tBuffer.IsOccluded(arrBehind, arrExtent) ||
+			tBuffer.IsOccluded(arrInFront, arrExtent) ||
+			tBuffer.IsOccluded(arrStraddling, arrExtent) ||
+			tBuffer.IsOccluded(arrAtCamera, arrExtent))
+		{
+			std::printf("Wall: wrong occlusion\n");
+			return false;
+		}
+
+		// Screen area is 1 for boxes reaching the camera and for boxes
+		// covering the view, 0 off screen
+		const float fSmall(tBuffer.GetScreenArea(arrBehind, arrExtent));
+		if (tBuffer.GetScreenArea(arrAtCamera, arrExtent) != 1.0f ||
+			tBuffer.GetScreenArea(arrInFront, arrScreen) != 1.0f ||
+			fSmall <= 0.0f || fSmall >= 0.05f)
+		{
+			std::printf("Wall: wrong screen areas\n");
+			return false;
+		}
+		const float arrOffScreen[3] = {0.0f, 200.0f, 20.0f};
+		if (tBuffer.GetScreenArea(arrOffScreen, arrExtent) != 0.0f)
+		{
+			std::printf("Wall: off screen box has an area\n");
+			return false;
+		}
+
+		// Begin drops the wall again
+		tBuffer.Begin(tCamera.arrViewProj);
+		tBuffer.Rasterise();
+		if (tBuffer.GetNumTriangles() != 0 ||
+			tBuffer.IsOccluded(arrBehind, arrExtent) ||
+			tBuffer.GetDepth(g_uWidth / 2, g_uHeight / 2) != 1.0f)
+		{
+			std::printf("Wall: Begin did not clear\n");
+			return false;
+		}
+		return true;
+	}
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	std::mt19937 tRandom(0x0CC1);
+
+	bool bPassed(TestWall());
+	for (std::uint32_t uTrial(0); uTrial < g_uNumTrials && bPassed; ++uTrial)
+	{
+		bPassed = TestRasterise(tRandom, uTrial) &&
+			TestStrideAndOffset(tRandom, uTrial) &&
+			TestIsOccluded(tRandom, uTrial);
+	}
+
+	std::printf("%s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
@@ -0,0 +1,617 @@
+// Checks every conversion in IOEMaths/Packing.h: half precision both ways
+// against an independent reference over every half and a spread of floats,
+// the normalised integer layouts over every code, and the octahedral,
+// tangent frame and shared exponent encodings against their documented
+// error. Finishes with the throughput of the array conversions.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <IOE/IOEMaths/Packing.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	namespace Packing = IOE::Maths::Packing;
+
+	const std::uint32_t g_uNumSamples = 1 << 18;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::uint32_t FloatBits(float fValue)
+	{
+		std::uint32_t uBits;
+		std::memcpy(&uBits, &fValue, sizeof(uBits));
+		return uBits;
+	}
+
+	bool IsHalfNaN(std::uint16_t uHalf)
+	{
+		return (uHalf & 0x7fffu) > 0x7c00u;
+	}
+
+	// Straight from the binary16 definition rather than by bit tricks
+	double ReferenceHalfToDouble(std::uint16_t uHalf)
+	{
+		const double dSign((uHalf & 0x8000u) ? -1.0 : 1.0);
+		const int nExponent((uHalf >> 10) & 0x1f);
+		const int nMantissa(uHalf & 0x3ff);
+		if (nExponent == 0x1f)
+		{
+			return nMantissa ? std::numeric_limits<double>::quiet_NaN()
+							 : dSign * std::numeric_limits<double>::infinity();
+		}
+		if (nExponent == 0)
+		{
+			return dSign * std::ldexp(nMantissa, -24);
+		}
+		return dSign * std::ldexp(nMantissa + 1024, nExponent - 25);
+	}
+
+	// Nearest half by searching the finite halves, ties to even
+	std::uint16_t ReferenceFloatToHalf(float fValue)
+	{
+		if (std::isnan(fValue))
+		{
+			return 0x7e00u;
+		}
+		const std::uint16_t uSign(
+			static_cast<std::uint16_t>(std::signbit(fValue) ? 0x8000u : 0u));
+		const double dAbs(std::fabs(static_cast<double>(fValue)));
+		if (dAbs >= 65520.0)
+		{
+			return static_cast<std::uint16_t>(uSign | 0x7c00u);
+		}
+
+		std::uint32_t uLow(0), uHigh(0x7bffu);
+		while (uLow < uHigh)
+		{
+			const std::uint32_t uMid((uLow + uHigh + 1) / 2);
+			if (ReferenceHalfToDouble(static_cast<std::uint16_t>(uMid)) <=
+				dAbs)
+			{
+				uLow = uMid;
+			}
+			else
+			{
+				uHigh = uMid - 1;
+			}
+		}
+
+		std::uint32_t uHalf(uLow);
+		if (uLow < 0x7c00u)
+		{
+			const double dBelow(
+				dAbs - ReferenceHalfToDouble(static_cast<std::uint16_t>(uLow)));
+			const double dAbove(
+				ReferenceHalfToDouble(static_cast<std::uint16_t>(uLow + 1)) -
+				dAbs);
+			if (dAbove < dBelow || (dAbove == dBelow && (uLow & 1u)))
+			{
+				uHalf = uLow + 1;
+			}
+		}
+		return static_cast<std::uint16_t>(uSign | uHalf);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool CheckHalf()
+	{
+		// Every half, both ways, scalar and array
+		std::vector<std::uint16_t> arrHalves(1 << 16);
+		for (std::uint32_t uHalf(0); uHalf < (1u << 16); ++uHalf)
+		{
+			arrHalves[uHalf] = static_cast<std::uint16_t>(uHalf);
+		}
+		std::vector<float> arrFloats(arrHalves.size());
+		std::vector<std::uint16_t> arrRoundTrip(arrHalves.size());
+		Packing::HalfToFloat(arrHalves.data(), arrFloats.data(),
+							 arrHalves.size());
+		Packing::FloatToHalf(arrFloats.data(), arrRoundTrip.data(),
+							 arrFloats.size());
+
+		std::uint32_t uFailures(0);
+		for (std::uint32_t uHalf(0); uHalf < (1u << 16); ++uHalf)
+		{
+			const std::uint16_t uValue(static_cast<std::uint16_t>(uHalf));
+			const float fScalar(Packing::HalfToFloat(uValue));
+			const double dReference(ReferenceHalfToDouble(uValue));
+			const bool bNaN(IsHalfNaN(uValue));
+
+			const bool bToFloat(
+				bNaN ? std::isnan(fScalar) && std::isnan(arrFloats[uHalf])
+					 : fScalar == dReference &&
+						   std::signbit(fScalar) == std::signbit(dReference) &&
+						   FloatBits(fScalar) == FloatBits(arrFloats[uHalf]));
+			const std::uint16_t uBack(Packing::FloatToHalf(fScalar));
+			const bool bBack(bNaN ? IsHalfNaN(uBack) &&
+										IsHalfNaN(arrRoundTrip[uHalf])
+								  : uBack == uValue &&
+										arrRoundTrip[uHalf] == uValue);
+			if (!bToFloat || !bBack)
+			{
+				if (uFailures++ < 4)
+				{
+					std::printf("  half %04x: %.9g back %04x\n", uHalf,
+								fScalar, uBack);
+				}
+			}
+		}
+
+		// Every 97th float bit pattern, which visits every exponent with a
+		// spread of mantissas including the rounding boundaries
+		std::vector<float> arrSources;
+		arrSources.reserve(static_cast<std::size_t>((1ull << 32) / 97 + 1));
+		for (std::uint64_t uBits(0); uBits < (1ull << 32); uBits += 97)
+		{
+			float fValue;
+			const std::uint32_t uPattern(static_cast<std::uint32_t>(uBits));
+			std::memcpy(&fValue, &uPattern, sizeof(fValue));
+			arrSources.push_back(fValue);
+		}
+		std::vector<std::uint16_t> arrConverted(arrSources.size());
+		Packing::FloatToHalf(arrSources.data(), arrConverted.data(),
+							 arrSources.size());
+
+		for (std::size_t uIdx(0); uIdx < arrSources.size(); ++uIdx)
+		{
+			const std::uint16_t uReference(
+				ReferenceFloatToHalf(arrSources[uIdx]));
+			const std::uint16_t uScalar(Packing::FloatToHalf(arrSources[uIdx]));
+			const bool bMatch(
+				IsHalfNaN(uReference)
+					? IsHalfNaN(uScalar) && IsHalfNaN(arrConverted[uIdx])
+					: uScalar == uReference &&
+						  arrConverted[uIdx] == uReference);
+			if (!bMatch && uFailures++ < 8)
+			{
+				std::printf("  float %08x: %04x array %04x expected %04x\n",
+							FloatBits(arrSources[uIdx]), uScalar,
+							arrConverted[uIdx], uReference);
+			}
+		}
+
+		std::printf("Half: every half round trips, %zu floats rounded, "
+					"F16C %s: %s\n",
+					arrSources.size(),
+					Packing::IsF16CSupported() ? "on" : "off",
+					uFailures ? "failed" : "ok");
+		return uFailures == 0;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Every code of every width survives unpacking and packing again, other
+	// than the most negative snorm code which decodes to -1 as well
+	bool CheckNormalisedCodes()
+	{
+		std::uint32_t uFailures(0);
+		for (std::uint32_t uBits(2); uBits <= 16; ++uBits)
+		{
+			const std::uint32_t uMask((1u << uBits) - 1);
+			const std::uint32_t uMostNegative(1u << (uBits - 1));
+			for (std::uint32_t uCode(0); uCode <= uMask; ++uCode)
+			{
+				if (Packing::PackUNorm(Packing::UnpackUNorm(uCode, uBits),
+									   uBits) != uCode)
+				{
+					++uFailures;
+				}
+
+				const std::uint32_t uExpected(
+					uCode == uMostNegative ? uMostNegative + 1 : uCode);
+				if (Packing::PackSNorm(Packing::UnpackSNorm(uCode, uBits),
+									   uBits) != uExpected)
+				{
+					++uFailures;
+				}
+			}
+		}
+		std::printf("Normalised codes of 2 to 16 bits round trip: %s\n",
+					uFailures ? "failed" : "ok");
+		return uFailures == 0;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	struct Layout
+	{
+		const char *pszName;
+		std::uint32_t arrBits[4];
+		bool bSigned;
+		std::uint64_t (*fnPack)(__m128);
+		__m128 (*fnUnpack)(std::uint64_t);
+	};
+
+	template <std::uint32_t (*TPack)(__m128)>
+	std::uint64_t Pack32(__m128 vValue)
+	{
+		return TPack(vValue);
+	}
+
+	template <__m128 (*TUnpack)(std::uint32_t)>
+	__m128 Unpack32(std::uint64_t uValue)
+	{
+		return TUnpack(static_cast<std::uint32_t>(uValue));
+	}
+
+	// The vector layouts put each component in the field the scalar
+	// functions would, and decode to within half a step of the clamped
+	// input
+	bool CheckLayout(const Layout &rLayout, std::mt19937 &rRandom)
+	{
+		std::uniform_real_distribution<float> tDistribution(-1.25f, 1.25f);
+
+		std::uint32_t uFailures(0);
+		double dWorst(0.0);
+		for (std::uint32_t uSample(0); uSample < g_uNumSamples; ++uSample)
+		{
+			float arrInput[4];
+			for (float &rfValue : arrInput)
+			{
+				rfValue = tDistribution(rRandom);
+			}
+			const std::uint64_t uPacked(
+				rLayout.fnPack(_mm_loadu_ps(arrInput)));
+			float arrOutput[4];
+			_mm_storeu_ps(arrOutput, rLayout.fnUnpack(uPacked));
+
+			std::uint32_t uShift(0);
+			for (std::uint32_t uLane(0); uLane < 4; ++uLane)
+			{
+				const std::uint32_t uBits(rLayout.arrBits[uLane]);
+				const std::uint32_t uField(static_cast<std::uint32_t>(
+					(uPacked >> uShift) & ((1u << uBits) - 1)));
+				uShift += uBits;
+
+				const float fMin(rLayout.bSigned ? -1.0f : 0.0f);
+				const float fClamped(
+					std::min(std::max(arrInput[uLane], fMin), 1.0f));
+				const std::uint32_t uExpected(
+					rLayout.bSigned ? Packing::PackSNorm(fClamped, uBits)
+									: Packing::PackUNorm(fClamped, uBits));
+				const double dStep(
+					1.0 / ((1u << (uBits - (rLayout.bSigned ? 1 : 0))) - 1));
+				const double dError(std::fabs(arrOutput[uLane] - fClamped));
+				dWorst = std::max(dWorst, dError / dStep);
+				if (uField != uExpected || dError > dStep * 0.5 + 1e-7)
+				{
+					++uFailures;
+				}
+			}
+		}
+		std::printf("%-16s worst error %.3f steps: %s\n", rLayout.pszName,
+					dWorst, uFailures ? "failed" : "ok");
+		return uFailures == 0;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	double AngleDegrees(const float *pA, const float *pB)
+	{
+		const double dCrossX(static_cast<double>(pA[1]) * pB[2] -
+							 static_cast<double>(pA[2]) * pB[1]);
+		const double dCrossY(static_cast<double>(pA[2]) * pB[0] -
+							 static_cast<double>(pA[0]) * pB[2]);
+		const double dCrossZ(static_cast<double>(pA[0]) * pB[1] -
+							 static_cast<double>(pA[1]) * pB[0]);
+		const double dDot(static_cast<double>(pA[0]) * pB[0] +
+						  static_cast<double>(pA[1]) * pB[1] +
+						  static_cast<double>(pA[2]) * pB[2]);
+		return std::atan2(std::sqrt(dCrossX * dCrossX + dCrossY * dCrossY +
+									dCrossZ * dCrossZ),
+						  dDot) *
+			   57.29577951308232;
+	}
+
+	void RandomUnitVector(std::mt19937 &rRandom, float *pVector)
+	{
+		std::normal_distribution<float> tNormal;
+		float fLength(0.0f);
+		while (fLength < 1e-3f)
+		{
+			for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+			{
+				pVector[uAxis] = tNormal(rRandom);
+			}
+			fLength = std::sqrt(pVector[0] * pVector[0] +
+								pVector[1] * pVector[1] +
+								pVector[2] * pVector[2]);
+		}
+		for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+		{
+			pVector[uAxis] /= fLength;
+		}
+	}
+
+	bool CheckOctahedral(std::mt19937 &rRandom)
+	{
+		// Four floats a vector to exercise the stride, the axes first as
+		// they sit on the folds
+		std::vector<float> arrVectors(g_uNumSamples * 4, 0.0f);
+		for (std::uint32_t uIdx(0); uIdx < g_uNumSamples; ++uIdx)
+		{
+			float *pVector(&arrVectors[uIdx * 4]);
+			if (uIdx < 6)
+			{
+				pVector[uIdx / 2] = (uIdx & 1) ? -1.0f : 1.0f;
+			}
+			else
+			{
+				RandomUnitVector(rRandom, pVector);
+			}
+		}
+
+		std::vector<std::uint32_t> arrPacked(g_uNumSamples);
+		std::vector<float> arrDecoded(g_uNumSamples * 4, 0.0f);
+		Packing::PackOctahedral16(arrVectors.data(), 4, arrPacked.data(),
+								  g_uNumSamples);
+		Packing::UnpackOctahedral16(arrPacked.data(), arrDecoded.data(), 4,
+									g_uNumSamples);
+
+		std::uint32_t uFailures(0);
+		double dWorst(0.0);
+		for (std::uint32_t uIdx(0); uIdx < g_uNumSamples; ++uIdx)
+		{
+			const float *pVector(&arrVectors[uIdx * 4]);
+			float arrScalar[3];
+			const std::uint32_t uScalar(
+				Packing::PackOctahedral16(pVector[0], pVector[1], pVector[2]));
+			Packing::UnpackOctahedral16(uScalar, arrScalar[0], arrScalar[1],
+										arrScalar[2]);
+			if (uScalar != arrPacked[uIdx] ||
+				std::memcmp(arrScalar, &arrDecoded[uIdx * 4],
+							sizeof(arrScalar)) != 0)
+			{
+				++uFailures;
+			}
+			dWorst = std::max(dWorst,
+							  AngleDegrees(pVector, &arrDecoded[uIdx * 4]));
+		}
+		std::printf("Octahedral16     worst error %.4f degrees: %s\n", dWorst,
+					uFailures || dWorst > 0.01 ? "failed" : "ok");
+		return uFailures == 0 && dWorst <= 0.01;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool CheckTangentFrames(std::mt19937 &rRandom)
+	{
+		std::uint32_t uFailures(0);
+		double dWorstNormal(0.0), dWorstTangent(0.0);
+		for (std::uint32_t uIdx(0); uIdx < g_uNumSamples; ++uIdx)
+		{
+			float arrNormal[3], arrTangent[3];
+			RandomUnitVector(rRandom, arrNormal);
+			RandomUnitVector(rRandom, arrTangent);
+			const float fHandedness((uIdx & 1) ? 1.0f : -1.0f);
+
+			// The tangent as packing orthonormalises it
+			const float fDot(arrTangent[0] * arrNormal[0] +
+							 arrTangent[1] * arrNormal[1] +
+							 arrTangent[2] * arrNormal[2]);
+			float arrExpected[3];
+			for (std::uint32_t uAxis(0); uAxis < 3; ++uAxis)
+			{
+				arrExpected[uAxis] =
+					arrTangent[uAxis] - arrNormal[uAxis] * fDot;
+			}
+			const float fLength(std::sqrt(arrExpected[0] * arrExpected[0] +
+										  arrExpected[1] * arrExpected[1] +
+										  arrExpected[2] * arrExpected[2]));
+			if (fLength < 1e-2f)
+			{
+				continue;
+			}
+			for (float &rfValue : arrExpected)
+			{
+				rfValue /= fLength;
+			}
+
+			float arrNormalOut[3], arrTangentOut[3], fHandednessOut;
+			Packing::UnpackTangentFrame(
+				Packing::PackTangentFrame(arrNormal, arrTangent, fHandedness),
+				arrNormalOut, arrTangentOut, fHandednessOut);
+			if (fHandednessOut != fHandedness)
+			{
+				++uFailures;
+			}
+			dWorstNormal =
+				std::max(dWorstNormal, AngleDegrees(arrNormal, arrNormalOut));
+			dWorstTangent = std::max(dWorstTangent,
+									 AngleDegrees(arrExpected, arrTangentOut));
+		}
+		const bool bPassed(uFailures == 0 && dWorstNormal <= 0.05 &&
+						   dWorstTangent <= 0.05);
+		std::printf("TangentFrame     worst error %.4f / %.4f degrees, %u "
+					"handedness flips: %s\n",
+					dWorstNormal, dWorstTangent, uFailures,
+					bPassed ? "ok" : "failed");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool CheckRGB9E5(std::mt19937 &rRandom)
+	{
+		// Magnitudes across the whole range, with the edge cases leading
+		std::uniform_real_distribution<float> tExponent(-20.0f, 17.0f);
+		std::vector<float> arrColours(g_uNumSamples * 3);
+		for (float &rfValue : arrColours)
+		{
+			rfValue = std::exp2(tExponent(rRandom));
+		}
+		const float arrEdges[] = {0.0f, -5.0f,
+								  std::numeric_limits<float>::quiet_NaN(),
+								  1e9f, 65408.0f, 65407.0f, 1.0f, 0.0f, 0.0f};
+		std::copy(std::begin(arrEdges), std::end(arrEdges), arrColours.begin());
+
+		std::vector<std::uint32_t> arrPacked(g_uNumSamples);
+		std::vector<float> arrDecoded(g_uNumSamples * 3);
+		Packing::PackRGB9E5(arrColours.data(), 3, arrPacked.data(),
+							g_uNumSamples);
+		Packing::UnpackRGB9E5(arrPacked.data(), arrDecoded.data(), 3,
+							  g_uNumSamples);
+
+		std::uint32_t uFailures(0);
+		double dWorst(0.0);
+		for (std::uint32_t uIdx(0); uIdx < g_uNumSamples; ++uIdx)
+		{
+			const float *pColour(&arrColours[uIdx * 3]);
+			if (arrPacked[uIdx] !=
+				Packing::PackRGB9E5(pColour[0], pColour[1], pColour[2]))
+			{
+				++uFailures;
+			}
+
+			float arrClamped[3];
+			float fMax(0.0f);
+			for (std::uint32_t uChannel(0); uChannel < 3; ++uChannel)
+			{
+				const float fValue(pColour[uChannel]);
+				arrClamped[uChannel] =
+					fValue > 0.0f ? std::min(fValue, 65408.0f) : 0.0f;
+				fMax = std::max(fMax, arrClamped[uChannel]);
+			}
+			for (std::uint32_t uChannel(0); uChannel < 3 && fMax > 1e-4f;
+				 ++uChannel)
+			{
+				const double dError(std::fabs(arrDecoded[uIdx * 3 + uChannel] -
+											  arrClamped[uChannel]));
+				dWorst = std::max(dWorst, dError / fMax);
+			}
+		}
+		const bool bPassed(uFailures == 0 && dWorst <= 1.0 / 511.0);
+		std::printf("RGB9E5           worst error %.5f of the largest "
+					"channel: %s\n",
+					dWorst, bPassed ? "ok" : "failed");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	template <typename TFunction>
+	double MeasureThroughput(std::size_t uCount, TFunction fnConvert)
+	{
+		const std::uint32_t uRepeats(8);
+		fnConvert();
+		const auto tStart(std::chrono::steady_clock::now());
+		for (std::uint32_t uRepeat(0); uRepeat < uRepeats; ++uRepeat)
+		{
+			fnConvert();
+		}
+		const std::chrono::duration<double> tElapsed(
+			std::chrono::steady_clock::now() - tStart);
+		return static_cast<double>(uCount) * uRepeats / tElapsed.count() / 1e6;
+	}
+
+	void Benchmark(std::mt19937 &rRandom)
+	{
+		const std::size_t uCount(1 << 22);
+		std::uniform_real_distribution<float> tDistribution(-100.0f, 100.0f);
+
+		std::vector<float> arrFloats(uCount * 4);
+		for (float &rfValue : arrFloats)
+		{
+			rfValue = tDistribution(rRandom);
+		}
+		std::vector<std::uint16_t> arrHalves(uCount);
+		std::vector<std::uint32_t> arrPacked(uCount);
+		std::vector<float> arrOutput(uCount * 4);
+
+		std::printf("Throughput, millions of values a second\n");
+		std::printf("  FloatToHalf        %8.0f\n",
+					MeasureThroughput(uCount, [&]() {
+						Packing::FloatToHalf(arrFloats.data(),
+											 arrHalves.data(), uCount);
+					}));
+		std::printf("  HalfToFloat        %8.0f\n",
+					MeasureThroughput(uCount, [&]() {
+						Packing::HalfToFloat(arrHalves.data(),
+											 arrOutput.data(), uCount);
+					}));
+
+		for (std::size_t uIdx(0); uIdx < uCount; ++uIdx)
+		{
+			RandomUnitVector(rRandom, &arrFloats[uIdx * 4]);
+		}
+		std::printf("  PackOctahedral16   %8.0f\n",
+					MeasureThroughput(uCount, [&]() {
+						Packing::PackOctahedral16(arrFloats.data(), 4,
+												  arrPacked.data(), uCount);
+					}));
+		std::printf("  UnpackOctahedral16 %8.0f\n",
+					MeasureThroughput(uCount, [&]() {
+						Packing::UnpackOctahedral16(arrPacked.data(),
+													arrOutput.data(), 4,
+													uCount);
+					}));
+		std::printf("  PackRGB9E5         %8.0f\n",
+					MeasureThroughput(uCount, [&]() {
+						Packing::PackRGB9E5(arrFloats.data(), 4,
+											arrPacked.data(), uCount);
+					}));
+		std::printf("  UnpackRGB9E5       %8.0f\n",
+					MeasureThroughput(uCount, [&]() {
+						Packing::UnpackRGB9E5(arrPacked.data(),
+											  arrOutput.data(), 4, uCount);
+					}));
+		std::printf("  PackSNorm1010102   %8.0f\n",
+					MeasureThroughput(uCount, [&]() {
+						for (std::size_t uIdx(0); uIdx < uCount; ++uIdx)
+						{
+							const float *pVector(&arrFloats[uIdx * 4]);
+							arrPacked[uIdx] = Packing::PackSNorm1010102(
+								_mm_loadu_ps(pVector));
+						}
+					}));
+	}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	std::mt19937 tRandom(29);
+
+	using namespace IOE::Maths::Packing;
+	const Layout arrLayouts[] = {
+		{"UNorm4x8", {8, 8, 8, 8}, false, Pack32<PackUNorm4x8>,
+		 Unpack32<UnpackUNorm4x8>},
+		{"SNorm4x8", {8, 8, 8, 8}, true, Pack32<PackSNorm4x8>,
+		 Unpack32<UnpackSNorm4x8>},
+		{"UNorm1010102", {10, 10, 10, 2}, false, Pack32<PackUNorm1010102>,
+		 Unpack32<UnpackUNorm1010102>},
+		{"SNorm1010102", {10, 10, 10, 2}, true, Pack32<PackSNorm1010102>,
+		 Unpack32<UnpackSNorm1010102>},
+		{"UNorm4x16", {16, 16, 16, 16}, false, PackUNorm4x16,
+		 UnpackUNorm4x16},
+		{"SNorm4x16", {16, 16, 16, 16}, true, PackSNorm4x16,
+		 UnpackSNorm4x16},
+	};
+
+	bool bPassed(CheckHalf());
+	bPassed = CheckNormalisedCodes() && bPassed;
+	for (const Layout &rLayout : arrLayouts)
+	{
+		bPassed = CheckLayout(rLayout, tRandom) && bPassed;
+	}
+	bPassed = CheckOctahedral(tRandom) && bPassed;
+	bPassed = CheckTangentFrames(tRandom) && bPassed;
+	bPassed = CheckRGB9E5(tRandom) && bPassed;
+
+	Benchmark(tRandom);
+
+	std::printf("%s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
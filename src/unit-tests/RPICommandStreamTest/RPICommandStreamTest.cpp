@@ -0,0 +1,277 @@
+// Checks the totals and redundant state changes the null RPI's command
+// stream counts against a reference model that remembers every slot, over
+// hand written cases and long random streams of sets, draws and resets.
+
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <map>
+#include <random>
+#include <utility>
+
+#include <IOE/IOERenderer/Null/IOERPICommandStream.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Renderer;
+
+	const std::uint32_t g_uNumTrials   = 50;
+	const std::uint32_t g_uNumCommands = 4000;
+
+	// Few objects and slots, so random sets often repeat what is bound
+	const std::uint32_t g_uNumObjects = 3;
+	const std::uint32_t g_uNumSlots	  = 2;
+
+	const char g_arrObjects[g_uNumObjects] = {};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool Expect(const IOERPICommandStream &rStream, const char *szCase,
+				std::uint32_t uStateChanges, std::uint32_t uRedundant)
+	{
+		const IOERPICommandStats &rStats(rStream.GetStats());
+		if (rStats.uStateChanges != uStateChanges ||
+			rStats.uRedundantStateChanges != uRedundant)
+		{
+			std::printf("%s: %u changes, %u redundant, expected %u, %u\n",
+						szCase, rStats.uStateChanges,
+						rStats.uRedundantStateChanges, uStateChanges,
+						uRedundant);
+			return false;
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestRedundant()
+	{
+		const void *pA(&g_arrObjects[0]);
+		const void *pB(&g_arrObjects[1]);
+
+		IOERPICommandStream tStream;
+		tStream.Record(ERPICommand::SetBlendState, pA);
+		tStream.Record(ERPICommand::SetBlendState, pA);
+		if (!Expect(tStream, "Same object", 2, 1))
+		{
+			return false;
+		}
+
+		// Another slot, argument or kind of state is a different binding
+		tStream.Record(ERPICommand::SetTexture, pA, 0, 0);
+		tStream.Record(ERPICommand::SetTexture, pA, 0, 1);
+		tStream.Record(ERPICommand::SetTexture, pA, 1, 1);
+		tStream.Record(ERPICommand::SetSampler, pA, 0, 0);
+		if (!Expect(tStream, "Other bindings", 6, 1))
+		{
+			return false;
+		}
+
+		// Only the last binding counts, so A B A is three changes
+		tStream.Record(ERPICommand::SetShader, pA);
+		tStream.Record(ERPICommand::SetShader, pB);
+		tStream.Record(ERPICommand::SetShader, pA);
+		tStream.Record(ERPICommand::SetShader, pA);
+		if (!Expect(tStream, "Rebind", 10, 2))
+		{
+			return false;
+		}
+
+		// Nothing but sets changes state
+		tStream.Record(ERPICommand::DrawIndexed, pA, 36);
+		tStream.Record(ERPICommand::Upload, pA, 256);
+		tStream.Record(ERPICommand::SetShader, pA);
+		return Expect(tStream, "Draws between", 11, 3);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestResets()
+	{
+		const void *pA(&g_arrObjects[0]);
+
+		IOERPICommandStream tStream;
+		tStream.Record(ERPICommand::SetShader, pA);
+		tStream.Record(ERPICommand::SetTexture, pA);
+
+		// Forgetting one kind of state leaves the others bound
+		tStream.ResetBoundState(ERPICommand::SetShader);
+		tStream.Record(ERPICommand::SetShader, pA);
+		tStream.Record(ERPICommand::SetTexture, pA);
+		if (!Expect(tStream, "Reset shaders", 4, 1))
+		{
+			return false;
+		}
+
+		tStream.ResetBoundState();
+		tStream.Record(ERPICommand::SetShader, pA);
+		tStream.Record(ERPICommand::SetTexture, pA);
+		if (!Expect(tStream, "Reset all", 6, 1))
+		{
+			return false;
+		}
+
+		// Clearing the totals keeps what is bound
+		tStream.Reset();
+		if (tStream.GetNumCommands() != 0 ||
+			tStream.GetCount(ERPICommand::SetShader) != 0)
+		{
+			std::printf("Reset: %u commands kept\n", tStream.GetNumCommands());
+			return false;
+		}
+		tStream.Record(ERPICommand::SetShader, pA);
+		return Expect(tStream, "Reset totals", 1, 1);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestTotals()
+	{
+		const void *pA(&g_arrObjects[0]);
+
+		IOERPICommandStream tStream;
+		tStream.Record(ERPICommand::Draw, pA, 3);
+		tStream.Record(ERPICommand::DrawIndexed, pA, 36);
+		tStream.Record(ERPICommand::DrawIndexedInstanced, pA, 36, 10);
+		tStream.Record(ERPICommand::Dispatch, pA);
+		tStream.Record(ERPICommand::Upload, pA, 64);
+		tStream.Record(ERPICommand::ClearBuffer, pA, 16);
+		tStream.Record(ERPICommand::CreateBuffer, pA, 1024);
+		tStream.Record(ERPICommand::CreateState, pA);
+
+		// With recording off only the totals move
+		tStream.SetRecordCommands(false);
+		tStream.Record(ERPICommand::DrawIndexed, pA, 6);
+		tStream.Record(ERPICommand::SetShader, pA);
+
+		const IOERPICommandStats &rStats(tStream.GetStats());
+		const bool bPassed(
+			tStream.GetNumCommands() == 8 &&
+			tStream.GetCommand(2).uSlot == 10 &&
+			tStream.GetCount(ERPICommand::DrawIndexed) == 2 &&
+			rStats.uDraws == 4 && rStats.uDrawnIndices == 81 &&
+			rStats.uDrawnInstances == 13 && rStats.uDispatches == 1 &&
+			rStats.uUploads == 2 && rStats.uBytesUploaded == 80 &&
+			rStats.uResourcesCreated == 2 && rStats.uBytesCreated == 1024 &&
+			rStats.uStateChanges == 1);
+		if (!bPassed)
+		{
+			std::printf("Totals: %u commands, %u draws, %llu indices, "
+						"%llu instances\n",
+						tStream.GetNumCommands(), rStats.uDraws,
+						static_cast<unsigned long long>(rStats.uDrawnIndices),
+						static_cast<unsigned long long>(
+							rStats.uDrawnInstances));
+		}
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Remembers every binding ever made, keyed the obvious way
+	struct Reference
+	{
+		typedef std::pair<ERPICommand::Enum, std::uint32_t> Slot;
+		typedef std::pair<const void *, std::uint64_t> Binding;
+
+		std::map<Slot, Binding> mapBound;
+		std::uint32_t uStateChanges = 0;
+		std::uint32_t uRedundant	= 0;
+
+		void Set(ERPICommand::Enum eCommand, const void *pObject,
+				 std::uint64_t uValue, std::uint32_t uSlot)
+		{
+			++uStateChanges;
+			const Slot tSlot(eCommand, uSlot);
+			const Binding tBinding(pObject, uValue);
+			auto itFound(mapBound.find(tSlot));
+			if (itFound != mapBound.end() && itFound->second == tBinding)
+			{
+				++uRedundant;
+			}
+			mapBound[tSlot] = tBinding;
+		}
+
+		void Forget(ERPICommand::Enum eCommand)
+		{
+			for (auto itSlot(mapBound.begin()); itSlot != mapBound.end();)
+			{
+				itSlot = itSlot->first.first == eCommand
+					? mapBound.erase(itSlot)
+					: std::next(itSlot);
+			}
+		}
+	};
+
+	bool TestRandom(std::mt19937 &rRandom)
+	{
+		IOERPICommandStream tStream;
+		tStream.SetRecordCommands(false);
+		Reference tReference;
+
+		const std::uint32_t uNumStates(ERPICommand::SetIndexBuffer -
+									   ERPICommand::SetRasterizerState + 1);
+		std::uniform_int_distribution<std::uint32_t> tState(0, uNumStates - 1);
+		std::uniform_int_distribution<std::uint32_t> tObject(0,
+															 g_uNumObjects);
+		std::uniform_int_distribution<std::uint32_t> tSlot(0, g_uNumSlots - 1);
+		std::uniform_int_distribution<std::uint32_t> tAction(0, 99);
+
+		for (std::uint32_t uIdx(0); uIdx < g_uNumCommands; ++uIdx)
+		{
+			const ERPICommand::Enum eState(static_cast<ERPICommand::Enum>(
+				ERPICommand::SetRasterizerState + tState(rRandom)));
+			const std::uint32_t uAction(tAction(rRandom));
+			if (uAction == 0)
+			{
+				tStream.ResetBoundState();
+				tReference.mapBound.clear();
+			}
+			else if (uAction == 1)
+			{
+				tStream.ResetBoundState(eState);
+				tReference.Forget(eState);
+			}
+			else if (uAction < 10)
+			{
+				tStream.Record(ERPICommand::DrawIndexed, nullptr, 6);
+			}
+			else
+			{
+				// Null objects bind nothing, as unbinding a slot does
+				const std::uint32_t uObject(tObject(rRandom));
+				const void *pObject(uObject == g_uNumObjects
+										? nullptr
+										: &g_arrObjects[uObject]);
+				const std::uint64_t uValue(tAction(rRandom) < 80 ? 0 : 1);
+				const std::uint32_t uSlot(tSlot(rRandom));
+
+				tStream.Record(eState, pObject, uValue, uSlot);
+				tReference.Set(eState, pObject, uValue, uSlot);
+			}
+		}
+
+		return tStream.GetNumCommands() == 0 &&
+			Expect(tStream, "Random", tReference.uStateChanges,
+				   tReference.uRedundant);
+	}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	bool bPassed(TestRedundant() && TestResets() && TestTotals());
+
+	std::mt19937 tRandom(0x5EED);
+	for (std::uint32_t uTrial(0); uTrial < g_uNumTrials && bPassed; ++uTrial)
+	{
+		bPassed = TestRandom(tRandom);
+	}
+
+	std::printf("%s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
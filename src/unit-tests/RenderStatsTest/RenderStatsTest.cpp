@@ -0,0 +1,174 @@
+// Checks IOERenderStats: the triangles counted for each topology, and the
+// min, average and max over the window of recent frames, before the ring
+// fills, as it wraps and as the frames holding the max leave it.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include <IOE/IOERenderer/IOERPI.h>
+#include <IOE/IOERenderer/IOERenderStats.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Renderer;
+
+	const std::uint32_t g_uWindowSize = IOERenderStats::ms_uWindowSize;
+
+	bool Expect(bool bPassed, const char *szCase)
+	{
+		if (!bPassed)
+		{
+			std::printf("%s\n", szCase);
+		}
+		return bPassed;
+	}
+
+	// Ends a frame of uDraws draws
+	void EndFrame(IOERenderStats &rStats, std::uint64_t uDraws)
+	{
+		rStats.Add(ERenderStat::Draws, uDraws);
+		rStats.EndFrame();
+	}
+
+	bool ExpectWindow(const IOERenderStats &rStats, std::uint64_t uLast,
+					  std::uint64_t uMin, double fAverage, std::uint64_t uMax,
+					  const char *szCase)
+	{
+		const ERenderStat::Enum eStat(ERenderStat::Draws);
+		if (rStats.GetLast(eStat) != uLast || rStats.GetMin(eStat) != uMin ||
+			std::fabs(rStats.GetAverage(eStat) - fAverage) > 1e-9 ||
+			rStats.GetMax(eStat) != uMax)
+		{
+			std::printf("%s: %s, expected %llu (%llu/%.1f/%llu)\n", szCase,
+						rStats.Format(eStat).c_str(),
+						static_cast<unsigned long long>(uLast),
+						static_cast<unsigned long long>(uMin), fAverage,
+						static_cast<unsigned long long>(uMax));
+			return false;
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestTopologies()
+	{
+		IOERenderStats tStats;
+		tStats.AddDraw(EPrimitiveTopology::TriangleList, 9, 2);
+		tStats.AddDraw(EPrimitiveTopology::TriangleStrip, 5);
+		tStats.AddDraw(EPrimitiveTopology::TriangleListWithAdjacency, 12);
+		tStats.AddDraw(EPrimitiveTopology::TriangleStripWithAdjacency, 10);
+		tStats.AddDraw(EPrimitiveTopology::TriangleStrip, 2);
+		tStats.AddDraw(EPrimitiveTopology::LineList, 8);
+
+		bool bPassed(Expect(tStats.GetCurrent(ERenderStat::Draws) == 6,
+							"Draws counted"));
+		bPassed &= Expect(tStats.GetCurrent(ERenderStat::Triangles) ==
+							  6 + 3 + 2 + 3,
+						  "Triangles counted");
+
+		// Nothing reaches the window until the frame ends
+		bPassed &= Expect(tStats.GetNumFrames() == 0 &&
+							  tStats.GetLast(ERenderStat::Draws) == 0 &&
+							  tStats.GetAverage(ERenderStat::Draws) == 0.0,
+						  "Window before the first frame");
+		tStats.EndFrame();
+		bPassed &= Expect(tStats.GetLast(ERenderStat::Triangles) == 14 &&
+							  tStats.GetCurrent(ERenderStat::Triangles) == 0,
+						  "Frame moved into the window");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestFilling()
+	{
+		IOERenderStats tStats;
+		EndFrame(tStats, 7);
+		bool bPassed(ExpectWindow(tStats, 7, 7, 7.0, 7, "One frame"));
+
+		// Frames 1 to 10 after it, so the first stays the largest
+		for (std::uint64_t uDraws(1); uDraws <= 10; ++uDraws)
+		{
+			EndFrame(tStats, uDraws);
+		}
+		bPassed &= Expect(tStats.GetNumFrames() == 11, "Frames held");
+		bPassed &= ExpectWindow(tStats, 10, 1, 62.0 / 11.0, 10,
+								"Partly filled window");
+		bPassed &= Expect(tStats.Format(ERenderStat::Draws) ==
+							  "10 (1/5.6/10)",
+						  "Formatted window");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestWrap()
+	{
+		// Frames count up from 1, and 30 more than the window holds
+		IOERenderStats tStats;
+		const std::uint32_t uNumFrames(g_uWindowSize + 30);
+		for (std::uint64_t uDraws(1); uDraws <= uNumFrames; ++uDraws)
+		{
+			EndFrame(tStats, uDraws);
+		}
+
+		// Only the last window of frames, 31 onwards, are kept
+		bool bPassed(Expect(tStats.GetNumFrames() == g_uWindowSize,
+							"Frames held past the window"));
+		bPassed &= ExpectWindow(tStats, uNumFrames, 31,
+								(31.0 + uNumFrames) * 0.5, uNumFrames,
+								"Wrapped window");
+
+		// Counting down over a whole window leaves the max in the oldest
+		// frame, so as empty frames push them out it moves through every
+		// slot of the ring
+		double fSum(0.0);
+		for (std::uint32_t uFrame(0); uFrame < g_uWindowSize; ++uFrame)
+		{
+			EndFrame(tStats, 1000 - uFrame);
+			fSum += 1000 - uFrame;
+		}
+		bPassed &= ExpectWindow(tStats, 1001 - g_uWindowSize,
+								1001 - g_uWindowSize, fSum / g_uWindowSize,
+								1000, "Window counting down");
+		for (std::uint32_t uFrame(1); uFrame < g_uWindowSize; ++uFrame)
+		{
+			EndFrame(tStats, 0);
+			fSum -= 1001 - uFrame;
+			if (!ExpectWindow(tStats, 0, 0, fSum / g_uWindowSize,
+							  1000 - uFrame, "Oldest frame left the window"))
+			{
+				return false;
+			}
+		}
+		EndFrame(tStats, 0);
+		bPassed &= ExpectWindow(tStats, 0, 0, 0.0, 0, "Window emptied");
+
+		tStats.Reset();
+		bPassed &= Expect(tStats.GetNumFrames() == 0 &&
+							  tStats.GetMax(ERenderStat::Draws) == 0,
+						  "Reset");
+		EndFrame(tStats, 3);
+		bPassed &= ExpectWindow(tStats, 3, 3, 3.0, 3, "Frame after reset");
+		return bPassed;
+	}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	bool bPassed(true);
+	bPassed &= TestTopologies();
+	bPassed &= TestFilling();
+	bPassed &= TestWrap();
+
+	std::printf("RenderStatsTest %s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
@@ -0,0 +1,345 @@
+// Checks IOEMaths/Sampling.h: the generators against the published PCG32
+// and xoshiro128+ outputs, the stratification that Sobol points keep with
+// and without Owen scrambling, and that the four wide warps place samples
+// where the scalar warps do.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include <IOE/IOEMaths/Sampling.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Maths;
+
+	bool Expect(bool bPassed, const char *szCase)
+	{
+		if (!bPassed)
+		{
+			std::printf("%s\n", szCase);
+		}
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestPCG()
+	{
+		// pcg32-demo's first outputs for initstate 42, initseq 54
+		const std::uint32_t arrExpected[] = {0xa15c02b7, 0x7b47f409,
+											 0xba1d3330, 0x83d2f293,
+											 0xbfa4784b, 0xcbed606e};
+
+		IOEPCG32 tRandom(42, 54);
+		bool bPassed(true);
+		for (std::uint32_t uExpected : arrExpected)
+		{
+			bPassed &= Expect(tRandom.NextUInt() == uExpected,
+							  "PCG32 differs from the reference");
+		}
+
+		// Advancing lands where drawing as many outputs would
+		IOEPCG32 tStepped(7, 3), tAdvanced(7, 3);
+		for (std::uint32_t uIdx(0); uIdx < 1000; ++uIdx)
+		{
+			tStepped.NextUInt();
+		}
+		tAdvanced.Advance(1000);
+		bPassed &= Expect(tStepped.NextUInt() == tAdvanced.NextUInt(),
+						  "PCG32 advance");
+
+		// Streams of the same seed are unrelated
+		IOEPCG32 tOther(42, 55);
+		tRandom.Seed(42, 54);
+		std::uint32_t uSame(0);
+		for (std::uint32_t uIdx(0); uIdx < 64; ++uIdx)
+		{
+			uSame += tRandom.NextUInt() == tOther.NextUInt() ? 1 : 0;
+		}
+		bPassed &= Expect(uSame == 0, "PCG32 streams overlap");
+
+		for (std::uint32_t uIdx(0); uIdx < 1000; ++uIdx)
+		{
+			bPassed &= Expect(tRandom.NextUInt(7) < 7, "PCG32 bound");
+			const float fValue(tRandom.NextFloat());
+			bPassed &= Expect(fValue >= 0.0f && fValue < 1.0f, "PCG32 float");
+		}
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// xoshiro128+ and SplitMix64 as published by Blackman and Vigna, one
+	// generator at a time
+	std::uint32_t ReferenceXoshiro(std::uint32_t (&arrState)[4])
+	{
+		const std::uint32_t uResult(arrState[0] + arrState[3]);
+		const std::uint32_t uT(arrState[1] << 9);
+		arrState[2] ^= arrState[0];
+		arrState[3] ^= arrState[1];
+		arrState[1] ^= arrState[2];
+		arrState[0] ^= arrState[3];
+		arrState[2] ^= uT;
+		arrState[3] = (arrState[3] << 11) | (arrState[3] >> 21);
+		return uResult;
+	}
+
+	std::uint64_t ReferenceSplitMix(std::uint64_t &rState)
+	{
+		std::uint64_t uZ(rState += 0x9e3779b97f4a7c15ull);
+		uZ = (uZ ^ (uZ >> 30)) * 0xbf58476d1ce4e5b9ull;
+		uZ = (uZ ^ (uZ >> 27)) * 0x94d049bb133111ebull;
+		return uZ ^ (uZ >> 31);
+	}
+
+	bool TestXoshiro()
+	{
+		// The reference's own outputs from the state {1, 2, 3, 4}
+		const std::uint32_t arrExpected[] = {5, 12295, 25178119, 27286542,
+											 39879690};
+		std::uint32_t arrKnown[4] = {1, 2, 3, 4};
+		bool bPassed(true);
+		for (std::uint32_t uExpected : arrExpected)
+		{
+			bPassed &= Expect(ReferenceXoshiro(arrKnown) == uExpected,
+							  "xoshiro128+ reference");
+		}
+
+		// Each lane is its own generator, seeded from SplitMix64 in turn
+		const std::uint64_t uSeed(0x1234567), uStream(5);
+		std::uint32_t arrLanes[4][4];
+		std::uint64_t uMixer(uSeed ^ (uStream * 0xd1b54a32d192ed03ull));
+		for (std::uint32_t uLane(0); uLane < 4; ++uLane)
+		{
+			const std::uint64_t uLow(ReferenceSplitMix(uMixer));
+			const std::uint64_t uHigh(ReferenceSplitMix(uMixer));
+			arrLanes[uLane][0] = static_cast<std::uint32_t>(uLow);
+			arrLanes[uLane][1] = static_cast<std::uint32_t>(uLow >> 32);
+			arrLanes[uLane][2] = static_cast<std::uint32_t>(uHigh);
+			arrLanes[uLane][3] = static_cast<std::uint32_t>(uHigh >> 32);
+		}
+
+		IOEXoshiro128x4 tRandom(uSeed, uStream);
+		for (std::uint32_t uIdx(0); uIdx < 100; ++uIdx)
+		{
+			alignas(16) std::uint32_t arrOut[4];
+			_mm_store_si128(reinterpret_cast<__m128i *>(arrOut),
+							tRandom.NextUInt4());
+			for (std::uint32_t uLane(0); uLane < 4; ++uLane)
+			{
+				bPassed &= Expect(
+					arrOut[uLane] == ReferenceXoshiro(arrLanes[uLane]),
+					"xoshiro128+ lane differs from the reference");
+			}
+		}
+
+		for (std::uint32_t uIdx(0); uIdx < 1000; ++uIdx)
+		{
+			alignas(16) float arrOut[4];
+			_mm_store_ps(arrOut, tRandom.NextFloat4());
+			for (float fValue : arrOut)
+			{
+				bPassed &= Expect(fValue >= 0.0f && fValue < 1.0f,
+								  "xoshiro128+ float");
+			}
+		}
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Whether the first 2^uLog2Count points form a (0, m, 2)-net: for every
+	// split of the square into 2^a by 2^(m - a) cells, each cell holds
+	// exactly one point
+	template <typename TPoint>
+	bool IsNet(std::uint32_t uLog2Count, TPoint tPoint)
+	{
+		const std::uint32_t uCount(1u << uLog2Count);
+		for (std::uint32_t uLog2X(0); uLog2X <= uLog2Count; ++uLog2X)
+		{
+			const std::uint32_t uCellsX(1u << uLog2X);
+			const std::uint32_t uCellsY(1u << (uLog2Count - uLog2X));
+			std::vector<std::uint32_t> arrCells(uCount, 0);
+			for (std::uint32_t uIdx(0); uIdx < uCount; ++uIdx)
+			{
+				float fX, fY;
+				tPoint(uIdx, fX, fY);
+				const std::uint32_t uCellX(
+					static_cast<std::uint32_t>(fX * uCellsX));
+				const std::uint32_t uCellY(
+					static_cast<std::uint32_t>(fY * uCellsY));
+				if (uCellX >= uCellsX || uCellY >= uCellsY ||
+					++arrCells[uCellY * uCellsX + uCellX] > 1)
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	bool TestSobol()
+	{
+		// Dimension 0 is the van der Corput sequence, dimension 1 is built
+		// from Joe and Kuo's first direction numbers
+		const float arrExpected[][2] = {{0.0f, 0.0f},	{0.5f, 0.5f},
+										{0.25f, 0.75f}, {0.75f, 0.25f},
+										{0.125f, 0.625f}};
+		bool bPassed(true);
+		for (std::uint32_t uIdx(0); uIdx < 5; ++uIdx)
+		{
+			bPassed &=
+				Expect(Sampling::Sobol(uIdx, 0) == arrExpected[uIdx][0] &&
+						   Sampling::Sobol(uIdx, 1) == arrExpected[uIdx][1],
+					   "Sobol differs from the reference");
+		}
+
+		const std::uint32_t uLog2Count(8);
+		bPassed &= Expect(IsNet(uLog2Count,
+								[](std::uint32_t uIdx, float &fX, float &fY) {
+									fX = Sampling::Sobol(uIdx, 0);
+									fY = Sampling::Sobol(uIdx, 1);
+								}),
+						  "Sobol points not stratified");
+
+		// Scrambling moves every point but keeps the strata, whatever the
+		// seed
+		for (std::uint32_t uSeed(1); uSeed <= 8; ++uSeed)
+		{
+			bPassed &= Expect(
+				IsNet(uLog2Count,
+					  [uSeed](std::uint32_t uIdx, float &fX, float &fY) {
+						  fX = Sampling::ScrambledSobol(uIdx, 0, uSeed);
+						  fY = Sampling::ScrambledSobol(uIdx, 1, uSeed);
+					  }),
+				"Owen scrambled Sobol points not stratified");
+		}
+
+		std::uint32_t uSame(0);
+		for (std::uint32_t uIdx(0); uIdx < (1u << uLog2Count); ++uIdx)
+		{
+			uSame += Sampling::ScrambledSobol(uIdx, 0, 1) ==
+							 Sampling::ScrambledSobol(uIdx, 0, 2)
+						 ? 1
+						 : 0;
+		}
+		bPassed &= Expect(uSame < 8, "Seeds scramble alike");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// The wide warps use the SIMD sine and cosine, so they agree with the
+	// scalar warps to within that approximation
+	bool IsClose(__m128 vPacket, const float (&arrScalar)[4])
+	{
+		alignas(16) float arrPacket[4];
+		_mm_store_ps(arrPacket, vPacket);
+		for (std::uint32_t uLane(0); uLane < 4; ++uLane)
+		{
+			if (!(std::fabs(arrPacket[uLane] - arrScalar[uLane]) <= 1e-5f))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool TestWarps()
+	{
+		// Random samples plus the edges and the centre, where the disc
+		// warps divide by zero
+		std::vector<float> arrU1, arrU2;
+		IOEPCG32 tRandom(28);
+		for (std::uint32_t uIdx(0); uIdx < 4096; ++uIdx)
+		{
+			arrU1.push_back(tRandom.NextFloat());
+			arrU2.push_back(tRandom.NextFloat());
+		}
+		const float arrEdges[] = {0.0f, 0.5f, 0.99999994f, 0.25f};
+		for (float fU1 : arrEdges)
+		{
+			for (float fU2 : arrEdges)
+			{
+				arrU1.push_back(fU1);
+				arrU2.push_back(fU2);
+			}
+		}
+
+		bool bPassed(true);
+		for (std::size_t uBase(0); uBase < arrU1.size(); uBase += 4)
+		{
+			const __m128 vU1(_mm_loadu_ps(&arrU1[uBase]));
+			const __m128 vU2(_mm_loadu_ps(&arrU2[uBase]));
+			float arrX[4], arrY[4], arrZ[4];
+			__m128 vX, vY, vZ;
+
+			for (std::uint32_t uLane(0); uLane < 4; ++uLane)
+			{
+				Sampling::ConcentricSampleDisc(arrU1[uBase + uLane],
+											   arrU2[uBase + uLane],
+											   arrX[uLane], arrY[uLane]);
+			}
+			Sampling::ConcentricSampleDisc(vU1, vU2, vX, vY);
+			bPassed &= Expect(IsClose(vX, arrX) && IsClose(vY, arrY),
+							  "Disc warps disagree");
+
+			for (std::uint32_t uLane(0); uLane < 4; ++uLane)
+			{
+				Sampling::UniformSampleSphere(
+					arrU1[uBase + uLane], arrU2[uBase + uLane], arrX[uLane],
+					arrY[uLane], arrZ[uLane]);
+			}
+			Sampling::UniformSampleSphere(vU1, vU2, vX, vY, vZ);
+			bPassed &= Expect(IsClose(vX, arrX) && IsClose(vY, arrY) &&
+								  IsClose(vZ, arrZ),
+							  "Sphere warps disagree");
+
+			for (std::uint32_t uLane(0); uLane < 4; ++uLane)
+			{
+				Sampling::UniformSampleHemisphere(
+					arrU1[uBase + uLane], arrU2[uBase + uLane], arrX[uLane],
+					arrY[uLane], arrZ[uLane]);
+			}
+			Sampling::UniformSampleHemisphere(vU1, vU2, vX, vY, vZ);
+			bPassed &= Expect(IsClose(vX, arrX) && IsClose(vY, arrY) &&
+								  IsClose(vZ, arrZ),
+							  "Hemisphere warps disagree");
+
+			for (std::uint32_t uLane(0); uLane < 4; ++uLane)
+			{
+				Sampling::CosineSampleHemisphere(
+					arrU1[uBase + uLane], arrU2[uBase + uLane], arrX[uLane],
+					arrY[uLane], arrZ[uLane]);
+				arrY[uLane] *= arrY[uLane];
+			}
+			Sampling::CosineSampleHemisphere(vU1, vU2, vX, vY, vZ);
+
+			// Y is lifted from the disc through a square root, which
+			// magnifies the disc's error near its rim, so compare Y squared
+			bPassed &= Expect(IsClose(vX, arrX) &&
+								  IsClose(_mm_mul_ps(vY, vY), arrY) &&
+								  IsClose(vZ, arrZ),
+							  "Cosine hemisphere warps disagree");
+		}
+		return bPassed;
+	}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	bool bPassed(TestPCG());
+	bPassed = TestXoshiro() && bPassed;
+	bPassed = TestSobol() && bPassed;
+	bPassed = TestWarps() && bPassed;
+
+	std::printf("%s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
@@ -0,0 +1,486 @@
+// Checks IOEShaderCache with a stub compiler: which edits change a key,
+// that equal keys share one binary and one compile, and that binaries and
+// their reflection come back from the cache file unchanged, including when
+// the file is damaged or from another version.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <IOE/IOERenderer/IOEShaderCache.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Renderer;
+
+	// Written to and removed from the working directory
+	const char *g_szShader	 = "ShaderCacheTest_Shader.hlsl";
+	const char *g_szCommon	 = "ShaderCacheTest_Common.hlsli";
+	const char *g_szLighting = "ShaderCacheTest_Lighting.hlsli";
+	const char *g_szCache	 = "ShaderCacheTest_Cache.bin";
+
+	const char *g_szBrokenEntryPoint = "Broken";
+
+	//////////////////////////////////////////////////////////////////////////
+
+	std::wstring Widen(const char *szValue)
+	{
+		return std::wstring(szValue, szValue + std::strlen(szValue));
+	}
+
+	void WriteFile(const char *szPath, const std::string &szContents)
+	{
+		std::ofstream tStream(szPath, std::ios::out | std::ios::binary);
+		tStream << szContents;
+	}
+
+	std::string ReadFile(const char *szPath)
+	{
+		std::ifstream tStream(szPath, std::ios::in | std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(tStream),
+						   std::istreambuf_iterator<char>());
+	}
+
+	// The shader only reaches the common file through a directory that
+	// does not exist, and the common file includes the shader back
+	void WriteSources(const std::string &szLighting)
+	{
+		WriteFile(g_szShader,
+				  std::string("  #  include \"none/../") + g_szCommon +
+					  "\"\nfloat4 Main() : SV_Target { return Light(); }\n");
+		WriteFile(g_szCommon, std::string("#include <") + g_szLighting +
+								  ">\n#include \"" + g_szShader + "\"\n");
+		WriteFile(g_szLighting, szLighting);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Makes up a binary from the options, so that every key has its own
+	// bytecode and reflection
+	class StubCompiler : public IOEShaderCompiler
+	{
+	public:
+		StubCompiler()
+			: m_szSignature("Stub 1.0")
+			, m_uNumCompiles(0)
+		{
+		}
+
+		virtual std::string GetCompilerSignature() const override
+		{
+			return m_szSignature;
+		}
+
+		virtual void CompileShader(const IOEShaderCompilationOptions &rOptions,
+								   IOEShaderBinary &rBinary) override
+		{
+			if (rOptions.szEntryPoint == g_szBrokenEntryPoint)
+			{
+				throw std::runtime_error("Stub compile failed");
+			}
+			++m_uNumCompiles;
+
+			const std::string szSeed(rOptions.szEntryPoint + "|" +
+									 rOptions.szProfile + "|" +
+									 std::to_string(m_uNumCompiles));
+			rBinary.arrBytecode.assign(szSeed.begin(), szSeed.end());
+
+			ShaderConstantBufferDescription &rBuffer(
+				rBinary.arrConstantBuffers[1]);
+			std::strcpy(rBuffer.szName, "PerObject");
+			rBuffer.nSizeBytes = 16 * m_uNumCompiles;
+			rBuffer.nSlotIdx   = 1;
+
+			ShaderVariableDescription tVariable;
+			std::strcpy(tVariable.szName, "vColour");
+			tVariable.eType			 = EShaderVariableType::Float4;
+			tVariable.nSizeOrSamples = 16;
+			rBuffer.arrVariables.push_back(tVariable);
+
+			const std::int32_t nSlot(static_cast<std::int32_t>(m_uNumCompiles));
+			std::strcpy(tVariable.szName, "tOutput");
+			tVariable.eType			= EShaderVariableType::Texture2D;
+			tVariable.nSlot			= nSlot;
+			tVariable.bGPUWriteable = true;
+			rBinary.arrGlobalVariables[EShaderVariableCategories::Texture]
+				.push_back(tVariable);
+		}
+
+	public:
+		std::string m_szSignature;
+		std::uint32_t m_uNumCompiles;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	IOEShaderCompilationOptions MakeOptions(const char *szEntryPoint)
+	{
+		IOEShaderCompilationOptions tOptions;
+		tOptions.szPath		  = Widen(g_szShader);
+		tOptions.szProfile	  = "ps_5_0";
+		tOptions.szEntryPoint = szEntryPoint;
+		tOptions.eShaderType  = EShaderType::Fragment;
+		tOptions.pMacros	  = nullptr;
+		return tOptions;
+	}
+
+	bool SameVariables(const ShaderDescription &arrA,
+					   const ShaderDescription &arrB)
+	{
+		if (arrA.size() != arrB.size())
+		{
+			return false;
+		}
+		for (std::size_t uIdx(0); uIdx < arrA.size(); ++uIdx)
+		{
+			const ShaderVariableDescription &rA(arrA[uIdx]);
+			const ShaderVariableDescription &rB(arrB[uIdx]);
+			if (std::strcmp(rA.szName, rB.szName) != 0 ||
+				rA.eType != rB.eType || rA.nSlot != rB.nSlot ||
+				rA.nSizeOrSamples != rB.nSizeOrSamples ||
+				rA.bGPUWriteable != rB.bGPUWriteable)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool SameBinary(const IOEShaderBinary &rA, const IOEShaderBinary &rB)
+	{
+		if (rA.arrBytecode != rB.arrBytecode)
+		{
+			return false;
+		}
+		for (std::size_t uIdx(0); uIdx < rA.arrConstantBuffers.size(); ++uIdx)
+		{
+			const ShaderConstantBufferDescription &rBufferA(
+				rA.arrConstantBuffers[uIdx]);
+			const ShaderConstantBufferDescription &rBufferB(
+				rB.arrConstantBuffers[uIdx]);
+			if (std::strcmp(rBufferA.szName, rBufferB.szName) != 0 ||
+				rBufferA.nSizeBytes != rBufferB.nSizeBytes ||
+				rBufferA.nSlotIdx != rBufferB.nSlotIdx ||
+				!SameVariables(rBufferA.arrVariables, rBufferB.arrVariables))
+			{
+				return false;
+			}
+		}
+		for (std::size_t uIdx(0); uIdx < rA.arrGlobalVariables.size(); ++uIdx)
+		{
+			if (!SameVariables(rA.arrGlobalVariables[uIdx],
+							   rB.arrGlobalVariables[uIdx]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestKeys()
+	{
+		WriteSources("float4 Light() { return 1; }\n");
+
+		StubCompiler tCompiler;
+		IOEShaderCache tCache;
+		tCache.Setup(L"", L"");
+
+		const IOEShaderCompilationOptions tOptions(MakeOptions("Main"));
+		const std::uint64_t uKey(tCache.CalculateKey(tOptions, tCompiler));
+		std::vector<std::uint64_t> arrKeys(1, uKey);
+
+		// Each of these must give a key of its own
+		IOEShaderCompilationOptions tChanged(tOptions);
+		tChanged.szEntryPoint = "MainShadow";
+		arrKeys.push_back(tCache.CalculateKey(tChanged, tCompiler));
+
+		tChanged			 = tOptions;
+		tChanged.szProfile	 = "ps_5_1";
+		arrKeys.push_back(tCache.CalculateKey(tChanged, tCompiler));
+
+		tChanged			 = tOptions;
+		tChanged.eShaderType = EShaderType::Compute;
+		arrKeys.push_back(tCache.CalculateKey(tChanged, tCompiler));
+
+		std::vector<IOEShaderMacroDefinition> arrMacros;
+		arrMacros.emplace_back("SHADOWS", "1");
+		tChanged		 = tOptions;
+		tChanged.pMacros = &arrMacros;
+		arrKeys.push_back(tCache.CalculateKey(tChanged, tCompiler));
+
+		arrMacros[0].m_szDefinition = "0";
+		arrKeys.push_back(tCache.CalculateKey(tChanged, tCompiler));
+
+		// Name and definition are hashed apart, so moving a character
+		// across them is a different key
+		arrMacros[0] = IOEShaderMacroDefinition("SHADOWS1", "");
+		arrKeys.push_back(tCache.CalculateKey(tChanged, tCompiler));
+
+		tCompiler.m_szSignature = "Stub 1.1";
+		arrKeys.push_back(tCache.CalculateKey(tOptions, tCompiler));
+		tCompiler.m_szSignature = "Stub 1.0";
+
+		for (std::size_t uIdx(0); uIdx < arrKeys.size(); ++uIdx)
+		{
+			for (std::size_t uOther(uIdx + 1); uOther < arrKeys.size();
+				 ++uOther)
+			{
+				if (arrKeys[uIdx] == arrKeys[uOther])
+				{
+					std::printf("Keys: changes %zu and %zu share a key\n",
+								uIdx, uOther);
+					return false;
+				}
+			}
+		}
+
+		// The same options always give the same key, and an empty macro
+		// list is no macros at all
+		std::vector<IOEShaderMacroDefinition> arrNoMacros;
+		tChanged		 = tOptions;
+		tChanged.pMacros = &arrNoMacros;
+		if (tCache.CalculateKey(tOptions, tCompiler) != uKey ||
+			tCache.CalculateKey(tChanged, tCompiler) != uKey)
+		{
+			std::printf("Keys: the same options changed key\n");
+			return false;
+		}
+
+		// Files are read once per run, so an edit is only seen once the
+		// cache is cleared. The edit is two includes deep.
+		WriteSources("float4 Light() { return 0.5; }\n");
+		if (tCache.CalculateKey(tOptions, tCompiler) != uKey)
+		{
+			std::printf("Keys: an edit was seen before Clear\n");
+			return false;
+		}
+		tCache.Clear();
+		const std::uint64_t uEditedKey(
+			tCache.CalculateKey(tOptions, tCompiler));
+		if (uEditedKey == uKey)
+		{
+			std::printf("Keys: editing an include kept the key\n");
+			return false;
+		}
+
+		// Putting it back gives the old key again
+		WriteSources("float4 Light() { return 1; }\n");
+		tCache.Clear();
+		if (tCache.CalculateKey(tOptions, tCompiler) != uKey)
+		{
+			std::printf("Keys: undoing the edit did not restore the key\n");
+			return false;
+		}
+
+		// A missing source still has a key, which is not any file's
+		std::remove(g_szLighting);
+		tCache.Clear();
+		const std::uint64_t uMissingKey(
+			tCache.CalculateKey(tOptions, tCompiler));
+		if (uMissingKey == uKey || uMissingKey == uEditedKey)
+		{
+			std::printf("Keys: a missing include kept a key\n");
+			return false;
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestSharing()
+	{
+		WriteSources("float4 Light() { return 1; }\n");
+
+		StubCompiler tCompiler;
+		IOEShaderCache tCache;
+		tCache.Setup(L"", L"");
+
+		const IOEShaderCompilationOptions tMain(MakeOptions("Main"));
+		const IOEShaderCompilationOptions tOther(MakeOptions("Other"));
+
+		auto pFirst(tCache.Compile(tMain, tCompiler));
+		auto pSecond(tCache.Compile(tMain, tCompiler));
+		auto pOther(tCache.Compile(tOther, tCompiler));
+		if (pFirst == nullptr || pFirst != pSecond || pOther == pFirst ||
+			tCompiler.m_uNumCompiles != 2 || tCache.GetNumCompiles() != 2 ||
+			tCache.GetNumHits() != 1 || tCache.GetNumBinaries() != 2)
+		{
+			std::printf("Sharing: %u compiles, %u hits, %zu binaries\n",
+						tCompiler.m_uNumCompiles, tCache.GetNumHits(),
+						tCache.GetNumBinaries());
+			return false;
+		}
+
+		// A failed compile leaves nothing behind, so the next one retries
+		const IOEShaderCompilationOptions tBroken(
+			MakeOptions(g_szBrokenEntryPoint));
+		for (std::uint32_t uTry(0); uTry < 2; ++uTry)
+		{
+			bool bThrown(false);
+			try
+			{
+				tCache.Compile(tBroken, tCompiler);
+			}
+			catch (const std::runtime_error &)
+			{
+				bThrown = true;
+			}
+			if (!bThrown || tCache.GetNumBinaries() != 2 ||
+				tCache.Find(tCache.CalculateKey(tBroken, tCompiler)) !=
+					nullptr)
+			{
+				std::printf("Sharing: a failed compile was kept\n");
+				return false;
+			}
+		}
+
+		// Binaries compiled elsewhere are found by the key they were
+		// added under
+		const std::uint64_t uKey(tCache.CalculateKey(tMain, tCompiler) + 1);
+		auto pAdded(std::make_shared<IOEShaderBinary>());
+		tCache.Add(uKey, pAdded);
+		if (tCache.Find(uKey) != pAdded || tCache.GetNumBinaries() != 3)
+		{
+			std::printf("Sharing: an added binary was not found\n");
+			return false;
+		}
+
+		tCache.Clear();
+		if (tCache.GetNumBinaries() != 0 || tCache.GetNumHits() != 0 ||
+			tCache.GetNumCompiles() != 0 || tCache.Find(uKey) != nullptr)
+		{
+			std::printf("Sharing: Clear kept %zu binaries\n",
+						tCache.GetNumBinaries());
+			return false;
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Compiles every entry point with a new cache on the cache file. Those
+	// before uNumKept must come from the file unchanged from arrBinaries,
+	// the rest must be compiled again. arrBinaries is left holding what
+	// was compiled or found.
+	bool Reload(const char *szCase,
+				const std::vector<std::string> &arrEntryPoints,
+				std::vector<std::shared_ptr<const IOEShaderBinary> >
+					&arrBinaries,
+				std::uint32_t uNumKept)
+	{
+		StubCompiler tCompiler;
+		IOEShaderCache tCache;
+		tCache.Setup(L"", Widen(g_szCache));
+
+		arrBinaries.resize(arrEntryPoints.size());
+		for (std::size_t uIdx(0); uIdx < arrEntryPoints.size(); ++uIdx)
+		{
+			auto pBinary(tCache.Compile(
+				MakeOptions(arrEntryPoints[uIdx].c_str()), tCompiler));
+			if (uIdx < uNumKept && !SameBinary(*pBinary, *arrBinaries[uIdx]))
+			{
+				std::printf("%s: %s came back changed\n", szCase,
+							arrEntryPoints[uIdx].c_str());
+				return false;
+			}
+			arrBinaries[uIdx] = pBinary;
+		}
+
+		const std::uint32_t uExpected(
+			static_cast<std::uint32_t>(arrEntryPoints.size()) - uNumKept);
+		if (tCompiler.m_uNumCompiles != uExpected)
+		{
+			std::printf("%s: %u compiles, expected %u\n", szCase,
+						tCompiler.m_uNumCompiles, uExpected);
+			return false;
+		}
+		return true;
+	}
+
+	bool TestCacheFile()
+	{
+		WriteSources("float4 Light() { return 1; }\n");
+		std::remove(g_szCache);
+
+		std::vector<std::string> arrEntryPoints;
+		for (std::uint32_t uIdx(0); uIdx < 8; ++uIdx)
+		{
+			arrEntryPoints.push_back("Main" + std::to_string(uIdx));
+		}
+		const std::uint32_t uNumEntryPoints(
+			static_cast<std::uint32_t>(arrEntryPoints.size()));
+
+		// Cold, then warm twice, as the warm runs compile nothing and so
+		// leave the file as it was
+		std::vector<std::shared_ptr<const IOEShaderBinary> > arrBinaries;
+		if (!Reload("Cold", arrEntryPoints, arrBinaries, 0) ||
+			!Reload("Warm", arrEntryPoints, arrBinaries, uNumEntryPoints) ||
+			!Reload("Warm again", arrEntryPoints, arrBinaries,
+					uNumEntryPoints))
+		{
+			return false;
+		}
+
+		// A file cut off inside the last binary keeps the ones before it,
+		// and is rewritten so the one compiled again is found next time
+		const std::string szWhole(ReadFile(g_szCache));
+		WriteFile(g_szCache, szWhole.substr(0, szWhole.size() - 10));
+		if (!Reload("Truncated", arrEntryPoints, arrBinaries,
+					uNumEntryPoints - 1) ||
+			!Reload("Rewritten", arrEntryPoints, arrBinaries,
+					uNumEntryPoints))
+		{
+			return false;
+		}
+
+		// Another version's file is thrown away whole
+		std::string szOtherVersion(ReadFile(g_szCache));
+		szOtherVersion[4] = static_cast<char>(IOEShaderCache::ms_uVersion + 1);
+		WriteFile(g_szCache, szOtherVersion);
+		if (!Reload("Version", arrEntryPoints, arrBinaries, 0))
+		{
+			return false;
+		}
+
+		// As is a file that is not a cache at all
+		WriteFile(g_szCache, "not a shader cache");
+		if (!Reload("Garbage", arrEntryPoints, arrBinaries, 0))
+		{
+			return false;
+		}
+
+		// A huge bytecode size in the first binary, after the magic,
+		// version and key, is damage rather than a shader
+		std::string szHuge(ReadFile(g_szCache));
+		std::memset(&szHuge[8 + sizeof(std::uint64_t)], 0xFF,
+					sizeof(std::uint32_t));
+		WriteFile(g_szCache, szHuge);
+		return Reload("Huge", arrEntryPoints, arrBinaries, 0);
+	}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	const bool bPassed(TestKeys() && TestSharing() && TestCacheFile());
+
+	std::remove(g_szShader);
+	std::remove(g_szCommon);
+	std::remove(g_szLighting);
+	std::remove(g_szCache);
+
+	std::printf("%s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
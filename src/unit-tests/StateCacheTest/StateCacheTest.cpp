@@ -0,0 +1,196 @@
+// Checks the RPI's state cache on the Null platform: states with equal
+// descriptions intern to one ID and one backend object, states whose hashes
+// collide are still kept apart, and pipeline IDs count up from one within
+// the render queue's material ID field.
+//
+// Takes the media directory as its first argument, ../../Media otherwise.
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+#include <IOE/IOERenderer/IOEMaterial.h>
+#include <IOE/IOERenderer/IOERPI.h>
+#include <IOE/IOERenderer/IOERenderQueue.h>
+#include <IOE/IOERenderer/IOEStateCache.h>
+
+#include "../Common/HeadlessRPI.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Renderer;
+
+	static_assert(IOEStateCache::ms_uMaxPipelineID ==
+					  GET_RENDER_MASK(IOERenderQueueItem::NUM_BITS_MATERIAL_ID),
+				  "Pipeline IDs must fill the material ID field exactly");
+
+	bool Expect(bool bPassed, const char *szCase)
+	{
+		if (!bPassed)
+		{
+			std::printf("%s\n", szCase);
+		}
+		return bPassed;
+	}
+
+	// Two states set up from tState interned alike, and made no new object
+	template <typename TState>
+	bool ExpectShared(IOERPI &rRPI, TState tState, const char *szCase)
+	{
+		const IOEStateCache &rCache(rRPI.GetStateCache());
+
+		TState tCopy(tState);
+		tState.Setup(&rRPI);
+		const std::uint32_t uNumStates(rCache.GetNumStates());
+		tCopy.Setup(&rRPI);
+
+		return Expect(tState.GetID() != 0 && tState.GetID() == tCopy.GetID() &&
+						  &tState.GetPlatform() == &tCopy.GetPlatform() &&
+						  rCache.GetNumStates() == uNumStates,
+					  szCase);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestEqualDescriptions(IOERPI &rRPI)
+	{
+		bool bPassed(ExpectShared(rRPI, IOERasterizerState::Default(),
+								  "Rasterizer states interned apart"));
+		bPassed &= ExpectShared(rRPI, IOEBlendState::DefaultAlpha(),
+								"Blend states interned apart");
+		bPassed &= ExpectShared(rRPI, IOESamplerState::Default(),
+								"Sampler states interned apart");
+		bPassed &= ExpectShared(rRPI, IOEDepthState::Default(),
+								"Depth states interned apart");
+
+		// The RPI's own defaults were interned first, so a new state with
+		// their description takes their ID
+		IOEDepthState tDepth(IOEDepthState::Default());
+		tDepth.Setup(&rRPI);
+		bPassed &= Expect(tDepth.GetID() == rRPI.GetDefaultDepthState().GetID(),
+						  "Default depth state not shared");
+
+		// And a different description gets an ID of its own
+		IOERasterizerState tWireframe(IOERasterizerState::Default());
+		tWireframe.tData.eFillMode = EFillMode::Wireframe;
+		tWireframe.Setup(&rRPI);
+		bPassed &= Expect(
+			tWireframe.GetID() != rRPI.GetRasterizerState().GetID() &&
+				tWireframe.GetHash() != rRPI.GetRasterizerState().GetHash(),
+			"Different rasterizer states share an ID");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestCollision(IOERPI &rRPI)
+	{
+		IOEStateCache &rCache(rRPI.GetStateCache());
+
+		// A copy keeps the hash of the state it was copied from, so changing
+		// its description gives two states whose hashes collide
+		IOERasterizerState tState(IOERasterizerState::Default());
+		tState.tData.nDepthBias = 16;
+		tState.Setup(&rRPI);
+
+		IOERasterizerState tCollider(tState);
+		tCollider.tData.nDepthBias = 32;
+
+		const std::uint32_t uNumStates(rCache.GetNumStates());
+		IOERasterizerState &rCollider(rCache.Intern(tCollider));
+
+		bool bPassed(Expect(tCollider.GetHash() == tState.GetHash(),
+							"States do not collide"));
+		bPassed &= Expect(rCollider.GetID() != tState.GetID() &&
+							  rCollider.tData.nDepthBias == 32,
+						  "Colliding state took the other's ID");
+		bPassed &= Expect(rCache.GetNumStates() == uNumStates + 1,
+						  "Colliding state not interned");
+
+		// Both stay found under the shared hash
+		bPassed &= Expect(rCache.Intern(tState).GetID() == tState.GetID(),
+						  "First state lost to the collision");
+		bPassed &= Expect(rCache.Intern(tCollider).GetID() == rCollider.GetID(),
+						  "Colliding state interned twice");
+		bPassed &= Expect(rCache.GetNumStates() == uNumStates + 1,
+						  "Colliding states interned again");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestPipelineIDs(IOERPI &rRPI)
+	{
+		IOEStateCache &rCache(rRPI.GetStateCache());
+
+		IOEPipelineDescription tDesc;
+		tDesc.SetMaterial(*rRPI.GetDebugDrawMaterial());
+		tDesc.uRasterizerStateID = rRPI.GetRasterizerState().GetID();
+		tDesc.uBlendStateID		 = rRPI.GetBlendState().GetID();
+		tDesc.uDepthStateID		 = rRPI.GetDefaultDepthState().GetID();
+
+		const std::uint32_t uNumPipelines(rCache.GetNumPipelines());
+		const std::uint32_t uID(rCache.GetPipelineID(tDesc));
+		bool bPassed(Expect(uID == uNumPipelines + 1,
+							"Pipeline IDs do not count up from one"));
+		bPassed &= Expect(rCache.GetPipelineID(tDesc) == uID,
+						  "Equal pipelines interned apart");
+
+		// Any one state changing is a new pipeline
+		IOEPipelineDescription tOther(tDesc);
+		tOther.uDepthStateID = 0;
+		const std::uint32_t uOtherID(rCache.GetPipelineID(tOther));
+		bPassed &= Expect(uOtherID == uID + 1, "Different pipelines share");
+		bPassed &= Expect(rCache.GetNumPipelines() == uNumPipelines + 2,
+						  "Pipeline count");
+
+		// The IDs survive being packed into a queue item, and order items
+		// that differ only by pipeline
+		const std::uint64_t uMask(
+			GET_RENDER_MASK(IOERenderQueueItem::NUM_BITS_MATERIAL_ID));
+		IOERenderQueueItem tItem, tOtherItem, tLastItem;
+		tItem.SetRenderCommandID(ERenderMode::Normal, EViewport::Viewport0, 0,
+								 false, 100, uID);
+		tOtherItem.SetRenderCommandID(ERenderMode::Normal,
+									  EViewport::Viewport0, 0, false, 100,
+									  uOtherID);
+		tLastItem.SetRenderCommandID(ERenderMode::Normal, EViewport::Viewport0,
+									 0, false, 100,
+									 IOEStateCache::ms_uMaxPipelineID);
+		bPassed &= Expect((tItem.GetRenderCommandID() & uMask) == uID &&
+							  (tOtherItem.GetRenderCommandID() & uMask) ==
+								  uOtherID,
+						  "Pipeline ID lost in the queue item");
+		bPassed &= Expect(tItem.GetRenderCommandID() <
+								  tOtherItem.GetRenderCommandID() &&
+							  tOtherItem.GetRenderCommandID() <
+								  tLastItem.GetRenderCommandID(),
+						  "Pipeline IDs out of order in the queue");
+		bPassed &= Expect(
+			(tLastItem.GetRenderCommandID() >>
+			 IOERenderQueueItem::BIT_POS_DEPTH) ==
+				(tItem.GetRenderCommandID() >>
+				 IOERenderQueueItem::BIT_POS_DEPTH),
+			"Largest pipeline ID spills out of its field");
+		return bPassed;
+	}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main(int nArgC, char **arrArgV)
+{
+	std::shared_ptr<IOERPI> pRPI(
+		UnitTests::CreateHeadlessRPI(UnitTests::GetMediaPath(nArgC, arrArgV)));
+
+	bool bPassed(true);
+	bPassed &= TestEqualDescriptions(*pRPI);
+	bPassed &= TestCollision(*pRPI);
+	bPassed &= TestPipelineIDs(*pRPI);
+
+	std::printf("StateCacheTest %s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
@@ -0,0 +1,223 @@
+// Checks IOEText and IOETextManager on the Null platform: a text is only
+// laid out again when its string or scale changes, a new position or colour
+// being applied to the quads it has, and every text of a font face is
+// uploaded together, more quads than the index buffer covers being drawn
+// from that one upload in further draws.
+//
+// Takes the media directory as its first argument, ../../Media otherwise.
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <IOE/IOERenderer/IOEFont.h>
+#include <IOE/IOERenderer/IOERPI.h>
+
+#include "../Common/HeadlessRPI.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Renderer;
+
+	const std::uint32_t g_uStride = sizeof(FontVertex);
+
+	bool Expect(bool bPassed, const char *szCase)
+	{
+		if (!bPassed)
+		{
+			std::printf("%s\n", szCase);
+		}
+		return bPassed;
+	}
+
+	bool IsColour(const FontVertex &rVertex, const IOEVector &vColour)
+	{
+		float fR, fG, fB, fA;
+		vColour.Get(fR, fG, fB, fA);
+		return rVertex.vColour.x == fR && rVertex.vColour.y == fG &&
+			rVertex.vColour.z == fB && rVertex.vColour.w == fA;
+	}
+
+	void RenderFrame(IOERPI &rRPI)
+	{
+		rRPI.OnPreRender(&rRPI);
+		IOETextManager::GetSingletonPtr()->OnRender(&rRPI);
+		rRPI.OnRender(&rRPI);
+		rRPI.OnPostRender(&rRPI);
+	}
+
+	// Glyphs are asked for as texts are laid out, rasterised by the atlas's
+	// worker, and published by the frame after
+	void LoadGlyphs(IOERPI &rRPI, IOEFont &rFont)
+	{
+		RenderFrame(rRPI);
+		rFont.GetFace()->GetAtlas().Flush();
+		RenderFrame(rRPI);
+	}
+
+	std::vector<FontVertex> GetVertices(IOEText &rText)
+	{
+		std::vector<FontVertex> arrVertices(rText.GetNumQuads() * 4);
+		rText.WriteVertices(arrVertices.data());
+		return arrVertices;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestRelayout(IOERPI &rRPI, IOEText &rText)
+	{
+		bool bPassed(Expect(rText.GetNumQuads() == 5, "Glyphs not loaded"));
+		const std::uint32_t uNumLayouts(rText.GetNumLayouts());
+		const std::vector<FontVertex> arrBefore(GetVertices(rText));
+
+		// Moved and coloured, and the same string and scale set again
+		rText.UpdatePosition(30.0f, 45.0f);
+		rText.UpdateColour(IOE::Maths::ColourList::Green);
+		rText.UpdateText("Hello");
+		rText.UpdateScale(1.0f, 1.0f);
+		RenderFrame(rRPI);
+		const std::vector<FontVertex> arrAfter(GetVertices(rText));
+		bPassed &= Expect(rText.GetNumLayouts() == uNumLayouts,
+						  "Laid out again for a new position or colour");
+
+		bool bMoved(arrAfter.size() == arrBefore.size());
+		for (std::size_t uIdx(0); bMoved && uIdx < arrAfter.size(); ++uIdx)
+		{
+			bMoved = arrAfter[uIdx].vPos.x == arrBefore[uIdx].vPos.x + 20.0f &&
+				arrAfter[uIdx].vPos.y == arrBefore[uIdx].vPos.y + 25.0f &&
+				IsColour(arrAfter[uIdx], IOE::Maths::ColourList::Green);
+		}
+		bPassed &= Expect(bMoved, "Position or colour not applied");
+
+		// Glyphs already in the atlas, so only the new string lays it out
+		rText.UpdateText("olleH");
+		RenderFrame(rRPI);
+		bPassed &= Expect(rText.GetNumLayouts() == uNumLayouts + 1,
+						  "New text not laid out once");
+
+		const float fWidth(rText.GetRenderWidth());
+		rText.UpdateScale(2.0f, 2.0f);
+		bPassed &= Expect(rText.GetRenderWidth() == fWidth * 2.0f &&
+							  rText.GetNumLayouts() == uNumLayouts + 2,
+						  "New scale not laid out once");
+		RenderFrame(rRPI);
+		bPassed &= Expect(rText.GetNumLayouts() == uNumLayouts + 2,
+						  "Laid out again by drawing");
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestSplitDraws(IOERPI &rRPI, const std::shared_ptr<IOEFont> &pFont,
+						IOEText &rText)
+	{
+		// A second size of the same face, so its text joins the same batch,
+		// and more quads between the texts than one draw can take
+		std::shared_ptr<IOEFont> pLarge(
+			IOEFont::CreateFontFromName("Arial", 24));
+		pLarge->Setup(&rRPI);
+		IOETextManager &rManager(*IOETextManager::GetSingletonPtr());
+		std::shared_ptr<IOEText> pFirst(rManager.CreateText(
+			std::string(IOEFont::ms_uMaxCharsPerDraw * 3 / 4, 'H'), 0.0f,
+			0.0f, pFont));
+		std::shared_ptr<IOEText> pSecond(rManager.CreateText(
+			std::string(IOEFont::ms_uMaxCharsPerDraw / 2, 'o'), 0.0f, 100.0f,
+			pLarge));
+		const std::uint32_t uNumQuads(rText.GetNumQuads() +
+									  pFirst->GetNumQuads() +
+									  pSecond->GetNumQuads());
+		bool bPassed(Expect(uNumQuads > IOEFont::ms_uMaxCharsPerDraw,
+							"Too few quads to split"));
+
+		IOERPICommandStream &rStream(UnitTests::GetCommandStream(rRPI));
+		rStream.Reset();
+		rStream.SetRecordCommands(true);
+		RenderFrame(rRPI);
+		rStream.SetRecordCommands(false);
+
+		// Each draw takes the indices of as many quads as it can, from the
+		// vertex buffer bound just before it
+		const void *pVertexBuffer(nullptr);
+		std::uint64_t uBinding(0);
+		std::vector<std::uint64_t> arrBindings;
+		std::uint32_t uNumDrawn(0);
+		for (std::uint32_t uIdx(0); uIdx < rStream.GetNumCommands(); ++uIdx)
+		{
+			const IOERPICommand &rCommand(rStream.GetCommand(uIdx));
+			if (rCommand.eCommand == ERPICommand::SetVertexBuffer)
+			{
+				pVertexBuffer = rCommand.pObject;
+				uBinding	  = rCommand.uValue;
+			}
+			else if (rCommand.eCommand == ERPICommand::DrawIndexed)
+			{
+				const std::uint32_t uRemaining(uNumQuads - uNumDrawn);
+				const std::uint32_t uExpected(
+					uRemaining < IOEFont::ms_uMaxCharsPerDraw
+						? uRemaining
+						: IOEFont::ms_uMaxCharsPerDraw);
+				bPassed &= Expect(rCommand.uValue == uExpected * 6,
+								  "Draw of the wrong number of quads");
+				arrBindings.push_back(uBinding);
+				uNumDrawn += uExpected;
+			}
+		}
+		bPassed &= Expect(arrBindings.size() == 2 && uNumDrawn == uNumQuads,
+						  "Quads not split over two draws");
+
+		// One upload to the ring both draws read from, the second from
+		// where the first's quads end
+		std::uint32_t uNumUploads(0);
+		for (std::uint32_t uIdx(0); uIdx < rStream.GetNumCommands(); ++uIdx)
+		{
+			const IOERPICommand &rCommand(rStream.GetCommand(uIdx));
+			if (rCommand.eCommand == ERPICommand::Upload &&
+				rCommand.pObject == pVertexBuffer)
+			{
+				bPassed &= Expect(rCommand.uValue == uNumQuads * 4 * g_uStride,
+								  "Upload of the wrong size");
+				++uNumUploads;
+			}
+		}
+		bPassed &= Expect(uNumUploads == 1, "Texts not uploaded together");
+		if (arrBindings.size() == 2)
+		{
+			const std::uint64_t uQuadsBytes(
+				static_cast<std::uint64_t>(IOEFont::ms_uMaxCharsPerDraw) * 4 *
+				g_uStride);
+			bPassed &= Expect((arrBindings[1] >> 32) ==
+								  (arrBindings[0] >> 32) + uQuadsBytes &&
+								  (arrBindings[1] & 0xFFFFFFFF) == g_uStride,
+							  "Second draw not from the end of the first");
+		}
+		return bPassed;
+	}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main(int nArgC, char **arrArgV)
+{
+	std::shared_ptr<IOERPI> pRPI(
+		UnitTests::CreateHeadlessRPI(UnitTests::GetMediaPath(nArgC, arrArgV)));
+
+	std::shared_ptr<IOEFont> pFont(IOEFont::CreateFontFromName("Arial", 12));
+	pFont->Setup(pRPI.get());
+	std::shared_ptr<IOEText> pText(
+		IOETextManager::GetSingletonPtr()->CreateText(
+			"Hello", 10.0f, 20.0f, pFont, IOE::Maths::ColourList::Red,
+			IOE::Maths::ColourList::Blue));
+	LoadGlyphs(*pRPI, *pFont);
+
+	bool bPassed(true);
+	bPassed &= TestRelayout(*pRPI, *pText);
+	bPassed &= TestSplitDraws(*pRPI, pFont, *pText);
+
+	std::printf("TextBatchTest %s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
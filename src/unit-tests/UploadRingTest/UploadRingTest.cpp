@@ -0,0 +1,328 @@
+// Checks the offsets IOEUploadRing hands out against a fake fence whose
+// GPU lags behind the CPU: alignment, wrapping at the end of the ring,
+// waiting only when the ring has caught up with the GPU, and that no
+// allocation ever overlaps data a frame the GPU has not passed still holds.
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <random>
+
+#include <IOE/IOERenderer/IOEUploadRing.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using namespace IOE::Renderer;
+
+	const std::uint32_t g_uCapacity		  = 1024;
+	const std::uint32_t g_uNumAllocations = 10000;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// The GPU only moves on when the test says so, or when waited on
+	class FakeFence : public IOEGPUFence
+	{
+	public:
+		FakeFence()
+			: m_uSignalled(0)
+			, m_uCompleted(0)
+			, m_uNumWaits(0)
+			, m_bWaitedAhead(false)
+		{
+		}
+
+		virtual void Signal(std::uint64_t uValue) override
+		{
+			m_uSignalled = uValue;
+		}
+		virtual std::uint64_t GetCompletedValue() override
+		{
+			return m_uCompleted;
+		}
+		virtual void Wait(std::uint64_t uValue) override
+		{
+			// Waiting on a value never signalled would block forever
+			m_bWaitedAhead = m_bWaitedAhead || uValue > m_uSignalled;
+			++m_uNumWaits;
+			m_uCompleted = uValue;
+		}
+
+		// The GPU never passes a value not yet signalled
+		void Complete(std::uint64_t uValue)
+		{
+			uValue		 = uValue < m_uSignalled ? uValue : m_uSignalled;
+			m_uCompleted = uValue > m_uCompleted ? uValue : m_uCompleted;
+		}
+
+	public:
+		std::uint64_t m_uSignalled;
+		std::uint64_t m_uCompleted;
+		std::uint32_t m_uNumWaits;
+		bool m_bWaitedAhead;
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool Expect(bool bPassed, const char *szCase)
+	{
+		if (!bPassed)
+		{
+			std::printf("%s\n", szCase);
+		}
+		return bPassed;
+	}
+
+	bool ExpectAllocate(IOEUploadRing &rRing, std::uint32_t uSize,
+						std::uint32_t uAlignment, std::uint32_t uExpected)
+	{
+		std::uint32_t uOffset(~0U);
+		if (!rRing.Allocate(uSize, uAlignment, uOffset) ||
+			uOffset != uExpected)
+		{
+			std::printf("Allocate %u aligned to %u: offset %u, expected %u\n",
+						uSize, uAlignment, uOffset, uExpected);
+			return false;
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestFrames()
+	{
+		FakeFence tFence;
+		IOEUploadRing tRing;
+		tRing.Setup(g_uCapacity, &tFence);
+
+		// Each allocation starts at its own alignment
+		if (!ExpectAllocate(tRing, 100, 16, 0) ||
+			!ExpectAllocate(tRing, 10, 16, 112) ||
+			!ExpectAllocate(tRing, 256, 256, 256) ||
+			!Expect(tRing.GetFrameBytes() == 512, "Frame bytes"))
+		{
+			return false;
+		}
+		tFence.Signal(1);
+		tRing.EndFrame(1);
+		if (!Expect(tRing.GetBytesInFlight() == 512, "Bytes in flight") ||
+			!Expect(tRing.GetFrameBytes() == 0, "Frame bytes after end"))
+		{
+			return false;
+		}
+
+		// The rest of the ring is free, but going past the end would
+		// reach frame one, which has to be waited for
+		if (!ExpectAllocate(tRing, 400, 16, 512) ||
+			!Expect(tFence.m_uNumWaits == 0, "Waited with room left") ||
+			!ExpectAllocate(tRing, 200, 16, 0) ||
+			!Expect(tFence.m_uNumWaits == 1 && tRing.GetNumWaits() == 1 &&
+						tFence.m_uCompleted == 1,
+					"Did not wait for the first frame"))
+		{
+			return false;
+		}
+		tFence.Signal(2);
+		tRing.EndFrame(2);
+
+		// Frames the GPU has passed are reused without waiting. Skipping
+		// the end of the ring counts against the frame, so 300 more bytes
+		// would need more than the whole ring.
+		tFence.Complete(2);
+		std::uint32_t uOffset(0);
+		if (!ExpectAllocate(tRing, 800, 16, 208) ||
+			!Expect(tRing.GetNumWaits() == 1, "Waited for a passed frame") ||
+			!Expect(!tRing.Allocate(300, 16, uOffset), "Overfilled a frame"))
+		{
+			return false;
+		}
+		tFence.Signal(3);
+		tRing.EndFrame(3);
+
+		// An empty frame fences nothing
+		tFence.Complete(3);
+		tRing.EndFrame(4);
+		return Expect(tRing.GetBytesInFlight() == 0, "Empty frame fenced");
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool TestLimits()
+	{
+		FakeFence tFence;
+		IOEUploadRing tRing;
+		tRing.Setup(g_uCapacity, &tFence);
+
+		// A frame may take the whole ring, but never more
+		std::uint32_t uOffset(0);
+		if (!ExpectAllocate(tRing, g_uCapacity, 16, 0) ||
+			!Expect(!tRing.Allocate(1, 16, uOffset), "Overfilled the ring"))
+		{
+			return false;
+		}
+		tFence.Signal(1);
+		tRing.EndFrame(1);
+		if (!Expect(!tRing.Allocate(2 * g_uCapacity, 16, uOffset),
+					"Allocated more than the ring") ||
+			!ExpectAllocate(tRing, 16, 16, 0) ||
+			!Expect(tRing.GetNumWaits() == 1, "Reused an unfinished frame"))
+		{
+			return false;
+		}
+
+		// Without a capacity nothing is ever handed out
+		IOEUploadRing tEmpty;
+		return Expect(!tEmpty.Allocate(16, 16, uOffset), "Empty ring");
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Frames with a GPU two frames behind, as the RPI runs. Every fifth
+	// allocation ends a frame of around 750 bytes, so three frames seldom
+	// fit in the ring and nearly every frame waits for the oldest.
+	bool TestLaggingGPU()
+	{
+		const std::uint32_t uCapacity(2 * g_uCapacity);
+
+		FakeFence tFence;
+		IOEUploadRing tRing;
+		tRing.Setup(uCapacity, &tFence);
+
+		std::uint64_t uFrame(0);
+		for (std::uint32_t uIdx(0); uIdx < g_uNumAllocations; ++uIdx)
+		{
+			const std::uint32_t uSize(1 + (uIdx * 37) % 300);
+			std::uint32_t uOffset(0);
+			if (!tRing.Allocate(uSize, 16, uOffset) || uOffset % 16 != 0 ||
+				uOffset + uSize > uCapacity)
+			{
+				std::printf("Lagging: allocation %u of %u at %u\n", uIdx,
+							uSize, uOffset);
+				return false;
+			}
+			if (uIdx % 5 == 4)
+			{
+				tFence.Signal(++uFrame);
+				tRing.EndFrame(uFrame);
+				if (uFrame > 2)
+				{
+					tFence.Complete(uFrame - 2);
+				}
+			}
+		}
+
+		const bool bPassed(tRing.GetNumWaits() == 1981 &&
+						   tRing.GetBytesInFlight() == 1578 &&
+						   !tFence.m_bWaitedAhead);
+		if (!bPassed)
+		{
+			std::printf("Lagging: %u waits, %u in flight\n",
+						tRing.GetNumWaits(), tRing.GetBytesInFlight());
+		}
+		return bPassed;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Random sizes, alignments and frame lengths, with the GPU passing a
+	// random number of frames. Every byte handed out is checked against
+	// the bytes of every frame the GPU has not passed.
+	bool TestRandom(std::mt19937 &rRandom)
+	{
+		struct Range
+		{
+			std::uint64_t uFence;
+			std::uint32_t uBegin;
+			std::uint32_t uEnd;
+		};
+
+		FakeFence tFence;
+		IOEUploadRing tRing;
+		tRing.Setup(g_uCapacity, &tFence);
+
+		std::uniform_int_distribution<std::uint32_t> tSize(1, 200);
+		std::uniform_int_distribution<std::uint32_t> tAlignment(0, 8);
+		std::uniform_int_distribution<std::uint32_t> tChance(0, 9);
+
+		std::deque<Range> arrInFlight;
+		std::uint64_t uFrame(1);
+		for (std::uint32_t uIdx(0); uIdx < g_uNumAllocations; ++uIdx)
+		{
+			const std::uint32_t uSize(tSize(rRandom));
+			const std::uint32_t uAlignment(1U << tAlignment(rRandom));
+			std::uint32_t uOffset(0);
+			if (!tRing.Allocate(uSize, uAlignment, uOffset))
+			{
+				// Only a frame with no room left may fail
+				if (tRing.GetFrameBytes() + uSize <= g_uCapacity / 2)
+				{
+					std::printf("Random: %u bytes failed with %u used\n",
+								uSize, tRing.GetFrameBytes());
+					return false;
+				}
+				uOffset = ~0U;
+			}
+			else if ((uOffset & (uAlignment - 1)) != 0 ||
+					 uOffset + uSize > g_uCapacity)
+			{
+				std::printf("Random: %u bytes aligned to %u at %u\n", uSize,
+							uAlignment, uOffset);
+				return false;
+			}
+
+			// Anything waited for in that allocation is free again
+			while (!arrInFlight.empty() &&
+				   arrInFlight.front().uFence <= tFence.m_uCompleted)
+			{
+				arrInFlight.pop_front();
+			}
+			if (uOffset != ~0U)
+			{
+				for (const Range &rRange : arrInFlight)
+				{
+					if (uOffset < rRange.uEnd &&
+						rRange.uBegin < uOffset + uSize)
+					{
+						std::printf("Random: [%u, %u) overlaps [%u, %u) of "
+									"frame %llu\n",
+									uOffset, uOffset + uSize, rRange.uBegin,
+									rRange.uEnd,
+									static_cast<unsigned long long>(
+										rRange.uFence));
+						return false;
+					}
+				}
+				Range tRange = {uFrame, uOffset, uOffset + uSize};
+				arrInFlight.push_back(tRange);
+			}
+
+			if (tChance(rRandom) == 0)
+			{
+				tFence.Signal(uFrame);
+				tRing.EndFrame(uFrame);
+				++uFrame;
+				tFence.Complete(tFence.m_uCompleted + tChance(rRandom) / 4);
+			}
+		}
+
+		return Expect(!tFence.m_bWaitedAhead, "Random: waited ahead");
+	}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	bool bPassed(TestFrames() && TestLimits() && TestLaggingGPU());
+
+	std::mt19937 tRandom(0xF3CE);
+	for (std::uint32_t uTrial(0); uTrial < 20 && bPassed; ++uTrial)
+	{
+		bPassed = TestRandom(tRandom);
+	}
+
+	std::printf("%s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}
@@ -0,0 +1,311 @@
+// Measures the error of every precision tier of the SIMD transcendentals in
+// IOEMaths/VectorMath.h against the double precision CRT, and fails when a
+// tier exceeds the bound documented in the header.
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+
+#include <IOE/IOEMaths/VectorMath.h>
+
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using IOE::Maths::EMathPrecision;
+	namespace SIMD = IOE::Maths::SIMD;
+
+	const std::uint32_t g_uNumSamples = 1 << 20;
+
+	//////////////////////////////////////////////////////////////////////////
+
+	enum class EErrorUnit
+	{
+		ULP,
+		Absolute,
+	};
+
+	// Spacing of the floats around the reference, denormals sharing the
+	// spacing of FLT_MIN
+	double ULP(double dReference)
+	{
+		float fMagnitude(static_cast<float>(std::fabs(dReference)));
+		fMagnitude = fMagnitude < FLT_MIN ? FLT_MIN : fMagnitude;
+		return static_cast<double>(std::nextafter(fMagnitude, FLT_MAX)) -
+			fMagnitude;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	typedef std::function<float(std::mt19937 &)> Sampler;
+	typedef __m128 (*Kernel)(__m128, __m128);
+	typedef std::function<double(double, double)> Reference;
+
+	struct ErrorCase
+	{
+		const char *pszName;
+		const char *pszDomain;
+		Sampler fnSampleX;
+		Sampler fnSampleY;
+		Reference fnReference;
+		EErrorUnit eUnit;
+
+		// Fast, Medium and Full, as documented in VectorMath.h
+		double arrBounds[3];
+	};
+
+	Sampler Uniform(float fMin, float fMax)
+	{
+		return [fMin, fMax](std::mt19937 &rRandom) {
+			return std::uniform_real_distribution<float>(fMin, fMax)(rRandom);
+		};
+	}
+
+	// Uniform in the exponent, so every binade is covered evenly
+	Sampler LogUniform(float fMin, float fMax)
+	{
+		const float fLogMin(std::log2(fMin));
+		const float fLogMax(std::log2(fMax));
+		return [fLogMin, fLogMax](std::mt19937 &rRandom) {
+			const float fExponent(std::uniform_real_distribution<float>(
+				fLogMin, fLogMax)(rRandom));
+			return std::exp2(fExponent);
+		};
+	}
+
+	Sampler Either(Sampler fnFirst, Sampler fnSecond)
+	{
+		return [fnFirst, fnSecond](std::mt19937 &rRandom) {
+			return (rRandom() & 1) != 0 ? fnFirst(rRandom) : fnSecond(rRandom);
+		};
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Largest error of the kernel over the case's domain
+	double MeasureError(const ErrorCase &rCase, const Kernel &fnKernel)
+	{
+		std::mt19937 tRandom(0x10E);
+		double dMaxError(0.0);
+
+		for (std::uint32_t uSample(0); uSample < g_uNumSamples; uSample += 4)
+		{
+			float arrX[4], arrY[4], arrResult[4];
+			for (std::uint32_t uLane(0); uLane < 4; ++uLane)
+			{
+				arrX[uLane] = rCase.fnSampleX(tRandom);
+				arrY[uLane] = rCase.fnSampleY ? rCase.fnSampleY(tRandom) : 0.0f;
+			}
+
+			_mm_storeu_ps(arrResult,
+						  fnKernel(_mm_loadu_ps(arrX), _mm_loadu_ps(arrY)));
+
+			for (std::uint32_t uLane(0); uLane < 4; ++uLane)
+			{
+				const double dReference(
+					rCase.fnReference(arrX[uLane], arrY[uLane]));
+				double dError(std::fabs(arrResult[uLane] - dReference));
+				if (rCase.eUnit == EErrorUnit::ULP)
+				{
+					dError /= ULP(dReference);
+				}
+				dMaxError = dError > dMaxError ? dError : dMaxError;
+			}
+		}
+
+		return dMaxError;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	template <EMathPrecision ePrecision>
+	Kernel GetKernel(const char *pszName)
+	{
+		const std::string strName(pszName);
+		if (strName == "Sin")
+		{
+			return [](__m128 vX, __m128) { return SIMD::Sin<ePrecision>(vX); };
+		}
+		if (strName == "Cos")
+		{
+			return [](__m128 vX, __m128) { return SIMD::Cos<ePrecision>(vX); };
+		}
+		if (strName == "ATan2")
+		{
+			return [](__m128 vX, __m128 vY) {
+				return SIMD::ATan2<ePrecision>(vY, vX);
+			};
+		}
+		if (strName == "Exp")
+		{
+			return [](__m128 vX, __m128) { return SIMD::Exp<ePrecision>(vX); };
+		}
+		if (strName == "Log")
+		{
+			return [](__m128 vX, __m128) { return SIMD::Log<ePrecision>(vX); };
+		}
+		if (strName == "Pow")
+		{
+			return [](__m128 vX, __m128 vY) {
+				return SIMD::Pow<ePrecision>(vX, vY);
+			};
+		}
+		return [](__m128 vX, __m128) { return SIMD::RSqrt<ePrecision>(vX); };
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// Sin and Cos must agree with SinCos exactly, as they share the kernel
+	template <EMathPrecision ePrecision>
+	bool CheckSinCos()
+	{
+		std::mt19937 tRandom(0x5C);
+		const Sampler fnSample(Uniform(-8192.0f, 8192.0f));
+		for (std::uint32_t uSample(0); uSample < g_uNumSamples; uSample += 4)
+		{
+			float arrX[4];
+			for (float &rX : arrX)
+			{
+				rX = fnSample(tRandom);
+			}
+
+			__m128 vSin, vCos;
+			SIMD::SinCos<ePrecision>(_mm_loadu_ps(arrX), vSin, vCos);
+			const __m128 vSinOnly(SIMD::Sin<ePrecision>(_mm_loadu_ps(arrX)));
+			const __m128 vCosOnly(SIMD::Cos<ePrecision>(_mm_loadu_ps(arrX)));
+			if (_mm_movemask_ps(_mm_cmpneq_ps(vSin, vSinOnly)) != 0 ||
+				_mm_movemask_ps(_mm_cmpneq_ps(vCos, vCosOnly)) != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	bool CheckSpecialValues()
+	{
+		const float fInfinity(std::numeric_limits<float>::infinity());
+		bool bPassed(true);
+		float arrResult[4];
+
+		_mm_storeu_ps(arrResult,
+					  SIMD::Log(_mm_setr_ps(0.0f, -1.0f, fInfinity, 1e-40f)));
+		bPassed = bPassed && arrResult[0] == -fInfinity;
+		bPassed = bPassed && arrResult[1] != arrResult[1];
+		bPassed = bPassed && arrResult[2] == fInfinity;
+		bPassed = bPassed && arrResult[3] == -fInfinity;
+
+		_mm_storeu_ps(arrResult,
+					  SIMD::Exp(_mm_setr_ps(100.0f, -100.0f, 0.0f, 1.0f)));
+		bPassed = bPassed && arrResult[0] == fInfinity;
+		bPassed = bPassed && arrResult[1] == 0.0f;
+		bPassed = bPassed && arrResult[2] == 1.0f;
+
+		_mm_storeu_ps(arrResult,
+					  SIMD::ATan2(_mm_setr_ps(0.0f, 0.0f, 1.0f, -1.0f),
+								  _mm_setr_ps(0.0f, -1.0f, 0.0f, 0.0f)));
+		bPassed = bPassed && arrResult[0] == 0.0f;
+		bPassed = bPassed && std::fabs(arrResult[1] - 3.14159265f) < 1e-6f;
+		bPassed = bPassed && std::fabs(arrResult[2] - 1.57079633f) < 1e-6f;
+		bPassed = bPassed && std::fabs(arrResult[3] + 1.57079633f) < 1e-6f;
+
+		_mm_storeu_ps(arrResult,
+					  SIMD::Pow(_mm_setr_ps(0.0f, 0.0f, 2.0f, -2.0f),
+								_mm_setr_ps(0.0f, 2.0f, 10.0f, 2.0f)));
+		bPassed = bPassed && arrResult[0] == 1.0f;
+		bPassed = bPassed && arrResult[1] == 0.0f;
+		bPassed = bPassed && std::fabs(arrResult[2] - 1024.0f) < 1e-2f;
+		bPassed = bPassed && arrResult[3] != arrResult[3];
+
+		return bPassed;
+	}
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	const float fPi(3.14159265f);
+	const Reference fnSin([](double dX, double) { return std::sin(dX); });
+	const Reference fnCos([](double dX, double) { return std::cos(dX); });
+	const Reference fnLog([](double dX, double) { return std::log(dX); });
+
+	// Every binade, and as many samples again around 1 where the result
+	// approaches zero
+	const Sampler fnLogSample(
+		Either(LogUniform(FLT_MIN, FLT_MAX), Uniform(0.5f, 2.0f)));
+
+	const ErrorCase arrCases[] = {
+		{"Sin", "|x| <= pi/4", Uniform(-fPi / 4, fPi / 4), nullptr, fnSin,
+		 EErrorUnit::ULP, {610, 1, 1}},
+		{"Cos", "|x| <= pi/4", Uniform(-fPi / 4, fPi / 4), nullptr, fnCos,
+		 EErrorUnit::ULP, {610, 1, 1}},
+		{"Sin", "|x| <= pi", Uniform(-fPi, fPi), nullptr, fnSin,
+		 EErrorUnit::Absolute, {3.7e-5, 7.8e-8, 7.8e-8}},
+		{"Cos", "|x| <= pi", Uniform(-fPi, fPi), nullptr, fnCos,
+		 EErrorUnit::Absolute, {3.7e-5, 7.8e-8, 7.8e-8}},
+		{"Sin", "|x| <= 8192", Uniform(-8192, 8192), nullptr, fnSin,
+		 EErrorUnit::Absolute, {4.7e-4, 1.5e-7, 7.9e-8}},
+		{"Cos", "|x| <= 8192", Uniform(-8192, 8192), nullptr, fnCos,
+		 EErrorUnit::Absolute, {4.7e-4, 1.5e-7, 7.9e-8}},
+		{"ATan2", "|x|, |y| <= 1000", Uniform(-1000, 1000),
+		 Uniform(-1000, 1000),
+		 [](double dX, double dY) { return std::atan2(dY, dX); },
+		 EErrorUnit::ULP, {6800, 6, 4}},
+		{"Exp", "[-87.3, 88.7]", Uniform(-87.3f, 88.7f), nullptr,
+		 [](double dX, double) { return std::exp(dX); }, EErrorUnit::ULP,
+		 {670, 3, 1}},
+		{"Log", "[FLT_MIN, FLT_MAX]", fnLogSample, nullptr, fnLog,
+		 EErrorUnit::ULP, {4800, 1, 1}},
+		{"Log", "[FLT_MIN, FLT_MAX]", fnLogSample, nullptr, fnLog,
+		 EErrorUnit::Absolute, {9.7e-5, 3.9e-6, 3.9e-6}},
+		{"Pow", "x in [1e-3, 1e3], |y| <= 4", LogUniform(1e-3f, 1e3f),
+		 Uniform(-4, 4),
+		 [](double dX, double dY) { return std::pow(dX, dY); },
+		 EErrorUnit::ULP, {6100, 33, 33}},
+		{"RSqrt", "[FLT_MIN, FLT_MAX]", LogUniform(FLT_MIN, FLT_MAX), nullptr,
+		 [](double dX, double) { return 1.0 / std::sqrt(dX); },
+		 EErrorUnit::ULP, {5000, 4, 2}},
+	};
+
+	bool bPassed(true);
+	for (const ErrorCase &rCase : arrCases)
+	{
+		const double arrErrors[3] = {
+			MeasureError(rCase, GetKernel<EMathPrecision::Fast>(rCase.pszName)),
+			MeasureError(rCase,
+						 GetKernel<EMathPrecision::Medium>(rCase.pszName)),
+			MeasureError(rCase, GetKernel<EMathPrecision::Full>(rCase.pszName)),
+		};
+
+		std::printf("%-6s %-28s", rCase.pszName, rCase.pszDomain);
+		for (std::uint32_t uTier(0); uTier < 3; ++uTier)
+		{
+			const bool bWithin(arrErrors[uTier] <= rCase.arrBounds[uTier]);
+			std::printf(rCase.eUnit == EErrorUnit::ULP ? " %10.2f ULP%s"
+													   : " %10.3g abs%s",
+						arrErrors[uTier], bWithin ? " " : "!");
+			bPassed = bPassed && bWithin;
+		}
+		std::printf("\n");
+	}
+
+	const bool bSinCos(CheckSinCos<EMathPrecision::Fast>() &&
+					   CheckSinCos<EMathPrecision::Medium>() &&
+					   CheckSinCos<EMathPrecision::Full>());
+	std::printf("SinCos matches Sin and Cos: %s\n", bSinCos ? "yes" : "no");
+
+	const bool bSpecial(CheckSpecialValues());
+	std::printf("Special values: %s\n", bSpecial ? "ok" : "failed");
+
+	bPassed = bPassed && bSinCos && bSpecial;
+	std::printf("%s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed ? 0 : 1;
+}